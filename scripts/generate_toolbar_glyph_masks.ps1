@@ -0,0 +1,62 @@
+# Regenerates src/greenflame_core/toolbar_glyph_masks.inc from the toolbar
+# alpha-mask PNGs under resources/. Run it after adding or changing a mask:
+#
+#   powershell -ExecutionPolicy Bypass -File scripts\generate_toolbar_glyph_masks.ps1
+#
+# Keep $masks in ToolbarGlyphMaskId order (src/greenflame_core/toolbar_glyph_masks.h).
+
+$ErrorActionPreference = 'Stop'
+Add-Type -AssemblyName System.Drawing
+
+$repoRoot = Split-Path -Parent $PSScriptRoot
+$masks = @(
+    @{ Name = 'Brush'; File = 'brush-mask.png' },
+    @{ Name = 'Highlighter'; File = 'highlighter-mask.png' },
+    @{ Name = 'Line'; File = 'line-mask.png' },
+    @{ Name = 'Arrow'; File = 'arrow-mask.png' },
+    @{ Name = 'Rectangle'; File = 'rectangle-mask.png' },
+    @{ Name = 'FilledRectangle'; File = 'filled_rectangle-mask.png' },
+    @{ Name = 'Ellipse'; File = 'ellipse-mask.png' },
+    @{ Name = 'FilledEllipse'; File = 'filled_ellipse-mask.png' },
+    @{ Name = 'Obfuscate'; File = 'obfuscate-mask.png' },
+    @{ Name = 'Text'; File = 'text-mask.png' },
+    @{ Name = 'Bubble'; File = 'bubble-mask.png' },
+    @{ Name = 'Cursor'; File = 'cursor-mask.png' },
+    @{ Name = 'Pin'; File = 'pin-mask.png' },
+    @{ Name = 'Help'; File = 'help-mask.png' }
+)
+
+$lines = [System.Collections.Generic.List[string]]::new()
+$lines.Add('// Generated by scripts/generate_toolbar_glyph_masks.ps1 from resources/*-mask.png.')
+$lines.Add('// Do not edit by hand; rerun the script after changing a mask.')
+foreach ($mask in $masks) {
+    $path = Join-Path $repoRoot (Join-Path 'resources' $mask.File)
+    $bitmap = [System.Drawing.Bitmap]::new($path)
+    try {
+        $mask.Width = $bitmap.Width
+        $mask.Height = $bitmap.Height
+        $lines.Add('')
+        $lines.Add("// resources/$($mask.File)")
+        $lines.Add("constexpr std::array<uint8_t, $($bitmap.Width * $bitmap.Height)> " +
+            "k$($mask.Name)GlyphAlpha = {{")
+        for ($y = 0; $y -lt $bitmap.Height; ++$y) {
+            $row = for ($x = 0; $x -lt $bitmap.Width; ++$x) {
+                '{0,3},' -f $bitmap.GetPixel($x, $y).A
+            }
+            $lines.Add('    ' + (-join $row))
+        }
+        $lines.Add('}};')
+    } finally {
+        $bitmap.Dispose()
+    }
+}
+$lines.Add('')
+$lines.Add("constexpr std::array<ToolbarGlyphMask, $($masks.Count)> kToolbarGlyphMasks = {{")
+foreach ($mask in $masks) {
+    $lines.Add("    {$($mask.Width), $($mask.Height), k$($mask.Name)GlyphAlpha},")
+}
+$lines.Add('}};')
+
+$output = Join-Path $repoRoot 'src\greenflame_core\toolbar_glyph_masks.inc'
+[System.IO.File]::WriteAllText($output, ($lines -join "`n") + "`n")
+Write-Host "Wrote $output"
@@ -86,4 +86,26 @@ void Write_console_block(std::wstring_view text, bool to_stderr) {
     }
 }
 
+bool Write_stdout_bytes(std::span<const uint8_t> bytes) {
+    HANDLE const stream = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (stream == nullptr || stream == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    DWORD mode = 0;
+    if (GetConsoleMode(stream, &mode) != 0) {
+        return false;
+    }
+    while (!bytes.empty()) {
+        DWORD const chunk = static_cast<DWORD>(
+            std::min<size_t>(bytes.size(), std::numeric_limits<DWORD>::max()));
+        DWORD written = 0;
+        if (WriteFile(stream, bytes.data(), chunk, &written, nullptr) == 0 ||
+            written == 0) {
+            return false;
+        }
+        bytes = bytes.subspan(written);
+    }
+    return true;
+}
+
 } // namespace greenflame
@@ -5,5 +5,8 @@ namespace greenflame {
 void Write_console_text(std::wstring_view text, bool to_stderr);
 void Write_console_line(std::wstring_view text, bool to_stderr);
 void Write_console_block(std::wstring_view text, bool to_stderr);
+// Writes raw bytes to standard output. Fails when stdout is a console or is not
+// available, so image data never lands in a terminal.
+[[nodiscard]] bool Write_stdout_bytes(std::span<const uint8_t> bytes);
 
 } // namespace greenflame
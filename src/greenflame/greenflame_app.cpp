@@ -6,12 +6,21 @@
 
 namespace {
 
+#ifdef DEBUG
+constexpr bool kDebugBuild = true;
+#else
+constexpr bool kDebugBuild = false;
+#endif
 constexpr int kThumbnailMaxWidth = 320;
 constexpr int kThumbnailMaxHeight = 120;
 constexpr wchar_t kStartupToggleFailedMessage[] =
     L"Failed to update 'Start with Windows' setting.";
 constexpr wchar_t kIncludeCursorToggleFailedMessage[] =
     L"Failed to update 'Include captured cursor' setting.";
+constexpr wchar_t kTraceSavedMessage[] = L"Performance trace saved.";
+constexpr wchar_t kTraceSaveFailedMessage[] = L"Failed to save performance trace.";
+constexpr wchar_t kNoLastCaptureMessage[] = L"No previous capture in history.";
+constexpr wchar_t kPinFailedMessage[] = L"Failed to pin the last capture.";
 
 [[nodiscard]] HBITMAP Create_thumbnail_from_clipboard() {
     if (OpenClipboard(nullptr) == 0) {
@@ -114,6 +123,37 @@ void Show_config_recovery(greenflame::TrayWindow &tray_window) {
         L"Config file restored. Persistent changes will be saved again.");
 }
 
+[[nodiscard]] bool Write_trace_file(std::filesystem::path const &path) {
+    std::string const json =
+        greenflame::core::TraceRecorder::Instance().Build_chrome_trace_json();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    return static_cast<bool>(file);
+}
+
+[[nodiscard]] std::filesystem::path Build_tray_trace_path() {
+    std::filesystem::path const dir = greenflame::Get_app_config_dir();
+    if (dir.empty()) {
+        return {};
+    }
+    SYSTEMTIME time = {};
+    GetLocalTime(&time);
+    auto const two_digits = [](WORD value) {
+        std::wstring text = std::to_wstring(value);
+        return text.size() < 2 ? L"0" + text : text;
+    };
+    std::wstring name = L"trace-";
+    name += std::to_wstring(time.wYear);
+    name += two_digits(time.wMonth);
+    name += two_digits(time.wDay);
+    name += L"-";
+    name += two_digits(time.wHour);
+    name += two_digits(time.wMinute);
+    name += two_digits(time.wSecond);
+    name += L".json";
+    return dir / name;
+}
+
 struct ChangeNotificationGuard {
     HANDLE handle = INVALID_HANDLE_VALUE;
     ~ChangeNotificationGuard() {
@@ -129,10 +169,10 @@ namespace greenflame {
 
 GreenflameApp::GreenflameApp(HINSTANCE hinstance, core::CliOptions const &cli_options)
     : hinstance_(hinstance), tray_window_(this),
-      overlay_window_(this, &config_, &window_query_),
+      overlay_window_(this, &config_, &window_query_, &save_directory_index_),
       app_controller_(config_, display_queries_, window_inspector_, capture_service_,
                       input_image_service_, annotation_preparation_service_,
-                      file_system_service_),
+                      file_system_service_, save_directory_index_),
       cli_options_(cli_options) {}
 
 uint8_t GreenflameApp::Run() {
@@ -145,7 +185,14 @@ uint8_t GreenflameApp::Run() {
         if (load_result.issue.has_value()) {
             Write_console_block(Build_config_issue_stderr_text(load_result), true);
         }
+        bool const tracing = !cli_options_.trace_output_path.empty();
+        core::TraceRecorder::Instance().Set_enabled(tracing);
         ProcessExitCode const cli_result = Run_cli_capture_mode();
+        if (tracing && !Write_trace_file(cli_options_.trace_output_path)) {
+            std::wstring warning = L"Warning: Failed to write trace file: ";
+            warning += cli_options_.trace_output_path;
+            Write_console_line(warning, true);
+        }
         (void)Save_app_config(config_);
         return To_exit_code(cli_result);
     }
@@ -165,6 +212,9 @@ uint8_t GreenflameApp::Run() {
     }
     Show_config_issue(load_result, tray_window_);
     overlay_window_.On_config_updated();
+    capture_service_.Set_history_budget_mb(config_.capture_history_budget_mb);
+    // Without the server, CLI calls simply run in their own process.
+    (void)cli_server_.Start();
 
     ChangeNotificationGuard watcher;
     {
@@ -191,12 +241,26 @@ uint8_t GreenflameApp::Run() {
                           : static_cast<DWORD>(debounce_deadline - now);
         }
 
-        DWORD const watch_count = (watcher.handle != INVALID_HANDLE_VALUE) ? 1u : 0u;
+        std::array<HANDLE, 2> handles = {};
+        DWORD handle_count = 0;
+        if (watcher.handle != INVALID_HANDLE_VALUE) {
+            handles[handle_count++] = watcher.handle;
+        }
+        HANDLE const cli_request_event = cli_server_.Request_ready_event();
+        if (cli_request_event != nullptr) {
+            handles[handle_count++] = cli_request_event;
+        }
         DWORD const result = MsgWaitForMultipleObjects(
-            watch_count, (watch_count > 0) ? &watcher.handle : nullptr, FALSE, timeout,
+            handle_count, (handle_count > 0) ? handles.data() : nullptr, FALSE, timeout,
             QS_ALLINPUT);
-
-        if (result == WAIT_OBJECT_0 && watch_count > 0) {
+        bool const handle_signaled =
+            result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + handle_count;
+        HANDLE const signaled =
+            handle_signaled ? handles[result - WAIT_OBJECT_0] : nullptr;
+
+        if (handle_signaled && signaled == cli_request_event) {
+            cli_server_.Run_pending_request(*this);
+        } else if (handle_signaled && signaled == watcher.handle) {
             FindNextChangeNotification(watcher.handle);
             debouncing = true;
             debounce_deadline = GetTickCount64() + k_debounce_ms;
@@ -212,6 +276,7 @@ uint8_t GreenflameApp::Run() {
                 Show_config_issue(load_result, tray_window_);
             }
             overlay_window_.On_config_updated();
+            capture_service_.Set_history_budget_mb(config_.capture_history_budget_mb);
             continue;
         }
 
@@ -225,6 +290,7 @@ uint8_t GreenflameApp::Run() {
         }
     }
 
+    cli_server_.Stop();
     (void)Save_app_config(config_);
     return static_cast<uint8_t>(message.wParam);
 }
@@ -240,6 +306,24 @@ ProcessExitCode GreenflameApp::Run_cli_capture_mode() {
     return cli_result.exit_code;
 }
 
+core::CliServerResponse
+GreenflameApp::Handle_cli_request(core::CliServerRequest const &request) {
+    // Relative --input and --output paths resolve against the client's directory.
+    std::wstring const previous_directory = Get_current_directory();
+    if (SetCurrentDirectoryW(request.working_directory.c_str()) == 0) {
+        core::CliServerResponse response{};
+        response.stderr_message = L"Error: Cannot use working directory: ";
+        response.stderr_message += request.working_directory;
+        response.exit_code = To_exit_code(ProcessExitCode::CliOutputPathFailure);
+        return response;
+    }
+    core::CliServerResponse response =
+        core::Run_forwarded_cli_request(app_controller_, request, kDebugBuild);
+    (void)SetCurrentDirectoryW(previous_directory.c_str());
+    (void)Save_app_config(config_);
+    return response;
+}
+
 void GreenflameApp::On_start_capture_requested() {
     (void)overlay_window_.Create_and_show(hinstance_);
 }
@@ -280,6 +364,15 @@ void GreenflameApp::On_copy_last_region_to_clipboard_requested() {
     Show_clipboard_result(result, config_, tray_window_);
 }
 
+void GreenflameApp::On_copy_last_capture_to_clipboard_requested() {
+    if (overlay_window_.Is_open()) {
+        return;
+    }
+    ClipboardCopyResult const result =
+        app_controller_.On_copy_last_capture_to_clipboard_requested();
+    Show_clipboard_result(result, config_, tray_window_);
+}
+
 void GreenflameApp::On_copy_last_window_to_clipboard_requested() {
     if (overlay_window_.Is_open()) {
         return;
@@ -289,6 +382,39 @@ void GreenflameApp::On_copy_last_window_to_clipboard_requested() {
     Show_clipboard_result(result, config_, tray_window_);
 }
 
+void GreenflameApp::On_save_last_capture_requested() {
+    if (overlay_window_.Is_open()) {
+        return;
+    }
+    SelectionSavedResult const result =
+        app_controller_.On_save_last_capture_requested();
+    if (result.file_path.empty()) {
+        tray_window_.Show_balloon(TrayBalloonIcon::Warning,
+                                  result.balloon_message.c_str());
+    } else if (config_.show_balloons) {
+        tray_window_.Show_balloon(TrayBalloonIcon::Info, result.balloon_message.c_str(),
+                                  nullptr, result.file_path);
+    }
+}
+
+void GreenflameApp::On_pin_last_capture_requested() {
+    if (overlay_window_.Is_open()) {
+        return;
+    }
+    std::optional<uint64_t> const id = app_controller_.Last_capture_history_id();
+    GdiCaptureResult capture{};
+    core::RectPx screen_rect = {};
+    if (!id.has_value() ||
+        !capture_service_.Load_history_capture(*id, capture, screen_rect)) {
+        tray_window_.Show_balloon(TrayBalloonIcon::Warning, kNoLastCaptureMessage);
+        return;
+    }
+    if (!pinned_image_manager_.Add_pin(hinstance_, capture, screen_rect, &config_)) {
+        tray_window_.Show_balloon(TrayBalloonIcon::Warning, kPinFailedMessage);
+    }
+    capture.Free();
+}
+
 bool GreenflameApp::Is_include_cursor_enabled() const { return config_.include_cursor; }
 
 bool GreenflameApp::On_set_include_cursor_enabled(bool enabled) {
@@ -315,6 +441,28 @@ bool GreenflameApp::On_set_start_with_windows_enabled(bool enabled) {
     return updated;
 }
 
+bool GreenflameApp::Is_trace_recording_enabled() const {
+    return core::TraceRecorder::Instance().Is_enabled();
+}
+
+void GreenflameApp::On_set_trace_recording_enabled(bool enabled) {
+    core::TraceRecorder &recorder = core::TraceRecorder::Instance();
+    if (enabled) {
+        recorder.Clear();
+        recorder.Set_enabled(true);
+        return;
+    }
+
+    recorder.Set_enabled(false);
+    std::filesystem::path const path = Build_tray_trace_path();
+    if (path.empty() || !Write_trace_file(path)) {
+        tray_window_.Show_balloon(TrayBalloonIcon::Warning, kTraceSaveFailedMessage);
+        return;
+    }
+    tray_window_.Show_balloon(TrayBalloonIcon::Info, kTraceSavedMessage, nullptr,
+                              path.wstring());
+}
+
 void GreenflameApp::On_exit_requested() {
     overlay_window_.Destroy();
     pinned_image_manager_.Close_all();
@@ -325,6 +473,12 @@ void GreenflameApp::On_overlay_closed() {
     // Overlay lifecycle is managed by OverlayWindow; no app action needed.
 }
 
+void GreenflameApp::On_selection_captured(core::RectPx screen_rect,
+                                          std::optional<HWND> window,
+                                          GdiCaptureResult const &capture) {
+    capture_service_.Record_capture(capture, screen_rect, window);
+}
+
 void GreenflameApp::On_selection_copied_to_clipboard(core::RectPx screen_rect,
                                                      std::optional<HWND> window) {
     ClipboardCopyResult const result =
@@ -4,6 +4,8 @@
 #include "greenflame_core/app_controller.h"
 #include "greenflame_core/cli_options.h"
 #include "greenflame_core/process_exit_code.h"
+#include "greenflame_core/trace_recorder.h"
+#include "win/cli_server.h"
 #include "win/overlay_window.h"
 #include "win/pinned_image_manager.h"
 #include "win/tray_window.h"
@@ -12,7 +14,9 @@
 
 namespace greenflame {
 
-class GreenflameApp final : public ITrayEvents, public IOverlayEvents {
+class GreenflameApp final : public ITrayEvents,
+                            public IOverlayEvents,
+                            public core::ICliRequestHandler {
   public:
     explicit GreenflameApp(HINSTANCE hinstance,
                            core::CliOptions const &cli_options = {});
@@ -26,17 +30,26 @@ class GreenflameApp final : public ITrayEvents, public IOverlayEvents {
 
   private:
     [[nodiscard]] ProcessExitCode Run_cli_capture_mode();
+    [[nodiscard]] core::CliServerResponse
+    Handle_cli_request(core::CliServerRequest const &request) override;
     void On_start_capture_requested() override;
     void On_copy_window_to_clipboard_requested(HWND target_window) override;
     void On_copy_monitor_to_clipboard_requested() override;
     void On_copy_desktop_to_clipboard_requested() override;
     void On_copy_last_region_to_clipboard_requested() override;
+    void On_copy_last_capture_to_clipboard_requested() override;
     void On_copy_last_window_to_clipboard_requested() override;
+    void On_save_last_capture_requested() override;
+    void On_pin_last_capture_requested() override;
     [[nodiscard]] bool Is_include_cursor_enabled() const override;
     [[nodiscard]] bool On_set_include_cursor_enabled(bool enabled) override;
     [[nodiscard]] bool On_set_start_with_windows_enabled(bool enabled) override;
+    [[nodiscard]] bool Is_trace_recording_enabled() const override;
+    void On_set_trace_recording_enabled(bool enabled) override;
     void On_exit_requested() override;
     void On_overlay_closed() override;
+    void On_selection_captured(core::RectPx screen_rect, std::optional<HWND> window,
+                               GdiCaptureResult const &capture) override;
     void On_selection_copied_to_clipboard(core::RectPx screen_rect,
                                           std::optional<HWND> window) override;
     bool On_selection_pinned_to_desktop(core::RectPx screen_rect,
@@ -51,6 +64,8 @@ class GreenflameApp final : public ITrayEvents, public IOverlayEvents {
     TrayWindow tray_window_;
     Win32WindowQuery window_query_;
     core::OverlayHelpContent overlay_help_content_ = {};
+    // Shared by overlay saves and controller (tray/CLI) saves.
+    core::SaveDirectoryIndex save_directory_index_ = {};
     OverlayWindow overlay_window_;
     Win32DisplayQueries display_queries_;
     Win32WindowInspector window_inspector_;
@@ -60,6 +75,7 @@ class GreenflameApp final : public ITrayEvents, public IOverlayEvents {
     Win32FileSystemService file_system_service_;
     AppController app_controller_;
     PinnedImageManager pinned_image_manager_;
+    CliPipeServer cli_server_;
     core::CliOptions cli_options_ = {};
     core::AppConfig config_ = {};
 };
@@ -1,8 +1,10 @@
-// Entry point: optional console-detach relaunch, then run GreenflameApp.
+// Entry point: forward CLI captures to a running tray app, optional
+// console-detach relaunch, then run GreenflameApp.
 
 #include "console_output.h"
 #include "greenflame_app.h"
 #include "version_string.h"
+#include "win/cli_server.h"
 #include "win/debug_log.h"
 
 namespace {
@@ -111,6 +113,19 @@ int WINAPI wWinMain(HINSTANCE h_instance, HINSTANCE, PWSTR, int) {
         return greenflame::To_exit_code(greenflame::ProcessExitCode::Success);
     }
 
+    // A running tray app serves captures without this process starting up the
+    // capture stack; when none answers, the capture runs here.
+    if (greenflame::core::Is_cli_server_forwardable(parse_result.options)) {
+        std::optional<greenflame::core::CliServerResponse> const response =
+            greenflame::Try_forward_cli_request(
+                {greenflame::Get_current_directory(), args});
+        if (response.has_value()) {
+            greenflame::Write_console_block(response->stderr_message, true);
+            greenflame::Write_console_block(response->stdout_message, false);
+            return response->exit_code;
+        }
+    }
+
     if (!greenflame::core::Has_cli_render_source(parse_result.options) &&
         GetConsoleWindow() != nullptr) {
         std::wstring command_line = GetCommandLineW();
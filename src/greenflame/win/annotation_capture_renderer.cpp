@@ -36,10 +36,14 @@ Is_highlighter_annotation(core::Annotation const &annotation) noexcept {
            freehand->freehand_tip_shape == core::FreehandTipShape::Square;
 }
 
-[[nodiscard]] core::RectPx
-Annotation_local_bounds(core::Annotation const &annotation,
-                        core::RectPx target_bounds) noexcept {
-    core::RectPx const bounds = core::Annotation_visual_bounds(annotation);
+[[nodiscard]] bool
+Is_dynamic_obfuscate_annotation(core::Annotation const &annotation) noexcept {
+    auto const *obfuscate = std::get_if<core::ObfuscateAnnotation>(&annotation.data);
+    return obfuscate != nullptr && obfuscate->premultiplied_bgra.empty();
+}
+
+[[nodiscard]] core::RectPx To_local_bounds(core::RectPx bounds,
+                                           core::RectPx target_bounds) noexcept {
     return core::RectPx::From_ltrb(
         bounds.left - target_bounds.left, bounds.top - target_bounds.top,
         bounds.right - target_bounds.left, bounds.bottom - target_bounds.top);
@@ -199,9 +203,9 @@ Create_scratch_render_target(IWICImagingFactory *wic_factory, ID2D1Factory *d2d_
 
 } // namespace
 
-bool Render_annotations_into_capture(GdiCaptureResult &capture,
-                                     std::span<const core::Annotation> annotations,
-                                     core::RectPx target_bounds) {
+bool Render_annotations_into_capture(
+    GdiCaptureResult &capture, std::span<const core::Annotation> annotations,
+    core::RectPx target_bounds, std::span<const core::AnnotationSummary> summaries) {
     if (!capture.Is_valid() || annotations.empty()) {
         return true;
     }
@@ -273,13 +277,15 @@ bool Render_annotations_into_capture(GdiCaptureResult &capture,
                                           -static_cast<float>(target_bounds.top));
         D2D1_MATRIX_3X2_F const identity_transform = D2D1::Matrix3x2F::Identity();
 
-        for (core::Annotation const &annotation : annotations) {
-            if (core::ObfuscateAnnotation const *const obfuscate =
-                    std::get_if<core::ObfuscateAnnotation>(&annotation.data);
-                obfuscate != nullptr && obfuscate->premultiplied_bgra.empty()) {
+        bool const use_summaries = summaries.size() == annotations.size();
+        for (size_t index = 0; index < annotations.size(); ++index) {
+            core::Annotation const &annotation = annotations[index];
+            if (Is_dynamic_obfuscate_annotation(annotation)) {
                 std::optional<DynamicObfuscateLayer> const layer =
-                    Build_dynamic_obfuscate_layer(pixels, capture.width, capture.height,
-                                                  row_bytes, *obfuscate, target_bounds);
+                    Build_dynamic_obfuscate_layer(
+                        pixels, capture.width, capture.height, row_bytes,
+                        std::get<core::ObfuscateAnnotation>(annotation.data),
+                        target_bounds);
                 if (!layer.has_value()) {
                     continue;
                 }
@@ -309,8 +315,10 @@ bool Render_annotations_into_capture(GdiCaptureResult &capture,
                 return false;
             }
 
-            core::RectPx const layer_bounds =
-                Annotation_local_bounds(annotation, target_bounds);
+            core::RectPx const layer_bounds = To_local_bounds(
+                use_summaries ? summaries[index].visual_bounds
+                              : core::Annotation_visual_bounds(annotation),
+                target_bounds);
             if (Is_highlighter_annotation(annotation)) {
                 core::Multiply_premultiplied_layer_onto_opaque_pixels(
                     pixels, capture.width, capture.height, row_bytes, layer_pixels,
@@ -338,4 +346,140 @@ bool Render_annotations_into_capture(GdiCaptureResult &capture,
     }
 }
 
+bool Annotations_need_capture_pixels(
+    std::span<const core::Annotation> annotations) noexcept {
+    return std::ranges::any_of(annotations, Is_dynamic_obfuscate_annotation);
+}
+
+bool Rasterize_annotation_layers(std::span<const core::Annotation> annotations,
+                                 core::RectPx target_bounds, int32_t output_width,
+                                 int32_t output_height,
+                                 std::vector<RasterizedAnnotationLayer> &layers) {
+    layers.clear();
+    if (annotations.empty()) {
+        return true;
+    }
+    core::RectPx const output_rect =
+        core::RectPx::From_ltrb(0, 0, output_width, output_height);
+
+    try {
+        // The scratch surface only needs to fit the largest clipped annotation,
+        // not the whole output.
+        std::vector<std::optional<core::RectPx>> clipped_bounds = {};
+        clipped_bounds.reserve(annotations.size());
+        int32_t scratch_width = 0;
+        int32_t scratch_height = 0;
+        for (core::Annotation const &annotation : annotations) {
+            if (Is_dynamic_obfuscate_annotation(annotation)) {
+                LOG_ANNOTATION_CAPTURE_MESSAGE(
+                    L"Rasterize_annotation_layers dynamic obfuscate needs pixels");
+                return false;
+            }
+            std::optional<core::RectPx> const clipped = core::RectPx::Clip(
+                To_local_bounds(core::Annotation_visual_bounds(annotation),
+                                target_bounds),
+                output_rect);
+            if (clipped.has_value()) {
+                scratch_width = std::max(scratch_width, clipped->Width());
+                scratch_height = std::max(scratch_height, clipped->Height());
+            }
+            clipped_bounds.push_back(clipped);
+        }
+        if (scratch_width <= 0 || scratch_height <= 0) {
+            return true;
+        }
+
+        HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+        bool owns_com = SUCCEEDED(hr);
+        if (hr == RPC_E_CHANGED_MODE) {
+            owns_com = false;
+        } else if (FAILED(hr)) {
+            return false;
+        }
+        CoInitGuard const coinit_guard(owns_com);
+
+        Microsoft::WRL::ComPtr<ID2D1Factory1> d2d_factory;
+        hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED,
+                               d2d_factory.GetAddressOf());
+        if (FAILED(hr) || !d2d_factory) {
+            return false;
+        }
+
+        Microsoft::WRL::ComPtr<IWICImagingFactory> wic_factory;
+        hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+                              IID_PPV_ARGS(wic_factory.GetAddressOf()));
+        if (FAILED(hr) || !wic_factory) {
+            return false;
+        }
+
+        Microsoft::WRL::ComPtr<IWICBitmap> scratch_bitmap;
+        Microsoft::WRL::ComPtr<ID2D1RenderTarget> scratch_rt;
+        if (!Create_scratch_render_target(wic_factory.Get(), d2d_factory.Get(),
+                                          scratch_width, scratch_height,
+                                          scratch_bitmap, scratch_rt)) {
+            return false;
+        }
+
+        D2DAnnotationRenderResources annotation_resources{};
+        if (!annotation_resources.Initialize(d2d_factory.Get(), scratch_rt.Get())) {
+            return false;
+        }
+        D2DAnnotationDrawContext const annotation_context =
+            annotation_resources.Build_context(d2d_factory.Get());
+        D2D1_MATRIX_3X2_F const identity_transform = D2D1::Matrix3x2F::Identity();
+
+        layers.reserve(annotations.size());
+        for (size_t index = 0; index < annotations.size(); ++index) {
+            if (!clipped_bounds[index].has_value()) {
+                continue;
+            }
+            core::Annotation const &annotation = annotations[index];
+            core::RectPx const bounds = *clipped_bounds[index];
+
+            scratch_rt->BeginDraw();
+            scratch_rt->SetTransform(identity_transform);
+            scratch_rt->Clear(D2D1::ColorF(0.f, 0.f, 0.f, 0.f));
+            scratch_rt->SetTransform(D2D1::Matrix3x2F::Translation(
+                -static_cast<float>(target_bounds.left + bounds.left),
+                -static_cast<float>(target_bounds.top + bounds.top)));
+            Draw_d2d_annotation(scratch_rt.Get(), annotation_context, annotation);
+            scratch_rt->SetTransform(identity_transform);
+            hr = scratch_rt->EndDraw();
+            if (FAILED(hr)) {
+                return false;
+            }
+
+            RasterizedAnnotationLayer layer{};
+            layer.bounds = bounds;
+            layer.row_bytes = bounds.Width() * 4;
+            layer.blend = Is_highlighter_annotation(annotation)
+                              ? core::ExportLayerBlend::Multiply
+                              : core::ExportLayerBlend::SourceOver;
+            layer.premultiplied_bgra.resize(static_cast<size_t>(layer.row_bytes) *
+                                            static_cast<size_t>(bounds.Height()));
+            WICRect const copy_rect = {0, 0, bounds.Width(), bounds.Height()};
+            hr = scratch_bitmap->CopyPixels(
+                &copy_rect, static_cast<UINT>(layer.row_bytes),
+                static_cast<UINT>(layer.premultiplied_bgra.size()),
+                layer.premultiplied_bgra.data());
+            if (FAILED(hr)) {
+                return false;
+            }
+            layers.push_back(std::move(layer));
+        }
+        return true;
+    } catch (std::bad_alloc const &) {
+        LOG_ANNOTATION_CAPTURE_MESSAGE(
+            L"Rasterize_annotation_layers bad_alloc while allocating layers");
+        return false;
+    } catch (std::exception const &) {
+        LOG_ANNOTATION_CAPTURE_MESSAGE(L"Rasterize_annotation_layers std::exception");
+        return false;
+    } catch (...) {
+        LOG_ANNOTATION_CAPTURE_MESSAGE(
+            L"Rasterize_annotation_layers unexpected exception");
+        return false;
+    }
+}
+
 } // namespace greenflame
@@ -2,12 +2,41 @@
 
 #include "greenflame/win/gdi_capture.h"
 #include "greenflame_core/annotation_types.h"
+#include "greenflame_core/export_compositor.h"
 
 namespace greenflame {
 
+// `summaries`, when parallel to `annotations`, supplies cached visual bounds.
+[[nodiscard]] bool Render_annotations_into_capture(
+    GdiCaptureResult &capture, std::span<const core::Annotation> annotations,
+    core::RectPx target_bounds,
+    std::span<const core::AnnotationSummary> summaries = {});
+
+// One annotation rasterized on its own, cropped to its visual bounds inside the
+// output, for core::Compose_export.
+struct RasterizedAnnotationLayer final {
+    core::RectPx bounds = {};
+    int32_t row_bytes = 0;
+    std::vector<uint8_t> premultiplied_bgra = {};
+    core::ExportLayerBlend blend = core::ExportLayerBlend::SourceOver;
+
+    [[nodiscard]] core::ExportLayer As_export_layer() const noexcept {
+        return {bounds, premultiplied_bgra, row_bytes, blend};
+    }
+};
+
+// True when an annotation is computed from the pixels beneath it (obfuscate
+// without a prepared raster), so it cannot be rasterized as a standalone layer.
+[[nodiscard]] bool
+Annotations_need_capture_pixels(std::span<const core::Annotation> annotations) noexcept;
+
+// Rasterizes each annotation into `layers`, in the pixel space of an output of
+// `output_width` x `output_height` whose top-left is `target_bounds`' top-left.
+// Annotations outside the output produce no layer.
 [[nodiscard]] bool
-Render_annotations_into_capture(GdiCaptureResult &capture,
-                                std::span<const core::Annotation> annotations,
-                                core::RectPx target_bounds);
+Rasterize_annotation_layers(std::span<const core::Annotation> annotations,
+                            core::RectPx target_bounds, int32_t output_width,
+                            int32_t output_height,
+                            std::vector<RasterizedAnnotationLayer> &layers);
 
 } // namespace greenflame
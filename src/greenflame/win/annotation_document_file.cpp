@@ -0,0 +1,100 @@
+#include "win/annotation_document_file.h"
+
+#include "win/mapped_file.h"
+
+namespace greenflame {
+
+namespace {
+
+[[nodiscard]] std::wstring Format_error_code(DWORD error) {
+    LPWSTR buffer = nullptr;
+    DWORD const flags = FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM |
+                        FORMAT_MESSAGE_IGNORE_INSERTS;
+    DWORD const length =
+        FormatMessageW(flags, nullptr, error, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+                       reinterpret_cast<LPWSTR>(&buffer), 0, nullptr);
+    if (length == 0 || buffer == nullptr) {
+        return L"Windows error " + std::to_wstring(error);
+    }
+
+    std::wstring message(buffer, static_cast<size_t>(length));
+    LocalFree(buffer);
+    while (!message.empty() && std::iswspace(message.back()) != 0) {
+        message.pop_back();
+    }
+    return message;
+}
+
+[[nodiscard]] bool Write_all_bytes(HANDLE handle, std::span<const uint8_t> bytes) {
+    size_t written_total = 0;
+    while (written_total < bytes.size()) {
+        std::span<const uint8_t> const remaining = bytes.subspan(written_total);
+        DWORD const chunk_size = static_cast<DWORD>(
+            std::min<size_t>(remaining.size(), static_cast<size_t>(1u << 20)));
+        DWORD written = 0;
+        if (WriteFile(handle, remaining.data(), chunk_size, &written, nullptr) == 0 ||
+            written == 0) {
+            return false;
+        }
+        written_total += written;
+    }
+    return true;
+}
+
+} // namespace
+
+bool Try_save_annotation_document_file(std::wstring_view path,
+                                       core::AnnotationDocument const &document,
+                                       std::wstring &error_message) {
+    error_message.clear();
+    if (path.empty()) {
+        error_message = L"Path is empty.";
+        return false;
+    }
+
+    std::vector<uint8_t> const bytes = core::Encode_annotation_document(document);
+
+    // Written next to the target and swapped in, so a failed save never leaves
+    // a truncated document behind.
+    std::wstring const path_string(path);
+    std::wstring const temp_path = path_string + L".tmp";
+    HANDLE const handle = CreateFileW(temp_path.c_str(), GENERIC_WRITE, 0, nullptr,
+                                      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error_message = Format_error_code(GetLastError());
+        return false;
+    }
+    bool const written = Write_all_bytes(handle, bytes);
+    DWORD const write_error = written ? 0 : GetLastError();
+    CloseHandle(handle);
+    if (!written) {
+        DeleteFileW(temp_path.c_str());
+        error_message = Format_error_code(write_error);
+        return false;
+    }
+
+    if (MoveFileExW(temp_path.c_str(), path_string.c_str(),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) == 0) {
+        error_message = Format_error_code(GetLastError());
+        DeleteFileW(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Try_load_annotation_document_file(std::wstring_view path,
+                                       core::AnnotationDocument &document,
+                                       std::wstring &error_message) {
+    document = {};
+    MappedFile file;
+    if (!file.Open(path, error_message)) {
+        return false;
+    }
+    if (!core::Try_decode_annotation_document(file.Bytes(), document)) {
+        error_message = L"File is not a supported annotation document.";
+        return false;
+    }
+    return true;
+}
+
+} // namespace greenflame
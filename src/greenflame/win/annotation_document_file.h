@@ -0,0 +1,21 @@
+#pragma once
+
+// Saves and reloads an annotation session in the core binary container
+// (greenflame_core/annotation_binary.h). Loading maps the file and decodes in
+// place, so rasterized text, bubble and obfuscate pixels come back without
+// going through IAnnotationPreparationService again.
+
+#include "greenflame_core/annotation_binary.h"
+
+namespace greenflame {
+
+[[nodiscard]] bool
+Try_save_annotation_document_file(std::wstring_view path,
+                                  core::AnnotationDocument const &document,
+                                  std::wstring &error_message);
+
+[[nodiscard]] bool Try_load_annotation_document_file(std::wstring_view path,
+                                                     core::AnnotationDocument &document,
+                                                     std::wstring &error_message);
+
+} // namespace greenflame
@@ -0,0 +1,422 @@
+#include "cli_server.h"
+
+namespace {
+
+constexpr DWORD kPipeBufferBytes = 64 * 1024;
+constexpr DWORD kBusyPipeWaitMs = 2000;
+// Bounds each server-side read or write, so a stalled client cannot hold the
+// single pipe instance.
+constexpr DWORD kServerIoTimeoutMs = 5000;
+
+// Per session, so CLI calls from another logon never reach this tray app.
+[[nodiscard]] std::wstring Build_pipe_name() {
+    DWORD session_id = 0;
+    (void)ProcessIdToSessionId(GetCurrentProcessId(), &session_id);
+    std::wstring name = L"\\\\.\\pipe\\greenflame.cli.";
+    name += std::to_wstring(session_id);
+    return name;
+}
+
+// The TOKEN_USER of `process`; empty when it cannot be read.
+[[nodiscard]] std::vector<uint8_t> Process_user(HANDLE process) {
+    HANDLE token = nullptr;
+    if (OpenProcessToken(process, TOKEN_QUERY, &token) == FALSE) {
+        return {};
+    }
+    std::vector<uint8_t> user = {};
+    DWORD size = 0;
+    (void)GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+    if (size >= sizeof(TOKEN_USER)) {
+        user.resize(size);
+        if (GetTokenInformation(token, TokenUser, user.data(), size, &size) == FALSE) {
+            user.clear();
+        }
+    }
+    CloseHandle(token);
+    return user;
+}
+
+[[nodiscard]] PSID User_sid(std::vector<uint8_t> &token_user) noexcept {
+    return reinterpret_cast<TOKEN_USER *>(token_user.data())->User.Sid;
+}
+
+// A DACL with one entry, the current user, so other accounts cannot open the
+// pipe or create instances of its name. `descriptor` points into `acl`.
+struct CurrentUserPipeSecurity final {
+    std::vector<uint8_t> user = {};
+    std::vector<uint8_t> acl = {};
+    SECURITY_DESCRIPTOR descriptor = {};
+    SECURITY_ATTRIBUTES attributes = {};
+};
+
+[[nodiscard]] bool Try_init_pipe_security(CurrentUserPipeSecurity &security) {
+    security.user = Process_user(GetCurrentProcess());
+    if (security.user.empty()) {
+        return false;
+    }
+    PSID const sid = User_sid(security.user);
+    DWORD const acl_bytes = static_cast<DWORD>(
+        sizeof(ACL) + sizeof(ACCESS_ALLOWED_ACE) - sizeof(DWORD) + GetLengthSid(sid));
+    security.acl.resize(acl_bytes);
+    PACL const acl = reinterpret_cast<PACL>(security.acl.data());
+    if (InitializeAcl(acl, acl_bytes, ACL_REVISION) == FALSE ||
+        AddAccessAllowedAce(acl, ACL_REVISION, FILE_ALL_ACCESS, sid) == FALSE ||
+        InitializeSecurityDescriptor(&security.descriptor,
+                                     SECURITY_DESCRIPTOR_REVISION) == FALSE ||
+        SetSecurityDescriptorDacl(&security.descriptor, TRUE, acl, FALSE) == FALSE) {
+        return false;
+    }
+    security.attributes.nLength = sizeof(security.attributes);
+    security.attributes.lpSecurityDescriptor = &security.descriptor;
+    security.attributes.bInheritHandle = FALSE;
+    return true;
+}
+
+// The pipe name is guessable, so before sending anything (paths, the working
+// directory) the client checks that the server runs as the same user in the same
+// session rather than in a process that took the name first.
+[[nodiscard]] bool Is_trusted_server(HANDLE pipe) {
+    ULONG server_process_id = 0;
+    DWORD own_session = 0;
+    DWORD server_session = 0;
+    if (GetNamedPipeServerProcessId(pipe, &server_process_id) == FALSE ||
+        ProcessIdToSessionId(GetCurrentProcessId(), &own_session) == FALSE ||
+        ProcessIdToSessionId(server_process_id, &server_session) == FALSE ||
+        own_session != server_session) {
+        return false;
+    }
+    HANDLE const server =
+        OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, server_process_id);
+    if (server == nullptr) {
+        return false;
+    }
+    std::vector<uint8_t> server_user = Process_user(server);
+    CloseHandle(server);
+    std::vector<uint8_t> own_user = Process_user(GetCurrentProcess());
+    return !server_user.empty() && !own_user.empty() &&
+           EqualSid(User_sid(server_user), User_sid(own_user)) != FALSE;
+}
+
+class ScopedEvent final {
+  public:
+    ScopedEvent() : handle_(CreateEventW(nullptr, TRUE, FALSE, nullptr)) {}
+    ~ScopedEvent() {
+        if (handle_ != nullptr) {
+            CloseHandle(handle_);
+        }
+    }
+    ScopedEvent(ScopedEvent const &) = delete;
+    ScopedEvent &operator=(ScopedEvent const &) = delete;
+
+    [[nodiscard]] HANDLE Get() const noexcept { return handle_; }
+
+  private:
+    HANDLE handle_ = nullptr;
+};
+
+// Overlapped I/O on the server end, abandoned on timeout or when the stop event
+// is signaled.
+class ServerPipeStream final : public greenflame::core::ICliServerStream {
+  public:
+    ServerPipeStream(HANDLE pipe, HANDLE stop_event) noexcept
+        : pipe_(pipe), stop_event_(stop_event) {}
+
+    [[nodiscard]] bool Read_exact(std::span<uint8_t> buffer) override {
+        while (!buffer.empty()) {
+            DWORD transferred = 0;
+            if (!Transfer(buffer.data(), buffer.size(), false, transferred) ||
+                transferred == 0) {
+                return false;
+            }
+            buffer = buffer.subspan(transferred);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool Write_all(std::span<const uint8_t> bytes) override {
+        while (!bytes.empty()) {
+            DWORD transferred = 0;
+            // WriteFile does not modify the buffer.
+            if (!Transfer(const_cast<uint8_t *>(bytes.data()), bytes.size(), true,
+                          transferred) ||
+                transferred == 0) {
+                return false;
+            }
+            bytes = bytes.subspan(transferred);
+        }
+        return true;
+    }
+
+    // The client closes its end once it has the response; waiting for that keeps
+    // DisconnectNamedPipe from discarding unread bytes.
+    void Wait_for_client_close() {
+        uint8_t byte = 0;
+        DWORD transferred = 0;
+        (void)Transfer(&byte, 1, false, transferred);
+    }
+
+  private:
+    [[nodiscard]] bool Transfer(uint8_t *data, size_t size, bool write,
+                                DWORD &transferred) {
+        if (io_event_.Get() == nullptr) {
+            return false;
+        }
+        OVERLAPPED overlapped{};
+        overlapped.hEvent = io_event_.Get();
+        DWORD const request = static_cast<DWORD>(
+            std::min<size_t>(size, std::numeric_limits<DWORD>::max()));
+        BOOL const started =
+            write ? WriteFile(pipe_, data, request, nullptr, &overlapped)
+                  : ReadFile(pipe_, data, request, nullptr, &overlapped);
+        if (started == FALSE && GetLastError() != ERROR_IO_PENDING) {
+            return false;
+        }
+        std::array<HANDLE, 2> const handles = {io_event_.Get(), stop_event_};
+        DWORD const wait =
+            WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(),
+                                   FALSE, kServerIoTimeoutMs);
+        if (wait != WAIT_OBJECT_0) {
+            CancelIoEx(pipe_, &overlapped);
+        }
+        return GetOverlappedResult(pipe_, &overlapped, &transferred, TRUE) != FALSE &&
+               wait == WAIT_OBJECT_0;
+    }
+
+    HANDLE pipe_ = INVALID_HANDLE_VALUE;
+    HANDLE stop_event_ = nullptr;
+    ScopedEvent io_event_ = {};
+};
+
+// Hands each request to the UI thread and waits for its response.
+class UiThreadHandler final : public greenflame::core::ICliRequestHandler {
+  public:
+    UiThreadHandler(greenflame::core::CliServerRequest &pending_request,
+                    greenflame::core::CliServerResponse &pending_response,
+                    HANDLE request_ready, HANDLE response_ready,
+                    HANDLE stop_event) noexcept
+        : pending_request_(pending_request), pending_response_(pending_response),
+          request_ready_(request_ready), response_ready_(response_ready),
+          stop_event_(stop_event) {}
+
+    [[nodiscard]] greenflame::core::CliServerResponse
+    Handle_cli_request(greenflame::core::CliServerRequest const &request) override {
+        pending_request_ = request;
+        ResetEvent(response_ready_);
+        SetEvent(request_ready_);
+        std::array<HANDLE, 2> const handles = {response_ready_, stop_event_};
+        if (WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(),
+                                   FALSE, INFINITE) != WAIT_OBJECT_0) {
+            return {};
+        }
+        return std::move(pending_response_);
+    }
+
+  private:
+    greenflame::core::CliServerRequest &pending_request_;
+    greenflame::core::CliServerResponse &pending_response_;
+    HANDLE request_ready_ = nullptr;
+    HANDLE response_ready_ = nullptr;
+    HANDLE stop_event_ = nullptr;
+};
+
+// Blocking I/O on the client end.
+class ClientPipeStream final : public greenflame::core::ICliServerStream {
+  public:
+    explicit ClientPipeStream(HANDLE pipe) noexcept : pipe_(pipe) {}
+
+    [[nodiscard]] bool Read_exact(std::span<uint8_t> buffer) override {
+        while (!buffer.empty()) {
+            DWORD read = 0;
+            if (ReadFile(pipe_, buffer.data(), Chunk(buffer.size()), &read, nullptr) ==
+                    FALSE ||
+                read == 0) {
+                return false;
+            }
+            buffer = buffer.subspan(read);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool Write_all(std::span<const uint8_t> bytes) override {
+        while (!bytes.empty()) {
+            DWORD written = 0;
+            if (WriteFile(pipe_, bytes.data(), Chunk(bytes.size()), &written,
+                          nullptr) == FALSE ||
+                written == 0) {
+                return false;
+            }
+            bytes = bytes.subspan(written);
+        }
+        return true;
+    }
+
+  private:
+    [[nodiscard]] static DWORD Chunk(size_t size) noexcept {
+        return static_cast<DWORD>(std::min<size_t>(size, kPipeBufferBytes));
+    }
+
+    HANDLE pipe_ = INVALID_HANDLE_VALUE;
+};
+
+[[nodiscard]] HANDLE Open_client_pipe(std::wstring const &name) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        // Identification level: the server may check who is calling but not act
+        // as the caller.
+        HANDLE const pipe = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+                                        nullptr, OPEN_EXISTING,
+                                        SECURITY_SQOS_PRESENT | SECURITY_IDENTIFICATION,
+                                        nullptr);
+        if (pipe != INVALID_HANDLE_VALUE) {
+            return pipe;
+        }
+        // Another CLI call is being served; wait for the next free instance.
+        if (GetLastError() != ERROR_PIPE_BUSY ||
+            WaitNamedPipeW(name.c_str(), kBusyPipeWaitMs) == FALSE) {
+            break;
+        }
+    }
+    return INVALID_HANDLE_VALUE;
+}
+
+} // namespace
+
+namespace greenflame {
+
+CliPipeServer::~CliPipeServer() { Stop(); }
+
+bool CliPipeServer::Start() {
+    if (pipe_ != INVALID_HANDLE_VALUE) {
+        return true;
+    }
+    CurrentUserPipeSecurity security = {};
+    if (!Try_init_pipe_security(security)) {
+        return false;
+    }
+    std::wstring const name = Build_pipe_name();
+    pipe_ = CreateNamedPipeW(name.c_str(),
+                             PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED |
+                                 FILE_FLAG_FIRST_PIPE_INSTANCE,
+                             PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT |
+                                 PIPE_REJECT_REMOTE_CLIENTS,
+                             1, kPipeBufferBytes, kPipeBufferBytes, 0,
+                             &security.attributes);
+    stop_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    request_ready_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    response_ready_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (pipe_ == INVALID_HANDLE_VALUE || stop_event_ == nullptr ||
+        request_ready_event_ == nullptr || response_ready_event_ == nullptr) {
+        Stop();
+        return false;
+    }
+    try {
+        thread_ = std::thread([this] { Serve_connections(); });
+    } catch (std::system_error const &) {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+void CliPipeServer::Stop() noexcept {
+    if (stop_event_ != nullptr) {
+        SetEvent(stop_event_);
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (HANDLE *event :
+         {&stop_event_, &request_ready_event_, &response_ready_event_}) {
+        if (*event != nullptr) {
+            CloseHandle(*event);
+            *event = nullptr;
+        }
+    }
+    if (pipe_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(pipe_);
+        pipe_ = INVALID_HANDLE_VALUE;
+    }
+}
+
+HANDLE CliPipeServer::Request_ready_event() const noexcept {
+    return thread_.joinable() ? request_ready_event_ : nullptr;
+}
+
+void CliPipeServer::Run_pending_request(core::ICliRequestHandler &handler) {
+    pending_response_ = handler.Handle_cli_request(pending_request_);
+    SetEvent(response_ready_event_);
+}
+
+void CliPipeServer::Serve_connections() {
+    ScopedEvent connect_event;
+    if (connect_event.Get() == nullptr) {
+        return;
+    }
+    UiThreadHandler ui_handler(pending_request_, pending_response_,
+                               request_ready_event_, response_ready_event_,
+                               stop_event_);
+    for (;;) {
+        OVERLAPPED overlapped{};
+        overlapped.hEvent = connect_event.Get();
+        bool connected = ConnectNamedPipe(pipe_, &overlapped) != FALSE;
+        DWORD const connect_error = connected ? ERROR_SUCCESS : GetLastError();
+        if (connect_error == ERROR_PIPE_CONNECTED) {
+            connected = true;
+        } else if (connect_error == ERROR_IO_PENDING) {
+            std::array<HANDLE, 2> const handles = {connect_event.Get(), stop_event_};
+            DWORD const wait = WaitForMultipleObjects(
+                static_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE);
+            if (wait != WAIT_OBJECT_0) {
+                CancelIoEx(pipe_, &overlapped);
+                DWORD ignored = 0;
+                (void)GetOverlappedResult(pipe_, &overlapped, &ignored, TRUE);
+                return;
+            }
+            DWORD ignored = 0;
+            connected =
+                GetOverlappedResult(pipe_, &overlapped, &ignored, FALSE) != FALSE;
+        } else if (connect_error != ERROR_SUCCESS) {
+            return;
+        }
+
+        if (connected) {
+            ServerPipeStream stream(pipe_, stop_event_);
+            if (core::Serve_cli_request(stream, ui_handler)) {
+                stream.Wait_for_client_close();
+            }
+        }
+        DisconnectNamedPipe(pipe_);
+        if (WaitForSingleObject(stop_event_, 0) == WAIT_OBJECT_0) {
+            return;
+        }
+    }
+}
+
+std::optional<core::CliServerResponse>
+Try_forward_cli_request(core::CliServerRequest const &request) {
+    HANDLE const pipe = Open_client_pipe(Build_pipe_name());
+    if (pipe == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+    if (!Is_trusted_server(pipe)) {
+        CloseHandle(pipe);
+        return std::nullopt;
+    }
+    ClientPipeStream stream(pipe);
+    std::optional<core::CliServerResponse> response =
+        core::Forward_cli_request(stream, request);
+    CloseHandle(pipe);
+    return response;
+}
+
+std::wstring Get_current_directory() {
+    DWORD const length = GetCurrentDirectoryW(0, nullptr);
+    if (length == 0) {
+        return {};
+    }
+    std::wstring directory(length, L'\0');
+    DWORD const written = GetCurrentDirectoryW(length, directory.data());
+    directory.resize(written < length ? written : 0);
+    return directory;
+}
+
+} // namespace greenflame
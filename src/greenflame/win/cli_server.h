@@ -0,0 +1,47 @@
+#pragma once
+
+#include "greenflame_core/cli_server_protocol.h"
+
+namespace greenflame {
+
+// The resident tray app's end of the CLI server: a per-session named pipe, open
+// to the current user only, that accepts one forwarded invocation at a time. The
+// pipe is served on a background thread, but requests run on the thread that
+// calls Run_pending_request (the tray message loop) when Request_ready_event is
+// signaled.
+class CliPipeServer final {
+  public:
+    CliPipeServer() = default;
+    ~CliPipeServer();
+    CliPipeServer(CliPipeServer const &) = delete;
+    CliPipeServer &operator=(CliPipeServer const &) = delete;
+
+    // False when the pipe is already owned by another process or cannot be made.
+    [[nodiscard]] bool Start();
+    void Stop() noexcept;
+
+    // Null until Start succeeds.
+    [[nodiscard]] HANDLE Request_ready_event() const noexcept;
+    void Run_pending_request(core::ICliRequestHandler &handler);
+
+  private:
+    void Serve_connections();
+
+    HANDLE pipe_ = INVALID_HANDLE_VALUE;
+    HANDLE stop_event_ = nullptr;
+    HANDLE request_ready_event_ = nullptr;
+    HANDLE response_ready_event_ = nullptr;
+    std::thread thread_ = {};
+    core::CliServerRequest pending_request_ = {};
+    core::CliServerResponse pending_response_ = {};
+};
+
+// Sends the invocation to a running tray app. Nullopt when no server is running,
+// the server is not this user's process in this session, or it did not answer;
+// the caller then runs the invocation itself.
+[[nodiscard]] std::optional<core::CliServerResponse>
+Try_forward_cli_request(core::CliServerRequest const &request);
+
+[[nodiscard]] std::wstring Get_current_directory();
+
+} // namespace greenflame
@@ -47,11 +47,10 @@ constexpr int kBytesPerPixel = 4;
     return SUCCEEDED(hr);
 }
 
-[[nodiscard]] bool
-Upload_capture_bitmap(ID2D1RenderTarget *hwnd_rt, GdiCaptureResult const &cap,
-                      float target_dpi,
-                      Microsoft::WRL::ComPtr<ID2D1Bitmap> &out_bitmap) {
-    if (hwnd_rt == nullptr || !cap.Is_valid()) {
+// Copies the capture into tightly packed, opaque BGRA rows.
+[[nodiscard]] bool Read_capture_pixels(GdiCaptureResult const &cap,
+                                       std::vector<uint8_t> &pixels) {
+    if (!cap.Is_valid()) {
         return false;
     }
 
@@ -72,7 +71,6 @@ Upload_capture_bitmap(ID2D1RenderTarget *hwnd_rt, GdiCaptureResult const &cap,
     }
     size_t const pixel_byte_count = row_bytes_size * height_size;
 
-    std::vector<uint8_t> pixels = {};
     try {
         pixels.resize(pixel_byte_count);
     } catch (std::bad_alloc const &) {
@@ -101,20 +99,119 @@ Upload_capture_bitmap(ID2D1RenderTarget *hwnd_rt, GdiCaptureResult const &cap,
     for (size_t index = 3; index < pixels.size(); index += 4) {
         pixels[index] = 0xFF;
     }
+    return true;
+}
 
+// Creates a bitmap from `bounds` of pixels read by Read_capture_pixels.
+[[nodiscard]] bool
+Create_capture_tile(ID2D1RenderTarget *hwnd_rt, std::span<uint8_t const> pixels,
+                    int capture_width, core::RectPx bounds, float target_dpi,
+                    Microsoft::WRL::ComPtr<ID2D1Bitmap> &out_bitmap) {
     D2D1_BITMAP_PROPERTIES props{};
     props.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
     props.pixelFormat.alphaMode = D2D1_ALPHA_MODE_IGNORE;
     props.dpiX = target_dpi;
     props.dpiY = target_dpi;
 
+    size_t const row_bytes =
+        static_cast<size_t>(capture_width) * static_cast<size_t>(kBytesPerPixel);
+    size_t const offset =
+        static_cast<size_t>(bounds.top) * row_bytes +
+        static_cast<size_t>(bounds.left) * static_cast<size_t>(kBytesPerPixel);
     HRESULT const hr = hwnd_rt->CreateBitmap(
-        D2D1::SizeU(static_cast<UINT32>(width), static_cast<UINT32>(height)),
-        pixels.data(), static_cast<UINT32>(row_bytes), props,
+        D2D1::SizeU(static_cast<UINT32>(bounds.Width()),
+                    static_cast<UINT32>(bounds.Height())),
+        pixels.subspan(offset).data(), static_cast<UINT32>(row_bytes), props,
         out_bitmap.ReleaseAndGetAddressOf());
     return SUCCEEDED(hr);
 }
 
+[[nodiscard]] bool
+Upload_capture_bitmap(ID2D1RenderTarget *hwnd_rt, GdiCaptureResult const &cap,
+                      float target_dpi,
+                      Microsoft::WRL::ComPtr<ID2D1Bitmap> &out_bitmap) {
+    std::vector<uint8_t> pixels = {};
+    if (hwnd_rt == nullptr || !Read_capture_pixels(cap, pixels)) {
+        return false;
+    }
+    return Create_capture_tile(hwnd_rt, pixels, cap.width,
+                               core::RectPx::From_ltrb(0, 0, cap.width, cap.height),
+                               target_dpi, out_bitmap);
+}
+
+// Uploads each tile of `grid` as its own bitmap.
+[[nodiscard]] bool
+Upload_capture_tiles(ID2D1RenderTarget *hwnd_rt, GdiCaptureResult const &cap,
+                     float target_dpi, core::SurfaceTileGrid const &grid,
+                     std::vector<Microsoft::WRL::ComPtr<ID2D1Bitmap>> &out_tiles) {
+    std::vector<uint8_t> pixels = {};
+    if (hwnd_rt == nullptr || !Read_capture_pixels(cap, pixels)) {
+        return false;
+    }
+    out_tiles.resize(grid.Tile_count());
+    for (size_t index = 0; index < out_tiles.size(); ++index) {
+        if (!Create_capture_tile(hwnd_rt, pixels, cap.width, grid.Tile_bounds(index),
+                                 target_dpi, out_tiles[index])) {
+            out_tiles.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rewrites one rect of a bitmap made from `bounds` of the same capture, so a small
+// change to the capture does not re-upload all of it.
+[[nodiscard]] bool Update_capture_bitmap_rect(ID2D1Bitmap *bitmap,
+                                              GdiCaptureResult const &cap,
+                                              core::RectPx bounds, core::RectPx rect) {
+    if (bitmap == nullptr || !cap.Is_valid()) {
+        return false;
+    }
+    D2D1_SIZE_U const size = bitmap->GetPixelSize();
+    if (size.width != static_cast<UINT32>(bounds.Width()) ||
+        size.height != static_cast<UINT32>(bounds.Height()) ||
+        core::RectPx::Intersect(bounds, core::RectPx::From_ltrb(0, 0, cap.width,
+                                                                cap.height)) !=
+            bounds) {
+        return false;
+    }
+    std::optional<core::RectPx> const clipped =
+        core::RectPx::Intersect(rect.Normalized(), bounds);
+    if (!clipped.has_value()) {
+        return true;
+    }
+
+    std::span<uint8_t const> const source = Capture_pixels(cap);
+    if (source.empty()) {
+        return false;
+    }
+    size_t const source_row_bytes = static_cast<size_t>(Row_bytes32(cap.width));
+    size_t const patch_row_bytes =
+        static_cast<size_t>(clipped->Width()) * static_cast<size_t>(kBytesPerPixel);
+    std::vector<uint8_t> patch(patch_row_bytes *
+                               static_cast<size_t>(clipped->Height()));
+    for (int32_t y = clipped->top; y < clipped->bottom; ++y) {
+        size_t const source_offset =
+            static_cast<size_t>(y) * source_row_bytes +
+            static_cast<size_t>(clipped->left) * static_cast<size_t>(kBytesPerPixel);
+        std::copy_n(source.subspan(source_offset, patch_row_bytes).begin(),
+                    patch_row_bytes,
+                    patch.begin() + static_cast<std::ptrdiff_t>(
+                                        static_cast<size_t>(y - clipped->top) *
+                                        patch_row_bytes));
+    }
+    for (size_t index = 3; index < patch.size(); index += 4) {
+        patch[index] = 0xFF;
+    }
+
+    D2D1_RECT_U const destination = {static_cast<UINT32>(clipped->left - bounds.left),
+                                     static_cast<UINT32>(clipped->top - bounds.top),
+                                     static_cast<UINT32>(clipped->right - bounds.left),
+                                     static_cast<UINT32>(clipped->bottom - bounds.top)};
+    return SUCCEEDED(bitmap->CopyFromMemory(&destination, patch.data(),
+                                            static_cast<UINT32>(patch_row_bytes)));
+}
+
 } // namespace
 
 bool D2DOverlayResources::Initialize_factory() {
@@ -191,13 +288,40 @@ bool D2DOverlayResources::Create_hwnd_rt(HWND hwnd, int width, int height) {
         return false;
     }
 
-    // 3. Flip-discard swap chain with a frame-latency waitable. SCALING_STRETCH
-    // tolerates transient size mismatches between WM_SIZE and ResizeBuffers; the
-    // overlay window is fullscreen-borderless and does not perform live resizes,
-    // so the visual difference vs. SCALING_NONE is irrelevant here.
+    // 3. D2D device + device context backed by the same D3D11 device. The
+    // device context becomes the new "hwnd_rt": every Draw_* helper, brush
+    // creator, and offscreen-RT factory in this file already takes an
+    // ID2D1RenderTarget* (or ID2D1DeviceContext*), so swapping the concrete
+    // type here is the entire ripple. It comes before the swap chain so the
+    // chain can be sized to the device's bitmap limit.
+    hr = factory->CreateDevice(dxgi_device.Get(), d2d_device.ReleaseAndGetAddressOf());
+    if (FAILED(hr)) {
+        return false;
+    }
+    hr = d2d_device->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE,
+                                         hwnd_rt.ReleaseAndGetAddressOf());
+    if (FAILED(hr)) {
+        return false;
+    }
+    max_bitmap_px = static_cast<int32_t>(
+        std::min<UINT32>(hwnd_rt->GetMaximumBitmapSize(),
+                         static_cast<UINT32>(std::numeric_limits<int32_t>::max())));
+    // A desktop over the limit still gets a swap chain and cache targets: they
+    // are scaled down to fit and DXGI stretches the chain back over the window.
+    // Lowering the context DPI by the same factor keeps every draw in overlay
+    // pixels; the screenshot itself stays full resolution as tiles.
+    target_fit = core::Fit_surface_to_limit(width, height, max_bitmap_px);
+    float const surface_dpi = Target_dpi() * target_fit.scale;
+    hwnd_rt->SetDpi(surface_dpi, surface_dpi);
+    hwnd_rt->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
+
+    // 4. Flip-discard swap chain with a frame-latency waitable. SCALING_STRETCH
+    // tolerates transient size mismatches between WM_SIZE and ResizeBuffers and
+    // stretches a chain capped by max_bitmap_px over the whole window; the
+    // overlay window is fullscreen-borderless and does not perform live resizes.
     DXGI_SWAP_CHAIN_DESC1 sc_desc{};
-    sc_desc.Width = static_cast<UINT>(width);
-    sc_desc.Height = static_cast<UINT>(height);
+    sc_desc.Width = static_cast<UINT>(target_fit.width);
+    sc_desc.Height = static_cast<UINT>(target_fit.height);
     sc_desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
     sc_desc.Stereo = FALSE;
     sc_desc.SampleDesc.Count = 1;
@@ -229,23 +353,6 @@ bool D2DOverlayResources::Create_hwnd_rt(HWND hwnd, int width, int height) {
     }
     frame_latency_waitable = swap_chain->GetFrameLatencyWaitableObject();
 
-    // 4. D2D device + device context backed by the same D3D11 device. The
-    // device context becomes the new "hwnd_rt": every Draw_* helper, brush
-    // creator, and offscreen-RT factory in this file already takes an
-    // ID2D1RenderTarget* (or ID2D1DeviceContext*), so swapping the concrete
-    // type here is the entire ripple.
-    hr = factory->CreateDevice(dxgi_device.Get(), d2d_device.ReleaseAndGetAddressOf());
-    if (FAILED(hr)) {
-        return false;
-    }
-    hr = d2d_device->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE,
-                                         hwnd_rt.ReleaseAndGetAddressOf());
-    if (FAILED(hr)) {
-        return false;
-    }
-    hwnd_rt->SetDpi(Target_dpi(), Target_dpi());
-    hwnd_rt->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
-
     // 5. Wrap the back buffer surface as an ID2D1Bitmap1 marked TARGET. With
     // BufferCount == 2 + FLIP_DISCARD the same DXGI surface object is reused
     // across Present() calls, so a single CreateBitmapFromDxgiSurface call at
@@ -258,8 +365,8 @@ bool D2DOverlayResources::Create_hwnd_rt(HWND hwnd, int width, int height) {
     D2D1_BITMAP_PROPERTIES1 bp{};
     bp.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
     bp.pixelFormat.alphaMode = D2D1_ALPHA_MODE_IGNORE;
-    bp.dpiX = Target_dpi();
-    bp.dpiY = Target_dpi();
+    bp.dpiX = surface_dpi;
+    bp.dpiY = surface_dpi;
     bp.bitmapOptions = D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW;
     hr = hwnd_rt->CreateBitmapFromDxgiSurface(
         back_surface.Get(), &bp, back_buffer_bitmap.ReleaseAndGetAddressOf());
@@ -295,7 +402,22 @@ bool D2DOverlayResources::Create_hwnd_rt(HWND hwnd, int width, int height) {
 }
 
 bool D2DOverlayResources::Upload_screenshot(GdiCaptureResult const &cap) {
-    return Upload_capture_bitmap(hwnd_rt.Get(), cap, Target_dpi(), screenshot);
+    screenshot.Reset();
+    screenshot_tiles.clear();
+    screenshot_grid = core::SurfaceTileGrid(cap.width, cap.height, max_bitmap_px);
+    if (screenshot_grid.Is_tiled()) {
+        return Upload_capture_tiles(hwnd_rt.Get(), cap, Target_dpi(), screenshot_grid,
+                                    screenshot_tiles);
+    }
+    if (!Upload_capture_bitmap(hwnd_rt.Get(), cap, Target_dpi(), screenshot)) {
+        return false;
+    }
+    screenshot_tiles.push_back(screenshot);
+    return true;
+}
+
+bool D2DOverlayResources::Has_screenshot() const noexcept {
+    return !screenshot_tiles.empty();
 }
 
 bool D2DOverlayResources::Upload_lifted_window_capture(GdiCaptureResult const &cap) {
@@ -303,6 +425,28 @@ bool D2DOverlayResources::Upload_lifted_window_capture(GdiCaptureResult const &c
                                  lifted_window_capture);
 }
 
+bool D2DOverlayResources::Update_screenshot_rect(GdiCaptureResult const &cap,
+                                                 core::RectPx rect) {
+    if (screenshot_tiles.size() != screenshot_grid.Tile_count()) {
+        return false;
+    }
+    for (core::SurfaceTileSpan const &span : screenshot_grid.Split(rect)) {
+        if (!Update_capture_bitmap_rect(screenshot_tiles[span.tile_index].Get(), cap,
+                                        screenshot_grid.Tile_bounds(span.tile_index),
+                                        span.surface_rect)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool D2DOverlayResources::Update_lifted_window_capture_rect(GdiCaptureResult const &cap,
+                                                            core::RectPx rect) {
+    return Update_capture_bitmap_rect(
+        lifted_window_capture.Get(), cap,
+        core::RectPx::From_ltrb(0, 0, cap.width, cap.height), rect);
+}
+
 void D2DOverlayResources::Clear_lifted_window_capture() noexcept {
     lifted_window_capture.Reset();
 }
@@ -524,8 +668,10 @@ bool D2DOverlayResources::Create_cache_targets(int width, int height) {
         return false;
     }
 
-    UINT32 const uw = static_cast<UINT32>(width);
-    UINT32 const uh = static_cast<UINT32>(height);
+    // Sized like the swap chain: the overlay's pixels as DIPs, scaled down to
+    // target_fit when the desktop exceeds the device's bitmap limit.
+    D2D1_SIZE_U const pixel_size = D2D1::SizeU(static_cast<UINT32>(target_fit.width),
+                                               static_cast<UINT32>(target_fit.height));
 
     // annotations_rt: transparent BGRA premultiplied (annotations drawn over nothing).
     {
@@ -533,13 +679,11 @@ bool D2DOverlayResources::Create_cache_targets(int width, int height) {
         D2D1_SIZE_F const size_f =
             D2D1::SizeF(static_cast<float>(width), static_cast<float>(height));
         HRESULT const hr = hwnd_rt->CreateCompatibleRenderTarget(
-            &size_f, nullptr, &pf, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE,
+            &size_f, &pixel_size, &pf, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE,
             annotations_rt.ReleaseAndGetAddressOf());
         if (FAILED(hr)) {
             return false;
         }
-        (void)uw;
-        (void)uh;
     }
 
     // frozen_rt: opaque BGRA (screenshot fills the background completely).
@@ -548,7 +692,7 @@ bool D2DOverlayResources::Create_cache_targets(int width, int height) {
         D2D1_SIZE_F const size_f =
             D2D1::SizeF(static_cast<float>(width), static_cast<float>(height));
         HRESULT const hr = hwnd_rt->CreateCompatibleRenderTarget(
-            &size_f, nullptr, &pf, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE,
+            &size_f, &pixel_size, &pf, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE,
             frozen_rt.ReleaseAndGetAddressOf());
         if (FAILED(hr)) {
             return false;
@@ -561,7 +705,7 @@ bool D2DOverlayResources::Create_cache_targets(int width, int height) {
         D2D1_SIZE_F const size_f =
             D2D1::SizeF(static_cast<float>(width), static_cast<float>(height));
         HRESULT const hr = hwnd_rt->CreateCompatibleRenderTarget(
-            &size_f, nullptr, &pf, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE,
+            &size_f, &pixel_size, &pf, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE,
             draft_stroke_rt.ReleaseAndGetAddressOf());
         if (FAILED(hr)) {
             return false;
@@ -574,7 +718,7 @@ bool D2DOverlayResources::Create_cache_targets(int width, int height) {
         D2D1_SIZE_F const size_f =
             D2D1::SizeF(static_cast<float>(width), static_cast<float>(height));
         HRESULT const hr = hwnd_rt->CreateCompatibleRenderTarget(
-            &size_f, nullptr, &pf, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE,
+            &size_f, &pixel_size, &pf, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE,
             draft_stroke_body_rt.ReleaseAndGetAddressOf());
         if (FAILED(hr)) {
             return false;
@@ -588,10 +732,11 @@ bool D2DOverlayResources::Create_cache_targets(int width, int height) {
         D2D1_BITMAP_PROPERTIES pf{};
         pf.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
         pf.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
-        pf.dpiX = Target_dpi();
-        pf.dpiY = Target_dpi();
+        float const surface_dpi = Target_dpi() * target_fit.scale;
+        pf.dpiX = surface_dpi;
+        pf.dpiY = surface_dpi;
         HRESULT const hr =
-            hwnd_rt->CreateBitmap(D2D1::SizeU(uw, uh), nullptr, 0, pf,
+            hwnd_rt->CreateBitmap(pixel_size, nullptr, 0, pf,
                                   base_composite_bitmap.ReleaseAndGetAddressOf());
         if (FAILED(hr)) {
             return false;
@@ -649,6 +794,8 @@ void D2DOverlayResources::Invalidate_frozen() noexcept { frozen_valid = false; }
 
 void D2DOverlayResources::Release_device_resources() {
     screenshot.Reset();
+    screenshot_tiles.clear();
+    screenshot_grid = {};
     lifted_window_capture.Reset();
     annotations_rt.Reset();
     frozen_rt.Reset();
@@ -4,6 +4,7 @@
 #include "greenflame/win/overlay_button.h"
 #include "greenflame_core/annotation_types.h"
 #include "greenflame_core/freehand_smoothing.h"
+#include "greenflame_core/surface_tiling.h"
 #include "greenflame_core/text_annotation_types.h"
 
 namespace greenflame {
@@ -12,7 +13,11 @@ namespace greenflame {
 // Lifetime: created once per overlay session; released when the overlay closes.
 //
 // Layer model:
-//   screenshot    — uploaded once at capture time, never redrawn
+//   screenshot    — uploaded once at capture time; only the captured cursor's
+//                   rect is rewritten when it is toggled. Split into tiles when
+//                   the capture exceeds the device's maximum bitmap size; the
+//                   swap chain and the caches below are single surfaces scaled
+//                   down to fit it instead (see target_fit)
 //   annotations   — rebuilt on annotation commit/undo/redo/delete
 //   frozen        — rebuilt when selection or annotations change
 //   draft_stroke  — rebuilt during freehand gesture from raw or split-tail preview
@@ -45,6 +50,11 @@ struct D2DOverlayResources final {
     // pipeline never builds frames faster than DWM consumes them.
     HANDLE frame_latency_waitable = nullptr;
     float target_dpi = kDefaultTargetDpi;
+    // Largest bitmap side the device accepts; queried in Create_hwnd_rt.
+    int32_t max_bitmap_px = core::kDefaultMaxSurfaceTilePx;
+    // Pixel size of the swap chain and cache targets, and the device context's
+    // DPI scale: the overlay size unless it exceeds max_bitmap_px.
+    core::SurfaceFit target_fit = {};
     // ArithmeticComposite effect (k1=1, k2=k3=k4=0) for multiply-blend highlighting.
     // Null until Create_hwnd_rt succeeds and ID2D1DeviceContext QI is available.
     Microsoft::WRL::ComPtr<ID2D1Effect> multiply_effect;
@@ -59,7 +69,13 @@ struct D2DOverlayResources final {
     Microsoft::WRL::ComPtr<ID2D1Effect> base_composite_effect;
 
     // Per-session bitmaps
+    // The whole capture when it fits in one bitmap, else null: effect inputs need
+    // a single image, so the highlighter multiply falls back to a plain blit.
     Microsoft::WRL::ComPtr<ID2D1Bitmap> screenshot;
+    // The capture as tiles of screenshot_grid (one tile aliasing `screenshot` when
+    // it fits). Draw through these so oversized desktops still render.
+    core::SurfaceTileGrid screenshot_grid = {};
+    std::vector<Microsoft::WRL::ComPtr<ID2D1Bitmap>> screenshot_tiles = {};
     Microsoft::WRL::ComPtr<ID2D1Bitmap> lifted_window_capture;
     Microsoft::WRL::ComPtr<ID2D1BitmapRenderTarget> annotations_rt;
     Microsoft::WRL::ComPtr<ID2D1BitmapRenderTarget> frozen_rt;
@@ -141,15 +157,23 @@ struct D2DOverlayResources final {
     // Create (or recreate) the HwndRenderTarget. Call after Initialize_factory.
     [[nodiscard]] bool Create_hwnd_rt(HWND hwnd, int width, int height);
 
-    // Upload the GDI capture as a D2D bitmap.
+    // Upload the GDI capture as a D2D bitmap, tiled by max_bitmap_px.
     [[nodiscard]] bool Upload_screenshot(GdiCaptureResult const &cap);
+    [[nodiscard]] bool Has_screenshot() const noexcept;
     [[nodiscard]] bool Upload_lifted_window_capture(GdiCaptureResult const &cap);
+    // Refresh only `rect` of an uploaded capture after it changed in place (the
+    // captured cursor being shown or hidden).
+    [[nodiscard]] bool Update_screenshot_rect(GdiCaptureResult const &cap,
+                                              core::RectPx rect);
+    [[nodiscard]] bool Update_lifted_window_capture_rect(GdiCaptureResult const &cap,
+                                                         core::RectPx rect);
     void Clear_lifted_window_capture() noexcept;
 
     // Create device-dependent shared resources (brushes, stroke styles, text formats).
     [[nodiscard]] bool Create_shared_resources();
 
-    // Create the annotations and frozen off-screen bitmap render targets.
+    // Create the annotations and frozen off-screen bitmap render targets, width x
+    // height in DIPs and target_fit in pixels. Call after Create_hwnd_rt.
     [[nodiscard]] bool Create_cache_targets(int width, int height);
 
     // Upload toolbar glyph alpha masks as D2D bitmaps, indexed by
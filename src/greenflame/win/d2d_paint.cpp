@@ -42,10 +42,37 @@ constexpr float kSpellSquiggleHalfPeriodPx = 2.0f;
 constexpr float kSpellSquiggleStrokeWidthPx = 1.0f;
 constexpr UINT32 kSpellSquiggleHitTestInitialCapacity = 8u;
 
-void Draw_clipped_screenshot_rect(ID2D1RenderTarget *rt, ID2D1Bitmap *screenshot,
+// Draws `source_rect` of the screenshot into `dest`, one DrawBitmap per screenshot
+// tile it touches, so captures larger than the device's maximum bitmap size work.
+void Draw_screenshot_rect(ID2D1RenderTarget *rt, D2DOverlayResources const &res,
+                          D2D1_RECT_F dest, core::RectPx source_rect) {
+    if (rt == nullptr || source_rect.Is_empty() ||
+        res.screenshot_tiles.size() != res.screenshot_grid.Tile_count()) {
+        return;
+    }
+
+    float const scale_x =
+        (dest.right - dest.left) / static_cast<float>(source_rect.Width());
+    float const scale_y =
+        (dest.bottom - dest.top) / static_cast<float>(source_rect.Height());
+    for (core::SurfaceTileSpan const &span : res.screenshot_grid.Split(source_rect)) {
+        core::RectPx const part = span.surface_rect;
+        D2D1_RECT_F const part_dest = D2D1::RectF(
+            dest.left + static_cast<float>(part.left - source_rect.left) * scale_x,
+            dest.top + static_cast<float>(part.top - source_rect.top) * scale_y,
+            dest.left + static_cast<float>(part.right - source_rect.left) * scale_x,
+            dest.top + static_cast<float>(part.bottom - source_rect.top) * scale_y);
+        D2D1_RECT_F const local_f = Rect(span.local_rect);
+        rt->DrawBitmap(res.screenshot_tiles[span.tile_index].Get(), part_dest, 1.f,
+                       D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, local_f);
+    }
+}
+
+void Draw_clipped_screenshot_rect(ID2D1RenderTarget *rt,
+                                  D2DOverlayResources const &res,
                                   core::RectPx restore_rect, int vd_width,
                                   int vd_height) {
-    if (rt == nullptr || screenshot == nullptr || restore_rect.Is_empty()) {
+    if (rt == nullptr || !res.Has_screenshot() || restore_rect.Is_empty()) {
         return;
     }
 
@@ -55,9 +82,7 @@ void Draw_clipped_screenshot_rect(ID2D1RenderTarget *rt, ID2D1Bitmap *screenshot
         return;
     }
 
-    D2D1_RECT_F const visible_f = Rect(*clipped);
-    rt->DrawBitmap(screenshot, visible_f, 1.f,
-                   D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, visible_f);
+    Draw_screenshot_rect(rt, res, Rect(*clipped), *clipped);
 }
 
 void Draw_bitmap_rect(ID2D1RenderTarget *rt, ID2D1Bitmap *bitmap,
@@ -608,7 +633,7 @@ void Draw_magnifier(ID2D1RenderTarget *rt, D2DOverlayResources &res,
                     int vd_height) {
     GREENFLAME_PROFILE_FUNCTION();
 
-    if (!res.screenshot || !res.factory) {
+    if (!res.Has_screenshot() || !res.factory) {
         return;
     }
 
@@ -750,11 +775,9 @@ void Draw_magnifier(ID2D1RenderTarget *rt, D2DOverlayResources &res,
         float const dst_h = static_cast<float>((sample_b - sample_t) * kMagnifierZoom);
         D2D1_RECT_F const dst_f =
             D2D1::RectF(dst_l, dst_t, dst_l + dst_w, dst_t + dst_h);
-        D2D1_RECT_F const src_f =
-            D2D1::RectF(static_cast<float>(sample_l), static_cast<float>(sample_t),
-                        static_cast<float>(sample_r), static_cast<float>(sample_b));
-        rt->DrawBitmap(res.screenshot.Get(), dst_f, 1.f,
-                       D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR, src_f);
+        Draw_screenshot_rect(
+            rt, res, dst_f,
+            core::RectPx::From_ltrb(sample_l, sample_t, sample_r, sample_b));
     }
 
     // Crosshair arms (semi-transparent black body, white contour).
@@ -2746,6 +2769,7 @@ void Draw_live_layer(ID2D1RenderTarget *rt, D2DOverlayResources &res,
 // can be used as a scratch surface.
 void Draw_annotations_to_rt(ID2D1RenderTarget *rt, D2DOverlayResources &res,
                             std::span<const core::Annotation> annotations,
+                            std::span<const core::AnnotationSummary> summaries,
                             std::span<const AnnotationPreviewPatch> patches,
                             std::optional<uint64_t> skip_id) {
     GREENFLAME_PROFILE_SCOPE("D2DPaint::Draw_annotations_to_rt");
@@ -2800,7 +2824,10 @@ void Draw_annotations_to_rt(ID2D1RenderTarget *rt, D2DOverlayResources &res,
                 use_cached_body ? Alpha_from_opacity_percent(fh.style.opacity_percent)
                                 : 1.0f;
             core::RectPx const highlighter_bounds =
-                core::Annotation_visual_bounds(ann).Normalized();
+                (patch == nullptr && i < summaries.size()
+                     ? summaries[i].visual_bounds
+                     : core::Annotation_visual_bounds(ann))
+                    .Normalized();
             if (highlighter_bounds.Is_empty()) {
                 continue;
             }
@@ -2908,6 +2935,7 @@ void Draw_annotations_to_rt(ID2D1RenderTarget *rt, D2DOverlayResources &res,
 
 void Rebuild_annotations_bitmap(D2DOverlayResources &res,
                                 std::span<const core::Annotation> annotations,
+                                std::span<const core::AnnotationSummary> summaries,
                                 std::span<const AnnotationPreviewPatch> patches,
                                 std::optional<uint64_t> skip_id) {
     GREENFLAME_PROFILE_SCOPE("D2DPaint::Rebuild_annotations_bitmap");
@@ -2918,8 +2946,8 @@ void Rebuild_annotations_bitmap(D2DOverlayResources &res,
 
     res.annotations_rt->BeginDraw();
     res.annotations_rt->Clear(D2D1::ColorF(0.f, 0.f, 0.f, 0.f));
-    Draw_annotations_to_rt(res.annotations_rt.Get(), res, annotations, patches,
-                           skip_id);
+    Draw_annotations_to_rt(res.annotations_rt.Get(), res, annotations, summaries,
+                           patches, skip_id);
 
     HRESULT const hr = res.annotations_rt->EndDraw();
     if (SUCCEEDED(hr)) {
@@ -2933,7 +2961,7 @@ void Rebuild_frozen_bitmap(D2DOverlayResources &res, core::RectPx selection,
                            int vd_width, int vd_height) {
     GREENFLAME_PROFILE_SCOPE("D2DPaint::Rebuild_frozen_bitmap");
 
-    if (!res.frozen_rt || !res.screenshot || !res.annotations_bitmap) {
+    if (!res.frozen_rt || !res.Has_screenshot() || !res.annotations_bitmap) {
         return;
     }
 
@@ -2941,7 +2969,8 @@ void Rebuild_frozen_bitmap(D2DOverlayResources &res, core::RectPx selection,
                                          static_cast<float>(vd_height));
 
     res.frozen_rt->BeginDraw();
-    res.frozen_rt->DrawBitmap(res.screenshot.Get());
+    Draw_screenshot_rect(res.frozen_rt.Get(), res, full,
+                         core::RectPx::From_ltrb(0, 0, vd_width, vd_height));
 
     // Composite committed annotations before dimming so the dim sits on top of them.
     res.frozen_rt->DrawBitmap(res.annotations_bitmap.Get());
@@ -2953,8 +2982,8 @@ void Rebuild_frozen_bitmap(D2DOverlayResources &res, core::RectPx selection,
     // Restore the selection area undimmed: screenshot then annotations, both
     // clipped so nothing outside the selection punches through the dim.
     if (!selection.Is_empty()) {
-        Draw_clipped_screenshot_rect(res.frozen_rt.Get(), res.screenshot.Get(),
-                                     selection, vd_width, vd_height);
+        Draw_clipped_screenshot_rect(res.frozen_rt.Get(), res, selection, vd_width,
+                                     vd_height);
         res.frozen_rt->PushAxisAlignedClip(Rect(selection),
                                            D2D1_ANTIALIAS_MODE_ALIASED);
         res.frozen_rt->DrawBitmap(res.annotations_bitmap.Get());
@@ -3035,9 +3064,8 @@ bool Paint_d2d_frame(D2DOverlayResources &res, D2DPaintInput const &input, int v
         // selection restore.
         D2D1_RECT_F const full = D2D1::RectF(0.f, 0.f, static_cast<float>(vd_width),
                                              static_cast<float>(vd_height));
-        if (res.screenshot) {
-            res.hwnd_rt->DrawBitmap(res.screenshot.Get());
-        }
+        Draw_screenshot_rect(res.hwnd_rt.Get(), res, full,
+                             core::RectPx::From_ltrb(0, 0, vd_width, vd_height));
 
         // Composite annotations before dimming so the dim sits on top of them.
         if (res.annotations_bitmap) {
@@ -3066,9 +3094,9 @@ bool Paint_d2d_frame(D2DOverlayResources &res, D2DPaintInput const &input, int v
                 Draw_bitmap_rect(res.hwnd_rt.Get(), input.lifted_window_bitmap,
                                  input.lifted_window_dest_rect,
                                  input.lifted_window_source_rect);
-            } else if (res.screenshot) {
-                Draw_clipped_screenshot_rect(res.hwnd_rt.Get(), res.screenshot.Get(),
-                                             restore_rect, vd_width, vd_height);
+            } else {
+                Draw_clipped_screenshot_rect(res.hwnd_rt.Get(), res, restore_rect,
+                                             vd_width, vd_height);
             }
         }
         if (!restore_rect.Is_empty()) {
@@ -102,9 +102,12 @@ struct D2DPaintInput {
 
 // Rebuild the annotations off-screen bitmap from committed annotations.
 // Sets res.annotations_valid = true on success.
+// summaries: the document's cached summaries for `annotations`, or empty to
+// compute bounds from the payloads.
 // patches: optional per-index overrides for the obfuscate preview path.
 void Rebuild_annotations_bitmap(D2DOverlayResources &res,
                                 std::span<const core::Annotation> annotations,
+                                std::span<const core::AnnotationSummary> summaries = {},
                                 std::span<const AnnotationPreviewPatch> patches = {},
                                 std::optional<uint64_t> skip_id = std::nullopt);
 
@@ -10,6 +10,9 @@ constexpr float kLayoutMaxExtentPx = 32768.0f;
 constexpr float kRoundToNearestOffsetPx = 0.5f;
 constexpr float kColorChannelMaxF = 255.0f;
 constexpr wchar_t kEmptyLayoutPlaceholder[] = L"M";
+// Horizontal margin around each bubble digit cell, as a fraction of the font
+// size, for glyphs that overhang their advance.
+constexpr float kBubbleDigitMarginFraction = 0.25f;
 struct ScopedCoInit final {
     ScopedCoInit() = default;
     ScopedCoInit(ScopedCoInit const &) = delete;
@@ -89,15 +92,16 @@ Resolve_text_font_family(core::TextAnnotationBaseStyle const &base_style,
 }
 
 [[nodiscard]] std::wstring_view
-Resolve_text_font_family(core::BubbleAnnotation const &annotation,
-                         std::array<std::wstring, 4> const &font_families) noexcept {
-    if (!annotation.font_family.empty()) {
-        return annotation.font_family;
+Resolve_bubble_font_family(core::TextFontChoice font_choice,
+                           std::wstring_view font_family,
+                           std::array<std::wstring, 4> const &font_families) noexcept {
+    if (!font_family.empty()) {
+        return font_family;
     }
 
-    size_t const family_index = core::Text_font_choice_index(annotation.font_choice);
+    size_t const family_index = core::Text_font_choice_index(font_choice);
     return font_families[family_index].empty()
-               ? Default_font_family(annotation.font_choice)
+               ? Default_font_family(font_choice)
                : std::wstring_view(font_families[family_index]);
 }
 
@@ -275,6 +279,24 @@ Insertion_offset_from_hit_test(DWRITE_HIT_TEST_METRICS const &metrics,
                       text_length);
 }
 
+// Caret x for every offset in [0, text_length], one hit test per offset.
+[[nodiscard]] bool Measure_caret_positions(IDWriteTextLayout *layout,
+                                           int32_t text_length,
+                                           std::vector<float> &caret_x_px) {
+    caret_x_px.resize(static_cast<size_t>(text_length) + 1);
+    for (int32_t offset = 0; offset <= text_length; ++offset) {
+        float caret_x = 0.0f;
+        float caret_y = 0.0f;
+        DWRITE_HIT_TEST_METRICS metrics{};
+        if (FAILED(layout->HitTestTextPosition(static_cast<UINT32>(offset), FALSE,
+                                               &caret_x, &caret_y, &metrics))) {
+            return false;
+        }
+        caret_x_px[static_cast<size_t>(offset)] = caret_x;
+    }
+    return true;
+}
+
 } // namespace
 
 D2DTextLayoutEngine::D2DTextLayoutEngine(ID2D1Factory *d2d_factory,
@@ -288,16 +310,27 @@ void D2DTextLayoutEngine::Set_font_families(std::array<std::wstring_view, 4> fam
         std::wstring_view const family = families[index].empty()
                                              ? core::kDefaultTextFontFamilies[index]
                                              : families[index];
-        font_families_[index].assign(family);
+        if (font_families_[index] != family) {
+            font_families_[index].assign(family);
+            ++font_generation_;
+        }
     }
 }
 
 void D2DTextLayoutEngine::Set_target_dpi(float dpi) noexcept {
-    target_dpi_ = dpi > 0.0f ? dpi : kDefaultTargetDpi;
+    float const target_dpi = dpi > 0.0f ? dpi : kDefaultTargetDpi;
+    if (target_dpi != target_dpi_) {
+        target_dpi_ = target_dpi;
+        ++font_generation_;
+    }
 }
 
 float D2DTextLayoutEngine::Target_dpi() const noexcept { return target_dpi_; }
 
+uint64_t D2DTextLayoutEngine::Font_generation() const noexcept {
+    return font_generation_;
+}
+
 int32_t D2DTextLayoutEngine::Line_ascent(core::TextAnnotationBaseStyle const &style) {
     Microsoft::WRL::ComPtr<IDWriteTextFormat> format =
         Create_text_format(dwrite_factory_, style, font_families_);
@@ -549,6 +582,81 @@ int32_t D2DTextLayoutEngine::Move_vertical(core::TextDraftBuffer const &buf,
     return Insertion_offset_from_hit_test(hit_metrics, trailing_hit, text_length);
 }
 
+bool D2DTextLayoutEngine::Measure_paragraph(core::TextAnnotationBaseStyle const &style,
+                                            std::span<const core::TextRun> runs,
+                                            core::TextParagraphMetrics &out) {
+    out = {};
+    if (dwrite_factory_ == nullptr) {
+        return false;
+    }
+
+    Microsoft::WRL::ComPtr<IDWriteTextFormat> format;
+    Microsoft::WRL::ComPtr<IDWriteTextLayout> layout;
+    int32_t const text_length = Flattened_text_length(runs);
+    if (text_length == 0) {
+        // Blank lines take the height of the placeholder glyph, as in
+        // Build_draft_layout.
+        if (!Build_placeholder_layout(dwrite_factory_, style, font_families_, format,
+                                      layout)) {
+            return false;
+        }
+    } else {
+        LayoutBuildData data{};
+        if (!Build_text_layout(dwrite_factory_, style, runs, font_families_, format,
+                               layout, data)) {
+            return false;
+        }
+    }
+
+    DWRITE_LINE_METRICS line_metrics{};
+    UINT32 line_count = 0;
+    if (FAILED(layout->GetLineMetrics(&line_metrics, 1, &line_count)) ||
+        line_count != 1) {
+        return false;
+    }
+    out.height_px = line_metrics.height;
+
+    float caret_x = 0.0f;
+    float caret_y = 0.0f;
+    DWRITE_HIT_TEST_METRICS metrics{};
+    if (FAILED(layout->HitTestTextPosition(0, FALSE, &caret_x, &caret_y, &metrics))) {
+        return false;
+    }
+    out.caret_x_px.assign(static_cast<size_t>(text_length) + 1, caret_x);
+    if (text_length == 0) {
+        return true;
+    }
+
+    // One cluster-metrics call per paragraph: the caret before each cluster is
+    // the running sum of advances, and offsets inside a multi-unit cluster
+    // (surrogate pairs, combining marks) snap to its leading edge as
+    // HitTestTextPosition does.
+    UINT32 cluster_count = 0;
+    HRESULT hr = layout->GetClusterMetrics(nullptr, 0, &cluster_count);
+    if (hr != HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER) || cluster_count == 0) {
+        return false;
+    }
+    std::vector<DWRITE_CLUSTER_METRICS> clusters(cluster_count);
+    if (FAILED(layout->GetClusterMetrics(clusters.data(), cluster_count,
+                                         &cluster_count))) {
+        return false;
+    }
+    size_t offset = 0;
+    for (DWRITE_CLUSTER_METRICS const &cluster : clusters) {
+        if (cluster.isRightToLeft) {
+            // Bidi runs are not in visual order here; ask DirectWrite per offset.
+            return Measure_caret_positions(layout.Get(), text_length, out.caret_x_px);
+        }
+        for (UINT16 unit = 0; unit < cluster.length && offset < out.caret_x_px.size();
+             ++unit) {
+            out.caret_x_px[offset++] = caret_x;
+        }
+        caret_x += cluster.width;
+    }
+    out.caret_x_px.back() = caret_x;
+    return true;
+}
+
 bool D2DTextLayoutEngine::Prepare_for_cli(core::TextAnnotation &annotation) {
     if (dwrite_factory_ == nullptr || !Text_runs_have_text(annotation.runs)) {
         return false;
@@ -713,13 +821,11 @@ void D2DTextLayoutEngine::Rasterize_bubble(core::BubbleAnnotation &annotation) {
 
     COLORREF const text_color = core::Bubble_text_color(annotation.color);
 
-    // Font size: fraction of diameter in DIP units. Larger fraction for 1-2 digits.
     int32_t const n = annotation.counter_value;
-    float const font_fraction = (n >= 100) ? 0.38f : 0.55f;
-    float const font_size_dip = font_fraction * fd;
+    float const font_size_dip = core::Bubble_counter_font_size(d, n);
 
-    std::wstring_view const family =
-        Resolve_text_font_family(annotation, font_families_);
+    std::wstring_view const family = Resolve_bubble_font_family(
+        annotation.font_choice, annotation.font_family, font_families_);
     std::wstring const family_name(family);
 
     Microsoft::WRL::ComPtr<IDWriteTextFormat> format;
@@ -803,4 +909,122 @@ void D2DTextLayoutEngine::Rasterize_bubble(core::BubbleAnnotation &annotation) {
     }
 }
 
+bool D2DTextLayoutEngine::Rasterize_bubble_digits(core::TextFontChoice font_choice,
+                                                  std::wstring_view font_family,
+                                                  float font_size_dip,
+                                                  core::BubbleDigitAtlas &out) {
+    out = {};
+    if (d2d_factory_ == nullptr || dwrite_factory_ == nullptr ||
+        !(font_size_dip > 0.0f)) {
+        return false;
+    }
+
+    std::wstring const family_name(
+        Resolve_bubble_font_family(font_choice, font_family, font_families_));
+    Microsoft::WRL::ComPtr<IDWriteTextFormat> format;
+    HRESULT hr = dwrite_factory_->CreateTextFormat(
+        family_name.c_str(), nullptr, DWRITE_FONT_WEIGHT_BOLD, DWRITE_FONT_STYLE_NORMAL,
+        DWRITE_FONT_STRETCH_NORMAL, font_size_dip, L"", format.GetAddressOf());
+    if (FAILED(hr) || !format) {
+        return false;
+    }
+    (void)format->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP);
+
+    // Lay out every digit first so one bitmap fits the widest of them. Glyphs
+    // may overhang their advance, so cells get a margin on both sides.
+    float const scale = Target_dpi() / kDefaultTargetDpi;
+    std::array<Microsoft::WRL::ComPtr<IDWriteTextLayout>, 10> layouts = {};
+    float max_advance_dip = 0.0f;
+    float line_height_dip = 0.0f;
+    for (size_t digit = 0; digit < layouts.size(); ++digit) {
+        wchar_t const ch = static_cast<wchar_t>(L'0' + digit);
+        hr = dwrite_factory_->CreateTextLayout(&ch, 1, format.Get(), kLayoutMaxExtentPx,
+                                               kLayoutMaxExtentPx,
+                                               layouts[digit].GetAddressOf());
+        DWRITE_TEXT_METRICS metrics{};
+        if (FAILED(hr) || !layouts[digit] ||
+            FAILED(layouts[digit]->GetMetrics(&metrics))) {
+            return false;
+        }
+        out.digits[digit].advance_px = metrics.widthIncludingTrailingWhitespace * scale;
+        max_advance_dip =
+            std::max(max_advance_dip, metrics.widthIncludingTrailingWhitespace);
+        line_height_dip = std::max(line_height_dip, metrics.height);
+    }
+    out.line_height_px = line_height_dip * scale;
+
+    int32_t const margin_px =
+        Ceil_to_int(font_size_dip * kBubbleDigitMarginFraction * scale);
+    int32_t const cell_width = Ceil_to_int(max_advance_dip * scale) + margin_px * 2;
+    int32_t const cell_height = Ceil_to_int(out.line_height_px);
+    if (cell_width <= 0 || cell_height <= 0) {
+        return false;
+    }
+
+    ScopedCoInit const co_init = Ensure_com_initialized();
+    (void)co_init;
+
+    Microsoft::WRL::ComPtr<IWICImagingFactory> wic_factory;
+    hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+                          IID_PPV_ARGS(&wic_factory));
+    if (FAILED(hr) || !wic_factory) {
+        return false;
+    }
+    Microsoft::WRL::ComPtr<IWICBitmap> wic_bitmap;
+    hr = wic_factory->CreateBitmap(static_cast<UINT>(cell_width),
+                                   static_cast<UINT>(cell_height),
+                                   GUID_WICPixelFormat32bppPBGRA, WICBitmapCacheOnLoad,
+                                   wic_bitmap.GetAddressOf());
+    if (FAILED(hr) || !wic_bitmap) {
+        return false;
+    }
+    D2D1_RENDER_TARGET_PROPERTIES const rt_props = D2D1::RenderTargetProperties(
+        D2D1_RENDER_TARGET_TYPE_DEFAULT,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+        Target_dpi(), Target_dpi());
+    Microsoft::WRL::ComPtr<ID2D1RenderTarget> render_target;
+    hr = d2d_factory_->CreateWicBitmapRenderTarget(wic_bitmap.Get(), rt_props,
+                                                   render_target.GetAddressOf());
+    if (FAILED(hr) || !render_target) {
+        return false;
+    }
+    render_target->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+    Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> brush;
+    hr = render_target->CreateSolidColorBrush(D2D1::ColorF(1.0f, 1.0f, 1.0f, 1.0f),
+                                              brush.GetAddressOf());
+    if (FAILED(hr) || !brush) {
+        return false;
+    }
+
+    // White on transparent: alpha is the glyph coverage.
+    UINT const row_bytes = static_cast<UINT>(cell_width) * 4u;
+    std::vector<uint8_t> pixels(static_cast<size_t>(row_bytes) *
+                                static_cast<size_t>(cell_height));
+    WICRect const rect = {0, 0, cell_width, cell_height};
+    for (size_t digit = 0; digit < layouts.size(); ++digit) {
+        render_target->BeginDraw();
+        render_target->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
+        render_target->DrawTextLayout(
+            D2D1::Point2F(static_cast<float>(margin_px) / scale, 0.0f),
+            layouts[digit].Get(), brush.Get());
+        if (FAILED(render_target->EndDraw()) ||
+            FAILED(wic_bitmap->CopyPixels(&rect, row_bytes,
+                                          static_cast<UINT>(pixels.size()),
+                                          pixels.data()))) {
+            out = {};
+            return false;
+        }
+        core::BubbleDigitGlyph &glyph = out.digits[digit];
+        glyph.offset_x_px = -margin_px;
+        glyph.width_px = cell_width;
+        glyph.height_px = cell_height;
+        glyph.coverage.resize(static_cast<size_t>(cell_width) *
+                              static_cast<size_t>(cell_height));
+        for (size_t pixel = 0; pixel < glyph.coverage.size(); ++pixel) {
+            glyph.coverage[pixel] = pixels[pixel * 4u + 3u];
+        }
+    }
+    return true;
+}
+
 } // namespace greenflame
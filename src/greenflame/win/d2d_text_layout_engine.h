@@ -25,9 +25,17 @@ class D2DTextLayoutEngine final : public core::ITextLayoutEngine {
                                         core::PointPx origin, int32_t offset,
                                         int delta_lines,
                                         int32_t preferred_x_px) override;
-    [[nodiscard]] bool Prepare_for_cli(core::TextAnnotation &annotation);
+    [[nodiscard]] bool Measure_paragraph(core::TextAnnotationBaseStyle const &style,
+                                         std::span<const core::TextRun> runs,
+                                         core::TextParagraphMetrics &out) override;
+    [[nodiscard]] bool Prepare_for_cli(core::TextAnnotation &annotation) override;
     void Rasterize(core::TextAnnotation &annotation) override;
     void Rasterize_bubble(core::BubbleAnnotation &annotation) override;
+    [[nodiscard]] uint64_t Font_generation() const noexcept override;
+    [[nodiscard]] bool Rasterize_bubble_digits(core::TextFontChoice font_choice,
+                                               std::wstring_view font_family,
+                                               float font_size_dip,
+                                               core::BubbleDigitAtlas &out) override;
 
   private:
     static constexpr float kDefaultTargetDpi = 96.0f;
@@ -35,6 +43,7 @@ class D2DTextLayoutEngine final : public core::ITextLayoutEngine {
     IDWriteFactory *dwrite_factory_ = nullptr;
     std::array<std::wstring, 4> font_families_ = {};
     float target_dpi_ = kDefaultTargetDpi;
+    uint64_t font_generation_ = 0;
 };
 
 } // namespace greenflame
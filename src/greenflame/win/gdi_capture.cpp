@@ -4,6 +4,9 @@
 
 #include "gdi_capture.h"
 #include "greenflame_core/bmp.h"
+#include "greenflame_core/image_resample.h"
+#include "greenflame_core/parallel_for.h"
+#include "greenflame_core/pixel_ops.h"
 #include "greenflame_core/rect_px.h"
 #include "win/display_queries.h"
 
@@ -69,6 +72,21 @@ void Fill_bmi32_top_down(BITMAPINFOHEADER &bmi, int width, int height) {
 
 int Row_bytes32(int width) { return (width * 4 + 3) & ~3; }
 
+std::span<uint8_t> Capture_pixels(GdiCaptureResult const &capture) {
+    GdiFlush();
+    DIBSECTION section = {};
+    if (!capture.Is_valid() ||
+        GetObjectW(capture.bitmap, sizeof(section), &section) != sizeof(section) ||
+        section.dsBm.bmBits == nullptr) {
+        return {};
+    }
+    size_t const row_bytes = static_cast<size_t>(Row_bytes32(capture.width));
+    CLANG_WARN_IGNORE_PUSH("-Wunsafe-buffer-usage-in-container")
+    return std::span<uint8_t>{reinterpret_cast<uint8_t *>(section.dsBm.bmBits),
+                              row_bytes * static_cast<size_t>(capture.height)};
+    CLANG_WARN_IGNORE_POP()
+}
+
 void GdiCaptureResult::Free() noexcept {
     if (bitmap) {
         DeleteObject(bitmap);
@@ -499,6 +517,36 @@ bool Composite_cursor_snapshot(CapturedCursorSnapshot const &cursor_snapshot,
     return ok;
 }
 
+bool Render_cursor_image(CapturedCursorSnapshot const &cursor_snapshot,
+                         core::CursorImage &out) {
+    out = {};
+    if (!cursor_snapshot.Is_valid()) {
+        return false;
+    }
+
+    int const width = cursor_snapshot.image_width;
+    int const height = cursor_snapshot.image_height;
+    // A target whose origin sits at hotspot - offset receives the image at (0, 0).
+    core::PointPx const image_origin_px = {
+        cursor_snapshot.hotspot_screen_px.x - cursor_snapshot.hotspot_offset_px.x,
+        cursor_snapshot.hotspot_screen_px.y - cursor_snapshot.hotspot_offset_px.y};
+    GdiCaptureResult on_black = {};
+    GdiCaptureResult on_white = {};
+    bool ok = Create_solid_capture(width, height, RGB(0, 0, 0), on_black) &&
+              Create_solid_capture(width, height, RGB(255, 255, 255), on_white) &&
+              Composite_cursor_snapshot(cursor_snapshot, image_origin_px, on_black) &&
+              Composite_cursor_snapshot(cursor_snapshot, image_origin_px, on_white);
+    if (ok) {
+        out = core::Cursor_image_from_black_and_white_renders(
+            Capture_pixels(on_black), Capture_pixels(on_white), width, height,
+            Row_bytes32(width), cursor_snapshot.hotspot_offset_px);
+        ok = out.Is_valid();
+    }
+    on_black.Free();
+    on_white.Free();
+    return ok;
+}
+
 HBITMAP Scale_bitmap_to_thumbnail(HBITMAP src_bitmap, int src_width, int src_height,
                                   int max_width, int max_height) {
     float const scale_w = static_cast<float>(max_width) / static_cast<float>(src_width);
@@ -511,33 +559,42 @@ HBITMAP Scale_bitmap_to_thumbnail(HBITMAP src_bitmap, int src_width, int src_hei
     int const tw = std::max(1, static_cast<int>(static_cast<float>(src_width) * scale));
     int const th =
         std::max(1, static_cast<int>(static_cast<float>(src_height) * scale));
-    HBITMAP result = nullptr;
     HDC const screen_dc = GetDC(nullptr);
-    if (screen_dc != nullptr) {
-        HDC const src_dc = CreateCompatibleDC(screen_dc);
-        HDC const dst_dc = CreateCompatibleDC(screen_dc);
-        result = CreateCompatibleBitmap(screen_dc, tw, th);
-        if (src_dc != nullptr && dst_dc != nullptr && result != nullptr) {
-            HGDIOBJ const old_src = SelectObject(src_dc, src_bitmap);
-            HGDIOBJ const old_dst = SelectObject(dst_dc, result);
-            SetStretchBltMode(dst_dc, HALFTONE);
-            SetBrushOrgEx(dst_dc, 0, 0, nullptr);
-            StretchBlt(dst_dc, 0, 0, tw, th, src_dc, 0, 0, src_width, src_height,
-                       SRCCOPY);
-            SelectObject(dst_dc, old_dst);
-            SelectObject(src_dc, old_src);
-        } else if (result != nullptr) {
-            DeleteObject(result);
-            result = nullptr;
-        }
-        if (dst_dc != nullptr) {
-            DeleteDC(dst_dc);
-        }
-        if (src_dc != nullptr) {
-            DeleteDC(src_dc);
+    if (screen_dc == nullptr) {
+        return nullptr;
+    }
+
+    // Read any bitmap (clipboard bitmaps are often device-dependent) as top-down
+    // BGRA, filter it in core and hand back a screen-compatible bitmap as before.
+    core::BgraBitmap source = {};
+    source.width_px = src_width;
+    source.height_px = src_height;
+    source.row_bytes = Row_bytes32(src_width);
+    source.premultiplied_bgra.resize(static_cast<size_t>(source.row_bytes) *
+                                     static_cast<size_t>(src_height));
+    BITMAPINFOHEADER info;
+    Fill_bmi32_top_down(info, src_width, src_height);
+    HBITMAP result = nullptr;
+    if (GetDIBits(screen_dc, src_bitmap, 0, static_cast<UINT>(src_height),
+                  source.premultiplied_bgra.data(),
+                  reinterpret_cast<BITMAPINFO *>(&info), DIB_RGB_COLORS) != 0) {
+        core::Force_alpha_opaque(source.premultiplied_bgra);
+        std::optional<core::BgraBitmap> const thumbnail =
+            core::Resample_bitmap(source, tw, th, core::ResampleFilter::Lanczos3,
+                                  core::Default_parallel_workers());
+        if (thumbnail.has_value()) {
+            result = CreateCompatibleBitmap(screen_dc, tw, th);
+            Fill_bmi32_top_down(info, tw, th);
+            if (result != nullptr &&
+                SetDIBits(screen_dc, result, 0, static_cast<UINT>(th),
+                          thumbnail->premultiplied_bgra.data(),
+                          reinterpret_cast<BITMAPINFO *>(&info), DIB_RGB_COLORS) == 0) {
+                DeleteObject(result);
+                result = nullptr;
+            }
         }
-        ReleaseDC(nullptr, screen_dc);
     }
+    ReleaseDC(nullptr, screen_dc);
     return result;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "greenflame_core/cursor_layer.h"
 #include "greenflame_core/rect_px.h"
 
 // Phase 3.1: GDI full-screen capture of the virtual desktop.
@@ -80,12 +81,23 @@ bool Composite_cursor_snapshot(CapturedCursorSnapshot const &cursor_snapshot,
                                core::PointPx target_origin_px,
                                GdiCaptureResult &target);
 
+// Draws a captured cursor over black and over white and recovers it as a
+// premultiplied core::CursorImage (with an invert mask for monochrome cursors), so
+// it can be composited into pixels without GDI. Returns false when it cannot draw.
+bool Render_cursor_image(CapturedCursorSnapshot const &cursor_snapshot,
+                         core::CursorImage &out);
+
 // --- Helpers for 32bpp top-down DIB (used by capture and bitmap interop) ---
 void Fill_bmi32_top_down(BITMAPINFOHEADER &bmi, int width, int height);
 int Row_bytes32(int width);
 
+// The top-down 32bpp pixels of a DIB-section capture (every capture made here is
+// one); empty when they cannot be reached. GDI work is flushed first.
+[[nodiscard]] std::span<uint8_t> Capture_pixels(GdiCaptureResult const &capture);
+
 // Scales src_bitmap to fit within max_width x max_height (preserving aspect
-// ratio). Returns an HBITMAP the caller must DeleteObject, or nullptr on failure.
+// ratio) with the core Lanczos resampler. Returns an HBITMAP the caller must
+// DeleteObject, or nullptr on failure.
 [[nodiscard]] HBITMAP Scale_bitmap_to_thumbnail(HBITMAP src_bitmap, int src_width,
                                                 int src_height, int max_width,
                                                 int max_height);
@@ -0,0 +1,104 @@
+#include "win/mapped_file.h"
+
+namespace greenflame {
+
+namespace {
+
+[[nodiscard]] std::wstring Format_last_error_message() {
+    DWORD const error = GetLastError();
+    LPWSTR buffer = nullptr;
+    DWORD const flags = FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM |
+                        FORMAT_MESSAGE_IGNORE_INSERTS;
+    DWORD const length =
+        FormatMessageW(flags, nullptr, error, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+                       reinterpret_cast<LPWSTR>(&buffer), 0, nullptr);
+    if (length == 0 || buffer == nullptr) {
+        return L"Windows error " + std::to_wstring(error);
+    }
+
+    std::wstring message(buffer, static_cast<size_t>(length));
+    LocalFree(buffer);
+    while (!message.empty() && std::iswspace(message.back()) != 0) {
+        message.pop_back();
+    }
+    return message;
+}
+
+} // namespace
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(std::wstring_view path, std::wstring &error_message) {
+    Close();
+    error_message.clear();
+    if (path.empty()) {
+        error_message = L"Path is empty.";
+        return false;
+    }
+
+    std::wstring const path_string(path);
+    file_ = CreateFileW(path_string.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        error_message = Format_last_error_message();
+        return false;
+    }
+
+    LARGE_INTEGER file_size = {};
+    if (GetFileSizeEx(file_, &file_size) == 0) {
+        error_message = Format_last_error_message();
+        Close();
+        return false;
+    }
+    if (file_size.QuadPart < 0 || static_cast<uint64_t>(file_size.QuadPart) >
+                                      std::numeric_limits<size_t>::max()) {
+        error_message = L"File is too large.";
+        Close();
+        return false;
+    }
+    // CreateFileMappingW rejects zero-length files; they simply have no bytes.
+    if (file_size.QuadPart == 0) {
+        return true;
+    }
+
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        error_message = Format_last_error_message();
+        Close();
+        return false;
+    }
+    view_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (view_ == nullptr) {
+        error_message = Format_last_error_message();
+        Close();
+        return false;
+    }
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close() noexcept {
+    if (view_ != nullptr) {
+        UnmapViewOfFile(view_);
+        view_ = nullptr;
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+    size_ = 0;
+}
+
+std::span<const uint8_t> MappedFile::Bytes() const noexcept {
+    if (view_ == nullptr) {
+        return {};
+    }
+    return {static_cast<uint8_t const *>(view_), size_};
+}
+
+} // namespace greenflame
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace greenflame {
+
+// Read-only view of a whole file mapped into memory. The view stays valid
+// until the object is destroyed or re-opened; empty files map to an empty span.
+class MappedFile final {
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    [[nodiscard]] bool Open(std::wstring_view path, std::wstring &error_message);
+    void Close() noexcept;
+
+    [[nodiscard]] std::span<const uint8_t> Bytes() const noexcept;
+
+  private:
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+    void const *view_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace greenflame
@@ -7,14 +7,17 @@
 #include "greenflame_core/app_config.h"
 #include "greenflame_core/modification_command.h"
 #include "greenflame_core/monitor_rules.h"
+#include "greenflame_core/parallel_for.h"
 #include "greenflame_core/pixel_ops.h"
 #include "greenflame_core/profiling.h"
 #include "greenflame_core/rect_px.h"
 #include "greenflame_core/save_image_policy.h"
 #include "greenflame_core/selection_handles.h"
 #include "greenflame_core/snap_to_edges.h"
+#include "greenflame_core/stage_graph.h"
 #include "greenflame_core/text_html.h"
 #include "greenflame_core/text_rtf.h"
+#include "greenflame_core/toolbar_glyph_masks.h"
 #include "greenflame_core/toolbar_placement.h"
 #include "greenflame_core/window_query.h"
 #include "win/d2d_overlay_resources.h"
@@ -33,25 +36,12 @@ constexpr int32_t kSnapThresholdPx = 10;
 constexpr int kToolbarButtonSizePx = 36;
 constexpr int kToolbarButtonSeparatorPx = 9; // size / 4
 constexpr int kAnnotationToolCursorResourceId = 102;
-constexpr int kBrushToolGlyphResourceId = 103;
-constexpr int kHighlighterToolGlyphResourceId = 104;
-constexpr int kLineToolGlyphResourceId = 105;
-constexpr int kArrowToolGlyphResourceId = 106;
-constexpr int kRectangleToolGlyphResourceId = 107;
-constexpr int kFilledRectangleToolGlyphResourceId = 108;
-constexpr int kEllipseToolGlyphResourceId = 109;
-constexpr int kFilledEllipseToolGlyphResourceId = 110;
-constexpr int kObfuscateToolGlyphResourceId = 111;
-constexpr int kHelpToolGlyphResourceId = 112;
-constexpr int kTextToolGlyphResourceId = 113;
-constexpr int kBubbleToolGlyphResourceId = 114;
-constexpr int kCursorToolGlyphResourceId = 115;
-constexpr int kPinToolGlyphResourceId = 116;
 constexpr UINT_PTR kBrushSizeOverlayTimerId = 1;
 constexpr UINT_PTR kCaretBlinkTimerId = 2;
 constexpr UINT_PTR kHighlighterStraightenTimerId = 3;
 constexpr UINT_PTR kSelectedAnnotationMarqueeTimerId = 4;
 constexpr UINT kSelectedAnnotationMarqueeTimerIntervalMs = 60;
+constexpr UINT kContentSnapEdgesReadyMessage = WM_APP + 1;
 constexpr int32_t kSelectedAnnotationMarqueePhaseStepPx = 1;
 constexpr wchar_t kPinToDesktopFailedMessage[] =
     L"Failed to pin the selection to the desktop.";
@@ -102,28 +92,39 @@ Text_annotation_has_text(greenflame::core::TextAnnotation const &annotation) noe
     return false;
 }
 
-struct ToolbarGlyphResourceSpec final {
+struct ToolbarGlyphSpec final {
     greenflame::OverlayToolbarGlyphId glyph = greenflame::OverlayToolbarGlyphId::None;
-    int resource_id = 0;
+    greenflame::core::ToolbarGlyphMaskId mask = {};
 };
 
-constexpr std::array<ToolbarGlyphResourceSpec, 14> kToolbarGlyphResourceSpecs = {{
-    {greenflame::OverlayToolbarGlyphId::Brush, kBrushToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Highlighter, kHighlighterToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Line, kLineToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Arrow, kArrowToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Rectangle, kRectangleToolGlyphResourceId},
+constexpr std::array<ToolbarGlyphSpec, 14> kToolbarGlyphSpecs = {{
+    {greenflame::OverlayToolbarGlyphId::Brush,
+     greenflame::core::ToolbarGlyphMaskId::Brush},
+    {greenflame::OverlayToolbarGlyphId::Highlighter,
+     greenflame::core::ToolbarGlyphMaskId::Highlighter},
+    {greenflame::OverlayToolbarGlyphId::Line,
+     greenflame::core::ToolbarGlyphMaskId::Line},
+    {greenflame::OverlayToolbarGlyphId::Arrow,
+     greenflame::core::ToolbarGlyphMaskId::Arrow},
+    {greenflame::OverlayToolbarGlyphId::Rectangle,
+     greenflame::core::ToolbarGlyphMaskId::Rectangle},
     {greenflame::OverlayToolbarGlyphId::FilledRectangle,
-     kFilledRectangleToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Ellipse, kEllipseToolGlyphResourceId},
+     greenflame::core::ToolbarGlyphMaskId::FilledRectangle},
+    {greenflame::OverlayToolbarGlyphId::Ellipse,
+     greenflame::core::ToolbarGlyphMaskId::Ellipse},
     {greenflame::OverlayToolbarGlyphId::FilledEllipse,
-     kFilledEllipseToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Obfuscate, kObfuscateToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Text, kTextToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Bubble, kBubbleToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Cursor, kCursorToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Pin, kPinToolGlyphResourceId},
-    {greenflame::OverlayToolbarGlyphId::Help, kHelpToolGlyphResourceId},
+     greenflame::core::ToolbarGlyphMaskId::FilledEllipse},
+    {greenflame::OverlayToolbarGlyphId::Obfuscate,
+     greenflame::core::ToolbarGlyphMaskId::Obfuscate},
+    {greenflame::OverlayToolbarGlyphId::Text,
+     greenflame::core::ToolbarGlyphMaskId::Text},
+    {greenflame::OverlayToolbarGlyphId::Bubble,
+     greenflame::core::ToolbarGlyphMaskId::Bubble},
+    {greenflame::OverlayToolbarGlyphId::Cursor,
+     greenflame::core::ToolbarGlyphMaskId::Cursor},
+    {greenflame::OverlayToolbarGlyphId::Pin, greenflame::core::ToolbarGlyphMaskId::Pin},
+    {greenflame::OverlayToolbarGlyphId::Help,
+     greenflame::core::ToolbarGlyphMaskId::Help},
 }};
 
 [[nodiscard]] HBITMAP
@@ -231,42 +232,26 @@ Capture_bounds_screen(greenflame::core::PointPx origin,
         origin.x, origin.y, origin.x + capture.width, origin.y + capture.height);
 }
 
-[[nodiscard]] bool Rebuild_capture_display(
-    greenflame::GdiCaptureResult const &base_capture,
-    std::optional<greenflame::CapturedCursorSnapshot> const &captured_cursor,
-    bool include_captured_cursor, greenflame::core::PointPx capture_origin_px,
-    greenflame::GdiCaptureResult &display_capture) {
-    if (!base_capture.Is_valid()) {
+// Shows or hides a capture's cursor layer in place; `changed` receives the rect whose
+// pixels changed. False when the capture's pixels cannot be reached.
+[[nodiscard]] bool Sync_cursor_layer(greenflame::core::CursorLayer &layer,
+                                     greenflame::GdiCaptureResult const &capture,
+                                     bool visible, greenflame::core::RectPx &changed) {
+    changed = {};
+    if (!capture.Is_valid()) {
         return false;
     }
-
-    int const width = base_capture.width;
-    int const height = base_capture.height;
-    if (display_capture.Is_valid() && display_capture.width == width &&
-        display_capture.height == height) {
-        if (!greenflame::Blit_capture(base_capture, 0, 0, width, height,
-                                      display_capture, 0, 0)) {
-            display_capture.Free();
-            return false;
-        }
-    } else {
-        display_capture.Free();
-        if (!greenflame::Crop_capture(base_capture, 0, 0, width, height,
-                                      display_capture)) {
-            return false;
-        }
+    if (!layer.Has_image() || layer.Is_shown() == visible) {
+        return true;
     }
 
-    if (include_captured_cursor && captured_cursor.has_value()) {
-        auto const &captured_cursor_value = captured_cursor.value();
-        if (captured_cursor_value.Is_valid() &&
-            !greenflame::Composite_cursor_snapshot(
-                captured_cursor_value, capture_origin_px, display_capture)) {
-            display_capture.Free();
-            return false;
-        }
+    std::span<uint8_t> const pixels = greenflame::Capture_pixels(capture);
+    if (pixels.empty()) {
+        return false;
     }
-
+    int const row_bytes = greenflame::Row_bytes32(capture.width);
+    changed = visible ? layer.Show(pixels, capture.width, capture.height, row_bytes)
+                      : layer.Hide(pixels, capture.width, capture.height, row_bytes);
     return true;
 }
 
@@ -457,143 +442,17 @@ Text_navigation_action_for_key(WPARAM wparam, bool ctrl) noexcept {
     return normalized;
 }
 
-template <typename T> struct ComPtr {
-    T *p = nullptr;
-
-    ComPtr() = default;
-    ~ComPtr() {
-        if (p != nullptr) {
-            p->Release();
-        }
-    }
-
-    ComPtr(ComPtr const &) = delete;
-    ComPtr &operator=(ComPtr const &) = delete;
-
-    T **operator&() { return &p; }
-    T *operator->() const { return p; }
-    explicit operator bool() const { return p != nullptr; }
-};
-
-struct CoInitGuard {
-    bool owned = false;
-
-    explicit CoInitGuard(bool owns) : owned(owns) {}
-    ~CoInitGuard() {
-        if (owned) {
-            CoUninitialize();
-        }
-    }
-
-    CoInitGuard(CoInitGuard const &) = delete;
-    CoInitGuard &operator=(CoInitGuard const &) = delete;
-};
-
 [[nodiscard]] std::shared_ptr<greenflame::OverlayButtonGlyph>
-Load_png_resource_alpha_mask(HINSTANCE hinstance, int resource_id) {
-    if (hinstance == nullptr) {
-        return {};
-    }
-
-    HRSRC const resource_info =
-        FindResourceW(hinstance, MAKEINTRESOURCEW(resource_id), RT_RCDATA);
-    if (resource_info == nullptr) {
-        return {};
-    }
-    DWORD const resource_size = SizeofResource(hinstance, resource_info);
-    if (resource_size == 0) {
-        return {};
-    }
-    HGLOBAL const resource_handle = LoadResource(hinstance, resource_info);
-    if (resource_handle == nullptr) {
-        return {};
-    }
-    void const *const resource_data = LockResource(resource_handle);
-    if (resource_data == nullptr) {
-        return {};
-    }
-
-    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-    bool coinit = SUCCEEDED(hr);
-    if (hr == RPC_E_CHANGED_MODE) {
-        coinit = false;
-    } else if (FAILED(hr)) {
+Make_toolbar_glyph(greenflame::core::ToolbarGlyphMaskId mask_id) {
+    greenflame::core::ToolbarGlyphMask const mask =
+        greenflame::core::Toolbar_glyph_mask(mask_id);
+    if (!mask.Is_valid()) {
         return {};
     }
-    CoInitGuard const co_guard(coinit);
-
-    ComPtr<IWICImagingFactory> factory;
-    hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
-                          IID_PPV_ARGS(&factory));
-    if (FAILED(hr) || !factory) {
-        return {};
-    }
-
-    ComPtr<IWICStream> stream;
-    hr = factory->CreateStream(&stream);
-    if (FAILED(hr) || !stream) {
-        return {};
-    }
-
-    BYTE *const stream_bytes =
-        const_cast<BYTE *>(static_cast<BYTE const *>(resource_data));
-    hr = stream->InitializeFromMemory(stream_bytes, resource_size);
-    if (FAILED(hr)) {
-        return {};
-    }
-
-    ComPtr<IWICBitmapDecoder> decoder;
-    hr = factory->CreateDecoderFromStream(stream.p, nullptr,
-                                          WICDecodeMetadataCacheOnLoad, &decoder);
-    if (FAILED(hr) || !decoder) {
-        return {};
-    }
-
-    ComPtr<IWICBitmapFrameDecode> frame;
-    hr = decoder->GetFrame(0, &frame);
-    if (FAILED(hr) || !frame) {
-        return {};
-    }
-
-    UINT width = 0;
-    UINT height = 0;
-    hr = frame->GetSize(&width, &height);
-    if (FAILED(hr) || width == 0 || height == 0) {
-        return {};
-    }
-
-    ComPtr<IWICFormatConverter> converter;
-    hr = factory->CreateFormatConverter(&converter);
-    if (FAILED(hr) || !converter) {
-        return {};
-    }
-    hr = converter->Initialize(frame.p, GUID_WICPixelFormat32bppBGRA,
-                               WICBitmapDitherTypeNone, nullptr, 0.0,
-                               WICBitmapPaletteTypeCustom);
-    if (FAILED(hr)) {
-        return {};
-    }
-
-    UINT const stride = width * 4;
-    size_t const buffer_size =
-        static_cast<size_t>(stride) * static_cast<size_t>(height);
-    std::vector<uint8_t> pixels(buffer_size);
-    hr = converter->CopyPixels(nullptr, stride, static_cast<UINT>(pixels.size()),
-                               pixels.data());
-    if (FAILED(hr)) {
-        return {};
-    }
-
     auto glyph = std::make_shared<greenflame::OverlayButtonGlyph>();
-    glyph->width = static_cast<int>(width);
-    glyph->height = static_cast<int>(height);
-    glyph->alpha_mask.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
-    for (size_t i = 0; i < glyph->alpha_mask.size(); ++i) {
-        glyph->alpha_mask[i] = pixels[i * 4 + 3];
-    }
-    if (!glyph->Is_valid()) {
-        return {};
-    }
+    glyph->width = mask.width;
+    glyph->height = mask.height;
+    glyph->alpha_mask.assign(mask.alpha.begin(), mask.alpha.end());
     return glyph;
 }
 
@@ -655,6 +514,52 @@ Build_preview_obfuscate_annotation(
     return annotation;
 }
 
+[[nodiscard]] std::wstring Build_input_trace_file_name() {
+    SYSTEMTIME time = {};
+    GetLocalTime(&time);
+    auto const two_digits = [](WORD value) {
+        std::wstring text = std::to_wstring(value);
+        return text.size() < 2 ? L"0" + text : text;
+    };
+    std::wstring name = L"overlay-input-";
+    name += std::to_wstring(time.wYear);
+    name += two_digits(time.wMonth);
+    name += two_digits(time.wDay);
+    name += L"-";
+    name += two_digits(time.wHour);
+    name += two_digits(time.wMinute);
+    name += two_digits(time.wSecond);
+    name += L".gfit";
+    return name;
+}
+
+// "name=begin..end" in microseconds from the start of the graph; `*` marks a
+// stage that ran on a worker.
+[[nodiscard, maybe_unused]] std::wstring
+Format_startup_stage_timings(greenflame::core::StageGraphResult const &result) {
+    std::wstring message =
+        L"Startup stages total_us=" + std::to_wstring(result.total_ns / 1000);
+    for (greenflame::core::StageTiming const &stage : result.stages) {
+        std::string_view const name = stage.name;
+        message += L" " + std::wstring(name.begin(), name.end()) + L"=";
+        switch (stage.status) {
+        case greenflame::core::StageStatus::Succeeded:
+            message += std::to_wstring(stage.begin_ns / 1000) + L".." +
+                       std::to_wstring(stage.end_ns / 1000) +
+                       (stage.ran_on_caller ? L"" : L"*");
+            break;
+        case greenflame::core::StageStatus::Failed:
+            message += L"failed";
+            break;
+        case greenflame::core::StageStatus::Pending:
+        case greenflame::core::StageStatus::Skipped:
+            message += L"skipped";
+            break;
+        }
+    }
+    return message;
+}
+
 } // namespace
 
 namespace greenflame {
@@ -663,7 +568,7 @@ struct OverlayWindow::OverlayResources {
     struct WindowCaptureState final {
         HWND window = nullptr;
         GdiCaptureResult base_capture = {};
-        GdiCaptureResult display_capture = {};
+        core::CursorLayer cursor_layer = {};
         core::RectPx capture_rect_screen = {};
         core::RectPx visible_rect_screen = {};
         core::PointPx visible_offset_px = {};
@@ -672,7 +577,7 @@ struct OverlayWindow::OverlayResources {
         void Reset() noexcept {
             window = nullptr;
             base_capture.Free();
-            display_capture.Free();
+            cursor_layer = {};
             capture_rect_screen = {};
             visible_rect_screen = {};
             visible_offset_px = {};
@@ -680,9 +585,12 @@ struct OverlayWindow::OverlayResources {
         }
     };
 
+    // Holds the captured cursor whenever it is shown; cursor_layer keeps the
+    // pixels it covers.
     GdiCaptureResult base_capture = {};
-    GdiCaptureResult display_capture = {};
-    std::optional<CapturedCursorSnapshot> captured_cursor = std::nullopt;
+    core::CursorLayer cursor_layer = {};
+    core::CursorImage captured_cursor = {};
+    core::PointPx captured_cursor_hotspot_screen_px = {};
     core::PointPx capture_origin_px = {};
     WindowCaptureState window_capture = {};
     std::array<std::shared_ptr<OverlayButtonGlyph const>,
@@ -695,15 +603,11 @@ struct OverlayWindow::OverlayResources {
     OverlayResources(OverlayResources const &) = delete;
     OverlayResources &operator=(OverlayResources const &) = delete;
 
-    [[nodiscard]] bool Initialize_for_capture(HINSTANCE hinstance) {
-        if (!base_capture.Is_valid() || !display_capture.Is_valid()) {
-            return false;
-        }
-        for (ToolbarGlyphResourceSpec const &spec : kToolbarGlyphResourceSpecs) {
+    void Load_toolbar_glyphs() {
+        for (ToolbarGlyphSpec const &spec : kToolbarGlyphSpecs) {
             toolbar_glyphs[Overlay_toolbar_glyph_index(spec.glyph)] =
-                Load_png_resource_alpha_mask(hinstance, spec.resource_id);
+                Make_toolbar_glyph(spec.mask);
         }
-        return true;
     }
 
     [[nodiscard]] std::array<OverlayButtonGlyph const *,
@@ -720,8 +624,9 @@ struct OverlayWindow::OverlayResources {
 
     void Reset() noexcept {
         base_capture.Free();
-        display_capture.Free();
-        captured_cursor.reset();
+        cursor_layer = {};
+        captured_cursor = {};
+        captured_cursor_hotspot_screen_px = {};
         capture_origin_px = {};
         window_capture.Reset();
         for (auto &glyph : toolbar_glyphs) {
@@ -750,18 +655,18 @@ struct OverlayWindow::ObfuscateSourceProvider final
         core::RectPx source_bounds = {};
         auto const &state = owner_->controller_.State();
         if (state.selection_uses_full_window_capture &&
-            owner_->resources_->window_capture.display_capture.Is_valid() &&
+            owner_->resources_->window_capture.base_capture.Is_valid() &&
             !state.selection_capture_rect_screen.Is_empty()) {
             RECT overlay_rect{};
             if (GetWindowRect(owner_->hwnd_, &overlay_rect) == 0) {
                 return std::nullopt;
             }
-            source_capture = &owner_->resources_->window_capture.display_capture;
+            source_capture = &owner_->resources_->window_capture.base_capture;
             source_bounds =
                 core::Screen_rect_to_client_rect(state.selection_capture_rect_screen,
                                                  overlay_rect.left, overlay_rect.top);
-        } else if (owner_->resources_->display_capture.Is_valid()) {
-            source_capture = &owner_->resources_->display_capture;
+        } else if (owner_->resources_->base_capture.Is_valid()) {
+            source_capture = &owner_->resources_->base_capture;
             source_bounds = {};
         } else {
             return std::nullopt;
@@ -807,8 +712,10 @@ struct OverlayWindow::ObfuscateSourceProvider final
 };
 
 OverlayWindow::OverlayWindow(IOverlayEvents *events, core::AppConfig *config,
-                             IWindowQuery *window_query)
-    : events_(events), config_(config), window_query_(window_query),
+                             IWindowQuery *window_query,
+                             core::SaveDirectoryIndex *save_directory_index)
+    : events_(events), config_(config), save_directory_index_(save_directory_index),
+      window_query_(window_query),
       resources_(std::make_unique<OverlayResources>()),
       obfuscate_source_provider_(std::make_unique<ObfuscateSourceProvider>(this)) {}
 
@@ -828,18 +735,7 @@ bool OverlayWindow::Is_captured_cursor_visible() const noexcept {
 }
 
 bool OverlayWindow::Current_capture_has_captured_cursor() const noexcept {
-    if (resources_ == nullptr) {
-        return false;
-    }
-
-    std::optional<CapturedCursorSnapshot> const &captured_cursor =
-        resources_->captured_cursor;
-    if (!captured_cursor.has_value()) {
-        return false;
-    }
-
-    auto const &captured_cursor_value = captured_cursor.value();
-    return captured_cursor_value.Is_valid();
+    return resources_ != nullptr && resources_->captured_cursor.Is_valid();
 }
 
 std::wstring OverlayWindow::Build_captured_cursor_tooltip() const {
@@ -856,27 +752,22 @@ std::wstring OverlayWindow::Build_pin_tooltip() const {
     return L"Pin to desktop (Ctrl+P)";
 }
 
-bool OverlayWindow::Rebuild_display_capture() {
-    if (resources_ == nullptr || !resources_->base_capture.Is_valid()) {
-        return false;
-    }
-    if (!Rebuild_capture_display(resources_->base_capture, resources_->captured_cursor,
-                                 Is_captured_cursor_visible(),
-                                 resources_->capture_origin_px,
-                                 resources_->display_capture)) {
+bool OverlayWindow::Sync_captured_cursor_layers(core::RectPx &desktop_changed,
+                                                core::RectPx &window_changed) {
+    window_changed = {};
+    if (resources_ == nullptr ||
+        !Sync_cursor_layer(resources_->cursor_layer, resources_->base_capture,
+                           Is_captured_cursor_visible(), desktop_changed)) {
+        desktop_changed = {};
         return false;
     }
 
-    if (resources_->window_capture.base_capture.Is_valid()) {
-        if (!Rebuild_capture_display(
-                resources_->window_capture.base_capture, resources_->captured_cursor,
-                Is_captured_cursor_visible(),
-                resources_->window_capture.capture_rect_screen.Top_left(),
-                resources_->window_capture.display_capture)) {
-            resources_->window_capture.Reset();
-        }
+    auto &window_capture = resources_->window_capture;
+    if (window_capture.base_capture.Is_valid() &&
+        !Sync_cursor_layer(window_capture.cursor_layer, window_capture.base_capture,
+                           Is_captured_cursor_visible(), window_changed)) {
+        window_capture.Reset();
     }
-
     return true;
 }
 
@@ -967,7 +858,6 @@ bool OverlayWindow::Update_ctrl_window_preview(HWND window,
                             std::to_wstring(static_cast<int>(capture_result.status)) +
                             L" message=" + capture_result.error_message);
         window_capture.base_capture.Free();
-        window_capture.display_capture.Free();
         window_capture.has_full_capture = false;
         if (d2d_resources_ != nullptr) {
             d2d_resources_->Clear_lifted_window_capture();
@@ -975,39 +865,45 @@ bool OverlayWindow::Update_ctrl_window_preview(HWND window,
         return false;
     }
 
-    window_capture.has_full_capture = Rebuild_capture_display(
-        window_capture.base_capture, resources_->captured_cursor,
-        Is_captured_cursor_visible(), normalized_capture_rect.Top_left(),
-        window_capture.display_capture);
+    core::PointPx const cursor_hotspot_screen_px =
+        resources_->captured_cursor_hotspot_screen_px;
+    window_capture.cursor_layer.Set_image(
+        resources_->captured_cursor,
+        {cursor_hotspot_screen_px.x - normalized_capture_rect.left,
+         cursor_hotspot_screen_px.y - normalized_capture_rect.top});
+    core::RectPx cursor_changed = {};
+    window_capture.has_full_capture =
+        Sync_cursor_layer(window_capture.cursor_layer, window_capture.base_capture,
+                          Is_captured_cursor_visible(), cursor_changed);
     if (!window_capture.has_full_capture) {
         GREENFLAME_LOG_WRITE(
-            L"overlay", std::wstring(L"Ctrl preview display rebuild failed hwnd=") +
+            L"overlay", std::wstring(L"Ctrl preview cursor composite failed hwnd=") +
                             Format_hwnd_for_debug_log(window));
         window_capture.base_capture.Free();
-        window_capture.display_capture.Free();
+        window_capture.cursor_layer.Discard_target();
         if (d2d_resources_ != nullptr) {
             d2d_resources_->Clear_lifted_window_capture();
         }
     } else if (d2d_resources_ != nullptr &&
                !d2d_resources_->Upload_lifted_window_capture(
-                   window_capture.display_capture)) {
+                   window_capture.base_capture)) {
         GREENFLAME_LOG_WRITE(
             L"overlay",
             std::wstring(L"Ctrl preview lifted bitmap upload failed hwnd=") +
                 Format_hwnd_for_debug_log(window) + L" capture_size=" +
-                std::to_wstring(window_capture.display_capture.width) + L"x" +
-                std::to_wstring(window_capture.display_capture.height));
+                std::to_wstring(window_capture.base_capture.width) + L"x" +
+                std::to_wstring(window_capture.base_capture.height));
         window_capture.base_capture.Free();
-        window_capture.display_capture.Free();
+        window_capture.cursor_layer.Discard_target();
         window_capture.has_full_capture = false;
         d2d_resources_->Clear_lifted_window_capture();
     } else {
         GREENFLAME_LOG_WRITE(
             L"overlay", std::wstring(L"Ctrl preview capture ready hwnd=") +
                             Format_hwnd_for_debug_log(window) + L" capture_size=" +
-                            std::to_wstring(window_capture.display_capture.width) +
+                            std::to_wstring(window_capture.base_capture.width) +
                             L"x" +
-                            std::to_wstring(window_capture.display_capture.height));
+                            std::to_wstring(window_capture.base_capture.height));
     }
 
     return window_capture.has_full_capture;
@@ -1057,6 +953,17 @@ core::PointPx OverlayWindow::Update_pointer_state_from_current_input(
     {
         GREENFLAME_PROFILE_SCOPE(
             "OverlayWindow::Update_pointer_state_from_current_input::Controller");
+        if (input_recorder_.Is_recording()) {
+            input_recorder_.Record({.kind = core::OverlayInputEventKind::PointerMove,
+                                    .mods = mods,
+                                    .cursor_client = cursor_client,
+                                    .cursor_screen = cursor_screen,
+                                    .monitor_index = monitor_idx,
+                                    .window_rect_screen = win_rect,
+                                    .virtual_desktop_bounds = vdesk,
+                                    .origin_x = ox,
+                                    .origin_y = oy});
+        }
         action = controller_.On_pointer_move(mods, cursor_client, cursor_screen,
                                              win_rect, vdesk, monitor_idx, ox, oy);
     }
@@ -1092,9 +999,9 @@ void OverlayWindow::Restore_selection_state(core::OverlaySelectionState const &s
     controller_.Restore_selection_state(state);
     if (d2d_resources_ != nullptr) {
         if (state.selection_uses_full_window_capture && resources_ != nullptr &&
-            resources_->window_capture.display_capture.Is_valid()) {
+            resources_->window_capture.base_capture.Is_valid()) {
             (void)d2d_resources_->Upload_lifted_window_capture(
-                resources_->window_capture.display_capture);
+                resources_->window_capture.base_capture);
         }
         d2d_resources_->Invalidate_annotations();
     }
@@ -1109,7 +1016,12 @@ void OverlayWindow::Toggle_captured_cursor_visibility() {
     bool const previous_value = config_->include_cursor;
     config_->include_cursor = !previous_value;
     config_->Normalize();
-    if (!Rebuild_display_capture()) {
+    core::RectPx desktop_changed = {};
+    core::RectPx window_changed = {};
+    // The edge analysis reads luma taken before the cursor was composed, so its
+    // edges stay valid either way.
+    bool const synced = Sync_captured_cursor_layers(desktop_changed, window_changed);
+    if (!synced) {
         config_->include_cursor = previous_value;
         config_->Normalize();
         return;
@@ -1118,13 +1030,16 @@ void OverlayWindow::Toggle_captured_cursor_visibility() {
     (void)Save_app_config(*config_);
     Rebuild_toolbar_buttons();
     if (d2d_resources_ != nullptr) {
-        if (!d2d_resources_->Upload_screenshot(resources_->display_capture)) {
+        if (!desktop_changed.Is_empty() &&
+            !d2d_resources_->Update_screenshot_rect(resources_->base_capture,
+                                                    desktop_changed)) {
             Handle_device_loss();
             return;
         }
-        if (resources_->window_capture.display_capture.Is_valid()) {
-            if (!d2d_resources_->Upload_lifted_window_capture(
-                    resources_->window_capture.display_capture)) {
+        if (resources_->window_capture.base_capture.Is_valid()) {
+            if (!window_changed.Is_empty() &&
+                !d2d_resources_->Update_lifted_window_capture_rect(
+                    resources_->window_capture.base_capture, window_changed)) {
                 Handle_device_loss();
                 return;
             }
@@ -1220,6 +1135,7 @@ void OverlayWindow::Accept_obfuscate_warning() {
 
 void OverlayWindow::Reject_obfuscate_warning() {
     Hide_obfuscate_warning();
+    Record_input_event(core::OverlayInputEventKind::Cancel);
     Apply_action(controller_.On_cancel());
     (void)Refresh_hover_handle();
     Refresh_cursor();
@@ -1434,6 +1350,12 @@ bool OverlayWindow::Create_and_show(HINSTANCE hinstance) {
         return false;
     }
     hinstance_ = hinstance;
+    if (save_directory_index_ != nullptr) {
+        // Re-list on the session's first ${num} save; files may have changed since.
+        save_directory_index_->Clear();
+    }
+    content_snap_edge_analyzer_.Cancel();
+    content_snap_edges_ = {};
     resources_->Reset();
     mouse_wheel_delta_remainder_ = 0;
     transient_center_label_text_.clear();
@@ -1442,65 +1364,145 @@ bool OverlayWindow::Create_and_show(HINSTANCE hinstance) {
     selection_wheel_ = {};
     text_layout_engine_.reset();
 
+    // Capture and cursor snapshot overlap with window and D2D creation; window,
+    // device and COM work stays on this thread.
     core::RectPx const bounds = Get_virtual_desktop_bounds_px();
-    if (!Capture_virtual_desktop(resources_->base_capture)) {
-        return false;
-    }
     resources_->capture_origin_px = {bounds.left, bounds.top};
-    CapturedCursorSnapshot captured_cursor = {};
-    if (Capture_cursor_snapshot(captured_cursor)) {
-        resources_->captured_cursor = std::move(captured_cursor);
-    } else {
-        resources_->captured_cursor.reset();
-    }
+    resources_->Load_toolbar_glyphs();
+    HWND hwnd = nullptr;
+    core::SnapEdges visible_snap_edges = {};
+    bool d2d_ready = false;
+    core::StageGraph startup;
+    size_t const capture_stage = startup.Add_stage(
+        "overlay.capture_desktop", core::StageThread::Any, {}, {"base_capture"},
+        [&] { return Capture_virtual_desktop(resources_->base_capture); });
+    (void)startup.Add_stage("overlay.capture_cursor", core::StageThread::Any, {},
+                            {"cursor"}, [&] {
+                                CapturedCursorSnapshot snapshot = {};
+                                if (Capture_cursor_snapshot(snapshot) &&
+                                    Render_cursor_image(snapshot,
+                                                        resources_->captured_cursor)) {
+                                    resources_->captured_cursor_hotspot_screen_px =
+                                        snapshot.hotspot_screen_px;
+                                }
+                                return true;
+                            });
+    size_t const window_stage = startup.Add_stage(
+        "overlay.create_window", core::StageThread::Caller, {}, {"hwnd"}, [&] {
+            hwnd = CreateWindowExW(WS_EX_TOPMOST, kOverlayWindowClass, L"", WS_POPUP,
+                                   bounds.left, bounds.top, bounds.Width(),
+                                   bounds.Height(), nullptr, nullptr, hinstance_, this);
+            return hwnd != nullptr;
+        });
+    // The hidden overlay is already in the z-order, so the walk starts below it.
+    (void)startup.Add_stage("overlay.window_snap_edges", core::StageThread::Any,
+                            {"hwnd"}, {"window_snap_edges"}, [&] {
+                                window_query_->Get_visible_top_level_window_snap_edges(
+                                    hwnd, visible_snap_edges);
+                                return true;
+                            });
+    // Content edges are found on cursor-free pixels, so toggling the captured
+    // cursor later never invalidates them. A missing luma only costs the edges.
+    std::optional<core::ContentEdgeLuma> content_luma = std::nullopt;
+    size_t const workers = core::Default_parallel_workers();
+    (void)startup.Add_stage(
+        "overlay.content_luma", core::StageThread::Any, {"base_capture"},
+        {"content_luma"}, [&] {
+            GdiCaptureResult const &capture = resources_->base_capture;
+            content_luma = core::Build_content_edge_luma(
+                {Capture_pixels(capture),
+                 static_cast<size_t>(Row_bytes32(capture.width)), capture.width,
+                 capture.height, resources_->capture_origin_px},
+                workers);
+            return true;
+        });
+    size_t const compose_stage = startup.Add_stage(
+        "overlay.compose_cursor", core::StageThread::Any,
+        {"base_capture", "cursor", "content_luma"}, {"display_pixels"}, [&] {
+            resources_->cursor_layer.Set_image(
+                resources_->captured_cursor,
+                {resources_->captured_cursor_hotspot_screen_px.x - bounds.left,
+                 resources_->captured_cursor_hotspot_screen_px.y - bounds.top});
+            core::RectPx desktop_changed = {};
+            core::RectPx window_changed = {};
+            return Sync_captured_cursor_layers(desktop_changed, window_changed);
+        });
+    (void)startup.Add_stage(
+        "overlay.d2d_device", core::StageThread::Caller, {"hwnd"}, {"d2d"}, [&] {
+            d2d_resources_ = std::make_unique<D2DOverlayResources>();
+            return d2d_resources_->Initialize_factory() &&
+                   d2d_resources_->Create_hwnd_rt(hwnd, bounds.Width(),
+                                                  bounds.Height()) &&
+                   d2d_resources_->Create_shared_resources() &&
+                   d2d_resources_->Create_cache_targets(bounds.Width(),
+                                                        bounds.Height());
+        });
+    (void)startup.Add_stage(
+        "overlay.upload_screenshot", core::StageThread::Caller,
+        {"d2d", "display_pixels"}, {"d2d_screenshot"}, [&] {
+            return d2d_resources_->Upload_screenshot(resources_->base_capture);
+        });
+    (void)startup.Add_stage(
+        "overlay.upload_glyphs", core::StageThread::Caller, {"d2d_screenshot"}, {},
+        [&] {
+            d2d_resources_->Clear_lifted_window_capture();
+            auto const glyphs = resources_->Glyph_pointers();
+            (void)d2d_resources_->Upload_glyph_bitmaps(
+                std::span<OverlayButtonGlyph const *const>(glyphs));
+            return true;
+        });
+    (void)startup.Add_stage(
+        "overlay.text_services", core::StageThread::Caller, {"d2d_screenshot"}, {},
+        [&] {
+            if (d2d_resources_->factory && d2d_resources_->dwrite_factory) {
+                text_layout_engine_ = std::make_unique<D2DTextLayoutEngine>(
+                    d2d_resources_->factory.Get(),
+                    d2d_resources_->dwrite_factory.Get());
+                text_layout_engine_->Set_font_families(
+                    Resolve_text_font_families(config_));
+            }
+            Rebuild_spell_check_service();
+            d2d_ready = true;
+            return true;
+        });
 
-    HWND const hwnd = CreateWindowExW(
-        WS_EX_TOPMOST, kOverlayWindowClass, L"", WS_POPUP, bounds.left, bounds.top,
-        bounds.Width(), bounds.Height(), nullptr, nullptr, hinstance_, this);
-    if (!hwnd) {
+    core::StageGraphResult const startup_result = startup.Run(workers);
+    GREENFLAME_LOG_WRITE(L"overlay", Format_startup_stage_timings(startup_result));
+    if (startup_result.Status(window_stage) != core::StageStatus::Succeeded) {
         resources_->Reset();
         hinstance_ = nullptr;
         return false;
     }
-    if (!Rebuild_display_capture() || !resources_->Initialize_for_capture(hinstance_)) {
+    if (startup_result.Status(capture_stage) != core::StageStatus::Succeeded ||
+        startup_result.Status(compose_stage) != core::StageStatus::Succeeded) {
         DestroyWindow(hwnd);
         return false;
     }
-
-    // Initialize D2D render pipeline.
-    d2d_resources_ = std::make_unique<D2DOverlayResources>();
-    if (!d2d_resources_->Initialize_factory() ||
-        !d2d_resources_->Create_hwnd_rt(hwnd, resources_->display_capture.width,
-                                        resources_->display_capture.height) ||
-        !d2d_resources_->Upload_screenshot(resources_->display_capture) ||
-        !d2d_resources_->Create_shared_resources() ||
-        !d2d_resources_->Create_cache_targets(resources_->display_capture.width,
-                                              resources_->display_capture.height)) {
+    if (!d2d_ready) {
+        // Paint falls back to GDI without a render pipeline.
         d2d_resources_.reset();
-    } else {
-        if (resources_->window_capture.display_capture.Is_valid()) {
-            (void)d2d_resources_->Upload_lifted_window_capture(
-                resources_->window_capture.display_capture);
-        } else {
-            d2d_resources_->Clear_lifted_window_capture();
-        }
-        auto const glyphs = resources_->Glyph_pointers();
-        (void)d2d_resources_->Upload_glyph_bitmaps(
-            std::span<OverlayButtonGlyph const *const>(glyphs));
-        if (d2d_resources_->factory && d2d_resources_->dwrite_factory) {
-            text_layout_engine_ = std::make_unique<D2DTextLayoutEngine>(
-                d2d_resources_->factory.Get(), d2d_resources_->dwrite_factory.Get());
-            text_layout_engine_->Set_font_families(Resolve_text_font_families(config_));
-        }
-        Rebuild_spell_check_service();
+        text_layout_engine_.reset();
     }
 
-    controller_.Reset_for_session(Get_monitors_with_bounds());
+    std::vector<core::MonitorWithBounds> monitors = Get_monitors_with_bounds();
+    if (config_ != nullptr && !config_->overlay_input_trace_dir.empty()) {
+        input_recorder_.Begin_session(monitors);
+    }
+    controller_.Reset_for_session(std::move(monitors));
     controller_.Set_text_layout_engine(text_layout_engine_.get());
     controller_.Set_spell_check_service(spell_check_service_.get());
     controller_.Set_obfuscate_source_provider(obfuscate_source_provider_.get());
-    controller_.Refresh_snap_edges(Collect_visible_snap_edges(), bounds.left,
-                                   bounds.top);
+    Append_monitor_snap_edges(visible_snap_edges);
+    if (input_recorder_.Is_recording()) {
+        input_recorder_.Record({.kind = core::OverlayInputEventKind::SnapEdgesRefreshed,
+                                .origin_x = bounds.left,
+                                .origin_y = bounds.top,
+                                .snap_edges = visible_snap_edges});
+    }
+    controller_.Refresh_snap_edges(visible_snap_edges, bounds.left, bounds.top);
+    if (content_luma.has_value()) {
+        Start_content_snap_edge_analysis(std::move(*content_luma));
+    }
     auto const tool_step = [&](core::AnnotationToolId tool, int32_t step) {
         controller_.Set_tool_size_step(tool, step);
     };
@@ -1610,6 +1612,17 @@ core::SnapEdges OverlayWindow::Collect_visible_snap_edges() const {
     if (window_query_ != nullptr && hwnd_ != nullptr) {
         window_query_->Get_visible_top_level_window_snap_edges(hwnd_, snap_edges);
     }
+    Append_monitor_snap_edges(snap_edges);
+    snap_edges.vertical.insert(snap_edges.vertical.end(),
+                               content_snap_edges_.vertical.begin(),
+                               content_snap_edges_.vertical.end());
+    snap_edges.horizontal.insert(snap_edges.horizontal.end(),
+                                 content_snap_edges_.horizontal.begin(),
+                                 content_snap_edges_.horizontal.end());
+    return snap_edges;
+}
+
+void OverlayWindow::Append_monitor_snap_edges(core::SnapEdges &snap_edges) const {
     std::vector<core::RectPx> monitor_rects;
     monitor_rects.reserve(controller_.State().cached_monitors.size());
     for (auto const &monitor : controller_.State().cached_monitors) {
@@ -1623,7 +1636,34 @@ core::SnapEdges OverlayWindow::Collect_visible_snap_edges() const {
     snap_edges.horizontal.insert(snap_edges.horizontal.end(),
                                  monitor_edges.horizontal.begin(),
                                  monitor_edges.horizontal.end());
-    return snap_edges;
+}
+
+void OverlayWindow::Start_content_snap_edge_analysis(core::ContentEdgeLuma luma) {
+    if (hwnd_ == nullptr) {
+        return;
+    }
+    HWND const hwnd = hwnd_;
+    content_snap_edge_analyzer_.Start(
+        std::move(luma), {}, core::Default_parallel_workers(),
+        [hwnd] { (void)PostMessageW(hwnd, kContentSnapEdgesReadyMessage, 0, 0); });
+}
+
+LRESULT OverlayWindow::On_content_snap_edges_ready() {
+    std::optional<core::SnapEdges> edges = content_snap_edge_analyzer_.Take_result();
+    if (!edges.has_value() || resources_ == nullptr) {
+        return 0;
+    }
+    content_snap_edges_ = std::move(*edges);
+    core::PointPx const origin = resources_->capture_origin_px;
+    core::SnapEdges const visible_snap_edges = Collect_visible_snap_edges();
+    if (input_recorder_.Is_recording()) {
+        input_recorder_.Record({.kind = core::OverlayInputEventKind::SnapEdgesRefreshed,
+                                .origin_x = origin.x,
+                                .origin_y = origin.y,
+                                .snap_edges = visible_snap_edges});
+    }
+    controller_.Refresh_snap_edges(visible_snap_edges, origin.x, origin.y);
+    return 0;
 }
 
 bool OverlayWindow::Handle_tool_size_delta(int32_t delta_steps) {
@@ -2403,10 +2443,16 @@ bool OverlayWindow::Should_show_square_cursor_preview() const {
 }
 
 bool OverlayWindow::Should_force_obfuscate_repaint() const {
-    core::Annotation const *const draft = controller_.Draft_annotation();
-    return (draft != nullptr &&
-            std::holds_alternative<core::ObfuscateAnnotation>(draft->data)) ||
-           !controller_.Active_obfuscate_preview_indices().empty();
+    // Only an obfuscate draft matters; asking other tools for theirs would build
+    // a full copy of a freehand stroke on every pointer move.
+    if (controller_.Active_annotation_tool() == core::AnnotationToolId::Obfuscate) {
+        core::Annotation const *const draft = controller_.Draft_annotation();
+        if (draft != nullptr &&
+            std::holds_alternative<core::ObfuscateAnnotation>(draft->data)) {
+            return true;
+        }
+    }
+    return !controller_.Active_obfuscate_preview_indices().empty();
 }
 
 bool OverlayWindow::Is_selection_stable_for_help() const {
@@ -2553,6 +2599,7 @@ LRESULT OverlayWindow::On_key_down(WPARAM wparam, LPARAM lparam) {
             Hide_help_overlay(false);
             return 0;
         }
+        Record_input_event(core::OverlayInputEventKind::Cancel);
         core::OverlayAction const action = controller_.On_cancel();
         Apply_action(action);
         Cancel_highlighter_straighten_pending();
@@ -2785,8 +2832,10 @@ LRESULT OverlayWindow::On_key_down(WPARAM wparam, LPARAM lparam) {
     }
     if (eff_ctrl && wparam == L'Z') {
         if (eff_shift) {
+            Record_input_event(core::OverlayInputEventKind::Redo);
             controller_.Redo();
         } else {
+            Record_input_event(core::OverlayInputEventKind::Undo);
             controller_.Undo();
         }
         if (d2d_resources_) {
@@ -2814,10 +2863,17 @@ LRESULT OverlayWindow::On_key_down(WPARAM wparam, LPARAM lparam) {
         }
     }
     if (wparam == VK_DELETE) {
+        Record_input_event(core::OverlayInputEventKind::DeleteSelectedAnnotation);
         Apply_action(controller_.On_delete_selected_annotation());
         return 0;
     }
     if (!eff_ctrl && !eff_alt) {
+        if (input_recorder_.Is_recording()) {
+            input_recorder_.Record(
+                {.kind = core::OverlayInputEventKind::AnnotationToolHotkey,
+                 .mods = {.shift = eff_shift},
+                 .hotkey = static_cast<wchar_t>(wparam)});
+        }
         core::OverlayAction const action = controller_.On_annotation_tool_hotkey(
             static_cast<wchar_t>(wparam), eff_shift);
         if (action != core::OverlayAction::None) {
@@ -2905,7 +2961,7 @@ LRESULT OverlayWindow::On_char(WPARAM wparam) {
 }
 
 LRESULT OverlayWindow::On_l_button_down() {
-    if (resources_ == nullptr || !resources_->display_capture.Is_valid()) {
+    if (resources_ == nullptr || !resources_->base_capture.Is_valid()) {
         return 0;
     }
     bool const had_text_edit = controller_.Has_active_text_edit();
@@ -3067,9 +3123,25 @@ LRESULT OverlayWindow::On_l_button_down() {
         vdesk = Get_virtual_desktop_bounds_px();
     }
 
+    core::SnapEdges const visible_snap_edges = Collect_visible_snap_edges();
+    if (input_recorder_.Is_recording()) {
+        input_recorder_.Record(
+            {.kind = core::OverlayInputEventKind::PrimaryPress,
+             .mods = mods,
+             .cursor_client = cursor_client,
+             .cursor_screen = cursor_screen,
+             .window = win_handle,
+             .monitor_index = monitor_idx,
+             .window_rect_screen = win_rect,
+             .virtual_desktop_bounds = vdesk,
+             .origin_x = wr.left,
+             .origin_y = wr.top,
+             .window_full_capture_available = window_full_capture_available,
+             .snap_edges = visible_snap_edges});
+    }
     Apply_action(controller_.On_primary_press(
         mods, cursor_client, cursor_screen, win_handle, monitor_idx, win_rect, vdesk,
-        Collect_visible_snap_edges(), wr.left, wr.top, window_full_capture_available));
+        visible_snap_edges, wr.left, wr.top, window_full_capture_available));
     if (controller_.Has_active_annotation_gesture() ||
         controller_.Has_active_text_edit()) {
         Clear_transient_center_label(false);
@@ -3225,6 +3297,10 @@ LRESULT OverlayWindow::On_mouse_wheel(WPARAM wparam) {
 
 LRESULT OverlayWindow::On_l_button_dbl_clk() {
     core::PointPx const cursor_client = Get_client_cursor_pos_px(hwnd_);
+    if (input_recorder_.Is_recording()) {
+        input_recorder_.Record({.kind = core::OverlayInputEventKind::PrimaryDoublePress,
+                                .cursor_client = cursor_client});
+    }
     Apply_action(controller_.On_primary_double_press(cursor_client));
     if (controller_.Has_active_text_edit()) {
         Reset_caret_blink();
@@ -3267,6 +3343,11 @@ LRESULT OverlayWindow::On_l_button_up() {
                 core::OverlayAction action = core::OverlayAction::None;
                 if (btn.action == ToolbarButtonAction::SelectAnnotationTool &&
                     btn.tool_id.has_value()) {
+                    if (input_recorder_.Is_recording()) {
+                        input_recorder_.Record(
+                            {.kind = core::OverlayInputEventKind::SelectAnnotationTool,
+                             .tool = *btn.tool_id});
+                    }
                     action = controller_.On_select_annotation_tool(*btn.tool_id);
                     Clear_transient_center_label(false);
                     Apply_action(action);
@@ -3314,7 +3395,13 @@ LRESULT OverlayWindow::On_l_button_up() {
     Cancel_highlighter_straighten_pending();
     core::OverlayModifierState mods{};
     mods.alt = (GetKeyState(VK_MENU) & 0x8000) != 0;
-    Apply_action(controller_.On_primary_release(mods, Get_client_cursor_pos_px(hwnd_)));
+    core::PointPx const release_client = Get_client_cursor_pos_px(hwnd_);
+    if (input_recorder_.Is_recording()) {
+        input_recorder_.Record({.kind = core::OverlayInputEventKind::PrimaryRelease,
+                                .mods = mods,
+                                .cursor_client = release_client});
+    }
+    Apply_action(controller_.On_primary_release(mods, release_client));
     if (controller_.Has_active_text_edit()) {
         Reset_caret_blink();
     } else if (had_text_edit && hwnd_ != nullptr) {
@@ -3359,7 +3446,7 @@ LRESULT OverlayWindow::On_l_button_up() {
 }
 
 LRESULT OverlayWindow::On_r_button_down() {
-    if (resources_ == nullptr || !resources_->display_capture.Is_valid()) {
+    if (resources_ == nullptr || !resources_->base_capture.Is_valid()) {
         return 0;
     }
     if (obfuscate_warning_dialog_.Is_visible()) {
@@ -3462,6 +3549,8 @@ LRESULT OverlayWindow::Wnd_proc(UINT msg, WPARAM wparam, LPARAM lparam) {
         return On_set_cursor(wparam, lparam);
     case WM_TIMER:
         return On_timer(wparam);
+    case kContentSnapEdgesReadyMessage:
+        return On_content_snap_edges_ready();
     case WM_ERASEBKGND:
         return 1;
     case WM_DESTROY:
@@ -3488,7 +3577,7 @@ std::wstring OverlayWindow::Resolve_default_save_directory() const {
 }
 
 void OverlayWindow::Build_default_save_name(std::wstring_view save_dir_for_num_scan,
-                                            std::span<wchar_t> out) const {
+                                            std::span<wchar_t> out) {
     if (out.empty()) {
         return;
     }
@@ -3534,10 +3623,20 @@ void OverlayWindow::Build_default_save_name(std::wstring_view save_dir_for_num_s
     std::wstring_view const effective_pattern =
         pattern.empty() ? core::Default_filename_pattern(s.selection_source) : pattern;
     if (core::Pattern_uses_num(effective_pattern)) {
-        std::vector<std::wstring> const files =
-            List_directory_filenames(save_dir_for_num_scan);
-        ctx.incrementing_number =
-            core::Find_next_num_for_pattern(effective_pattern, ctx, files);
+        if (save_directory_index_ == nullptr) {
+            ctx.incrementing_number =
+                core::Find_next_num_for_pattern(effective_pattern, ctx,
+                                                List_directory_filenames(
+                                                    save_dir_for_num_scan));
+        } else {
+            if (!save_directory_index_->Is_loaded_for(save_dir_for_num_scan)) {
+                save_directory_index_->Load(
+                    save_dir_for_num_scan,
+                    List_directory_filenames(save_dir_for_num_scan));
+            }
+            ctx.incrementing_number =
+                save_directory_index_->Next_num(effective_pattern, ctx);
+        }
     }
 
     std::wstring const name =
@@ -3610,6 +3709,9 @@ void OverlayWindow::Save_directly_and_close(bool copy_saved_file_to_clipboard) {
         Destroy();
         return;
     }
+    if (save_directory_index_ != nullptr) {
+        save_directory_index_->Add_saved_path(reserved_path);
+    }
     bool file_copied_to_clipboard = false;
     if (copy_saved_file_to_clipboard) {
         file_copied_to_clipboard = Copy_file_path_to_clipboard(reserved_path, hwnd_);
@@ -3681,6 +3783,9 @@ void OverlayWindow::Save_as_and_close(bool copy_saved_file_to_clipboard) {
         cropped.Free();
         return;
     }
+    if (save_directory_index_ != nullptr) {
+        save_directory_index_->Add_saved_path(std::wstring_view(path_buffer.data()));
+    }
     bool file_copied_to_clipboard = false;
     if (copy_saved_file_to_clipboard) {
         file_copied_to_clipboard =
@@ -3702,6 +3807,10 @@ void OverlayWindow::Notify_save_and_close(GdiCaptureResult &cropped,
                                           std::wstring_view saved_path,
                                           bool file_copied_to_clipboard) {
     HBITMAP thumb = Create_thumbnail_from_capture(cropped);
+    if (events_) {
+        events_->On_selection_captured(Selection_screen_rect(),
+                                       controller_.State().selection_window, cropped);
+    }
     cropped.Free();
     if (events_) {
         events_->On_selection_saved_to_file(Selection_screen_rect(),
@@ -3728,36 +3837,17 @@ bool OverlayWindow::Build_selection_capture(GdiCaptureResult &out) const {
 
     auto const &state = controller_.State();
     if (state.selection_uses_full_window_capture) {
-        if (!resources_->window_capture.display_capture.Is_valid()) {
+        if (!resources_->window_capture.base_capture.Is_valid()) {
             return false;
         }
-        return Crop_capture(resources_->window_capture.display_capture, 0, 0,
-                            resources_->window_capture.display_capture.width,
-                            resources_->window_capture.display_capture.height, out);
+        return Crop_capture(resources_->window_capture.base_capture, 0, 0,
+                            resources_->window_capture.base_capture.width,
+                            resources_->window_capture.base_capture.height, out);
     }
 
-    if (!Crop_capture(resources_->base_capture, selection.left, selection.top,
-                      selection.Width(), selection.Height(), out)) {
-        return false;
-    }
-
-    core::RectPx const selection_screen_rect = Selection_visible_screen_rect();
-    if (Is_captured_cursor_visible()) {
-        std::optional<CapturedCursorSnapshot> const &captured_cursor =
-            resources_->captured_cursor;
-        if (captured_cursor.has_value()) {
-            auto const &captured_cursor_value = captured_cursor.value();
-            if (captured_cursor_value.Is_valid() &&
-                !Composite_cursor_snapshot(
-                    captured_cursor_value,
-                    {selection_screen_rect.left, selection_screen_rect.top}, out)) {
-                out.Free();
-                return false;
-            }
-        }
-    }
-
-    return true;
+    // base_capture already carries the captured cursor when it is shown.
+    return Crop_capture(resources_->base_capture, selection.left, selection.top,
+                        selection.Width(), selection.Height(), out);
 }
 
 bool OverlayWindow::Build_rendered_selection_capture(GdiCaptureResult &out) const {
@@ -3775,7 +3865,8 @@ bool OverlayWindow::Build_rendered_selection_capture(GdiCaptureResult &out) cons
             ? core::Screen_rect_to_client_rect(state.selection_capture_rect_screen,
                                                overlay_rect.left, overlay_rect.top)
             : state.final_selection;
-    if (!Render_annotations_into_capture(out, controller_.Annotations(), selection)) {
+    if (!Render_annotations_into_capture(out, controller_.Annotations(), selection,
+                                         controller_.Annotation_summaries())) {
         out.Free();
         return false;
     }
@@ -3798,6 +3889,10 @@ void OverlayWindow::Copy_to_clipboard_and_close() {
         return;
     }
     bool const copied_to_clipboard = Copy_capture_to_clipboard(cropped, hwnd_);
+    if (copied_to_clipboard && events_) {
+        events_->On_selection_captured(Selection_screen_rect(),
+                                       controller_.State().selection_window, cropped);
+    }
     cropped.Free();
 
     if (copied_to_clipboard && events_) {
@@ -3914,21 +4009,28 @@ LRESULT OverlayWindow::On_paint() {
         if (!d2d_resources_->annotations_valid) {
             GREENFLAME_PROFILE_SCOPE(
                 "OverlayWindow::On_paint::Rebuild_annotations_cache");
-            Rebuild_annotations_bitmap(*d2d_resources_, controller_.Annotations(), {},
+            Rebuild_annotations_bitmap(*d2d_resources_, controller_.Annotations(),
+                                       controller_.Annotation_summaries(), {},
                                        controller_.Editing_annotation_id());
         }
         if (!d2d_resources_->frozen_valid) {
             GREENFLAME_PROFILE_SCOPE("OverlayWindow::On_paint::Rebuild_frozen_cache");
             Rebuild_frozen_bitmap(*d2d_resources_, s.final_selection,
-                                  resources_->display_capture.width,
-                                  resources_->display_capture.height);
+                                  resources_->base_capture.width,
+                                  resources_->base_capture.height);
         }
 
         D2DPaintInput input{};
         std::optional<core::TextDraftView> draft_text_view = std::nullopt;
         std::optional<core::Annotation> draft_obfuscate_preview = std::nullopt;
         std::vector<AnnotationPreviewPatch> patches;
-        core::Annotation const *paint_draft_annotation = controller_.Draft_annotation();
+        // A multi-point freehand draft is painted from its raw points; building
+        // its draft annotation would copy and smooth the whole stroke per frame.
+        bool const paints_freehand_points =
+            controller_.Draft_freehand_style().has_value() &&
+            controller_.Draft_freehand_points().size() != 1;
+        core::Annotation const *paint_draft_annotation =
+            paints_freehand_points ? nullptr : controller_.Draft_annotation();
         bool has_live_obfuscate_preview = false;
         {
             GREENFLAME_PROFILE_SCOPE("OverlayWindow::On_paint::Prepare_input");
@@ -4217,8 +4319,8 @@ LRESULT OverlayWindow::On_paint() {
         {
             GREENFLAME_PROFILE_SCOPE("OverlayWindow::On_paint::Paint_d2d_frame");
             ok = Paint_d2d_frame(
-                *d2d_resources_, input, resources_->display_capture.width,
-                resources_->display_capture.height, Active_top_layer());
+                *d2d_resources_, input, resources_->base_capture.width,
+                resources_->base_capture.height, Active_top_layer());
         }
         if (!ok) {
             Handle_device_loss();
@@ -4235,15 +4337,15 @@ LRESULT OverlayWindow::On_paint() {
 
 void OverlayWindow::Handle_device_loss() {
     if (!d2d_resources_ || resources_ == nullptr ||
-        !resources_->display_capture.Is_valid()) {
+        !resources_->base_capture.Is_valid()) {
         return;
     }
-    int const w = resources_->display_capture.width;
-    int const h = resources_->display_capture.height;
+    int const w = resources_->base_capture.width;
+    int const h = resources_->base_capture.height;
 
     d2d_resources_->Release_device_resources();
     if (!d2d_resources_->Create_hwnd_rt(hwnd_, w, h) ||
-        !d2d_resources_->Upload_screenshot(resources_->display_capture) ||
+        !d2d_resources_->Upload_screenshot(resources_->base_capture) ||
         !d2d_resources_->Create_shared_resources() ||
         !d2d_resources_->Create_cache_targets(w, h)) {
         controller_.Set_text_layout_engine(nullptr);
@@ -4253,9 +4355,9 @@ void OverlayWindow::Handle_device_loss() {
         InvalidateRect(hwnd_, nullptr, TRUE);
         return;
     }
-    if (resources_->window_capture.display_capture.Is_valid()) {
+    if (resources_->window_capture.base_capture.Is_valid()) {
         if (!d2d_resources_->Upload_lifted_window_capture(
-                resources_->window_capture.display_capture)) {
+                resources_->window_capture.base_capture)) {
             d2d_resources_->Clear_lifted_window_capture();
         }
     } else {
@@ -4278,7 +4380,38 @@ void OverlayWindow::Handle_device_loss() {
     InvalidateRect(hwnd_, nullptr, FALSE);
 }
 
+void OverlayWindow::Record_input_event(core::OverlayInputEventKind kind) {
+    if (input_recorder_.Is_recording()) {
+        input_recorder_.Record({.kind = kind});
+    }
+}
+
+void OverlayWindow::Save_recorded_input_trace() {
+    if (!input_recorder_.Is_recording()) {
+        return;
+    }
+    core::OverlayInputTrace const trace = input_recorder_.Take_trace();
+    if (config_ == nullptr || config_->overlay_input_trace_dir.empty() ||
+        trace.events.empty()) {
+        return;
+    }
+    std::filesystem::path const dir(config_->overlay_input_trace_dir);
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    std::filesystem::path const path = dir / Build_input_trace_file_name();
+    std::vector<uint8_t> const bytes = core::Encode_overlay_input_trace(trace);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<char const *>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        GREENFLAME_LOG_WRITE(L"overlay", L"Failed to write overlay input trace: " +
+                                             path.wstring());
+    }
+}
+
 LRESULT OverlayWindow::On_destroy() {
+    content_snap_edge_analyzer_.Cancel();
+    content_snap_edges_ = {};
     Clear_transient_center_label(false);
     caret_blink_visible_ = true;
     selected_annotation_marquee_phase_px_ = 0;
@@ -4301,6 +4434,7 @@ LRESULT OverlayWindow::On_destroy() {
     }
     resources_->Reset();
     controller_.Reset_for_session({});
+    Save_recorded_input_trace();
     if (events_) {
         events_->On_overlay_closed();
     }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "greenflame_core/content_snap_edges.h"
 #include "greenflame_core/overlay_controller.h"
 #include "greenflame_core/overlay_help_content.h"
+#include "greenflame_core/overlay_input_trace.h"
 #include "greenflame_core/rect_px.h"
 #include "greenflame_core/selection_wheel.h"
 #include "win/d2d_text_layout_engine.h"
@@ -23,6 +25,11 @@ class IOverlayEvents {
   public:
     virtual ~IOverlayEvents() = default;
     virtual void On_overlay_closed() = 0;
+    // The final pixels of a selection that is being copied or saved, before the
+    // matching copied/saved notification.
+    virtual void On_selection_captured(core::RectPx screen_rect,
+                                       std::optional<HWND> window,
+                                       GdiCaptureResult const &capture) = 0;
     virtual void On_selection_copied_to_clipboard(core::RectPx screen_rect,
                                                   std::optional<HWND> window) = 0;
     virtual bool On_selection_pinned_to_desktop(core::RectPx screen_rect,
@@ -40,7 +47,8 @@ class IOverlayEvents {
 class OverlayWindow final {
   public:
     OverlayWindow(IOverlayEvents *events, core::AppConfig *config,
-                  IWindowQuery *window_query);
+                  IWindowQuery *window_query,
+                  core::SaveDirectoryIndex *save_directory_index);
     ~OverlayWindow();
 
     OverlayWindow(OverlayWindow const &) = delete;
@@ -105,9 +113,10 @@ class OverlayWindow final {
     LRESULT On_l_button_up();
     LRESULT On_r_button_down();
     LRESULT On_timer(WPARAM wparam);
+    LRESULT On_content_snap_edges_ready();
 
     void Build_default_save_name(std::wstring_view save_dir_for_num_scan,
-                                 std::span<wchar_t> out) const;
+                                 std::span<wchar_t> out);
     [[nodiscard]] std::wstring Resolve_default_save_directory() const;
     [[nodiscard]] core::RectPx Selection_screen_rect() const;
     [[nodiscard]] core::RectPx Selection_visible_screen_rect() const;
@@ -123,6 +132,8 @@ class OverlayWindow final {
     LRESULT On_paint();
     LRESULT On_destroy();
     LRESULT On_close();
+    void Record_input_event(core::OverlayInputEventKind kind);
+    void Save_recorded_input_trace();
     LRESULT On_set_cursor(WPARAM wparam, LPARAM lparam);
     void Refresh_cursor();
     bool Refresh_hover_handle();
@@ -179,7 +190,10 @@ class OverlayWindow final {
     [[nodiscard]] bool Current_capture_has_captured_cursor() const noexcept;
     [[nodiscard]] std::wstring Build_captured_cursor_tooltip() const;
     [[nodiscard]] std::wstring Build_pin_tooltip() const;
-    [[nodiscard]] bool Rebuild_display_capture();
+    // Shows or hides the captured cursor in the desktop and window captures to match
+    // the config; each rect receives the pixels that changed in its capture.
+    [[nodiscard]] bool Sync_captured_cursor_layers(core::RectPx &desktop_changed,
+                                                   core::RectPx &window_changed);
     [[nodiscard]] core::RectPx
     Visible_window_rect_screen(core::RectPx window_rect_screen) const noexcept;
     [[nodiscard]] std::optional<HWND>
@@ -198,6 +212,8 @@ class OverlayWindow final {
     [[nodiscard]] OverlayButtonGlyph const *
     Resolve_toolbar_button_glyph(OverlayToolbarGlyphId glyph) const noexcept;
     [[nodiscard]] core::SnapEdges Collect_visible_snap_edges() const;
+    void Append_monitor_snap_edges(core::SnapEdges &snap_edges) const;
+    void Start_content_snap_edge_analysis(core::ContentEdgeLuma luma);
 
     void Rebuild_toolbar_buttons();
     [[nodiscard]] std::vector<core::PointPx>
@@ -242,15 +258,23 @@ class OverlayWindow final {
 
     IOverlayEvents *events_ = nullptr;
     core::AppConfig *config_ = nullptr;
+    core::SaveDirectoryIndex *save_directory_index_ = nullptr;
     IWindowQuery *window_query_ = nullptr;
     HWND hwnd_ = nullptr;
     HINSTANCE hinstance_ = nullptr;
     core::OverlayController controller_;
+    core::OverlayInputRecorder input_recorder_ = {};
     std::unique_ptr<OverlayResources> resources_;
     std::unique_ptr<ObfuscateSourceProvider> obfuscate_source_provider_;
     std::unique_ptr<D2DOverlayResources> d2d_resources_;
     std::unique_ptr<D2DTextLayoutEngine> text_layout_engine_;
     std::unique_ptr<Win32SpellCheckService> spell_check_service_;
+    // Reads resources_->base_capture on a background thread; declared after
+    // resources_ so it stops first.
+    core::ContentSnapEdgeAnalyzer content_snap_edge_analyzer_;
+    // Screen-space edges found in the capture so far; empty until the first
+    // analysis lands.
+    core::SnapEdges content_snap_edges_ = {};
     std::optional<core::SelectionHandle> last_hover_handle_;
     OverlayHelpOverlay hotkey_help_overlay_ = {};
     OverlayWarningDialog obfuscate_warning_dialog_ = {};
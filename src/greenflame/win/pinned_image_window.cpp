@@ -1,6 +1,8 @@
 #include "win/pinned_image_window.h"
 
 #include "greenflame_core/app_config.h"
+#include "greenflame_core/parallel_for.h"
+#include "greenflame_core/pixel_ops.h"
 #include "greenflame_core/save_image_policy.h"
 #include "win/save_image.h"
 
@@ -31,7 +33,6 @@ constexpr int kMiddleHaloWidthPx = 4;
 constexpr int kInnerHaloWidthPx = 2;
 constexpr int kInnerStrokeWidthPx = 1;
 constexpr float kArcQuarterSweepDeg = 90.f;
-constexpr int kDegreesPerQuarterTurn = 90;
 constexpr float kMinScaleDelta = 0.001f;
 constexpr wchar_t kCopyPinnedImageFailedMessage[] =
     L"Failed to copy the pinned image to the clipboard.";
@@ -132,13 +133,13 @@ void Append_rounded_rect_path(Gdiplus::GraphicsPath &path, Gdiplus::RectF rect,
     return (quarter_turns & 1) != 0;
 }
 
-void Calculate_display_dimensions(greenflame::GdiCaptureResult const &capture,
+void Calculate_display_dimensions(greenflame::core::BgraBitmap const &image,
                                   float scale, int quarter_turns, int &oriented_width,
                                   int &oriented_height) {
     float const clamped_scale = std::clamp(scale, kMinScale, kMaxScale);
-    float const scaled_width_value = static_cast<float>(capture.width) * clamped_scale;
+    float const scaled_width_value = static_cast<float>(image.width_px) * clamped_scale;
     float const scaled_height_value =
-        static_cast<float>(capture.height) * clamped_scale;
+        static_cast<float>(image.height_px) * clamped_scale;
     int const scaled_width =
         std::max(1, static_cast<int>(std::lround(scaled_width_value)));
     int const scaled_height =
@@ -194,22 +195,35 @@ void Draw_halo(Gdiplus::Graphics &graphics, Gdiplus::RectF image_rect, bool acti
     graphics.DrawPath(&stroke, &stroke_path);
 }
 
-[[nodiscard]] bool Draw_transformed_capture(Gdiplus::Graphics &graphics,
-                                            greenflame::GdiCaptureResult const &capture,
-                                            Gdiplus::RectF image_rect,
-                                            int quarter_turns, BYTE opacity_alpha) {
-    Gdiplus::Bitmap source_bitmap(capture.bitmap, nullptr);
+// Opaque copy of the pinned pixels; the pyramid and every zoom level derive from
+// it, so GDI+ only ever blits content that is already scaled and rotated.
+[[nodiscard]] greenflame::core::BgraBitmap
+Capture_to_bitmap(greenflame::GdiCaptureResult const &capture) {
+    std::span<uint8_t const> const pixels = greenflame::Capture_pixels(capture);
+    if (pixels.empty()) {
+        return {};
+    }
+    greenflame::core::BgraBitmap bitmap = {};
+    bitmap.width_px = capture.width;
+    bitmap.height_px = capture.height;
+    bitmap.row_bytes = greenflame::Row_bytes32(capture.width);
+    bitmap.premultiplied_bgra.assign(pixels.begin(), pixels.end());
+    greenflame::core::Force_alpha_opaque(bitmap.premultiplied_bgra);
+    return bitmap;
+}
+
+[[nodiscard]] bool Draw_content(Gdiplus::Graphics &graphics,
+                                greenflame::core::BgraBitmap const &content,
+                                Gdiplus::RectF image_rect, BYTE opacity_alpha) {
+    // GDI+ only reads the pixels of a bitmap drawn as a source.
+    BYTE *const scan0 = const_cast<BYTE *>(content.premultiplied_bgra.data());
+    Gdiplus::Bitmap source_bitmap(content.width_px, content.height_px,
+                                  static_cast<INT>(content.row_bytes),
+                                  PixelFormat32bppPARGB, scan0);
     if (source_bitmap.GetLastStatus() != Gdiplus::Ok) {
         return false;
     }
 
-    float draw_width = image_rect.Width;
-    float draw_height = image_rect.Height;
-    if (Quarter_turns_swap_dimensions(quarter_turns)) {
-        draw_width = image_rect.Height;
-        draw_height = image_rect.Width;
-    }
-
     Gdiplus::ImageAttributes image_attributes;
     float const alpha = static_cast<float>(opacity_alpha) / static_cast<float>(255);
     Gdiplus::ColorMatrix const color_matrix = {{
@@ -222,18 +236,12 @@ void Draw_halo(Gdiplus::Graphics &graphics, Gdiplus::RectF image_rect, bool acti
     image_attributes.SetColorMatrix(&color_matrix, Gdiplus::ColorMatrixFlagsDefault,
                                     Gdiplus::ColorAdjustTypeBitmap);
 
-    float const center_x = image_rect.X + (image_rect.Width * 0.5f);
-    float const center_y = image_rect.Y + (image_rect.Height * 0.5f);
-    graphics.TranslateTransform(center_x, center_y);
-    graphics.RotateTransform(
-        static_cast<Gdiplus::REAL>(quarter_turns * kDegreesPerQuarterTurn));
-    Gdiplus::RectF draw_rect(-(draw_width * 0.5f), -(draw_height * 0.5f), draw_width,
-                             draw_height);
-    graphics.DrawImage(&source_bitmap, draw_rect, 0.f, 0.f,
-                       static_cast<Gdiplus::REAL>(capture.width),
-                       static_cast<Gdiplus::REAL>(capture.height), Gdiplus::UnitPixel,
-                       &image_attributes);
-    graphics.ResetTransform();
+    // Content matches image_rect pixel for pixel; no filtering is wanted here.
+    graphics.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
+    graphics.DrawImage(&source_bitmap, image_rect, 0.f, 0.f,
+                       static_cast<Gdiplus::REAL>(content.width_px),
+                       static_cast<Gdiplus::REAL>(content.height_px),
+                       Gdiplus::UnitPixel, &image_attributes);
     return true;
 }
 
@@ -307,10 +315,7 @@ PinnedImageWindow::PinnedImageWindow(IPinnedImageWindowEvents *events,
                                      core::AppConfig *config)
     : events_(events), config_(config) {}
 
-PinnedImageWindow::~PinnedImageWindow() {
-    Destroy();
-    capture_.Free();
-}
+PinnedImageWindow::~PinnedImageWindow() { Destroy(); }
 
 bool PinnedImageWindow::Register_window_class(HINSTANCE hinstance) {
     WNDCLASSEXW window_class = {};
@@ -332,11 +337,19 @@ bool PinnedImageWindow::Create(HINSTANCE hinstance, GdiCaptureResult &capture,
 
     hinstance_ = hinstance;
     initial_screen_rect_ = screen_rect;
-    Take_capture_ownership(capture);
+    // The pyramid base is the only copy of the pixels a pin keeps; the capture
+    // is released as soon as the base exists.
+    pyramid_.Reset(Capture_to_bitmap(capture));
+    capture.Free();
+    rendered_content_ = {};
+    if (!pyramid_.Has_image()) {
+        hinstance_ = nullptr;
+        return false;
+    }
 
     int image_width = 0;
     int image_height = 0;
-    Calculate_display_dimensions(capture_, scale_, quarter_turns_clockwise_,
+    Calculate_display_dimensions(pyramid_.Base(), scale_, quarter_turns_clockwise_,
                                  image_width, image_height);
     int const window_width = image_width + (kHaloPaddingPx * 2);
     int const window_height = image_height + (kHaloPaddingPx * 2);
@@ -346,7 +359,7 @@ bool PinnedImageWindow::Create(HINSTANCE hinstance, GdiCaptureResult &capture,
         WS_POPUP, screen_rect.left - kHaloPaddingPx, screen_rect.top - kHaloPaddingPx,
         window_width, window_height, nullptr, nullptr, hinstance_, this);
     if (hwnd == nullptr) {
-        capture_.Free();
+        pyramid_.Reset({});
         hinstance_ = nullptr;
         return false;
     }
@@ -376,16 +389,6 @@ bool PinnedImageWindow::Is_open() const noexcept {
     return hwnd_ != nullptr && IsWindow(hwnd_) != 0;
 }
 
-void PinnedImageWindow::Take_capture_ownership(GdiCaptureResult &capture) noexcept {
-    capture_.Free();
-    capture_.bitmap = capture.bitmap;
-    capture_.width = capture.width;
-    capture_.height = capture.height;
-    capture.bitmap = nullptr;
-    capture.width = 0;
-    capture.height = 0;
-}
-
 void PinnedImageWindow::Bring_to_front() noexcept {
     if (!Is_open()) {
         return;
@@ -418,13 +421,13 @@ core::PointPx PinnedImageWindow::Current_window_center_screen() const noexcept {
 
 bool PinnedImageWindow::Refresh_layered_window(
     std::optional<core::PointPx> preserve_center_screen) {
-    if (!Is_open() || !capture_.Is_valid() || !Ensure_gdiplus()) {
+    if (!Is_open() || !pyramid_.Has_image() || !Ensure_gdiplus()) {
         return false;
     }
 
     int content_width = 0;
     int content_height = 0;
-    Calculate_display_dimensions(capture_, scale_, quarter_turns_clockwise_,
+    Calculate_display_dimensions(pyramid_.Base(), scale_, quarter_turns_clockwise_,
                                  content_width, content_height);
     int const window_width = content_width + (kHaloPaddingPx * 2);
     int const window_height = content_height + (kHaloPaddingPx * 2);
@@ -457,7 +460,6 @@ bool PinnedImageWindow::Refresh_layered_window(
 
     Gdiplus::Graphics graphics(&canvas);
     graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
-    graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
     graphics.SetPixelOffsetMode(Gdiplus::PixelOffsetModeHalf);
     graphics.Clear(Gdiplus::Color(0, 0, 0, 0));
 
@@ -469,8 +471,10 @@ bool PinnedImageWindow::Refresh_layered_window(
     BYTE const opacity_alpha = static_cast<BYTE>(
         std::clamp(opacity_percent_, kMinOpacityPercent, kMaxOpacityPercent) * 255 /
         100);
-    if (!Draw_transformed_capture(graphics, capture_, image_rect,
-                                  quarter_turns_clockwise_, opacity_alpha)) {
+    core::BgraBitmap const *const content =
+        Prepare_content(content_width, content_height);
+    if (content == nullptr ||
+        !Draw_content(graphics, *content, image_rect, opacity_alpha)) {
         return false;
     }
 
@@ -486,48 +490,67 @@ bool PinnedImageWindow::Refresh_layered_window(
 
 bool PinnedImageWindow::Build_export_capture(GdiCaptureResult &out) const {
     out.Free();
-    if (!capture_.Is_valid() || !Ensure_gdiplus()) {
+    if (!pyramid_.Has_image()) {
         return false;
     }
 
-    int export_width = 0;
-    int export_height = 0;
-    Calculate_display_dimensions(capture_, 1.f, quarter_turns_clockwise_, export_width,
-                                 export_height);
-    if (!Create_solid_capture(export_width, export_height, RGB(0, 0, 0), out)) {
+    // Exports are unscaled, so only the rotation applies.
+    core::BgraBitmap const rotated =
+        core::Rotate_bitmap_quarter_turns(pyramid_.Base(), quarter_turns_clockwise_);
+    if (!rotated.Is_valid() ||
+        !Create_solid_capture(rotated.width_px, rotated.height_px, RGB(0, 0, 0), out)) {
         return false;
     }
 
-    HDC const screen_dc = GetDC(nullptr);
-    if (screen_dc == nullptr) {
+    std::span<uint8_t> const pixels = Capture_pixels(out);
+    if (pixels.empty()) {
         out.Free();
         return false;
     }
+    size_t const row_bytes = static_cast<size_t>(rotated.row_bytes);
+    for (int32_t row = 0; row < rotated.height_px; ++row) {
+        size_t const offset = static_cast<size_t>(row) * row_bytes;
+        std::copy_n(rotated.premultiplied_bgra.begin() +
+                        static_cast<std::ptrdiff_t>(offset),
+                    row_bytes, pixels.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+    return true;
+}
 
-    bool ok = false;
-    HDC const memory_dc = CreateCompatibleDC(screen_dc);
-    if (memory_dc != nullptr) {
-        HGDIOBJ const old_bitmap = SelectObject(memory_dc, out.bitmap);
-        if (old_bitmap != nullptr && old_bitmap != HGDI_ERROR) {
-            Gdiplus::Graphics graphics(memory_dc);
-            graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
-            graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
-            graphics.Clear(Gdiplus::Color(255, 0, 0, 0));
-            Gdiplus::RectF const image_rect(0.f, 0.f,
-                                            static_cast<Gdiplus::REAL>(export_width),
-                                            static_cast<Gdiplus::REAL>(export_height));
-            ok = Draw_transformed_capture(graphics, capture_, image_rect,
-                                          quarter_turns_clockwise_, 255);
-            SelectObject(memory_dc, old_bitmap);
-        }
-        DeleteDC(memory_dc);
+core::BgraBitmap const *PinnedImageWindow::Prepare_content(int content_width,
+                                                           int content_height) {
+    bool const swaps = Quarter_turns_swap_dimensions(quarter_turns_clockwise_);
+    int const width = swaps ? content_height : content_width;
+    int const height = swaps ? content_width : content_height;
+    core::BgraBitmap const &base = pyramid_.Base();
+    bool const unscaled = base.width_px == width && base.height_px == height;
+    if (unscaled && quarter_turns_clockwise_ == 0) {
+        // 1:1 and upright: draw the base instead of keeping a second full copy.
+        rendered_content_ = {};
+        return &base;
+    }
+    if (rendered_content_.Is_valid() && rendered_content_.width_px == content_width &&
+        rendered_content_.height_px == content_height &&
+        rendered_quarter_turns_ == quarter_turns_clockwise_) {
+        return &rendered_content_;
     }
-    ReleaseDC(nullptr, screen_dc);
 
-    if (!ok) {
-        out.Free();
+    if (unscaled) {
+        rendered_content_ =
+            core::Rotate_bitmap_quarter_turns(base, quarter_turns_clockwise_);
+    } else {
+        std::optional<core::BgraBitmap> const scaled =
+            pyramid_.Resample(width, height, core::ResampleFilter::Lanczos3,
+                              core::Default_parallel_workers());
+        if (!scaled.has_value()) {
+            rendered_content_ = {};
+            return nullptr;
+        }
+        rendered_content_ =
+            core::Rotate_bitmap_quarter_turns(*scaled, quarter_turns_clockwise_);
     }
-    return ok;
+    rendered_quarter_turns_ = quarter_turns_clockwise_;
+    return &rendered_content_;
 }
 
 void PinnedImageWindow::Copy_to_clipboard() {
@@ -615,7 +638,7 @@ void PinnedImageWindow::Save_to_file() {
 }
 
 void PinnedImageWindow::Rotate(int32_t delta_quarter_turns) {
-    if (!capture_.Is_valid()) {
+    if (!pyramid_.Has_image()) {
         return;
     }
 
@@ -627,7 +650,7 @@ void PinnedImageWindow::Rotate(int32_t delta_quarter_turns) {
 }
 
 void PinnedImageWindow::Zoom(int32_t delta_steps) {
-    if (!capture_.Is_valid() || delta_steps == 0) {
+    if (!pyramid_.Has_image() || delta_steps == 0) {
         return;
     }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "greenflame_core/image_resample.h"
 #include "greenflame_core/rect_px.h"
 #include "win/gdi_capture.h"
 
@@ -39,7 +40,6 @@ class PinnedImageWindow final {
                                             LPARAM lparam);
     LRESULT Wnd_proc(UINT msg, WPARAM wparam, LPARAM lparam);
 
-    void Take_capture_ownership(GdiCaptureResult &capture) noexcept;
     void Show_context_menu(POINT screen_point);
     void Start_drag(core::PointPx cursor_screen);
     void Update_drag(core::PointPx cursor_screen);
@@ -49,6 +49,10 @@ class PinnedImageWindow final {
     [[nodiscard]] bool Refresh_layered_window(
         std::optional<core::PointPx> preserve_center_screen = std::nullopt);
     [[nodiscard]] bool Build_export_capture(GdiCaptureResult &out) const;
+    // Scaled and rotated pixels for the current zoom; reused until either changes.
+    // At 1:1 with no rotation this is the pyramid base itself.
+    [[nodiscard]] core::BgraBitmap const *Prepare_content(int content_width,
+                                                          int content_height);
     void Copy_to_clipboard();
     void Save_to_file();
     void Rotate(int32_t delta_quarter_turns);
@@ -60,7 +64,9 @@ class PinnedImageWindow final {
     core::AppConfig *config_ = nullptr;
     HWND hwnd_ = nullptr;
     HINSTANCE hinstance_ = nullptr;
-    GdiCaptureResult capture_ = {};
+    core::ResampleMipPyramid pyramid_ = {};
+    core::BgraBitmap rendered_content_ = {};
+    int rendered_quarter_turns_ = 0;
     core::RectPx initial_screen_rect_ = {};
     int quarter_turns_clockwise_ = 0;
     int opacity_percent_ = 100;
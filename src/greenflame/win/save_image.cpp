@@ -1,8 +1,10 @@
-// Save GdiCaptureResult to PNG or JPEG via Windows Imaging Component (WIC).
+// Save GdiCaptureResult to PNG or JPEG via Windows Imaging Component (WIC), or
+// encode it into memory.
 
 #include "win/save_image.h"
 
 #include "greenflame_core/app_config.h"
+#include "greenflame_core/export_compositor.h"
 #include "greenflame_core/save_image_policy.h"
 
 #pragma comment(lib, "Windowscodecs.lib")
@@ -36,9 +38,50 @@ struct CoInitGuard {
     CoInitGuard &operator=(const CoInitGuard &) = delete;
 };
 
-bool Save_capture_via_wic(GdiCaptureResult const &capture, wchar_t const *path,
+// Where an encoder writes: the file at `path`, or `memory` when path is null.
+struct EncodeTarget final {
+    wchar_t const *path = nullptr;
+    std::vector<uint8_t> *memory = nullptr;
+};
+
+bool Open_encode_stream(IWICImagingFactory *factory, EncodeTarget const &target,
+                        ComPtr<IStream> &stream) {
+    if (target.path) {
+        ComPtr<IWICStream> wic_stream;
+        HRESULT hr = factory->CreateStream(&wic_stream);
+        if (FAILED(hr) || !wic_stream) return false;
+        hr = wic_stream->InitializeFromFilename(target.path, GENERIC_WRITE);
+        if (FAILED(hr)) return false;
+        // IWICStream is an IStream; hand the reference over.
+        stream.p = wic_stream.p;
+        wic_stream.p = nullptr;
+        return true;
+    }
+    if (!target.memory) return false;
+    HRESULT const hr = CreateStreamOnHGlobal(nullptr, TRUE, &stream);
+    return SUCCEEDED(hr) && stream;
+}
+
+bool Copy_memory_stream(IStream *stream, std::vector<uint8_t> &bytes) {
+    STATSTG stat{};
+    HRESULT hr = stream->Stat(&stat, STATFLAG_NONAME);
+    if (FAILED(hr) || stat.cbSize.HighPart != 0) return false;
+    try {
+        bytes.resize(stat.cbSize.LowPart);
+    } catch (std::bad_alloc const &) {
+        return false;
+    }
+    LARGE_INTEGER const start = {};
+    hr = stream->Seek(start, STREAM_SEEK_SET, nullptr);
+    if (FAILED(hr)) return false;
+    ULONG read = 0;
+    hr = stream->Read(bytes.data(), static_cast<ULONG>(bytes.size()), &read);
+    return SUCCEEDED(hr) && read == bytes.size();
+}
+
+bool Save_capture_via_wic(GdiCaptureResult const &capture, EncodeTarget const &target,
                           REFGUID container_format) {
-    if (!capture.Is_valid() || !path) return false;
+    if (!capture.Is_valid()) return false;
 
     HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
     bool coinit = SUCCEEDED(hr);
@@ -63,12 +106,8 @@ bool Save_capture_via_wic(GdiCaptureResult const &capture, wchar_t const *path,
         &wic_bitmap);
     if (FAILED(hr) || !wic_bitmap) return false;
 
-    ComPtr<IWICStream> stream;
-    hr = factory->CreateStream(&stream);
-    if (FAILED(hr) || !stream) return false;
-
-    hr = stream->InitializeFromFilename(path, GENERIC_WRITE);
-    if (FAILED(hr)) return false;
+    ComPtr<IStream> stream;
+    if (!Open_encode_stream(factory.p, target, stream)) return false;
 
     ComPtr<IWICBitmapEncoder> encoder;
     hr = factory->CreateEncoder(container_format, nullptr, &encoder);
@@ -104,7 +143,146 @@ bool Save_capture_via_wic(GdiCaptureResult const &capture, wchar_t const *path,
     if (FAILED(hr)) return false;
 
     hr = encoder->Commit();
-    return SUCCEEDED(hr);
+    if (FAILED(hr)) return false;
+    return !target.memory || Copy_memory_stream(stream.p, *target.memory);
+}
+
+// Feeds composed rows to IWICBitmapFrameEncode::WritePixels, converting to the
+// encoder's pixel format when it does not take 32bpp BGRA (JPEG wants 24bpp).
+class WicFrameRowSink final : public core::IExportRowSink {
+  public:
+    WicFrameRowSink(IWICBitmapFrameEncode *frame, bool packed_bgr) noexcept
+        : frame_(frame), packed_bgr_(packed_bgr) {}
+
+    [[nodiscard]] bool Write_rows(int32_t, int32_t row_count,
+                                  std::span<const uint8_t> rows,
+                                  size_t row_bytes) override {
+        if (!packed_bgr_) {
+            // WritePixels does not modify the buffer despite the non-const pointer.
+            return SUCCEEDED(frame_->WritePixels(
+                static_cast<UINT>(row_count), static_cast<UINT>(row_bytes),
+                static_cast<UINT>(rows.size()), const_cast<BYTE *>(rows.data())));
+        }
+        size_t const pixels_per_row = row_bytes / 4u;
+        size_t const packed_row_bytes = pixels_per_row * 3u;
+        packed_.resize(packed_row_bytes * static_cast<size_t>(row_count));
+        size_t out = 0;
+        for (size_t in = 0; in + 4u <= rows.size(); in += 4u) {
+            packed_[out++] = rows[in];
+            packed_[out++] = rows[in + 1u];
+            packed_[out++] = rows[in + 2u];
+        }
+        return SUCCEEDED(frame_->WritePixels(
+            static_cast<UINT>(row_count), static_cast<UINT>(packed_row_bytes),
+            static_cast<UINT>(packed_.size()), packed_.data()));
+    }
+
+  private:
+    IWICBitmapFrameEncode *frame_ = nullptr;
+    bool packed_bgr_ = false;
+    std::vector<uint8_t> packed_ = {};
+};
+
+bool Save_export_via_wic(core::ExportCompositeSpec const &spec,
+                         core::ExportCompositeOptions const &options, int32_t width,
+                         int32_t height, EncodeTarget const &target,
+                         REFGUID container_format) {
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+    bool coinit = SUCCEEDED(hr);
+    if (hr == RPC_E_CHANGED_MODE) {
+        coinit = false;
+    } else if (FAILED(hr)) {
+        return false;
+    }
+    CoInitGuard co_guard(coinit);
+
+    ComPtr<IWICImagingFactory> factory;
+    hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+                          IID_PPV_ARGS(&factory));
+    if (FAILED(hr) || !factory) return false;
+
+    ComPtr<IStream> stream;
+    if (!Open_encode_stream(factory.p, target, stream)) return false;
+
+    ComPtr<IWICBitmapEncoder> encoder;
+    hr = factory->CreateEncoder(container_format, nullptr, &encoder);
+    if (FAILED(hr) || !encoder) return false;
+
+    hr = encoder->Initialize(stream.p, WICBitmapEncoderNoCache);
+    if (FAILED(hr)) return false;
+
+    ComPtr<IWICBitmapFrameEncode> frame_encode;
+    IPropertyBag2 *props = nullptr;
+    hr = encoder->CreateNewFrame(&frame_encode, &props);
+    if (FAILED(hr) || !frame_encode) return false;
+    if (props) {
+        props->Release();
+        props = nullptr;
+    }
+
+    hr = frame_encode->Initialize(nullptr);
+    if (FAILED(hr)) return false;
+
+    hr = frame_encode->SetSize(static_cast<UINT>(width), static_cast<UINT>(height));
+    if (FAILED(hr)) return false;
+
+    // Composed rows are opaque, so BGR without alpha is an exact substitute.
+    WICPixelFormatGUID pixel_format = GUID_WICPixelFormat32bppBGRA;
+    hr = frame_encode->SetPixelFormat(&pixel_format);
+    if (FAILED(hr)) return false;
+    bool const packed_bgr = IsEqualGUID(pixel_format, GUID_WICPixelFormat24bppBGR);
+    if (!packed_bgr && !IsEqualGUID(pixel_format, GUID_WICPixelFormat32bppBGRA) &&
+        !IsEqualGUID(pixel_format, GUID_WICPixelFormat32bppBGR)) {
+        return false;
+    }
+
+    WicFrameRowSink sink(frame_encode.p, packed_bgr);
+    if (!core::Compose_export(spec, options, sink)) return false;
+
+    hr = frame_encode->Commit();
+    if (FAILED(hr)) return false;
+
+    hr = encoder->Commit();
+    if (FAILED(hr)) return false;
+    return !target.memory || Copy_memory_stream(stream.p, *target.memory);
+}
+
+bool Save_export_via_dib(core::ExportCompositeSpec const &spec,
+                         core::ExportCompositeOptions const &options, int32_t width,
+                         int32_t height, wchar_t const *path) {
+    BITMAPINFO bitmap_info = {};
+    Fill_bmi32_top_down(bitmap_info.bmiHeader, width, height);
+    HDC const screen_dc = GetDC(nullptr);
+    if (screen_dc == nullptr) return false;
+    void *bits = nullptr;
+    HBITMAP const bitmap = CreateDIBSection(screen_dc, &bitmap_info, DIB_RGB_COLORS,
+                                            &bits, nullptr, 0);
+    ReleaseDC(nullptr, screen_dc);
+    if (bitmap == nullptr || bits == nullptr) {
+        if (bitmap != nullptr) DeleteObject(bitmap);
+        return false;
+    }
+
+    GdiCaptureResult canvas{};
+    canvas.bitmap = bitmap;
+    canvas.width = width;
+    canvas.height = height;
+    size_t const row_bytes = static_cast<size_t>(Row_bytes32(width));
+    CLANG_WARN_IGNORE_PUSH("-Wunsafe-buffer-usage-in-container")
+    std::span<uint8_t> const pixels{reinterpret_cast<uint8_t *>(bits),
+                                    row_bytes * static_cast<size_t>(height)};
+    CLANG_WARN_IGNORE_POP()
+    core::ImageRowTargetSink sink(core::ImageRowTarget{pixels, row_bytes});
+    bool const saved =
+        core::Compose_export(spec, options, sink) && Save_capture_to_bmp(canvas, path);
+    canvas.Free();
+    return saved;
+}
+
+REFGUID Container_format_for(core::ImageSaveFormat format) {
+    if (format == core::ImageSaveFormat::Jpeg) return GUID_ContainerFormatJpeg;
+    if (format == core::ImageSaveFormat::Bmp) return GUID_ContainerFormatBmp;
+    return GUID_ContainerFormatPng;
 }
 
 [[nodiscard]] std::wstring Build_suffixed_path(std::wstring_view path,
@@ -147,7 +325,8 @@ bool Save_capture_via_wic(GdiCaptureResult const &capture, wchar_t const *path,
 } // namespace
 
 bool Save_capture_to_png(GdiCaptureResult const &capture, wchar_t const *path) {
-    return Save_capture_via_wic(capture, path, GUID_ContainerFormatPng);
+    if (!path) return false;
+    return Save_capture_via_wic(capture, EncodeTarget{path}, GUID_ContainerFormatPng);
 }
 
 bool Save_capture_to_file(GdiCaptureResult const &capture, wchar_t const *path,
@@ -162,7 +341,42 @@ bool Save_capture_to_file(GdiCaptureResult const &capture, wchar_t const *path,
 }
 
 bool Save_capture_to_jpeg(GdiCaptureResult const &capture, wchar_t const *path) {
-    return Save_capture_via_wic(capture, path, GUID_ContainerFormatJpeg);
+    if (!path) return false;
+    return Save_capture_via_wic(capture, EncodeTarget{path}, GUID_ContainerFormatJpeg);
+}
+
+bool Encode_capture_to_memory(GdiCaptureResult const &capture,
+                              core::ImageSaveFormat format,
+                              std::vector<uint8_t> &bytes) {
+    bytes.clear();
+    return Save_capture_via_wic(capture, EncodeTarget{nullptr, &bytes},
+                                Container_format_for(format));
+}
+
+bool Save_export_to_file(core::ExportCompositeSpec const &spec,
+                         core::ExportCompositeOptions const &options,
+                         wchar_t const *path, core::ImageSaveFormat format) {
+    int32_t width = 0;
+    int32_t height = 0;
+    if (!path || !core::Try_get_export_size(spec, width, height)) return false;
+    if (format == core::ImageSaveFormat::Bmp) {
+        return Save_export_via_dib(spec, options, width, height, path);
+    }
+    return Save_export_via_wic(spec, options, width, height, EncodeTarget{path},
+                               Container_format_for(format));
+}
+
+bool Encode_export_to_memory(core::ExportCompositeSpec const &spec,
+                             core::ExportCompositeOptions const &options,
+                             core::ImageSaveFormat format,
+                             std::vector<uint8_t> &bytes) {
+    bytes.clear();
+    int32_t width = 0;
+    int32_t height = 0;
+    if (!core::Try_get_export_size(spec, width, height)) return false;
+    return Save_export_via_wic(spec, options, width, height,
+                               EncodeTarget{nullptr, &bytes},
+                               Container_format_for(format));
 }
 
 std::wstring Reserve_unique_file_path(std::wstring_view desired_path) noexcept {
@@ -7,6 +7,8 @@
 namespace greenflame::core {
 enum class ImageSaveFormat : uint8_t;
 struct AppConfig;
+struct ExportCompositeOptions;
+struct ExportCompositeSpec;
 } // namespace greenflame::core
 
 namespace greenflame {
@@ -19,6 +21,23 @@ bool Save_capture_to_jpeg(GdiCaptureResult const &capture, wchar_t const *path);
 bool Save_capture_to_file(GdiCaptureResult const &capture, wchar_t const *path,
                           core::ImageSaveFormat format);
 
+// Composes `spec` with core::Compose_export and hands each finished band of rows
+// straight to the PNG or JPEG encoder, so the padded image never exists as a
+// whole frame. BMP output is composed into one DIB and written as before.
+bool Save_export_to_file(core::ExportCompositeSpec const &spec,
+                         core::ExportCompositeOptions const &options,
+                         wchar_t const *path, core::ImageSaveFormat format);
+
+// In-memory counterparts for non-file output sinks. All formats, BMP included,
+// go through the WIC encoders.
+bool Encode_capture_to_memory(GdiCaptureResult const &capture,
+                              core::ImageSaveFormat format,
+                              std::vector<uint8_t> &bytes);
+bool Encode_export_to_memory(core::ExportCompositeSpec const &spec,
+                             core::ExportCompositeOptions const &options,
+                             core::ImageSaveFormat format,
+                             std::vector<uint8_t> &bytes);
+
 // Atomically reserves a writable file path. The returned file path exists
 // (created as an empty placeholder) and is unique at reservation time.
 // If the requested path is already taken, a numeric suffix is appended.
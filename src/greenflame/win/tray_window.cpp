@@ -2,6 +2,7 @@
 
 #include "win/tray_window.h"
 #include "app_config_store.h"
+#include "greenflame_core/trace_recorder.h"
 #include "win/about_dialog.h"
 #include "win/debug_log.h"
 #include "win/ui_palette.h"
@@ -31,6 +32,10 @@ enum CommandId : int {
     OpenConfig = 9,
     About = 10,
     Exit = 11,
+    CopyLastCapture = 12,
+    RecordTrace = 13,
+    SaveLastCapture = 14,
+    PinLastCapture = 15,
 };
 
 enum HotkeyId : int {
@@ -84,8 +89,12 @@ constexpr wchar_t kCaptureFullScreenMenuText[] =
 constexpr wchar_t kCaptureLastRegionMenuText[] = L"Capture last region\tAlt + Prt Scrn";
 constexpr wchar_t kCaptureLastWindowMenuText[] =
     L"Capture last window\tCtrl + Alt + Prt Scrn";
+constexpr wchar_t kCopyLastCaptureMenuText[] = L"Copy last capture again";
+constexpr wchar_t kSaveLastCaptureMenuText[] = L"Save last capture again";
+constexpr wchar_t kPinLastCaptureMenuText[] = L"Pin last capture again";
 constexpr wchar_t kIncludeCursorMenuText[] = L"Include captured cursor";
 constexpr wchar_t kStartWithWindowsMenuText[] = L"Start with Windows";
+constexpr wchar_t kRecordTraceMenuText[] = L"Record performance trace";
 constexpr wchar_t kOpenConfigMenuText[] = L"Open config file...";
 constexpr wchar_t kAboutMenuText[] = L"About Greenflame...";
 
@@ -1232,12 +1241,24 @@ LRESULT TrayWindow::Wnd_proc(UINT msg, WPARAM wparam, LPARAM lparam) {
         case CopyLastWindow:
             Notify_copy_last_window_to_clipboard();
             break;
+        case CopyLastCapture:
+            Notify_copy_last_capture_to_clipboard();
+            break;
+        case SaveLastCapture:
+            Notify_save_last_capture();
+            break;
+        case PinLastCapture:
+            Notify_pin_last_capture();
+            break;
         case IncludeCursor:
             Notify_toggle_include_cursor();
             break;
         case StartWithWindows:
             Notify_toggle_start_with_windows();
             break;
+        case RecordTrace:
+            Notify_toggle_trace_recording();
+            break;
         case OpenConfig:
             Open_config_file();
             break;
@@ -1351,6 +1372,9 @@ void TrayWindow::Show_context_menu() {
     AppendMenuW(menu, MF_SEPARATOR, 0, nullptr);
     AppendMenuW(menu, MF_STRING, CopyLastRegion, kCaptureLastRegionMenuText);
     AppendMenuW(menu, MF_STRING, CopyLastWindow, kCaptureLastWindowMenuText);
+    AppendMenuW(menu, MF_STRING, CopyLastCapture, kCopyLastCaptureMenuText);
+    AppendMenuW(menu, MF_STRING, SaveLastCapture, kSaveLastCaptureMenuText);
+    AppendMenuW(menu, MF_STRING, PinLastCapture, kPinLastCaptureMenuText);
     AppendMenuW(menu, MF_SEPARATOR, 0, nullptr);
     UINT include_cursor_flags = MF_STRING;
     if (events_ != nullptr && events_->Is_include_cursor_enabled()) {
@@ -1363,6 +1387,13 @@ void TrayWindow::Show_context_menu() {
     }
     AppendMenuW(menu, start_with_windows_flags, StartWithWindows,
                 kStartWithWindowsMenuText);
+    if constexpr (core::kTraceRecorderCompiledIn) {
+        UINT record_trace_flags = MF_STRING;
+        if (events_ != nullptr && events_->Is_trace_recording_enabled()) {
+            record_trace_flags |= MF_CHECKED;
+        }
+        AppendMenuW(menu, record_trace_flags, RecordTrace, kRecordTraceMenuText);
+    }
     AppendMenuW(menu, MF_SEPARATOR, 0, nullptr);
     AppendMenuW(menu, MF_STRING, OpenConfig, kOpenConfigMenuText);
     AppendMenuW(menu, MF_SEPARATOR, 0, nullptr);
@@ -1433,6 +1464,24 @@ void TrayWindow::Notify_copy_last_window_to_clipboard() {
     }
 }
 
+void TrayWindow::Notify_copy_last_capture_to_clipboard() {
+    if (events_) {
+        events_->On_copy_last_capture_to_clipboard_requested();
+    }
+}
+
+void TrayWindow::Notify_save_last_capture() {
+    if (events_) {
+        events_->On_save_last_capture_requested();
+    }
+}
+
+void TrayWindow::Notify_pin_last_capture() {
+    if (events_) {
+        events_->On_pin_last_capture_requested();
+    }
+}
+
 void TrayWindow::Notify_toggle_include_cursor() {
     if (!events_) {
         return;
@@ -1451,4 +1500,11 @@ void TrayWindow::Notify_toggle_start_with_windows() {
     }
 }
 
+void TrayWindow::Notify_toggle_trace_recording() {
+    if (!events_) {
+        return;
+    }
+    events_->On_set_trace_recording_enabled(!events_->Is_trace_recording_enabled());
+}
+
 } // namespace greenflame
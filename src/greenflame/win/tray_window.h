@@ -22,9 +22,15 @@ class ITrayEvents {
     virtual void On_copy_desktop_to_clipboard_requested() = 0;
     virtual void On_copy_last_region_to_clipboard_requested() = 0;
     virtual void On_copy_last_window_to_clipboard_requested() = 0;
+    virtual void On_copy_last_capture_to_clipboard_requested() = 0;
+    virtual void On_save_last_capture_requested() = 0;
+    virtual void On_pin_last_capture_requested() = 0;
     [[nodiscard]] virtual bool Is_include_cursor_enabled() const = 0;
     [[nodiscard]] virtual bool On_set_include_cursor_enabled(bool enabled) = 0;
     [[nodiscard]] virtual bool On_set_start_with_windows_enabled(bool enabled) = 0;
+    // Only reachable in builds with the trace recorder compiled in.
+    [[nodiscard]] virtual bool Is_trace_recording_enabled() const = 0;
+    virtual void On_set_trace_recording_enabled(bool enabled) = 0;
     virtual void On_exit_requested() = 0;
 };
 
@@ -63,8 +69,12 @@ class TrayWindow final {
     void Notify_copy_desktop_to_clipboard();
     void Notify_copy_last_region_to_clipboard();
     void Notify_copy_last_window_to_clipboard();
+    void Notify_copy_last_capture_to_clipboard();
+    void Notify_save_last_capture();
+    void Notify_pin_last_capture();
     void Notify_toggle_include_cursor();
     void Notify_toggle_start_with_windows();
+    void Notify_toggle_trace_recording();
 
     ITrayEvents *events_ = nullptr;
     HWND hwnd_ = nullptr;
@@ -1,4 +1,6 @@
 #include "win/wgc_window_capture.h"
+#include "greenflame_core/hdr_tone_map.h"
+#include "greenflame_core/parallel_for.h"
 #include "win/debug_log.h"
 
 namespace {
@@ -498,11 +500,100 @@ Try_create_capture_item(HWND hwnd, GraphicsCaptureItem &item,
     return true;
 }
 
-[[nodiscard]] bool Try_copy_frame_to_capture(ID3D11Device *device,
-                                             ID3D11DeviceContext *context,
-                                             Direct3D11CaptureFrame const &frame,
-                                             greenflame::GdiCaptureResult &capture,
-                                             std::wstring &error_message) {
+// How the desktop under the target window is composed. When it is HDR the frame
+// pool is asked for FP16 scRGB and the frame is tone mapped to sRGB on readback;
+// an 8-bit pool would have Windows clip everything above SDR white.
+struct WgcDisplayColor final {
+    bool hdr = false;
+    greenflame::core::HdrToneMapSettings tone_map = {};
+};
+
+// "SDR content brightness" of the display driven by `gdi_device_name`.
+[[nodiscard]] float Query_sdr_white_nits(wchar_t const *gdi_device_name) {
+    UINT32 path_count = 0;
+    UINT32 mode_count = 0;
+    if (GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &path_count,
+                                    &mode_count) != ERROR_SUCCESS) {
+        return greenflame::core::kDefaultSdrWhiteNits;
+    }
+    std::vector<DISPLAYCONFIG_PATH_INFO> paths(path_count);
+    std::vector<DISPLAYCONFIG_MODE_INFO> modes(mode_count);
+    if (QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &path_count, paths.data(),
+                           &mode_count, modes.data(), nullptr) != ERROR_SUCCESS) {
+        return greenflame::core::kDefaultSdrWhiteNits;
+    }
+    paths.resize(path_count);
+    for (DISPLAYCONFIG_PATH_INFO const &path : paths) {
+        DISPLAYCONFIG_SOURCE_DEVICE_NAME source_name = {};
+        source_name.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME;
+        source_name.header.size = sizeof(source_name);
+        source_name.header.adapterId = path.sourceInfo.adapterId;
+        source_name.header.id = path.sourceInfo.id;
+        if (DisplayConfigGetDeviceInfo(&source_name.header) != ERROR_SUCCESS ||
+            wcscmp(source_name.viewGdiDeviceName, gdi_device_name) != 0) {
+            continue;
+        }
+        DISPLAYCONFIG_SDR_WHITE_LEVEL white_level = {};
+        white_level.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SDR_WHITE_LEVEL;
+        white_level.header.size = sizeof(white_level);
+        white_level.header.adapterId = path.targetInfo.adapterId;
+        white_level.header.id = path.targetInfo.id;
+        if (DisplayConfigGetDeviceInfo(&white_level.header) == ERROR_SUCCESS &&
+            white_level.SDRWhiteLevel > 0) {
+            // SDRWhiteLevel is in units where 1000 is scRGB 1.0 (80 nits).
+            return static_cast<float>(white_level.SDRWhiteLevel) / 1000.f *
+                   greenflame::core::kDefaultSdrWhiteNits;
+        }
+        break;
+    }
+    return greenflame::core::kDefaultSdrWhiteNits;
+}
+
+// Best effort: any failure reports an SDR display, which keeps the 8-bit path.
+[[nodiscard]] WgcDisplayColor Query_window_display_color(HWND hwnd) {
+    WgcDisplayColor color = {};
+    HMONITOR const monitor = MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST);
+    Microsoft::WRL::ComPtr<IDXGIFactory1> factory;
+    if (monitor == nullptr ||
+        FAILED(CreateDXGIFactory1(IID_PPV_ARGS(factory.GetAddressOf())))) {
+        return color;
+    }
+    Microsoft::WRL::ComPtr<IDXGIAdapter1> adapter;
+    for (UINT adapter_index = 0;
+         factory->EnumAdapters1(adapter_index, adapter.ReleaseAndGetAddressOf()) ==
+         S_OK;
+         ++adapter_index) {
+        Microsoft::WRL::ComPtr<IDXGIOutput> output;
+        for (UINT output_index = 0;
+             adapter->EnumOutputs(output_index, output.ReleaseAndGetAddressOf()) ==
+             S_OK;
+             ++output_index) {
+            Microsoft::WRL::ComPtr<IDXGIOutput6> output6;
+            DXGI_OUTPUT_DESC1 desc = {};
+            if (FAILED(output.As(&output6)) || FAILED(output6->GetDesc1(&desc)) ||
+                desc.Monitor != monitor) {
+                continue;
+            }
+            if (desc.ColorSpace != DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020) {
+                return color;
+            }
+            color.hdr = true;
+            color.tone_map.sdr_white_nits = Query_sdr_white_nits(desc.DeviceName);
+            if (std::isfinite(desc.MaxLuminance) && desc.MaxLuminance > 0.f) {
+                color.tone_map.peak_nits = desc.MaxLuminance;
+            }
+            return color;
+        }
+    }
+    return color;
+}
+
+[[nodiscard]] bool
+Try_copy_frame_to_capture(ID3D11Device *device, ID3D11DeviceContext *context,
+                          Direct3D11CaptureFrame const &frame,
+                          greenflame::core::HdrToneMapSettings const &tone_map,
+                          greenflame::GdiCaptureResult &capture,
+                          std::wstring &error_message) {
     if (device == nullptr || context == nullptr || !frame) {
         error_message =
             L"Error: WGC window capture frame conversion received invalid state.";
@@ -522,7 +613,12 @@ Try_create_capture_item(HWND hwnd, GraphicsCaptureItem &item,
 
     D3D11_TEXTURE2D_DESC source_desc = {};
     source_texture->GetDesc(&source_desc);
-    if (source_desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM) {
+    std::optional<greenflame::core::HdrPixelFormat> hdr_format = std::nullopt;
+    if (source_desc.Format == DXGI_FORMAT_R16G16B16A16_FLOAT) {
+        hdr_format = greenflame::core::HdrPixelFormat::ScRgbFloat16;
+    } else if (source_desc.Format == DXGI_FORMAT_R10G10B10A2_UNORM) {
+        hdr_format = greenflame::core::HdrPixelFormat::Hdr10Rgb10A2;
+    } else if (source_desc.Format != DXGI_FORMAT_B8G8R8A8_UNORM) {
         error_message =
             L"Error: WGC window capture returned an unexpected pixel format.";
         return false;
@@ -566,7 +662,12 @@ Try_create_capture_item(HWND hwnd, GraphicsCaptureItem &item,
         error_message = L"Error: Failed to compute WGC window capture row bytes.";
         return false;
     }
-    if (map.Get().RowPitch < static_cast<UINT>(row_bytes)) {
+    size_t const source_pixel_row_bytes =
+        hdr_format.has_value()
+            ? static_cast<size_t>(content_size.Width) *
+                  greenflame::core::Hdr_bytes_per_pixel(*hdr_format)
+            : static_cast<size_t>(row_bytes);
+    if (static_cast<size_t>(map.Get().RowPitch) < source_pixel_row_bytes) {
         capture.Free();
         error_message =
             L"Error: WGC window capture returned an invalid staging row pitch.";
@@ -589,6 +690,20 @@ Try_create_capture_item(HWND hwnd, GraphicsCaptureItem &item,
     std::span<uint8_t const> source_bytes{
         reinterpret_cast<uint8_t const *>(map.Get().pData), source_byte_count};
     CLANG_WARN_IGNORE_POP()
+    if (hdr_format.has_value()) {
+        greenflame::core::HdrSourcePixels const source{
+            source_bytes, source_row_bytes, content_size.Width, content_size.Height,
+            *hdr_format};
+        if (!greenflame::core::Convert_hdr_to_srgb(
+                source, tone_map, greenflame::core::Default_parallel_workers(),
+                {destination_bytes, static_cast<size_t>(row_bytes)})) {
+            capture.Free();
+            error_message = L"Error: Failed to tone map the HDR WGC window capture "
+                            L"frame.";
+            return false;
+        }
+        return true;
+    }
     for (int32_t row = 0; row < content_size.Height; ++row) {
         size_t const source_offset =
             static_cast<size_t>(row) * static_cast<size_t>(map.Get().RowPitch);
@@ -679,6 +794,11 @@ core::CaptureSaveResult Capture_window_with_wgc(HWND hwnd,
         }
         LOG_WGC_MESSAGE(log_context + L" capture_item_ready");
 
+        WgcDisplayColor const display_color = Query_window_display_color(hwnd);
+        LOG_WGC_MESSAGE(log_context + L" display_hdr=" +
+                        std::to_wstring(display_color.hdr ? 1 : 0) + L" sdr_white=" +
+                        std::to_wstring(display_color.tone_map.sdr_white_nits));
+
         failure_context = L"reading the WGC capture item size";
         LOG_WGC_MESSAGE(log_context + L" reading_item_size");
         winrt::Windows::Graphics::SizeInt32 const initial_size = item.Size();
@@ -701,8 +821,10 @@ core::CaptureSaveResult Capture_window_with_wgc(HWND hwnd,
         Direct3D11CaptureFramePool frame_pool =
             Direct3D11CaptureFramePool::CreateFreeThreaded(
                 winrt_device,
-                winrt::Windows::Graphics::DirectX::DirectXPixelFormat::
-                    B8G8R8A8UIntNormalized,
+                display_color.hdr ? winrt::Windows::Graphics::DirectX::
+                                        DirectXPixelFormat::R16G16B16A16Float
+                                  : winrt::Windows::Graphics::DirectX::
+                                        DirectXPixelFormat::B8G8R8A8UIntNormalized,
                 kWgcFramePoolBufferCount, initial_size);
         [[maybe_unused]] auto frame_arrived_revoker = frame_pool.FrameArrived(
             winrt::auto_revoke, [frame_state, log_context](
@@ -812,7 +934,8 @@ core::CaptureSaveResult Capture_window_with_wgc(HWND hwnd,
 
         failure_context = L"converting the WGC frame";
         if (!Try_copy_frame_to_capture(d3d_device.Get(), d3d_context.Get(),
-                                       frame_to_convert, capture_out, error_message)) {
+                                       frame_to_convert, display_color.tone_map,
+                                       capture_out, error_message)) {
             capture_out.Free();
             return log_and_fail(error_message);
         }
@@ -1,11 +1,19 @@
 #include "win/win32_services.h"
 
 #include "app_config_store.h"
+#include "console_output.h"
 #include "greenflame/win/annotation_capture_renderer.h"
 #include "greenflame/win/d2d_text_layout_engine.h"
+#include "greenflame_core/export_compositor.h"
+#include "greenflame_core/input_image_source.h"
+#include "greenflame_core/parallel_for.h"
+#include "greenflame_core/pixel_ops.h"
+#include "greenflame_core/profiling.h"
 #include "greenflame_core/string_utils.h"
+#include "win/annotation_document_file.h"
 #include "win/display_queries.h"
 #include "win/gdi_capture.h"
+#include "win/mapped_file.h"
 #include "win/save_image.h"
 #include "win/wgc_window_capture.h"
 
@@ -29,30 +37,6 @@ struct MinimizedWindowSearchState {
     bool had_exception = false;
 };
 
-struct ScopedComApartment final {
-    explicit ScopedComApartment(bool owns_apartment) noexcept
-        : owns_apartment_(owns_apartment) {}
-    ~ScopedComApartment() {
-        if (owns_apartment_) {
-            CoUninitialize();
-        }
-    }
-
-    ScopedComApartment(ScopedComApartment const &) = delete;
-    ScopedComApartment &operator=(ScopedComApartment const &) = delete;
-
-  private:
-    bool owns_apartment_ = false;
-};
-
-struct DecodedInputImage final {
-    int32_t width = 0;
-    int32_t height = 0;
-    int row_bytes = 0;
-    greenflame::core::ImageSaveFormat format = greenflame::core::ImageSaveFormat::Png;
-    std::vector<uint8_t> pixels = {};
-};
-
 [[nodiscard]] bool Is_window_cloaked(HWND hwnd) noexcept {
     DWORD cloaked = 0;
     HRESULT const hr =
@@ -371,6 +355,42 @@ Save_bitmap_to_file(greenflame::GdiCaptureResult const &capture, std::wstring_vi
     return Make_capture_save_result(greenflame::core::CaptureSaveStatus::Success);
 }
 
+// Hands an encoded image to a non-file sink: standard output, or the result.
+[[nodiscard]] greenflame::core::CaptureSaveResult
+Deliver_encoded_bytes(greenflame::core::OutputSinkKind sink,
+                      std::vector<uint8_t> &&bytes) {
+    if (sink == greenflame::core::OutputSinkKind::Stdout) {
+        if (!greenflame::Write_stdout_bytes(bytes)) {
+            return Make_capture_save_result(
+                greenflame::core::CaptureSaveStatus::SaveFailed,
+                L"Error: Failed to write image to standard output (redirect or pipe "
+                L"it; a console cannot receive image data).");
+        }
+        return Make_capture_save_result(greenflame::core::CaptureSaveStatus::Success);
+    }
+    greenflame::core::CaptureSaveResult result =
+        Make_capture_save_result(greenflame::core::CaptureSaveStatus::Success);
+    result.encoded_bytes = std::move(bytes);
+    return result;
+}
+
+// `path` is only used by file sinks. Other sinks encode into memory: the WIC
+// encoders need a seekable stream, which a pipe is not.
+[[nodiscard]] greenflame::core::CaptureSaveResult
+Save_bitmap_to_sink(greenflame::GdiCaptureResult const &capture,
+                    greenflame::core::OutputSinkKind sink, std::wstring_view path,
+                    greenflame::core::ImageSaveFormat format) {
+    if (sink == greenflame::core::OutputSinkKind::File) {
+        return Save_bitmap_to_file(capture, path, format);
+    }
+    std::vector<uint8_t> bytes = {};
+    if (!greenflame::Encode_capture_to_memory(capture, format, bytes)) {
+        return Make_capture_save_result(greenflame::core::CaptureSaveStatus::SaveFailed,
+                                        L"Error: Failed to encode image.");
+    }
+    return Deliver_encoded_bytes(sink, std::move(bytes));
+}
+
 [[nodiscard]] bool Maybe_composite_captured_cursor(
     greenflame::core::CaptureSaveRequest const &request,
     greenflame::CapturedCursorSnapshot const *cursor_snapshot,
@@ -399,15 +419,6 @@ Save_bitmap_to_file(greenflame::GdiCaptureResult const &capture, std::wstring_vi
     return exists != FALSE;
 }
 
-template <typename T>
-[[nodiscard]] bool Is_rasterized_ready(T const &annotation) noexcept {
-    return annotation.bitmap_width_px > 0 && annotation.bitmap_height_px > 0 &&
-           annotation.bitmap_row_bytes > 0 && !annotation.premultiplied_bgra.empty() &&
-           static_cast<size_t>(annotation.bitmap_row_bytes) *
-                   static_cast<size_t>(annotation.bitmap_height_px) ==
-               annotation.premultiplied_bgra.size();
-}
-
 [[nodiscard]] greenflame::core::CaptureSaveResult Save_exact_source_capture_to_file(
     greenflame::GdiCaptureResult &source_capture,
     greenflame::core::CaptureSaveRequest const &request,
@@ -445,7 +456,7 @@ template <typename T>
                 greenflame::core::CaptureSaveStatus::SaveFailed,
                 L"Error: Failed to compose annotations onto the capture.");
         }
-        return Save_bitmap_to_file(source_capture, path, format);
+        return Save_bitmap_to_sink(source_capture, request.output_sink, path, format);
     }
 
     if (!Maybe_composite_captured_cursor(request, cursor_snapshot,
@@ -482,7 +493,8 @@ template <typename T>
                 greenflame::core::CaptureSaveStatus::SaveFailed,
                 L"Error: Failed to compose annotations onto the capture.");
         } else {
-            result = Save_bitmap_to_file(final_capture, path, format);
+            result = Save_bitmap_to_sink(final_capture, request.output_sink, path,
+                                         format);
         }
     }
 
@@ -490,6 +502,192 @@ template <typename T>
     return result;
 }
 
+struct CursorPatch final {
+    greenflame::core::RectPx screen_rect = {};
+    std::vector<uint8_t> pixels = {};
+};
+
+// Renders the source area under the cursor, with the cursor drawn in, into a small
+// opaque patch clipped to the source rect. Empty when the cursor is outside it.
+[[nodiscard]] bool
+Try_build_cursor_patch(greenflame::CapturedCursorSnapshot const &cursor_snapshot,
+                       greenflame::GdiCaptureResult const &capture,
+                       greenflame::core::RectPx virtual_bounds,
+                       greenflame::core::CaptureSaveRequest const &request,
+                       CursorPatch &patch) {
+    patch = {};
+    int64_t const left64 = static_cast<int64_t>(cursor_snapshot.hotspot_screen_px.x) -
+                           cursor_snapshot.hotspot_offset_px.x;
+    int64_t const top64 = static_cast<int64_t>(cursor_snapshot.hotspot_screen_px.y) -
+                          cursor_snapshot.hotspot_offset_px.y;
+    int64_t const right64 = left64 + cursor_snapshot.image_width;
+    int64_t const bottom64 = top64 + cursor_snapshot.image_height;
+    if (left64 < static_cast<int64_t>(INT32_MIN) ||
+        top64 < static_cast<int64_t>(INT32_MIN) ||
+        right64 > static_cast<int64_t>(INT32_MAX) ||
+        bottom64 > static_cast<int64_t>(INT32_MAX)) {
+        return true;
+    }
+    std::optional<greenflame::core::RectPx> const patch_rect =
+        greenflame::core::RectPx::Clip(
+            greenflame::core::RectPx::From_ltrb(
+                static_cast<int32_t>(left64), static_cast<int32_t>(top64),
+                static_cast<int32_t>(right64), static_cast<int32_t>(bottom64)),
+            request.source_rect_screen);
+    if (!patch_rect.has_value()) {
+        return true;
+    }
+
+    greenflame::GdiCaptureResult patch_capture{};
+    if (!greenflame::Create_solid_capture(patch_rect->Width(), patch_rect->Height(),
+                                          request.fill_color, patch_capture)) {
+        return false;
+    }
+    bool ok = true;
+    if (std::optional<greenflame::core::RectPx> const desktop_part =
+            greenflame::core::RectPx::Clip(*patch_rect, virtual_bounds);
+        desktop_part.has_value()) {
+        ok = greenflame::Blit_capture(
+            capture, desktop_part->left - virtual_bounds.left,
+            desktop_part->top - virtual_bounds.top, desktop_part->Width(),
+            desktop_part->Height(), patch_capture,
+            desktop_part->left - patch_rect->left, desktop_part->top - patch_rect->top);
+    }
+    ok = ok && greenflame::Composite_cursor_snapshot(
+                   cursor_snapshot, patch_rect->Top_left(), patch_capture);
+    if (ok) {
+        patch.screen_rect = *patch_rect;
+        patch.pixels.resize(static_cast<size_t>(patch_rect->Width()) *
+                            static_cast<size_t>(patch_rect->Height()) * 4u);
+        BITMAPINFOHEADER bmi{};
+        greenflame::Fill_bmi32_top_down(bmi, patch_capture.width, patch_capture.height);
+        HDC const dc = GetDC(nullptr);
+        ok = dc != nullptr &&
+             GetDIBits(dc, patch_capture.bitmap, 0,
+                       static_cast<UINT>(patch_capture.height), patch.pixels.data(),
+                       reinterpret_cast<BITMAPINFO *>(&bmi), DIB_RGB_COLORS) != 0;
+        if (dc != nullptr) {
+            ReleaseDC(nullptr, dc);
+        }
+        greenflame::core::Force_alpha_opaque(patch.pixels);
+    }
+    patch_capture.Free();
+    return ok;
+}
+
+// Padded or preserve-extent save without full-frame canvases: desktop rows, fill,
+// cursor patch and annotation layers are composed tile by tile straight into the
+// encoder. `clipped_screen` is the part of the source rect on the desktop.
+[[nodiscard]] greenflame::core::CaptureSaveResult Save_streamed_capture_to_file(
+    greenflame::core::CaptureSaveRequest const &request,
+    greenflame::GdiCaptureResult const &capture,
+    greenflame::CapturedCursorSnapshot const &cursor_snapshot,
+    greenflame::core::RectPx clipped_screen, greenflame::core::RectPx virtual_bounds,
+    std::wstring_view path, greenflame::core::ImageSaveFormat format) {
+    int32_t source_width = 0;
+    int32_t source_height = 0;
+    int32_t output_width = 0;
+    int32_t output_height = 0;
+    int32_t dst_left = 0;
+    int32_t dst_top = 0;
+    GdiFlush();
+    DIBSECTION section = {};
+    if (!Try_compute_render_sizes(request, source_width, source_height, output_width,
+                                  output_height) ||
+        !Try_compute_offset(clipped_screen.left, request.source_rect_screen.left,
+                            dst_left) ||
+        !Try_compute_offset(clipped_screen.top, request.source_rect_screen.top,
+                            dst_top) ||
+        GetObjectW(capture.bitmap, sizeof(section), &section) != sizeof(section) ||
+        section.dsBm.bmBits == nullptr) {
+        return Make_capture_save_result(
+            greenflame::core::CaptureSaveStatus::SaveFailed,
+            L"Error: Failed to prepare the capture bitmap.");
+    }
+
+    size_t const capture_row_bytes =
+        static_cast<size_t>(greenflame::Row_bytes32(capture.width));
+    greenflame::core::RectPx const capture_rect =
+        Capture_rect_from_screen_rect(clipped_screen, virtual_bounds);
+    CLANG_WARN_IGNORE_PUSH("-Wunsafe-buffer-usage-in-container")
+    std::span<const uint8_t> const capture_pixels{
+        reinterpret_cast<uint8_t const *>(section.dsBm.bmBits),
+        capture_row_bytes * static_cast<size_t>(capture.height)};
+    CLANG_WARN_IGNORE_POP()
+
+    // The off-desktop part of the source rect is fill, like the padding, so it
+    // folds into the insets. Each inset is bounded by the already checked output
+    // size.
+    greenflame::core::ExportCompositeSpec spec{};
+    spec.source = {
+        capture_pixels.subspan(static_cast<size_t>(capture_rect.top) *
+                                   capture_row_bytes +
+                               static_cast<size_t>(capture_rect.left) * 4u),
+        capture_row_bytes, capture_rect.Width(), capture_rect.Height()};
+    spec.padding_px = {
+        request.padding_px.left + dst_left, request.padding_px.top + dst_top,
+        request.padding_px.right + (source_width - dst_left - capture_rect.Width()),
+        request.padding_px.bottom + (source_height - dst_top - capture_rect.Height())};
+    spec.fill_color = request.fill_color;
+
+    std::vector<greenflame::core::ExportLayer> layers = {};
+    CursorPatch cursor_patch{};
+    if (request.include_cursor && cursor_snapshot.Is_valid()) {
+        if (!Try_build_cursor_patch(cursor_snapshot, capture, virtual_bounds, request,
+                                    cursor_patch)) {
+            return Make_capture_save_result(
+                greenflame::core::CaptureSaveStatus::SaveFailed,
+                L"Error: Failed to prepare the capture bitmap.");
+        }
+        if (!cursor_patch.pixels.empty()) {
+            greenflame::core::RectPx const rect = cursor_patch.screen_rect;
+            int32_t const offset_x =
+                request.padding_px.left - request.source_rect_screen.left;
+            int32_t const offset_y =
+                request.padding_px.top - request.source_rect_screen.top;
+            layers.push_back({greenflame::core::RectPx::From_ltrb(
+                                  rect.left + offset_x, rect.top + offset_y,
+                                  rect.right + offset_x, rect.bottom + offset_y),
+                              cursor_patch.pixels, rect.Width() * 4});
+        }
+    }
+
+    greenflame::core::RectPx annotation_target_bounds = {};
+    std::vector<greenflame::RasterizedAnnotationLayer> annotation_layers = {};
+    if (!Try_compute_annotation_target_bounds(request, annotation_target_bounds) ||
+        !greenflame::Rasterize_annotation_layers(request.annotations,
+                                                 annotation_target_bounds, output_width,
+                                                 output_height, annotation_layers)) {
+        return Make_capture_save_result(
+            greenflame::core::CaptureSaveStatus::SaveFailed,
+            L"Error: Failed to compose annotations onto the capture.");
+    }
+    for (greenflame::RasterizedAnnotationLayer const &layer : annotation_layers) {
+        layers.push_back(layer.As_export_layer());
+    }
+    spec.layers = layers;
+
+    greenflame::core::ExportCompositeOptions const options{
+        greenflame::core::kDefaultExportTileRows,
+        greenflame::core::Default_parallel_workers()};
+    if (request.output_sink != greenflame::core::OutputSinkKind::File) {
+        std::vector<uint8_t> bytes = {};
+        if (!greenflame::Encode_export_to_memory(spec, options, format, bytes)) {
+            return Make_capture_save_result(
+                greenflame::core::CaptureSaveStatus::SaveFailed,
+                L"Error: Failed to encode image.");
+        }
+        return Deliver_encoded_bytes(request.output_sink, std::move(bytes));
+    }
+    std::wstring const output_path(path);
+    if (!greenflame::Save_export_to_file(spec, options, output_path.c_str(), format)) {
+        return Make_capture_save_result(
+            greenflame::core::CaptureSaveStatus::SaveFailed,
+            L"Error: Failed to encode or write image file.");
+    }
+    return Make_capture_save_result(greenflame::core::CaptureSaveStatus::Success);
+}
+
 [[nodiscard]] greenflame::core::InputImageProbeResult
 Make_probe_result(greenflame::core::InputImageProbeStatus status,
                   std::wstring_view error_message = {}) {
@@ -504,180 +702,314 @@ Make_input_save_result(greenflame::core::InputImageSaveStatus status,
     return greenflame::core::InputImageSaveResult{status, std::wstring(error_message)};
 }
 
-[[nodiscard]] bool Try_decode_input_image(std::wstring_view path,
-                                          DecodedInputImage &decoded_image,
-                                          std::wstring &error_message) {
-    decoded_image = {};
-    error_message.clear();
-
-    if (path.empty()) {
-        error_message = L"--input: path is empty.";
-        return false;
-    }
-    if (!Has_supported_input_extension(path)) {
-        error_message = L"--input: unsupported input image extension. Supported "
-                        L"extensions are .png, .jpg/.jpeg, and .bmp.";
-        return false;
+// WIC behind the core decoder interface. Every WIC decoder is created over the
+// mapped file bytes, so the input file is never opened a second time.
+class WicInputImageDecoder final : public greenflame::core::IInputImageDecoder {
+  public:
+    WicInputImageDecoder() = default;
+    ~WicInputImageDecoder() override {
+        factory_.Reset();
+        if (owns_apartment_) {
+            CoUninitialize();
+        }
     }
+    WicInputImageDecoder(WicInputImageDecoder const &) = delete;
+    WicInputImageDecoder &operator=(WicInputImageDecoder const &) = delete;
+
+    [[nodiscard]] greenflame::core::InputImageDecodeStatus
+    Read_header(std::span<const uint8_t> file_bytes,
+                greenflame::core::InputImageHeader &header,
+                std::wstring &detail) override {
+        using greenflame::core::InputImageDecodeStatus;
+        Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
+        InputImageDecodeStatus const status =
+            Open_frame(file_bytes, frame, header.format, detail);
+        if (status != InputImageDecodeStatus::Success) {
+            return status;
+        }
 
-    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-    bool owns_apartment = SUCCEEDED(hr);
-    if (hr == RPC_E_CHANGED_MODE) {
-        owns_apartment = false;
-    } else if (FAILED(hr)) {
-        error_message =
-            Build_hresult_error(L"Error: Failed to initialize COM for --input.", hr);
-        return false;
-    }
-    ScopedComApartment const apartment(owns_apartment);
+        UINT width_u = 0;
+        UINT height_u = 0;
+        HRESULT const hr = frame->GetSize(&width_u, &height_u);
+        if (FAILED(hr) || width_u == 0 || height_u == 0 ||
+            width_u > static_cast<UINT>(INT32_MAX) ||
+            height_u > static_cast<UINT>(INT32_MAX)) {
+            detail = L"invalid image dimensions.";
+            return InputImageDecodeStatus::Unreadable;
+        }
+        uint64_t const pixel_bytes64 = static_cast<uint64_t>(width_u) *
+                                       kBytesPerPixel32 *
+                                       static_cast<uint64_t>(height_u);
+        if (width_u > static_cast<UINT>(INT32_MAX) / kBytesPerPixel32 ||
+            pixel_bytes64 > static_cast<uint64_t>(UINT_MAX)) {
+            detail = L"image dimensions are too large.";
+            return InputImageDecodeStatus::Unreadable;
+        }
 
-    Microsoft::WRL::ComPtr<IWICImagingFactory> factory;
-    hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
-                          IID_PPV_ARGS(factory.GetAddressOf()));
-    if (FAILED(hr) || !factory) {
-        error_message = Build_hresult_error(
-            L"Error: Failed to initialize Windows Imaging Component for --input.", hr);
-        return false;
-    }
+        WICPixelFormatGUID pixel_format = GUID_WICPixelFormat32bppBGRA;
+        header.width = static_cast<int32_t>(width_u);
+        header.height = static_cast<int32_t>(height_u);
+        header.may_have_alpha = FAILED(frame->GetPixelFormat(&pixel_format)) ||
+                                Pixel_format_may_have_alpha(pixel_format);
+        return InputImageDecodeStatus::Success;
+    }
+
+    [[nodiscard]] greenflame::core::InputImageDecodeStatus
+    Decode_rows(std::span<const uint8_t> file_bytes,
+                greenflame::core::InputImageHeader const &header,
+                greenflame::core::ImageRowTarget const &target,
+                std::wstring &detail) override {
+        using greenflame::core::InputImageDecodeStatus;
+        if (!greenflame::core::Image_row_target_fits(target, header.width,
+                                                     header.height) ||
+            target.row_bytes > static_cast<size_t>(UINT_MAX)) {
+            detail = L"Error: Failed to prepare the input image bitmap.";
+            return InputImageDecodeStatus::Failed;
+        }
 
-    std::wstring const path_string(path);
-    Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
-    hr = factory->CreateDecoderFromFilename(path_string.c_str(), nullptr, GENERIC_READ,
-                                            WICDecodeMetadataCacheOnDemand,
-                                            decoder.GetAddressOf());
-    if (FAILED(hr) || !decoder) {
-        error_message = L"--input: unable to read image file \"" + path_string +
-                        L"\": " + Format_hresult_message(hr);
-        return false;
-    }
+        Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
+        greenflame::core::ImageSaveFormat format = header.format;
+        InputImageDecodeStatus const status =
+            Open_frame(file_bytes, frame, format, detail);
+        if (status != InputImageDecodeStatus::Success) {
+            return status;
+        }
 
-    GUID container_format = GUID_ContainerFormatPng;
-    hr = decoder->GetContainerFormat(&container_format);
-    if (FAILED(hr) ||
-        !Try_map_container_format(container_format, decoded_image.format)) {
-        error_message = L"--input: unsupported input image format. Supported formats "
-                        L"are png, jpg/jpeg, and bmp.";
-        return false;
-    }
+        Microsoft::WRL::ComPtr<IWICFormatConverter> converter;
+        HRESULT hr = factory_->CreateFormatConverter(converter.GetAddressOf());
+        if (SUCCEEDED(hr) && converter) {
+            hr = converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppBGRA,
+                                       WICBitmapDitherTypeNone, nullptr, 0.0,
+                                       WICBitmapPaletteTypeCustom);
+        }
+        if (FAILED(hr) || !converter) {
+            detail = Build_hresult_error(
+                L"Error: Failed to convert the input image into BGRA pixels.", hr);
+            return InputImageDecodeStatus::Failed;
+        }
 
-    Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
-    hr = decoder->GetFrame(0, frame.GetAddressOf());
-    if (FAILED(hr) || !frame) {
-        error_message = L"--input: unable to read image file \"" + path_string +
-                        L"\": " + Format_hresult_message(hr);
-        return false;
+        // Rows land directly in the caller's canvas at its stride.
+        UINT const buffer_size = static_cast<UINT>(
+            std::min<size_t>(target.pixels.size(), static_cast<size_t>(UINT_MAX)));
+        hr = converter->CopyPixels(nullptr, static_cast<UINT>(target.row_bytes),
+                                   buffer_size, target.pixels.data());
+        if (FAILED(hr)) {
+            detail = Format_hresult_message(hr);
+            return InputImageDecodeStatus::Unreadable;
+        }
+        if (header.may_have_alpha &&
+            !greenflame::core::Image_rows_are_opaque(target, header.width,
+                                                     header.height)) {
+            return InputImageDecodeStatus::Transparent;
+        }
+        return InputImageDecodeStatus::Success;
     }
 
-    UINT width_u = 0;
-    UINT height_u = 0;
-    hr = frame->GetSize(&width_u, &height_u);
-    if (FAILED(hr) || width_u == 0 || height_u == 0 ||
-        width_u > static_cast<UINT>(INT32_MAX) ||
-        height_u > static_cast<UINT>(INT32_MAX)) {
-        error_message = L"--input: unable to read image file \"" + path_string +
-                        L"\": invalid image dimensions.";
-        return false;
-    }
+  private:
+    [[nodiscard]] greenflame::core::InputImageDecodeStatus
+    Open_frame(std::span<const uint8_t> file_bytes,
+               Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> &frame,
+               greenflame::core::ImageSaveFormat &format, std::wstring &detail) {
+        using greenflame::core::InputImageDecodeStatus;
+        if (!factory_) {
+            HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+            if (FAILED(hr) && hr != RPC_E_CHANGED_MODE) {
+                detail = Build_hresult_error(
+                    L"Error: Failed to initialize COM for --input.", hr);
+                return InputImageDecodeStatus::Failed;
+            }
+            owns_apartment_ = SUCCEEDED(hr);
+            hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr,
+                                  CLSCTX_INPROC_SERVER,
+                                  IID_PPV_ARGS(factory_.GetAddressOf()));
+            if (FAILED(hr) || !factory_) {
+                factory_.Reset();
+                detail = Build_hresult_error(L"Error: Failed to initialize Windows "
+                                             L"Imaging Component for --input.",
+                                             hr);
+                return InputImageDecodeStatus::Failed;
+            }
+        }
 
-    if (width_u > static_cast<UINT>(INT32_MAX) / kBytesPerPixel32) {
-        error_message = L"--input: unable to read image file \"" + path_string +
-                        L"\": image dimensions are too large.";
-        return false;
-    }
+        if (file_bytes.empty() || file_bytes.size() > static_cast<size_t>(
+                                      std::numeric_limits<DWORD>::max())) {
+            detail = file_bytes.empty() ? L"file is empty." : L"file is too large.";
+            return InputImageDecodeStatus::Unreadable;
+        }
 
-    UINT const stride = width_u * kBytesPerPixel32;
-    uint64_t const pixel_bytes64 =
-        static_cast<uint64_t>(stride) * static_cast<uint64_t>(height_u);
-    if (pixel_bytes64 == 0 || pixel_bytes64 > static_cast<uint64_t>(UINT_MAX)) {
-        error_message = L"--input: unable to read image file \"" + path_string +
-                        L"\": image dimensions are too large.";
-        return false;
+        Microsoft::WRL::ComPtr<IWICStream> stream;
+        HRESULT hr = factory_->CreateStream(stream.GetAddressOf());
+        if (SUCCEEDED(hr) && stream) {
+            // WIC only reads through the stream; the mapping is read-only.
+            hr = stream->InitializeFromMemory(const_cast<BYTE *>(file_bytes.data()),
+                                              static_cast<DWORD>(file_bytes.size()));
+        }
+        Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
+        if (SUCCEEDED(hr) && stream) {
+            hr = factory_->CreateDecoderFromStream(stream.Get(), nullptr,
+                                                   WICDecodeMetadataCacheOnDemand,
+                                                   decoder.GetAddressOf());
+        }
+        if (FAILED(hr) || !decoder) {
+            detail = Format_hresult_message(hr);
+            return InputImageDecodeStatus::Unreadable;
+        }
+
+        GUID container_format = GUID_ContainerFormatPng;
+        hr = decoder->GetContainerFormat(&container_format);
+        if (FAILED(hr) || !Try_map_container_format(container_format, format)) {
+            return InputImageDecodeStatus::UnsupportedFormat;
+        }
+
+        hr = decoder->GetFrame(0, frame.GetAddressOf());
+        if (FAILED(hr) || !frame) {
+            detail = Format_hresult_message(hr);
+            return InputImageDecodeStatus::Unreadable;
+        }
+        return InputImageDecodeStatus::Success;
+    }
+
+    // Conservative: anything WIC cannot describe is treated as alpha-capable.
+    [[nodiscard]] bool
+    Pixel_format_may_have_alpha(WICPixelFormatGUID const &pixel_format) const {
+        Microsoft::WRL::ComPtr<IWICComponentInfo> component_info;
+        Microsoft::WRL::ComPtr<IWICPixelFormatInfo2> pixel_format_info;
+        BOOL supports_transparency = TRUE;
+        if (FAILED(factory_->CreateComponentInfo(pixel_format,
+                                                 component_info.GetAddressOf())) ||
+            FAILED(component_info.As(&pixel_format_info)) ||
+            FAILED(pixel_format_info->SupportsTransparency(&supports_transparency))) {
+            return true;
+        }
+        return supports_transparency != FALSE;
     }
 
-    Microsoft::WRL::ComPtr<IWICFormatConverter> converter;
-    hr = factory->CreateFormatConverter(converter.GetAddressOf());
-    if (FAILED(hr) || !converter) {
-        error_message = Build_hresult_error(
-            L"Error: Failed to convert the input image into BGRA pixels.", hr);
+    Microsoft::WRL::ComPtr<IWICImagingFactory> factory_;
+    bool owns_apartment_ = false;
+};
+
+// An input file mapped once, plus the decoder that reads it: the portable core
+// BMP decoder when it understands the layout, WIC otherwise.
+struct InputImageSource final {
+    greenflame::MappedFile file = {};
+    greenflame::core::BmpInputImageDecoder bmp_decoder = {};
+    WicInputImageDecoder wic_decoder = {};
+    greenflame::core::IInputImageDecoder *decoder = nullptr;
+    greenflame::core::InputImageHeader header = {};
+};
+
+[[nodiscard]] std::wstring
+Build_input_decode_error(greenflame::core::InputImageDecodeStatus status,
+                         std::wstring_view detail, std::wstring_view path) {
+    switch (status) {
+    case greenflame::core::InputImageDecodeStatus::Unreadable:
+        return L"--input: unable to read image file \"" + std::wstring(path) +
+               L"\": " + std::wstring(detail);
+    case greenflame::core::InputImageDecodeStatus::UnsupportedFormat:
+        return L"--input: unsupported input image format. Supported formats are "
+               L"png, jpg/jpeg, and bmp.";
+    case greenflame::core::InputImageDecodeStatus::Transparent:
+        return kInputTransparencyUnsupportedMessage;
+    case greenflame::core::InputImageDecodeStatus::Success:
+    case greenflame::core::InputImageDecodeStatus::Failed:
+        break;
+    }
+    return std::wstring(detail);
+}
+
+[[nodiscard]] bool Try_open_input_image(std::wstring_view path,
+                                        InputImageSource &source,
+                                        std::wstring &error_message) {
+    error_message.clear();
+    if (path.empty()) {
+        error_message = L"--input: path is empty.";
         return false;
     }
-
-    hr = converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppBGRA,
-                               WICBitmapDitherTypeNone, nullptr, 0.0,
-                               WICBitmapPaletteTypeCustom);
-    if (FAILED(hr)) {
-        error_message = Build_hresult_error(
-            L"Error: Failed to convert the input image into BGRA pixels.", hr);
+    if (!Has_supported_input_extension(path)) {
+        error_message = L"--input: unsupported input image extension. Supported "
+                        L"extensions are .png, .jpg/.jpeg, and .bmp.";
         return false;
     }
 
-    decoded_image.width = static_cast<int32_t>(width_u);
-    decoded_image.height = static_cast<int32_t>(height_u);
-    decoded_image.row_bytes = static_cast<int>(stride);
-    decoded_image.pixels.resize(static_cast<size_t>(pixel_bytes64));
-    hr = converter->CopyPixels(nullptr, stride, static_cast<UINT>(pixel_bytes64),
-                               decoded_image.pixels.data());
-    if (FAILED(hr)) {
-        decoded_image = {};
-        error_message = L"--input: unable to read image file \"" + path_string +
-                        L"\": " + Format_hresult_message(hr);
+    std::wstring map_error = {};
+    if (!source.file.Open(path, map_error)) {
+        error_message = L"--input: unable to read image file \"" + std::wstring(path) +
+                        L"\": " + map_error;
         return false;
     }
 
-    for (size_t i = 3; i < decoded_image.pixels.size(); i += kBytesPerPixel32) {
-        if (decoded_image.pixels[i] != 255u) {
-            decoded_image = {};
-            error_message = kInputTransparencyUnsupportedMessage;
-            return false;
-        }
+    std::span<const uint8_t> const bytes = source.file.Bytes();
+    if (greenflame::core::BmpInputImageDecoder::Can_decode(bytes)) {
+        source.decoder = &source.bmp_decoder;
+    } else {
+        source.decoder = &source.wic_decoder;
+    }
+    std::wstring detail = {};
+    greenflame::core::InputImageDecodeStatus const status =
+        source.decoder->Read_header(bytes, source.header, detail);
+    if (status != greenflame::core::InputImageDecodeStatus::Success) {
+        error_message = Build_input_decode_error(status, detail, path);
+        return false;
     }
-
     return true;
 }
 
-[[nodiscard]] bool
-Try_create_capture_from_input_image(DecodedInputImage const &decoded_image,
-                                    greenflame::GdiCaptureResult &capture,
-                                    std::wstring &error_message) {
-    capture.Free();
-    error_message.clear();
-
-    if (decoded_image.width <= 0 || decoded_image.height <= 0 ||
-        decoded_image.row_bytes <= 0 || decoded_image.pixels.empty()) {
-        error_message = L"Error: Failed to prepare the input image bitmap.";
+[[nodiscard]] bool Try_decode_input_rows(InputImageSource &source,
+                                         greenflame::core::ImageRowTarget const &target,
+                                         std::wstring_view path,
+                                         std::wstring &error_message) {
+    std::wstring detail = {};
+    greenflame::core::InputImageDecodeStatus const status = source.decoder->Decode_rows(
+        source.file.Bytes(), source.header, target, detail);
+    if (status != greenflame::core::InputImageDecodeStatus::Success) {
+        error_message = Build_input_decode_error(status, detail, path);
         return false;
     }
+    return true;
+}
 
-    BITMAPINFO bitmap_info = {};
-    greenflame::Fill_bmi32_top_down(bitmap_info.bmiHeader, decoded_image.width,
-                                    decoded_image.height);
-
-    HDC const screen_dc = GetDC(nullptr);
-    if (screen_dc == nullptr) {
-        error_message = L"Error: Failed to acquire a screen DC while preparing the "
-                        L"input image bitmap.";
+// Creates the final --input canvas. Padding is pre-filled; the image area is
+// left for the decoder to write in place. `pixels` covers the whole DIB.
+[[nodiscard]] bool Try_create_input_canvas(int32_t width, int32_t height,
+                                           greenflame::core::InsetsPx const &padding,
+                                           COLORREF fill_color,
+                                           greenflame::GdiCaptureResult &canvas,
+                                           std::span<uint8_t> &pixels) {
+    canvas.Free();
+    pixels = {};
+    if (padding.Is_zero()) {
+        BITMAPINFO bitmap_info = {};
+        greenflame::Fill_bmi32_top_down(bitmap_info.bmiHeader, width, height);
+        HDC const screen_dc = GetDC(nullptr);
+        if (screen_dc == nullptr) {
+            return false;
+        }
+        void *bitmap_bits = nullptr;
+        HBITMAP const bitmap = CreateDIBSection(
+            screen_dc, &bitmap_info, DIB_RGB_COLORS, &bitmap_bits, nullptr, 0);
+        ReleaseDC(nullptr, screen_dc);
+        if (bitmap == nullptr || bitmap_bits == nullptr) {
+            return false;
+        }
+        canvas.bitmap = bitmap;
+        canvas.width = width;
+        canvas.height = height;
+    } else if (!greenflame::Create_solid_capture(width, height, fill_color, canvas)) {
         return false;
     }
 
-    void *bitmap_bits = nullptr;
-    HBITMAP const bitmap = CreateDIBSection(screen_dc, &bitmap_info, DIB_RGB_COLORS,
-                                            &bitmap_bits, nullptr, 0);
-    ReleaseDC(nullptr, screen_dc);
-    if (bitmap == nullptr || bitmap_bits == nullptr) {
-        error_message = L"Error: Failed to create a 32bpp DIB for the input image.";
+    GdiFlush();
+    DIBSECTION section = {};
+    if (GetObjectW(canvas.bitmap, sizeof(section), &section) != sizeof(section) ||
+        section.dsBm.bmBits == nullptr) {
+        canvas.Free();
         return false;
     }
-
     CLANG_WARN_IGNORE_PUSH("-Wunsafe-buffer-usage-in-container")
-    std::span<uint8_t> destination_bytes{reinterpret_cast<uint8_t *>(bitmap_bits),
-                                         decoded_image.pixels.size()};
+    pixels = std::span<uint8_t>{reinterpret_cast<uint8_t *>(section.dsBm.bmBits),
+                                static_cast<size_t>(greenflame::Row_bytes32(width)) *
+                                    static_cast<size_t>(height)};
     CLANG_WARN_IGNORE_POP()
-    std::copy(decoded_image.pixels.begin(), decoded_image.pixels.end(),
-              destination_bytes.begin());
-
-    capture.bitmap = bitmap;
-    capture.width = decoded_image.width;
-    capture.height = decoded_image.height;
     return true;
 }
 
@@ -809,87 +1141,17 @@ Win32WindowInspector::Count_minimized_windows_by_title(std::wstring_view needle)
     return state.match_count;
 }
 
-bool Win32CaptureService::Copy_rect_to_clipboard(core::RectPx screen_rect,
-                                                 bool include_cursor) {
-    if (screen_rect.Is_empty()) {
-        return false;
-    }
-
-    core::RectPx const virtual_bounds = greenflame::Get_virtual_desktop_bounds_px();
-    std::optional<core::RectPx> const clipped_screen =
-        core::RectPx::Clip(screen_rect, virtual_bounds);
-    if (!clipped_screen.has_value()) {
-        return false;
-    }
-
-    GdiCaptureResult capture{};
-    if (!greenflame::Capture_virtual_desktop(capture)) {
-        return false;
-    }
-    greenflame::CapturedCursorSnapshot cursor_snapshot = {};
-    if (include_cursor) {
-        (void)greenflame::Capture_cursor_snapshot(cursor_snapshot);
-    }
-
-    core::RectPx const capture_rect =
-        Capture_rect_from_screen_rect(*clipped_screen, virtual_bounds);
-    GdiCaptureResult cropped{};
-    bool const cropped_ok =
-        greenflame::Crop_capture(capture, capture_rect.left, capture_rect.top,
-                                 capture_rect.Width(), capture_rect.Height(), cropped);
-    capture.Free();
-    if (!cropped_ok) {
-        return false;
-    }
-
-    if (include_cursor && !greenflame::Composite_cursor_snapshot(
-                              cursor_snapshot, clipped_screen->Top_left(), cropped)) {
-        cropped.Free();
-        return false;
-    }
-
-    bool const copied = greenflame::Copy_capture_to_clipboard(cropped, nullptr);
-    cropped.Free();
-    return copied;
-}
-
-core::CaptureSaveResult
-Win32CaptureService::Save_capture_to_file(core::CaptureSaveRequest const &request,
-                                          std::wstring_view path,
-                                          core::ImageSaveFormat format) {
-    if (request.source_rect_screen.Is_empty() || path.empty()) {
-        return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
-                                        L"Error: Failed to encode or write image "
-                                        L"file.");
-    }
-
-    if (request.source_kind == core::CaptureSourceKind::Window &&
-        request.window_capture_backend == core::WindowCaptureBackend::Wgc) {
-        if (request.source_window == nullptr) {
-            return Make_capture_save_result(
-                core::CaptureSaveStatus::BackendFailed,
-                L"Error: WGC window capture requires a valid target window.");
-        }
-
-        GdiCaptureResult source_capture{};
-        core::CaptureSaveResult wgc_result = greenflame::Capture_window_with_wgc(
-            request.source_window, request.source_rect_screen, source_capture);
-        if (wgc_result.status != core::CaptureSaveStatus::Success) {
-            source_capture.Free();
-            return wgc_result;
-        }
-
-        greenflame::CapturedCursorSnapshot cursor_snapshot = {};
-        if (request.include_cursor) {
-            (void)greenflame::Capture_cursor_snapshot(cursor_snapshot);
-        }
-        core::CaptureSaveResult const save_result = Save_exact_source_capture_to_file(
-            source_capture, request, &cursor_snapshot, path, format);
-        source_capture.Free();
-        return save_result;
-    }
+namespace {
 
-    core::RectPx const virtual_bounds = greenflame::Get_virtual_desktop_bounds_px();
+// Saves a screen-rect request from an already grabbed `capture` covering
+// `virtual_bounds`. The capture is only read, so one grab can serve several
+// requests.
+[[nodiscard]] core::CaptureSaveResult
+Save_screen_rect_from_frame(core::CaptureSaveRequest const &request,
+                            GdiCaptureResult const &capture,
+                            core::RectPx virtual_bounds,
+                            CapturedCursorSnapshot const &cursor_snapshot,
+                            std::wstring_view path, core::ImageSaveFormat format) {
     std::optional<core::RectPx> const clipped_screen =
         core::RectPx::Clip(request.source_rect_screen, virtual_bounds);
     if (!clipped_screen.has_value()) {
@@ -899,25 +1161,12 @@ Win32CaptureService::Save_capture_to_file(core::CaptureSaveRequest const &reques
     }
 
     if (!request.preserve_source_extent && request.padding_px.Is_zero()) {
-        GdiCaptureResult capture{};
-        if (!greenflame::Capture_virtual_desktop(capture)) {
-            return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
-                                            L"Error: Failed to prepare the capture "
-                                            L"bitmap.");
-        }
-        greenflame::CapturedCursorSnapshot cursor_snapshot = {};
-        if (request.include_cursor) {
-            (void)greenflame::Capture_cursor_snapshot(cursor_snapshot);
-        }
-
         core::RectPx const capture_rect =
             Capture_rect_from_screen_rect(*clipped_screen, virtual_bounds);
         GdiCaptureResult cropped{};
-        bool const cropped_ok = greenflame::Crop_capture(
-            capture, capture_rect.left, capture_rect.top, capture_rect.Width(),
-            capture_rect.Height(), cropped);
-        capture.Free();
-        if (!cropped_ok) {
+        if (!greenflame::Crop_capture(capture, capture_rect.left, capture_rect.top,
+                                      capture_rect.Width(), capture_rect.Height(),
+                                      cropped)) {
             return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
                                             L"Error: Failed to prepare the capture "
                                             L"bitmap.");
@@ -939,8 +1188,8 @@ Win32CaptureService::Save_capture_to_file(core::CaptureSaveRequest const &reques
                 L"Error: Failed to compose annotations onto the capture.");
         }
 
-        core::CaptureSaveResult const save_result =
-            Save_bitmap_to_file(cropped, path, format);
+        core::CaptureSaveResult save_result =
+            Save_bitmap_to_sink(cropped, request.output_sink, path, format);
         cropped.Free();
         return save_result;
     }
@@ -956,21 +1205,17 @@ Win32CaptureService::Save_capture_to_file(core::CaptureSaveRequest const &reques
                                         L"bitmap.");
     }
 
-    GdiCaptureResult capture{};
-    if (!greenflame::Capture_virtual_desktop(capture)) {
-        return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
-                                        L"Error: Failed to prepare the capture "
-                                        L"bitmap.");
-    }
-    greenflame::CapturedCursorSnapshot cursor_snapshot = {};
-    if (request.include_cursor) {
-        (void)greenflame::Capture_cursor_snapshot(cursor_snapshot);
+    // Dynamic obfuscation reads the composed pixels beneath it, so only those
+    // saves still build the full-frame canvases below.
+    if (!greenflame::Annotations_need_capture_pixels(request.annotations)) {
+        return Save_streamed_capture_to_file(request, capture, cursor_snapshot,
+                                             *clipped_screen, virtual_bounds, path,
+                                             format);
     }
 
     GdiCaptureResult source_canvas{};
     if (!greenflame::Create_solid_capture(source_width, source_height,
                                           request.fill_color, source_canvas)) {
-        capture.Free();
         return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
                                         L"Error: Failed to prepare the capture "
                                         L"bitmap.");
@@ -990,7 +1235,6 @@ Win32CaptureService::Save_capture_to_file(core::CaptureSaveRequest const &reques
         greenflame::Blit_capture(capture, capture_rect.left, capture_rect.top,
                                  capture_rect.Width(), capture_rect.Height(),
                                  source_canvas, dst_left, dst_top);
-    capture.Free();
     if (!blitted_source) {
         source_canvas.Free();
         return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
@@ -1045,8 +1289,8 @@ Win32CaptureService::Save_capture_to_file(core::CaptureSaveRequest const &reques
             L"Error: Failed to compose annotations onto the capture.");
     }
 
-    core::CaptureSaveResult const save_result =
-        Save_bitmap_to_file(*capture_to_save, path, format);
+    core::CaptureSaveResult save_result =
+        Save_bitmap_to_sink(*capture_to_save, request.output_sink, path, format);
     if (capture_to_save == &source_canvas) {
         source_canvas.Free();
     } else {
@@ -1055,53 +1299,390 @@ Win32CaptureService::Save_capture_to_file(core::CaptureSaveRequest const &reques
     return save_result;
 }
 
+} // namespace
+
+bool Win32CaptureService::Copy_rect_to_clipboard(core::RectPx screen_rect,
+                                                 bool include_cursor) {
+    GREENFLAME_PROFILE_FUNCTION();
+    if (screen_rect.Is_empty()) {
+        return false;
+    }
+
+    core::RectPx const virtual_bounds = greenflame::Get_virtual_desktop_bounds_px();
+    std::optional<core::RectPx> const clipped_screen =
+        core::RectPx::Clip(screen_rect, virtual_bounds);
+    if (!clipped_screen.has_value()) {
+        return false;
+    }
+
+    GdiCaptureResult capture{};
+    if (!greenflame::Capture_virtual_desktop(capture)) {
+        return false;
+    }
+    greenflame::CapturedCursorSnapshot cursor_snapshot = {};
+    if (include_cursor) {
+        (void)greenflame::Capture_cursor_snapshot(cursor_snapshot);
+    }
+
+    core::RectPx const capture_rect =
+        Capture_rect_from_screen_rect(*clipped_screen, virtual_bounds);
+    GdiCaptureResult cropped{};
+    bool const cropped_ok =
+        greenflame::Crop_capture(capture, capture_rect.left, capture_rect.top,
+                                 capture_rect.Width(), capture_rect.Height(), cropped);
+    capture.Free();
+    if (!cropped_ok) {
+        return false;
+    }
+
+    if (include_cursor && !greenflame::Composite_cursor_snapshot(
+                              cursor_snapshot, clipped_screen->Top_left(), cropped)) {
+        cropped.Free();
+        return false;
+    }
+
+    bool const copied = greenflame::Copy_capture_to_clipboard(cropped, nullptr);
+    if (copied) {
+        Record_capture(cropped, *clipped_screen, std::nullopt);
+    }
+    cropped.Free();
+    return copied;
+}
+
+core::CaptureSaveResult
+Win32CaptureService::Save_capture_to_file(core::CaptureSaveRequest const &request,
+                                          std::wstring_view path,
+                                          core::ImageSaveFormat format) {
+    GREENFLAME_PROFILE_FUNCTION();
+    if (request.source_rect_screen.Is_empty() ||
+        (request.output_sink == core::OutputSinkKind::File && path.empty())) {
+        return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
+                                        L"Error: Failed to encode or write image "
+                                        L"file.");
+    }
+
+    if (request.source_kind == core::CaptureSourceKind::Window &&
+        request.window_capture_backend == core::WindowCaptureBackend::Wgc) {
+        if (request.source_window == nullptr) {
+            return Make_capture_save_result(
+                core::CaptureSaveStatus::BackendFailed,
+                L"Error: WGC window capture requires a valid target window.");
+        }
+
+        GdiCaptureResult source_capture{};
+        core::CaptureSaveResult wgc_result = greenflame::Capture_window_with_wgc(
+            request.source_window, request.source_rect_screen, source_capture);
+        if (wgc_result.status != core::CaptureSaveStatus::Success) {
+            source_capture.Free();
+            return wgc_result;
+        }
+
+        greenflame::CapturedCursorSnapshot cursor_snapshot = {};
+        if (request.include_cursor) {
+            (void)greenflame::Capture_cursor_snapshot(cursor_snapshot);
+        }
+        core::CaptureSaveResult const save_result = Save_exact_source_capture_to_file(
+            source_capture, request, &cursor_snapshot, path, format);
+        source_capture.Free();
+        return save_result;
+    }
+
+    core::RectPx const virtual_bounds = greenflame::Get_virtual_desktop_bounds_px();
+    GdiCaptureResult capture{};
+    if (!greenflame::Capture_virtual_desktop(capture)) {
+        return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
+                                        L"Error: Failed to prepare the capture "
+                                        L"bitmap.");
+    }
+    greenflame::CapturedCursorSnapshot cursor_snapshot = {};
+    if (request.include_cursor) {
+        (void)greenflame::Capture_cursor_snapshot(cursor_snapshot);
+    }
+    core::CaptureSaveResult save_result = Save_screen_rect_from_frame(
+        request, capture, virtual_bounds, cursor_snapshot, path, format);
+    capture.Free();
+    return save_result;
+}
+
+std::vector<core::CaptureSaveResult> Win32CaptureService::Save_captures_from_one_grab(
+    std::span<const core::CaptureSaveJob> jobs) {
+    GREENFLAME_PROFILE_FUNCTION();
+    std::vector<core::CaptureSaveResult> results(jobs.size());
+    if (jobs.empty()) {
+        return results;
+    }
+    core::CaptureSaveResult const prepare_failed =
+        Make_capture_save_result(core::CaptureSaveStatus::SaveFailed,
+                                 L"Error: Failed to prepare the capture bitmap.");
+
+    core::RectPx const virtual_bounds = greenflame::Get_virtual_desktop_bounds_px();
+    GdiCaptureResult capture{};
+    if (!greenflame::Capture_virtual_desktop(capture)) {
+        std::ranges::fill(results, prepare_failed);
+        return results;
+    }
+    greenflame::CapturedCursorSnapshot cursor_snapshot = {};
+    if (std::ranges::any_of(jobs, [](core::CaptureSaveJob const &job) {
+            return job.request.include_cursor;
+        })) {
+        (void)greenflame::Capture_cursor_snapshot(cursor_snapshot);
+    }
+
+    // A GDI bitmap can only be selected into one DC at a time, so every job gets
+    // its own crop of the frame before the jobs run concurrently.
+    std::vector<GdiCaptureResult> frames(jobs.size());
+    std::vector<core::RectPx> frame_bounds(jobs.size());
+    std::vector<bool> ready(jobs.size(), false);
+    for (size_t index = 0; index < jobs.size(); ++index) {
+        core::CaptureSaveRequest const &request = jobs[index].request;
+        std::optional<core::RectPx> const clipped =
+            core::RectPx::Clip(request.source_rect_screen, virtual_bounds);
+        if (request.source_kind != core::CaptureSourceKind::ScreenRect ||
+            (request.output_sink == core::OutputSinkKind::File &&
+             jobs[index].path.empty()) ||
+            !clipped.has_value()) {
+            results[index] = prepare_failed;
+            continue;
+        }
+        core::RectPx const capture_rect =
+            Capture_rect_from_screen_rect(*clipped, virtual_bounds);
+        if (!greenflame::Crop_capture(capture, capture_rect.left, capture_rect.top,
+                                      capture_rect.Width(), capture_rect.Height(),
+                                      frames[index])) {
+            results[index] = prepare_failed;
+            continue;
+        }
+        frame_bounds[index] = *clipped;
+        ready[index] = true;
+    }
+    capture.Free();
+
+    auto const save_job = [&](size_t index) {
+        try {
+            results[index] = Save_screen_rect_from_frame(
+                jobs[index].request, frames[index], frame_bounds[index],
+                cursor_snapshot, jobs[index].path, jobs[index].format);
+        } catch (std::bad_alloc const &) {
+            results[index] = prepare_failed;
+        }
+        frames[index].Free();
+    };
+    // Jobs and the export tiles inside them share one pool, so a grab saved to
+    // several outputs never runs more threads than there are cores.
+    core::Parallel_for(jobs.size(), {.max_workers = core::Default_parallel_workers()},
+                       [&](size_t index) {
+                           if (ready[index]) {
+                               save_job(index);
+                           }
+                       });
+    return results;
+}
+
+std::optional<uint64_t> Win32CaptureService::Take_recorded_capture_id() {
+    return std::exchange(recorded_capture_id_, std::nullopt);
+}
+
+bool Win32CaptureService::Copy_history_capture_to_clipboard(uint64_t id) {
+    GdiCaptureResult capture{};
+    core::RectPx screen_rect = {};
+    if (!Load_history_capture(id, capture, screen_rect)) {
+        return false;
+    }
+    bool const copied = greenflame::Copy_capture_to_clipboard(capture, nullptr);
+    capture.Free();
+    return copied;
+}
+
+core::CaptureSaveResult
+Win32CaptureService::Save_history_capture_to_file(uint64_t id, std::wstring_view path,
+                                                  core::ImageSaveFormat format) {
+    GdiCaptureResult capture{};
+    core::RectPx screen_rect = {};
+    if (!Load_history_capture(id, capture, screen_rect)) {
+        return Make_capture_save_result(core::CaptureSaveStatus::SaveFailed);
+    }
+    core::CaptureSaveResult result = Save_bitmap_to_file(capture, path, format);
+    capture.Free();
+    return result;
+}
+
+void Win32CaptureService::Record_capture(GdiCaptureResult const &capture,
+                                         core::RectPx screen_rect,
+                                         std::optional<HWND> window) {
+    std::span<uint8_t> const pixels = Capture_pixels(capture);
+    if (pixels.empty()) {
+        recorded_capture_id_ = std::nullopt;
+        return;
+    }
+    core::ExportSourcePixels const source{
+        pixels, static_cast<size_t>(greenflame::Row_bytes32(capture.width)),
+        capture.width, capture.height};
+    recorded_capture_id_ = history_.Record(source, screen_rect, window);
+}
+
+bool Win32CaptureService::Load_history_capture(uint64_t id, GdiCaptureResult &out,
+                                               core::RectPx &screen_rect) {
+    std::optional<core::CaptureHistoryEntryInfo> const info = history_.Find(id);
+    if (!info.has_value() ||
+        !greenflame::Create_solid_capture(info->width, info->height,
+                                          static_cast<COLORREF>(0), out)) {
+        return false;
+    }
+    std::span<uint8_t> const pixels = Capture_pixels(out);
+    core::ImageRowTarget const target{
+        pixels, static_cast<size_t>(greenflame::Row_bytes32(out.width))};
+    if (pixels.empty() || !history_.Read_all(id, target)) {
+        out.Free();
+        return false;
+    }
+    screen_rect = info->screen_rect;
+    return true;
+}
+
+void Win32CaptureService::Set_history_budget_mb(int32_t budget_mb) {
+    history_.Set_limits(core::CaptureHistoryLimits{
+        .budget_bytes = static_cast<size_t>(std::max(budget_mb, 0)) << 20u});
+}
+
+struct Win32InputImageService::ProbedInput final {
+    std::wstring path = {};
+    InputImageSource source = {};
+    // Whole-image rows, width * 4 bytes apart; empty when the probe did not need
+    // to decode.
+    std::vector<uint8_t> rows = {};
+};
+
+Win32InputImageService::Win32InputImageService() = default;
+
+Win32InputImageService::~Win32InputImageService() = default;
+
 core::InputImageProbeResult
 Win32InputImageService::Probe_input_image(std::wstring_view path) {
-    DecodedInputImage decoded_image{};
+    probed_input_.reset();
+    auto probed = std::make_unique<ProbedInput>();
+    InputImageSource &source = probed->source;
     std::wstring error_message = {};
-    if (!Try_decode_input_image(path, decoded_image, error_message)) {
+    if (!Try_open_input_image(path, source, error_message)) {
         return Make_probe_result(core::InputImageProbeStatus::SourceReadFailed,
                                  error_message);
     }
 
+    // Formats that can carry alpha still need their pixels checked here, so a
+    // transparent input fails before any output path is reserved. The rows are
+    // kept for the save instead of being decoded a second time.
+    if (source.header.may_have_alpha) {
+        size_t const row_bytes = static_cast<size_t>(source.header.width) * 4u;
+        probed->rows.resize(row_bytes * static_cast<size_t>(source.header.height));
+        if (!Try_decode_input_rows(source,
+                                   core::ImageRowTarget{probed->rows, row_bytes},
+                                   path, error_message)) {
+            return Make_probe_result(core::InputImageProbeStatus::SourceReadFailed,
+                                     error_message);
+        }
+    }
+
     core::InputImageProbeResult result{};
     result.status = core::InputImageProbeStatus::Success;
-    result.width = decoded_image.width;
-    result.height = decoded_image.height;
-    result.format = decoded_image.format;
+    result.width = source.header.width;
+    result.height = source.header.height;
+    result.format = source.header.format;
+    probed->path = path;
+    probed_input_ = std::move(probed);
     return result;
 }
 
 core::InputImageSaveResult Win32InputImageService::Save_input_image_to_file(
     core::InputImageSaveRequest const &request, std::wstring_view input_path,
     std::wstring_view output_path, core::ImageSaveFormat format) {
-    if (input_path.empty() || output_path.empty()) {
+    std::unique_ptr<ProbedInput> probed = std::move(probed_input_);
+    bool const to_file = request.output_sink == core::OutputSinkKind::File;
+    if (input_path.empty() || (to_file && output_path.empty())) {
         return Make_input_save_result(
             core::InputImageSaveStatus::SaveFailed,
             L"Error: Input and output paths are required for --input.");
     }
 
-    DecodedInputImage decoded_image{};
     std::wstring error_message = {};
-    if (!Try_decode_input_image(input_path, decoded_image, error_message)) {
-        return Make_input_save_result(core::InputImageSaveStatus::SourceReadFailed,
-                                      error_message);
-    }
-
-    GdiCaptureResult source_capture{};
-    if (!Try_create_capture_from_input_image(decoded_image, source_capture,
-                                             error_message)) {
-        return Make_input_save_result(core::InputImageSaveStatus::SaveFailed,
-                                      error_message);
+    if (probed == nullptr || probed->path != input_path) {
+        probed = std::make_unique<ProbedInput>();
+        if (!Try_open_input_image(input_path, probed->source, error_message)) {
+            return Make_input_save_result(core::InputImageSaveStatus::SourceReadFailed,
+                                          error_message);
+        }
     }
+    InputImageSource &source = probed->source;
 
     core::CaptureSaveRequest capture_request{};
     capture_request.source_rect_screen =
-        core::RectPx::From_ltrb(0, 0, decoded_image.width, decoded_image.height);
+        core::RectPx::From_ltrb(0, 0, source.header.width, source.header.height);
     capture_request.padding_px = request.padding_px;
     capture_request.fill_color = request.fill_color;
     capture_request.annotations = request.annotations;
 
+    int32_t source_width = 0;
+    int32_t source_height = 0;
+    int32_t output_width = 0;
+    int32_t output_height = 0;
+    core::RectPx annotation_target_bounds = {};
+    GdiCaptureResult canvas{};
+    std::span<uint8_t> canvas_pixels = {};
+    if (!Try_compute_render_sizes(capture_request, source_width, source_height,
+                                  output_width, output_height) ||
+        !Try_compute_annotation_target_bounds(capture_request,
+                                              annotation_target_bounds) ||
+        !Try_create_input_canvas(output_width, output_height, request.padding_px,
+                                 request.fill_color, canvas, canvas_pixels)) {
+        return Make_input_save_result(core::InputImageSaveStatus::SaveFailed,
+                                      L"Error: Failed to prepare the input image "
+                                      L"bitmap.");
+    }
+
+    // The image is decoded straight into its padded position in the canvas.
+    size_t const canvas_row_bytes = static_cast<size_t>(Row_bytes32(output_width));
+    core::ImageRowTarget const target{
+        canvas_pixels.subspan(static_cast<size_t>(request.padding_px.top) *
+                                  canvas_row_bytes +
+                              static_cast<size_t>(request.padding_px.left) * 4u),
+        canvas_row_bytes};
+    bool decoded = true;
+    if (probed->rows.empty()) {
+        decoded = Try_decode_input_rows(source, target, input_path, error_message);
+    } else {
+        size_t const row_bytes = static_cast<size_t>(source.header.width) * 4u;
+        for (size_t row = 0; row < static_cast<size_t>(source.header.height); ++row) {
+            std::memcpy(target.pixels.data() + row * target.row_bytes,
+                        probed->rows.data() + row * row_bytes, row_bytes);
+        }
+    }
+    // Unmapped before saving: the output may replace the input file.
+    probed.reset();
+    if (!decoded) {
+        canvas.Free();
+        return Make_input_save_result(core::InputImageSaveStatus::SourceReadFailed,
+                                      error_message);
+    }
+
+    if (!Render_annotations_into_capture(canvas, capture_request.annotations,
+                                         annotation_target_bounds)) {
+        canvas.Free();
+        return Make_input_save_result(
+            core::InputImageSaveStatus::SaveFailed,
+            L"Error: Failed to compose annotations onto the capture.");
+    }
+
+    if (!to_file) {
+        core::CaptureSaveResult save_result =
+            Save_bitmap_to_sink(canvas, request.output_sink, {}, format);
+        canvas.Free();
+        core::InputImageSaveResult result = Make_input_save_result(
+            save_result.status == core::CaptureSaveStatus::Success
+                ? core::InputImageSaveStatus::Success
+                : core::InputImageSaveStatus::SaveFailed,
+            save_result.error_message);
+        result.encoded_bytes = std::move(save_result.encoded_bytes);
+        return result;
+    }
+
     std::wstring const input_path_string(input_path);
     std::wstring const output_path_string(output_path);
     core::CaptureSaveResult save_result{};
@@ -1109,37 +1690,35 @@ core::InputImageSaveResult Win32InputImageService::Save_input_image_to_file(
         std::wstring temp_path = {};
         if (!Try_create_sibling_temp_path(output_path_string, temp_path,
                                           error_message)) {
-            source_capture.Free();
+            canvas.Free();
             return Make_input_save_result(core::InputImageSaveStatus::SaveFailed,
                                           error_message);
         }
 
-        save_result = Save_exact_source_capture_to_file(source_capture, capture_request,
-                                                        nullptr, temp_path, format);
+        save_result = Save_bitmap_to_file(canvas, temp_path, format);
         if (save_result.status != core::CaptureSaveStatus::Success) {
             Delete_file_if_exists(temp_path);
-            source_capture.Free();
+            canvas.Free();
             return Make_input_save_result(core::InputImageSaveStatus::SaveFailed,
                                           save_result.error_message);
         }
 
         if (!Try_replace_file(temp_path, output_path_string, error_message)) {
             Delete_file_if_exists(temp_path);
-            source_capture.Free();
+            canvas.Free();
             return Make_input_save_result(core::InputImageSaveStatus::SaveFailed,
                                           error_message);
         }
     } else {
-        save_result = Save_exact_source_capture_to_file(
-            source_capture, capture_request, nullptr, output_path_string, format);
+        save_result = Save_bitmap_to_file(canvas, output_path_string, format);
         if (save_result.status != core::CaptureSaveStatus::Success) {
-            source_capture.Free();
+            canvas.Free();
             return Make_input_save_result(core::InputImageSaveStatus::SaveFailed,
                                           save_result.error_message);
         }
     }
 
-    source_capture.Free();
+    canvas.Free();
     return Make_input_save_result(core::InputImageSaveStatus::Success);
 }
 
@@ -1153,8 +1732,10 @@ Win32AnnotationPreparationService::Prepare_annotations(
     }
     result.annotations = request.annotations;
 
+    // Workers each get their own layout engine, so the Direct2D factory they
+    // share must be multithreaded. DirectWrite's shared factory already is.
     Microsoft::WRL::ComPtr<ID2D1Factory> d2d_factory;
-    HRESULT hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED,
+    HRESULT hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_MULTI_THREADED,
                                    d2d_factory.GetAddressOf());
     if (FAILED(hr) || !d2d_factory) {
         result.error_message = L"Error: Failed to initialize Direct2D for --annotate.";
@@ -1179,55 +1760,60 @@ Win32AnnotationPreparationService::Prepare_annotations(
         return result;
     }
 
-    D2DTextLayoutEngine engine(d2d_factory.Get(), dwrite_factory.Get());
-    std::array<std::wstring_view, 4> preset_font_families = {
-        request.preset_font_families[0], request.preset_font_families[1],
-        request.preset_font_families[2], request.preset_font_families[3]};
-    engine.Set_font_families(preset_font_families);
-
-    for (core::Annotation &annotation : result.annotations) {
-        if (core::TextAnnotation *const text =
+    // Each distinct explicit family is looked up once per batch.
+    std::unordered_map<std::wstring, bool> installed_families = {};
+    auto const find_missing_family =
+        [&](std::wstring const &family) -> std::wstring const * {
+        if (family.empty()) {
+            return nullptr;
+        }
+        auto const [it, inserted] = installed_families.try_emplace(family, false);
+        if (inserted) {
+            it->second = Has_installed_font_family(font_collection.Get(), family);
+        }
+        return it->second ? nullptr : &it->first;
+    };
+    for (core::Annotation const &annotation : result.annotations) {
+        std::wstring const *missing_family = nullptr;
+        if (core::TextAnnotation const *const text =
                 std::get_if<core::TextAnnotation>(&annotation.data);
             text != nullptr) {
-            if (!text->base_style.font_family.empty() &&
-                !Has_installed_font_family(font_collection.Get(),
-                                           text->base_style.font_family)) {
-                result.status = core::AnnotationPreparationStatus::InputInvalid;
-                result.error_message = L"--annotate: font family \"" +
-                                       text->base_style.font_family +
-                                       L"\" is not installed.";
-                return result;
-            }
-
-            if (!engine.Prepare_for_cli(*text) || !Is_rasterized_ready(*text)) {
-                result.error_message =
-                    L"Error: Failed to rasterize a text annotation for --annotate.";
-                return result;
-            }
-            continue;
+            missing_family = find_missing_family(text->base_style.font_family);
+        } else if (core::BubbleAnnotation const *const bubble =
+                       std::get_if<core::BubbleAnnotation>(&annotation.data);
+                   bubble != nullptr) {
+            missing_family = find_missing_family(bubble->font_family);
         }
-
-        if (core::BubbleAnnotation *const bubble =
-                std::get_if<core::BubbleAnnotation>(&annotation.data);
-            bubble != nullptr) {
-            if (!bubble->font_family.empty() &&
-                !Has_installed_font_family(font_collection.Get(),
-                                           bubble->font_family)) {
-                result.status = core::AnnotationPreparationStatus::InputInvalid;
-                result.error_message = L"--annotate: font family \"" +
-                                       bubble->font_family + L"\" is not installed.";
-                return result;
-            }
-
-            engine.Rasterize_bubble(*bubble);
-            if (!Is_rasterized_ready(*bubble)) {
-                result.error_message =
-                    L"Error: Failed to rasterize a bubble annotation for --annotate.";
-                return result;
-            }
+        if (missing_family != nullptr) {
+            result.status = core::AnnotationPreparationStatus::InputInvalid;
+            result.error_message = L"--annotate: font family \"" + *missing_family +
+                                   L"\" is not installed.";
+            return result;
         }
     }
 
+    std::array<std::wstring_view, 4> const preset_font_families = {
+        request.preset_font_families[0], request.preset_font_families[1],
+        request.preset_font_families[2], request.preset_font_families[3]};
+    core::TextLayoutEngineFactory const engine_factory =
+        [&]() -> std::unique_ptr<core::ITextLayoutEngine> {
+        auto engine = std::make_unique<D2DTextLayoutEngine>(d2d_factory.Get(),
+                                                            dwrite_factory.Get());
+        engine->Set_font_families(preset_font_families);
+        return engine;
+    };
+    core::AnnotationRasterBatchResult const raster =
+        raster_scheduler_.Rasterize(result.annotations, request.preset_font_families,
+                                    engine_factory, core::Default_parallel_workers());
+    if (!raster.success) {
+        result.error_message =
+            std::holds_alternative<core::BubbleAnnotation>(
+                result.annotations[raster.failed_index].data)
+                ? L"Error: Failed to rasterize a bubble annotation for --annotate."
+                : L"Error: Failed to rasterize a text annotation for --annotate.";
+        return result;
+    }
+
     result.status = core::AnnotationPreparationStatus::Success;
     return result;
 }
@@ -1362,6 +1948,18 @@ bool Win32FileSystemService::Try_read_text_file_utf8(
     return true;
 }
 
+bool Win32FileSystemService::Try_read_annotation_document(
+    std::wstring_view path, core::AnnotationDocument &document,
+    std::wstring &error_message) const {
+    return Try_load_annotation_document_file(path, document, error_message);
+}
+
+bool Win32FileSystemService::Try_write_annotation_document(
+    std::wstring_view path, core::AnnotationDocument const &document,
+    std::wstring &error_message) const {
+    return Try_save_annotation_document_file(path, document, error_message);
+}
+
 void Win32FileSystemService::Delete_file_if_exists(std::wstring_view path) const {
     if (path.empty()) {
         return;
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "greenflame_core/annotation_raster_scheduler.h"
 #include "greenflame_core/app_services.h"
+#include "greenflame_core/capture_history.h"
 #include "greenflame_core/spell_check_service.h"
+#include "win/gdi_capture.h"
 #include "win/window_query.h"
 
 namespace greenflame {
@@ -42,21 +45,63 @@ class Win32CaptureService final : public ICaptureService {
     [[nodiscard]] core::CaptureSaveResult
     Save_capture_to_file(core::CaptureSaveRequest const &request,
                          std::wstring_view path, core::ImageSaveFormat format) override;
+    [[nodiscard]] std::vector<core::CaptureSaveResult>
+    Save_captures_from_one_grab(std::span<const core::CaptureSaveJob> jobs) override;
+    [[nodiscard]] std::optional<uint64_t> Take_recorded_capture_id() override;
+    [[nodiscard]] bool Copy_history_capture_to_clipboard(uint64_t id) override;
+    [[nodiscard]] core::CaptureSaveResult
+    Save_history_capture_to_file(uint64_t id, std::wstring_view path,
+                                 core::ImageSaveFormat format) override;
+
+    // Keeps a copy of `capture` for exact re-copies; it is compressed in the
+    // background. Clipboard copies made by this service are recorded on their
+    // own; the overlay reports its captures here.
+    void Record_capture(GdiCaptureResult const &capture, core::RectPx screen_rect,
+                        std::optional<HWND> window);
+    // A new bitmap of a history entry, e.g. to pin it again. False once the entry
+    // has been evicted.
+    [[nodiscard]] bool Load_history_capture(uint64_t id, GdiCaptureResult &out,
+                                            core::RectPx &screen_rect);
+    // 0 disables the history and drops what it holds.
+    void Set_history_budget_mb(int32_t budget_mb);
+
+  private:
+    core::CaptureHistoryRecorder history_{
+        core::CaptureHistoryLimits{.budget_bytes = 0}};
+    std::optional<uint64_t> recorded_capture_id_ = std::nullopt;
 };
 
 class Win32AnnotationPreparationService final : public IAnnotationPreparationService {
   public:
     [[nodiscard]] core::AnnotationPreparationResult
     Prepare_annotations(core::AnnotationPreparationRequest const &request) override;
+
+  private:
+    // Text and bubble rasters are reused across batches served by this service.
+    core::AnnotationRasterScheduler raster_scheduler_ = {};
 };
 
 class Win32InputImageService final : public IInputImageService {
   public:
+    Win32InputImageService();
+    ~Win32InputImageService();
+    Win32InputImageService(Win32InputImageService const &) = delete;
+    Win32InputImageService &operator=(Win32InputImageService const &) = delete;
+    Win32InputImageService(Win32InputImageService &&) = delete;
+    Win32InputImageService &operator=(Win32InputImageService &&) = delete;
+
     [[nodiscard]] core::InputImageProbeResult
     Probe_input_image(std::wstring_view path) override;
     [[nodiscard]] core::InputImageSaveResult Save_input_image_to_file(
         core::InputImageSaveRequest const &request, std::wstring_view input_path,
         std::wstring_view output_path, core::ImageSaveFormat format) override;
+
+  private:
+    struct ProbedInput;
+
+    // The mapping, header and (for formats that can carry alpha) decoded rows
+    // from the last successful probe, handed to the save of the same path.
+    std::unique_ptr<ProbedInput> probed_input_;
 };
 
 class Win32FileSystemService final : public IFileSystemService {
@@ -75,6 +120,14 @@ class Win32FileSystemService final : public IFileSystemService {
     [[nodiscard]] bool
     Try_read_text_file_utf8(std::wstring_view path, std::string &utf8_text,
                             std::wstring &error_message) const override;
+    [[nodiscard]] bool
+    Try_read_annotation_document(std::wstring_view path,
+                                 core::AnnotationDocument &document,
+                                 std::wstring &error_message) const override;
+    [[nodiscard]] bool
+    Try_write_annotation_document(std::wstring_view path,
+                                  core::AnnotationDocument const &document,
+                                  std::wstring &error_message) const override;
     void Delete_file_if_exists(std::wstring_view path) const override;
     [[nodiscard]] core::SaveTimestamp Get_current_timestamp() const override;
 };
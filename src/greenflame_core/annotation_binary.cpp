@@ -0,0 +1,677 @@
+#include "greenflame_core/annotation_binary.h"
+
+#include "greenflame_core/annotation_document.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr uint8_t kBitmapRaw = 0;
+constexpr uint8_t kBitmapLz = 1;
+constexpr size_t kMaxBitmapBytes = size_t{1} << 30;
+// Two int32 coordinates are never further apart than this.
+constexpr int64_t kMaxPointDelta = int64_t{1} << 32;
+
+constexpr size_t kLzMinMatch = 4;
+// Match lengths fit a two-byte varint, so a match sequence (empty literal count,
+// distance, length) of at least four bytes never expands to more than
+// kLzMaxMatch bytes. That bounds the decoded size by the input length before
+// anything is allocated.
+constexpr size_t kLzMaxMatch = kLzMinMatch + 0x3FFF;
+constexpr size_t kLzMaxExpansion = kLzMaxMatch / 4 + 1;
+constexpr size_t kLzHashBits = 14;
+constexpr uint32_t kLzNoPosition = std::numeric_limits<uint32_t>::max();
+
+[[nodiscard]] uint64_t Zigzag_encode(int64_t value) noexcept {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+[[nodiscard]] int64_t Zigzag_decode(uint64_t value) noexcept {
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+class ByteWriter final {
+  public:
+    void Put_u8(uint8_t value) { bytes_.push_back(value); }
+
+    void Put_u16(uint16_t value) {
+        Put_u8(static_cast<uint8_t>(value & 0xFFu));
+        Put_u8(static_cast<uint8_t>(value >> 8));
+    }
+
+    void Put_u32(uint32_t value) {
+        Put_u16(static_cast<uint16_t>(value & 0xFFFFu));
+        Put_u16(static_cast<uint16_t>(value >> 16));
+    }
+
+    void Put_varint(uint64_t value) {
+        while (value >= 0x80u) {
+            Put_u8(static_cast<uint8_t>(value | 0x80u));
+            value >>= 7;
+        }
+        Put_u8(static_cast<uint8_t>(value));
+    }
+
+    void Put_signed(int64_t value) { Put_varint(Zigzag_encode(value)); }
+    void Put_bool(bool value) { Put_u8(value ? 1 : 0); }
+
+    void Put_bytes(std::span<const uint8_t> bytes) {
+        bytes_.insert(bytes_.end(), bytes.begin(), bytes.end());
+    }
+
+    [[nodiscard]] std::vector<uint8_t> Take() noexcept { return std::move(bytes_); }
+
+  private:
+    std::vector<uint8_t> bytes_ = {};
+};
+
+// All reads are bounds checked against the source span; a failed read leaves
+// the output untouched and returns false.
+class ByteReader final {
+  public:
+    explicit ByteReader(std::span<const uint8_t> bytes) noexcept : bytes_(bytes) {}
+
+    [[nodiscard]] size_t Remaining() const noexcept { return bytes_.size() - offset_; }
+
+    [[nodiscard]] bool Read_u8(uint8_t &value) noexcept {
+        if (Remaining() < 1) {
+            return false;
+        }
+        value = bytes_[offset_++];
+        return true;
+    }
+
+    [[nodiscard]] bool Read_u16(uint16_t &value) noexcept {
+        uint8_t low = 0;
+        uint8_t high = 0;
+        if (!Read_u8(low) || !Read_u8(high)) {
+            return false;
+        }
+        value = static_cast<uint16_t>(low | (high << 8));
+        return true;
+    }
+
+    [[nodiscard]] bool Read_u32(uint32_t &value) noexcept {
+        uint16_t low = 0;
+        uint16_t high = 0;
+        if (!Read_u16(low) || !Read_u16(high)) {
+            return false;
+        }
+        value = static_cast<uint32_t>(low) | (static_cast<uint32_t>(high) << 16);
+        return true;
+    }
+
+    [[nodiscard]] bool Read_varint(uint64_t &value) noexcept {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = 0;
+            if (!Read_u8(byte)) {
+                return false;
+            }
+            result |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+            if ((byte & 0x80u) == 0) {
+                value = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool Read_signed(int64_t &value) noexcept {
+        uint64_t raw = 0;
+        if (!Read_varint(raw)) {
+            return false;
+        }
+        value = Zigzag_decode(raw);
+        return true;
+    }
+
+    [[nodiscard]] bool Read_i32(int32_t &value) noexcept {
+        int64_t decoded = 0;
+        if (!Read_signed(decoded)) {
+            return false;
+        }
+        if (decoded < std::numeric_limits<int32_t>::min() ||
+            decoded > std::numeric_limits<int32_t>::max()) {
+            return false;
+        }
+        value = static_cast<int32_t>(decoded);
+        return true;
+    }
+
+    [[nodiscard]] bool Read_bool(bool &value) noexcept {
+        uint8_t byte = 0;
+        if (!Read_u8(byte) || byte > 1) {
+            return false;
+        }
+        value = byte == 1;
+        return true;
+    }
+
+    // Element counts are capped by the bytes left, since every element takes
+    // at least `min_element_bytes`; corrupt counts cannot force huge reserves.
+    [[nodiscard]] bool Read_count(size_t &count, size_t min_element_bytes) noexcept {
+        uint64_t raw = 0;
+        if (!Read_varint(raw) || raw > Remaining() / min_element_bytes) {
+            return false;
+        }
+        count = static_cast<size_t>(raw);
+        return true;
+    }
+
+    [[nodiscard]] bool Read_bytes(size_t count,
+                                  std::span<const uint8_t> &bytes) noexcept {
+        if (Remaining() < count) {
+            return false;
+        }
+        bytes = bytes_.subspan(offset_, count);
+        offset_ += count;
+        return true;
+    }
+
+  private:
+    std::span<const uint8_t> bytes_ = {};
+    size_t offset_ = 0;
+};
+
+void Write_point(ByteWriter &writer, PointPx point) {
+    writer.Put_signed(point.x);
+    writer.Put_signed(point.y);
+}
+
+void Write_rect(ByteWriter &writer, RectPx rect) {
+    writer.Put_signed(rect.left);
+    writer.Put_signed(rect.top);
+    writer.Put_signed(rect.right);
+    writer.Put_signed(rect.bottom);
+}
+
+void Write_string(ByteWriter &writer, std::wstring_view text) {
+    writer.Put_varint(text.size());
+    for (wchar_t const ch : text) {
+        writer.Put_u16(static_cast<uint16_t>(ch));
+    }
+}
+
+void Write_stroke_style(ByteWriter &writer, StrokeStyle const &style) {
+    writer.Put_signed(style.width_px);
+    writer.Put_u32(static_cast<uint32_t>(style.color));
+    writer.Put_signed(style.opacity_percent);
+}
+
+[[nodiscard]] uint8_t Pack_text_flags(TextStyleFlags flags) noexcept {
+    return static_cast<uint8_t>((flags.bold ? 1u : 0u) | (flags.italic ? 2u : 0u) |
+                                (flags.underline ? 4u : 0u) |
+                                (flags.strikethrough ? 8u : 0u));
+}
+
+void Write_bitmap(ByteWriter &writer, int32_t width_px, int32_t height_px,
+                  int32_t row_bytes, std::vector<uint8_t> const &pixels,
+                  AnnotationBinaryEncodeOptions const &options) {
+    writer.Put_signed(width_px);
+    writer.Put_signed(height_px);
+    writer.Put_signed(row_bytes);
+    writer.Put_varint(pixels.size());
+    if (options.compress_bitmaps && !pixels.empty()) {
+        std::vector<uint8_t> const compressed = Lz_compress_bytes(pixels);
+        if (!compressed.empty() && compressed.size() < pixels.size()) {
+            writer.Put_u8(kBitmapLz);
+            writer.Put_varint(compressed.size());
+            writer.Put_bytes(compressed);
+            return;
+        }
+    }
+    writer.Put_u8(kBitmapRaw);
+    writer.Put_bytes(pixels);
+}
+
+void Write_annotation(ByteWriter &writer, Annotation const &annotation,
+                      AnnotationBinaryEncodeOptions const &options) {
+    writer.Put_u8(static_cast<uint8_t>(annotation.Kind()));
+    writer.Put_varint(annotation.id);
+    std::visit(
+        Overloaded{
+            [&](FreehandStrokeAnnotation const &freehand) {
+                Write_stroke_style(writer, freehand.style);
+                writer.Put_u8(static_cast<uint8_t>(freehand.freehand_tip_shape));
+                writer.Put_varint(freehand.points.size());
+                PointPx previous = {};
+                for (PointPx const point : freehand.points) {
+                    writer.Put_signed(static_cast<int64_t>(point.x) - previous.x);
+                    writer.Put_signed(static_cast<int64_t>(point.y) - previous.y);
+                    previous = point;
+                }
+            },
+            [&](LineAnnotation const &line) {
+                Write_point(writer, line.start);
+                Write_point(writer, line.end);
+                Write_stroke_style(writer, line.style);
+                writer.Put_bool(line.arrow_head);
+            },
+            [&](RectangleAnnotation const &rectangle) {
+                Write_rect(writer, rectangle.outer_bounds);
+                Write_stroke_style(writer, rectangle.style);
+                writer.Put_bool(rectangle.filled);
+            },
+            [&](EllipseAnnotation const &ellipse) {
+                Write_rect(writer, ellipse.outer_bounds);
+                Write_stroke_style(writer, ellipse.style);
+                writer.Put_bool(ellipse.filled);
+            },
+            [&](ObfuscateAnnotation const &obfuscate) {
+                Write_rect(writer, obfuscate.bounds);
+                writer.Put_signed(obfuscate.block_size);
+                Write_bitmap(writer, obfuscate.bitmap_width_px,
+                             obfuscate.bitmap_height_px, obfuscate.bitmap_row_bytes,
+                             obfuscate.premultiplied_bgra, options);
+            },
+            [&](TextAnnotation const &text) {
+                Write_point(writer, text.origin);
+                writer.Put_u32(static_cast<uint32_t>(text.base_style.color));
+                writer.Put_u8(static_cast<uint8_t>(text.base_style.font_choice));
+                Write_string(writer, text.base_style.font_family);
+                writer.Put_signed(text.base_style.point_size);
+                writer.Put_varint(text.runs.size());
+                for (TextRun const &run : text.runs) {
+                    Write_string(writer, run.text);
+                    writer.Put_u8(Pack_text_flags(run.flags));
+                }
+                Write_rect(writer, text.visual_bounds);
+                Write_bitmap(writer, text.bitmap_width_px, text.bitmap_height_px,
+                             text.bitmap_row_bytes, text.premultiplied_bgra, options);
+            },
+            [&](BubbleAnnotation const &bubble) {
+                Write_point(writer, bubble.center);
+                writer.Put_signed(bubble.diameter_px);
+                writer.Put_u32(static_cast<uint32_t>(bubble.color));
+                writer.Put_u8(static_cast<uint8_t>(bubble.font_choice));
+                Write_string(writer, bubble.font_family);
+                writer.Put_signed(bubble.counter_value);
+                Write_bitmap(writer, bubble.bitmap_width_px, bubble.bitmap_height_px,
+                             bubble.bitmap_row_bytes, bubble.premultiplied_bgra,
+                             options);
+            },
+        },
+        annotation.data);
+}
+
+[[nodiscard]] bool Read_point(ByteReader &reader, PointPx &point) noexcept {
+    return reader.Read_i32(point.x) && reader.Read_i32(point.y);
+}
+
+[[nodiscard]] bool Read_rect(ByteReader &reader, RectPx &rect) noexcept {
+    return reader.Read_i32(rect.left) && reader.Read_i32(rect.top) &&
+           reader.Read_i32(rect.right) && reader.Read_i32(rect.bottom);
+}
+
+[[nodiscard]] bool Read_color(ByteReader &reader, COLORREF &color) noexcept {
+    uint32_t raw = 0;
+    if (!reader.Read_u32(raw)) {
+        return false;
+    }
+    color = static_cast<COLORREF>(raw);
+    return true;
+}
+
+[[nodiscard]] bool Read_string(ByteReader &reader, std::wstring &text) noexcept {
+    size_t length = 0;
+    if (!reader.Read_count(length, 2)) {
+        return false;
+    }
+    text.resize(length);
+    for (wchar_t &ch : text) {
+        uint16_t unit = 0;
+        if (!reader.Read_u16(unit)) {
+            return false;
+        }
+        ch = static_cast<wchar_t>(unit);
+    }
+    return true;
+}
+
+[[nodiscard]] bool Read_stroke_style(ByteReader &reader, StrokeStyle &style) noexcept {
+    return reader.Read_i32(style.width_px) && Read_color(reader, style.color) &&
+           reader.Read_i32(style.opacity_percent);
+}
+
+[[nodiscard]] bool Read_font_choice(ByteReader &reader,
+                                    TextFontChoice &choice) noexcept {
+    uint8_t raw = 0;
+    if (!reader.Read_u8(raw) || raw > static_cast<uint8_t>(TextFontChoice::Art)) {
+        return false;
+    }
+    choice = static_cast<TextFontChoice>(raw);
+    return true;
+}
+
+[[nodiscard]] bool Read_text_flags(ByteReader &reader, TextStyleFlags &flags) noexcept {
+    uint8_t raw = 0;
+    if (!reader.Read_u8(raw) || raw > 0x0Fu) {
+        return false;
+    }
+    flags.bold = (raw & 1u) != 0;
+    flags.italic = (raw & 2u) != 0;
+    flags.underline = (raw & 4u) != 0;
+    flags.strikethrough = (raw & 8u) != 0;
+    return true;
+}
+
+// Either the all-zero "not rasterized" shape or whole BGRA rows, so readers can
+// index width x height pixels `row_bytes` apart without further checks.
+[[nodiscard]] bool Is_valid_bitmap_shape(int32_t width_px, int32_t height_px,
+                                         int32_t row_bytes, uint64_t size) noexcept {
+    if (width_px == 0 && height_px == 0 && row_bytes == 0) {
+        return size == 0;
+    }
+    if (width_px <= 0 || height_px <= 0 ||
+        static_cast<int64_t>(row_bytes) < int64_t{width_px} * 4) {
+        return false;
+    }
+    // Both factors are below 2^31, so the product cannot overflow.
+    return static_cast<uint64_t>(row_bytes) * static_cast<uint64_t>(height_px) ==
+           size;
+}
+
+[[nodiscard]] bool Read_bitmap(ByteReader &reader, int32_t &width_px,
+                               int32_t &height_px, int32_t &row_bytes,
+                               std::vector<uint8_t> &pixels) noexcept {
+    uint64_t size = 0;
+    uint8_t encoding = 0;
+    if (!reader.Read_i32(width_px) || !reader.Read_i32(height_px) ||
+        !reader.Read_i32(row_bytes) || !reader.Read_varint(size) ||
+        size > kMaxBitmapBytes ||
+        !Is_valid_bitmap_shape(width_px, height_px, row_bytes, size) ||
+        !reader.Read_u8(encoding)) {
+        return false;
+    }
+
+    std::span<const uint8_t> payload = {};
+    if (encoding == kBitmapRaw) {
+        if (!reader.Read_bytes(static_cast<size_t>(size), payload)) {
+            return false;
+        }
+        pixels.assign(payload.begin(), payload.end());
+        return true;
+    }
+    if (encoding != kBitmapLz) {
+        return false;
+    }
+    size_t compressed_size = 0;
+    return reader.Read_count(compressed_size, 1) &&
+           reader.Read_bytes(compressed_size, payload) &&
+           Try_lz_decompress_bytes(payload, static_cast<size_t>(size), pixels);
+}
+
+[[nodiscard]] bool Read_freehand(ByteReader &reader,
+                                 FreehandStrokeAnnotation &freehand) noexcept {
+    uint8_t tip = 0;
+    size_t count = 0;
+    if (!Read_stroke_style(reader, freehand.style) || !reader.Read_u8(tip) ||
+        tip > static_cast<uint8_t>(FreehandTipShape::Square) ||
+        !reader.Read_count(count, 2)) {
+        return false;
+    }
+    freehand.freehand_tip_shape = static_cast<FreehandTipShape>(tip);
+    freehand.points.resize(count);
+    PointPx previous = {};
+    for (PointPx &point : freehand.points) {
+        int64_t delta_x = 0;
+        int64_t delta_y = 0;
+        if (!reader.Read_signed(delta_x) || !reader.Read_signed(delta_y) ||
+            delta_x < -kMaxPointDelta || delta_x > kMaxPointDelta ||
+            delta_y < -kMaxPointDelta || delta_y > kMaxPointDelta) {
+            return false;
+        }
+        int64_t const x = static_cast<int64_t>(previous.x) + delta_x;
+        int64_t const y = static_cast<int64_t>(previous.y) + delta_y;
+        if (x < std::numeric_limits<int32_t>::min() ||
+            x > std::numeric_limits<int32_t>::max() ||
+            y < std::numeric_limits<int32_t>::min() ||
+            y > std::numeric_limits<int32_t>::max()) {
+            return false;
+        }
+        point = PointPx{static_cast<int32_t>(x), static_cast<int32_t>(y)};
+        previous = point;
+    }
+    return true;
+}
+
+[[nodiscard]] bool Read_text(ByteReader &reader, TextAnnotation &text) noexcept {
+    size_t run_count = 0;
+    if (!Read_point(reader, text.origin) ||
+        !Read_color(reader, text.base_style.color) ||
+        !Read_font_choice(reader, text.base_style.font_choice) ||
+        !Read_string(reader, text.base_style.font_family) ||
+        !reader.Read_i32(text.base_style.point_size) ||
+        !reader.Read_count(run_count, 2)) {
+        return false;
+    }
+    text.runs.resize(run_count);
+    for (TextRun &run : text.runs) {
+        if (!Read_string(reader, run.text) || !Read_text_flags(reader, run.flags)) {
+            return false;
+        }
+    }
+    return Read_rect(reader, text.visual_bounds) &&
+           Read_bitmap(reader, text.bitmap_width_px, text.bitmap_height_px,
+                       text.bitmap_row_bytes, text.premultiplied_bgra);
+}
+
+[[nodiscard]] bool Read_bubble(ByteReader &reader, BubbleAnnotation &bubble) noexcept {
+    return Read_point(reader, bubble.center) && reader.Read_i32(bubble.diameter_px) &&
+           Read_color(reader, bubble.color) &&
+           Read_font_choice(reader, bubble.font_choice) &&
+           Read_string(reader, bubble.font_family) &&
+           reader.Read_i32(bubble.counter_value) &&
+           Read_bitmap(reader, bubble.bitmap_width_px, bubble.bitmap_height_px,
+                       bubble.bitmap_row_bytes, bubble.premultiplied_bgra);
+}
+
+[[nodiscard]] bool Read_annotation(ByteReader &reader,
+                                   Annotation &annotation) noexcept {
+    uint8_t kind = 0;
+    if (!reader.Read_u8(kind) || !reader.Read_varint(annotation.id)) {
+        return false;
+    }
+    switch (static_cast<AnnotationKind>(kind)) {
+    case AnnotationKind::Freehand:
+        return Read_freehand(reader,
+                             annotation.data.emplace<FreehandStrokeAnnotation>());
+    case AnnotationKind::Line: {
+        LineAnnotation &line = annotation.data.emplace<LineAnnotation>();
+        return Read_point(reader, line.start) && Read_point(reader, line.end) &&
+               Read_stroke_style(reader, line.style) &&
+               reader.Read_bool(line.arrow_head);
+    }
+    case AnnotationKind::Rectangle: {
+        RectangleAnnotation &rectangle = annotation.data.emplace<RectangleAnnotation>();
+        return Read_rect(reader, rectangle.outer_bounds) &&
+               Read_stroke_style(reader, rectangle.style) &&
+               reader.Read_bool(rectangle.filled);
+    }
+    case AnnotationKind::Ellipse: {
+        EllipseAnnotation &ellipse = annotation.data.emplace<EllipseAnnotation>();
+        return Read_rect(reader, ellipse.outer_bounds) &&
+               Read_stroke_style(reader, ellipse.style) &&
+               reader.Read_bool(ellipse.filled);
+    }
+    case AnnotationKind::Obfuscate: {
+        ObfuscateAnnotation &obfuscate = annotation.data.emplace<ObfuscateAnnotation>();
+        return Read_rect(reader, obfuscate.bounds) &&
+               reader.Read_i32(obfuscate.block_size) &&
+               Read_bitmap(reader, obfuscate.bitmap_width_px,
+                           obfuscate.bitmap_height_px, obfuscate.bitmap_row_bytes,
+                           obfuscate.premultiplied_bgra);
+    }
+    case AnnotationKind::Text:
+        return Read_text(reader, annotation.data.emplace<TextAnnotation>());
+    case AnnotationKind::Bubble:
+        return Read_bubble(reader, annotation.data.emplace<BubbleAnnotation>());
+    }
+    return false;
+}
+
+[[nodiscard]] bool Read_document(ByteReader &reader,
+                                 AnnotationDocument &document) noexcept {
+    std::span<const uint8_t> magic = {};
+    uint16_t version = 0;
+    uint16_t reserved = 0;
+    if (!reader.Read_bytes(kAnnotationBinaryMagic.size(), magic) ||
+        !std::equal(magic.begin(), magic.end(), kAnnotationBinaryMagic.begin()) ||
+        !reader.Read_u16(version) || version != kAnnotationBinaryVersion ||
+        !reader.Read_u16(reserved) || reserved != 0 ||
+        !reader.Read_varint(document.next_annotation_id)) {
+        return false;
+    }
+
+    size_t selection_count = 0;
+    if (!reader.Read_count(selection_count, 1)) {
+        return false;
+    }
+    document.selected_annotation_ids.resize(selection_count);
+    for (uint64_t &id : document.selected_annotation_ids) {
+        if (!reader.Read_varint(id)) {
+            return false;
+        }
+    }
+
+    size_t annotation_count = 0;
+    if (!reader.Read_count(annotation_count, 2)) {
+        return false;
+    }
+    document.annotations.resize(annotation_count);
+    for (Annotation &annotation : document.annotations) {
+        if (!Read_annotation(reader, annotation)) {
+            return false;
+        }
+    }
+    return reader.Remaining() == 0;
+}
+
+[[nodiscard]] uint32_t Lz_hash(std::span<const uint8_t> input,
+                               size_t position) noexcept {
+    uint32_t const value = static_cast<uint32_t>(input[position]) |
+                           (static_cast<uint32_t>(input[position + 1]) << 8) |
+                           (static_cast<uint32_t>(input[position + 2]) << 16) |
+                           (static_cast<uint32_t>(input[position + 3]) << 24);
+    return (value * 2654435761u) >> (32 - kLzHashBits);
+}
+
+} // namespace
+
+std::vector<uint8_t>
+Encode_annotation_document(AnnotationDocument const &document,
+                           AnnotationBinaryEncodeOptions const &options) {
+    ByteWriter writer;
+    writer.Put_bytes(kAnnotationBinaryMagic);
+    writer.Put_u16(kAnnotationBinaryVersion);
+    writer.Put_u16(0);
+    writer.Put_varint(document.next_annotation_id);
+    writer.Put_varint(document.selected_annotation_ids.size());
+    for (uint64_t const id : document.selected_annotation_ids) {
+        writer.Put_varint(id);
+    }
+    writer.Put_varint(document.annotations.size());
+    for (Annotation const &annotation : document.annotations) {
+        Write_annotation(writer, annotation, options);
+    }
+    return writer.Take();
+}
+
+bool Try_decode_annotation_document(std::span<const uint8_t> bytes,
+                                    AnnotationDocument &document) noexcept {
+    document = {};
+    ByteReader reader(bytes);
+    if (!Read_document(reader, document)) {
+        document = {};
+        return false;
+    }
+    Rebuild_annotation_document_index(document);
+    return true;
+}
+
+// Stream of sequences: varint literal count, the literals, then (unless the
+// output is complete) varint match distance and varint (match length - 4). Matches
+// are at most kLzMaxMatch bytes.
+std::vector<uint8_t> Lz_compress_bytes(std::span<const uint8_t> input) {
+    if (input.size() >= kLzNoPosition) {
+        return {};
+    }
+
+    ByteWriter writer;
+    std::vector<uint32_t> table(size_t{1} << kLzHashBits, kLzNoPosition);
+    size_t literal_start = 0;
+    size_t position = 0;
+    while (position + kLzMinMatch <= input.size()) {
+        uint32_t const hash = Lz_hash(input, position);
+        uint32_t const candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(position);
+        if (candidate == kLzNoPosition ||
+            std::memcmp(&input[candidate], &input[position], kLzMinMatch) != 0) {
+            ++position;
+            continue;
+        }
+
+        size_t length = kLzMinMatch;
+        while (length < kLzMaxMatch && position + length < input.size() &&
+               input[candidate + length] == input[position + length]) {
+            ++length;
+        }
+        writer.Put_varint(position - literal_start);
+        writer.Put_bytes(input.subspan(literal_start, position - literal_start));
+        writer.Put_varint(position - candidate);
+        writer.Put_varint(length - kLzMinMatch);
+        position += length;
+        literal_start = position;
+    }
+    if (literal_start < input.size()) {
+        writer.Put_varint(input.size() - literal_start);
+        writer.Put_bytes(input.subspan(literal_start));
+    }
+    return writer.Take();
+}
+
+bool Try_lz_decompress_bytes(std::span<const uint8_t> input, size_t decoded_size,
+                             std::vector<uint8_t> &output) noexcept {
+    output.clear();
+    if (decoded_size > kMaxBitmapBytes ||
+        decoded_size / kLzMaxExpansion > input.size()) {
+        return false;
+    }
+    output.reserve(decoded_size);
+
+    ByteReader reader(input);
+    while (output.size() < decoded_size) {
+        uint64_t literal_count = 0;
+        std::span<const uint8_t> literals = {};
+        if (!reader.Read_varint(literal_count) ||
+            literal_count > decoded_size - output.size() ||
+            !reader.Read_bytes(static_cast<size_t>(literal_count), literals)) {
+            return false;
+        }
+        output.insert(output.end(), literals.begin(), literals.end());
+        if (output.size() == decoded_size) {
+            break;
+        }
+
+        uint64_t distance = 0;
+        uint64_t extra_length = 0;
+        size_t const remaining = decoded_size - output.size();
+        if (remaining < kLzMinMatch || !reader.Read_varint(distance) ||
+            distance == 0 || distance > output.size() ||
+            !reader.Read_varint(extra_length) ||
+            extra_length > std::min(remaining, kLzMaxMatch) - kLzMinMatch) {
+            return false;
+        }
+        size_t const length = static_cast<size_t>(extra_length) + kLzMinMatch;
+        size_t const source = output.size() - static_cast<size_t>(distance);
+        // Byte by byte so overlapping matches replicate runs.
+        for (size_t index = 0; index < length; ++index) {
+            uint8_t const value = output[source + index];
+            output.push_back(value);
+        }
+    }
+    return reader.Remaining() == 0;
+}
+
+} // namespace greenflame::core
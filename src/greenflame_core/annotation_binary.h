@@ -0,0 +1,40 @@
+#pragma once
+
+#include "greenflame_core/annotation_types.h"
+
+namespace greenflame::core {
+
+// Compact binary container for an AnnotationDocument ("GFAN"). Fixed-width
+// fields are little-endian, integers are LEB128 varints (zigzag for signed
+// values), freehand points are delta encoded, and rasterized text, bubble and
+// obfuscate pixels are embedded either raw or LZ compressed. A document loaded
+// back is equal to the one saved, so no re-rasterization is needed.
+inline constexpr std::array<uint8_t, 4> kAnnotationBinaryMagic = {{'G', 'F', 'A', 'N'}};
+inline constexpr uint16_t kAnnotationBinaryVersion = 1;
+
+struct AnnotationBinaryEncodeOptions final {
+    // Bitmaps that do not shrink are stored raw regardless.
+    bool compress_bitmaps = true;
+
+    constexpr bool
+    operator==(AnnotationBinaryEncodeOptions const &) const noexcept = default;
+};
+
+[[nodiscard]] std::vector<uint8_t>
+Encode_annotation_document(AnnotationDocument const &document,
+                           AnnotationBinaryEncodeOptions const &options = {});
+
+// Decodes from any byte span, typically a read-only view of a mapped file.
+// Every length is bounds checked; returns false and leaves `document` empty on
+// truncated, corrupt or unsupported-version input.
+[[nodiscard]] bool
+Try_decode_annotation_document(std::span<const uint8_t> bytes,
+                               AnnotationDocument &document) noexcept;
+
+// LZ77-style byte compression used for embedded bitmaps. Exposed for tests.
+[[nodiscard]] std::vector<uint8_t> Lz_compress_bytes(std::span<const uint8_t> input);
+[[nodiscard]] bool Try_lz_decompress_bytes(std::span<const uint8_t> input,
+                                           size_t decoded_size,
+                                           std::vector<uint8_t> &output) noexcept;
+
+} // namespace greenflame::core
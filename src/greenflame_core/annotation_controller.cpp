@@ -1,6 +1,7 @@
 #include "greenflame_core/annotation_controller.h"
 
 #include "greenflame_core/annotation_commands.h"
+#include "greenflame_core/annotation_document.h"
 #include "greenflame_core/freehand_annotation_tool.h"
 #include "greenflame_core/profiling.h"
 #include "greenflame_core/selection_wheel.h"
@@ -88,7 +89,7 @@ bool AnnotationController::Toggle_tool(AnnotationToolId id) {
         active_tool_.reset();
     } else {
         active_tool_ = id;
-        document_.selected_annotation_ids.clear();
+        Set_document_selection(document_, {});
     }
     return true;
 }
@@ -295,6 +296,14 @@ bool AnnotationController::Set_highlighter_opacity_percent(
     return true;
 }
 
+std::span<const AnnotationSummary>
+AnnotationController::Annotation_summaries() const noexcept {
+    if (!Annotation_document_index_is_current(document_)) {
+        return {};
+    }
+    return document_.index.summaries;
+}
+
 Annotation const *AnnotationController::Draft_annotation() const noexcept {
     IAnnotationTool const *const tool = Active_tool_impl();
     return tool == nullptr ? nullptr : tool->Draft_annotation(*this);
@@ -321,8 +330,7 @@ std::optional<size_t> AnnotationController::Selected_annotation_index() const no
     if (document_.selected_annotation_ids.size() != 1) {
         return std::nullopt;
     }
-    return Index_of_annotation_id(document_.annotations,
-                                  document_.selected_annotation_ids.front());
+    return Index_of_annotation_id(document_, document_.selected_annotation_ids.front());
 }
 
 Annotation const *AnnotationController::Selected_annotation() const noexcept {
@@ -335,8 +343,7 @@ Annotation const *AnnotationController::Selected_annotation() const noexcept {
 
 std::optional<RectPx>
 AnnotationController::Selected_annotation_bounds() const noexcept {
-    return Annotation_selection_bounds(document_.annotations,
-                                       document_.selected_annotation_ids);
+    return Annotation_selection_bounds(document_);
 }
 
 std::optional<AnnotationEditTarget>
@@ -388,12 +395,16 @@ std::vector<size_t> AnnotationController::Active_obfuscate_preview_indices() con
         return indices;
     }
 
+    bool const index_is_current = Annotation_document_index_is_current(document_);
     for (size_t index = 0; index < document_.annotations.size(); ++index) {
         Annotation const &annotation = document_.annotations[index];
         if (!Is_obfuscate_annotation(annotation)) {
             continue;
         }
 
+        RectPx const bounds = index_is_current
+                                  ? document_.index.summaries[index].hit_bounds
+                                  : Annotation_bounds(annotation);
         bool include_index = false;
         for (AnnotationEditPreview const &preview : previews) {
             if (preview.index >= document_.annotations.size()) {
@@ -403,9 +414,8 @@ std::vector<size_t> AnnotationController::Active_obfuscate_preview_indices() con
                 Annotation_bounds(preview.annotation_before);
             std::optional<RectPx> const new_bounds =
                 Annotation_bounds(preview.annotation_after);
-            if (index == preview.index ||
-                Bounds_intersect(Annotation_bounds(annotation), old_bounds) ||
-                Bounds_intersect(Annotation_bounds(annotation), new_bounds)) {
+            if (index == preview.index || Bounds_intersect(bounds, old_bounds) ||
+                Bounds_intersect(bounds, new_bounds)) {
                 include_index = true;
                 break;
             }
@@ -455,7 +465,7 @@ void AnnotationController::Begin_text_draft(PointPx origin) {
         return;
     }
 
-    document_.selected_annotation_ids.clear();
+    Set_document_selection(document_, {});
     TextAnnotationBaseStyle const base_style{
         .color = freehand_style_.color,
         .font_choice = Normalize_text_font_choice(text_current_font_),
@@ -506,7 +516,7 @@ bool AnnotationController::Begin_text_edit_on_annotation(uint64_t annotation_id,
     }
 
     std::optional<size_t> const index =
-        Index_of_annotation_id(document_.annotations, annotation_id);
+        Index_of_annotation_id(document_, annotation_id);
     if (!index.has_value()) {
         return false;
     }
@@ -539,7 +549,7 @@ void AnnotationController::Commit_text_edit_annotation(UndoStack &undo_stack,
     text_layout_engine_->Rasterize(annotation);
 
     std::optional<size_t> const index =
-        Index_of_annotation_id(document_.annotations, editing_id);
+        Index_of_annotation_id(document_, editing_id);
     if (!index.has_value()) {
         return;
     }
@@ -652,9 +662,7 @@ bool AnnotationController::On_primary_release(UndoStack &undo_stack) {
                     return false;
                 }
                 annotation_after = *rebuilt;
-                if (command.index < document_.annotations.size()) {
-                    document_.annotations[command.index] = annotation_after;
-                }
+                Replace_document_annotation(document_, command.index, annotation_after);
                 command.annotation_after = annotation_after;
             }
             primary_commands.push_back(std::make_unique<UpdateAnnotationCommand>(
@@ -711,13 +719,12 @@ bool AnnotationController::Delete_selected_annotation(UndoStack &undo_stack) {
     std::vector<size_t> selected_indices = {};
     selected_indices.reserve(selection_before.size());
     for (size_t index = 0; index < annotations_after.size(); ++index) {
-        if (Selection_contains_annotation_id(selection_before,
-                                             annotations_after[index].id)) {
+        if (Selection_contains_annotation_id(document_, annotations_after[index].id)) {
             selected_indices.push_back(index);
         }
     }
     if (selected_indices.empty()) {
-        document_.selected_annotation_ids.clear();
+        Set_document_selection(document_, {});
         return true;
     }
 
@@ -742,8 +749,7 @@ bool AnnotationController::Delete_selected_annotation(UndoStack &undo_stack) {
 }
 
 void AnnotationController::Clear_annotations() noexcept {
-    document_.annotations.clear();
-    document_.selected_annotation_ids.clear();
+    Clear_document_annotations(document_);
     active_edit_interaction_.reset();
     text_edit_ctrl_.reset();
     editing_annotation_id_.reset();
@@ -758,7 +764,7 @@ void AnnotationController::Reset_for_selection_mode() noexcept {
 std::optional<uint64_t>
 AnnotationController::Annotation_id_at(PointPx cursor) const noexcept {
     std::optional<size_t> const index =
-        Index_of_topmost_annotation_at(document_.annotations, cursor);
+        Index_of_topmost_annotation_at(document_, cursor);
     if (!index.has_value()) {
         return std::nullopt;
     }
@@ -782,7 +788,7 @@ bool AnnotationController::Set_selected_annotations(
     if (document_.selected_annotation_ids == selection) {
         return false;
     }
-    document_.selected_annotation_ids = std::move(selection);
+    Set_document_selection(document_, std::move(selection));
     return true;
 }
 
@@ -814,8 +820,8 @@ bool AnnotationController::Select_topmost_annotation(PointPx cursor) {
 
 AnnotationSelection AnnotationController::Annotation_ids_intersecting_selection_rect(
     RectPx selection_rect) const noexcept {
-    return greenflame::core::Annotation_ids_intersecting_selection_rect(
-        document_.annotations, selection_rect);
+    return greenflame::core::Annotation_ids_intersecting_selection_rect(document_,
+                                                                        selection_rect);
 }
 
 std::span<const PointPx> AnnotationController::Draft_freehand_points() const noexcept {
@@ -899,7 +905,7 @@ AnnotationController::Build_bubble_annotation(PointPx cursor) const {
     bubble.color = freehand_style_.color;
     bubble.font_choice = Normalize_text_font_choice(bubble_current_font_);
     bubble.counter_value = bubble_counter_;
-    text_layout_engine_->Rasterize_bubble(bubble);
+    bubble_renderer_.Rasterize(bubble, *text_layout_engine_);
 
     Annotation annotation{};
     annotation.id = Next_annotation_id();
@@ -950,7 +956,7 @@ bool AnnotationController::Begin_annotation_edit(AnnotationEditTarget target,
             document_.annotations, document_.selected_annotation_ids, cursor);
     } else {
         std::optional<size_t> const index =
-            Index_of_annotation_id(document_.annotations, target.annotation_id);
+            Index_of_annotation_id(document_, target.annotation_id);
         if (!index.has_value()) {
             return false;
         }
@@ -963,7 +969,7 @@ bool AnnotationController::Begin_annotation_edit(AnnotationEditTarget target,
 
     if (target.kind != AnnotationEditTargetKind::SelectionBody) {
         AnnotationSelection const selection = {target.annotation_id};
-        document_.selected_annotation_ids = Normalized_selection(selection);
+        Set_document_selection(document_, Normalized_selection(selection));
     }
     active_edit_interaction_ = std::move(interaction);
     return true;
@@ -971,8 +977,7 @@ bool AnnotationController::Begin_annotation_edit(AnnotationEditTarget target,
 
 AnnotationSelection AnnotationController::Normalized_selection(
     std::span<const uint64_t> selected_annotation_ids) const noexcept {
-    return Normalize_annotation_selection(document_.annotations,
-                                          selected_annotation_ids);
+    return Normalize_annotation_selection(document_, selected_annotation_ids);
 }
 
 std::optional<Annotation> AnnotationController::Rebuild_obfuscate_annotation(
@@ -1017,6 +1022,10 @@ AnnotationController::Build_reactive_obfuscate_update_commands(
     AnnotationSelection const &selection_before,
     AnnotationSelection const &selection_after) {
     std::vector<std::unique_ptr<ICommand>> commands = {};
+    // Positions of the pre-edit annotations, built once on the first rebuild so a
+    // commit touching many obfuscates stays linear. First occurrence wins, as in
+    // Index_of_annotation_id.
+    std::unordered_map<uint64_t, size_t> before_position_by_id = {};
     for (size_t index = 0; index < after_annotations.size(); ++index) {
         if (!Is_obfuscate_annotation(after_annotations[index])) {
             continue;
@@ -1027,19 +1036,27 @@ AnnotationController::Build_reactive_obfuscate_update_commands(
         if (!rebuilt.has_value()) {
             continue;
         }
-        std::optional<size_t> const before_index =
-            Index_of_annotation_id(before_annotations, after_annotations[index].id);
-        if (!before_index.has_value()) {
+        if (before_position_by_id.empty() && !before_annotations.empty()) {
+            before_position_by_id.reserve(before_annotations.size());
+            for (size_t position = 0; position < before_annotations.size();
+                 ++position) {
+                before_position_by_id.try_emplace(before_annotations[position].id,
+                                                  position);
+            }
+        }
+        auto const before = before_position_by_id.find(after_annotations[index].id);
+        if (before == before_position_by_id.end()) {
             after_annotations[index] = *rebuilt;
             continue;
         }
-        if (before_annotations[*before_index] == *rebuilt) {
+        size_t const before_index = before->second;
+        if (before_annotations[before_index] == *rebuilt) {
             after_annotations[index] = *rebuilt;
             continue;
         }
 
         commands.push_back(std::make_unique<UpdateAnnotationCommand>(
-            this, index, before_annotations[*before_index], *rebuilt, selection_before,
+            this, index, before_annotations[before_index], *rebuilt, selection_before,
             selection_after, "Recompute obfuscate annotation"));
         after_annotations[index] = *rebuilt;
     }
@@ -1093,17 +1110,21 @@ void AnnotationController::Push_annotation_commands(
 void AnnotationController::Update_annotation_at(
     size_t index, Annotation annotation,
     std::span<const uint64_t> selected_annotation_ids) {
+    // Edit drags restate the selection they started with on every pointer move;
+    // the document already holds it normalized, so skip the rebuild.
+    bool const keeps_selection =
+        !active_tool_.has_value() && index < document_.annotations.size() &&
+        document_.annotations[index].id == annotation.id &&
+        std::ranges::equal(selected_annotation_ids, document_.selected_annotation_ids);
+    if (keeps_selection) {
+        Replace_document_annotation(document_, index, std::move(annotation));
+        return;
+    }
     AnnotationSelection selection = active_tool_.has_value()
                                         ? AnnotationSelection{}
                                         : Normalized_selection(selected_annotation_ids);
-    if (index >= document_.annotations.size()) {
-        document_.selected_annotation_ids = std::move(selection);
-        return;
-    }
-    document_.annotations[index] = std::move(annotation);
-    document_.selected_annotation_ids = std::move(selection);
-    document_.next_annotation_id =
-        std::max(document_.next_annotation_id, document_.annotations[index].id + 1);
+    Replace_document_annotation(document_, index, std::move(annotation));
+    Set_document_selection(document_, std::move(selection));
 }
 
 void AnnotationController::Update_annotation_at(
@@ -1124,17 +1145,8 @@ void AnnotationController::Insert_annotation_at(
         active_tool_.has_value() ? AnnotationSelection{}
                                  : AnnotationSelection(selected_annotation_ids.begin(),
                                                        selected_annotation_ids.end());
-    if (index > document_.annotations.size()) {
-        index = document_.annotations.size();
-    }
-    document_.annotations.insert(document_.annotations.begin() +
-                                     static_cast<std::ptrdiff_t>(index),
-                                 std::move(annotation));
-    document_.selected_annotation_ids = Normalized_selection(selection);
-    for (Annotation const &entry : document_.annotations) {
-        document_.next_annotation_id =
-            std::max(document_.next_annotation_id, entry.id + 1);
-    }
+    Insert_document_annotation(document_, index, std::move(annotation));
+    Set_document_selection(document_, Normalized_selection(selection));
 }
 
 void AnnotationController::Insert_annotation_at(
@@ -1154,13 +1166,8 @@ void AnnotationController::Erase_annotation_at(
         active_tool_.has_value() ? AnnotationSelection{}
                                  : AnnotationSelection(selected_annotation_ids.begin(),
                                                        selected_annotation_ids.end());
-    if (index >= document_.annotations.size()) {
-        document_.selected_annotation_ids = Normalized_selection(selection);
-        return;
-    }
-    document_.annotations.erase(document_.annotations.begin() +
-                                static_cast<std::ptrdiff_t>(index));
-    document_.selected_annotation_ids = Normalized_selection(selection);
+    Erase_document_annotation(document_, index);
+    Set_document_selection(document_, Normalized_selection(selection));
 }
 
 void AnnotationController::Erase_annotation_at(
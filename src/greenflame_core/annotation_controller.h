@@ -2,6 +2,7 @@
 
 #include "greenflame_core/annotation_edit_interaction.h"
 #include "greenflame_core/annotation_tool_registry.h"
+#include "greenflame_core/bubble_renderer.h"
 #include "greenflame_core/command.h"
 #include "greenflame_core/freehand_smoothing.h"
 #include "greenflame_core/obfuscate_raster.h"
@@ -82,6 +83,10 @@ class AnnotationController final : public IAnnotationToolHost,
     [[nodiscard]] std::span<const Annotation> Annotations() const noexcept {
         return document_.annotations;
     }
+    // Cached per-annotation summaries, parallel to Annotations(); empty while the
+    // document index is stale.
+    [[nodiscard]] std::span<const AnnotationSummary>
+    Annotation_summaries() const noexcept;
     [[nodiscard]] Annotation const *Draft_annotation() const noexcept;
     [[nodiscard]] std::span<const PointPx> Draft_freehand_points() const noexcept;
     [[nodiscard]] std::optional<StrokeStyle> Draft_freehand_style() const noexcept;
@@ -244,6 +249,8 @@ class AnnotationController final : public IAnnotationToolHost,
     int32_t obfuscate_block_size_ = kObfuscateDefaultBlockSize;
     std::unique_ptr<IAnnotationEditInteraction> active_edit_interaction_ = {};
     ITextLayoutEngine *text_layout_engine_ = nullptr;
+    // Draft bubbles are rebuilt on every cursor move.
+    mutable BubbleRenderer bubble_renderer_ = {};
     ISpellCheckService *spell_check_service_ = nullptr;
     IObfuscateSourceProvider *obfuscate_source_provider_ = nullptr;
     std::optional<TextEditController> text_edit_ctrl_ = std::nullopt;
@@ -0,0 +1,167 @@
+#include "greenflame_core/annotation_document.h"
+
+#include "greenflame_core/annotation_hit_test.h"
+
+namespace greenflame::core {
+
+namespace {
+
+void Set_selection_flags(AnnotationDocument &document,
+                         std::span<const uint64_t> selection, bool selected) {
+    AnnotationDocumentIndex &index = document.index;
+    for (uint64_t const id : selection) {
+        auto const it = index.position_by_id.find(id);
+        if (it != index.position_by_id.end()) {
+            index.selected_at[it->second] = selected;
+        }
+    }
+}
+
+// Rebuilds the id map and selection flags; summaries are left as they are.
+void Rebuild_positions(AnnotationDocument &document) {
+    AnnotationDocumentIndex &index = document.index;
+    index.position_by_id.clear();
+    index.position_by_id.reserve(document.annotations.size());
+    for (size_t position = 0; position < document.annotations.size(); ++position) {
+        index.position_by_id.try_emplace(document.annotations[position].id, position);
+    }
+    index.selected_at.assign(document.annotations.size(), false);
+    Set_selection_flags(document, document.selected_annotation_ids, true);
+}
+
+} // namespace
+
+void Rebuild_annotation_document_index(AnnotationDocument &document) {
+    std::vector<AnnotationSummary> &summaries = document.index.summaries;
+    summaries.clear();
+    summaries.reserve(document.annotations.size());
+    for (Annotation const &annotation : document.annotations) {
+        summaries.push_back(Summarize_annotation(annotation));
+    }
+    Rebuild_positions(document);
+}
+
+bool Annotation_document_index_is_current(AnnotationDocument const &document) noexcept {
+    size_t const size = document.annotations.size();
+    if (document.index.selected_at.size() != size ||
+        document.index.summaries.size() != size) {
+        return false;
+    }
+    for (size_t position = 0; position < size; ++position) {
+        if (document.index.summaries[position].id !=
+            document.annotations[position].id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Annotation_document_index_is_current_at(AnnotationDocument const &document,
+                                             size_t position) noexcept {
+    size_t const size = document.annotations.size();
+    return position < size && document.index.selected_at.size() == size &&
+           document.index.summaries.size() == size &&
+           document.index.summaries[position].id == document.annotations[position].id;
+}
+
+void Insert_document_annotation(AnnotationDocument &document, size_t index,
+                                Annotation annotation) {
+    size_t const size = document.annotations.size();
+    index = std::min(index, size);
+    document.next_annotation_id =
+        std::max(document.next_annotation_id, annotation.id + 1);
+    if (!Annotation_document_index_is_current(document)) {
+        document.annotations.insert(document.annotations.begin() +
+                                        static_cast<std::ptrdiff_t>(index),
+                                    std::move(annotation));
+        Rebuild_annotation_document_index(document);
+        return;
+    }
+
+    AnnotationDocumentIndex &lookup = document.index;
+    uint64_t const id = annotation.id;
+    lookup.summaries.insert(lookup.summaries.begin() +
+                                static_cast<std::ptrdiff_t>(index),
+                            Summarize_annotation(annotation));
+    document.annotations.insert(document.annotations.begin() +
+                                    static_cast<std::ptrdiff_t>(index),
+                                std::move(annotation));
+    if (index != size) {
+        Rebuild_positions(document);
+        return;
+    }
+    auto const [it, inserted] = lookup.position_by_id.try_emplace(id, index);
+    lookup.selected_at.push_back(
+        inserted && std::ranges::find(document.selected_annotation_ids, id) !=
+                        document.selected_annotation_ids.end());
+}
+
+void Erase_document_annotation(AnnotationDocument &document, size_t index) {
+    size_t const size = document.annotations.size();
+    if (index >= size) {
+        return;
+    }
+    bool const was_current = Annotation_document_index_is_current(document);
+    uint64_t const id = document.annotations[index].id;
+    document.annotations.erase(document.annotations.begin() +
+                               static_cast<std::ptrdiff_t>(index));
+    if (!was_current) {
+        Rebuild_annotation_document_index(document);
+        return;
+    }
+
+    AnnotationDocumentIndex &lookup = document.index;
+    lookup.summaries.erase(lookup.summaries.begin() +
+                           static_cast<std::ptrdiff_t>(index));
+    if (index + 1 != size) {
+        Rebuild_positions(document);
+        return;
+    }
+    // The last annotation has no later duplicate, so only its own entry moves.
+    lookup.selected_at.pop_back();
+    auto const it = lookup.position_by_id.find(id);
+    if (it != lookup.position_by_id.end() && it->second == index) {
+        lookup.position_by_id.erase(it);
+    }
+}
+
+void Replace_document_annotation(AnnotationDocument &document, size_t index,
+                                 Annotation annotation) {
+    if (index >= document.annotations.size()) {
+        return;
+    }
+    document.next_annotation_id =
+        std::max(document.next_annotation_id, annotation.id + 1);
+    bool const same_id = document.annotations[index].id == annotation.id;
+    document.annotations[index] = std::move(annotation);
+    if (!Annotation_document_index_is_current(document)) {
+        Rebuild_annotation_document_index(document);
+        return;
+    }
+    document.index.summaries[index] = Summarize_annotation(document.annotations[index]);
+    if (!same_id) {
+        Rebuild_positions(document);
+    }
+}
+
+void Clear_document_annotations(AnnotationDocument &document) noexcept {
+    document.annotations.clear();
+    document.selected_annotation_ids.clear();
+    document.index.position_by_id.clear();
+    document.index.selected_at.clear();
+    document.index.summaries.clear();
+}
+
+void Set_document_selection(AnnotationDocument &document,
+                            AnnotationSelection selection) {
+    if (!Annotation_document_index_is_current(document)) {
+        document.selected_annotation_ids = std::move(selection);
+        Rebuild_annotation_document_index(document);
+        return;
+    }
+    Set_selection_flags(document, document.selected_annotation_ids, false);
+    document.selected_annotation_ids = std::move(selection);
+    Set_selection_flags(document, document.selected_annotation_ids, true);
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "greenflame_core/annotation_types.h"
+
+namespace greenflame::core {
+
+// Mutators that keep AnnotationDocument::index in step with the annotation list
+// and the selection. Only the inserted or replaced annotation is summarized.
+// Appending and removing the last annotation update the id map in place; other
+// structural edits rebuild it, which costs the same O(n) as the vector shift
+// they already pay.
+
+// Recomputes the index from scratch. Call after assigning `annotations` or
+// `selected_annotation_ids` directly.
+void Rebuild_annotation_document_index(AnnotationDocument &document);
+// True when the index covers exactly the current annotation list: same size and
+// the same id at every position, so a reorder done behind the helpers' back is
+// caught. O(n); whole-document scans call it once up front.
+[[nodiscard]] bool
+Annotation_document_index_is_current(AnnotationDocument const &document) noexcept;
+// O(1) form for a single position: its summary and selection flag describe the
+// annotation stored there.
+[[nodiscard]] bool
+Annotation_document_index_is_current_at(AnnotationDocument const &document,
+                                        size_t position) noexcept;
+
+void Insert_document_annotation(AnnotationDocument &document, size_t index,
+                                Annotation annotation);
+void Erase_document_annotation(AnnotationDocument &document, size_t index);
+void Replace_document_annotation(AnnotationDocument &document, size_t index,
+                                 Annotation annotation);
+void Clear_document_annotations(AnnotationDocument &document) noexcept;
+// Stores `selection` as given; callers normalize it first.
+void Set_document_selection(AnnotationDocument &document,
+                            AnnotationSelection selection);
+
+} // namespace greenflame::core
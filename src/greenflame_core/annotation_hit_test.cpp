@@ -1,5 +1,6 @@
 #include "greenflame_core/annotation_hit_test.h"
 
+#include "greenflame_core/annotation_document.h"
 #include "greenflame_core/bubble_annotation_types.h"
 
 namespace greenflame::core {
@@ -623,6 +624,15 @@ RectPx Annotation_selection_frame_bounds(Annotation const &annotation) noexcept
     return bounds;
 }
 
+AnnotationSummary Summarize_annotation(Annotation const &annotation) noexcept {
+    return AnnotationSummary{
+        .id = annotation.id,
+        .hit_bounds = Annotation_bounds(annotation),
+        .visual_bounds = Annotation_visual_bounds(annotation),
+        .selection_frame_bounds = Annotation_selection_frame_bounds(annotation),
+    };
+}
+
 AnnotationSelection
 Normalize_annotation_selection(std::span<const Annotation> annotations,
                                std::span<const uint64_t> selection_ids) noexcept {
@@ -798,6 +808,115 @@ std::optional<size_t> Index_of_annotation_id(std::span<const Annotation> annotat
     return std::nullopt;
 }
 
+std::optional<size_t> Index_of_annotation_id(AnnotationDocument const &document,
+                                             uint64_t id) noexcept {
+    // The mapped position is only trusted when the annotation there still has the
+    // id; a miss or a stale position (an edit made without the index helpers)
+    // falls back to the scan.
+    auto const it = document.index.position_by_id.find(id);
+    if (it != document.index.position_by_id.end() &&
+        it->second < document.annotations.size() &&
+        document.annotations[it->second].id == id) {
+        return it->second;
+    }
+    return Index_of_annotation_id(document.annotations, id);
+}
+
+bool Selection_contains_annotation_id(AnnotationDocument const &document,
+                                      uint64_t annotation_id) noexcept {
+    std::optional<size_t> const index = Index_of_annotation_id(document, annotation_id);
+    if (!index.has_value()) {
+        return false;
+    }
+    if (!Annotation_document_index_is_current_at(document, *index)) {
+        return Selection_contains_annotation_id(document.selected_annotation_ids,
+                                                annotation_id);
+    }
+    return document.index.selected_at[*index];
+}
+
+AnnotationSelection
+Normalize_annotation_selection(AnnotationDocument const &document,
+                               std::span<const uint64_t> selection_ids) noexcept {
+    if (!Annotation_document_index_is_current(document)) {
+        return Normalize_annotation_selection(document.annotations, selection_ids);
+    }
+    std::vector<size_t> positions = {};
+    positions.reserve(selection_ids.size());
+    for (uint64_t const id : selection_ids) {
+        if (std::optional<size_t> const index = Index_of_annotation_id(document, id);
+            index.has_value()) {
+            positions.push_back(*index);
+        }
+    }
+    std::ranges::sort(positions);
+    auto const duplicates = std::ranges::unique(positions);
+    positions.erase(duplicates.begin(), duplicates.end());
+
+    AnnotationSelection normalized = {};
+    normalized.reserve(positions.size());
+    for (size_t const position : positions) {
+        normalized.push_back(document.annotations[position].id);
+    }
+    return normalized;
+}
+
+std::optional<RectPx>
+Annotation_selection_bounds(AnnotationDocument const &document) noexcept {
+    if (!Annotation_document_index_is_current(document)) {
+        return Annotation_selection_bounds(document.annotations,
+                                           document.selected_annotation_ids);
+    }
+    std::optional<RectPx> bounds = std::nullopt;
+    for (uint64_t const id : document.selected_annotation_ids) {
+        std::optional<size_t> const index = Index_of_annotation_id(document, id);
+        if (!index.has_value()) {
+            continue;
+        }
+        RectPx const frame_bounds =
+            document.index.summaries[*index].selection_frame_bounds;
+        bounds =
+            bounds.has_value() ? RectPx::Union(*bounds, frame_bounds) : frame_bounds;
+    }
+    return bounds;
+}
+
+std::optional<size_t> Index_of_topmost_annotation_at(AnnotationDocument const &document,
+                                                     PointPx point) noexcept {
+    if (!Annotation_document_index_is_current(document)) {
+        return Index_of_topmost_annotation_at(document.annotations, point);
+    }
+    std::span<const AnnotationSummary> const summaries = document.index.summaries;
+    for (size_t i = summaries.size(); i > 0; --i) {
+        if (summaries[i - 1].hit_bounds.Contains(point) &&
+            Annotation_hits_point(document.annotations[i - 1], point)) {
+            return i - 1;
+        }
+    }
+    return std::nullopt;
+}
+
+AnnotationSelection
+Annotation_ids_intersecting_selection_rect(AnnotationDocument const &document,
+                                           RectPx selection_rect) noexcept {
+    if (!Annotation_document_index_is_current(document)) {
+        return Annotation_ids_intersecting_selection_rect(document.annotations,
+                                                          selection_rect);
+    }
+    AnnotationSelection selection = {};
+    RectPx const normalized_rect = selection_rect.Normalized();
+    if (normalized_rect.Is_empty()) {
+        return selection;
+    }
+    for (AnnotationSummary const &summary : document.index.summaries) {
+        if (RectPx::Intersect(summary.selection_frame_bounds, normalized_rect)
+                .has_value()) {
+            selection.push_back(summary.id);
+        }
+    }
+    return selection;
+}
+
 std::optional<AnnotationLineEndpoint>
 Hit_test_line_endpoint_handles(PointPx start, PointPx end, PointPx cursor) noexcept {
     bool const hit_start = Endpoint_handle_bounds(start).Contains(cursor);
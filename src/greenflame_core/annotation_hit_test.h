@@ -8,6 +8,8 @@ namespace greenflame::core {
 [[nodiscard]] RectPx Annotation_visual_bounds(Annotation const &annotation) noexcept;
 [[nodiscard]] RectPx
 Annotation_selection_frame_bounds(Annotation const &annotation) noexcept;
+[[nodiscard]] AnnotationSummary
+Summarize_annotation(Annotation const &annotation) noexcept;
 [[nodiscard]] AnnotationSelection
 Normalize_annotation_selection(std::span<const Annotation> annotations,
                                std::span<const uint64_t> selection_ids) noexcept;
@@ -27,6 +29,27 @@ Index_of_topmost_annotation_at(std::span<const Annotation> annotations,
                                PointPx point) noexcept;
 [[nodiscard]] std::optional<size_t>
 Index_of_annotation_id(std::span<const Annotation> annotations, uint64_t id) noexcept;
+// Overloads backed by AnnotationDocument::index: O(1) id and membership lookups,
+// and selection work proportional to the selection rather than the document. A
+// stale index (see Annotation_document_index_is_current) falls back to the
+// payload scans above.
+[[nodiscard]] std::optional<size_t>
+Index_of_annotation_id(AnnotationDocument const &document, uint64_t id) noexcept;
+[[nodiscard]] bool Selection_contains_annotation_id(AnnotationDocument const &document,
+                                                    uint64_t annotation_id) noexcept;
+[[nodiscard]] AnnotationSelection
+Normalize_annotation_selection(AnnotationDocument const &document,
+                               std::span<const uint64_t> selection_ids) noexcept;
+[[nodiscard]] std::optional<RectPx>
+Annotation_selection_bounds(AnnotationDocument const &document) noexcept;
+// Sweep the cached summaries and only visit payloads whose hit bounds contain
+// the point.
+[[nodiscard]] std::optional<size_t>
+Index_of_topmost_annotation_at(AnnotationDocument const &document,
+                               PointPx point) noexcept;
+[[nodiscard]] AnnotationSelection
+Annotation_ids_intersecting_selection_rect(AnnotationDocument const &document,
+                                           RectPx selection_rect) noexcept;
 [[nodiscard]] std::optional<AnnotationLineEndpoint>
 Hit_test_line_endpoint_handles(PointPx start, PointPx end, PointPx cursor) noexcept;
 [[nodiscard]] RectPx Rectangle_outer_bounds_from_corners(PointPx a, PointPx b) noexcept;
@@ -0,0 +1,303 @@
+#include "greenflame_core/annotation_raster_scheduler.h"
+
+#include "greenflame_core/bubble_renderer.h"
+#include "greenflame_core/parallel_for.h"
+
+namespace greenflame::core {
+
+namespace {
+
+enum class RasterKeyKind : uint8_t {
+    Text = 1,
+    Bubble = 2,
+};
+
+class RasterKeyWriter final {
+  public:
+    explicit RasterKeyWriter(RasterKeyKind kind) {
+        key_.push_back(static_cast<char>(kind));
+    }
+
+    template <typename T> void Put(T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        char bytes[sizeof(T)] = {};
+        std::memcpy(bytes, &value, sizeof(T));
+        key_.append(bytes, sizeof(T));
+    }
+
+    void Put_string(std::wstring_view text) {
+        Put(static_cast<uint64_t>(text.size()));
+        for (wchar_t const ch : text) {
+            Put(ch);
+        }
+    }
+
+    void Put_families(std::span<const std::wstring> families) {
+        Put(static_cast<uint64_t>(families.size()));
+        for (std::wstring const &family : families) {
+            Put_string(family);
+        }
+    }
+
+    [[nodiscard]] std::string Take() noexcept { return std::move(key_); }
+
+  private:
+    std::string key_ = {};
+};
+
+[[nodiscard]] std::string Text_raster_key(TextAnnotation const &text,
+                                          std::span<const std::wstring> families) {
+    RasterKeyWriter writer(RasterKeyKind::Text);
+    writer.Put_families(families);
+    writer.Put(text.base_style.color);
+    writer.Put(text.base_style.font_choice);
+    writer.Put_string(text.base_style.font_family);
+    writer.Put(text.base_style.point_size);
+    // Engines without a layout pass rasterize the incoming bounds. Parsed CLI
+    // annotations have none yet.
+    bool const has_bounds = !text.visual_bounds.Is_empty();
+    writer.Put(has_bounds);
+    if (has_bounds) {
+        writer.Put(text.visual_bounds.left - text.origin.x);
+        writer.Put(text.visual_bounds.top - text.origin.y);
+        writer.Put(text.visual_bounds.right - text.origin.x);
+        writer.Put(text.visual_bounds.bottom - text.origin.y);
+    }
+    writer.Put(static_cast<uint64_t>(text.runs.size()));
+    for (TextRun const &run : text.runs) {
+        writer.Put_string(run.text);
+        writer.Put(run.flags);
+    }
+    return writer.Take();
+}
+
+[[nodiscard]] std::string Bubble_raster_key(BubbleAnnotation const &bubble,
+                                            std::span<const std::wstring> families) {
+    RasterKeyWriter writer(RasterKeyKind::Bubble);
+    writer.Put_families(families);
+    writer.Put(bubble.diameter_px);
+    writer.Put(bubble.color);
+    writer.Put(bubble.font_choice);
+    writer.Put_string(bubble.font_family);
+    writer.Put(bubble.counter_value);
+    return writer.Take();
+}
+
+[[nodiscard]] RectPx Translate_rect(RectPx rect, PointPx delta) noexcept {
+    return RectPx::From_ltrb(rect.left + delta.x, rect.top + delta.y,
+                             rect.right + delta.x, rect.bottom + delta.y);
+}
+
+[[nodiscard]] bool Raster_is_ready(int32_t width_px, int32_t height_px,
+                                   int32_t row_bytes,
+                                   std::vector<uint8_t> const &pixels) noexcept {
+    return width_px > 0 && height_px > 0 && row_bytes >= width_px * 4 &&
+           static_cast<size_t>(row_bytes) * static_cast<size_t>(height_px) ==
+               pixels.size();
+}
+
+struct RasterJob final {
+    std::string key = {};
+    // First annotation in the batch with this key; rasterized on a copy.
+    size_t first_index = 0;
+    Annotation prototype = {};
+    bool success = false;
+};
+
+void Run_job(ITextLayoutEngine *engine, BubbleRenderer &bubble_renderer,
+             RasterJob &job) {
+    if (engine == nullptr) {
+        return;
+    }
+    if (TextAnnotation *const text = std::get_if<TextAnnotation>(&job.prototype.data);
+        text != nullptr) {
+        job.success = engine->Prepare_for_cli(*text) &&
+                      Raster_is_ready(text->bitmap_width_px, text->bitmap_height_px,
+                                      text->bitmap_row_bytes, text->premultiplied_bgra);
+        return;
+    }
+    if (BubbleAnnotation *const bubble =
+            std::get_if<BubbleAnnotation>(&job.prototype.data);
+        bubble != nullptr) {
+        bubble_renderer.Rasterize(*bubble, *engine);
+        job.success =
+            Raster_is_ready(bubble->bitmap_width_px, bubble->bitmap_height_px,
+                            bubble->bitmap_row_bytes, bubble->premultiplied_bgra);
+    }
+}
+
+void Run_jobs(std::span<RasterJob> jobs, TextLayoutEngineFactory const &engine_factory,
+              size_t max_workers) {
+    size_t const workers = std::min(std::max<size_t>(max_workers, 1), jobs.size());
+    if (workers <= 1) {
+        std::unique_ptr<ITextLayoutEngine> const engine = engine_factory();
+        BubbleRenderer bubble_renderer;
+        for (RasterJob &job : jobs) {
+            Run_job(engine.get(), bubble_renderer, job);
+        }
+        return;
+    }
+
+    // One pool index per worker, so each engine stays on the thread that made it.
+    std::atomic<size_t> next_job = 0;
+    Parallel_for(workers, {.max_workers = workers}, [&](size_t) {
+        std::unique_ptr<ITextLayoutEngine> const engine = engine_factory();
+        BubbleRenderer bubble_renderer;
+        for (size_t index = next_job.fetch_add(1); index < jobs.size();
+             index = next_job.fetch_add(1)) {
+            Run_job(engine.get(), bubble_renderer, jobs[index]);
+        }
+    });
+}
+
+} // namespace
+
+AnnotationRasterScheduler::AnnotationRasterScheduler(size_t cache_capacity) noexcept
+    : capacity_(cache_capacity) {}
+
+AnnotationRasterBatchResult AnnotationRasterScheduler::Rasterize(
+    std::span<Annotation> annotations, std::span<const std::wstring> font_families,
+    TextLayoutEngineFactory const &engine_factory, size_t max_workers) {
+    AnnotationRasterBatchResult result{};
+
+    // Key per annotation (empty for kinds without a raster) and one job per
+    // distinct key the cache cannot serve. `keys` is never resized, so views of
+    // its strings stay valid.
+    std::vector<std::string> keys(annotations.size());
+    std::vector<RasterJob> jobs = {};
+    std::unordered_map<std::string_view, size_t> job_by_key = {};
+    for (size_t index = 0; index < annotations.size(); ++index) {
+        Annotation const &annotation = annotations[index];
+        if (TextAnnotation const *const text =
+                std::get_if<TextAnnotation>(&annotation.data);
+            text != nullptr) {
+            keys[index] = Text_raster_key(*text, font_families);
+        } else if (BubbleAnnotation const *const bubble =
+                       std::get_if<BubbleAnnotation>(&annotation.data);
+                   bubble != nullptr) {
+            keys[index] = Bubble_raster_key(*bubble, font_families);
+        } else {
+            continue;
+        }
+        if (lookup_.contains(keys[index]) || job_by_key.contains(keys[index])) {
+            continue;
+        }
+        job_by_key.emplace(keys[index], jobs.size());
+        jobs.push_back(RasterJob{keys[index], index, annotation, false});
+    }
+
+    if (!jobs.empty()) {
+        Run_jobs(jobs, engine_factory, max_workers);
+    }
+    result.rasterized = jobs.size();
+
+    // Failed jobs are not cached; their first annotation reports the failure.
+    std::vector<Raster> job_rasters(jobs.size());
+    for (size_t job = 0; job < jobs.size(); ++job) {
+        if (!jobs[job].success) {
+            continue;
+        }
+        Raster &raster = job_rasters[job];
+        if (TextAnnotation *const text =
+                std::get_if<TextAnnotation>(&jobs[job].prototype.data);
+            text != nullptr) {
+            raster.relative_bounds = Translate_rect(
+                text->visual_bounds, PointPx{-text->origin.x, -text->origin.y});
+            raster.width_px = text->bitmap_width_px;
+            raster.height_px = text->bitmap_height_px;
+            raster.row_bytes = text->bitmap_row_bytes;
+            raster.premultiplied_bgra = std::move(text->premultiplied_bgra);
+        } else {
+            BubbleAnnotation &bubble =
+                std::get<BubbleAnnotation>(jobs[job].prototype.data);
+            raster.width_px = bubble.bitmap_width_px;
+            raster.height_px = bubble.bitmap_height_px;
+            raster.row_bytes = bubble.bitmap_row_bytes;
+            raster.premultiplied_bgra = std::move(bubble.premultiplied_bgra);
+        }
+    }
+
+    result.success = true;
+    for (size_t index = 0; index < annotations.size() && result.success; ++index) {
+        if (keys[index].empty()) {
+            continue;
+        }
+        Raster const *raster = nullptr;
+        if (auto const job = job_by_key.find(keys[index]); job != job_by_key.end()) {
+            if (!jobs[job->second].success) {
+                result.success = false;
+                result.failed_index = index;
+                break;
+            }
+            raster = &job_rasters[job->second];
+            if (jobs[job->second].first_index != index) {
+                ++result.reused;
+            }
+        } else {
+            raster = Find(keys[index]);
+            ++result.reused;
+        }
+        if (raster == nullptr) {
+            result.success = false;
+            result.failed_index = index;
+            break;
+        }
+
+        Annotation &annotation = annotations[index];
+        if (TextAnnotation *const text = std::get_if<TextAnnotation>(&annotation.data);
+            text != nullptr) {
+            text->visual_bounds = Translate_rect(raster->relative_bounds, text->origin);
+            text->bitmap_width_px = raster->width_px;
+            text->bitmap_height_px = raster->height_px;
+            text->bitmap_row_bytes = raster->row_bytes;
+            text->premultiplied_bgra = raster->premultiplied_bgra;
+        } else {
+            BubbleAnnotation &bubble = std::get<BubbleAnnotation>(annotation.data);
+            bubble.bitmap_width_px = raster->width_px;
+            bubble.bitmap_height_px = raster->height_px;
+            bubble.bitmap_row_bytes = raster->row_bytes;
+            bubble.premultiplied_bgra = raster->premultiplied_bgra;
+        }
+    }
+
+    // Successful rasters are kept even when another request of the batch failed.
+    for (size_t job = 0; job < jobs.size(); ++job) {
+        if (jobs[job].success) {
+            Store(std::move(jobs[job].key), std::move(job_rasters[job]));
+        }
+    }
+    return result;
+}
+
+void AnnotationRasterScheduler::Clear() noexcept {
+    lookup_.clear();
+    entries_.clear();
+}
+
+size_t AnnotationRasterScheduler::Cached_entries() const noexcept {
+    return entries_.size();
+}
+
+AnnotationRasterScheduler::Raster const *
+AnnotationRasterScheduler::Find(std::string const &key) {
+    auto const it = lookup_.find(key);
+    if (it == lookup_.end()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->raster;
+}
+
+void AnnotationRasterScheduler::Store(std::string key, Raster raster) {
+    if (capacity_ == 0 || lookup_.contains(key)) {
+        return;
+    }
+    entries_.push_front(Entry{std::move(key), std::move(raster)});
+    lookup_.emplace(entries_.front().key, entries_.begin());
+    while (entries_.size() > capacity_) {
+        lookup_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "greenflame_core/annotation_types.h"
+#include "greenflame_core/text_layout_engine.h"
+
+namespace greenflame::core {
+
+inline constexpr size_t kDefaultAnnotationRasterCacheEntries = 256;
+
+// Creates one engine per worker. Called concurrently from worker threads, so it
+// must only touch thread-safe shared state.
+using TextLayoutEngineFactory = std::function<std::unique_ptr<ITextLayoutEngine>()>;
+
+struct AnnotationRasterBatchResult final {
+    bool success = false;
+    // Batch position of the first text or bubble annotation that failed.
+    size_t failed_index = 0;
+    // Distinct requests rasterized by this batch and requests served from the
+    // cache or from an identical request earlier in the batch.
+    size_t rasterized = 0;
+    size_t reused = 0;
+
+    constexpr bool operator==(AnnotationRasterBatchResult const &) const noexcept =
+        default;
+};
+
+// Rasterizes the text and bubble annotations of CLI batches. Identical requests
+// (text runs and base style; bubble diameter, color, font and counter) are
+// rasterized once: unique misses are spread over worker threads, each with its
+// own engine, and results are kept in an LRU cache that outlives the batch.
+// Rasters are position independent, so a hit is translated to the annotation's
+// own origin.
+class AnnotationRasterScheduler final {
+  public:
+    AnnotationRasterScheduler() = default;
+    explicit AnnotationRasterScheduler(size_t cache_capacity) noexcept;
+    // The lookup map holds views of the cached keys.
+    AnnotationRasterScheduler(AnnotationRasterScheduler const &) = delete;
+    AnnotationRasterScheduler &operator=(AnnotationRasterScheduler const &) = delete;
+    AnnotationRasterScheduler(AnnotationRasterScheduler &&) = delete;
+    AnnotationRasterScheduler &operator=(AnnotationRasterScheduler &&) = delete;
+
+    // `font_families` are the preset families the factory's engines resolve
+    // TextFontChoice with; they are part of every cache key. `max_workers` of 0
+    // or 1 rasterizes on the calling thread.
+    [[nodiscard]] AnnotationRasterBatchResult
+    Rasterize(std::span<Annotation> annotations,
+              std::span<const std::wstring> font_families,
+              TextLayoutEngineFactory const &engine_factory, size_t max_workers);
+
+    void Clear() noexcept;
+    [[nodiscard]] size_t Cached_entries() const noexcept;
+
+  private:
+    struct Raster final {
+        // Text visual bounds relative to the origin; unused for bubbles.
+        RectPx relative_bounds = {};
+        int32_t width_px = 0;
+        int32_t height_px = 0;
+        int32_t row_bytes = 0;
+        std::vector<uint8_t> premultiplied_bgra = {};
+    };
+    struct Entry final {
+        std::string key = {};
+        Raster raster = {};
+    };
+
+    [[nodiscard]] Raster const *Find(std::string const &key);
+    void Store(std::string key, Raster raster);
+
+    size_t capacity_ = kDefaultAnnotationRasterCacheEntries;
+    // Most recently used first.
+    std::list<Entry> entries_ = {};
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> lookup_ = {};
+};
+
+} // namespace greenflame::core
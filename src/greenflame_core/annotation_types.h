@@ -112,12 +112,38 @@ struct Annotation final {
     constexpr bool operator==(Annotation const &) const noexcept = default;
 };
 
+// Hot per-annotation metadata, cached so bounds and hit scans sweep one dense
+// array instead of striding over payload variants (points, runs, bitmaps).
+struct AnnotationSummary final {
+    uint64_t id = 0;
+    RectPx hit_bounds = {};
+    RectPx visual_bounds = {};
+    RectPx selection_frame_bounds = {};
+
+    constexpr bool operator==(AnnotationSummary const &) const noexcept = default;
+};
+
+// Lookup state derived from an AnnotationDocument: the position of each
+// annotation id (first occurrence wins), a per-position selection flag and a
+// per-position summary. Maintained by the helpers in annotation_document.h.
+struct AnnotationDocumentIndex final {
+    std::unordered_map<uint64_t, size_t> position_by_id = {};
+    std::vector<bool> selected_at = {};
+    std::vector<AnnotationSummary> summaries = {};
+};
+
 struct AnnotationDocument final {
     std::vector<Annotation> annotations = {};
     AnnotationSelection selected_annotation_ids = {};
     uint64_t next_annotation_id = 1;
-
-    constexpr bool operator==(AnnotationDocument const &) const noexcept = default;
+    AnnotationDocumentIndex index = {};
+
+    // The index is derived state and does not take part in equality.
+    [[nodiscard]] bool operator==(AnnotationDocument const &other) const noexcept {
+        return annotations == other.annotations &&
+               selected_annotation_ids == other.selected_annotation_ids &&
+               next_annotation_id == other.next_annotation_id;
+    }
 };
 
 } // namespace greenflame::core
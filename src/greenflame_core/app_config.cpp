@@ -54,6 +54,9 @@ void AppConfig::Normalize() {
     if (last_save_as_dir.size() > kMaxConfigPathChars) {
         last_save_as_dir.resize(kMaxConfigPathChars);
     }
+    if (overlay_input_trace_dir.size() > kMaxConfigPathChars) {
+        overlay_input_trace_dir.resize(kMaxConfigPathChars);
+    }
 
     auto clamp_pattern = [](std::wstring &value) {
         if (value.size() > 256) {
@@ -65,6 +68,8 @@ void AppConfig::Normalize() {
     clamp_pattern(filename_pattern_monitor);
     clamp_pattern(filename_pattern_window);
     padding_color = static_cast<COLORREF>(padding_color & kColorrefMask);
+    capture_history_budget_mb =
+        std::clamp(capture_history_budget_mb, 0, kMaxCaptureHistoryBudgetMb);
     brush_size = std::clamp(brush_size, kMinToolSize, kMaxToolSize);
     line_size = std::clamp(line_size, kMinToolSize, kMaxToolSize);
     arrow_size = std::clamp(arrow_size, kMinToolSize, kMaxToolSize);
@@ -17,6 +17,8 @@ struct AppConfig final {
     static constexpr int32_t kDefaultObfuscateBlockSize = 10;
     static constexpr int32_t kDefaultTextSize = 10;
     static constexpr int32_t kDefaultToolSizeOverlayDurationMs = 800;
+    static constexpr int32_t kDefaultCaptureHistoryBudgetMb = 64;
+    static constexpr int32_t kMaxCaptureHistoryBudgetMb = 1024;
     static constexpr int32_t kDefaultHighlighterPauseStraightenMs = 800;
     static constexpr FreehandSmoothingMode kDefaultBrushSmoothingMode =
         FreehandSmoothingMode::Smooth;
@@ -32,6 +34,7 @@ struct AppConfig final {
     std::wstring default_save_format = {}; // "png" (default), "jpg"/"jpeg", or "bmp".
     COLORREF padding_color = Make_colorref(0x00, 0x00, 0x00);
     bool include_cursor = false;
+    int32_t capture_history_budget_mb = kDefaultCaptureHistoryBudgetMb; // 0 = off
     int32_t brush_size = kDefaultBrushSize;
     FreehandSmoothingMode brush_smoothing_mode = kDefaultBrushSmoothingMode;
     int32_t line_size = kDefaultLineSize;
@@ -63,6 +66,8 @@ struct AppConfig final {
     bool show_balloons = true;
     bool show_selection_size_side_labels = true;
     bool show_selection_size_center_label = true;
+    // Folder for recorded overlay sessions (.gfit); empty = not recording.
+    std::wstring overlay_input_trace_dir = {};
 
     void Normalize();
 };
@@ -29,9 +29,10 @@ constexpr int32_t kMaxAnnotationColorIndex =
 constexpr int32_t kMaxHighlighterColorIndex =
     static_cast<int32_t>(kHighlighterColorSlotCount) - 1;
 
-constexpr std::array<std::string_view, 5> kRootKeys = {
-    {"$schema", "capture", "ui", "tools", "save"}};
-constexpr std::array<std::string_view, 1> kCaptureKeys = {{"include_cursor"}};
+constexpr std::array<std::string_view, 6> kRootKeys = {
+    {"$schema", "capture", "ui", "tools", "save", "diagnostics"}};
+constexpr std::array<std::string_view, 2> kCaptureKeys = {
+    {"include_cursor", "history_budget_mb"}};
 constexpr std::array<std::string_view, 4> kUiKeys = {
     {"show_balloons", "show_selection_size_side_labels",
      "show_selection_size_center_label", "tool_size_overlay_duration_ms"}};
@@ -55,6 +56,8 @@ constexpr std::array<std::string_view, 8> kSaveKeys = {
      "filename_pattern_window"}};
 constexpr std::array<std::string_view, 2> kObfuscateKeys = {
     {"block_size", "risk_acknowledged"}};
+constexpr std::array<std::string_view, 1> kDiagnosticsKeys = {
+    {"overlay_input_trace_dir"}};
 
 [[nodiscard]] bool Contains_key(std::span<const std::string_view> allowed_keys,
                                 std::string_view key) noexcept {
@@ -840,6 +843,9 @@ void Apply_capture_object(Json const &object, ParseContext &ctx) {
     Report_unknown_keys(object, kCaptureKeys, k_path, ctx);
     Apply_bool_property(object, "include_cursor", k_path,
                         ctx.result.config.include_cursor, ctx);
+    Apply_integer_property(object, "history_budget_mb", k_path, 0,
+                           AppConfig::kMaxCaptureHistoryBudgetMb,
+                           ctx.result.config.capture_history_budget_mb, ctx);
 }
 
 void Apply_ui_object(Json const &object, ParseContext &ctx) {
@@ -1105,6 +1111,21 @@ void Apply_save_object(Json const &object, ParseContext &ctx) {
     Apply_padding_color_property(object, ctx);
 }
 
+void Apply_diagnostics_object(Json const &object, ParseContext &ctx) {
+    constexpr std::wstring_view k_path = L"diagnostics";
+
+    if (object.JSON_type() != JsonClass::Object) {
+        ctx.Report_schema_error(k_path, L"Must be an object.");
+        return;
+    }
+
+    Report_unknown_keys(object, kDiagnosticsKeys, k_path, ctx);
+    Apply_non_empty_string_property(object, "overlay_input_trace_dir", k_path,
+                                    kMaxConfigPathChars,
+                                    ctx.result.config.overlay_input_trace_dir, false,
+                                    ctx);
+}
+
 } // namespace
 
 AppConfigParseResult
@@ -1139,6 +1160,9 @@ Parse_app_config_json_with_diagnostics(std::string_view json_text) noexcept {
     if (root.has_key("save")) {
         Apply_save_object(root["save"], ctx);
     }
+    if (root.has_key("diagnostics")) {
+        Apply_diagnostics_object(root["diagnostics"], ctx);
+    }
 
     return ctx.result;
 }
@@ -1156,9 +1180,15 @@ std::string Serialize_app_config_json(AppConfig const &config) {
     AppConfig const defaults{};
     easyjson::JSON root = easyjson::object();
 
-    if (config.include_cursor != defaults.include_cursor) {
+    if (config.include_cursor != defaults.include_cursor ||
+        config.capture_history_budget_mb != defaults.capture_history_budget_mb) {
         root["capture"] = easyjson::object();
-        root["capture"]["include_cursor"] = config.include_cursor;
+        if (config.include_cursor != defaults.include_cursor) {
+            root["capture"]["include_cursor"] = config.include_cursor;
+        }
+        if (config.capture_history_budget_mb != defaults.capture_history_budget_mb) {
+            root["capture"]["history_budget_mb"] = config.capture_history_budget_mb;
+        }
     }
 
     if (!config.show_balloons || !config.show_selection_size_side_labels ||
@@ -1401,6 +1431,12 @@ std::string Serialize_app_config_json(AppConfig const &config) {
         }
     }
 
+    if (!config.overlay_input_trace_dir.empty()) {
+        root["diagnostics"] = easyjson::object();
+        root["diagnostics"]["overlay_input_trace_dir"] =
+            To_utf8(config.overlay_input_trace_dir);
+    }
+
     return root.dump();
 }
 
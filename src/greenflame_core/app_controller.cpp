@@ -1,5 +1,6 @@
 #include "greenflame_core/app_controller.h"
 
+#include "greenflame_core/annotation_hit_test.h"
 #include "greenflame_core/app_config.h"
 #include "greenflame_core/cli_annotation_import.h"
 #include "greenflame_core/obfuscate_risk_warning.h"
@@ -13,6 +14,9 @@ namespace {
 constexpr wchar_t kClipboardCopiedBalloonMessage[] = L"Selection copied to clipboard.";
 constexpr wchar_t kNoLastRegionMessage[] = L"No previously captured region.";
 constexpr wchar_t kNoLastWindowMessage[] = L"No previously captured window.";
+constexpr wchar_t kNoLastCaptureMessage[] = L"No previous capture in history.";
+constexpr wchar_t kSaveLastCaptureFailedMessage[] =
+    L"Failed to save the last capture.";
 constexpr wchar_t kLastWindowClosedMessage[] =
     L"Previously captured window is no longer available.";
 constexpr wchar_t kLastWindowMinimizedMessage[] =
@@ -125,19 +129,14 @@ struct CliPreparedAnnotationsLoadResult final {
     bool ok = false;
 };
 
-[[nodiscard]] CliPreparedAnnotationsLoadResult Load_prepared_annotations(
-    greenflame::core::CliOptions const &cli_options,
+[[nodiscard]] CliPreparedAnnotationsLoadResult Prepare_json_annotations(
+    std::wstring_view annotate_value,
     greenflame::core::CliAnnotationParseContext const &parse_context,
     greenflame::core::AppConfig const &config,
     greenflame::IAnnotationPreparationService &annotation_preparation_service,
     greenflame::IFileSystemService &file_system_service) {
     CliPreparedAnnotationsLoadResult result{};
     result.ok = true;
-    if (!cli_options.annotate_value.has_value()) {
-        return result;
-    }
-
-    std::wstring_view const annotate_value = Trim_wspace(*cli_options.annotate_value);
     std::string annotation_json = {};
     if (greenflame::core::Classify_cli_annotation_input(annotate_value) ==
         greenflame::core::CliAnnotationInputKind::InlineJson) {
@@ -204,6 +203,113 @@ struct CliPreparedAnnotationsLoadResult final {
     return result;
 }
 
+void Append_file_error(std::wstring &message, std::wstring_view path,
+                       std::wstring_view error) {
+    message += path;
+    message += L"\"";
+    if (!error.empty()) {
+        message += L": ";
+        message += error;
+    }
+}
+
+// Documents hold annotations relative to the capture's top-left corner, so one
+// prepared document applies to any later capture of the same layout.
+[[nodiscard]] CliPreparedAnnotationsLoadResult
+Read_annotation_document(std::wstring_view annotate_value,
+                         greenflame::core::PointPx capture_origin,
+                         greenflame::IFileSystemService &file_system_service) {
+    CliPreparedAnnotationsLoadResult result{};
+    std::wstring const document_path =
+        file_system_service.Resolve_absolute_path(annotate_value);
+    greenflame::core::AnnotationDocument document = {};
+    std::wstring read_error = {};
+    if (!file_system_service.Try_read_annotation_document(document_path, document,
+                                                          read_error)) {
+        result.exit_code = greenflame::ProcessExitCode::CliAnnotationInputInvalid;
+        result.error_message = L"--annotate: unable to read annotation document \"";
+        Append_file_error(result.error_message, document_path, read_error);
+        return result;
+    }
+    result.annotations.reserve(document.annotations.size());
+    for (greenflame::core::Annotation const &annotation : document.annotations) {
+        greenflame::core::Annotation placed =
+            greenflame::core::Translate_annotation(annotation, capture_origin);
+        // Obfuscation is always recomputed from the pixels it now covers.
+        if (auto *const obfuscate =
+                std::get_if<greenflame::core::ObfuscateAnnotation>(&placed.data)) {
+            obfuscate->bitmap_width_px = 0;
+            obfuscate->bitmap_height_px = 0;
+            obfuscate->bitmap_row_bytes = 0;
+            obfuscate->premultiplied_bgra.clear();
+        }
+        result.annotations.push_back(std::move(placed));
+    }
+    result.ok = true;
+    return result;
+}
+
+[[nodiscard]] bool
+Write_annotation_document(std::wstring_view save_path,
+                          greenflame::core::PointPx capture_origin,
+                          std::vector<greenflame::core::Annotation> const &annotations,
+                          greenflame::IFileSystemService &file_system_service,
+                          std::wstring &error_message) {
+    greenflame::core::AnnotationDocument document = {};
+    document.annotations.reserve(annotations.size());
+    greenflame::core::PointPx const to_local{-capture_origin.x, -capture_origin.y};
+    for (greenflame::core::Annotation const &annotation : annotations) {
+        document.annotations.push_back(
+            greenflame::core::Translate_annotation(annotation, to_local));
+        document.next_annotation_id =
+            std::max(document.next_annotation_id, annotation.id + 1);
+    }
+    std::wstring const document_path =
+        file_system_service.Resolve_absolute_path(save_path);
+    std::wstring write_error = {};
+    if (file_system_service.Try_write_annotation_document(document_path, document,
+                                                          write_error)) {
+        return true;
+    }
+    error_message = L"Error: Unable to write annotation document \"";
+    Append_file_error(error_message, document_path, write_error);
+    return false;
+}
+
+[[nodiscard]] CliPreparedAnnotationsLoadResult Load_prepared_annotations(
+    greenflame::core::CliOptions const &cli_options,
+    greenflame::core::CliAnnotationParseContext const &parse_context,
+    greenflame::core::AppConfig const &config,
+    greenflame::IAnnotationPreparationService &annotation_preparation_service,
+    greenflame::IFileSystemService &file_system_service) {
+    if (!cli_options.annotate_value.has_value()) {
+        CliPreparedAnnotationsLoadResult result{};
+        result.ok = true;
+        return result;
+    }
+
+    std::wstring_view const annotate_value = Trim_wspace(*cli_options.annotate_value);
+    greenflame::core::PointPx const capture_origin =
+        parse_context.capture_rect_screen.Top_left();
+    CliPreparedAnnotationsLoadResult result =
+        greenflame::core::Classify_cli_annotation_input(annotate_value) ==
+                greenflame::core::CliAnnotationInputKind::DocumentPath
+            ? Read_annotation_document(annotate_value, capture_origin,
+                                       file_system_service)
+            : Prepare_json_annotations(annotate_value, parse_context, config,
+                                       annotation_preparation_service,
+                                       file_system_service);
+    if (result.ok && !cli_options.save_annotations_path.empty() &&
+        !Write_annotation_document(cli_options.save_annotations_path, capture_origin,
+                                   result.annotations, file_system_service,
+                                   result.error_message)) {
+        result.ok = false;
+        result.exit_code = greenflame::ProcessExitCode::CliOutputPathFailure;
+        result.annotations.clear();
+    }
+    return result;
+}
+
 [[nodiscard]] greenflame::CliResult Make_cli_error(greenflame::ProcessExitCode code,
                                                    std::wstring_view message) {
     greenflame::CliResult result{};
@@ -322,6 +428,17 @@ Format_skipped_minimized_window_warning(size_t minimized_match_count) {
     return message;
 }
 
+[[nodiscard]] std::wstring
+Build_output_write_failure(greenflame::core::OutputSinkKind sink,
+                           std::wstring_view output_path) {
+    if (sink == greenflame::core::OutputSinkKind::Stdout) {
+        return L"Error: Failed to encode or write image to standard output.";
+    }
+    std::wstring message = L"Error: Failed to encode or write image file: ";
+    message += output_path;
+    return message;
+}
+
 } // namespace
 
 namespace greenflame {
@@ -331,12 +448,14 @@ AppController::AppController(
     IWindowInspector &window_inspector, ICaptureService &capture_service,
     IInputImageService &input_image_service,
     IAnnotationPreparationService &annotation_preparation_service,
-    IFileSystemService &file_system_service)
+    IFileSystemService &file_system_service,
+    core::SaveDirectoryIndex &save_directory_index)
     : config_(config), display_queries_(display_queries),
       window_inspector_(window_inspector), capture_service_(capture_service),
       input_image_service_(input_image_service),
       annotation_preparation_service_(annotation_preparation_service),
-      file_system_service_(file_system_service) {}
+      file_system_service_(file_system_service),
+      save_directory_index_(save_directory_index) {}
 
 ClipboardCopyResult
 AppController::On_copy_window_to_clipboard_requested(HWND target_window) {
@@ -406,13 +525,56 @@ ClipboardCopyResult AppController::On_copy_last_region_to_clipboard_requested()
     if (!last_capture_screen_rect_.has_value()) {
         return ClipboardCopyResult{kNoLastRegionMessage, false};
     }
+    // The history still holds the region exactly as it was captured; grab the
+    // screen again only once it has been evicted.
+    if (last_capture_history_id_.has_value() &&
+        capture_service_.Copy_history_capture_to_clipboard(*last_capture_history_id_)) {
+        return ClipboardCopyResult{kClipboardCopiedBalloonMessage, true};
+    }
     if (capture_service_.Copy_rect_to_clipboard(*last_capture_screen_rect_,
                                                 config_.include_cursor)) {
+        // The recapture is now the newest copy of the last region.
+        last_capture_history_id_ = capture_service_.Take_recorded_capture_id();
         return ClipboardCopyResult{kClipboardCopiedBalloonMessage, true};
     }
     return ClipboardCopyResult{kNoLastRegionMessage, false};
 }
 
+ClipboardCopyResult AppController::On_copy_last_capture_to_clipboard_requested() {
+    if (last_capture_history_id_.has_value() &&
+        capture_service_.Copy_history_capture_to_clipboard(*last_capture_history_id_)) {
+        return ClipboardCopyResult{kClipboardCopiedBalloonMessage, true};
+    }
+    return ClipboardCopyResult{kNoLastCaptureMessage, false};
+}
+
+SelectionSavedResult AppController::On_save_last_capture_requested() {
+    if (!last_capture_history_id_.has_value()) {
+        return SelectionSavedResult{kNoLastCaptureMessage, {}};
+    }
+    save_directory_index_.Clear();
+    core::ImageSaveFormat const format = core::Image_save_format_from_config(config_);
+    std::wstring const path = file_system_service_.Reserve_unique_file_path(
+        Build_default_output_path(core::SaveSelectionSource::Region, std::nullopt, {},
+                                  format));
+    if (path.empty()) {
+        return SelectionSavedResult{kSaveLastCaptureFailedMessage, {}};
+    }
+    save_directory_index_.Add_saved_path(path);
+    core::CaptureSaveResult const result =
+        capture_service_.Save_history_capture_to_file(*last_capture_history_id_, path,
+                                                      format);
+    if (result.status != core::CaptureSaveStatus::Success) {
+        file_system_service_.Delete_file_if_exists(path);
+        return SelectionSavedResult{result.error_message.empty()
+                                        ? std::wstring(kNoLastCaptureMessage)
+                                        : result.error_message,
+                                    {}};
+    }
+    return SelectionSavedResult{
+        core::Build_saved_selection_balloon_message(path, false), path};
+}
+
 ClipboardCopyResult AppController::On_copy_last_window_to_clipboard_requested() {
     if (!last_capture_window_.has_value()) {
         return ClipboardCopyResult{kNoLastWindowMessage, false};
@@ -506,9 +668,15 @@ core::OverlayHelpContent AppController::Build_overlay_help_content() const {
 }
 
 CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_options) {
+    // Each request re-lists the save directory once, so it sees files written or
+    // deleted since the last overlay session or request.
+    save_directory_index_.Clear();
     if (!cli_options.input_path.empty()) {
         return Run_cli_input_mode(cli_options);
     }
+    if (!cli_options.additional_regions.empty()) {
+        return Run_cli_multi_region_mode(cli_options);
+    }
 
     core::RectPx target_rect = {};
     core::SaveSelectionSource source = core::SaveSelectionSource::Region;
@@ -690,6 +858,7 @@ CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_option
 
     auto try_resolve_and_reserve_output =
         [&](std::wstring &output_path, core::ImageSaveFormat &output_format,
+            core::OutputSinkKind &output_sink,
             bool &delete_output_path_on_failure) -> std::optional<CliResult> {
         core::ImageSaveFormat const default_format =
             cli_options.output_format.has_value()
@@ -712,14 +881,18 @@ CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_option
             }
             output_path = resolved.path;
             output_format = resolved.format;
+            output_sink = resolved.sink;
         } else {
             output_path = Build_default_output_path(source, monitor_index_zero_based,
                                                     window_title, default_format);
         }
 
+        delete_output_path_on_failure = false;
+        if (output_sink != core::OutputSinkKind::File) {
+            return std::nullopt;
+        }
         output_path = file_system_service_.Resolve_absolute_path(output_path);
 
-        delete_output_path_on_failure = false;
         if (!has_explicit_output_path) {
             std::wstring const reserved =
                 file_system_service_.Reserve_unique_file_path(output_path);
@@ -729,6 +902,7 @@ CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_option
             }
             output_path = reserved;
             delete_output_path_on_failure = true;
+            save_directory_index_.Add_saved_path(output_path);
         } else if (!cli_options.overwrite_output) {
             bool already_exists = false;
             if (!file_system_service_.Try_reserve_exact_file_path(output_path,
@@ -846,9 +1020,11 @@ CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_option
 
     std::wstring output_path = {};
     core::ImageSaveFormat output_format = core::ImageSaveFormat::Png;
+    core::OutputSinkKind output_sink = core::OutputSinkKind::File;
     bool delete_output_path_on_failure = false;
-    if (std::optional<CliResult> const output_error = try_resolve_and_reserve_output(
-            output_path, output_format, delete_output_path_on_failure);
+    if (std::optional<CliResult> const output_error =
+            try_resolve_and_reserve_output(output_path, output_format, output_sink,
+                                           delete_output_path_on_failure);
         output_error.has_value()) {
         return *output_error;
     }
@@ -866,6 +1042,7 @@ CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_option
         save_request.include_cursor = include_cursor;
         save_request.preserve_source_extent = has_padding;
         save_request.annotations = prepared_annotations;
+        save_request.output_sink = output_sink;
         return save_request;
     };
 
@@ -875,9 +1052,7 @@ CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_option
             Append_line(stderr_text, save_result.error_message);
             return;
         }
-        std::wstring error_message = L"Error: Failed to encode or write image file: ";
-        error_message += output_path;
-        Append_line(stderr_text, error_message);
+        Append_line(stderr_text, Build_output_write_failure(output_sink, output_path));
     };
 
     auto finish_with_save_result =
@@ -984,8 +1159,13 @@ CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_option
         }
     }
 
-    Update_default_save_dir_from_path(config_, output_path);
     Store_last_capture(target_rect, captured_window);
+    // Standard output carries the image itself, so nothing else is printed there.
+    if (output_sink != core::OutputSinkKind::File) {
+        config_.Normalize();
+        return CliResult{{}, stderr_text, ProcessExitCode::Success};
+    }
+    Update_default_save_dir_from_path(config_, output_path);
     config_.Normalize();
 
     std::wstring stdout_text = L"Saved: ";
@@ -993,6 +1173,181 @@ CliResult AppController::Run_cli_capture_mode(core::CliOptions const &cli_option
     return CliResult{stdout_text, stderr_text, ProcessExitCode::Success};
 }
 
+CliResult
+AppController::Run_cli_multi_region_mode(core::CliOptions const &cli_options) {
+    if (!cli_options.region_px.has_value()) {
+        return Make_cli_error(ProcessExitCode::CliRegionMissing,
+                              L"Error: --region is required.");
+    }
+    std::vector<core::CliRegionOutput> pairs = {};
+    pairs.reserve(cli_options.additional_regions.size() + 1);
+    pairs.push_back({*cli_options.region_px, cli_options.output_path});
+    pairs.insert(pairs.end(), cli_options.additional_regions.begin(),
+                 cli_options.additional_regions.end());
+
+    bool const has_padding = cli_options.padding_px.has_value();
+    core::InsetsPx const padding_px = cli_options.padding_px.value_or(core::InsetsPx{});
+    COLORREF const padding_color = Resolve_padding_color(config_, cli_options);
+    bool const include_cursor = Resolve_include_cursor(config_, cli_options);
+    core::ImageSaveFormat const default_format =
+        cli_options.output_format.has_value()
+            ? core::Image_save_format_from_cli_format(*cli_options.output_format)
+            : core::Image_save_format_from_config(config_);
+    core::RectPx const virtual_bounds =
+        display_queries_.Get_virtual_desktop_bounds_px();
+
+    // Every pair is checked before any output path is reserved.
+    std::vector<core::CaptureSaveJob> jobs = {};
+    jobs.reserve(pairs.size());
+    bool any_partially_out_of_bounds = false;
+    for (core::CliRegionOutput const &pair : pairs) {
+        int32_t padded_output_width = 0;
+        int32_t padded_output_height = 0;
+        if (has_padding &&
+            !Try_compute_padded_output_size(pair.region_px, padding_px,
+                                            padded_output_width,
+                                            padded_output_height)) {
+            return Make_cli_error(
+                ProcessExitCode::CliCaptureSaveFailed,
+                L"Error: Requested padded output dimensions are invalid or too large.");
+        }
+        std::optional<core::RectPx> const clipped =
+            core::RectPx::Clip(pair.region_px, virtual_bounds);
+        if (!clipped.has_value()) {
+            return Make_cli_error(ProcessExitCode::CliCaptureSaveFailed,
+                                  L"Error: Requested capture area is outside the "
+                                  L"virtual desktop.");
+        }
+        any_partially_out_of_bounds =
+            any_partially_out_of_bounds || *clipped != pair.region_px;
+
+        core::CliAnnotationParseContext const parse_context{
+            .capture_rect_screen = pair.region_px,
+            .virtual_desktop_bounds = virtual_bounds,
+            .config = &config_,
+            .target_kind = core::CliAnnotationTargetKind::Capture,
+        };
+        CliPreparedAnnotationsLoadResult prepared_annotations_result =
+            Load_prepared_annotations(cli_options, parse_context, config_,
+                                      annotation_preparation_service_,
+                                      file_system_service_);
+        if (!prepared_annotations_result.ok) {
+            return Make_cli_error(prepared_annotations_result.exit_code,
+                                  prepared_annotations_result.error_message);
+        }
+        if (Has_obfuscate_annotation(prepared_annotations_result.annotations) &&
+            !config_.obfuscate_risk_acknowledged) {
+            return Make_cli_error(
+                ProcessExitCode::CliObfuscateRiskUnacknowledged,
+                Build_cli_obfuscate_risk_unacknowledged_message(file_system_service_));
+        }
+
+        core::ResolveExplicitPathResult const resolved =
+            core::Resolve_explicit_output_path(pair.output_path, default_format,
+                                               cli_options.output_format);
+        if (!resolved.ok || resolved.path.empty()) {
+            if (!resolved.error_message.empty()) {
+                return Make_cli_error(ProcessExitCode::CliOutputPathFailure,
+                                      resolved.error_message);
+            }
+            return Make_cli_error(ProcessExitCode::CliOutputPathFailure,
+                                  L"Error: Unable to resolve output path.");
+        }
+        core::CaptureSaveJob job{};
+        job.path = file_system_service_.Resolve_absolute_path(resolved.path);
+        job.format = resolved.format;
+        if (std::ranges::any_of(jobs, [&](core::CaptureSaveJob const &other) {
+                return core::Equals_no_case(other.path, job.path);
+            })) {
+            std::wstring message = L"Error: Each --region needs its own --output "
+                                   L"path: ";
+            message += job.path;
+            return Make_cli_error(ProcessExitCode::CliOutputPathFailure, message);
+        }
+        job.request.source_kind = core::CaptureSourceKind::ScreenRect;
+        job.request.window_capture_backend = core::WindowCaptureBackend::Gdi;
+        job.request.source_rect_screen = pair.region_px;
+        job.request.padding_px = padding_px;
+        job.request.fill_color = padding_color;
+        job.request.include_cursor = include_cursor;
+        job.request.preserve_source_extent = has_padding;
+        job.request.annotations = std::move(prepared_annotations_result.annotations);
+        jobs.push_back(std::move(job));
+    }
+
+    std::vector<bool> reserved(jobs.size(), false);
+    auto const release_reserved = [&]() {
+        for (size_t index = 0; index < jobs.size(); ++index) {
+            if (reserved[index]) {
+                file_system_service_.Delete_file_if_exists(jobs[index].path);
+            }
+        }
+    };
+    if (!cli_options.overwrite_output) {
+        for (size_t index = 0; index < jobs.size(); ++index) {
+            bool already_exists = false;
+            if (file_system_service_.Try_reserve_exact_file_path(jobs[index].path,
+                                                                 already_exists)) {
+                reserved[index] = true;
+                continue;
+            }
+            release_reserved();
+            if (already_exists) {
+                std::wstring message = L"Error: Output file already exists: ";
+                message += jobs[index].path;
+                message += L". Use --overwrite (or -f) to replace it.";
+                return Make_cli_error(ProcessExitCode::CliOutputPathFailure, message);
+            }
+            return Make_cli_error(ProcessExitCode::CliOutputPathFailure,
+                                  L"Error: Unable to reserve the output path.");
+        }
+    }
+
+    std::wstring stderr_text = {};
+    if (has_padding && any_partially_out_of_bounds) {
+        Append_line(stderr_text,
+                    L"Warning: Requested capture area extends outside the virtual "
+                    L"desktop. Uncovered areas were filled with the padding color.");
+    }
+
+    std::vector<core::CaptureSaveResult> const results =
+        capture_service_.Save_captures_from_one_grab(jobs);
+    std::wstring stdout_text = {};
+    std::optional<size_t> first_saved = std::nullopt;
+    bool all_saved = true;
+    for (size_t index = 0; index < jobs.size(); ++index) {
+        if (index < results.size() &&
+            results[index].status == core::CaptureSaveStatus::Success) {
+            std::wstring line = L"Saved: ";
+            line += jobs[index].path;
+            Append_line(stdout_text, line);
+            first_saved = first_saved.value_or(index);
+            continue;
+        }
+        all_saved = false;
+        if (reserved[index]) {
+            file_system_service_.Delete_file_if_exists(jobs[index].path);
+        }
+        if (index < results.size() && !results[index].error_message.empty()) {
+            Append_line(stderr_text, results[index].error_message);
+        } else {
+            Append_line(stderr_text, Build_output_write_failure(
+                                         core::OutputSinkKind::File, jobs[index].path));
+        }
+    }
+
+    if (!first_saved.has_value()) {
+        return CliResult{{}, stderr_text, ProcessExitCode::CliCaptureSaveFailed};
+    }
+    Store_last_capture(pairs.front().region_px, std::nullopt);
+    Update_default_save_dir_from_path(config_, jobs[*first_saved].path);
+    config_.Normalize();
+    // Crops that did save are kept and reported even when others failed.
+    return CliResult{stdout_text, stderr_text,
+                     all_saved ? ProcessExitCode::Success
+                               : ProcessExitCode::CliCaptureSaveFailed};
+}
+
 CliResult AppController::Run_cli_input_mode(core::CliOptions const &cli_options) {
     bool const has_padding = cli_options.padding_px.has_value();
     core::InsetsPx const padding_px = cli_options.padding_px.value_or(core::InsetsPx{});
@@ -1050,6 +1405,7 @@ CliResult AppController::Run_cli_input_mode(core::CliOptions const &cli_options)
 
     std::wstring output_path = {};
     core::ImageSaveFormat output_format = probe_result.format;
+    core::OutputSinkKind output_sink = core::OutputSinkKind::File;
     bool delete_output_path_on_failure = false;
     if (cli_options.output_path.empty()) {
         output_path = input_path;
@@ -1080,10 +1436,14 @@ CliResult AppController::Run_cli_input_mode(core::CliOptions const &cli_options)
                                   L"Error: Unable to resolve output path.");
         }
 
-        output_path = file_system_service_.Resolve_absolute_path(resolved.path);
         output_format = resolved.format;
+        output_sink = resolved.sink;
+        output_path = output_sink == core::OutputSinkKind::File
+                          ? file_system_service_.Resolve_absolute_path(resolved.path)
+                          : resolved.path;
 
-        if (!cli_options.overwrite_output) {
+        if (output_sink == core::OutputSinkKind::File &&
+            !cli_options.overwrite_output) {
             bool already_exists = false;
             if (!file_system_service_.Try_reserve_exact_file_path(output_path,
                                                                   already_exists)) {
@@ -1105,6 +1465,7 @@ CliResult AppController::Run_cli_input_mode(core::CliOptions const &cli_options)
         .padding_px = padding_px,
         .fill_color = padding_color,
         .annotations = prepared_annotations_result.annotations,
+        .output_sink = output_sink,
     };
     core::InputImageSaveResult const save_result =
         input_image_service_.Save_input_image_to_file(save_request, input_path,
@@ -1119,8 +1480,7 @@ CliResult AppController::Run_cli_input_mode(core::CliOptions const &cli_options)
             if (save_result.status == core::InputImageSaveStatus::SourceReadFailed) {
                 stderr_text = L"Error: Failed to read input image file.";
             } else {
-                stderr_text = L"Error: Failed to encode or write image file: ";
-                stderr_text += output_path;
+                stderr_text = Build_output_write_failure(output_sink, output_path);
             }
         }
         ProcessExitCode const exit_code =
@@ -1130,6 +1490,9 @@ CliResult AppController::Run_cli_input_mode(core::CliOptions const &cli_options)
         return CliResult{{}, stderr_text, exit_code};
     }
 
+    if (output_sink != core::OutputSinkKind::File) {
+        return CliResult{{}, {}, ProcessExitCode::Success};
+    }
     std::wstring stdout_text = L"Saved: ";
     stdout_text += output_path;
     return CliResult{stdout_text, {}, ProcessExitCode::Success};
@@ -1137,7 +1500,7 @@ CliResult AppController::Run_cli_input_mode(core::CliOptions const &cli_options)
 
 std::wstring AppController::Build_default_output_path(
     core::SaveSelectionSource source, std::optional<size_t> monitor_index_zero_based,
-    std::wstring_view window_title, core::ImageSaveFormat format) const {
+    std::wstring_view window_title, core::ImageSaveFormat format) {
     std::wstring const save_dir =
         file_system_service_.Resolve_save_directory(config_.default_save_dir);
 
@@ -1151,10 +1514,12 @@ std::wstring AppController::Build_default_output_path(
         configured_pattern.empty() ? core::Default_filename_pattern(source)
                                    : configured_pattern;
     if (core::Pattern_uses_num(effective_pattern)) {
-        std::vector<std::wstring> const files =
-            file_system_service_.List_directory_filenames(save_dir);
+        if (!save_directory_index_.Is_loaded_for(save_dir)) {
+            save_directory_index_.Load(
+                save_dir, file_system_service_.List_directory_filenames(save_dir));
+        }
         context.incrementing_number =
-            core::Find_next_num_for_pattern(effective_pattern, context, files);
+            save_directory_index_.Next_num(effective_pattern, context);
     }
 
     std::wstring const base_name =
@@ -1171,6 +1536,7 @@ std::wstring AppController::Build_default_output_path(
 void AppController::Store_last_capture(core::RectPx screen_rect,
                                        std::optional<HWND> window) {
     last_capture_screen_rect_ = screen_rect.Normalized();
+    last_capture_history_id_ = capture_service_.Take_recorded_capture_id();
     if (window.has_value()) {
         last_capture_window_ = *window;
     }
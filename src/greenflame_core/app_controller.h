@@ -33,7 +33,8 @@ class AppController final {
                   IWindowInspector &window_inspector, ICaptureService &capture_service,
                   IInputImageService &input_image_service,
                   IAnnotationPreparationService &annotation_preparation_service,
-                  IFileSystemService &file_system_service);
+                  IFileSystemService &file_system_service,
+                  core::SaveDirectoryIndex &save_directory_index);
     AppController(AppController const &) = delete;
     AppController &operator=(AppController const &) = delete;
     AppController(AppController &&) = delete;
@@ -45,7 +46,15 @@ class AppController final {
     [[nodiscard]] ClipboardCopyResult On_copy_monitor_to_clipboard_requested();
     [[nodiscard]] ClipboardCopyResult On_copy_desktop_to_clipboard_requested();
     [[nodiscard]] ClipboardCopyResult On_copy_last_region_to_clipboard_requested();
+    [[nodiscard]] ClipboardCopyResult On_copy_last_capture_to_clipboard_requested();
     [[nodiscard]] ClipboardCopyResult On_copy_last_window_to_clipboard_requested();
+    // Saves the last capture from the history into the default save directory.
+    // `file_path` is empty when nothing was saved.
+    [[nodiscard]] SelectionSavedResult On_save_last_capture_requested();
+    // The history entry of the last capture, for callers that re-pin it.
+    [[nodiscard]] std::optional<uint64_t> Last_capture_history_id() const noexcept {
+        return last_capture_history_id_;
+    }
     [[nodiscard]] ClipboardCopyResult
     On_selection_copied_to_clipboard(core::RectPx screen_rect,
                                      std::optional<HWND> window);
@@ -57,11 +66,13 @@ class AppController final {
 
   private:
     [[nodiscard]] CliResult Run_cli_input_mode(core::CliOptions const &cli_options);
+    [[nodiscard]] CliResult
+    Run_cli_multi_region_mode(core::CliOptions const &cli_options);
     [[nodiscard]] std::wstring
     Build_default_output_path(core::SaveSelectionSource source,
                               std::optional<size_t> monitor_index_zero_based,
                               std::wstring_view window_title,
-                              core::ImageSaveFormat format) const;
+                              core::ImageSaveFormat format);
     void Store_last_capture(core::RectPx screen_rect, std::optional<HWND> window);
 
     core::AppConfig &config_;
@@ -74,6 +85,8 @@ class AppController final {
 
     std::optional<core::RectPx> last_capture_screen_rect_ = std::nullopt;
     std::optional<HWND> last_capture_window_ = std::nullopt;
+    std::optional<uint64_t> last_capture_history_id_ = std::nullopt;
+    core::SaveDirectoryIndex &save_directory_index_;
 };
 
 } // namespace greenflame
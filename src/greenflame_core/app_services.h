@@ -25,10 +25,20 @@ struct CaptureSaveRequest final {
     bool include_cursor = false;
     bool preserve_source_extent = false;
     std::vector<Annotation> annotations = {};
+    OutputSinkKind output_sink = OutputSinkKind::File;
 
     constexpr bool operator==(const CaptureSaveRequest &) const noexcept = default;
 };
 
+// One output of a multi-region save: its own crop, padding and annotations.
+struct CaptureSaveJob final {
+    CaptureSaveRequest request = {};
+    std::wstring path = {};
+    ImageSaveFormat format = ImageSaveFormat::Png;
+
+    bool operator==(const CaptureSaveJob &) const noexcept = default;
+};
+
 enum class CaptureSaveStatus : uint8_t {
     Success = 0,
     BackendFailed = 1,
@@ -38,6 +48,8 @@ enum class CaptureSaveStatus : uint8_t {
 struct CaptureSaveResult final {
     CaptureSaveStatus status = CaptureSaveStatus::SaveFailed;
     std::wstring error_message = {};
+    // The encoded image, for OutputSinkKind::Memory requests only.
+    std::vector<uint8_t> encoded_bytes = {};
 
     bool operator==(const CaptureSaveResult &) const noexcept = default;
 };
@@ -88,6 +100,7 @@ struct InputImageSaveRequest final {
     InsetsPx padding_px = {};
     COLORREF fill_color = static_cast<COLORREF>(0);
     std::vector<Annotation> annotations = {};
+    OutputSinkKind output_sink = OutputSinkKind::File;
 
     constexpr bool operator==(const InputImageSaveRequest &) const noexcept = default;
 };
@@ -95,6 +108,8 @@ struct InputImageSaveRequest final {
 struct InputImageSaveResult final {
     InputImageSaveStatus status = InputImageSaveStatus::SaveFailed;
     std::wstring error_message = {};
+    // The encoded image, for OutputSinkKind::Memory requests only.
+    std::vector<uint8_t> encoded_bytes = {};
 
     bool operator==(const InputImageSaveResult &) const noexcept = default;
 };
@@ -142,9 +157,27 @@ class ICaptureService {
     virtual ~ICaptureService() = default;
     [[nodiscard]] virtual bool Copy_rect_to_clipboard(core::RectPx screen_rect,
                                                       bool include_cursor) = 0;
+    // Encodes straight into `request.output_sink`; `path` is only used by file
+    // sinks.
     [[nodiscard]] virtual core::CaptureSaveResult
     Save_capture_to_file(core::CaptureSaveRequest const &request,
                          std::wstring_view path, core::ImageSaveFormat format) = 0;
+    // Grabs the desktop once and saves every screen-rect job from that frame,
+    // encoding in parallel. Results are in job order; one failing job does not
+    // stop the others.
+    [[nodiscard]] virtual std::vector<core::CaptureSaveResult>
+    Save_captures_from_one_grab(std::span<const core::CaptureSaveJob> jobs) = 0;
+    // The capture history entry recorded since the last call, by a clipboard copy
+    // or an overlay copy or save. Nullopt when nothing was recorded.
+    [[nodiscard]] virtual std::optional<uint64_t> Take_recorded_capture_id() = 0;
+    // Copies a capture history entry as it was captured, without a new screen grab.
+    // False once the entry has been evicted.
+    [[nodiscard]] virtual bool Copy_history_capture_to_clipboard(uint64_t id) = 0;
+    // Saves a capture history entry as it was captured. SaveFailed with no message
+    // once the entry has been evicted.
+    [[nodiscard]] virtual core::CaptureSaveResult
+    Save_history_capture_to_file(uint64_t id, std::wstring_view path,
+                                 core::ImageSaveFormat format) = 0;
 };
 
 class IAnnotationPreparationService {
@@ -159,6 +192,9 @@ class IInputImageService {
     virtual ~IInputImageService() = default;
     [[nodiscard]] virtual core::InputImageProbeResult
     Probe_input_image(std::wstring_view path) = 0;
+    // As ICaptureService::Save_capture_to_file, `output_path` is only used by file
+    // sinks. A save of the path just probed reuses what the probe opened and
+    // decoded instead of reading the file again.
     [[nodiscard]] virtual core::InputImageSaveResult Save_input_image_to_file(
         core::InputImageSaveRequest const &request, std::wstring_view input_path,
         std::wstring_view output_path, core::ImageSaveFormat format) = 0;
@@ -181,6 +217,16 @@ class IFileSystemService {
     [[nodiscard]] virtual bool
     Try_read_text_file_utf8(std::wstring_view path, std::string &utf8_text,
                             std::wstring &error_message) const = 0;
+    // Binary annotation documents (annotation_binary.h). Reads decode straight
+    // from a mapped view of the file; writes replace `path` only once complete.
+    [[nodiscard]] virtual bool
+    Try_read_annotation_document(std::wstring_view path,
+                                 core::AnnotationDocument &document,
+                                 std::wstring &error_message) const = 0;
+    [[nodiscard]] virtual bool
+    Try_write_annotation_document(std::wstring_view path,
+                                  core::AnnotationDocument const &document,
+                                  std::wstring &error_message) const = 0;
     virtual void Delete_file_if_exists(std::wstring_view path) const = 0;
     [[nodiscard]] virtual core::SaveTimestamp Get_current_timestamp() const = 0;
 };
@@ -17,6 +17,9 @@ constexpr float kLumB = 0.0722f;
 constexpr float kLumBlackThreshold = 0.179f;
 constexpr float kColorChannelMaxF = 255.0f;
 constexpr COLORREF kByteMask = static_cast<COLORREF>(0xFF);
+constexpr float kCounterFontFraction = 0.55f;
+constexpr float kLongCounterFontFraction = 0.38f;
+constexpr int32_t kLongCounterMin = 100;
 
 [[nodiscard]] float Srgb_to_linear(float c) noexcept {
     return (c <= kSrgbLinearThreshold) ? c / kSrgbLinearDivisor
@@ -45,4 +48,11 @@ COLORREF Bubble_text_color(COLORREF bg) noexcept {
                                       : Make_colorref(255, 255, 255);
 }
 
+float Bubble_counter_font_size(int32_t diameter_px, int32_t counter_value) noexcept {
+    float const fraction = (counter_value >= kLongCounterMin)
+                               ? kLongCounterFontFraction
+                               : kCounterFontFraction;
+    return fraction * static_cast<float>(diameter_px);
+}
+
 } // namespace greenflame::core
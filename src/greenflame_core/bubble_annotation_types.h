@@ -8,6 +8,11 @@ namespace greenflame::core {
 // WCAG 2.x relative-luminance threshold: L > 0.179 → use black text, else white.
 [[nodiscard]] COLORREF Bubble_text_color(COLORREF bg) noexcept;
 
+// Bold counter font size in DIPs: a larger fraction of the diameter for one or
+// two digits than for three or more.
+[[nodiscard]] float Bubble_counter_font_size(int32_t diameter_px,
+                                             int32_t counter_value) noexcept;
+
 struct BubbleAnnotation final {
     PointPx center = {};
     int32_t diameter_px = 0;
@@ -0,0 +1,235 @@
+#include "greenflame_core/bubble_renderer.h"
+
+namespace greenflame::core {
+
+namespace {
+
+// Supersampling grid per pixel edge for the disc coverage.
+constexpr int32_t kDiscSamplesPerAxis = 4;
+constexpr float kDiscSampleCount =
+    static_cast<float>(kDiscSamplesPerAxis * kDiscSamplesPerAxis);
+// Matches the platform renderer: fill inset by half a pixel, then a 1px ring
+// centered 1.5px inside the outer edge.
+constexpr float kDiscFillInsetPx = 0.5f;
+constexpr float kDiscRingInsetPx = 1.5f;
+constexpr float kDiscRingHalfWidthPx = 0.5f;
+constexpr float kChannelMax = 255.0f;
+
+struct ColorChannels final {
+    float blue = 0.0f;
+    float green = 0.0f;
+    float red = 0.0f;
+};
+
+[[nodiscard]] ColorChannels To_channels(COLORREF color) noexcept {
+    return {static_cast<float>((color >> 16u) & 0xFFu),
+            static_cast<float>((color >> 8u) & 0xFFu),
+            static_cast<float>(color & 0xFFu)};
+}
+
+[[nodiscard]] uint8_t To_byte(float value) noexcept {
+    return static_cast<uint8_t>(std::clamp(std::lround(value), 0L, 255L));
+}
+
+[[nodiscard]] std::vector<uint8_t> Draw_disc(int32_t diameter_px, COLORREF color) {
+    size_t const side = static_cast<size_t>(diameter_px);
+    std::vector<uint8_t> pixels(side * side * 4u, 0);
+    float const radius = static_cast<float>(diameter_px) / 2.0f;
+    float const fill_radius = radius - kDiscFillInsetPx;
+    float const ring_radius = radius - kDiscRingInsetPx;
+    ColorChannels const fill = To_channels(color);
+    ColorChannels const ring = To_channels(Bubble_text_color(color));
+
+    for (int32_t y = 0; y < diameter_px; ++y) {
+        for (int32_t x = 0; x < diameter_px; ++x) {
+            int32_t fill_samples = 0;
+            int32_t ring_samples = 0;
+            for (int32_t sy = 0; sy < kDiscSamplesPerAxis; ++sy) {
+                float const dy = static_cast<float>(y) +
+                                 (static_cast<float>(sy) + 0.5f) /
+                                     static_cast<float>(kDiscSamplesPerAxis) -
+                                 radius;
+                for (int32_t sx = 0; sx < kDiscSamplesPerAxis; ++sx) {
+                    float const dx = static_cast<float>(x) +
+                                     (static_cast<float>(sx) + 0.5f) /
+                                         static_cast<float>(kDiscSamplesPerAxis) -
+                                     radius;
+                    float const distance = std::sqrt(dx * dx + dy * dy);
+                    if (fill_radius > 0.0f && distance <= fill_radius) {
+                        ++fill_samples;
+                    }
+                    if (ring_radius > 0.0f &&
+                        std::abs(distance - ring_radius) <= kDiscRingHalfWidthPx) {
+                        ++ring_samples;
+                    }
+                }
+            }
+            if (fill_samples == 0 && ring_samples == 0) {
+                continue;
+            }
+            // Ring over fill, source-over.
+            float const ring_coverage =
+                static_cast<float>(ring_samples) / kDiscSampleCount;
+            float const fill_coverage = static_cast<float>(fill_samples) /
+                                        kDiscSampleCount * (1.0f - ring_coverage);
+            size_t const at =
+                (static_cast<size_t>(y) * side + static_cast<size_t>(x)) * 4u;
+            pixels[at] = To_byte(ring.blue * ring_coverage + fill.blue * fill_coverage);
+            pixels[at + 1] =
+                To_byte(ring.green * ring_coverage + fill.green * fill_coverage);
+            pixels[at + 2] =
+                To_byte(ring.red * ring_coverage + fill.red * fill_coverage);
+            pixels[at + 3] = To_byte(kChannelMax * (ring_coverage + fill_coverage));
+        }
+    }
+    return pixels;
+}
+
+// Source-over of an opaque `color` through `glyph`'s coverage at (left, top).
+void Blend_glyph(std::span<uint8_t> pixels, int32_t side, BubbleDigitGlyph const &glyph,
+                 int32_t left, int32_t top, COLORREF color) noexcept {
+    std::array<uint32_t, 4> const source = {(color >> 16u) & 0xFFu,
+                                            (color >> 8u) & 0xFFu, color & 0xFFu, 255u};
+    for (int32_t row = 0; row < glyph.height_px; ++row) {
+        int32_t const y = top + row;
+        if (y < 0 || y >= side) {
+            continue;
+        }
+        size_t const mask_row =
+            static_cast<size_t>(row) * static_cast<size_t>(glyph.width_px);
+        size_t const pixel_row = static_cast<size_t>(y) * static_cast<size_t>(side);
+        for (int32_t column = 0; column < glyph.width_px; ++column) {
+            int32_t const x = left + column;
+            if (x < 0 || x >= side) {
+                continue;
+            }
+            uint32_t const coverage =
+                glyph.coverage[mask_row + static_cast<size_t>(column)];
+            if (coverage == 0) {
+                continue;
+            }
+            uint32_t const inverse = 255u - coverage;
+            size_t const at = (pixel_row + static_cast<size_t>(x)) * 4u;
+            for (size_t channel = 0; channel < 4; ++channel) {
+                pixels[at + channel] = static_cast<uint8_t>(
+                    (source[channel] * coverage + pixels[at + channel] * inverse +
+                     127u) /
+                    255u);
+            }
+        }
+    }
+}
+
+[[nodiscard]] bool Atlas_is_usable(BubbleDigitAtlas const &atlas) noexcept {
+    if (!(atlas.line_height_px > 0.0f)) {
+        return false;
+    }
+    return std::ranges::all_of(atlas.digits, [](BubbleDigitGlyph const &glyph) {
+        return glyph.width_px >= 0 && glyph.height_px >= 0 &&
+               glyph.coverage.size() == static_cast<size_t>(glyph.width_px) *
+                                            static_cast<size_t>(glyph.height_px);
+    });
+}
+
+} // namespace
+
+BubbleRenderer::BubbleRenderer(size_t max_cached_entries) noexcept
+    : max_cached_entries_(std::max<size_t>(max_cached_entries, 1)) {}
+
+void BubbleRenderer::Rasterize(BubbleAnnotation &bubble, ITextLayoutEngine &engine) {
+    bubble.bitmap_width_px = 0;
+    bubble.bitmap_height_px = 0;
+    bubble.bitmap_row_bytes = 0;
+    bubble.premultiplied_bgra.clear();
+
+    int32_t const side = bubble.diameter_px;
+    if (side <= 0) {
+        return;
+    }
+    BubbleDigitAtlas const *const atlas =
+        bubble.counter_value >= 0 ? Atlas(bubble, engine) : nullptr;
+    if (atlas == nullptr) {
+        engine.Rasterize_bubble(bubble);
+        return;
+    }
+
+    std::vector<uint8_t> pixels = Disc(side, bubble.color);
+    std::string const digits = std::to_string(bubble.counter_value);
+    float text_width = 0.0f;
+    for (char const digit : digits) {
+        text_width += atlas->digits[static_cast<size_t>(digit - '0')].advance_px;
+    }
+    // Centered on both axes, like the platform renderer's centered paragraph.
+    float pen_x = (static_cast<float>(side) - text_width) / 2.0f;
+    int32_t const top = static_cast<int32_t>(
+        std::lround((static_cast<float>(side) - atlas->line_height_px) / 2.0f));
+    COLORREF const text_color = Bubble_text_color(bubble.color);
+    for (char const digit : digits) {
+        BubbleDigitGlyph const &glyph = atlas->digits[static_cast<size_t>(digit - '0')];
+        int32_t const left =
+            static_cast<int32_t>(std::lround(pen_x)) + glyph.offset_x_px;
+        Blend_glyph(pixels, side, glyph, left, top, text_color);
+        pen_x += glyph.advance_px;
+    }
+
+    bubble.bitmap_width_px = side;
+    bubble.bitmap_height_px = side;
+    bubble.bitmap_row_bytes = side * 4;
+    bubble.premultiplied_bgra = std::move(pixels);
+}
+
+void BubbleRenderer::Clear() noexcept {
+    discs_.clear();
+    atlases_.clear();
+}
+
+size_t BubbleRenderer::Cached_discs() const noexcept { return discs_.size(); }
+
+size_t BubbleRenderer::Cached_atlases() const noexcept { return atlases_.size(); }
+
+std::vector<uint8_t> BubbleRenderer::Disc(int32_t diameter_px, COLORREF color) {
+    uint64_t const key =
+        (static_cast<uint64_t>(static_cast<uint32_t>(diameter_px)) << 32u) | color;
+    if (auto const it = discs_.find(key); it != discs_.end()) {
+        return it->second;
+    }
+    if (discs_.size() >= max_cached_entries_) {
+        discs_.clear();
+    }
+    return discs_.emplace(key, Draw_disc(diameter_px, color)).first->second;
+}
+
+BubbleDigitAtlas const *BubbleRenderer::Atlas(BubbleAnnotation const &bubble,
+                                              ITextLayoutEngine &engine) {
+    // Preset choices resolve to whatever families the engine holds now.
+    if (uint64_t const generation = engine.Font_generation();
+        generation != atlas_font_generation_) {
+        atlases_.clear();
+        atlas_font_generation_ = generation;
+    }
+    float const font_size_dip =
+        Bubble_counter_font_size(bubble.diameter_px, bubble.counter_value);
+    auto const it = std::ranges::find_if(atlases_, [&](AtlasEntry const &entry) {
+        return entry.font_choice == bubble.font_choice &&
+               entry.font_size_dip == font_size_dip &&
+               entry.font_family == bubble.font_family;
+    });
+    if (it != atlases_.end()) {
+        return it->atlas ? &*it->atlas : nullptr;
+    }
+
+    if (atlases_.size() >= max_cached_entries_) {
+        atlases_.clear();
+    }
+    AtlasEntry &entry = atlases_.emplace_back(AtlasEntry{
+        bubble.font_choice, bubble.font_family, font_size_dip, std::nullopt});
+    BubbleDigitAtlas atlas{};
+    if (engine.Rasterize_bubble_digits(bubble.font_choice, bubble.font_family,
+                                       font_size_dip, atlas) &&
+        Atlas_is_usable(atlas)) {
+        entry.atlas = std::move(atlas);
+    }
+    return entry.atlas ? &*entry.atlas : nullptr;
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "greenflame_core/bubble_annotation_types.h"
+#include "greenflame_core/text_layout_engine.h"
+
+namespace greenflame::core {
+
+inline constexpr size_t kDefaultBubbleRendererCacheEntries = 64;
+
+// Builds bubble rasters without a text engine round trip per bubble: the disc
+// (fill plus inner ring) is drawn once per diameter and color, and counters are
+// composed from a digit atlas fetched once per font and size. Digits are kept
+// as coverage and tinted at composition time, so one atlas serves every color.
+// Atlases are dropped when the engine's Font_generation changes.
+// Engines without Rasterize_bubble_digits, and counters that are not plain
+// non-negative numbers, fall back to ITextLayoutEngine::Rasterize_bubble.
+// Not thread-safe; use one renderer per thread.
+class BubbleRenderer final {
+  public:
+    BubbleRenderer() = default;
+    // Each of the disc and atlas caches is emptied when it reaches this size.
+    explicit BubbleRenderer(size_t max_cached_entries) noexcept;
+
+    void Rasterize(BubbleAnnotation &bubble, ITextLayoutEngine &engine);
+
+    void Clear() noexcept;
+    [[nodiscard]] size_t Cached_discs() const noexcept;
+    [[nodiscard]] size_t Cached_atlases() const noexcept;
+
+  private:
+    struct AtlasEntry final {
+        TextFontChoice font_choice = TextFontChoice::Sans;
+        std::wstring font_family = {};
+        float font_size_dip = 0.0f;
+        // Nullopt when the engine failed, so the lookup is not retried.
+        std::optional<BubbleDigitAtlas> atlas = std::nullopt;
+    };
+
+    [[nodiscard]] std::vector<uint8_t> Disc(int32_t diameter_px, COLORREF color);
+    // Null when the engine cannot rasterize digits for this font and size.
+    [[nodiscard]] BubbleDigitAtlas const *Atlas(BubbleAnnotation const &bubble,
+                                                ITextLayoutEngine &engine);
+
+    size_t max_cached_entries_ = kDefaultBubbleRendererCacheEntries;
+    // Keyed by diameter in the high half and color in the low half.
+    std::unordered_map<uint64_t, std::vector<uint8_t>> discs_ = {};
+    // Few fonts and sizes are live at once, so a linear scan is enough.
+    std::vector<AtlasEntry> atlases_ = {};
+    uint64_t atlas_font_generation_ = 0;
+};
+
+} // namespace greenflame::core
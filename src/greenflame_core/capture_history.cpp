@@ -0,0 +1,448 @@
+#include "greenflame_core/capture_history.h"
+
+#include "greenflame_core/annotation_binary.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr uint8_t kOpaqueAlpha = 255;
+constexpr size_t kBytesPerPixel = 4;
+
+[[nodiscard]] bool Source_is_valid(ExportSourcePixels const &source) noexcept {
+    if (source.width <= 0 || source.height <= 0) {
+        return false;
+    }
+    size_t const used_row_bytes = static_cast<size_t>(source.width) * kBytesPerPixel;
+    if (source.row_bytes < used_row_bytes) {
+        return false;
+    }
+    size_t const rows_before_last = static_cast<size_t>(source.height - 1);
+    if (rows_before_last > 0 &&
+        rows_before_last > (std::numeric_limits<size_t>::max() - used_row_bytes) /
+                               source.row_bytes) {
+        return false;
+    }
+    return source.pixels.size() >= rows_before_last * source.row_bytes + used_row_bytes;
+}
+
+[[nodiscard]] int32_t Tile_count(int32_t extent) noexcept {
+    return (extent + kCaptureHistoryTileSize - 1) / kCaptureHistoryTileSize;
+}
+
+// Box-filtered down to kCaptureHistoryThumbnailMaxEdge on the longer edge.
+[[nodiscard]] CaptureThumbnail Build_thumbnail(ExportSourcePixels const &source) {
+    int32_t const longest = std::max(source.width, source.height);
+    CaptureThumbnail thumbnail{};
+    if (longest <= kCaptureHistoryThumbnailMaxEdge) {
+        thumbnail.width = source.width;
+        thumbnail.height = source.height;
+    } else {
+        int64_t const edge = kCaptureHistoryThumbnailMaxEdge;
+        thumbnail.width =
+            std::max(1, static_cast<int32_t>(int64_t{source.width} * edge / longest));
+        thumbnail.height =
+            std::max(1, static_cast<int32_t>(int64_t{source.height} * edge / longest));
+    }
+    thumbnail.pixels.resize(static_cast<size_t>(thumbnail.width) *
+                            static_cast<size_t>(thumbnail.height) * kBytesPerPixel);
+
+    size_t out = 0;
+    for (int32_t ty = 0; ty < thumbnail.height; ++ty) {
+        int32_t const y0 =
+            static_cast<int32_t>(int64_t{ty} * source.height / thumbnail.height);
+        int32_t const y1 = std::max(
+            y0 + 1,
+            static_cast<int32_t>(int64_t{ty + 1} * source.height / thumbnail.height));
+        for (int32_t tx = 0; tx < thumbnail.width; ++tx) {
+            int32_t const x0 =
+                static_cast<int32_t>(int64_t{tx} * source.width / thumbnail.width);
+            int32_t const x1 = std::max(
+                x0 + 1,
+                static_cast<int32_t>(int64_t{tx + 1} * source.width / thumbnail.width));
+            std::array<uint64_t, 3> sums = {};
+            for (int32_t y = y0; y < y1; ++y) {
+                size_t const row = static_cast<size_t>(y) * source.row_bytes;
+                for (int32_t x = x0; x < x1; ++x) {
+                    size_t const pixel = row + static_cast<size_t>(x) * kBytesPerPixel;
+                    sums[0] += source.pixels[pixel];
+                    sums[1] += source.pixels[pixel + 1u];
+                    sums[2] += source.pixels[pixel + 2u];
+                }
+            }
+            uint64_t const count =
+                static_cast<uint64_t>(y1 - y0) * static_cast<uint64_t>(x1 - x0);
+            for (uint64_t const sum : sums) {
+                thumbnail.pixels[out++] =
+                    static_cast<uint8_t>((sum + count / 2u) / count);
+            }
+            thumbnail.pixels[out++] = kOpaqueAlpha;
+        }
+    }
+    return thumbnail;
+}
+
+} // namespace
+
+std::optional<CompressedCapture>
+Compress_capture_for_history(ExportSourcePixels const &pixels, size_t budget_bytes) {
+    if (!Source_is_valid(pixels)) {
+        return std::nullopt;
+    }
+
+    CompressedCapture capture{};
+    capture.width = pixels.width;
+    capture.height = pixels.height;
+    capture.thumbnail = Build_thumbnail(pixels);
+    capture.memory_bytes = capture.thumbnail.pixels.size();
+    if (capture.memory_bytes > budget_bytes) {
+        return std::nullopt;
+    }
+
+    int32_t const columns = Tile_count(pixels.width);
+    int32_t const rows = Tile_count(pixels.height);
+    capture.tiles.reserve(static_cast<size_t>(columns) * static_cast<size_t>(rows));
+    std::vector<uint8_t> raw;
+    for (int32_t tile_y = 0; tile_y < rows; ++tile_y) {
+        int32_t const top = tile_y * kCaptureHistoryTileSize;
+        int32_t const height = std::min(kCaptureHistoryTileSize, pixels.height - top);
+        for (int32_t tile_x = 0; tile_x < columns; ++tile_x) {
+            int32_t const left = tile_x * kCaptureHistoryTileSize;
+            size_t const tile_row_bytes =
+                static_cast<size_t>(std::min(kCaptureHistoryTileSize,
+                                             pixels.width - left)) *
+                kBytesPerPixel;
+            raw.resize(tile_row_bytes * static_cast<size_t>(height));
+            for (int32_t y = 0; y < height; ++y) {
+                std::span<uint8_t> const out = std::span<uint8_t>(raw).subspan(
+                    static_cast<size_t>(y) * tile_row_bytes, tile_row_bytes);
+                std::ranges::copy(
+                    pixels.pixels.subspan(static_cast<size_t>(top + y) *
+                                                  pixels.row_bytes +
+                                              static_cast<size_t>(left) *
+                                                  kBytesPerPixel,
+                                          tile_row_bytes),
+                    out.begin());
+                for (size_t alpha = 3; alpha < out.size(); alpha += kBytesPerPixel) {
+                    out[alpha] = kOpaqueAlpha;
+                }
+            }
+            CompressedCapture::Tile tile{};
+            tile.bytes = Lz_compress_bytes(raw);
+            tile.compressed = tile.bytes.size() < raw.size();
+            if (tile.compressed) {
+                tile.bytes.shrink_to_fit();
+            } else {
+                tile.bytes = raw;
+            }
+            capture.memory_bytes += tile.bytes.size();
+            if (capture.memory_bytes > budget_bytes) {
+                return std::nullopt;
+            }
+            capture.tiles.push_back(std::move(tile));
+        }
+    }
+    return capture;
+}
+
+CaptureHistory::CaptureHistory(CaptureHistoryLimits limits) : limits_(limits) {}
+
+std::optional<uint64_t> CaptureHistory::Push(ExportSourcePixels const &pixels,
+                                             RectPx screen_rect,
+                                             std::optional<HWND> window) {
+    if (limits_.max_entries == 0 || limits_.budget_bytes == 0) {
+        return std::nullopt;
+    }
+    std::optional<CompressedCapture> capture =
+        Compress_capture_for_history(pixels, limits_.budget_bytes);
+    if (!capture.has_value()) {
+        return std::nullopt;
+    }
+    uint64_t const id = Reserve_id();
+    if (!Insert(id, std::move(*capture), screen_rect, window)) {
+        return std::nullopt;
+    }
+    return id;
+}
+
+uint64_t CaptureHistory::Reserve_id() noexcept { return next_id_++; }
+
+bool CaptureHistory::Insert(uint64_t id, CompressedCapture capture, RectPx screen_rect,
+                            std::optional<HWND> window) {
+    if (limits_.max_entries == 0 || capture.memory_bytes > limits_.budget_bytes ||
+        id >= next_id_ || (!entries_.empty() && id <= entries_.back().info.id)) {
+        return false;
+    }
+    Evict_for(capture.memory_bytes);
+    Entry entry{};
+    entry.info.id = id;
+    entry.info.screen_rect = screen_rect;
+    entry.info.window = window;
+    entry.info.width = capture.width;
+    entry.info.height = capture.height;
+    entry.capture = std::move(capture);
+    memory_bytes_ += entry.capture.memory_bytes;
+    entries_.push_back(std::move(entry));
+    return true;
+}
+
+CaptureHistoryEntryInfo const *CaptureHistory::Find(uint64_t id) const noexcept {
+    Entry const *const entry = Find_entry(id);
+    return entry != nullptr ? &entry->info : nullptr;
+}
+
+CaptureHistoryEntryInfo const *CaptureHistory::Latest() const noexcept {
+    return entries_.empty() ? nullptr : &entries_.back().info;
+}
+
+CaptureThumbnail const *CaptureHistory::Thumbnail(uint64_t id) const noexcept {
+    Entry const *const entry = Find_entry(id);
+    return entry != nullptr ? &entry->capture.thumbnail : nullptr;
+}
+
+bool CaptureHistory::Read_rect(uint64_t id, RectPx rect, ImageRowTarget target) const {
+    Entry const *const entry = Find_entry(id);
+    if (entry == nullptr) {
+        return false;
+    }
+    CaptureHistoryEntryInfo const &info = entry->info;
+    rect = rect.Normalized();
+    if (rect.Is_empty() || rect.left < 0 || rect.top < 0 || rect.right > info.width ||
+        rect.bottom > info.height) {
+        return false;
+    }
+    size_t const rect_row_bytes = static_cast<size_t>(rect.Width()) * kBytesPerPixel;
+    size_t const rows_before_last = static_cast<size_t>(rect.Height() - 1);
+    if (target.row_bytes < rect_row_bytes ||
+        (rows_before_last > 0 &&
+         rows_before_last > target.pixels.size() / target.row_bytes) ||
+        target.pixels.size() < rows_before_last * target.row_bytes + rect_row_bytes) {
+        return false;
+    }
+
+    int32_t const columns = Tile_count(info.width);
+    std::vector<uint8_t> scratch;
+    for (int32_t tile_y = rect.top / kCaptureHistoryTileSize;
+         tile_y < Tile_count(rect.bottom); ++tile_y) {
+        for (int32_t tile_x = rect.left / kCaptureHistoryTileSize;
+             tile_x < Tile_count(rect.right); ++tile_x) {
+            RectPx const tile_rect = RectPx::From_ltrb(
+                tile_x * kCaptureHistoryTileSize, tile_y * kCaptureHistoryTileSize,
+                std::min(info.width, (tile_x + 1) * kCaptureHistoryTileSize),
+                std::min(info.height, (tile_y + 1) * kCaptureHistoryTileSize));
+            std::optional<RectPx> const overlap = RectPx::Intersect(tile_rect, rect);
+            if (!overlap.has_value()) {
+                continue;
+            }
+            size_t const tile_index =
+                static_cast<size_t>(tile_y) * static_cast<size_t>(columns) +
+                static_cast<size_t>(tile_x);
+            CompressedCapture::Tile const &tile = entry->capture.tiles[tile_index];
+            size_t const tile_row_bytes =
+                static_cast<size_t>(tile_rect.Width()) * kBytesPerPixel;
+            std::span<const uint8_t> tile_pixels = tile.bytes;
+            if (tile.compressed) {
+                if (!Try_lz_decompress_bytes(tile.bytes,
+                                             tile_row_bytes * static_cast<size_t>(
+                                                                  tile_rect.Height()),
+                                             scratch)) {
+                    return false;
+                }
+                tile_pixels = scratch;
+            }
+            size_t const copy_bytes =
+                static_cast<size_t>(overlap->Width()) * kBytesPerPixel;
+            size_t const from_column =
+                static_cast<size_t>(overlap->left - tile_rect.left) * kBytesPerPixel;
+            size_t const to_column =
+                static_cast<size_t>(overlap->left - rect.left) * kBytesPerPixel;
+            for (int32_t y = overlap->top; y < overlap->bottom; ++y) {
+                size_t const from = static_cast<size_t>(y - tile_rect.top) *
+                                        tile_row_bytes +
+                                    from_column;
+                size_t const to =
+                    static_cast<size_t>(y - rect.top) * target.row_bytes + to_column;
+                std::ranges::copy(tile_pixels.subspan(from, copy_bytes),
+                                  target.pixels.subspan(to, copy_bytes).begin());
+            }
+        }
+    }
+    return true;
+}
+
+bool CaptureHistory::Read_all(uint64_t id, ImageRowTarget target) const {
+    CaptureHistoryEntryInfo const *const info = Find(id);
+    return info != nullptr &&
+           Read_rect(id, RectPx::From_ltrb(0, 0, info->width, info->height), target);
+}
+
+void CaptureHistory::Set_limits(CaptureHistoryLimits limits) {
+    limits_ = limits;
+    Evict_for(0);
+}
+
+void CaptureHistory::Clear() noexcept {
+    entries_.clear();
+    memory_bytes_ = 0;
+}
+
+size_t CaptureHistory::Size() const noexcept { return entries_.size(); }
+
+size_t CaptureHistory::Memory_bytes() const noexcept { return memory_bytes_; }
+
+CaptureHistory::Entry const *CaptureHistory::Find_entry(uint64_t id) const noexcept {
+    // Ids are inserted in increasing order but reserved ids may never arrive, so
+    // the ring is sorted with gaps.
+    auto const found = std::ranges::lower_bound(
+        entries_, id, {}, [](Entry const &entry) { return entry.info.id; });
+    return found != entries_.end() && found->info.id == id ? &*found : nullptr;
+}
+
+void CaptureHistory::Evict_for(size_t incoming_bytes) {
+    size_t const kept_entries = incoming_bytes > 0 ? 1u : 0u;
+    while (!entries_.empty() &&
+           (entries_.size() + kept_entries > limits_.max_entries ||
+            memory_bytes_ + incoming_bytes > limits_.budget_bytes)) {
+        memory_bytes_ -= entries_.front().capture.memory_bytes;
+        entries_.pop_front();
+    }
+}
+
+CaptureHistoryRecorder::CaptureHistoryRecorder(CaptureHistoryLimits limits)
+    : history_(limits) {}
+
+CaptureHistoryRecorder::~CaptureHistoryRecorder() {
+    {
+        std::scoped_lock lock(mutex_);
+        pending_.clear();
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::optional<uint64_t> CaptureHistoryRecorder::Record(ExportSourcePixels const &pixels,
+                                                       RectPx screen_rect,
+                                                       std::optional<HWND> window) {
+    if (!Source_is_valid(pixels)) {
+        return std::nullopt;
+    }
+    {
+        std::scoped_lock lock(mutex_);
+        CaptureHistoryLimits const limits = history_.Limits();
+        if (limits.max_entries == 0 || limits.budget_bytes == 0) {
+            return std::nullopt;
+        }
+    }
+
+    // Copy before locking so the worker and readers never wait on the caller's copy.
+    PendingCapture pending{};
+    pending.width = pixels.width;
+    pending.height = pixels.height;
+    pending.screen_rect = screen_rect;
+    pending.window = window;
+    size_t const row_bytes = static_cast<size_t>(pixels.width) * kBytesPerPixel;
+    try {
+        pending.pixels.resize(row_bytes * static_cast<size_t>(pixels.height));
+    } catch (std::bad_alloc const &) {
+        return std::nullopt;
+    }
+    for (int32_t y = 0; y < pixels.height; ++y) {
+        std::ranges::copy(
+            pixels.pixels.subspan(static_cast<size_t>(y) * pixels.row_bytes, row_bytes),
+            pending.pixels.begin() +
+                static_cast<std::ptrdiff_t>(static_cast<size_t>(y) * row_bytes));
+    }
+    ExportSourcePixels const copy{pending.pixels, row_bytes, pending.width,
+                                  pending.height};
+
+    std::unique_lock lock(mutex_);
+    CaptureHistoryLimits const limits = history_.Limits();
+    if (limits.max_entries == 0 || limits.budget_bytes == 0) {
+        return std::nullopt;
+    }
+    if (!thread_.joinable()) {
+        try {
+            thread_ = std::thread([this] { Compress_pending(); });
+        } catch (std::system_error const &) {
+            // No worker: compress on the caller, as a plain CaptureHistory does.
+            return history_.Push(copy, screen_rect, window);
+        }
+    }
+    if (pending_.size() >= kCaptureHistoryMaxPendingCaptures) {
+        // The worker is behind; let it drain so ids still arrive in order, then
+        // compress this capture here rather than queue another raw frame.
+        Wait_until_idle(lock);
+        return history_.Push(copy, screen_rect, window);
+    }
+
+    pending.id = history_.Reserve_id();
+    uint64_t const id = pending.id;
+    pending_.push_back(std::move(pending));
+    lock.unlock();
+    changed_.notify_all();
+    return id;
+}
+
+std::optional<CaptureHistoryEntryInfo> CaptureHistoryRecorder::Find(uint64_t id) {
+    std::unique_lock lock(mutex_);
+    Wait_until_idle(lock);
+    CaptureHistoryEntryInfo const *const info = history_.Find(id);
+    return info != nullptr ? std::optional<CaptureHistoryEntryInfo>(*info)
+                           : std::nullopt;
+}
+
+bool CaptureHistoryRecorder::Read_all(uint64_t id, ImageRowTarget target) {
+    std::unique_lock lock(mutex_);
+    Wait_until_idle(lock);
+    return history_.Read_all(id, target);
+}
+
+void CaptureHistoryRecorder::Set_limits(CaptureHistoryLimits limits) {
+    std::scoped_lock lock(mutex_);
+    history_.Set_limits(limits);
+    if (limits.max_entries == 0 || limits.budget_bytes == 0) {
+        pending_.clear();
+        changed_.notify_all();
+    }
+}
+
+void CaptureHistoryRecorder::Compress_pending() {
+    std::unique_lock lock(mutex_);
+    for (;;) {
+        changed_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        PendingCapture const pending = std::move(pending_.front());
+        pending_.pop_front();
+        compressing_ = true;
+        size_t const budget_bytes = history_.Limits().budget_bytes;
+        lock.unlock();
+        std::optional<CompressedCapture> capture = std::nullopt;
+        try {
+            capture = Compress_capture_for_history(
+                ExportSourcePixels{pending.pixels,
+                                   static_cast<size_t>(pending.width) * kBytesPerPixel,
+                                   pending.width, pending.height},
+                budget_bytes);
+        } catch (std::bad_alloc const &) {
+            // Dropped like a capture over the budget.
+        }
+        lock.lock();
+        if (capture.has_value()) {
+            (void)history_.Insert(pending.id, std::move(*capture), pending.screen_rect,
+                                  pending.window);
+        }
+        compressing_ = false;
+        changed_.notify_all();
+    }
+}
+
+void CaptureHistoryRecorder::Wait_until_idle(std::unique_lock<std::mutex> &lock) {
+    changed_.wait(lock, [this] { return pending_.empty() && !compressing_; });
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "greenflame_core/export_compositor.h"
+
+namespace greenflame::core {
+
+inline constexpr int32_t kCaptureHistoryTileSize = 64;
+inline constexpr int32_t kCaptureHistoryThumbnailMaxEdge = 160;
+inline constexpr size_t kDefaultCaptureHistoryMaxEntries = 16;
+inline constexpr size_t kDefaultCaptureHistoryBudgetBytes = size_t{64} << 20;
+// Raw captures a CaptureHistoryRecorder holds for its worker before Record
+// compresses on the caller instead.
+inline constexpr size_t kCaptureHistoryMaxPendingCaptures = 2;
+
+struct CaptureHistoryLimits final {
+    size_t max_entries = kDefaultCaptureHistoryMaxEntries;
+    // Compressed tiles plus thumbnails of every entry. 0 disables the history.
+    size_t budget_bytes = kDefaultCaptureHistoryBudgetBytes;
+};
+
+// Opaque BGRA, width * 4 bytes per row.
+struct CaptureThumbnail final {
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<uint8_t> pixels = {};
+};
+
+// One capture as the history keeps it: the thumbnail plus every tile in row
+// order, each compressed with Lz_compress_bytes unless that would not shrink it.
+struct CompressedCapture final {
+    struct Tile final {
+        std::vector<uint8_t> bytes = {};
+        bool compressed = false;
+    };
+
+    int32_t width = 0;
+    int32_t height = 0;
+    CaptureThumbnail thumbnail = {};
+    std::vector<Tile> tiles = {};
+    size_t memory_bytes = 0;
+};
+
+// Copies and compresses `pixels` (alpha is ignored); touches no shared state, so
+// it can run on any thread. Nullopt for invalid pixels or when the result would
+// exceed `budget_bytes`.
+[[nodiscard]] std::optional<CompressedCapture>
+Compress_capture_for_history(ExportSourcePixels const &pixels, size_t budget_bytes);
+
+struct CaptureHistoryEntryInfo final {
+    uint64_t id = 0;
+    RectPx screen_rect = {};
+    std::optional<HWND> window = std::nullopt;
+    int32_t width = 0;
+    int32_t height = 0;
+};
+
+// A bounded ring of recent captures, newest last. Each capture is kept as
+// independently compressed tiles, so reading a sub-rect only decompresses the
+// tiles it touches, and with a small uncompressed thumbnail. The oldest entries
+// are dropped to stay within the limits. Not thread-safe.
+class CaptureHistory final {
+  public:
+    explicit CaptureHistory(CaptureHistoryLimits limits = {});
+
+    // Compresses `pixels` and adds them under a new id. Returns the id, or nullopt
+    // when the capture alone does not fit the budget.
+    [[nodiscard]] std::optional<uint64_t> Push(ExportSourcePixels const &pixels,
+                                               RectPx screen_rect,
+                                               std::optional<HWND> window);
+
+    // Splits Push for callers that compress elsewhere: Reserve_id hands out the
+    // id up front, Insert adds the capture under it later. Ids must be inserted
+    // in the order they were reserved; a reserved id that is never inserted is
+    // simply never found. Insert returns false when the limits turn it away.
+    [[nodiscard]] uint64_t Reserve_id() noexcept;
+    bool Insert(uint64_t id, CompressedCapture capture, RectPx screen_rect,
+                std::optional<HWND> window);
+
+    [[nodiscard]] CaptureHistoryEntryInfo const *Find(uint64_t id) const noexcept;
+    [[nodiscard]] CaptureHistoryEntryInfo const *Latest() const noexcept;
+    [[nodiscard]] CaptureThumbnail const *Thumbnail(uint64_t id) const noexcept;
+
+    // Writes `rect`, in capture coordinates, as opaque BGRA rows into `target`.
+    [[nodiscard]] bool Read_rect(uint64_t id, RectPx rect, ImageRowTarget target) const;
+    [[nodiscard]] bool Read_all(uint64_t id, ImageRowTarget target) const;
+
+    void Set_limits(CaptureHistoryLimits limits);
+    [[nodiscard]] CaptureHistoryLimits Limits() const noexcept { return limits_; }
+    void Clear() noexcept;
+    [[nodiscard]] size_t Size() const noexcept;
+    [[nodiscard]] size_t Memory_bytes() const noexcept;
+
+  private:
+    struct Entry final {
+        CaptureHistoryEntryInfo info = {};
+        CompressedCapture capture = {};
+    };
+
+    [[nodiscard]] Entry const *Find_entry(uint64_t id) const noexcept;
+    void Evict_for(size_t incoming_bytes);
+
+    CaptureHistoryLimits limits_ = {};
+    std::deque<Entry> entries_ = {};
+    size_t memory_bytes_ = 0;
+    uint64_t next_id_ = 1;
+};
+
+// A CaptureHistory filled from a background thread, so recording a capture costs
+// its caller one copy of the pixels. Record hands back the entry's id at once;
+// compression and insertion follow on the worker, in record order. Once
+// kCaptureHistoryMaxPendingCaptures raw copies are waiting, Record waits for them
+// and compresses its own capture, so a burst cannot pile up uncompressed frames.
+// Reads wait for records still in flight, so a read right after Record sees the
+// entry. Thread-safe.
+class CaptureHistoryRecorder final {
+  public:
+    explicit CaptureHistoryRecorder(CaptureHistoryLimits limits = {});
+    // Drops records not yet compressed and waits for the one in progress.
+    ~CaptureHistoryRecorder();
+    CaptureHistoryRecorder(CaptureHistoryRecorder const &) = delete;
+    CaptureHistoryRecorder &operator=(CaptureHistoryRecorder const &) = delete;
+    CaptureHistoryRecorder(CaptureHistoryRecorder &&) = delete;
+    CaptureHistoryRecorder &operator=(CaptureHistoryRecorder &&) = delete;
+
+    // Nullopt when the history is disabled or `pixels` are invalid. The id is
+    // never found if the compressed capture turns out not to fit the budget.
+    [[nodiscard]] std::optional<uint64_t> Record(ExportSourcePixels const &pixels,
+                                                 RectPx screen_rect,
+                                                 std::optional<HWND> window);
+
+    [[nodiscard]] std::optional<CaptureHistoryEntryInfo> Find(uint64_t id);
+    [[nodiscard]] bool Read_all(uint64_t id, ImageRowTarget target);
+
+    // Disabling the history also drops records still waiting.
+    void Set_limits(CaptureHistoryLimits limits);
+
+  private:
+    struct PendingCapture final {
+        uint64_t id = 0;
+        std::vector<uint8_t> pixels = {}; // width * 4 bytes per row
+        int32_t width = 0;
+        int32_t height = 0;
+        RectPx screen_rect = {};
+        std::optional<HWND> window = std::nullopt;
+    };
+
+    void Compress_pending();
+    void Wait_until_idle(std::unique_lock<std::mutex> &lock);
+
+    std::mutex mutex_ = {};
+    std::condition_variable changed_ = {};
+    CaptureHistory history_;
+    std::deque<PendingCapture> pending_ = {};
+    bool compressing_ = false;
+    bool stopping_ = false;
+    std::thread thread_ = {};
+};
+
+} // namespace greenflame::core
@@ -1,6 +1,7 @@
 #include "greenflame_core/cli_annotation_import.h"
 
 #include "greenflame_core/selection_wheel.h"
+#include "greenflame_core/string_utils.h"
 
 namespace greenflame::core {
 
@@ -53,6 +54,7 @@ constexpr size_t kRgbColorStringChars =
     kHexPrefixChars + (kRgbChannelCount * kHexByteChars);
 constexpr int32_t kHighlighterWidthStepOffsetPx = 10;
 constexpr int32_t kBubbleDiameterStepOffsetPx = 20;
+constexpr size_t kEstimatedBytesPerTapeToken = 4;
 
 struct QuietCerrCapture final {
     QuietCerrCapture() : old_buffer_(std::cerr.rdbuf(stream_.rdbuf())) {}
@@ -109,9 +111,38 @@ struct ParseState final {
     }
 };
 
+enum class JsonTapeKind : uint8_t {
+    Null = 0,
+    Boolean = 1,
+    Integral = 2,
+    Floating = 3,
+    String = 4,
+    Object = 5,
+    Array = 6,
+};
+
+// One value of a JSON document flattened in document order. Containers are
+// followed by their children (object members as key/value token pairs) and
+// `next` is the index just past the value, so siblings are reached without
+// walking children. Strings reference the source text instead of owning a copy.
+struct JsonTapeToken final {
+    int64_t integer = 0;
+    uint32_t offset = 0;
+    uint32_t length = 0;
+    uint32_t next = 0;
+    uint32_t count = 0;
+    JsonTapeKind kind = JsonTapeKind::Null;
+    // Boolean value, or whether a string contains escape sequences.
+    bool flag = false;
+};
+
+// Validates JSON syntax; when given a tape it also records every value it
+// accepts, so checking and tokenizing the input is a single pass.
 class JsonSyntaxChecker final {
   public:
-    explicit JsonSyntaxChecker(std::string_view text) : text_(text) {}
+    explicit JsonSyntaxChecker(std::string_view text,
+                               std::vector<JsonTapeToken> *tape = nullptr)
+        : text_(text), tape_(tape) {}
 
     [[nodiscard]] std::wstring Check_error() noexcept {
         Skip_whitespace();
@@ -183,12 +214,15 @@ class JsonSyntaxChecker final {
 
     [[nodiscard]] bool Parse_object() noexcept {
         (void)Advance();
+        size_t const token_index = Begin_container(JsonTapeKind::Object);
+        uint32_t members = 0;
         Skip_whitespace();
         if (At_end()) {
             return Fail(L"Unexpected end of JSON input inside an object.");
         }
         if (Peek() == '}') {
             (void)Advance();
+            End_container(token_index, members);
             return true;
         }
 
@@ -207,12 +241,14 @@ class JsonSyntaxChecker final {
             if (!Parse_value()) {
                 return false;
             }
+            ++members;
             Skip_whitespace();
             if (At_end()) {
                 return Fail(L"Unexpected end of JSON input inside an object.");
             }
             if (Peek() == '}') {
                 (void)Advance();
+                End_container(token_index, members);
                 return true;
             }
             if (Peek() != ',') {
@@ -225,12 +261,15 @@ class JsonSyntaxChecker final {
 
     [[nodiscard]] bool Parse_array() noexcept {
         (void)Advance();
+        size_t const token_index = Begin_container(JsonTapeKind::Array);
+        uint32_t elements = 0;
         Skip_whitespace();
         if (At_end()) {
             return Fail(L"Unexpected end of JSON input inside an array.");
         }
         if (Peek() == ']') {
             (void)Advance();
+            End_container(token_index, elements);
             return true;
         }
 
@@ -238,12 +277,14 @@ class JsonSyntaxChecker final {
             if (!Parse_value()) {
                 return false;
             }
+            ++elements;
             Skip_whitespace();
             if (At_end()) {
                 return Fail(L"Unexpected end of JSON input inside an array.");
             }
             if (Peek() == ']') {
                 (void)Advance();
+                End_container(token_index, elements);
                 return true;
             }
             if (Peek() != ',') {
@@ -258,9 +299,17 @@ class JsonSyntaxChecker final {
         if (Advance() != '"') {
             return Fail(L"Expected '\"' to begin a string.");
         }
+        size_t const begin = index_;
+        bool escaped = false;
         while (!At_end()) {
             char const ch = Advance();
             if (ch == '"') {
+                JsonTapeToken token{};
+                token.kind = JsonTapeKind::String;
+                token.offset = static_cast<uint32_t>(begin);
+                token.length = static_cast<uint32_t>(index_ - 1 - begin);
+                token.flag = escaped;
+                Push_scalar(token);
                 return true;
             }
             if (static_cast<unsigned char>(ch) < 0x20u) {
@@ -269,6 +318,7 @@ class JsonSyntaxChecker final {
             if (ch != '\\') {
                 continue;
             }
+            escaped = true;
             if (At_end()) {
                 return Fail(L"Incomplete escape sequence in JSON string.");
             }
@@ -306,10 +356,17 @@ class JsonSyntaxChecker final {
                 return Fail(L"Invalid JSON literal.");
             }
         }
+        JsonTapeToken token{};
+        token.kind =
+            literal_text == "null" ? JsonTapeKind::Null : JsonTapeKind::Boolean;
+        token.flag = literal_text == "true";
+        Push_scalar(token);
         return true;
     }
 
     [[nodiscard]] bool Parse_number() noexcept {
+        size_t const begin = index_;
+        bool integral = true;
         if (Peek() == '-') {
             (void)Advance();
         }
@@ -327,6 +384,7 @@ class JsonSyntaxChecker final {
         }
 
         if (!At_end() && Peek() == '.') {
+            integral = false;
             (void)Advance();
             if (At_end() || std::isdigit(static_cast<unsigned char>(Peek())) == 0) {
                 return Fail(L"Invalid JSON number.");
@@ -337,6 +395,7 @@ class JsonSyntaxChecker final {
         }
 
         if (!At_end() && (Peek() == 'e' || Peek() == 'E')) {
+            integral = false;
             (void)Advance();
             if (!At_end() && (Peek() == '+' || Peek() == '-')) {
                 (void)Advance();
@@ -349,12 +408,53 @@ class JsonSyntaxChecker final {
             }
         }
 
+        // Like easyjson, fractions and exponents make a number non-integral;
+        // integers outside int64_t are kept as non-integral too.
+        JsonTapeToken token{};
+        token.kind = JsonTapeKind::Floating;
+        if (integral) {
+            char const *const first = text_.data() + begin;
+            char const *const last = text_.data() + index_;
+            auto const [end, error] = std::from_chars(first, last, token.integer);
+            if (error == std::errc{} && end == last) {
+                token.kind = JsonTapeKind::Integral;
+            }
+        }
+        Push_scalar(token);
         return true;
     }
 
+    [[nodiscard]] size_t Begin_container(JsonTapeKind kind) {
+        if (tape_ == nullptr) {
+            return 0;
+        }
+        JsonTapeToken token{};
+        token.kind = kind;
+        tape_->push_back(token);
+        return tape_->size() - 1;
+    }
+
+    void End_container(size_t token_index, uint32_t count) noexcept {
+        if (tape_ == nullptr) {
+            return;
+        }
+        JsonTapeToken &token = (*tape_)[token_index];
+        token.count = count;
+        token.next = static_cast<uint32_t>(tape_->size());
+    }
+
+    void Push_scalar(JsonTapeToken token) {
+        if (tape_ == nullptr) {
+            return;
+        }
+        token.next = static_cast<uint32_t>(tape_->size() + 1);
+        tape_->push_back(token);
+    }
+
     std::string_view text_ = {};
     size_t index_ = 0;
     std::wstring error_ = {};
+    std::vector<JsonTapeToken> *tape_ = nullptr;
 };
 
 [[nodiscard]] bool Contains_key(std::span<const std::string_view> allowed_keys,
@@ -485,6 +585,242 @@ void Report_unknown_keys(Json const &object,
     return true;
 }
 
+[[nodiscard]] JsonClass Json_class(Json const &value) noexcept {
+    return value.JSON_type();
+}
+
+[[nodiscard]] size_t Json_length(Json const &array) {
+    return static_cast<size_t>(array.length());
+}
+
+[[nodiscard]] bool Json_bool(Json const &value) { return value.to_bool(); }
+
+template <typename Fn>
+[[nodiscard]] bool For_each_json_element(Json const &array, Fn &&fn) {
+    size_t const count = Json_length(array);
+    for (size_t index = 0; index < count; ++index) {
+        if (!fn(Json_element(array, index), index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+[[nodiscard]] bool Contains_only_keys(Json const &object,
+                                      std::span<const std::string_view> allowed_keys) {
+    for (auto const &[key, value] : object.object_range()) {
+        (void)value;
+        if (!Contains_key(allowed_keys, key)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Read-only view of one value on a JSON tape, with the same accessors as the
+// easyjson helpers above so the validators below accept either representation.
+struct JsonTapeValue final {
+    std::string_view source = {};
+    std::span<const JsonTapeToken> tape = {};
+    size_t index = 0;
+
+    [[nodiscard]] JsonTapeToken const *Token() const noexcept {
+        return index < tape.size() ? &tape[index] : nullptr;
+    }
+
+    [[nodiscard]] JsonTapeValue At(size_t token_index) const noexcept {
+        return JsonTapeValue{source, tape, token_index};
+    }
+
+    [[nodiscard]] std::string_view Raw_string() const noexcept {
+        JsonTapeToken const *const token = Token();
+        return token != nullptr ? source.substr(token->offset, token->length)
+                                : std::string_view{};
+    }
+};
+
+[[nodiscard]] JsonClass Json_class(JsonTapeValue const &value) noexcept {
+    JsonTapeToken const *const token = value.Token();
+    if (token == nullptr) {
+        return JsonClass::Null;
+    }
+    switch (token->kind) {
+    case JsonTapeKind::Boolean:
+        return JsonClass::Boolean;
+    case JsonTapeKind::Integral:
+        return JsonClass::Integral;
+    case JsonTapeKind::Floating:
+        return JsonClass::Floating;
+    case JsonTapeKind::String:
+        return JsonClass::String;
+    case JsonTapeKind::Object:
+        return JsonClass::Object;
+    case JsonTapeKind::Array:
+        return JsonClass::Array;
+    case JsonTapeKind::Null:
+        break;
+    }
+    return JsonClass::Null;
+}
+
+// Decodes escapes the way easyjson does: single-character escapes are
+// resolved and \uXXXX is kept verbatim.
+[[nodiscard]] std::string Decode_json_string(std::string_view raw) {
+    std::string decoded = {};
+    decoded.reserve(raw.size());
+    for (size_t index = 0; index < raw.size(); ++index) {
+        char const ch = raw[index];
+        if (ch != '\\' || index + 1 >= raw.size()) {
+            decoded.push_back(ch);
+            continue;
+        }
+        char const escaped = raw[++index];
+        switch (escaped) {
+        case 'b':
+            decoded.push_back('\b');
+            break;
+        case 'f':
+            decoded.push_back('\f');
+            break;
+        case 'n':
+            decoded.push_back('\n');
+            break;
+        case 'r':
+            decoded.push_back('\r');
+            break;
+        case 't':
+            decoded.push_back('\t');
+            break;
+        case 'u':
+            decoded += "\\u";
+            break;
+        default:
+            decoded.push_back(escaped);
+            break;
+        }
+    }
+    return decoded;
+}
+
+[[nodiscard]] std::string Get_json_string(JsonTapeValue const &value) {
+    JsonTapeToken const *const token = value.Token();
+    if (token == nullptr || token->kind != JsonTapeKind::String) {
+        return {};
+    }
+    return token->flag ? Decode_json_string(value.Raw_string())
+                       : std::string(value.Raw_string());
+}
+
+[[nodiscard]] bool Json_key_equals(JsonTapeValue const &key, std::string_view name) {
+    return key.Token()->flag ? Decode_json_string(key.Raw_string()) == name
+                             : key.Raw_string() == name;
+}
+
+template <typename Fn> void For_each_json_member(JsonTapeValue const &object, Fn &&fn) {
+    JsonTapeToken const *const token = object.Token();
+    if (token == nullptr || token->kind != JsonTapeKind::Object) {
+        return;
+    }
+    size_t key_index = object.index + 1;
+    for (uint32_t member = 0; member < token->count; ++member) {
+        size_t const value_index = key_index + 1;
+        fn(object.At(key_index), object.At(value_index));
+        key_index = object.tape[value_index].next;
+    }
+}
+
+[[nodiscard]] std::optional<JsonTapeValue> Find_json_member(JsonTapeValue const &object,
+                                                            std::string_view key) {
+    // Duplicate keys resolve to the last occurrence, as in the easyjson DOM.
+    std::optional<JsonTapeValue> found = std::nullopt;
+    For_each_json_member(object, [&](JsonTapeValue const &member_key,
+                                     JsonTapeValue const &member_value) {
+        if (Json_key_equals(member_key, key)) {
+            found = member_value;
+        }
+    });
+    return found;
+}
+
+[[nodiscard]] bool Has_json_key(JsonTapeValue const &object, std::string_view key) {
+    return Find_json_member(object, key).has_value();
+}
+
+[[nodiscard]] JsonTapeValue Json_member(JsonTapeValue const &object,
+                                        std::string_view key) {
+    return Find_json_member(object, key).value_or(JsonTapeValue{});
+}
+
+[[nodiscard]] size_t Json_length(JsonTapeValue const &array) noexcept {
+    JsonTapeToken const *const token = array.Token();
+    return token != nullptr && token->kind == JsonTapeKind::Array ? token->count : 0;
+}
+
+[[nodiscard]] bool Json_bool(JsonTapeValue const &value) noexcept {
+    JsonTapeToken const *const token = value.Token();
+    return token != nullptr && token->kind == JsonTapeKind::Boolean && token->flag;
+}
+
+template <typename Fn>
+[[nodiscard]] bool For_each_json_element(JsonTapeValue const &array, Fn &&fn) {
+    size_t const count = Json_length(array);
+    size_t element_index = array.index + 1;
+    for (size_t index = 0; index < count; ++index) {
+        if (!fn(array.At(element_index), index)) {
+            return false;
+        }
+        element_index = array.tape[element_index].next;
+    }
+    return true;
+}
+
+[[nodiscard]] bool Try_read_int32(JsonTapeValue const &value, int32_t &out) noexcept {
+    JsonTapeToken const *const token = value.Token();
+    if (token == nullptr || token->kind != JsonTapeKind::Integral ||
+        token->integer < static_cast<int64_t>(std::numeric_limits<int32_t>::min()) ||
+        token->integer > static_cast<int64_t>(std::numeric_limits<int32_t>::max())) {
+        return false;
+    }
+    out = static_cast<int32_t>(token->integer);
+    return true;
+}
+
+[[nodiscard]] bool Contains_only_keys(JsonTapeValue const &object,
+                                      std::span<const std::string_view> allowed_keys) {
+    bool only_allowed = true;
+    For_each_json_member(object, [&](JsonTapeValue const &member_key,
+                                     JsonTapeValue const &member_value) {
+        (void)member_value;
+        if (!only_allowed) {
+            return;
+        }
+        only_allowed = member_key.Token()->flag
+                           ? Contains_key(allowed_keys, Get_json_string(member_key))
+                           : Contains_key(allowed_keys, member_key.Raw_string());
+    });
+    return only_allowed;
+}
+
+void Report_unknown_keys(JsonTapeValue const &object,
+                         std::span<const std::string_view> allowed_keys,
+                         std::wstring_view path, ParseState &state) {
+    // The DOM reports the first unknown key in std::map order; match it by
+    // picking the smallest unknown key.
+    std::optional<std::string> first_unknown = std::nullopt;
+    For_each_json_member(object, [&](JsonTapeValue const &member_key,
+                                     JsonTapeValue const &member_value) {
+        (void)member_value;
+        std::string key = Get_json_string(member_key);
+        if (!Contains_key(allowed_keys, key) &&
+            (!first_unknown.has_value() || key < *first_unknown)) {
+            first_unknown = std::move(key);
+        }
+    });
+    if (first_unknown.has_value()) {
+        state.Fail(Join_path(path, *first_unknown), L"contains an unknown property.");
+    }
+}
+
 [[nodiscard]] bool Try_parse_hex_digit(char ch, uint8_t &value) noexcept {
     if (ch >= '0' && ch <= '9') {
         value = static_cast<uint8_t>(ch - '0');
@@ -681,7 +1017,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     }
 }
 
-[[nodiscard]] bool Try_parse_color_property(Json const &object, std::string_view key,
+template <typename Value>
+[[nodiscard]] bool Try_parse_color_property(Value const &object, std::string_view key,
                                             std::wstring_view path,
                                             std::optional<COLORREF> &out,
                                             ParseState &state) {
@@ -689,8 +1026,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
         out.reset();
         return true;
     }
-    Json const &member = Json_member(object, key);
-    if (member.JSON_type() != JsonClass::String) {
+    auto const &member = Json_member(object, key);
+    if (Json_class(member) != JsonClass::String) {
         state.Fail(Join_path(path, key), L"must be a #rrggbb color string.");
         return false;
     }
@@ -703,7 +1040,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_opacity_property(Json const &object, std::string_view key,
+template <typename Value>
+[[nodiscard]] bool Try_parse_opacity_property(Value const &object, std::string_view key,
                                               std::wstring_view path,
                                               std::optional<int32_t> &out,
                                               ParseState &state) {
@@ -712,7 +1050,7 @@ void Apply_font_override(BubbleAnnotation &bubble,
         return true;
     }
 
-    Json const &member = Json_member(object, key);
+    auto const &member = Json_member(object, key);
     int32_t value = 0;
     if (!Try_read_int32(member, value) || value < kMinOpacityPercent ||
         value > kMaxOpacityPercent) {
@@ -723,7 +1061,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_size_property(Json const &object, std::string_view key,
+template <typename Value>
+[[nodiscard]] bool Try_parse_size_property(Value const &object, std::string_view key,
                                            std::wstring_view path,
                                            std::optional<int32_t> &out,
                                            ParseState &state) {
@@ -732,7 +1071,7 @@ void Apply_font_override(BubbleAnnotation &bubble,
         return true;
     }
 
-    Json const &member = Json_member(object, key);
+    auto const &member = Json_member(object, key);
     int32_t value = 0;
     if (!Try_read_int32(member, value) || value < kMinToolSizeStep ||
         value > kMaxToolSizeStep) {
@@ -745,7 +1084,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_required_int32(Json const &object, std::string_view key,
+template <typename Value>
+[[nodiscard]] bool Try_parse_required_int32(Value const &object, std::string_view key,
                                             std::wstring_view path, int32_t &out,
                                             ParseState &state) {
     if (!Has_json_key(object, key)) {
@@ -759,31 +1099,33 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_bool_property(Json const &object, std::string_view key,
+template <typename Value>
+[[nodiscard]] bool Try_parse_bool_property(Value const &object, std::string_view key,
                                            std::wstring_view path, bool &out,
                                            ParseState &state) {
     if (!Has_json_key(object, key)) {
         out = false;
         return true;
     }
-    Json const &member = Json_member(object, key);
-    if (member.JSON_type() != JsonClass::Boolean) {
+    auto const &member = Json_member(object, key);
+    if (Json_class(member) != JsonClass::Boolean) {
         state.Fail(Join_path(path, key), L"must be a boolean.");
         return false;
     }
-    out = member.to_bool();
+    out = Json_bool(member);
     return true;
 }
 
-[[nodiscard]] bool Try_parse_string_property(Json const &object, std::string_view key,
+template <typename Value>
+[[nodiscard]] bool Try_parse_string_property(Value const &object, std::string_view key,
                                              std::wstring_view path, std::wstring &out,
                                              ParseState &state) {
     if (!Has_json_key(object, key)) {
         state.Fail(Join_path(path, key), L"is required.");
         return false;
     }
-    Json const &member = Json_member(object, key);
-    if (member.JSON_type() != JsonClass::String) {
+    auto const &member = Json_member(object, key);
+    if (Json_class(member) != JsonClass::String) {
         state.Fail(Join_path(path, key), L"must be a string.");
         return false;
     }
@@ -794,9 +1136,10 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_font_spec(Json const &value, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_font_spec(Value const &value, std::wstring_view path,
                                        FontSpec &out, ParseState &state) {
-    if (value.JSON_type() != JsonClass::Object) {
+    if (Json_class(value) != JsonClass::Object) {
         state.Fail(path, L"must be an object.");
         return false;
     }
@@ -814,8 +1157,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
 
     out = {};
     if (has_preset) {
-        Json const &preset_value = Json_member(value, "preset");
-        if (preset_value.JSON_type() != JsonClass::String) {
+        auto const &preset_value = Json_member(value, "preset");
+        if (Json_class(preset_value) != JsonClass::String) {
             state.Fail(Join_path(path, "preset"), L"must be a string.");
             return false;
         }
@@ -841,8 +1184,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
         return false;
     }
 
-    Json const &family_value = Json_member(value, "family");
-    if (family_value.JSON_type() != JsonClass::String) {
+    auto const &family_value = Json_member(value, "family");
+    if (Json_class(family_value) != JsonClass::String) {
         state.Fail(Join_path(path, "family"), L"must be a string.");
         return false;
     }
@@ -866,7 +1209,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_optional_font_property(Json const &object,
+template <typename Value>
+[[nodiscard]] bool Try_parse_optional_font_property(Value const &object,
                                                     std::string_view key,
                                                     std::wstring_view path,
                                                     std::optional<FontSpec> &out,
@@ -894,9 +1238,10 @@ void Apply_font_override(BubbleAnnotation &bubble,
            Try_add_int32(origin.y, point.y, out.y);
 }
 
-[[nodiscard]] bool Try_parse_point(Json const &value, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_point(Value const &value, std::wstring_view path,
                                    PointPx &out, ParseState &state) {
-    if (value.JSON_type() != JsonClass::Object) {
+    if (Json_class(value) != JsonClass::Object) {
         state.Fail(path, L"must be an object.");
         return false;
     }
@@ -912,23 +1257,41 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_points_array(Json const &value, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_read_point_quietly(Value const &value, PointPx &out) {
+    if (Json_class(value) != JsonClass::Object ||
+        !Contains_only_keys(value, kPointKeys) || !Has_json_key(value, "x") ||
+        !Has_json_key(value, "y")) {
+        return false;
+    }
+    return Try_read_int32(Json_member(value, "x"), out.x) &&
+           Try_read_int32(Json_member(value, "y"), out.y);
+}
+
+template <typename Value>
+[[nodiscard]] bool Try_parse_points_array(Value const &value, std::wstring_view path,
                                           std::vector<PointPx> &points,
                                           ParseState &state) {
-    if (value.JSON_type() != JsonClass::Array) {
+    if (Json_class(value) != JsonClass::Array) {
         state.Fail(path, L"must be an array.");
         return false;
     }
 
     points.clear();
-    points.reserve(value.length());
-    for (size_t index = 0; index < value.length(); ++index) {
-        PointPx point{};
-        if (!Try_parse_point(Json_element(value, index), Join_index(path, index), point,
-                             state)) {
-            return false;
-        }
-        points.push_back(point);
+    points.reserve(Json_length(value));
+    bool const parsed =
+        For_each_json_element(value, [&](auto const &element, size_t index) {
+            // Element paths are only built when a point needs a diagnostic.
+            PointPx point{};
+            if (!Try_read_point_quietly(element, point) &&
+                !Try_parse_point(element, Join_index(path, index), point, state)) {
+                return false;
+            }
+            points.push_back(point);
+            return true;
+        });
+    if (!parsed) {
+        return false;
     }
 
     if (points.empty()) {
@@ -938,7 +1301,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_line_like(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_line_like(Value const &object, std::wstring_view path,
                                        std::wstring_view type, bool arrow_head,
                                        ParseState &state, Annotation &out) {
     std::optional<COLORREF> annotation_color = std::nullopt;
@@ -982,7 +1346,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_brush(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_brush(Value const &object, std::wstring_view path,
                                    ParseState &state, Annotation &out) {
     std::optional<COLORREF> annotation_color = std::nullopt;
     std::optional<int32_t> size_step = std::nullopt;
@@ -1022,7 +1387,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_highlighter(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_highlighter(Value const &object, std::wstring_view path,
                                          ParseState &state, Annotation &out) {
     std::optional<COLORREF> annotation_color = std::nullopt;
     std::optional<int32_t> opacity_percent = std::nullopt;
@@ -1090,7 +1456,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_rectangle(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_rectangle(Value const &object, std::wstring_view path,
                                        std::wstring_view type, bool filled,
                                        ParseState &state, Annotation &out) {
     std::optional<COLORREF> annotation_color = std::nullopt;
@@ -1149,7 +1516,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_ellipse(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_ellipse(Value const &object, std::wstring_view path,
                                      std::wstring_view type, bool filled,
                                      ParseState &state, Annotation &out) {
     std::optional<COLORREF> annotation_color = std::nullopt;
@@ -1214,7 +1582,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_obfuscate(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_obfuscate(Value const &object, std::wstring_view path,
                                        ParseState &state, Annotation &out) {
     std::optional<int32_t> size_step = std::nullopt;
     int32_t left = 0;
@@ -1258,7 +1627,44 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_text(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_text_span(Value const &span, std::wstring_view span_path,
+                                       ParseState &state, TextRun &out) {
+    if (Json_class(span) != JsonClass::Object) {
+        state.Fail(span_path, L"must be an object.");
+        return false;
+    }
+    Report_unknown_keys(span, kTextSpanKeys, span_path, state);
+    if (!state.result.error_message.empty()) {
+        return false;
+    }
+
+    std::wstring text = {};
+    if (!Try_parse_string_property(span, "text", span_path, text, state)) {
+        return false;
+    }
+    text = Normalize_text_newlines(text);
+    if (text.empty()) {
+        state.Fail(Join_path(span_path, "text"), L"must not be empty.");
+        return false;
+    }
+
+    TextStyleFlags flags{};
+    if (!Try_parse_bool_property(span, "bold", span_path, flags.bold, state) ||
+        !Try_parse_bool_property(span, "italic", span_path, flags.italic, state) ||
+        !Try_parse_bool_property(span, "underline", span_path, flags.underline,
+                                 state) ||
+        !Try_parse_bool_property(span, "strikethrough", span_path,
+                                 flags.strikethrough, state)) {
+        return false;
+    }
+
+    out = TextRun{std::move(text), flags};
+    return true;
+}
+
+template <typename Value>
+[[nodiscard]] bool Try_parse_text(Value const &object, std::wstring_view path,
                                   ParseState &state, Annotation &out) {
     std::optional<COLORREF> annotation_color = std::nullopt;
     std::optional<FontSpec> annotation_font = std::nullopt;
@@ -1299,54 +1705,33 @@ void Apply_font_override(BubbleAnnotation &bubble,
         }
         runs.push_back(TextRun{std::move(text), {}});
     } else {
-        Json const &spans = Json_member(object, "spans");
-        if (spans.JSON_type() != JsonClass::Array) {
+        auto const &spans = Json_member(object, "spans");
+        if (Json_class(spans) != JsonClass::Array) {
             state.Fail(Join_path(path, "spans"), L"must be an array.");
             return false;
         }
-        if (spans.length() == 0) {
+        if (Json_length(spans) == 0) {
             state.Fail(Join_path(path, "spans"), L"must not be empty.");
             return false;
         }
-        runs.reserve(spans.length());
-        for (size_t index = 0; index < spans.length(); ++index) {
-            Json const &span = Json_element(spans, index);
-            std::wstring const span_path = Join_index(Join_path(path, "spans"), index);
-            if (span.JSON_type() != JsonClass::Object) {
-                state.Fail(span_path, L"must be an object.");
-                return false;
-            }
-            Report_unknown_keys(span, kTextSpanKeys, span_path, state);
-            if (!state.result.error_message.empty()) {
-                return false;
-            }
-
-            std::wstring text = {};
-            if (!Try_parse_string_property(span, "text", span_path, text, state)) {
-                return false;
-            }
-            text = Normalize_text_newlines(text);
-            if (text.empty()) {
-                state.Fail(Join_path(span_path, "text"), L"must not be empty.");
-                return false;
-            }
-
-            TextStyleFlags flags{};
-            if (!Try_parse_bool_property(span, "bold", span_path, flags.bold, state) ||
-                !Try_parse_bool_property(span, "italic", span_path, flags.italic,
-                                         state) ||
-                !Try_parse_bool_property(span, "underline", span_path, flags.underline,
-                                         state) ||
-                !Try_parse_bool_property(span, "strikethrough", span_path,
-                                         flags.strikethrough, state)) {
-                return false;
-            }
-
-            if (!runs.empty() && runs.back().flags == flags) {
-                runs.back().text += text;
-            } else {
-                runs.push_back(TextRun{std::move(text), flags});
-            }
+        runs.reserve(Json_length(spans));
+        std::wstring const spans_path = Join_path(path, "spans");
+        bool const parsed =
+            For_each_json_element(spans, [&](auto const &span, size_t index) {
+                TextRun run{};
+                if (!Try_parse_text_span(span, Join_index(spans_path, index), state,
+                                         run)) {
+                    return false;
+                }
+                if (!runs.empty() && runs.back().flags == run.flags) {
+                    runs.back().text += run.text;
+                } else {
+                    runs.push_back(std::move(run));
+                }
+                return true;
+            });
+        if (!parsed) {
+            return false;
         }
     }
 
@@ -1369,7 +1754,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_bubble(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_bubble(Value const &object, std::wstring_view path,
                                     ParseState &state, Annotation &out) {
     std::optional<COLORREF> annotation_color = std::nullopt;
     std::optional<FontSpec> annotation_font = std::nullopt;
@@ -1408,9 +1794,10 @@ void Apply_font_override(BubbleAnnotation &bubble,
     return true;
 }
 
-[[nodiscard]] bool Try_parse_annotation(Json const &object, std::wstring_view path,
+template <typename Value>
+[[nodiscard]] bool Try_parse_annotation(Value const &object, std::wstring_view path,
                                         ParseState &state, Annotation &out) {
-    if (object.JSON_type() != JsonClass::Object) {
+    if (Json_class(object) != JsonClass::Object) {
         state.Fail(path, L"must be an object.");
         return false;
     }
@@ -1418,8 +1805,8 @@ void Apply_font_override(BubbleAnnotation &bubble,
         state.Fail(path, L"must contain \"type\".");
         return false;
     }
-    Json const &type_value = Json_member(object, "type");
-    if (type_value.JSON_type() != JsonClass::String) {
+    auto const &type_value = Json_member(object, "type");
+    if (Json_class(type_value) != JsonClass::String) {
         state.Fail(Join_path(path, "type"), L"must be a string.");
         return false;
     }
@@ -1502,67 +1889,42 @@ void Assign_bubble_numbers(std::vector<Annotation> &annotations) {
     }
 }
 
-} // namespace
-
-CliAnnotationInputKind Classify_cli_annotation_input(std::wstring_view value) noexcept {
-    size_t index = 0;
-    while (index < value.size() && std::iswspace(value[index]) != 0) {
-        ++index;
-    }
-    if (index < value.size() && value[index] == L'{') {
-        return CliAnnotationInputKind::InlineJson;
-    }
-    return CliAnnotationInputKind::FilePath;
-}
-
-std::array<std::wstring, 4> Resolve_text_font_families(AppConfig const &config) {
-    return {{config.text_font_sans, config.text_font_serif, config.text_font_mono,
-             config.text_font_art}};
-}
-
-CliAnnotationParseResult
-Parse_cli_annotations_json(std::string_view json_text,
-                           CliAnnotationParseContext const &context) noexcept {
+[[nodiscard]] ParseState Make_parse_state(CliAnnotationParseContext const &context) {
     ParseState state{};
     state.config = context.config;
     state.capture_rect_screen = context.capture_rect_screen;
     state.virtual_desktop_bounds = context.virtual_desktop_bounds;
     state.target_kind = context.target_kind;
-
     if (state.config == nullptr) {
         state.Fail(kRootPath, L"internal annotation parse context is missing config.");
-        return state.result;
-    }
-
-    std::wstring const syntax_error = JsonSyntaxChecker(json_text).Check_error();
-    if (!syntax_error.empty()) {
-        state.Fail(kRootPath, syntax_error);
-        return state.result;
     }
+    return state;
+}
 
-    Json const root = Load_json_silently(json_text);
-    if (root.JSON_type() != JsonClass::Object) {
+template <typename Value>
+void Parse_annotation_document(Value const &root, ParseState &state) {
+    if (Json_class(root) != JsonClass::Object) {
         state.Fail(kRootPath, L"top-level JSON value must be an object.");
-        return state.result;
+        return;
     }
 
     Report_unknown_keys(root, kRootKeys, kRootPath, state);
     if (!state.result.error_message.empty()) {
-        return state.result;
+        return;
     }
 
     if (Has_json_key(root, "$schema") &&
-        Json_member(root, "$schema").JSON_type() != JsonClass::String) {
+        Json_class(Json_member(root, "$schema")) != JsonClass::String) {
         state.Fail(Join_path(kRootPath, "$schema"), L"must be a string.");
-        return state.result;
+        return;
     }
 
     if (Has_json_key(root, "coordinate_space")) {
-        Json const &coordinate_space_value = Json_member(root, "coordinate_space");
-        if (coordinate_space_value.JSON_type() != JsonClass::String) {
+        auto const &coordinate_space_value = Json_member(root, "coordinate_space");
+        if (Json_class(coordinate_space_value) != JsonClass::String) {
             state.Fail(Join_path(kRootPath, "coordinate_space"),
                        L"must be \"local\" or \"global\".");
-            return state.result;
+            return;
         }
         std::string const coordinate_space = Get_json_string(coordinate_space_value);
         if (coordinate_space == "local") {
@@ -1571,13 +1933,13 @@ Parse_cli_annotations_json(std::string_view json_text,
             if (state.target_kind == CliAnnotationTargetKind::InputImage) {
                 state.Fail(Join_path(kRootPath, "coordinate_space"),
                            L"\"global\" is not supported with --input.");
-                return state.result;
+                return;
             }
             state.coordinate_space = CoordinateSpace::Global;
         } else {
             state.Fail(Join_path(kRootPath, "coordinate_space"),
                        L"must be \"local\" or \"global\".");
-            return state.result;
+            return;
         }
     }
 
@@ -1588,36 +1950,113 @@ Parse_cli_annotations_json(std::string_view json_text,
                                     state) ||
         !Try_parse_optional_font_property(root, "font", kRootPath, state.defaults.font,
                                           state)) {
-        return state.result;
+        return;
     }
 
     if (!Has_json_key(root, "annotations")) {
         state.Fail(Join_path(kRootPath, "annotations"), L"is required.");
-        return state.result;
+        return;
     }
-    Json const &annotations = Json_member(root, "annotations");
-    if (annotations.JSON_type() != JsonClass::Array) {
+    auto const &annotations = Json_member(root, "annotations");
+    if (Json_class(annotations) != JsonClass::Array) {
         state.Fail(Join_path(kRootPath, "annotations"), L"must be an array.");
-        return state.result;
+        return;
     }
 
     std::vector<Annotation> translated = {};
-    translated.reserve(annotations.length());
-    for (size_t index = 0; index < annotations.length(); ++index) {
-        Annotation annotation{};
-        annotation.id = static_cast<uint64_t>(index + 1);
-        if (!Try_parse_annotation(
-                Json_element(annotations, index),
-                Join_index(Join_path(kRootPath, "annotations"), index), state,
-                annotation)) {
-            return state.result;
-        }
-        translated.push_back(std::move(annotation));
+    translated.reserve(Json_length(annotations));
+    std::wstring const annotations_path = Join_path(kRootPath, "annotations");
+    bool const parsed =
+        For_each_json_element(annotations, [&](auto const &element, size_t index) {
+            Annotation annotation{};
+            annotation.id = static_cast<uint64_t>(index + 1);
+            if (!Try_parse_annotation(element, Join_index(annotations_path, index),
+                                      state, annotation)) {
+                return false;
+            }
+            translated.push_back(std::move(annotation));
+            return true;
+        });
+    if (!parsed) {
+        return;
     }
 
     Assign_bubble_numbers(translated);
     state.result.annotations = std::move(translated);
     state.result.ok = true;
+}
+
+} // namespace
+
+CliAnnotationInputKind Classify_cli_annotation_input(std::wstring_view value) noexcept {
+    size_t index = 0;
+    while (index < value.size() && std::iswspace(value[index]) != 0) {
+        ++index;
+    }
+    if (index < value.size() && value[index] == L'{') {
+        return CliAnnotationInputKind::InlineJson;
+    }
+    size_t end = value.size();
+    while (end > index && std::iswspace(value[end - 1]) != 0) {
+        --end;
+    }
+    size_t const extension_size = kCliAnnotationDocumentExtension.size();
+    if (end - index > extension_size &&
+        Equals_no_case(value.substr(end - extension_size, extension_size),
+                       kCliAnnotationDocumentExtension)) {
+        return CliAnnotationInputKind::DocumentPath;
+    }
+    return CliAnnotationInputKind::FilePath;
+}
+
+std::array<std::wstring, 4> Resolve_text_font_families(AppConfig const &config) {
+    return {{config.text_font_sans, config.text_font_serif, config.text_font_mono,
+             config.text_font_art}};
+}
+
+CliAnnotationParseResult
+Parse_cli_annotations_json(std::string_view json_text,
+                           CliAnnotationParseContext const &context) noexcept {
+    if (json_text.size() > std::numeric_limits<uint32_t>::max()) {
+        // Tape offsets are 32-bit.
+        return Parse_cli_annotations_json_dom(json_text, context);
+    }
+
+    ParseState state = Make_parse_state(context);
+    if (state.config == nullptr) {
+        return state.result;
+    }
+
+    // Syntax checking and tokenizing share one pass over the input; the
+    // validators then walk the flat tape instead of an easyjson DOM.
+    std::vector<JsonTapeToken> tape = {};
+    tape.reserve(json_text.size() / kEstimatedBytesPerTapeToken);
+    std::wstring const syntax_error = JsonSyntaxChecker(json_text, &tape).Check_error();
+    if (!syntax_error.empty()) {
+        state.Fail(kRootPath, syntax_error);
+        return state.result;
+    }
+
+    Parse_annotation_document(JsonTapeValue{json_text, tape, 0}, state);
+    return state.result;
+}
+
+CliAnnotationParseResult
+Parse_cli_annotations_json_dom(std::string_view json_text,
+                               CliAnnotationParseContext const &context) noexcept {
+    ParseState state = Make_parse_state(context);
+    if (state.config == nullptr) {
+        return state.result;
+    }
+
+    std::wstring const syntax_error = JsonSyntaxChecker(json_text).Check_error();
+    if (!syntax_error.empty()) {
+        state.Fail(kRootPath, syntax_error);
+        return state.result;
+    }
+
+    Json const root = Load_json_silently(json_text);
+    Parse_annotation_document(root, state);
     return state.result;
 }
 
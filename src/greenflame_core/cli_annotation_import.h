@@ -5,9 +5,16 @@
 
 namespace greenflame::core {
 
+// File name extension of prepared binary annotation documents
+// (annotation_binary.h) accepted by --annotate and written by --save-annotations.
+inline constexpr std::wstring_view kCliAnnotationDocumentExtension = L".gfa";
+
 enum class CliAnnotationInputKind : uint8_t {
     InlineJson = 0,
     FilePath = 1,
+    // A path ending in kCliAnnotationDocumentExtension: already prepared, so it
+    // skips JSON parsing and annotation preparation.
+    DocumentPath = 2,
 };
 
 enum class CliAnnotationTargetKind : uint8_t {
@@ -43,4 +50,11 @@ struct CliAnnotationParseResult final {
 Parse_cli_annotations_json(std::string_view json_text,
                            CliAnnotationParseContext const &context) noexcept;
 
+// Reference parser that loads an easyjson DOM before validating. Produces the
+// same result as Parse_cli_annotations_json(), which validates a flat token
+// tape recorded during the syntax check instead.
+[[nodiscard]] CliAnnotationParseResult
+Parse_cli_annotations_json_dom(std::string_view json_text,
+                               CliAnnotationParseContext const &context) noexcept;
+
 } // namespace greenflame::core
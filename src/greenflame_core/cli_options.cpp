@@ -1,5 +1,7 @@
 #include "greenflame_core/cli_options.h"
+#include "greenflame_core/save_image_policy.h"
 #include "greenflame_core/selection_wheel.h"
+#include "greenflame_core/trace_recorder.h"
 
 namespace greenflame::core {
 
@@ -26,6 +28,10 @@ enum class CliOptionId : uint8_t {
 #ifdef DEBUG
     Testing12 = 17,
 #endif
+#if defined(GREENFLAME_ENABLE_TRACE_RECORDER) && GREENFLAME_ENABLE_TRACE_RECORDER
+    TraceOutput = 18,
+#endif
+    SaveAnnotations = 19,
 };
 
 enum class CliOptionValueKind : uint8_t {
@@ -57,7 +63,8 @@ constexpr CliOptionSpec kCliOptionSpecs[] = {
     {
         L"region",
         L"<x,y,w,h>",
-        L"Capture an explicit physical-pixel region.",
+        L"Capture an explicit physical-pixel region. Repeat with one --output "
+        L"per region to save several crops of a single desktop grab.",
         L'r',
         CliOptionId::Region,
         CliOptionValueKind::Region,
@@ -139,7 +146,8 @@ constexpr CliOptionSpec kCliOptionSpecs[] = {
     {
         L"output",
         L"<path>",
-        L"Output file path. Valid only with a live capture source or --input.",
+        L"Output file path, or - to write the image to standard output. Valid "
+        L"only with a live capture source or --input.",
         L'o',
         CliOptionId::Output,
         CliOptionValueKind::Path,
@@ -181,13 +189,25 @@ constexpr CliOptionSpec kCliOptionSpecs[] = {
     {
         L"annotate",
         L"<json|path>",
-        L"Apply JSON-defined annotations to the saved CLI render result.",
+        L"Apply JSON-defined annotations to the saved CLI render result. A .gfa "
+        L"path loads annotations written by --save-annotations.",
         L'\0',
         CliOptionId::Annotate,
         CliOptionValueKind::String,
         CliOptionGroup::Optional,
         false,
     },
+    {
+        L"save-annotations",
+        L"<path>",
+        L"Also write the prepared --annotate annotations to <path> as a binary .gfa "
+        L"document, which later --annotate runs reload without re-rendering text.",
+        L'\0',
+        CliOptionId::SaveAnnotations,
+        CliOptionValueKind::Path,
+        CliOptionGroup::Optional,
+        false,
+    },
     {
         L"window-capture",
         L"<auto|gdi|wgc>",
@@ -229,6 +249,19 @@ constexpr CliOptionSpec kCliOptionSpecs[] = {
         CliOptionGroup::Optional,
         false,
     },
+#if defined(GREENFLAME_ENABLE_TRACE_RECORDER) && GREENFLAME_ENABLE_TRACE_RECORDER
+    {
+        L"trace-output",
+        L"<path>",
+        L"Record profiling scopes during this invocation and write them to <path> "
+        L"as Chrome trace-event JSON.",
+        L'\0',
+        CliOptionId::TraceOutput,
+        CliOptionValueKind::Path,
+        CliOptionGroup::Optional,
+        false,
+    },
+#endif
 #ifdef DEBUG
     {
         L"testing-1-2",
@@ -651,6 +684,17 @@ Find_option_by_short_name(wchar_t name, bool debug_build) noexcept {
             return Make_error(L"--region expects one value x,y,w,h with x>=0, y>=0, "
                               L"w>0, and h>0.");
         }
+        if (options.capture_mode == CliCaptureMode::Region) {
+            auto const slot = std::ranges::find_if(
+                options.additional_regions,
+                [](CliRegionOutput const &pair) { return pair.region_px.Is_empty(); });
+            if (slot != options.additional_regions.end()) {
+                slot->region_px = region;
+            } else {
+                options.additional_regions.push_back({region, {}});
+            }
+            return CliParseResult{{}, options, true};
+        }
         if (!Try_set_capture_mode(options, CliCaptureMode::Region, error_message)) {
             return Make_error(error_message);
         }
@@ -717,10 +761,20 @@ Find_option_by_short_name(wchar_t name, bool debug_build) noexcept {
         if (value.empty()) {
             return Make_error(L"--output expects a non-empty path.");
         }
-        if (!options.output_path.empty()) {
-            return Make_error(L"--output can only be specified once.");
+        if (options.output_path.empty()) {
+            options.output_path = value;
+            return CliParseResult{{}, options, true};
+        }
+        // Only repeated --region accepts more outputs; validation checks that.
+        if (auto const slot = std::ranges::find_if(options.additional_regions,
+                                                   [](CliRegionOutput const &pair) {
+                                                       return pair.output_path.empty();
+                                                   });
+            slot != options.additional_regions.end()) {
+            slot->output_path = value;
+        } else {
+            options.additional_regions.push_back({{}, value});
         }
-        options.output_path = value;
         return CliParseResult{{}, options, true};
     case CliOptionId::Format: {
         CliOutputFormat format = CliOutputFormat::Png;
@@ -768,6 +822,15 @@ Find_option_by_short_name(wchar_t name, bool debug_build) noexcept {
         }
         options.annotate_value = value;
         return CliParseResult{{}, options, true};
+    case CliOptionId::SaveAnnotations:
+        if (value.empty()) {
+            return Make_error(L"--save-annotations expects a non-empty path.");
+        }
+        if (!options.save_annotations_path.empty()) {
+            return Make_error(L"--save-annotations can only be specified once.");
+        }
+        options.save_annotations_path = value;
+        return CliParseResult{{}, options, true};
     case CliOptionId::WindowCapture: {
         WindowCaptureBackend backend = WindowCaptureBackend::Auto;
         if (!Try_parse_window_capture_backend(value, backend)) {
@@ -805,12 +868,44 @@ Find_option_by_short_name(wchar_t name, bool debug_build) noexcept {
     case CliOptionId::Testing12:
         options.testing_1_2 = true;
         return CliParseResult{{}, options, true};
+#endif
+#if defined(GREENFLAME_ENABLE_TRACE_RECORDER) && GREENFLAME_ENABLE_TRACE_RECORDER
+    case CliOptionId::TraceOutput:
+        if (value.empty()) {
+            return Make_error(L"--trace-output expects a non-empty path.");
+        }
+        if (!options.trace_output_path.empty()) {
+            return Make_error(L"--trace-output can only be specified once.");
+        }
+        options.trace_output_path = value;
+        return CliParseResult{{}, options, true};
 #endif
     }
     return Make_error(L"Internal CLI parser error.");
 }
 
 [[nodiscard]] CliParseResult Validate_cli_options(CliOptions const &options) {
+    if (!options.additional_regions.empty()) {
+        if (options.capture_mode != CliCaptureMode::Region) {
+            return Make_error(L"--output can only be specified once.");
+        }
+        if (options.output_path.empty() ||
+            std::ranges::any_of(options.additional_regions,
+                                [](CliRegionOutput const &pair) {
+                                    return pair.region_px.Is_empty() ||
+                                           pair.output_path.empty();
+                                })) {
+            return Make_error(L"Repeated --region values need one --output each, "
+                              L"paired in order.");
+        }
+        if (Is_stdout_output_path(options.output_path) ||
+            std::ranges::any_of(options.additional_regions,
+                                [](CliRegionOutput const &pair) {
+                                    return Is_stdout_output_path(pair.output_path);
+                                })) {
+            return Make_error(L"--output - cannot be used with repeated --region.");
+        }
+    }
     if (!options.output_path.empty() && !Has_cli_render_source(options)) {
         return Make_error(L"--output requires one render source: --region, --window, "
                           L"--window-hwnd, --monitor, --desktop, or --input.");
@@ -833,6 +928,11 @@ Find_option_by_short_name(wchar_t name, bool debug_build) noexcept {
                           L"--region, --window, --window-hwnd, --monitor, or "
                           L"--desktop.");
     }
+    if (!options.trace_output_path.empty() && !Has_cli_render_source(options)) {
+        return Make_error(L"--trace-output requires one render source: --region, "
+                          L"--window, --window-hwnd, --monitor, --desktop, or "
+                          L"--input.");
+    }
     if (options.annotate_value.has_value() && !Has_cli_render_source(options)) {
         return Make_error(L"--annotate requires one render source: --region, --window, "
                           L"--window-hwnd, --monitor, --desktop, or --input.");
@@ -840,10 +940,16 @@ Find_option_by_short_name(wchar_t name, bool debug_build) noexcept {
     if (!options.input_path.empty() && !options.annotate_value.has_value()) {
         return Make_error(L"--input requires --annotate.");
     }
+    if (!options.save_annotations_path.empty() && !options.annotate_value.has_value()) {
+        return Make_error(L"--save-annotations requires --annotate.");
+    }
     if (!options.input_path.empty() && options.output_path.empty() &&
         !options.overwrite_output) {
         return Make_error(L"--input requires either --output or --overwrite.");
     }
+    if (Is_stdout_output_path(options.output_path) && options.overwrite_output) {
+        return Make_error(L"--overwrite cannot be used with --output -.");
+    }
     if (options.window_capture_backend_explicit &&
         options.capture_mode != CliCaptureMode::Window) {
         return Make_error(L"--window-capture requires --window or --window-hwnd.");
@@ -1058,6 +1164,7 @@ std::wstring Build_cli_help_text(bool debug_build) {
     help_text += L"Notes:\n";
     help_text += L"  --option=value and --option value are both supported.\n";
     help_text += L"  No capture mode starts the tray app as usual.\n";
+    help_text += L"  Repeated --region values pair with --output values in order.\n";
     help_text += L"\n";
     return help_text;
 }
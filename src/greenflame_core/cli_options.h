@@ -36,11 +36,19 @@ enum class CliCursorOverride : uint8_t {
            mode == CliCaptureMode::Monitor || mode == CliCaptureMode::Desktop;
 }
 
+// A --region after the first, with the --output paired to it.
+struct CliRegionOutput final {
+    RectPx region_px = {};
+    std::wstring output_path = {};
+};
+
 struct CliOptions final {
     std::wstring input_path = {};
     std::wstring window_name = {};
     std::wstring output_path = {};
     std::optional<std::wstring> annotate_value = std::nullopt;
+    // Where to also write the prepared --annotate annotations as a binary document.
+    std::wstring save_annotations_path = {};
     std::optional<RectPx> region_px = std::nullopt;
     std::optional<InsetsPx> padding_px = std::nullopt;
     std::optional<COLORREF> padding_color_override = std::nullopt;
@@ -53,6 +61,11 @@ struct CliOptions final {
     bool window_capture_backend_explicit = false;
     CliCursorOverride cursor_override = CliCursorOverride::UseConfig;
     bool overwrite_output = false;
+    // Only set in builds with the trace recorder.
+    std::wstring trace_output_path = {};
+    // Repeated --region/--output pairs after the first, paired in order. When
+    // present every region is cropped from one desktop grab.
+    std::vector<CliRegionOutput> additional_regions = {};
 #ifdef DEBUG
     bool testing_1_2 = false;
 #endif
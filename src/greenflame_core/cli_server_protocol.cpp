@@ -0,0 +1,263 @@
+#include "greenflame_core/cli_server_protocol.h"
+
+#include "greenflame_core/app_controller.h"
+
+namespace greenflame::core {
+
+namespace {
+
+enum class CliServerMessageKind : uint8_t {
+    Request = 1,
+    Response = 2,
+};
+
+constexpr size_t kFrameHeaderBytes = 4;
+
+class ByteWriter final {
+  public:
+    void Put_u8(uint8_t value) { bytes_.push_back(value); }
+
+    void Put_u16(uint16_t value) {
+        bytes_.push_back(static_cast<uint8_t>(value & 0xFFu));
+        bytes_.push_back(static_cast<uint8_t>((value >> 8u) & 0xFFu));
+    }
+
+    void Put_u32(uint32_t value) {
+        for (uint32_t shift = 0; shift < 32u; shift += 8u) {
+            bytes_.push_back(static_cast<uint8_t>((value >> shift) & 0xFFu));
+        }
+    }
+
+    void Put_string(std::wstring_view text) {
+        Put_u32(static_cast<uint32_t>(text.size()));
+        for (wchar_t const ch : text) {
+            Put_u16(static_cast<uint16_t>(ch));
+        }
+    }
+
+    void Put_header(CliServerMessageKind kind) {
+        bytes_.insert(bytes_.end(), kCliServerMagic.begin(), kCliServerMagic.end());
+        Put_u16(kCliServerProtocolVersion);
+        Put_u8(static_cast<uint8_t>(kind));
+    }
+
+    [[nodiscard]] std::vector<uint8_t> Take() { return std::move(bytes_); }
+
+  private:
+    std::vector<uint8_t> bytes_ = {};
+};
+
+class ByteReader final {
+  public:
+    explicit ByteReader(std::span<const uint8_t> bytes) noexcept : bytes_(bytes) {}
+
+    [[nodiscard]] bool Read_u8(uint8_t &value) noexcept {
+        if (offset_ >= bytes_.size()) {
+            return false;
+        }
+        value = bytes_[offset_++];
+        return true;
+    }
+
+    [[nodiscard]] bool Read_u16(uint16_t &value) noexcept {
+        uint8_t low = 0;
+        uint8_t high = 0;
+        if (!Read_u8(low) || !Read_u8(high)) {
+            return false;
+        }
+        value = static_cast<uint16_t>(low | (high << 8u));
+        return true;
+    }
+
+    [[nodiscard]] bool Read_u32(uint32_t &value) noexcept {
+        uint32_t result = 0;
+        for (uint32_t shift = 0; shift < 32u; shift += 8u) {
+            uint8_t byte = 0;
+            if (!Read_u8(byte)) {
+                return false;
+            }
+            result |= static_cast<uint32_t>(byte) << shift;
+        }
+        value = result;
+        return true;
+    }
+
+    [[nodiscard]] bool Read_string(std::wstring &text) {
+        uint32_t count = 0;
+        if (!Read_u32(count) || count > Remaining() / 2u) {
+            return false;
+        }
+        text.resize(count);
+        for (wchar_t &ch : text) {
+            uint16_t unit = 0;
+            (void)Read_u16(unit);
+            ch = static_cast<wchar_t>(unit);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool Read_header(CliServerMessageKind kind) noexcept {
+        for (uint8_t const expected : kCliServerMagic) {
+            uint8_t byte = 0;
+            if (!Read_u8(byte) || byte != expected) {
+                return false;
+            }
+        }
+        uint16_t version = 0;
+        uint8_t message_kind = 0;
+        return Read_u16(version) && version == kCliServerProtocolVersion &&
+               Read_u8(message_kind) && message_kind == static_cast<uint8_t>(kind);
+    }
+
+    [[nodiscard]] size_t Remaining() const noexcept { return bytes_.size() - offset_; }
+
+  private:
+    std::span<const uint8_t> bytes_ = {};
+    size_t offset_ = 0;
+};
+
+} // namespace
+
+std::vector<uint8_t> Encode_cli_server_request(CliServerRequest const &request) {
+    ByteWriter writer;
+    writer.Put_header(CliServerMessageKind::Request);
+    writer.Put_string(request.working_directory);
+    writer.Put_u32(static_cast<uint32_t>(request.args.size()));
+    for (std::wstring const &arg : request.args) {
+        writer.Put_string(arg);
+    }
+    return writer.Take();
+}
+
+std::vector<uint8_t> Encode_cli_server_response(CliServerResponse const &response) {
+    ByteWriter writer;
+    writer.Put_header(CliServerMessageKind::Response);
+    writer.Put_string(response.stdout_message);
+    writer.Put_string(response.stderr_message);
+    writer.Put_u8(response.exit_code);
+    return writer.Take();
+}
+
+bool Try_decode_cli_server_request(std::span<const uint8_t> payload,
+                                   CliServerRequest &request) {
+    if (payload.size() > kCliServerMaxPayloadBytes) {
+        return false;
+    }
+    ByteReader reader(payload);
+    CliServerRequest decoded{};
+    uint32_t arg_count = 0;
+    // Every argument takes at least its 4-byte length.
+    if (!reader.Read_header(CliServerMessageKind::Request) ||
+        !reader.Read_string(decoded.working_directory) || !reader.Read_u32(arg_count) ||
+        arg_count > reader.Remaining() / 4u) {
+        return false;
+    }
+    decoded.args.resize(arg_count);
+    for (std::wstring &arg : decoded.args) {
+        if (!reader.Read_string(arg)) {
+            return false;
+        }
+    }
+    if (reader.Remaining() != 0) {
+        return false;
+    }
+    request = std::move(decoded);
+    return true;
+}
+
+bool Try_decode_cli_server_response(std::span<const uint8_t> payload,
+                                    CliServerResponse &response) {
+    if (payload.size() > kCliServerMaxPayloadBytes) {
+        return false;
+    }
+    ByteReader reader(payload);
+    CliServerResponse decoded{};
+    if (!reader.Read_header(CliServerMessageKind::Response) ||
+        !reader.Read_string(decoded.stdout_message) ||
+        !reader.Read_string(decoded.stderr_message) ||
+        !reader.Read_u8(decoded.exit_code) || reader.Remaining() != 0) {
+        return false;
+    }
+    response = std::move(decoded);
+    return true;
+}
+
+bool Write_cli_server_frame(ICliServerStream &stream,
+                            std::span<const uint8_t> payload) {
+    if (payload.size() > kCliServerMaxPayloadBytes) {
+        return false;
+    }
+    uint32_t const size = static_cast<uint32_t>(payload.size());
+    std::array<uint8_t, kFrameHeaderBytes> const header = {
+        static_cast<uint8_t>(size & 0xFFu), static_cast<uint8_t>((size >> 8u) & 0xFFu),
+        static_cast<uint8_t>((size >> 16u) & 0xFFu),
+        static_cast<uint8_t>((size >> 24u) & 0xFFu)};
+    return stream.Write_all(header) && (payload.empty() || stream.Write_all(payload));
+}
+
+bool Read_cli_server_frame(ICliServerStream &stream, std::vector<uint8_t> &payload) {
+    std::array<uint8_t, kFrameHeaderBytes> header = {};
+    if (!stream.Read_exact(header)) {
+        return false;
+    }
+    uint32_t const size = static_cast<uint32_t>(header[0]) |
+                          (static_cast<uint32_t>(header[1]) << 8u) |
+                          (static_cast<uint32_t>(header[2]) << 16u) |
+                          (static_cast<uint32_t>(header[3]) << 24u);
+    if (size > kCliServerMaxPayloadBytes) {
+        return false;
+    }
+    payload.resize(size);
+    return size == 0 || stream.Read_exact(payload);
+}
+
+bool Serve_cli_request(ICliServerStream &stream, ICliRequestHandler &handler) {
+    std::vector<uint8_t> payload = {};
+    CliServerRequest request{};
+    if (!Read_cli_server_frame(stream, payload) ||
+        !Try_decode_cli_server_request(payload, request)) {
+        return false;
+    }
+    CliServerResponse const response = handler.Handle_cli_request(request);
+    return Write_cli_server_frame(stream, Encode_cli_server_response(response));
+}
+
+std::optional<CliServerResponse> Forward_cli_request(ICliServerStream &stream,
+                                                     CliServerRequest const &request) {
+    std::vector<uint8_t> payload = Encode_cli_server_request(request);
+    if (!Write_cli_server_frame(stream, payload)) {
+        return std::nullopt;
+    }
+    CliServerResponse response{};
+    if (!Read_cli_server_frame(stream, payload) ||
+        !Try_decode_cli_server_response(payload, response)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool Is_cli_server_forwardable(CliOptions const &options) noexcept {
+    return options.action == CliAction::None && Has_cli_render_source(options) &&
+           !Is_stdout_output_path(options.output_path) &&
+           options.trace_output_path.empty();
+}
+
+CliServerResponse Run_forwarded_cli_request(AppController &controller,
+                                            CliServerRequest const &request,
+                                            bool debug_build) {
+    CliServerResponse response{};
+    CliParseResult const parse_result = Parse_cli_arguments(request.args, debug_build);
+    if (!parse_result.ok) {
+        response.stderr_message = L"Error: ";
+        response.stderr_message += parse_result.error_message;
+        response.exit_code = To_exit_code(ProcessExitCode::CliArgumentParseFailed);
+        return response;
+    }
+    CliResult const result = controller.Run_cli_capture_mode(parse_result.options);
+    response.stdout_message = result.stdout_message;
+    response.stderr_message = result.stderr_message;
+    response.exit_code = To_exit_code(result.exit_code);
+    return response;
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "greenflame_core/cli_options.h"
+#include "greenflame_core/save_image_policy.h"
+
+namespace greenflame {
+class AppController;
+}
+
+namespace greenflame::core {
+
+// Request/response protocol between a CLI invocation and the resident tray app.
+// Each message is a frame: a little-endian u32 payload length, then the payload.
+// A payload starts with "GFCS", a u16 version and a message kind; strings are a
+// u32 code-unit count followed by UTF-16LE code units.
+inline constexpr std::array<uint8_t, 4> kCliServerMagic = {{'G', 'F', 'C', 'S'}};
+inline constexpr uint16_t kCliServerProtocolVersion = 1;
+inline constexpr size_t kCliServerMaxPayloadBytes = size_t{4} << 20;
+
+// The arguments are forwarded as given and parsed again by the server, so both
+// sides always agree on the resulting CliOptions. Relative paths in them are
+// resolved against `working_directory`.
+struct CliServerRequest final {
+    std::wstring working_directory = {};
+    std::vector<std::wstring> args = {};
+
+    bool operator==(CliServerRequest const &) const noexcept = default;
+};
+
+struct CliServerResponse final {
+    std::wstring stdout_message = {};
+    std::wstring stderr_message = {};
+    uint8_t exit_code = 0;
+
+    bool operator==(CliServerResponse const &) const noexcept = default;
+};
+
+[[nodiscard]] std::vector<uint8_t>
+Encode_cli_server_request(CliServerRequest const &request);
+[[nodiscard]] std::vector<uint8_t>
+Encode_cli_server_response(CliServerResponse const &response);
+// Both decoders reject truncated, trailing, oversized or other-version payloads.
+[[nodiscard]] bool Try_decode_cli_server_request(std::span<const uint8_t> payload,
+                                                 CliServerRequest &request);
+[[nodiscard]] bool Try_decode_cli_server_response(std::span<const uint8_t> payload,
+                                                  CliServerResponse &response);
+
+// A connected byte stream: a named pipe in the app, an in-memory pair in tests.
+class ICliServerStream {
+  public:
+    virtual ~ICliServerStream() = default;
+    // Fills all of `buffer`; false on error or end of stream.
+    [[nodiscard]] virtual bool Read_exact(std::span<uint8_t> buffer) = 0;
+    [[nodiscard]] virtual bool Write_all(std::span<const uint8_t> bytes) = 0;
+};
+
+[[nodiscard]] bool Write_cli_server_frame(ICliServerStream &stream,
+                                          std::span<const uint8_t> payload);
+[[nodiscard]] bool Read_cli_server_frame(ICliServerStream &stream,
+                                         std::vector<uint8_t> &payload);
+
+class ICliRequestHandler {
+  public:
+    virtual ~ICliRequestHandler() = default;
+    [[nodiscard]] virtual CliServerResponse
+    Handle_cli_request(CliServerRequest const &request) = 0;
+};
+
+// Serves one request. An unreadable request gets no response, so the client
+// falls back to running in-process; returns false then or when the response
+// cannot be sent.
+[[nodiscard]] bool Serve_cli_request(ICliServerStream &stream,
+                                     ICliRequestHandler &handler);
+
+// Client side: nullopt when the server did not answer with a valid response.
+[[nodiscard]] std::optional<CliServerResponse>
+Forward_cli_request(ICliServerStream &stream, CliServerRequest const &request);
+
+// Invocations the server can run for a client. Standard output carries image
+// bytes that belong to the client's own stdout, so those stay in-process.
+[[nodiscard]] bool Is_cli_server_forwardable(CliOptions const &options) noexcept;
+
+// Parses and runs a forwarded invocation with the server's controller.
+[[nodiscard]] CliServerResponse
+Run_forwarded_cli_request(AppController &controller, CliServerRequest const &request,
+                          bool debug_build);
+
+} // namespace greenflame::core
@@ -0,0 +1,375 @@
+#include "greenflame_core/content_snap_edges.h"
+
+#include "greenflame_core/parallel_for.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr size_t kSourceBytesPerPixel = 4;
+// Mask bits per pixel: a boundary above it (horizontal edge) or left of it
+// (vertical edge) that survived thinning.
+constexpr uint8_t kHorizontalBoundary = 1u;
+constexpr uint8_t kVerticalBoundary = 2u;
+
+struct TileRect final {
+    int32_t x0 = 0;
+    int32_t y0 = 0;
+    int32_t x1 = 0;
+    int32_t y1 = 0;
+};
+
+void Convert_luma_rows(ContentEdgeSourcePixels const &source, int32_t first_row,
+                       int32_t end_row, ContentEdgeLuma &luma) noexcept {
+    size_t const width = static_cast<size_t>(source.width);
+    for (int32_t y = first_row; y < end_row; ++y) {
+        uint8_t const *in = source.pixels.data() + static_cast<size_t>(y) *
+                                                       source.row_bytes;
+        uint8_t *out = luma.values.data() + static_cast<size_t>(y) * width;
+        // Rec. 601 weights in 8-bit fixed point.
+        for (size_t x = 0; x < width; ++x) {
+            uint8_t const *pixel = in + x * kSourceBytesPerPixel;
+            out[x] = static_cast<uint8_t>((pixel[0] * 29u + pixel[1] * 150u +
+                                           pixel[2] * 77u + 128u) >>
+                                          8u);
+        }
+    }
+}
+
+// Response across the boundary above row `y` for columns [x0, x1):
+// |d(x - 1) + 2 d(x) + d(x + 1)| with d the step from row y - 1 to row y, columns
+// clamped at the sides. Zero outside the image's interior boundaries.
+void Horizontal_response_row(ContentEdgeLuma const &luma, int32_t y, int32_t x0,
+                             int32_t x1, std::vector<int32_t> &steps, int32_t *out) {
+    size_t const count = static_cast<size_t>(x1 - x0);
+    if (y < 1 || y >= luma.height) {
+        std::fill_n(out, count, 0);
+        return;
+    }
+    std::span<const uint8_t> const above = luma.Row(y - 1);
+    std::span<const uint8_t> const below = luma.Row(y);
+    steps.resize(count + 2);
+    for (size_t index = 0; index < steps.size(); ++index) {
+        size_t const x = static_cast<size_t>(std::clamp<int32_t>(
+            x0 - 1 + static_cast<int32_t>(index), 0, luma.width - 1));
+        steps[index] = static_cast<int32_t>(below[x]) - static_cast<int32_t>(above[x]);
+    }
+    int32_t const *s = steps.data();
+    for (size_t index = 0; index < count; ++index) {
+        out[index] = std::abs(s[index] + 2 * s[index + 1] + s[index + 2]);
+    }
+}
+
+// Response across the boundary left of each column in [x0 - 1, x1 + 1) on row `y`,
+// the transpose of Horizontal_response_row. Zero where the column has no left
+// neighbour or lies outside the image.
+void Vertical_response_row(ContentEdgeLuma const &luma, int32_t y, int32_t x0,
+                           int32_t x1, int32_t *out) {
+    std::span<const uint8_t> const above = luma.Row(std::max(y - 1, 0));
+    std::span<const uint8_t> const row = luma.Row(y);
+    std::span<const uint8_t> const below = luma.Row(std::min(y + 1, luma.height - 1));
+    int32_t const first = std::max(x0 - 1, 1);
+    int32_t const end = std::min(x1 + 1, luma.width);
+    std::fill_n(out, static_cast<size_t>(x1 - x0 + 2), 0);
+    for (int32_t x = first; x < end; ++x) {
+        size_t const right = static_cast<size_t>(x);
+        size_t const left = right - 1;
+        int32_t const step = (static_cast<int32_t>(above[right]) - above[left]) +
+                             2 * (static_cast<int32_t>(row[right]) - row[left]) +
+                             (static_cast<int32_t>(below[right]) - below[left]);
+        out[x - (x0 - 1)] = std::abs(step);
+    }
+}
+
+// Marks boundaries inside `tile` whose response reaches the threshold and is a
+// local maximum across the boundary, so a soft edge yields one line.
+void Mark_tile_boundaries(ContentEdgeLuma const &luma, TileRect tile,
+                          int32_t min_gradient, std::vector<uint8_t> &mask) {
+    size_t const columns = static_cast<size_t>(tile.x1 - tile.x0);
+    size_t const rows = static_cast<size_t>(tile.y1 - tile.y0);
+    size_t const width = static_cast<size_t>(luma.width);
+
+    // Horizontal: responses for boundary rows y0 - 1 .. y1.
+    std::vector<int32_t> steps = {};
+    std::vector<int32_t> horizontal((rows + 2) * columns);
+    for (size_t row = 0; row < rows + 2; ++row) {
+        Horizontal_response_row(luma, tile.y0 - 1 + static_cast<int32_t>(row), tile.x0,
+                                tile.x1, steps, horizontal.data() + row * columns);
+    }
+    std::vector<int32_t> vertical(columns + 2);
+    for (size_t row = 0; row < rows; ++row) {
+        int32_t const *previous = horizontal.data() + row * columns;
+        int32_t const *current = previous + columns;
+        int32_t const *next = current + columns;
+        int32_t const y = tile.y0 + static_cast<int32_t>(row);
+        uint8_t *out = mask.data() + static_cast<size_t>(y) * width +
+                       static_cast<size_t>(tile.x0);
+        for (size_t column = 0; column < columns; ++column) {
+            int32_t const value = current[column];
+            bool const keep = value >= min_gradient && value >= previous[column] &&
+                              value > next[column];
+            out[column] = keep ? kHorizontalBoundary : uint8_t{0};
+        }
+
+        // vertical[column + 1] is the response left of tile.x0 + column.
+        Vertical_response_row(luma, y, tile.x0, tile.x1, vertical.data());
+        for (size_t column = 0; column < columns; ++column) {
+            int32_t const value = vertical[column + 1];
+            bool const keep = value >= min_gradient && value >= vertical[column] &&
+                              value > vertical[column + 2];
+            if (keep) {
+                out[column] = static_cast<uint8_t>(out[column] | kVerticalBoundary);
+            }
+        }
+    }
+}
+
+// One run along a line; hits extend it and gaps up to max_gap_px are bridged.
+struct RunState final {
+    int32_t start = -1;
+    int32_t last_hit = -1;
+};
+
+class RunCollector final {
+  public:
+    RunCollector(ContentEdgeSettings const &settings, int32_t line_origin,
+                 int32_t span_origin) noexcept
+        : min_run_(settings.min_run_px), max_gap_(settings.max_gap_px),
+          line_origin_(line_origin), span_origin_(span_origin) {}
+
+    void Step(RunState &run, int32_t line, int32_t position, bool hit) {
+        if (!hit) {
+            return;
+        }
+        if (run.start >= 0 && position - run.last_hit - 1 > max_gap_) {
+            Flush(run, line);
+        }
+        if (run.start < 0) {
+            run.start = position;
+        }
+        run.last_hit = position;
+    }
+
+    void Flush(RunState &run, int32_t line) {
+        if (run.start >= 0 && run.last_hit + 1 - run.start >= min_run_) {
+            segments_.push_back({line_origin_ + line, span_origin_ + run.start,
+                                span_origin_ + run.last_hit + 1});
+        }
+        run = {};
+    }
+
+    [[nodiscard]] std::vector<SnapEdgeSegmentPx> Take_segments() noexcept {
+        return std::move(segments_);
+    }
+
+  private:
+    std::vector<SnapEdgeSegmentPx> segments_ = {};
+    int32_t min_run_ = 0;
+    int32_t max_gap_ = 0;
+    int32_t line_origin_ = 0;
+    int32_t span_origin_ = 0;
+};
+
+// Keeps the longest `max_edges` segments, then orders by line and span so the
+// result does not depend on tile scheduling.
+void Finish_segments(std::vector<SnapEdgeSegmentPx> &segments, size_t max_edges) {
+    auto const by_line = [](SnapEdgeSegmentPx const &a, SnapEdgeSegmentPx const &b) {
+        if (a.line != b.line) {
+            return a.line < b.line;
+        }
+        return a.span_start != b.span_start ? a.span_start < b.span_start
+                                            : a.span_end < b.span_end;
+    };
+    if (segments.size() > max_edges) {
+        std::sort(segments.begin(), segments.end(),
+                  [&](SnapEdgeSegmentPx const &a, SnapEdgeSegmentPx const &b) {
+                      int32_t const a_length = a.span_end - a.span_start;
+                      int32_t const b_length = b.span_end - b.span_start;
+                      return a_length != b_length ? a_length > b_length : by_line(a, b);
+                  });
+        segments.resize(max_edges);
+    }
+    std::sort(segments.begin(), segments.end(), by_line);
+}
+
+[[nodiscard]] std::vector<SnapEdgeSegmentPx>
+Join_bands(std::vector<std::vector<SnapEdgeSegmentPx>> &bands) {
+    std::vector<SnapEdgeSegmentPx> joined = {};
+    for (std::vector<SnapEdgeSegmentPx> &band : bands) {
+        joined.insert(joined.end(), band.begin(), band.end());
+    }
+    return joined;
+}
+
+} // namespace
+
+std::optional<ContentEdgeLuma>
+Build_content_edge_luma(ContentEdgeSourcePixels const &source, size_t max_workers) {
+    if (source.width <= 0 || source.height <= 0 ||
+        source.row_bytes / kSourceBytesPerPixel < static_cast<size_t>(source.width) ||
+        source.pixels.size() / source.row_bytes < static_cast<size_t>(source.height)) {
+        return std::nullopt;
+    }
+    ContentEdgeLuma luma = {};
+    luma.width = source.width;
+    luma.height = source.height;
+    luma.origin = source.origin;
+    luma.values.resize(static_cast<size_t>(source.width) *
+                       static_cast<size_t>(source.height));
+    int32_t const band_rows = kDefaultContentEdgeTilePx;
+    size_t const bands =
+        static_cast<size_t>((source.height + band_rows - 1) / band_rows);
+    Parallel_for(bands, {.max_workers = max_workers}, [&](size_t band) {
+        int32_t const first_row = static_cast<int32_t>(band) * band_rows;
+        Convert_luma_rows(source, first_row,
+                          std::min(first_row + band_rows, source.height), luma);
+    });
+    return luma;
+}
+
+std::optional<SnapEdges>
+Detect_content_snap_edges(ContentEdgeSourcePixels const &source,
+                          ContentEdgeSettings const &settings, size_t max_workers,
+                          std::atomic<bool> const *cancel) {
+    std::optional<ContentEdgeLuma> const luma =
+        Build_content_edge_luma(source, max_workers);
+    if (!luma.has_value()) {
+        return std::nullopt;
+    }
+    return Detect_content_snap_edges_in_luma(*luma, settings, max_workers, cancel);
+}
+
+std::optional<SnapEdges>
+Detect_content_snap_edges_in_luma(ContentEdgeLuma const &luma,
+                                  ContentEdgeSettings const &settings,
+                                  size_t max_workers, std::atomic<bool> const *cancel) {
+    if (luma.width <= 0 || luma.height <= 0 || settings.tile_px <= 0 ||
+        luma.values.size() / static_cast<size_t>(luma.width) <
+            static_cast<size_t>(luma.height)) {
+        return std::nullopt;
+    }
+
+    int32_t const tile_px = settings.tile_px;
+    size_t const tile_columns =
+        static_cast<size_t>((luma.width + tile_px - 1) / tile_px);
+    size_t const tile_rows = static_cast<size_t>((luma.height + tile_px - 1) / tile_px);
+    auto const band_end = [tile_px](size_t band, int32_t extent) {
+        return std::min(static_cast<int32_t>(band + 1) * tile_px, extent);
+    };
+    ParallelForOptions const parallel{.max_workers = max_workers, .cancel = cancel};
+
+    std::vector<uint8_t> mask(luma.values.size());
+    if (!Parallel_for(tile_rows * tile_columns, parallel, [&](size_t index) {
+            size_t const column = index % tile_columns;
+            size_t const row = index / tile_columns;
+            TileRect const tile{static_cast<int32_t>(column) * tile_px,
+                                static_cast<int32_t>(row) * tile_px,
+                                band_end(column, luma.width),
+                                band_end(row, luma.height)};
+            Mark_tile_boundaries(luma, tile, settings.min_gradient, mask);
+        })) {
+        return std::nullopt;
+    }
+
+    // Horizontal runs scan rows in bands of rows; vertical runs walk bands of
+    // columns row by row, keeping one run per column, so both read the mask in
+    // memory order.
+    size_t const width = static_cast<size_t>(luma.width);
+    std::vector<std::vector<SnapEdgeSegmentPx>> horizontal_bands(tile_rows);
+    std::vector<std::vector<SnapEdgeSegmentPx>> vertical_bands(tile_columns);
+    if (!Parallel_for(tile_rows + tile_columns, parallel, [&](size_t index) {
+            if (index < tile_rows) {
+                RunCollector runs(settings, luma.origin.y, luma.origin.x);
+                for (int32_t y = static_cast<int32_t>(index) * tile_px;
+                     y < band_end(index, luma.height); ++y) {
+                    uint8_t const *line = mask.data() + static_cast<size_t>(y) * width;
+                    RunState run = {};
+                    for (int32_t x = 0; x < luma.width; ++x) {
+                        runs.Step(run, y, x, (line[x] & kHorizontalBoundary) != 0);
+                    }
+                    runs.Flush(run, y);
+                }
+                horizontal_bands[index] = runs.Take_segments();
+                return;
+            }
+            size_t const band = index - tile_rows;
+            int32_t const x0 = static_cast<int32_t>(band) * tile_px;
+            int32_t const x1 = band_end(band, luma.width);
+            RunCollector runs(settings, luma.origin.x, luma.origin.y);
+            std::vector<RunState> columns(static_cast<size_t>(x1 - x0));
+            for (int32_t y = 0; y < luma.height; ++y) {
+                uint8_t const *line = mask.data() + static_cast<size_t>(y) * width;
+                for (int32_t x = x0; x < x1; ++x) {
+                    runs.Step(columns[static_cast<size_t>(x - x0)], x, y,
+                              (line[x] & kVerticalBoundary) != 0);
+                }
+            }
+            for (int32_t x = x0; x < x1; ++x) {
+                runs.Flush(columns[static_cast<size_t>(x - x0)], x);
+            }
+            vertical_bands[band] = runs.Take_segments();
+        })) {
+        return std::nullopt;
+    }
+
+    SnapEdges edges = {};
+    edges.horizontal = Join_bands(horizontal_bands);
+    edges.vertical = Join_bands(vertical_bands);
+    Finish_segments(edges.horizontal, settings.max_edges_per_axis);
+    Finish_segments(edges.vertical, settings.max_edges_per_axis);
+    return edges;
+}
+
+ContentSnapEdgeAnalyzer::~ContentSnapEdgeAnalyzer() { Cancel(); }
+
+void ContentSnapEdgeAnalyzer::Start(ContentEdgeLuma luma,
+                                    ContentEdgeSettings settings, size_t max_workers,
+                                    std::function<void()> on_ready) {
+    Cancel();
+    cancel_ = false;
+    auto analyze = [this, luma = std::move(luma), settings, max_workers,
+                    on_ready = std::move(on_ready)]() {
+        std::optional<SnapEdges> edges = std::nullopt;
+        try {
+            edges = Detect_content_snap_edges_in_luma(luma, settings, max_workers,
+                                                      &cancel_);
+        } catch (std::exception const &) {
+            // E.g. bad_alloc for the mask or from a worker: publish no content
+            // edges rather than end the process over an optional feature.
+            edges = SnapEdges{};
+        }
+        if (!edges.has_value()) {
+            return;
+        }
+        {
+            std::scoped_lock lock(mutex_);
+            result_ = std::move(edges);
+        }
+        if (on_ready) {
+            on_ready();
+        }
+    };
+    try {
+        thread_ = std::thread(std::move(analyze));
+    } catch (std::system_error const &) {
+        // No thread: snapping keeps to window and monitor geometry.
+    }
+}
+
+void ContentSnapEdgeAnalyzer::Cancel() {
+    cancel_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    std::scoped_lock lock(mutex_);
+    result_.reset();
+}
+
+std::optional<SnapEdges> ContentSnapEdgeAnalyzer::Take_result() {
+    std::scoped_lock lock(mutex_);
+    std::optional<SnapEdges> result = std::move(result_);
+    result_.reset();
+    return result;
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "greenflame_core/snap_edge_builder.h"
+
+namespace greenflame::core {
+
+inline constexpr int32_t kDefaultContentEdgeTilePx = 256;
+
+// Read-only 32bpp BGRA pixels, `row_bytes` apart. The alpha byte is ignored.
+struct ContentEdgeSourcePixels final {
+    std::span<const uint8_t> pixels = {};
+    size_t row_bytes = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    // Screen position of the top-left pixel; edges are reported in screen space.
+    PointPx origin = {};
+};
+
+// 8-bit Rec. 601 luma of a capture, all the detector reads. It is a copy, so it
+// stays valid when the capture's pixels change later, e.g. under a cursor patch.
+struct ContentEdgeLuma final {
+    std::vector<uint8_t> values = {}; // `width` bytes per row
+    int32_t width = 0;
+    int32_t height = 0;
+    PointPx origin = {};
+
+    [[nodiscard]] std::span<const uint8_t> Row(int32_t y) const noexcept {
+        return std::span<const uint8_t>(values).subspan(
+            static_cast<size_t>(y) * static_cast<size_t>(width),
+            static_cast<size_t>(width));
+    }
+};
+
+struct ContentEdgeSettings final {
+    // Smallest luma step across a boundary, smoothed with the 1-2-1 Sobel weights
+    // along it (0 .. 1020). 128 is a 32-level step, which flat UI borders clear
+    // easily and JPEG-like noise does not.
+    int32_t min_gradient = 128;
+    // Shortest run kept; text strokes and icons stay below it.
+    int32_t min_run_px = 48;
+    // Weaker pixels allowed inside a run (anti-aliasing, dotted borders).
+    int32_t max_gap_px = 2;
+    int32_t tile_px = kDefaultContentEdgeTilePx;
+    // Longest runs kept per axis, so busy images do not flood the snap search.
+    size_t max_edges_per_axis = 4096;
+};
+
+// Finds long horizontal and vertical luma boundaries (panel borders, table lines,
+// button edges) as snap edges: a Sobel-style response across each pixel boundary,
+// thinned to its local maximum, then scanned for runs. A boundary between rows
+// y - 1 and y is a horizontal edge on line y, matching the exclusive right and
+// bottom of rect edges. Tiles run on up to `max_workers` threads of the shared
+// pool (0 or 1 runs on the caller) without changing the result. Returns nullopt
+// for an invalid source or when `cancel` becomes true; it is checked between
+// tiles.
+[[nodiscard]] std::optional<SnapEdges>
+Detect_content_snap_edges(ContentEdgeSourcePixels const &source,
+                          ContentEdgeSettings const &settings, size_t max_workers,
+                          std::atomic<bool> const *cancel = nullptr);
+[[nodiscard]] std::optional<SnapEdges>
+Detect_content_snap_edges_in_luma(ContentEdgeLuma const &luma,
+                                  ContentEdgeSettings const &settings,
+                                  size_t max_workers,
+                                  std::atomic<bool> const *cancel = nullptr);
+
+// The first step of Detect_content_snap_edges on its own, so a caller can take
+// the luma before it changes the pixels. Nullopt for an invalid source.
+[[nodiscard]] std::optional<ContentEdgeLuma>
+Build_content_edge_luma(ContentEdgeSourcePixels const &source, size_t max_workers);
+
+// Runs Detect_content_snap_edges on a background thread so snapping keeps using
+// the edges it has until the analysis lands. `on_ready` is called on that thread
+// after an uncancelled run; Take_result then hands the edges over once. A run
+// that throws yields empty edges; without a thread no result ever arrives.
+class ContentSnapEdgeAnalyzer final {
+  public:
+    ContentSnapEdgeAnalyzer() = default;
+    ~ContentSnapEdgeAnalyzer();
+    ContentSnapEdgeAnalyzer(ContentSnapEdgeAnalyzer const &) = delete;
+    ContentSnapEdgeAnalyzer &operator=(ContentSnapEdgeAnalyzer const &) = delete;
+    ContentSnapEdgeAnalyzer(ContentSnapEdgeAnalyzer &&) = delete;
+    ContentSnapEdgeAnalyzer &operator=(ContentSnapEdgeAnalyzer &&) = delete;
+
+    // Cancels a run still in flight first.
+    void Start(ContentEdgeLuma luma, ContentEdgeSettings settings, size_t max_workers,
+               std::function<void()> on_ready);
+    // Stops the run at its next tile, waits for it and drops any unclaimed result.
+    void Cancel();
+    [[nodiscard]] std::optional<SnapEdges> Take_result();
+
+  private:
+    std::thread thread_ = {};
+    std::atomic<bool> cancel_ = false;
+    std::mutex mutex_ = {};
+    std::optional<SnapEdges> result_ = std::nullopt;
+};
+
+} // namespace greenflame::core
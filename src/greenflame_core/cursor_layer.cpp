@@ -0,0 +1,200 @@
+#include "greenflame_core/cursor_layer.h"
+
+#include "greenflame_core/pixel_ops.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr size_t kBytesPerPixel = 4;
+
+[[nodiscard]] bool Target_is_valid(std::span<const uint8_t> pixels, int32_t width,
+                                   int32_t height, int32_t row_bytes) noexcept {
+    if (width <= 0 || height <= 0 ||
+        static_cast<size_t>(row_bytes) < static_cast<size_t>(width) * kBytesPerPixel) {
+        return false;
+    }
+    return pixels.size() >=
+           static_cast<size_t>(row_bytes) * static_cast<size_t>(height);
+}
+
+[[nodiscard]] size_t Pixel_offset(int32_t x, int32_t y, int32_t row_bytes) noexcept {
+    return static_cast<size_t>(y) * static_cast<size_t>(row_bytes) +
+           static_cast<size_t>(x) * kBytesPerPixel;
+}
+
+} // namespace
+
+bool CursorImage::Is_valid() const noexcept {
+    return bitmap.Is_valid() &&
+           (invert_mask.empty() ||
+            invert_mask.size() == static_cast<size_t>(bitmap.width_px) *
+                                      static_cast<size_t>(bitmap.height_px));
+}
+
+CursorImage Cursor_image_from_black_and_white_renders(std::span<const uint8_t> on_black,
+                                                      std::span<const uint8_t> on_white,
+                                                      int32_t width, int32_t height,
+                                                      int32_t row_bytes,
+                                                      PointPx hotspot_offset_px) {
+    if (!Target_is_valid(on_black, width, height, row_bytes) ||
+        !Target_is_valid(on_white, width, height, row_bytes)) {
+        return {};
+    }
+
+    CursorImage image = {};
+    image.hotspot_offset_px = hotspot_offset_px;
+    image.bitmap.width_px = width;
+    image.bitmap.height_px = height;
+    image.bitmap.row_bytes = width * static_cast<int32_t>(kBytesPerPixel);
+    image.bitmap.premultiplied_bgra.resize(static_cast<size_t>(image.bitmap.row_bytes) *
+                                           static_cast<size_t>(height));
+    std::vector<uint8_t> invert_mask(static_cast<size_t>(width) *
+                                     static_cast<size_t>(height));
+    bool any_inverted = false;
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            size_t const src = Pixel_offset(x, y, row_bytes);
+            size_t const dst = Pixel_offset(x, y, image.bitmap.row_bytes);
+            int black_sum = 0;
+            int white_sum = 0;
+            int coverage_gap = 0; // 255 - alpha
+            for (size_t channel = 0; channel < 3; ++channel) {
+                int const black = on_black[src + channel];
+                int const white = on_white[src + channel];
+                black_sum += black;
+                white_sum += white;
+                coverage_gap = std::max(coverage_gap, white - black);
+            }
+            if (white_sum < black_sum) {
+                invert_mask[static_cast<size_t>(y) * static_cast<size_t>(width) +
+                            static_cast<size_t>(x)] = 1;
+                any_inverted = true;
+                continue;
+            }
+
+            // Over black a premultiplied pixel shows its color; over white it adds
+            // the uncovered share of the background.
+            uint8_t const alpha = static_cast<uint8_t>(255 - coverage_gap);
+            for (size_t channel = 0; channel < 3; ++channel) {
+                image.bitmap.premultiplied_bgra[dst + channel] =
+                    std::min(on_black[src + channel], alpha);
+            }
+            image.bitmap.premultiplied_bgra[dst + 3] = alpha;
+        }
+    }
+    if (any_inverted) {
+        image.invert_mask = std::move(invert_mask);
+    }
+    return image;
+}
+
+void CursorLayer::Set_image(CursorImage image, PointPx hotspot_px) {
+    image_ = std::move(image);
+    hotspot_px_ = hotspot_px;
+    shown_ = false;
+    patch_rect_ = {};
+    patch_.clear();
+}
+
+RectPx CursorLayer::Bounds() const noexcept {
+    if (!Has_image()) {
+        return {};
+    }
+    int32_t const left = hotspot_px_.x - image_.hotspot_offset_px.x;
+    int32_t const top = hotspot_px_.y - image_.hotspot_offset_px.y;
+    return RectPx::From_ltrb(left, top, left + image_.bitmap.width_px,
+                             top + image_.bitmap.height_px);
+}
+
+RectPx CursorLayer::Show(std::span<uint8_t> pixels, int32_t width, int32_t height,
+                         int32_t row_bytes) {
+    if (shown_ || !Has_image() || !Target_is_valid(pixels, width, height, row_bytes)) {
+        return {};
+    }
+
+    RectPx const bounds = Bounds();
+    RectPx const patch_rect =
+        RectPx::Intersect(bounds, RectPx::From_ltrb(0, 0, width, height))
+            .value_or(RectPx{});
+    patch_.clear();
+    if (patch_rect.Is_empty()) {
+        shown_ = true;
+        patch_rect_ = {};
+        return {};
+    }
+
+    // Saved in full before the layer counts as shown: if the allocation throws,
+    // Hide has nothing to restore and the pixels are untouched.
+    size_t const patch_row_bytes =
+        static_cast<size_t>(patch_rect.Width()) * kBytesPerPixel;
+    patch_.resize(patch_row_bytes * static_cast<size_t>(patch_rect.Height()));
+    for (int32_t y = patch_rect.top; y < patch_rect.bottom; ++y) {
+        size_t const src = Pixel_offset(patch_rect.left, y, row_bytes);
+        std::copy_n(pixels.begin() + static_cast<std::ptrdiff_t>(src), patch_row_bytes,
+                    patch_.begin() + static_cast<std::ptrdiff_t>(
+                                         static_cast<size_t>(y - patch_rect.top) *
+                                         patch_row_bytes));
+    }
+    shown_ = true;
+    patch_rect_ = patch_rect;
+
+    BgraBitmap const &bitmap = image_.bitmap;
+    Blend_premultiplied_bitmap_onto_opaque_pixels(
+        pixels, width, height, row_bytes, bitmap.premultiplied_bgra, bitmap.width_px,
+        bitmap.height_px, bitmap.row_bytes, bounds);
+    if (!image_.invert_mask.empty()) {
+        for (int32_t y = patch_rect_.top; y < patch_rect_.bottom; ++y) {
+            for (int32_t x = patch_rect_.left; x < patch_rect_.right; ++x) {
+                size_t const mask_index =
+                    static_cast<size_t>(y - bounds.top) *
+                        static_cast<size_t>(bitmap.width_px) +
+                    static_cast<size_t>(x - bounds.left);
+                if (image_.invert_mask[mask_index] == 0) {
+                    continue;
+                }
+                size_t const offset = Pixel_offset(x, y, row_bytes);
+                for (size_t channel = 0; channel < 3; ++channel) {
+                    pixels[offset + channel] =
+                        static_cast<uint8_t>(255 - pixels[offset + channel]);
+                }
+            }
+        }
+    }
+    return patch_rect_;
+}
+
+RectPx CursorLayer::Hide(std::span<uint8_t> pixels, int32_t width, int32_t height,
+                         int32_t row_bytes) noexcept {
+    if (!shown_) {
+        return {};
+    }
+    shown_ = false;
+    RectPx const restored = patch_rect_;
+    patch_rect_ = {};
+    if (restored.Is_empty() || !Target_is_valid(pixels, width, height, row_bytes) ||
+        restored.right > width || restored.bottom > height) {
+        patch_.clear();
+        return {};
+    }
+
+    size_t const patch_row_bytes =
+        static_cast<size_t>(restored.Width()) * kBytesPerPixel;
+    for (int32_t y = restored.top; y < restored.bottom; ++y) {
+        size_t const dst = Pixel_offset(restored.left, y, row_bytes);
+        std::copy_n(patch_.begin() +
+                        static_cast<std::ptrdiff_t>(
+                            static_cast<size_t>(y - restored.top) * patch_row_bytes),
+                    patch_row_bytes, pixels.begin() + static_cast<std::ptrdiff_t>(dst));
+    }
+    patch_.clear();
+    return restored;
+}
+
+void CursorLayer::Discard_target() noexcept {
+    shown_ = false;
+    patch_rect_ = {};
+    patch_.clear();
+}
+
+} // namespace greenflame::core
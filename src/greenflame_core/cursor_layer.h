@@ -0,0 +1,66 @@
+#pragma once
+
+#include "greenflame_core/obfuscate_raster.h"
+#include "greenflame_core/rect_px.h"
+
+namespace greenflame::core {
+
+// A captured mouse cursor, independent of where it is drawn. Monochrome cursors
+// can invert what is under them instead of covering it; those pixels are kept in
+// invert_mask (one byte per pixel, nonzero inverts) rather than in the bitmap.
+struct CursorImage final {
+    BgraBitmap bitmap = {};
+    std::vector<uint8_t> invert_mask = {}; // empty or width_px * height_px
+    PointPx hotspot_offset_px = {};        // hotspot inside the image
+
+    [[nodiscard]] bool Is_valid() const noexcept;
+    bool operator==(CursorImage const &) const noexcept = default;
+};
+
+// Recovers a CursorImage from the same cursor drawn once over opaque black and
+// once over opaque white (both BGRA, same size and row stride). Where the white
+// render is darker than the black one the cursor inverts the background. Returns
+// an invalid image when the inputs do not describe a cursor.
+[[nodiscard]] CursorImage
+Cursor_image_from_black_and_white_renders(std::span<const uint8_t> on_black,
+                                          std::span<const uint8_t> on_white,
+                                          int32_t width, int32_t height,
+                                          int32_t row_bytes, PointPx hotspot_offset_px);
+
+// Draws a CursorImage into an opaque BGRA target in place, remembering only the
+// pixels it covers so hiding it again restores the target exactly. Toggling costs
+// O(cursor size) and needs no second copy of the target.
+class CursorLayer final {
+  public:
+    // Replaces the image and places its hotspot at hotspot_px in target pixels.
+    // Must not be called while shown.
+    void Set_image(CursorImage image, PointPx hotspot_px);
+
+    [[nodiscard]] bool Has_image() const noexcept { return image_.Is_valid(); }
+    [[nodiscard]] bool Is_shown() const noexcept { return shown_; }
+
+    // Image bounds in target pixels, not clipped to any target.
+    [[nodiscard]] RectPx Bounds() const noexcept;
+
+    // Save the covered pixels and composite the cursor, or write the saved pixels
+    // back. Each returns the rect of target pixels it changed; empty when it was
+    // already in that state or the cursor lies outside the target. Hide expects
+    // the same target Show was given.
+    RectPx Show(std::span<uint8_t> pixels, int32_t width, int32_t height,
+                int32_t row_bytes);
+    RectPx Hide(std::span<uint8_t> pixels, int32_t width, int32_t height,
+                int32_t row_bytes) noexcept;
+
+    // Forgets the saved pixels without writing them back, for when the target
+    // itself is being discarded. The image is kept.
+    void Discard_target() noexcept;
+
+  private:
+    CursorImage image_ = {};
+    PointPx hotspot_px_ = {};
+    bool shown_ = false;
+    RectPx patch_rect_ = {};
+    std::vector<uint8_t> patch_ = {}; // tightly packed BGRA under patch_rect_
+};
+
+} // namespace greenflame::core
@@ -0,0 +1,260 @@
+#include "greenflame_core/export_compositor.h"
+
+#include "greenflame_core/parallel_for.h"
+#include "greenflame_core/pixel_ops.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr uint8_t kOpaqueAlpha = 255;
+
+[[nodiscard]] bool Pixels_cover(size_t available, size_t row_bytes, int32_t width,
+                                int32_t height) noexcept {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    size_t const used_row_bytes = static_cast<size_t>(width) * 4u;
+    if (row_bytes < used_row_bytes) {
+        return false;
+    }
+    size_t const rows_before_last = static_cast<size_t>(height - 1);
+    if (rows_before_last > 0 &&
+        rows_before_last > (std::numeric_limits<size_t>::max() - used_row_bytes) /
+                               row_bytes) {
+        return false;
+    }
+    return available >= rows_before_last * row_bytes + used_row_bytes;
+}
+
+// The bitmap blends read whole layer rows.
+[[nodiscard]] bool Layer_is_valid(ExportLayer const &layer) noexcept {
+    RectPx const bounds = layer.bounds.Normalized();
+    if (bounds.Is_empty() || layer.row_bytes < bounds.Width() * 4) {
+        return false;
+    }
+    size_t const row_bytes = static_cast<size_t>(layer.row_bytes);
+    size_t const rows = static_cast<size_t>(bounds.Height());
+    return rows <= layer.premultiplied_bgra.size() / row_bytes;
+}
+
+void Fill_pixels(std::span<uint8_t> pixels,
+                 std::array<uint8_t, 4> const &color) noexcept {
+    for (size_t offset = 0; offset + 4u <= pixels.size(); offset += 4u) {
+        std::memcpy(&pixels[offset], color.data(), 4u);
+    }
+}
+
+struct TileLayout final {
+    int32_t width = 0;
+    int32_t height = 0;
+    size_t row_bytes = 0;
+    int32_t tile_rows = 0;
+    std::array<uint8_t, 4> fill = {};
+};
+
+void Compose_tile(ExportCompositeSpec const &spec, TileLayout const &layout,
+                  int32_t first_row, int32_t row_count, std::span<uint8_t> tile) {
+    ExportSourcePixels const &source = spec.source;
+    int32_t const source_top = spec.padding_px.top;
+    int32_t const source_bottom = source_top + source.height;
+    size_t const left_bytes = static_cast<size_t>(spec.padding_px.left) * 4u;
+    size_t const source_bytes = static_cast<size_t>(source.width) * 4u;
+
+    for (int32_t row = 0; row < row_count; ++row) {
+        int32_t const y = first_row + row;
+        std::span<uint8_t> const out =
+            tile.subspan(static_cast<size_t>(row) * layout.row_bytes, layout.row_bytes);
+        if (y < source_top || y >= source_bottom) {
+            Fill_pixels(out, layout.fill);
+            continue;
+        }
+        Fill_pixels(out.first(left_bytes), layout.fill);
+        std::span<uint8_t> const copied = out.subspan(left_bytes, source_bytes);
+        std::ranges::copy(source.pixels.subspan(static_cast<size_t>(y - source_top) *
+                                                    source.row_bytes,
+                                                source_bytes),
+                          copied.begin());
+        for (size_t alpha = 3; alpha < copied.size(); alpha += 4u) {
+            copied[alpha] = kOpaqueAlpha;
+        }
+        Fill_pixels(out.subspan(left_bytes + source_bytes), layout.fill);
+    }
+
+    RectPx const tile_rect =
+        RectPx::From_ltrb(0, first_row, layout.width, first_row + row_count);
+    for (ExportLayer const &layer : spec.layers) {
+        RectPx const bounds = layer.bounds.Normalized();
+        if (!RectPx::Intersect(bounds, tile_rect).has_value()) {
+            continue;
+        }
+        RectPx const tile_bounds =
+            RectPx::From_ltrb(bounds.left, bounds.top - first_row, bounds.right,
+                              bounds.bottom - first_row);
+        int const tile_row_bytes = static_cast<int>(layout.row_bytes);
+        if (layer.blend == ExportLayerBlend::Multiply) {
+            Multiply_premultiplied_bitmap_onto_opaque_pixels(
+                tile, layout.width, row_count, tile_row_bytes, layer.premultiplied_bgra,
+                bounds.Width(), bounds.Height(), layer.row_bytes, tile_bounds);
+        } else {
+            Blend_premultiplied_bitmap_onto_opaque_pixels(
+                tile, layout.width, row_count, tile_row_bytes, layer.premultiplied_bgra,
+                bounds.Width(), bounds.Height(), layer.row_bytes, tile_bounds);
+        }
+    }
+}
+
+} // namespace
+
+ImageRowTargetSink::ImageRowTargetSink(ImageRowTarget target) noexcept
+    : target_(target) {}
+
+bool ImageRowTargetSink::Write_rows(int32_t first_row, int32_t row_count,
+                                    std::span<const uint8_t> rows, size_t row_bytes) {
+    if (first_row < 0 || row_count <= 0 || row_bytes == 0 ||
+        target_.row_bytes < row_bytes ||
+        rows.size() < static_cast<size_t>(row_count) * row_bytes ||
+        !Pixels_cover(target_.pixels.size(), target_.row_bytes,
+                      static_cast<int32_t>(row_bytes / 4u), first_row + row_count)) {
+        return false;
+    }
+    for (int32_t row = 0; row < row_count; ++row) {
+        std::ranges::copy(
+            rows.subspan(static_cast<size_t>(row) * row_bytes, row_bytes),
+            target_.pixels.begin() +
+                static_cast<std::ptrdiff_t>(static_cast<size_t>(first_row + row) *
+                                            target_.row_bytes));
+    }
+    return true;
+}
+
+bool Try_get_export_size(ExportCompositeSpec const &spec, int32_t &width,
+                         int32_t &height) noexcept {
+    ExportSourcePixels const &source = spec.source;
+    if (!Pixels_cover(source.pixels.size(), source.row_bytes, source.width,
+                      source.height)) {
+        return false;
+    }
+    int32_t out_width = 0;
+    int32_t out_height = 0;
+    if (!spec.padding_px.Try_expand_size(source.width, source.height, out_width,
+                                         out_height) ||
+        out_width > std::numeric_limits<int32_t>::max() / 4) {
+        return false;
+    }
+    width = out_width;
+    height = out_height;
+    return true;
+}
+
+namespace {
+
+[[nodiscard]] bool Compose_export_tiles(ExportCompositeSpec const &spec,
+                                        ExportCompositeOptions const &options,
+                                        IExportRowSink &sink) {
+    TileLayout layout{};
+    if (!Try_get_export_size(spec, layout.width, layout.height) ||
+        !std::ranges::all_of(spec.layers, Layer_is_valid)) {
+        return false;
+    }
+    layout.row_bytes = static_cast<size_t>(layout.width) * 4u;
+    layout.tile_rows = std::clamp(options.tile_rows, 1, layout.height);
+    layout.fill = {static_cast<uint8_t>((spec.fill_color >> 16u) & 0xFFu),
+                   static_cast<uint8_t>((spec.fill_color >> 8u) & 0xFFu),
+                   static_cast<uint8_t>(spec.fill_color & 0xFFu), kOpaqueAlpha};
+
+    size_t const tile_rows = static_cast<size_t>(layout.tile_rows);
+    size_t const tile_count = (static_cast<size_t>(layout.height) + tile_rows - 1u) /
+                              tile_rows;
+    size_t const workers =
+        std::min(std::max<size_t>(options.max_workers, 1), tile_count);
+    size_t const tile_bytes = layout.row_bytes * tile_rows;
+    if (tile_bytes / layout.row_bytes != tile_rows) {
+        return false;
+    }
+    // Tiles are composed in groups of `workers`. With more than one worker there
+    // are two sets of tile buffers, so the next group is composed while the sink
+    // consumes the current one.
+    size_t const slots = workers == 1 ? 1 : workers * 2;
+    if (slots > std::numeric_limits<size_t>::max() / tile_bytes) {
+        return false;
+    }
+    std::vector<uint8_t> buffer(tile_bytes * slots);
+
+    auto const tile_rows_at = [&](size_t tile) {
+        int32_t const first_row = static_cast<int32_t>(tile) * layout.tile_rows;
+        return std::pair{first_row,
+                         std::min(layout.tile_rows, layout.height - first_row)};
+    };
+    auto const slot_of = [&](size_t tile) { return tile % slots; };
+    auto const compose = [&](size_t tile) {
+        auto const [first_row, row_count] = tile_rows_at(tile);
+        Compose_tile(spec, layout, first_row, row_count,
+                     std::span<uint8_t>(buffer).subspan(
+                         slot_of(tile) * tile_bytes,
+                         static_cast<size_t>(row_count) * layout.row_bytes));
+    };
+    auto const write = [&](size_t tile) {
+        auto const [first_row, row_count] = tile_rows_at(tile);
+        return sink.Write_rows(
+            first_row, row_count,
+            std::span<const uint8_t>(buffer).subspan(
+                slot_of(tile) * tile_bytes,
+                static_cast<size_t>(row_count) * layout.row_bytes),
+            layout.row_bytes);
+    };
+
+    if (workers == 1) {
+        for (size_t tile = 0; tile < tile_count; ++tile) {
+            compose(tile);
+            if (!write(tile)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The caller writes each group while the pool composes the next one. A failed
+    // write cancels the composing that is still queued.
+    std::atomic<bool> write_failed = false;
+    ParallelForOptions const parallel{.max_workers = workers, .cancel = &write_failed};
+    auto const compose_group = [&](size_t group, std::function<void()> const &first) {
+        size_t const end = std::min(group + workers, tile_count);
+        Parallel_for(end - group, parallel,
+                     [&](size_t index) { compose(group + index); }, first);
+    };
+    compose_group(0, {});
+    for (size_t group = 0; group < tile_count; group += workers) {
+        size_t const next = group + workers;
+        auto const write_group = [&] {
+            for (size_t tile = group; tile < std::min(next, tile_count); ++tile) {
+                if (!write(tile)) {
+                    write_failed.store(true);
+                    return;
+                }
+            }
+        };
+        if (next < tile_count) {
+            compose_group(next, write_group);
+        } else {
+            write_group();
+        }
+        if (write_failed.load()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool Compose_export(ExportCompositeSpec const &spec,
+                    ExportCompositeOptions const &options, IExportRowSink &sink) {
+    try {
+        return Compose_export_tiles(spec, options, sink);
+    } catch (std::bad_alloc const &) {
+        return false;
+    }
+}
+
+} // namespace greenflame::core
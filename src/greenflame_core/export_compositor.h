@@ -0,0 +1,89 @@
+#pragma once
+
+#include "greenflame_core/input_image_source.h"
+#include "greenflame_core/rect_px.h"
+
+namespace greenflame::core {
+
+inline constexpr int32_t kDefaultExportTileRows = 64;
+
+// Read-only 32bpp BGRA pixels, `row_bytes` apart, starting at the top-left pixel
+// of the region to export. The alpha byte is ignored: exports are opaque.
+struct ExportSourcePixels final {
+    std::span<const uint8_t> pixels = {};
+    size_t row_bytes = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+};
+
+enum class ExportLayerBlend : uint8_t {
+    SourceOver = 0,
+    // Highlighter strokes.
+    Multiply = 1,
+};
+
+// A premultiplied BGRA bitmap covering `bounds` in output coordinates. Layers may
+// extend past the output; the part outside is ignored.
+struct ExportLayer final {
+    RectPx bounds = {};
+    std::span<const uint8_t> premultiplied_bgra = {};
+    int32_t row_bytes = 0;
+    ExportLayerBlend blend = ExportLayerBlend::SourceOver;
+};
+
+// One export: the source placed inside `padding_px` of `fill_color`, then
+// `layers` applied in order (an opaque cursor patch first, then annotations).
+struct ExportCompositeSpec final {
+    ExportSourcePixels source = {};
+    InsetsPx padding_px = {};
+    COLORREF fill_color = static_cast<COLORREF>(0);
+    std::span<const ExportLayer> layers = {};
+};
+
+struct ExportCompositeOptions final {
+    // Output rows per tile. A tile is a band of whole rows so finished tiles can
+    // be handed to a row-streaming encoder in order.
+    int32_t tile_rows = kDefaultExportTileRows;
+    // Tiles composed concurrently on the shared worker pool; 0 or 1 composes on
+    // the calling thread.
+    size_t max_workers = 1;
+};
+
+// Receives finished opaque BGRA output rows, top to bottom, from the calling
+// thread.
+class IExportRowSink {
+  public:
+    virtual ~IExportRowSink() = default;
+
+    // `rows` holds `row_count` rows of `row_bytes` each, starting at `first_row`.
+    [[nodiscard]] virtual bool Write_rows(int32_t first_row, int32_t row_count,
+                                          std::span<const uint8_t> rows,
+                                          size_t row_bytes) = 0;
+};
+
+// Copies rows into a caller-owned buffer, e.g. a DIB section's bits.
+class ImageRowTargetSink final : public IExportRowSink {
+  public:
+    explicit ImageRowTargetSink(ImageRowTarget target) noexcept;
+
+    [[nodiscard]] bool Write_rows(int32_t first_row, int32_t row_count,
+                                  std::span<const uint8_t> rows,
+                                  size_t row_bytes) override;
+
+  private:
+    ImageRowTarget target_ = {};
+};
+
+// Output size of `spec`; false when the source is invalid or the size overflows.
+[[nodiscard]] bool Try_get_export_size(ExportCompositeSpec const &spec,
+                                       int32_t &width, int32_t &height) noexcept;
+
+// Produces every output tile exactly once: padding fill, source copy, layers and
+// opaque alpha in one pass over a tile-sized buffer, so peak memory is a few
+// tiles rather than several full frames. Returns false on invalid input, on
+// allocation failure or when the sink fails; rows already written stay written.
+[[nodiscard]] bool Compose_export(ExportCompositeSpec const &spec,
+                                  ExportCompositeOptions const &options,
+                                  IExportRowSink &sink);
+
+} // namespace greenflame::core
@@ -0,0 +1,259 @@
+#include "greenflame_core/hdr_tone_map.h"
+
+#include "greenflame_core/parallel_for.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr float kScRgbUnitNits = 80.f; // scRGB 1.0
+constexpr double kPqMaxNits = 10000.0;
+constexpr size_t kHdr10CodeCount = 1024;
+constexpr uint32_t kHdr10CodeMask = 0x3FFu;
+// Linear [0, 1] is looked up at this resolution; fine enough that every 8-bit
+// sRGB code, including the darkest, is reachable.
+constexpr size_t kSrgbTableSteps = 16384;
+constexpr uint8_t kOpaqueAlpha = 255;
+
+// Linear Rec.2020 to linear Rec.709 (ITU-R BT.2087), row-major.
+constexpr std::array<float, 9> kRec2020ToRec709 = {
+    1.6605f,  -0.5876f, -0.0728f, //
+    -0.1246f, 1.1329f,  -0.0083f, //
+    -0.0182f, -0.1006f, 1.1187f,
+};
+
+using SrgbTable = std::array<uint8_t, kSrgbTableSteps + 1>;
+using PqTable = std::array<float, kHdr10CodeCount>;
+
+// Built once with double math; the per-pixel path only indexes it.
+[[nodiscard]] SrgbTable const &Srgb_encode_table() {
+    static SrgbTable const table = [] {
+        SrgbTable values = {};
+        for (size_t index = 0; index < values.size(); ++index) {
+            double const linear =
+                static_cast<double>(index) / static_cast<double>(kSrgbTableSteps);
+            double const encoded = linear <= 0.0031308
+                                       ? linear * 12.92
+                                       : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+            values[index] = static_cast<uint8_t>(std::lround(encoded * 255.0));
+        }
+        return values;
+    }();
+    return table;
+}
+
+// SMPTE ST 2084 (PQ) EOTF per 10-bit code, in nits.
+[[nodiscard]] PqTable const &Pq_nits_table() {
+    static PqTable const table = [] {
+        constexpr double m1 = 2610.0 / 16384.0;
+        constexpr double m2 = 2523.0 / 4096.0 * 128.0;
+        constexpr double c1 = 3424.0 / 4096.0;
+        constexpr double c2 = 2413.0 / 4096.0 * 32.0;
+        constexpr double c3 = 2392.0 / 4096.0 * 32.0;
+        PqTable values = {};
+        for (size_t code = 0; code < values.size(); ++code) {
+            double const signal =
+                std::pow(static_cast<double>(code) /
+                             static_cast<double>(kHdr10CodeCount - 1),
+                         1.0 / m2);
+            double const linear =
+                std::pow(std::max(signal - c1, 0.0) / (c2 - c3 * signal), 1.0 / m1);
+            values[code] = static_cast<float>(linear * kPqMaxNits);
+        }
+        return values;
+    }();
+    return table;
+}
+
+// Settings resolved once per conversion. Values are linear light relative to
+// SDR white.
+struct ToneMapContext final {
+    ToneMapCurve curve = ToneMapCurve::Clip;
+    float white = 1.f; // input level that maps to white
+    float knee = 0.f;
+    float inverse_white_nits = 1.f;
+    SrgbTable const *srgb = nullptr;
+    PqTable const *pq = nullptr;
+
+    [[nodiscard]] float Tone(float value) const noexcept {
+        switch (curve) {
+        case ToneMapCurve::Reinhard:
+            return value * (1.f + value / (white * white)) / (1.f + value);
+        case ToneMapCurve::SoftKnee: {
+            if (value <= knee) {
+                return value;
+            }
+            // Reinhard on the part above the knee; its slope at the knee is 1.
+            float const span = 1.f - knee;
+            float const above = (value - knee) / span;
+            float const above_white = (white - knee) / span;
+            return knee + span * above * (1.f + above / (above_white * above_white)) /
+                              (1.f + above);
+        }
+        case ToneMapCurve::Clip:
+            break;
+        }
+        return std::min(value, 1.f);
+    }
+
+    [[nodiscard]] uint8_t Encode(float linear) const noexcept {
+        float const clamped = std::min(linear, 1.f);
+        return (*srgb)[static_cast<size_t>(
+            clamped * static_cast<float>(kSrgbTableSteps) + 0.5f)];
+    }
+
+    void Write(float red, float green, float blue,
+               std::span<uint8_t> pixel) const noexcept {
+        // NaN and negative (out of gamut) become 0, infinity the white level.
+        red = red > 0.f ? std::min(red, white) : 0.f;
+        green = green > 0.f ? std::min(green, white) : 0.f;
+        blue = blue > 0.f ? std::min(blue, white) : 0.f;
+        float const brightest = std::max({red, green, blue});
+        if (brightest > 0.f) {
+            float const scale = Tone(brightest) / brightest;
+            red *= scale;
+            green *= scale;
+            blue *= scale;
+        }
+        pixel[0] = Encode(blue);
+        pixel[1] = Encode(green);
+        pixel[2] = Encode(red);
+        pixel[3] = kOpaqueAlpha;
+    }
+};
+
+[[nodiscard]] float Half_to_float(uint8_t low, uint8_t high) noexcept {
+    uint32_t const half =
+        static_cast<uint32_t>(low) | (static_cast<uint32_t>(high) << 8u);
+    uint32_t const sign = (half & 0x8000u) << 16u;
+    uint32_t const exponent = (half >> 10u) & 0x1Fu;
+    uint32_t const mantissa = half & 0x3FFu;
+    if (exponent == 0) {
+        float const magnitude = static_cast<float>(mantissa) * 0x1p-24f;
+        return sign != 0 ? -magnitude : magnitude;
+    }
+    uint32_t const bits =
+        sign | (exponent == 0x1Fu ? 0x7F800000u : (exponent + 112u) << 23u) |
+        (mantissa << 13u);
+    float value = 0.f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void Convert_rows(HdrSourcePixels const &source, ToneMapContext const &context,
+                  int32_t first_row, int32_t end_row, ImageRowTarget target) noexcept {
+    size_t const width = static_cast<size_t>(source.width);
+    size_t const source_pixel_bytes = Hdr_bytes_per_pixel(source.format);
+    for (int32_t row = first_row; row < end_row; ++row) {
+        std::span<const uint8_t> const in = source.pixels.subspan(
+            static_cast<size_t>(row) * source.row_bytes, width * source_pixel_bytes);
+        std::span<uint8_t> const out = target.pixels.subspan(
+            static_cast<size_t>(row) * target.row_bytes, width * 4);
+        if (source.format == HdrPixelFormat::ScRgbFloat16) {
+            float const scale = kScRgbUnitNits * context.inverse_white_nits;
+            for (size_t x = 0; x < width; ++x) {
+                std::span<const uint8_t> const pixel = in.subspan(x * 8, 8);
+                context.Write(Half_to_float(pixel[0], pixel[1]) * scale,
+                              Half_to_float(pixel[2], pixel[3]) * scale,
+                              Half_to_float(pixel[4], pixel[5]) * scale,
+                              out.subspan(x * 4, 4));
+            }
+            continue;
+        }
+
+        PqTable const &pq = *context.pq;
+        std::array<float, 9> const &m = kRec2020ToRec709;
+        for (size_t x = 0; x < width; ++x) {
+            std::span<const uint8_t> const pixel = in.subspan(x * 4, 4);
+            uint32_t const packed = static_cast<uint32_t>(pixel[0]) |
+                                    (static_cast<uint32_t>(pixel[1]) << 8u) |
+                                    (static_cast<uint32_t>(pixel[2]) << 16u) |
+                                    (static_cast<uint32_t>(pixel[3]) << 24u);
+            float const r = pq[packed & kHdr10CodeMask] * context.inverse_white_nits;
+            float const g =
+                pq[(packed >> 10u) & kHdr10CodeMask] * context.inverse_white_nits;
+            float const b =
+                pq[(packed >> 20u) & kHdr10CodeMask] * context.inverse_white_nits;
+            context.Write(m[0] * r + m[1] * g + m[2] * b,
+                          m[3] * r + m[4] * g + m[5] * b,
+                          m[6] * r + m[7] * g + m[8] * b, out.subspan(x * 4, 4));
+        }
+    }
+}
+
+[[nodiscard]] bool Try_make_context(HdrToneMapSettings const &settings,
+                                    ToneMapContext &context) {
+    if (!std::isfinite(settings.sdr_white_nits) || settings.sdr_white_nits <= 0.f ||
+        !std::isfinite(settings.peak_nits) || settings.peak_nits <= 0.f ||
+        !std::isfinite(settings.knee) || settings.knee < 0.f || settings.knee >= 1.f) {
+        return false;
+    }
+    context.white = std::max(settings.peak_nits / settings.sdr_white_nits, 1.f);
+    // Without headroom above SDR white there is nothing to roll off.
+    context.curve = context.white > 1.f ? settings.curve : ToneMapCurve::Clip;
+    context.knee = settings.knee;
+    context.inverse_white_nits = 1.f / settings.sdr_white_nits;
+    context.srgb = &Srgb_encode_table();
+    context.pq = &Pq_nits_table();
+    return true;
+}
+
+} // namespace
+
+size_t Hdr_bytes_per_pixel(HdrPixelFormat format) noexcept {
+    return format == HdrPixelFormat::ScRgbFloat16 ? 8 : 4;
+}
+
+bool Convert_hdr_to_srgb(HdrSourcePixels const &source,
+                         HdrToneMapSettings const &settings, size_t max_workers,
+                         ImageRowTarget target) {
+    if (source.width <= 0 || source.height <= 0) {
+        return false;
+    }
+    size_t const width = static_cast<size_t>(source.width);
+    size_t const height = static_cast<size_t>(source.height);
+    if (source.row_bytes / Hdr_bytes_per_pixel(source.format) < width ||
+        target.row_bytes / 4 < width ||
+        source.pixels.size() / source.row_bytes < height ||
+        target.pixels.size() / target.row_bytes < height) {
+        return false;
+    }
+    ToneMapContext context = {};
+    if (!Try_make_context(settings, context)) {
+        return false;
+    }
+
+    size_t const workers = std::clamp<size_t>(max_workers, 1, height);
+    size_t const band_rows = (height + workers - 1) / workers;
+    Parallel_for((height + band_rows - 1) / band_rows, {.max_workers = workers},
+                 [&](size_t band) {
+                     size_t const first_row = band * band_rows;
+                     Convert_rows(source, context, static_cast<int32_t>(first_row),
+                                  static_cast<int32_t>(
+                                      std::min(first_row + band_rows, height)),
+                                  target);
+                 });
+    return true;
+}
+
+std::optional<BgraBitmap> Convert_hdr_to_srgb_bitmap(HdrSourcePixels const &source,
+                                                     HdrToneMapSettings const &settings,
+                                                     size_t max_workers) {
+    if (source.width <= 0 || source.height <= 0) {
+        return std::nullopt;
+    }
+    BgraBitmap bitmap = {};
+    bitmap.width_px = source.width;
+    bitmap.height_px = source.height;
+    bitmap.row_bytes = source.width * 4;
+    bitmap.premultiplied_bgra.resize(static_cast<size_t>(bitmap.row_bytes) *
+                                     static_cast<size_t>(source.height));
+    if (!Convert_hdr_to_srgb(source, settings, max_workers,
+                             {bitmap.premultiplied_bgra,
+                              static_cast<size_t>(bitmap.row_bytes)})) {
+        return std::nullopt;
+    }
+    return bitmap;
+}
+
+} // namespace greenflame::core
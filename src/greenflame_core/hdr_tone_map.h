@@ -0,0 +1,72 @@
+#pragma once
+
+#include "greenflame_core/input_image_source.h"
+#include "greenflame_core/obfuscate_raster.h"
+
+namespace greenflame::core {
+
+// Windows' default SDR content brightness; scRGB 1.0 is defined as this level.
+inline constexpr float kDefaultSdrWhiteNits = 80.f;
+inline constexpr float kDefaultHdrPeakNits = 1000.f;
+inline constexpr float kDefaultToneMapKnee = 0.8f;
+
+enum class HdrPixelFormat : uint8_t {
+    // DXGI_FORMAT_R16G16B16A16_FLOAT: linear scRGB, Rec.709 primaries.
+    ScRgbFloat16 = 0,
+    // DXGI_FORMAT_R10G10B10A2_UNORM carrying HDR10: Rec.2020 primaries, PQ.
+    Hdr10Rgb10A2 = 1,
+};
+
+enum class ToneMapCurve : uint8_t {
+    // Everything at or above SDR white becomes white.
+    Clip = 0,
+    // Extended Reinhard over the whole range: peak_nits reaches white, SDR white
+    // lands well below it.
+    Reinhard = 1,
+    // Exact below `knee` x SDR white, then a Reinhard roll-off that reaches
+    // white at peak_nits. Retains highlight detail, but SDR white itself lands
+    // below white, so white UI turns light gray.
+    SoftKnee = 2,
+};
+
+struct HdrToneMapSettings final {
+    // Clip keeps SDR content, e.g. white window backgrounds, identical to an 8-bit
+    // capture; only levels above SDR white are lost.
+    ToneMapCurve curve = ToneMapCurve::Clip;
+    // Brightness the display gives SDR white, e.g. from the Windows "SDR content
+    // brightness" setting.
+    float sdr_white_nits = kDefaultSdrWhiteNits;
+    // Brightest level worth keeping apart from white; at or below sdr_white_nits
+    // every curve clips.
+    float peak_nits = kDefaultHdrPeakNits;
+    float knee = kDefaultToneMapKnee; // SoftKnee only, fraction of SDR white
+};
+
+// Read-only pixels of `format`, `row_bytes` apart, starting at the top-left pixel.
+struct HdrSourcePixels final {
+    std::span<const uint8_t> pixels = {};
+    size_t row_bytes = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    HdrPixelFormat format = HdrPixelFormat::ScRgbFloat16;
+};
+
+[[nodiscard]] size_t Hdr_bytes_per_pixel(HdrPixelFormat format) noexcept;
+
+// Converts HDR pixels to opaque sRGB BGRA rows in one pass: decode to linear
+// light relative to SDR white, convert to Rec.709, tone map the brightest channel
+// (so hue is kept) and encode through a fixed sRGB table. Bands of rows run on up
+// to `max_workers` threads of the shared pool (0 or 1 converts on the caller);
+// every pixel depends only on its own value, so the output is the same for any
+// worker count. Alpha is ignored: captures are opaque. Returns false on invalid
+// input or settings.
+[[nodiscard]] bool Convert_hdr_to_srgb(HdrSourcePixels const &source,
+                                       HdrToneMapSettings const &settings,
+                                       size_t max_workers, ImageRowTarget target);
+
+// Same conversion into a new tightly packed bitmap.
+[[nodiscard]] std::optional<BgraBitmap>
+Convert_hdr_to_srgb_bitmap(HdrSourcePixels const &source,
+                           HdrToneMapSettings const &settings, size_t max_workers);
+
+} // namespace greenflame::core
@@ -0,0 +1,442 @@
+#include "greenflame_core/image_resample.h"
+
+#include "greenflame_core/parallel_for.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr size_t kBytesPerPixel = 4;
+constexpr int32_t kWeightOne = 1 << kResampleWeightBits;
+constexpr int32_t kWeightRound = 1 << (kResampleWeightBits - 1);
+// Pixels per side of a transpose tile: 32 x 32 x 4 bytes fits comfortably in L1
+// for both the source and the destination tile.
+constexpr int32_t kTransposeTilePx = 32;
+constexpr double kPi = 3.14159265358979323846;
+
+[[nodiscard]] double Filter_support(ResampleFilter filter) noexcept {
+    switch (filter) {
+    case ResampleFilter::Bicubic:
+        return 2.0;
+    case ResampleFilter::Lanczos3:
+        return 3.0;
+    case ResampleFilter::Box:
+        break;
+    }
+    return 0.5;
+}
+
+[[nodiscard]] double Sinc(double x) noexcept {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    double const angle = x * kPi;
+    return std::sin(angle) / angle;
+}
+
+[[nodiscard]] double Filter_value(ResampleFilter filter, double x) noexcept {
+    switch (filter) {
+    case ResampleFilter::Bicubic: {
+        constexpr double a = -0.5;
+        double const t = std::abs(x);
+        if (t < 1.0) {
+            return ((a + 2.0) * t - (a + 3.0)) * t * t + 1.0;
+        }
+        if (t < 2.0) {
+            return ((a * t - 5.0 * a) * t + 8.0 * a) * t - 4.0 * a;
+        }
+        return 0.0;
+    }
+    case ResampleFilter::Lanczos3:
+        return std::abs(x) < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+    case ResampleFilter::Box:
+        break;
+    }
+    return x >= -0.5 && x < 0.5 ? 1.0 : 0.0;
+}
+
+[[nodiscard]] uint8_t Clamp_channel(int32_t accumulated) noexcept {
+    return static_cast<uint8_t>(
+        std::clamp((accumulated + kWeightRound) >> kResampleWeightBits, 0, 255));
+}
+
+// Premultiplied colors may not exceed alpha; negative lobes can push them past.
+void Store_pixel(std::span<uint8_t> out, std::array<int32_t, 4> const &acc) noexcept {
+    uint8_t const alpha = Clamp_channel(acc[3]);
+    out[0] = std::min(Clamp_channel(acc[0]), alpha);
+    out[1] = std::min(Clamp_channel(acc[1]), alpha);
+    out[2] = std::min(Clamp_channel(acc[2]), alpha);
+    out[3] = alpha;
+}
+
+[[nodiscard]] BgraBitmap Make_bitmap(int32_t width, int32_t height) {
+    BgraBitmap bitmap = {};
+    bitmap.width_px = width;
+    bitmap.height_px = height;
+    bitmap.row_bytes = width * static_cast<int32_t>(kBytesPerPixel);
+    bitmap.premultiplied_bgra.resize(static_cast<size_t>(bitmap.row_bytes) *
+                                     static_cast<size_t>(height));
+    return bitmap;
+}
+
+// Splits [0, rows) into contiguous bands, one per worker, run on the shared pool.
+template <typename BandFn>
+void Run_row_bands(int32_t rows, size_t max_workers, BandFn const &band) {
+    size_t const workers =
+        std::clamp<size_t>(max_workers, 1, static_cast<size_t>(rows));
+    int32_t const band_rows =
+        static_cast<int32_t>((static_cast<size_t>(rows) + workers - 1) / workers);
+    size_t const bands = static_cast<size_t>((rows + band_rows - 1) / band_rows);
+    Parallel_for(bands, {.max_workers = workers}, [&](size_t index) {
+        int32_t const first_row = static_cast<int32_t>(index) * band_rows;
+        band(first_row, std::min(first_row + band_rows, rows));
+    });
+}
+
+void Resample_horizontal(BgraBitmap const &source, ResampleAxisWeights const &axis,
+                         size_t max_workers, BgraBitmap &target) {
+    size_t const taps = static_cast<size_t>(axis.taps);
+    Run_row_bands(source.height_px, max_workers, [&](int32_t first, int32_t end) {
+        for (int32_t y = first; y < end; ++y) {
+            std::span<const uint8_t> const in =
+                std::span<const uint8_t>(source.premultiplied_bgra)
+                    .subspan(static_cast<size_t>(y) *
+                                 static_cast<size_t>(source.row_bytes),
+                             static_cast<size_t>(source.width_px) * kBytesPerPixel);
+            std::span<uint8_t> const out =
+                std::span<uint8_t>(target.premultiplied_bgra)
+                    .subspan(static_cast<size_t>(y) *
+                                 static_cast<size_t>(target.row_bytes),
+                             static_cast<size_t>(target.width_px) * kBytesPerPixel);
+            for (size_t x = 0; x < static_cast<size_t>(target.width_px); ++x) {
+                std::span<const int32_t> const weights =
+                    std::span<const int32_t>(axis.weights).subspan(x * taps, taps);
+                std::span<const uint8_t> const pixels = in.subspan(
+                    static_cast<size_t>(axis.first_source[x]) * kBytesPerPixel,
+                    taps * kBytesPerPixel);
+                std::array<int32_t, 4> acc = {};
+                for (size_t tap = 0; tap < taps; ++tap) {
+                    int32_t const weight = weights[tap];
+                    acc[0] += weight * pixels[tap * kBytesPerPixel];
+                    acc[1] += weight * pixels[tap * kBytesPerPixel + 1];
+                    acc[2] += weight * pixels[tap * kBytesPerPixel + 2];
+                    acc[3] += weight * pixels[tap * kBytesPerPixel + 3];
+                }
+                Store_pixel(out.subspan(x * kBytesPerPixel, kBytesPerPixel), acc);
+            }
+        }
+    });
+}
+
+// Accumulates whole source rows, so the inner loop is one multiply-add over a
+// contiguous span that the compiler vectorizes.
+void Resample_vertical(BgraBitmap const &source, ResampleAxisWeights const &axis,
+                       size_t max_workers, BgraBitmap &target) {
+    size_t const taps = static_cast<size_t>(axis.taps);
+    size_t const row_values = static_cast<size_t>(target.width_px) * kBytesPerPixel;
+    Run_row_bands(target.height_px, max_workers, [&](int32_t first, int32_t end) {
+        std::vector<int32_t> acc(row_values);
+        for (int32_t y = first; y < end; ++y) {
+            std::fill(acc.begin(), acc.end(), 0);
+            size_t const weight_offset = static_cast<size_t>(y) * taps;
+            size_t const first_row =
+                static_cast<size_t>(axis.first_source[static_cast<size_t>(y)]);
+            for (size_t tap = 0; tap < taps; ++tap) {
+                int32_t const weight = axis.weights[weight_offset + tap];
+                if (weight == 0) {
+                    continue;
+                }
+                std::span<const uint8_t> const in =
+                    std::span<const uint8_t>(source.premultiplied_bgra)
+                        .subspan((first_row + tap) *
+                                     static_cast<size_t>(source.row_bytes),
+                                 row_values);
+                for (size_t index = 0; index < row_values; ++index) {
+                    acc[index] += weight * in[index];
+                }
+            }
+            std::span<uint8_t> const out =
+                std::span<uint8_t>(target.premultiplied_bgra)
+                    .subspan(static_cast<size_t>(y) *
+                                 static_cast<size_t>(target.row_bytes),
+                             row_values);
+            for (size_t index = 0; index < row_values; index += kBytesPerPixel) {
+                Store_pixel(out.subspan(index, kBytesPerPixel),
+                            {acc[index], acc[index + 1], acc[index + 2],
+                             acc[index + 3]});
+            }
+        }
+    });
+}
+
+[[nodiscard]] std::shared_ptr<const ResampleAxisWeights>
+Axis_weights(ResampleWeightCache *cache, int32_t source_size, int32_t target_size,
+             ResampleFilter filter) {
+    if (cache != nullptr) {
+        return cache->Get(source_size, target_size, filter);
+    }
+    return std::make_shared<const ResampleAxisWeights>(
+        Build_resample_axis_weights(source_size, target_size, filter));
+}
+
+void Copy_pixel(std::span<const uint8_t> source, size_t source_offset,
+                std::span<uint8_t> target, size_t target_offset) noexcept {
+    std::memcpy(&target[target_offset], &source[source_offset], kBytesPerPixel);
+}
+
+} // namespace
+
+bool ResampleAxisWeights::Is_valid() const noexcept {
+    return source_size > 0 && target_size > 0 && taps > 0 &&
+           first_source.size() == static_cast<size_t>(target_size) &&
+           weights.size() ==
+               static_cast<size_t>(target_size) * static_cast<size_t>(taps);
+}
+
+ResampleAxisWeights Build_resample_axis_weights(int32_t source_size,
+                                                int32_t target_size,
+                                                ResampleFilter filter) {
+    if (source_size <= 0 || target_size <= 0) {
+        return {};
+    }
+
+    double const scale =
+        static_cast<double>(source_size) / static_cast<double>(target_size);
+    double const filter_scale = std::max(scale, 1.0);
+    double const support = Filter_support(filter) * filter_scale;
+
+    // Exact (double) weights first, to learn the widest footprint.
+    struct Footprint final {
+        int32_t first = 0;
+        std::vector<double> values = {};
+    };
+    std::vector<Footprint> footprints(static_cast<size_t>(target_size));
+    int32_t taps = 1;
+    for (int32_t x = 0; x < target_size; ++x) {
+        double const center = (static_cast<double>(x) + 0.5) * scale;
+        int32_t const first =
+            std::max(static_cast<int32_t>(center - support + 0.5), 0);
+        int32_t const end = std::clamp(static_cast<int32_t>(center + support + 0.5),
+                                       first + 1, source_size);
+        Footprint &footprint = footprints[static_cast<size_t>(x)];
+        footprint.first = first;
+        double total = 0.0;
+        for (int32_t index = first; index < end; ++index) {
+            double const value = Filter_value(
+                filter, (static_cast<double>(index) + 0.5 - center) / filter_scale);
+            footprint.values.push_back(value);
+            total += value;
+        }
+        if (total == 0.0) {
+            // Degenerate footprint: fall back to the nearest source pixel.
+            std::fill(footprint.values.begin(), footprint.values.end(), 0.0);
+            size_t const nearest = std::min(
+                static_cast<size_t>(std::max(center - static_cast<double>(first), 0.0)),
+                footprint.values.size() - 1);
+            footprint.values[nearest] = 1.0;
+            total = 1.0;
+        }
+        for (double &value : footprint.values) {
+            value /= total;
+        }
+        taps = std::max(taps, end - first);
+    }
+
+    ResampleAxisWeights axis = {};
+    axis.source_size = source_size;
+    axis.target_size = target_size;
+    axis.filter = filter;
+    axis.taps = taps;
+    axis.first_source.resize(static_cast<size_t>(target_size));
+    axis.weights.resize(static_cast<size_t>(target_size) * static_cast<size_t>(taps));
+    for (size_t x = 0; x < footprints.size(); ++x) {
+        Footprint const &footprint = footprints[x];
+        // Shift the window left at the far edge so every tap stays in range.
+        int32_t const first = std::min(footprint.first, source_size - taps);
+        axis.first_source[x] = first;
+        std::span<int32_t> const weights =
+            std::span<int32_t>(axis.weights)
+                .subspan(x * static_cast<size_t>(taps), static_cast<size_t>(taps));
+        size_t const offset = static_cast<size_t>(footprint.first - first);
+        int32_t sum = 0;
+        size_t largest = offset;
+        for (size_t index = 0; index < footprint.values.size(); ++index) {
+            int32_t const weight = static_cast<int32_t>(
+                std::lround(footprint.values[index] * static_cast<double>(kWeightOne)));
+            weights[offset + index] = weight;
+            sum += weight;
+            if (weight > weights[largest]) {
+                largest = offset + index;
+            }
+        }
+        // Rounding residue goes to the dominant tap so flat areas stay exact.
+        weights[largest] += kWeightOne - sum;
+    }
+    return axis;
+}
+
+ResampleWeightCache::ResampleWeightCache(size_t capacity) noexcept
+    : capacity_(std::max<size_t>(capacity, 1)) {}
+
+std::shared_ptr<const ResampleAxisWeights>
+ResampleWeightCache::Get(int32_t source_size, int32_t target_size,
+                         ResampleFilter filter) {
+    {
+        std::lock_guard<std::mutex> const lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            ResampleAxisWeights const &entry = **it;
+            if (entry.source_size == source_size && entry.target_size == target_size &&
+                entry.filter == filter) {
+                std::shared_ptr<const ResampleAxisWeights> found = *it;
+                entries_.erase(it);
+                entries_.push_front(found);
+                return found;
+            }
+        }
+    }
+
+    // Built outside the lock; a racing duplicate is harmless.
+    std::shared_ptr<const ResampleAxisWeights> built =
+        std::make_shared<const ResampleAxisWeights>(
+            Build_resample_axis_weights(source_size, target_size, filter));
+    std::lock_guard<std::mutex> const lock(mutex_);
+    entries_.push_front(built);
+    while (entries_.size() > capacity_) {
+        entries_.pop_back();
+    }
+    return built;
+}
+
+size_t ResampleWeightCache::Size() const {
+    std::lock_guard<std::mutex> const lock(mutex_);
+    return entries_.size();
+}
+
+std::optional<BgraBitmap> Resample_bitmap(BgraBitmap const &source, int32_t width,
+                                          int32_t height, ResampleFilter filter,
+                                          size_t max_workers,
+                                          ResampleWeightCache *cache) {
+    if (!source.Is_valid() || width <= 0 || height <= 0) {
+        return std::nullopt;
+    }
+
+    BgraBitmap horizontal = {};
+    BgraBitmap const *vertical_source = &source;
+    if (width != source.width_px) {
+        std::shared_ptr<const ResampleAxisWeights> const axis =
+            Axis_weights(cache, source.width_px, width, filter);
+        horizontal = Make_bitmap(width, source.height_px);
+        Resample_horizontal(source, *axis, max_workers, horizontal);
+        vertical_source = &horizontal;
+    }
+    if (height == source.height_px) {
+        if (vertical_source == &source) {
+            return source;
+        }
+        return horizontal;
+    }
+
+    std::shared_ptr<const ResampleAxisWeights> const axis =
+        Axis_weights(cache, source.height_px, height, filter);
+    BgraBitmap target = Make_bitmap(width, height);
+    Resample_vertical(*vertical_source, *axis, max_workers, target);
+    return target;
+}
+
+BgraBitmap Rotate_bitmap_quarter_turns(BgraBitmap const &source,
+                                       int32_t quarter_turns) {
+    if (!source.Is_valid()) {
+        return {};
+    }
+    int32_t const turns = ((quarter_turns % 4) + 4) % 4;
+    if (turns == 0) {
+        return source;
+    }
+
+    int32_t const width = source.width_px;
+    int32_t const height = source.height_px;
+    bool const swaps = (turns & 1) != 0;
+    BgraBitmap target = swaps ? Make_bitmap(height, width) : Make_bitmap(width, height);
+    std::span<const uint8_t> const in(source.premultiplied_bgra);
+    std::span<uint8_t> const out(target.premultiplied_bgra);
+    size_t const in_row_bytes = static_cast<size_t>(source.row_bytes);
+    size_t const out_row_bytes = static_cast<size_t>(target.row_bytes);
+    for (int32_t tile_y = 0; tile_y < height; tile_y += kTransposeTilePx) {
+        int32_t const tile_bottom = std::min(tile_y + kTransposeTilePx, height);
+        for (int32_t tile_x = 0; tile_x < width; tile_x += kTransposeTilePx) {
+            int32_t const tile_right = std::min(tile_x + kTransposeTilePx, width);
+            for (int32_t y = tile_y; y < tile_bottom; ++y) {
+                for (int32_t x = tile_x; x < tile_right; ++x) {
+                    int32_t out_x = width - 1 - x; // half turn
+                    int32_t out_y = height - 1 - y;
+                    if (turns == 1) {
+                        out_x = height - 1 - y;
+                        out_y = x;
+                    } else if (turns == 3) {
+                        out_x = y;
+                        out_y = width - 1 - x;
+                    }
+                    Copy_pixel(in,
+                               static_cast<size_t>(y) * in_row_bytes +
+                                   static_cast<size_t>(x) * kBytesPerPixel,
+                               out,
+                               static_cast<size_t>(out_y) * out_row_bytes +
+                                   static_cast<size_t>(out_x) * kBytesPerPixel);
+                }
+            }
+        }
+    }
+    return target;
+}
+
+void ResampleMipPyramid::Reset(BgraBitmap base) {
+    levels_.clear();
+    if (base.Is_valid()) {
+        levels_.push_back(std::move(base));
+    }
+}
+
+bool ResampleMipPyramid::Has_image() const noexcept { return !levels_.empty(); }
+
+BgraBitmap const &ResampleMipPyramid::Base() const noexcept {
+    static BgraBitmap const empty = {};
+    return levels_.empty() ? empty : levels_.front();
+}
+
+size_t ResampleMipPyramid::Level_count() const noexcept { return levels_.size(); }
+
+BgraBitmap const &ResampleMipPyramid::Level_for(int32_t width, int32_t height) {
+    if (levels_.empty()) {
+        return Base();
+    }
+    size_t level = 0;
+    while (true) {
+        BgraBitmap const &current = levels_[level];
+        int32_t const half_width = current.width_px / 2;
+        int32_t const half_height = current.height_px / 2;
+        if (half_width < std::max(width, 1) || half_height < std::max(height, 1)) {
+            return levels_[level];
+        }
+        if (level + 1 == levels_.size()) {
+            std::optional<BgraBitmap> next = Resample_bitmap(
+                current, half_width, half_height, ResampleFilter::Box, 1, &weights_);
+            if (!next.has_value()) {
+                return levels_[level];
+            }
+            levels_.push_back(std::move(*next));
+        }
+        ++level;
+    }
+}
+
+std::optional<BgraBitmap> ResampleMipPyramid::Resample(int32_t width, int32_t height,
+                                                       ResampleFilter filter,
+                                                       size_t max_workers) {
+    if (levels_.empty()) {
+        return std::nullopt;
+    }
+    return Resample_bitmap(Level_for(width, height), width, height, filter,
+                           max_workers, &weights_);
+}
+
+} // namespace greenflame::core
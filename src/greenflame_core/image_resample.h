@@ -0,0 +1,94 @@
+#pragma once
+
+#include "greenflame_core/obfuscate_raster.h"
+
+namespace greenflame::core {
+
+// Axis weights are fixed point with this many fractional bits; every target
+// pixel's weights sum to exactly 1 << kResampleWeightBits.
+inline constexpr int32_t kResampleWeightBits = 14;
+inline constexpr size_t kDefaultResampleWeightCacheCapacity = 16;
+
+enum class ResampleFilter : uint8_t {
+    // Area average when shrinking, nearest neighbour when enlarging.
+    Box = 0,
+    // Catmull-Rom cubic.
+    Bicubic = 1,
+    // Windowed sinc with three lobes; sharpest, with slight ringing.
+    Lanczos3 = 2,
+};
+
+// Contributions of source pixels to each target pixel along one axis. Target
+// pixel `i` reads source pixels first_source[i] .. first_source[i] + taps - 1
+// with weights[i * taps ..]; unused taps carry a zero weight.
+struct ResampleAxisWeights final {
+    int32_t source_size = 0;
+    int32_t target_size = 0;
+    ResampleFilter filter = ResampleFilter::Box;
+    int32_t taps = 0;
+    std::vector<int32_t> first_source = {};
+    std::vector<int32_t> weights = {};
+
+    [[nodiscard]] bool Is_valid() const noexcept;
+};
+
+// Empty (invalid) weights when either size is not positive. When shrinking, the
+// filter is widened by the scale factor so every source pixel contributes.
+[[nodiscard]] ResampleAxisWeights
+Build_resample_axis_weights(int32_t source_size, int32_t target_size,
+                            ResampleFilter filter);
+
+// Thread-safe, bounded cache of axis weights keyed by sizes and filter; the
+// least recently used entry goes first. Repeated zoom steps and the two axes of
+// a square resize share entries.
+class ResampleWeightCache final {
+  public:
+    explicit ResampleWeightCache(
+        size_t capacity = kDefaultResampleWeightCacheCapacity) noexcept;
+
+    [[nodiscard]] std::shared_ptr<const ResampleAxisWeights>
+    Get(int32_t source_size, int32_t target_size, ResampleFilter filter);
+    [[nodiscard]] size_t Size() const;
+
+  private:
+    mutable std::mutex mutex_ = {};
+    std::deque<std::shared_ptr<const ResampleAxisWeights>> entries_ = {};
+    size_t capacity_ = kDefaultResampleWeightCacheCapacity;
+};
+
+// Resamples premultiplied BGRA to `width` x `height` with a horizontal then a
+// vertical pass. Integer math only, and bands of rows run on up to `max_workers`
+// threads (0 or 1 runs on the caller) without changing the result. Colors are
+// clamped to alpha so ringing never produces invalid premultiplied pixels.
+// `cache` may be null. Returns nullopt for an invalid source or size.
+[[nodiscard]] std::optional<BgraBitmap>
+Resample_bitmap(BgraBitmap const &source, int32_t width, int32_t height,
+                ResampleFilter filter, size_t max_workers,
+                ResampleWeightCache *cache = nullptr);
+
+// Rotates clockwise by `quarter_turns` (any integer; negative is
+// counter-clockwise) as a tiled transpose, so both sides stay cache friendly.
+[[nodiscard]] BgraBitmap Rotate_bitmap_quarter_turns(BgraBitmap const &source,
+                                                     int32_t quarter_turns);
+
+// Halving pyramid of one image, built lazily. Downscales resample from the
+// smallest level that still covers the target, which bounds the filter taps and
+// makes repeated zoom steps cheap; enlargements read the base image.
+class ResampleMipPyramid final {
+  public:
+    void Reset(BgraBitmap base);
+    [[nodiscard]] bool Has_image() const noexcept;
+    [[nodiscard]] BgraBitmap const &Base() const noexcept;
+    // Levels built so far, including the base.
+    [[nodiscard]] size_t Level_count() const noexcept;
+    [[nodiscard]] BgraBitmap const &Level_for(int32_t width, int32_t height);
+    [[nodiscard]] std::optional<BgraBitmap> Resample(int32_t width, int32_t height,
+                                                     ResampleFilter filter,
+                                                     size_t max_workers);
+
+  private:
+    std::vector<BgraBitmap> levels_ = {};
+    ResampleWeightCache weights_;
+};
+
+} // namespace greenflame::core
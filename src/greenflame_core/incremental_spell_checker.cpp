@@ -0,0 +1,232 @@
+#include "greenflame_core/incremental_spell_checker.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr wchar_t kParagraphSeparator = L'\n';
+
+[[nodiscard]] size_t Common_prefix_length(std::wstring_view a,
+                                          std::wstring_view b) noexcept {
+    size_t const limit = std::min(a.size(), b.size());
+    size_t length = 0;
+    while (length < limit && a[length] == b[length]) {
+        ++length;
+    }
+    return length;
+}
+
+[[nodiscard]] size_t Common_suffix_length(std::wstring_view a, std::wstring_view b,
+                                          size_t prefix_length) noexcept {
+    size_t const limit = std::min(a.size(), b.size()) - prefix_length;
+    size_t length = 0;
+    while (length < limit && a[a.size() - 1 - length] == b[b.size() - 1 - length]) {
+        ++length;
+    }
+    return length;
+}
+
+} // namespace
+
+IncrementalSpellChecker::IncrementalSpellChecker(ISpellCheckService const *service,
+                                                 size_t max_cached_paragraphs)
+    : service_(service),
+      max_cached_paragraphs_(std::max<size_t>(1, max_cached_paragraphs)) {}
+
+std::span<const SpellError> IncrementalSpellChecker::Update(std::wstring_view text) {
+    (void)Rebuild_paragraphs(text, true);
+    return errors_;
+}
+
+std::vector<SpellCheckJob>
+IncrementalSpellChecker::Begin_update(std::wstring_view text) {
+    return Rebuild_paragraphs(text, false);
+}
+
+bool IncrementalSpellChecker::Complete_job(SpellCheckJob const &job,
+                                           std::vector<SpellError> errors) {
+    bool const current = job.text_version == text_version_;
+    bool changed = false;
+    if (current) {
+        std::wstring_view const text = text_;
+        for (Paragraph &paragraph : paragraphs_) {
+            if (!paragraph.pending ||
+                text.substr(static_cast<size_t>(paragraph.start_utf16),
+                            static_cast<size_t>(paragraph.length_utf16)) !=
+                    job.paragraph_text) {
+                continue;
+            }
+            paragraph.pending = false;
+            paragraph.errors = errors;
+            changed = changed || !errors.empty();
+        }
+    }
+    Store_in_cache(job.paragraph_text, std::move(errors));
+    if (changed) {
+        Merge_errors();
+    }
+    return changed;
+}
+
+std::span<const SpellError> IncrementalSpellChecker::Errors() const noexcept {
+    return errors_;
+}
+
+uint64_t IncrementalSpellChecker::Text_version() const noexcept {
+    return text_version_;
+}
+
+size_t IncrementalSpellChecker::Cached_paragraph_count() const noexcept {
+    return cache_.size();
+}
+
+void IncrementalSpellChecker::Clear() noexcept {
+    ++text_version_;
+    text_.clear();
+    paragraphs_.clear();
+    errors_.clear();
+    cache_.clear();
+}
+
+std::vector<SpellCheckJob>
+IncrementalSpellChecker::Rebuild_paragraphs(std::wstring_view text, bool synchronous) {
+    std::vector<SpellCheckJob> jobs = {};
+    if (service_ == nullptr) {
+        text_.assign(text);
+        paragraphs_.clear();
+        errors_.clear();
+        return jobs;
+    }
+    if (text == text_) {
+        if (synchronous) {
+            // Resolve paragraphs left pending by an earlier Begin_update().
+            for (Paragraph &paragraph : paragraphs_) {
+                if (paragraph.pending) {
+                    paragraph.pending = false;
+                    paragraph.errors = Check_paragraph(text, paragraph);
+                }
+            }
+            Merge_errors();
+        }
+        return jobs;
+    }
+
+    ++text_version_;
+
+    // Only paragraphs touching the edited span [prefix, size - suffix) can have
+    // changed; everything before it is kept as is and everything after it is
+    // shifted by the length delta.
+    size_t const prefix = Common_prefix_length(text_, text);
+    size_t const suffix = Common_suffix_length(text_, text, prefix);
+    int32_t const old_dirty_end = static_cast<int32_t>(text_.size() - suffix);
+    int32_t const new_dirty_end = static_cast<int32_t>(text.size() - suffix);
+    int32_t const shift = new_dirty_end - old_dirty_end;
+
+    std::vector<Paragraph> old_paragraphs = std::move(paragraphs_);
+    paragraphs_ = {};
+
+    int32_t start = 0;
+    size_t old_index = 0;
+    while (true) {
+        size_t const separator =
+            text.find(kParagraphSeparator, static_cast<size_t>(start));
+        int32_t const end = separator == std::wstring_view::npos
+                                ? static_cast<int32_t>(text.size())
+                                : static_cast<int32_t>(separator);
+        Paragraph paragraph{start, end - start};
+
+        // A paragraph ending before the edit (separator included) or starting
+        // after it is unchanged; reuse the previous paragraph's result.
+        bool reused = false;
+        if (end < static_cast<int32_t>(prefix)) {
+            while (old_index < old_paragraphs.size() &&
+                   old_paragraphs[old_index].start_utf16 < start) {
+                ++old_index;
+            }
+            if (old_index < old_paragraphs.size() &&
+                old_paragraphs[old_index].start_utf16 == start &&
+                old_paragraphs[old_index].length_utf16 == paragraph.length_utf16) {
+                paragraph = std::move(old_paragraphs[old_index]);
+                reused = true;
+            }
+        } else if (start > new_dirty_end) {
+            int32_t const old_start = start - shift;
+            while (old_index < old_paragraphs.size() &&
+                   old_paragraphs[old_index].start_utf16 < old_start) {
+                ++old_index;
+            }
+            if (old_index < old_paragraphs.size() &&
+                old_paragraphs[old_index].start_utf16 == old_start &&
+                old_paragraphs[old_index].length_utf16 == paragraph.length_utf16) {
+                paragraph = std::move(old_paragraphs[old_index]);
+                paragraph.start_utf16 = start;
+                reused = true;
+            }
+        }
+
+        if (reused && paragraph.pending) {
+            // Still waiting on a job issued for an older version; reissue it.
+            reused = false;
+            paragraph.pending = false;
+        }
+
+        if (!reused && paragraph.length_utf16 > 0) {
+            std::wstring_view const key =
+                text.substr(static_cast<size_t>(start),
+                            static_cast<size_t>(paragraph.length_utf16));
+            if (auto const cached = cache_.find(std::wstring(key));
+                cached != cache_.end()) {
+                paragraph.errors = cached->second;
+            } else if (synchronous) {
+                paragraph.errors = Check_paragraph(text, paragraph);
+            } else {
+                paragraph.errors.clear();
+                paragraph.pending = true;
+                jobs.push_back(SpellCheckJob{text_version_, std::wstring(key)});
+            }
+        }
+        paragraphs_.push_back(std::move(paragraph));
+
+        if (separator == std::wstring_view::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    text_.assign(text);
+    Merge_errors();
+    return jobs;
+}
+
+std::vector<SpellError>
+IncrementalSpellChecker::Check_paragraph(std::wstring_view text,
+                                         Paragraph const &paragraph) {
+    std::wstring key(text.substr(static_cast<size_t>(paragraph.start_utf16),
+                                 static_cast<size_t>(paragraph.length_utf16)));
+    std::vector<SpellError> errors = service_->Check(key);
+    Store_in_cache(std::move(key), errors);
+    return errors;
+}
+
+void IncrementalSpellChecker::Store_in_cache(std::wstring key,
+                                             std::vector<SpellError> errors) {
+    if (cache_.size() >= max_cached_paragraphs_ && !cache_.contains(key)) {
+        // Paragraph texts are short-lived while typing; dropping the whole table
+        // is cheaper than tracking recency and the live paragraphs re-enter it
+        // on their next miss.
+        cache_.clear();
+    }
+    cache_.insert_or_assign(std::move(key), std::move(errors));
+}
+
+void IncrementalSpellChecker::Merge_errors() {
+    errors_.clear();
+    for (Paragraph const &paragraph : paragraphs_) {
+        for (SpellError const &error : paragraph.errors) {
+            errors_.push_back(SpellError{paragraph.start_utf16 + error.start_utf16,
+                                         error.length_utf16});
+        }
+    }
+}
+
+} // namespace greenflame::core
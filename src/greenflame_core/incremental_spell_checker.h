@@ -0,0 +1,74 @@
+#pragma once
+
+#include "greenflame_core/spell_check_service.h"
+
+namespace greenflame::core {
+
+// One paragraph of text that still needs a spell-check pass. Produced by
+// IncrementalSpellChecker::Begin_update() for callers that run checks off the
+// editing path; hand the result back through Complete_job().
+struct SpellCheckJob final {
+    uint64_t text_version = 0;
+    std::wstring paragraph_text = {};
+
+    bool operator==(SpellCheckJob const &) const noexcept = default;
+};
+
+// Incremental front end for ISpellCheckService. Text is split into paragraphs
+// at L'\n'; each paragraph is checked on its own and its errors are cached by
+// paragraph text. On every update only the span that differs from the previous
+// text is examined, so typing in one paragraph of a long annotation re-checks
+// that paragraph alone. Paragraphs are the smallest unit re-checked because the
+// underlying checkers are context sensitive (repeated words, sentence starts).
+class IncrementalSpellChecker final {
+  public:
+    static constexpr size_t kDefaultMaxCachedParagraphs = 256;
+
+    explicit IncrementalSpellChecker(
+        ISpellCheckService const *service,
+        size_t max_cached_paragraphs = kDefaultMaxCachedParagraphs);
+
+    // Synchronous update: checks every changed paragraph that is not cached and
+    // returns the merged errors for the whole text in document order.
+    [[nodiscard]] std::span<const SpellError> Update(std::wstring_view text);
+
+    // Asynchronous update: returns one job per changed, uncached paragraph and
+    // bumps Text_version(). Errors() immediately reflects everything already
+    // known; paragraphs with outstanding jobs report no errors until completed.
+    [[nodiscard]] std::vector<SpellCheckJob> Begin_update(std::wstring_view text);
+
+    // Stores the result of a job in the cache. Errors() is refreshed only when
+    // the job's text version is still current; stale results are cached but
+    // otherwise ignored. Returns true when Errors() changed.
+    bool Complete_job(SpellCheckJob const &job, std::vector<SpellError> errors);
+
+    [[nodiscard]] std::span<const SpellError> Errors() const noexcept;
+    [[nodiscard]] uint64_t Text_version() const noexcept;
+    [[nodiscard]] size_t Cached_paragraph_count() const noexcept;
+    void Clear() noexcept;
+
+  private:
+    struct Paragraph final {
+        int32_t start_utf16 = 0;
+        int32_t length_utf16 = 0;
+        bool pending = false;
+        std::vector<SpellError> errors = {};
+    };
+
+    std::vector<SpellCheckJob> Rebuild_paragraphs(std::wstring_view text,
+                                                  bool synchronous);
+    [[nodiscard]] std::vector<SpellError> Check_paragraph(std::wstring_view text,
+                                                          Paragraph const &paragraph);
+    void Store_in_cache(std::wstring key, std::vector<SpellError> errors);
+    void Merge_errors();
+
+    ISpellCheckService const *service_ = nullptr;
+    size_t max_cached_paragraphs_ = kDefaultMaxCachedParagraphs;
+    uint64_t text_version_ = 0;
+    std::wstring text_ = {};
+    std::vector<Paragraph> paragraphs_ = {};
+    std::vector<SpellError> errors_ = {};
+    std::unordered_map<std::wstring, std::vector<SpellError>> cache_ = {};
+};
+
+} // namespace greenflame::core
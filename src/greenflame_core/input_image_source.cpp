@@ -0,0 +1,203 @@
+#include "greenflame_core/input_image_source.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr size_t kBmpFileHeaderBytes = 14;
+constexpr size_t kBmpInfoHeaderBytes = 40;
+constexpr size_t kBmpMasksOffset = kBmpFileHeaderBytes + kBmpInfoHeaderBytes;
+// Info headers of 56 bytes or more (V3 extension, V4, V5) carry an alpha mask.
+constexpr size_t kBmpAlphaMaskOffset = kBmpMasksOffset + 12;
+constexpr uint32_t kBmpInfoHeaderWithAlphaMaskBytes = 56;
+constexpr uint32_t kBiRgb = 0;
+constexpr uint32_t kBiBitfields = 3;
+constexpr size_t kBytesPerPixel32 = 4;
+
+[[nodiscard]] uint16_t Read_le16(std::span<const uint8_t> bytes,
+                                 size_t offset) noexcept {
+    return static_cast<uint16_t>(bytes[offset] | (bytes[offset + 1] << 8));
+}
+
+[[nodiscard]] uint32_t Read_le32(std::span<const uint8_t> bytes,
+                                 size_t offset) noexcept {
+    return static_cast<uint32_t>(Read_le16(bytes, offset)) |
+           (static_cast<uint32_t>(Read_le16(bytes, offset + 2)) << 16);
+}
+
+struct BmpLayout final {
+    int32_t width = 0;
+    int32_t height = 0;
+    bool top_down = false;
+    uint16_t bits_per_pixel = 0;
+    size_t pixel_offset = 0;
+    size_t stride = 0;
+};
+
+// Fills everything but the dimensions-derived fields; fails for layouts this
+// decoder does not handle.
+[[nodiscard]] bool Try_read_bmp_format(std::span<const uint8_t> bytes,
+                                       BmpLayout &layout) noexcept {
+    if (bytes.size() < kBmpMasksOffset || bytes[0] != 'B' || bytes[1] != 'M') {
+        return false;
+    }
+    uint32_t const info_size = Read_le32(bytes, kBmpFileHeaderBytes);
+    uint16_t const planes = Read_le16(bytes, kBmpFileHeaderBytes + 12);
+    uint16_t const bits = Read_le16(bytes, kBmpFileHeaderBytes + 14);
+    uint32_t const compression = Read_le32(bytes, kBmpFileHeaderBytes + 16);
+    if (info_size < kBmpInfoHeaderBytes || planes != 1 || (bits != 24 && bits != 32)) {
+        return false;
+    }
+
+    if (compression == kBiBitfields) {
+        if (bits != 32 || bytes.size() < kBmpAlphaMaskOffset ||
+            Read_le32(bytes, kBmpMasksOffset) != 0x00FF0000u ||
+            Read_le32(bytes, kBmpMasksOffset + 4) != 0x0000FF00u ||
+            Read_le32(bytes, kBmpMasksOffset + 8) != 0x000000FFu) {
+            return false;
+        }
+    } else if (compression != kBiRgb) {
+        return false;
+    }
+    // A declared alpha channel changes how Windows interprets the fourth byte.
+    if (info_size >= kBmpInfoHeaderWithAlphaMaskBytes &&
+        (bytes.size() < kBmpAlphaMaskOffset + 4 ||
+         Read_le32(bytes, kBmpAlphaMaskOffset) != 0)) {
+        return false;
+    }
+
+    layout.bits_per_pixel = bits;
+    layout.pixel_offset = Read_le32(bytes, 10);
+    return true;
+}
+
+[[nodiscard]] InputImageDecodeStatus Read_bmp_layout(std::span<const uint8_t> bytes,
+                                                     BmpLayout &layout,
+                                                     std::wstring &detail) {
+    if (!Try_read_bmp_format(bytes, layout)) {
+        return InputImageDecodeStatus::UnsupportedFormat;
+    }
+
+    int32_t const width = static_cast<int32_t>(Read_le32(bytes, 18));
+    int32_t const height = static_cast<int32_t>(Read_le32(bytes, 22));
+    if (width <= 0 || height == 0 || height == std::numeric_limits<int32_t>::min()) {
+        detail = L"invalid image dimensions.";
+        return InputImageDecodeStatus::Unreadable;
+    }
+    layout.width = width;
+    layout.height = height < 0 ? -height : height;
+    layout.top_down = height < 0;
+
+    uint64_t const output_bytes = static_cast<uint64_t>(layout.width) *
+                                  kBytesPerPixel32 *
+                                  static_cast<uint64_t>(layout.height);
+    if (static_cast<uint64_t>(layout.width) * kBytesPerPixel32 >
+            static_cast<uint64_t>(std::numeric_limits<int32_t>::max()) ||
+        output_bytes > std::numeric_limits<uint32_t>::max()) {
+        detail = L"image dimensions are too large.";
+        return InputImageDecodeStatus::Unreadable;
+    }
+
+    uint64_t const stride =
+        (static_cast<uint64_t>(layout.width) * layout.bits_per_pixel + 31) / 32 * 4;
+    uint64_t const last_row_end =
+        static_cast<uint64_t>(layout.pixel_offset) +
+        stride * static_cast<uint64_t>(layout.height - 1) +
+        static_cast<uint64_t>(layout.width) * (layout.bits_per_pixel / 8u);
+    if (layout.pixel_offset < kBmpMasksOffset || last_row_end > bytes.size()) {
+        detail = L"pixel data is truncated.";
+        return InputImageDecodeStatus::Unreadable;
+    }
+    layout.stride = static_cast<size_t>(stride);
+    return InputImageDecodeStatus::Success;
+}
+
+} // namespace
+
+bool BmpInputImageDecoder::Can_decode(std::span<const uint8_t> file_bytes) noexcept {
+    BmpLayout layout{};
+    return Try_read_bmp_format(file_bytes, layout);
+}
+
+InputImageDecodeStatus
+BmpInputImageDecoder::Read_header(std::span<const uint8_t> file_bytes,
+                                  InputImageHeader &header, std::wstring &detail) {
+    BmpLayout layout{};
+    InputImageDecodeStatus const status = Read_bmp_layout(file_bytes, layout, detail);
+    if (status != InputImageDecodeStatus::Success) {
+        return status;
+    }
+    header = InputImageHeader{layout.width, layout.height, ImageSaveFormat::Bmp, false};
+    return InputImageDecodeStatus::Success;
+}
+
+InputImageDecodeStatus BmpInputImageDecoder::Decode_rows(
+    std::span<const uint8_t> file_bytes, InputImageHeader const &header,
+    ImageRowTarget const &target, std::wstring &detail) {
+    BmpLayout layout{};
+    InputImageDecodeStatus const status = Read_bmp_layout(file_bytes, layout, detail);
+    if (status != InputImageDecodeStatus::Success) {
+        return status;
+    }
+    if (layout.width != header.width || layout.height != header.height ||
+        !Image_row_target_fits(target, layout.width, layout.height)) {
+        detail = L"Error: Failed to prepare the input image bitmap.";
+        return InputImageDecodeStatus::Failed;
+    }
+
+    size_t const source_pixel_bytes = layout.bits_per_pixel / 8u;
+    size_t const width = static_cast<size_t>(layout.width);
+    for (int32_t y = 0; y < layout.height; ++y) {
+        int32_t const source_row = layout.top_down ? y : layout.height - 1 - y;
+        std::span<const uint8_t> const source = file_bytes.subspan(
+            layout.pixel_offset + static_cast<size_t>(source_row) * layout.stride,
+            width * source_pixel_bytes);
+        std::span<uint8_t> const destination = target.pixels.subspan(
+            static_cast<size_t>(y) * target.row_bytes, width * kBytesPerPixel32);
+        for (size_t x = 0; x < width; ++x) {
+            size_t const from = x * source_pixel_bytes;
+            size_t const to = x * kBytesPerPixel32;
+            destination[to] = source[from];
+            destination[to + 1] = source[from + 1];
+            destination[to + 2] = source[from + 2];
+            destination[to + 3] = 0xFFu;
+        }
+    }
+    return InputImageDecodeStatus::Success;
+}
+
+bool Image_row_target_fits(ImageRowTarget const &target, int32_t width,
+                           int32_t height) noexcept {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    uint64_t const row_pixel_bytes = static_cast<uint64_t>(width) * kBytesPerPixel32;
+    if (target.row_bytes < row_pixel_bytes) {
+        return false;
+    }
+    uint64_t const required = static_cast<uint64_t>(target.row_bytes) *
+                                  static_cast<uint64_t>(height - 1) +
+                              row_pixel_bytes;
+    return required <= target.pixels.size();
+}
+
+bool Image_rows_are_opaque(ImageRowTarget const &target, int32_t width,
+                           int32_t height) noexcept {
+    if (!Image_row_target_fits(target, width, height)) {
+        return false;
+    }
+    size_t const row_pixel_bytes = static_cast<size_t>(width) * kBytesPerPixel32;
+    for (int32_t y = 0; y < height; ++y) {
+        std::span<const uint8_t> const row =
+            target.pixels.subspan(static_cast<size_t>(y) * target.row_bytes,
+                                  row_pixel_bytes);
+        for (size_t alpha = 3; alpha < row.size(); alpha += kBytesPerPixel32) {
+            if (row[alpha] != 0xFFu) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "greenflame_core/save_image_policy.h"
+
+namespace greenflame::core {
+
+enum class InputImageDecodeStatus : uint8_t {
+    Success = 0,
+    // `detail` names the problem; the caller adds which file it was.
+    Unreadable = 1,
+    UnsupportedFormat = 2,
+    Transparent = 3,
+    // `detail` is a complete message (e.g. the platform decoder failed to start).
+    Failed = 4,
+};
+
+struct InputImageHeader final {
+    int32_t width = 0;
+    int32_t height = 0;
+    ImageSaveFormat format = ImageSaveFormat::Png;
+    // False when the stored pixel format has no alpha channel, so decoded rows
+    // are known to be opaque without scanning them.
+    bool may_have_alpha = true;
+
+    constexpr bool operator==(InputImageHeader const &) const noexcept = default;
+};
+
+// Destination for decoded pixels: top-down 32bpp BGRA rows `row_bytes` apart.
+// `pixels` starts at the image's top-left pixel, so it may point into a larger
+// padded canvas and the decoder writes the final rows in place.
+struct ImageRowTarget final {
+    std::span<uint8_t> pixels = {};
+    size_t row_bytes = 0;
+};
+
+// Decodes one family of input images from an in-memory (typically mapped) copy
+// of the whole file.
+class IInputImageDecoder {
+  public:
+    virtual ~IInputImageDecoder() = default;
+
+    // Reads only the header; pixel data is not touched.
+    [[nodiscard]] virtual InputImageDecodeStatus
+    Read_header(std::span<const uint8_t> file_bytes, InputImageHeader &header,
+                std::wstring &detail) = 0;
+    [[nodiscard]] virtual InputImageDecodeStatus
+    Decode_rows(std::span<const uint8_t> file_bytes, InputImageHeader const &header,
+                ImageRowTarget const &target, std::wstring &detail) = 0;
+};
+
+// Portable decoder for uncompressed BMP files: BI_RGB at 24 or 32 bpp and
+// BI_BITFIELDS at 32 bpp with plain BGR masks, bottom-up or top-down. The
+// fourth byte of 32 bpp pixels is ignored, as Windows does. Other layouts
+// (palettes, RLE, alpha masks, embedded PNG/JPEG) are left to the platform
+// decoder; check Can_decode() first.
+class BmpInputImageDecoder final : public IInputImageDecoder {
+  public:
+    [[nodiscard]] static bool Can_decode(std::span<const uint8_t> file_bytes) noexcept;
+
+    [[nodiscard]] InputImageDecodeStatus
+    Read_header(std::span<const uint8_t> file_bytes, InputImageHeader &header,
+                std::wstring &detail) override;
+    [[nodiscard]] InputImageDecodeStatus
+    Decode_rows(std::span<const uint8_t> file_bytes, InputImageHeader const &header,
+                ImageRowTarget const &target, std::wstring &detail) override;
+};
+
+// True when `target` holds `height` rows of at least `width` BGRA pixels.
+[[nodiscard]] bool Image_row_target_fits(ImageRowTarget const &target, int32_t width,
+                                         int32_t height) noexcept;
+[[nodiscard]] bool Image_rows_are_opaque(ImageRowTarget const &target, int32_t width,
+                                         int32_t height) noexcept;
+
+} // namespace greenflame::core
@@ -47,6 +47,15 @@ Resolve_explicit_output_path(std::wstring_view explicit_path,
         result.error_message = L"Error: --output path is empty.";
         return result;
     }
+    if (Is_stdout_output_path(explicit_path)) {
+        result.ok = true;
+        result.path = std::wstring(explicit_path);
+        result.format = cli_format.has_value()
+                            ? Image_save_format_from_cli_format(*cli_format)
+                            : default_format;
+        result.sink = OutputSinkKind::Stdout;
+        return result;
+    }
 
     OutputPathExtensionResult const ext = Inspect_output_path_extension(explicit_path);
     if (ext.kind == OutputPathExtensionKind::Unsupported) {
@@ -21,12 +21,15 @@ struct ResolveExplicitPathResult final {
     std::wstring path = {};
     std::wstring error_message = {};
     ImageSaveFormat format = ImageSaveFormat::Png;
+    OutputSinkKind sink = OutputSinkKind::File;
     bool ok = false;
 };
 
 [[nodiscard]] OutputPathExtensionResult
 Inspect_output_path_extension(std::wstring_view path);
 
+// `-` selects standard output: the path stays `-` and the format comes from
+// --format or `default_format`.
 [[nodiscard]] ResolveExplicitPathResult
 Resolve_explicit_output_path(std::wstring_view explicit_path,
                              ImageSaveFormat default_format,
@@ -255,6 +255,11 @@ std::span<const Annotation> OverlayController::Annotations() const noexcept {
     return annotation_controller_.Annotations();
 }
 
+std::span<const AnnotationSummary>
+OverlayController::Annotation_summaries() const noexcept {
+    return annotation_controller_.Annotation_summaries();
+}
+
 Annotation const *OverlayController::Draft_annotation() const noexcept {
     return annotation_controller_.Draft_annotation();
 }
@@ -155,6 +155,8 @@ class OverlayController final {
     [[nodiscard]] std::vector<AnnotationToolbarButtonView>
     Build_annotation_toolbar_button_views() const;
     [[nodiscard]] std::span<const Annotation> Annotations() const noexcept;
+    [[nodiscard]] std::span<const AnnotationSummary>
+    Annotation_summaries() const noexcept;
     [[nodiscard]] Annotation const *Draft_annotation() const noexcept;
     [[nodiscard]] std::span<const PointPx> Draft_freehand_points() const noexcept;
     [[nodiscard]] std::optional<StrokeStyle> Draft_freehand_style() const noexcept;
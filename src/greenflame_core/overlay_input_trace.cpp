@@ -0,0 +1,569 @@
+#include "greenflame_core/overlay_input_trace.h"
+
+#include "greenflame_core/trace_recorder.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr uint8_t kHasWindow = 1u << 0;
+constexpr uint8_t kHasMonitorIndex = 1u << 1;
+constexpr uint8_t kHasWindowRect = 1u << 2;
+constexpr uint8_t kHasSnapEdges = 1u << 3;
+constexpr uint8_t kWindowFullCaptureAvailable = 1u << 4;
+constexpr uint8_t kKnownEventFlags = (1u << 5) - 1u;
+
+constexpr uint8_t kModShift = 1u << 0;
+constexpr uint8_t kModCtrl = 1u << 1;
+constexpr uint8_t kModAlt = 1u << 2;
+constexpr uint8_t kModPrimaryDown = 1u << 3;
+
+// Smallest encodings, used to cap counts read from untrusted input.
+constexpr size_t kMinMonitorBytes = 6;
+constexpr size_t kMinEventBytes = 12;
+constexpr size_t kMinSnapEdgeBytes = 3;
+
+[[nodiscard]] uint64_t Zigzag_encode(int64_t value) noexcept {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+[[nodiscard]] int64_t Zigzag_decode(uint64_t value) noexcept {
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+class ByteWriter final {
+  public:
+    void Put_u8(uint8_t value) { bytes_.push_back(value); }
+
+    void Put_u16(uint16_t value) {
+        Put_u8(static_cast<uint8_t>(value & 0xFFu));
+        Put_u8(static_cast<uint8_t>(value >> 8));
+    }
+
+    void Put_varint(uint64_t value) {
+        while (value >= 0x80u) {
+            Put_u8(static_cast<uint8_t>(value | 0x80u));
+            value >>= 7;
+        }
+        Put_u8(static_cast<uint8_t>(value));
+    }
+
+    void Put_signed(int64_t value) { Put_varint(Zigzag_encode(value)); }
+
+    void Put_point(PointPx point) {
+        Put_signed(point.x);
+        Put_signed(point.y);
+    }
+
+    void Put_rect(RectPx rect) {
+        Put_signed(rect.left);
+        Put_signed(rect.top);
+        Put_signed(rect.right);
+        Put_signed(rect.bottom);
+    }
+
+    void Put_bytes(std::span<const uint8_t> bytes) {
+        bytes_.insert(bytes_.end(), bytes.begin(), bytes.end());
+    }
+
+    [[nodiscard]] std::vector<uint8_t> Take() noexcept { return std::move(bytes_); }
+
+  private:
+    std::vector<uint8_t> bytes_ = {};
+};
+
+class ByteReader final {
+  public:
+    explicit ByteReader(std::span<const uint8_t> bytes) noexcept : bytes_(bytes) {}
+
+    [[nodiscard]] size_t Remaining() const noexcept { return bytes_.size() - offset_; }
+
+    [[nodiscard]] bool Read_u8(uint8_t &value) noexcept {
+        if (Remaining() < 1) {
+            return false;
+        }
+        value = bytes_[offset_++];
+        return true;
+    }
+
+    [[nodiscard]] bool Read_u16(uint16_t &value) noexcept {
+        uint8_t low = 0;
+        uint8_t high = 0;
+        if (!Read_u8(low) || !Read_u8(high)) {
+            return false;
+        }
+        value = static_cast<uint16_t>(low | (high << 8));
+        return true;
+    }
+
+    [[nodiscard]] bool Read_varint(uint64_t &value) noexcept {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = 0;
+            if (!Read_u8(byte)) {
+                return false;
+            }
+            result |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+            if ((byte & 0x80u) == 0) {
+                value = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool Read_signed(int64_t &value) noexcept {
+        uint64_t raw = 0;
+        if (!Read_varint(raw)) {
+            return false;
+        }
+        value = Zigzag_decode(raw);
+        return true;
+    }
+
+    [[nodiscard]] bool Read_i32(int32_t &value) noexcept {
+        int64_t decoded = 0;
+        if (!Read_signed(decoded) || decoded < std::numeric_limits<int32_t>::min() ||
+            decoded > std::numeric_limits<int32_t>::max()) {
+            return false;
+        }
+        value = static_cast<int32_t>(decoded);
+        return true;
+    }
+
+    [[nodiscard]] bool Read_point(PointPx &point) noexcept {
+        return Read_i32(point.x) && Read_i32(point.y);
+    }
+
+    [[nodiscard]] bool Read_rect(RectPx &rect) noexcept {
+        return Read_i32(rect.left) && Read_i32(rect.top) && Read_i32(rect.right) &&
+               Read_i32(rect.bottom);
+    }
+
+    [[nodiscard]] bool Read_count(size_t &count, size_t min_element_bytes) noexcept {
+        uint64_t raw = 0;
+        if (!Read_varint(raw) || raw > Remaining() / min_element_bytes) {
+            return false;
+        }
+        count = static_cast<size_t>(raw);
+        return true;
+    }
+
+    [[nodiscard]] bool Read_magic(std::span<const uint8_t> magic) noexcept {
+        for (uint8_t const expected : magic) {
+            uint8_t byte = 0;
+            if (!Read_u8(byte) || byte != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    std::span<const uint8_t> bytes_ = {};
+    size_t offset_ = 0;
+};
+
+void Write_segments(ByteWriter &writer, std::span<const SnapEdgeSegmentPx> segments) {
+    writer.Put_varint(segments.size());
+    for (SnapEdgeSegmentPx const &segment : segments) {
+        writer.Put_signed(segment.line);
+        writer.Put_signed(segment.span_start);
+        writer.Put_signed(segment.span_end);
+    }
+}
+
+[[nodiscard]] bool Read_segments(ByteReader &reader,
+                                 std::vector<SnapEdgeSegmentPx> &segments) {
+    size_t count = 0;
+    if (!reader.Read_count(count, kMinSnapEdgeBytes)) {
+        return false;
+    }
+    segments.resize(count);
+    for (SnapEdgeSegmentPx &segment : segments) {
+        if (!reader.Read_i32(segment.line) || !reader.Read_i32(segment.span_start) ||
+            !reader.Read_i32(segment.span_end)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+[[nodiscard]] uint8_t Pack_mods(OverlayModifierState mods) noexcept {
+    return static_cast<uint8_t>((mods.shift ? kModShift : 0u) |
+                                (mods.ctrl ? kModCtrl : 0u) |
+                                (mods.alt ? kModAlt : 0u) |
+                                (mods.primary_down ? kModPrimaryDown : 0u));
+}
+
+[[nodiscard]] OverlayModifierState Unpack_mods(uint8_t bits) noexcept {
+    return OverlayModifierState{(bits & kModShift) != 0, (bits & kModCtrl) != 0,
+                                (bits & kModAlt) != 0, (bits & kModPrimaryDown) != 0};
+}
+
+void Write_event(ByteWriter &writer, OverlayInputEvent const &event,
+                 int64_t previous_time_ns) {
+    uint8_t flags = 0;
+    flags |= event.window.has_value() ? kHasWindow : 0u;
+    flags |= event.monitor_index.has_value() ? kHasMonitorIndex : 0u;
+    flags |= event.window_rect_screen.has_value() ? kHasWindowRect : 0u;
+    flags |= event.snap_edges.has_value() ? kHasSnapEdges : 0u;
+    flags |= event.window_full_capture_available ? kWindowFullCaptureAvailable : 0u;
+
+    writer.Put_u8(static_cast<uint8_t>(event.kind));
+    writer.Put_u8(flags);
+    writer.Put_u8(Pack_mods(event.mods));
+    writer.Put_signed(event.time_ns - previous_time_ns);
+    writer.Put_point(event.cursor_client);
+    writer.Put_point(event.cursor_screen);
+    if (event.window.has_value()) {
+        writer.Put_varint(reinterpret_cast<uintptr_t>(*event.window));
+    }
+    if (event.monitor_index.has_value()) {
+        writer.Put_varint(*event.monitor_index);
+    }
+    if (event.window_rect_screen.has_value()) {
+        writer.Put_rect(*event.window_rect_screen);
+    }
+    writer.Put_rect(event.virtual_desktop_bounds);
+    writer.Put_signed(event.origin_x);
+    writer.Put_signed(event.origin_y);
+    writer.Put_u16(static_cast<uint16_t>(event.hotkey));
+    writer.Put_u8(static_cast<uint8_t>(event.tool));
+    if (event.snap_edges.has_value()) {
+        Write_segments(writer, event.snap_edges->vertical);
+        Write_segments(writer, event.snap_edges->horizontal);
+    }
+}
+
+[[nodiscard]] bool Read_event(ByteReader &reader, int64_t previous_time_ns,
+                              OverlayInputEvent &event) {
+    uint8_t kind = 0;
+    uint8_t flags = 0;
+    uint8_t mods = 0;
+    int64_t time_delta_ns = 0;
+    if (!reader.Read_u8(kind) || kind >= kOverlayInputEventKindCount ||
+        !reader.Read_u8(flags) || (flags & ~kKnownEventFlags) != 0 ||
+        !reader.Read_u8(mods) || !reader.Read_signed(time_delta_ns) ||
+        !reader.Read_point(event.cursor_client) ||
+        !reader.Read_point(event.cursor_screen) ||
+        (time_delta_ns > 0 &&
+         previous_time_ns > std::numeric_limits<int64_t>::max() - time_delta_ns) ||
+        (time_delta_ns < 0 &&
+         previous_time_ns < std::numeric_limits<int64_t>::min() - time_delta_ns)) {
+        return false;
+    }
+    event.kind = static_cast<OverlayInputEventKind>(kind);
+    event.mods = Unpack_mods(mods);
+    event.time_ns = previous_time_ns + time_delta_ns;
+    event.window_full_capture_available = (flags & kWindowFullCaptureAvailable) != 0;
+
+    if ((flags & kHasWindow) != 0) {
+        uint64_t window = 0;
+        if (!reader.Read_varint(window) || window > UINTPTR_MAX) {
+            return false;
+        }
+        event.window = reinterpret_cast<HWND>(static_cast<uintptr_t>(window));
+    }
+    if ((flags & kHasMonitorIndex) != 0) {
+        uint64_t monitor_index = 0;
+        if (!reader.Read_varint(monitor_index) || monitor_index > SIZE_MAX) {
+            return false;
+        }
+        event.monitor_index = static_cast<size_t>(monitor_index);
+    }
+    if ((flags & kHasWindowRect) != 0) {
+        RectPx rect = {};
+        if (!reader.Read_rect(rect)) {
+            return false;
+        }
+        event.window_rect_screen = rect;
+    }
+
+    uint16_t hotkey = 0;
+    uint8_t tool = 0;
+    if (!reader.Read_rect(event.virtual_desktop_bounds) ||
+        !reader.Read_i32(event.origin_x) || !reader.Read_i32(event.origin_y) ||
+        !reader.Read_u16(hotkey) || !reader.Read_u8(tool) ||
+        tool > static_cast<uint8_t>(AnnotationToolId::Bubble)) {
+        return false;
+    }
+    event.hotkey = static_cast<wchar_t>(hotkey);
+    event.tool = static_cast<AnnotationToolId>(tool);
+
+    if ((flags & kHasSnapEdges) != 0) {
+        SnapEdges edges = {};
+        if (!Read_segments(reader, edges.vertical) ||
+            !Read_segments(reader, edges.horizontal)) {
+            return false;
+        }
+        event.snap_edges = std::move(edges);
+    }
+    return true;
+}
+
+[[nodiscard]] bool Same_snap_edges(SnapEdges const &a, SnapEdges const &b) noexcept {
+    return a.vertical == b.vertical && a.horizontal == b.horizontal;
+}
+
+} // namespace
+
+std::vector<uint8_t> Encode_overlay_input_trace(OverlayInputTrace const &trace) {
+    ByteWriter writer;
+    writer.Put_bytes(kOverlayInputTraceMagic);
+    writer.Put_u16(kOverlayInputTraceVersion);
+    writer.Put_varint(trace.monitors.size());
+    for (MonitorWithBounds const &monitor : trace.monitors) {
+        writer.Put_rect(monitor.bounds);
+        writer.Put_signed(monitor.info.dpi_scale.percent);
+        writer.Put_u8(static_cast<uint8_t>(monitor.info.orientation));
+    }
+    writer.Put_varint(trace.events.size());
+    int64_t previous_time_ns = 0;
+    for (OverlayInputEvent const &event : trace.events) {
+        Write_event(writer, event, previous_time_ns);
+        previous_time_ns = event.time_ns;
+    }
+    return writer.Take();
+}
+
+bool Try_decode_overlay_input_trace(std::span<const uint8_t> bytes,
+                                    OverlayInputTrace &trace) noexcept {
+    trace = {};
+    ByteReader reader(bytes);
+    uint16_t version = 0;
+    size_t monitor_count = 0;
+    if (!reader.Read_magic(kOverlayInputTraceMagic) || !reader.Read_u16(version) ||
+        version != kOverlayInputTraceVersion ||
+        !reader.Read_count(monitor_count, kMinMonitorBytes)) {
+        return false;
+    }
+
+    OverlayInputTrace decoded = {};
+    decoded.monitors.resize(monitor_count);
+    for (MonitorWithBounds &monitor : decoded.monitors) {
+        uint8_t orientation = 0;
+        if (!reader.Read_rect(monitor.bounds) ||
+            !reader.Read_i32(monitor.info.dpi_scale.percent) ||
+            !reader.Read_u8(orientation) ||
+            orientation > static_cast<uint8_t>(MonitorOrientation::Portrait)) {
+            return false;
+        }
+        monitor.info.orientation = static_cast<MonitorOrientation>(orientation);
+    }
+
+    size_t event_count = 0;
+    if (!reader.Read_count(event_count, kMinEventBytes)) {
+        return false;
+    }
+    decoded.events.resize(event_count);
+    int64_t previous_time_ns = 0;
+    for (OverlayInputEvent &event : decoded.events) {
+        if (!Read_event(reader, previous_time_ns, event)) {
+            return false;
+        }
+        previous_time_ns = event.time_ns;
+    }
+    if (reader.Remaining() != 0) {
+        return false;
+    }
+    trace = std::move(decoded);
+    return true;
+}
+
+void OverlayInputRecorder::Begin_session(std::span<const MonitorWithBounds> monitors) {
+    trace_ = {};
+    trace_.monitors.assign(monitors.begin(), monitors.end());
+    last_snap_edges_.reset();
+    session_start_ns_ = TraceRecorder::Now_ns();
+    recording_ = true;
+}
+
+void OverlayInputRecorder::Record(OverlayInputEvent event) {
+    if (!recording_) {
+        return;
+    }
+    event.time_ns = TraceRecorder::Now_ns() - session_start_ns_;
+    if (event.snap_edges.has_value()) {
+        if (event.kind == OverlayInputEventKind::PrimaryPress &&
+            last_snap_edges_.has_value() &&
+            Same_snap_edges(*event.snap_edges, *last_snap_edges_)) {
+            event.snap_edges.reset();
+        } else {
+            last_snap_edges_ = event.snap_edges;
+        }
+    }
+    trace_.events.push_back(std::move(event));
+}
+
+OverlayInputTrace OverlayInputRecorder::Take_trace() {
+    recording_ = false;
+    last_snap_edges_.reset();
+    return std::exchange(trace_, {});
+}
+
+OverlayAction Apply_overlay_input_event(OverlayController &controller,
+                                        OverlayInputEvent const &event,
+                                        SnapEdges &snap_edges) {
+    switch (event.kind) {
+    case OverlayInputEventKind::PrimaryPress:
+        if (event.snap_edges.has_value()) {
+            snap_edges = *event.snap_edges;
+        }
+        return controller.On_primary_press(
+            event.mods, event.cursor_client, event.cursor_screen, event.window,
+            event.monitor_index, event.window_rect_screen, event.virtual_desktop_bounds,
+            snap_edges, event.origin_x, event.origin_y,
+            event.window_full_capture_available);
+    case OverlayInputEventKind::PrimaryDoublePress:
+        return controller.On_primary_double_press(event.cursor_client);
+    case OverlayInputEventKind::PointerMove:
+        return controller.On_pointer_move(event.mods, event.cursor_client,
+                                          event.cursor_screen, event.window_rect_screen,
+                                          event.virtual_desktop_bounds,
+                                          event.monitor_index, event.origin_x,
+                                          event.origin_y);
+    case OverlayInputEventKind::PrimaryRelease:
+        return controller.On_primary_release(event.mods, event.cursor_client);
+    case OverlayInputEventKind::ModifierChanged:
+        return controller.On_modifier_changed(
+            event.mods, event.cursor_screen, event.window_rect_screen,
+            event.virtual_desktop_bounds, event.monitor_index, event.origin_x,
+            event.origin_y);
+    case OverlayInputEventKind::Cancel:
+        return controller.On_cancel();
+    case OverlayInputEventKind::AnnotationToolHotkey:
+        return controller.On_annotation_tool_hotkey(event.hotkey, event.mods.shift);
+    case OverlayInputEventKind::SelectAnnotationTool:
+        return controller.On_select_annotation_tool(event.tool);
+    case OverlayInputEventKind::DeleteSelectedAnnotation:
+        return controller.On_delete_selected_annotation();
+    case OverlayInputEventKind::Undo:
+        controller.Undo();
+        return OverlayAction::Repaint;
+    case OverlayInputEventKind::Redo:
+        controller.Redo();
+        return OverlayAction::Repaint;
+    case OverlayInputEventKind::SnapEdgesRefreshed:
+        if (event.snap_edges.has_value()) {
+            snap_edges = *event.snap_edges;
+        }
+        controller.Refresh_snap_edges(snap_edges, event.origin_x, event.origin_y);
+        return OverlayAction::None;
+    }
+    return OverlayAction::None;
+}
+
+OverlayReplayLatency Summarize_replay_latency(std::span<int64_t> samples_ns) noexcept {
+    OverlayReplayLatency latency = {};
+    latency.count = samples_ns.size();
+    if (samples_ns.empty()) {
+        return latency;
+    }
+    std::sort(samples_ns.begin(), samples_ns.end());
+    auto const nearest_rank = [&](size_t percent) {
+        size_t const rank = (samples_ns.size() * percent + 99u) / 100u;
+        return samples_ns[std::max<size_t>(rank, 1u) - 1u];
+    };
+    latency.p50_ns = nearest_rank(50);
+    latency.p90_ns = nearest_rank(90);
+    latency.p99_ns = nearest_rank(99);
+    latency.max_ns = samples_ns.back();
+    return latency;
+}
+
+OverlayReplayReport Replay_overlay_input_trace(OverlayController &controller,
+                                               OverlayInputTrace const &trace,
+                                               OverlayReplayOptions const &options) {
+    struct KindSamples final {
+        std::vector<int64_t> durations_ns = {};
+        uint64_t allocations = 0;
+        uint64_t max_allocations = 0;
+    };
+    std::array<KindSamples, kOverlayInputEventKindCount> by_kind = {};
+    {
+        std::array<size_t, kOverlayInputEventKindCount> counts = {};
+        for (OverlayInputEvent const &event : trace.events) {
+            ++counts[static_cast<size_t>(event.kind)];
+        }
+        for (size_t kind = 0; kind < by_kind.size(); ++kind) {
+            by_kind[kind].durations_ns.reserve(counts[kind]);
+        }
+    }
+
+    OverlayReplayReport report = {};
+    controller.Reset_for_session(trace.monitors);
+    SnapEdges snap_edges = {};
+    for (OverlayInputEvent const &event : trace.events) {
+        uint64_t const allocations_before =
+            options.allocation_count != nullptr ? options.allocation_count() : 0;
+        int64_t const begin_ns = TraceRecorder::Now_ns();
+        OverlayAction const action =
+            Apply_overlay_input_event(controller, event, snap_edges);
+        int64_t const elapsed_ns = TraceRecorder::Now_ns() - begin_ns;
+        uint64_t const allocations =
+            options.allocation_count != nullptr
+                ? options.allocation_count() - allocations_before
+                : 0;
+
+        KindSamples &samples = by_kind[static_cast<size_t>(event.kind)];
+        samples.durations_ns.push_back(elapsed_ns);
+        samples.allocations += allocations;
+        samples.max_allocations = std::max(samples.max_allocations, allocations);
+        report.repaint_actions += action == OverlayAction::Repaint ? 1u : 0u;
+        report.close_actions += action == OverlayAction::Close ? 1u : 0u;
+    }
+
+    std::vector<int64_t> all_durations_ns;
+    all_durations_ns.reserve(trace.events.size());
+    for (size_t kind = 0; kind < by_kind.size(); ++kind) {
+        KindSamples &samples = by_kind[kind];
+        all_durations_ns.insert(all_durations_ns.end(), samples.durations_ns.begin(),
+                                samples.durations_ns.end());
+        OverlayReplayLatency &latency = report.by_kind[kind];
+        latency = Summarize_replay_latency(samples.durations_ns);
+        latency.allocations = samples.allocations;
+        latency.max_allocations = samples.max_allocations;
+        report.all.allocations += samples.allocations;
+        report.all.max_allocations =
+            std::max(report.all.max_allocations, samples.max_allocations);
+    }
+    uint64_t const allocations = report.all.allocations;
+    uint64_t const max_allocations = report.all.max_allocations;
+    report.all = Summarize_replay_latency(all_durations_ns);
+    report.all.allocations = allocations;
+    report.all.max_allocations = max_allocations;
+    return report;
+}
+
+std::string_view Overlay_input_event_kind_name(OverlayInputEventKind kind) noexcept {
+    switch (kind) {
+    case OverlayInputEventKind::PrimaryPress:
+        return "primary_press";
+    case OverlayInputEventKind::PrimaryDoublePress:
+        return "primary_double_press";
+    case OverlayInputEventKind::PointerMove:
+        return "pointer_move";
+    case OverlayInputEventKind::PrimaryRelease:
+        return "primary_release";
+    case OverlayInputEventKind::ModifierChanged:
+        return "modifier_changed";
+    case OverlayInputEventKind::Cancel:
+        return "cancel";
+    case OverlayInputEventKind::AnnotationToolHotkey:
+        return "annotation_tool_hotkey";
+    case OverlayInputEventKind::SelectAnnotationTool:
+        return "select_annotation_tool";
+    case OverlayInputEventKind::DeleteSelectedAnnotation:
+        return "delete_selected_annotation";
+    case OverlayInputEventKind::Undo:
+        return "undo";
+    case OverlayInputEventKind::Redo:
+        return "redo";
+    case OverlayInputEventKind::SnapEdgesRefreshed:
+        return "snap_edges_refreshed";
+    }
+    return "unknown";
+}
+
+} // namespace greenflame::core
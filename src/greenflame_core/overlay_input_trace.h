@@ -0,0 +1,125 @@
+#pragma once
+
+#include "greenflame_core/overlay_controller.h"
+
+namespace greenflame::core {
+
+// Recorded overlay session ("GFIT"): the monitor layout plus every input the
+// window fed OverlayController, with the snap edges it saw. Replaying one
+// drives a fresh controller through the same calls without any Win32 state.
+// Same encoding rules as the annotation container: little-endian fixed fields,
+// LEB128 varints, zigzag for signed values.
+inline constexpr std::array<uint8_t, 4> kOverlayInputTraceMagic = {
+    {'G', 'F', 'I', 'T'}};
+inline constexpr uint16_t kOverlayInputTraceVersion = 1;
+
+enum class OverlayInputEventKind : uint8_t {
+    PrimaryPress = 0,
+    PrimaryDoublePress = 1,
+    PointerMove = 2,
+    PrimaryRelease = 3,
+    ModifierChanged = 4,
+    Cancel = 5,
+    AnnotationToolHotkey = 6,
+    SelectAnnotationTool = 7,
+    DeleteSelectedAnnotation = 8,
+    Undo = 9,
+    Redo = 10,
+    SnapEdgesRefreshed = 11,
+};
+inline constexpr size_t kOverlayInputEventKindCount = 12;
+
+// One controller call with its pre-resolved Win32 arguments. Fields a kind
+// does not take stay default.
+struct OverlayInputEvent final {
+    OverlayInputEventKind kind = OverlayInputEventKind::PointerMove;
+    int64_t time_ns = 0; // since the session began
+    OverlayModifierState mods = {};
+    PointPx cursor_client = {};
+    PointPx cursor_screen = {};
+    std::optional<HWND> window = std::nullopt; // only compared, never dereferenced
+    std::optional<size_t> monitor_index = std::nullopt;
+    std::optional<RectPx> window_rect_screen = std::nullopt;
+    RectPx virtual_desktop_bounds = {};
+    int32_t origin_x = 0;
+    int32_t origin_y = 0;
+    bool window_full_capture_available = false;
+    wchar_t hotkey = L'\0';
+    AnnotationToolId tool = AnnotationToolId::Freehand;
+    // PrimaryPress and SnapEdgesRefreshed; a press without edges reuses the
+    // previous event's.
+    std::optional<SnapEdges> snap_edges = std::nullopt;
+};
+
+struct OverlayInputTrace final {
+    std::vector<MonitorWithBounds> monitors = {};
+    std::vector<OverlayInputEvent> events = {};
+};
+
+[[nodiscard]] std::vector<uint8_t>
+Encode_overlay_input_trace(OverlayInputTrace const &trace);
+// Bounds checked like Try_decode_annotation_document; returns false and leaves
+// `trace` empty on truncated, corrupt or unsupported-version input.
+[[nodiscard]] bool Try_decode_overlay_input_trace(std::span<const uint8_t> bytes,
+                                                  OverlayInputTrace &trace) noexcept;
+
+// Collects a session as the window forwards input to its controller. Snap
+// edges identical to the last recorded set are stored once.
+class OverlayInputRecorder final {
+  public:
+    void Begin_session(std::span<const MonitorWithBounds> monitors);
+    [[nodiscard]] bool Is_recording() const noexcept { return recording_; }
+    void Record(OverlayInputEvent event);
+    // Ends the session and hands over what was recorded.
+    [[nodiscard]] OverlayInputTrace Take_trace();
+
+  private:
+    OverlayInputTrace trace_ = {};
+    std::optional<SnapEdges> last_snap_edges_ = std::nullopt;
+    int64_t session_start_ns_ = 0;
+    bool recording_ = false;
+};
+
+// Feeds one event to the controller. `snap_edges` carries the edges in effect
+// and is updated by events that bring their own.
+OverlayAction Apply_overlay_input_event(OverlayController &controller,
+                                        OverlayInputEvent const &event,
+                                        SnapEdges &snap_edges);
+
+struct OverlayReplayLatency final {
+    size_t count = 0;
+    int64_t p50_ns = 0;
+    int64_t p90_ns = 0;
+    int64_t p99_ns = 0;
+    int64_t max_ns = 0;
+    uint64_t allocations = 0;
+    uint64_t max_allocations = 0; // in a single event
+};
+
+struct OverlayReplayReport final {
+    OverlayReplayLatency all = {};
+    std::array<OverlayReplayLatency, kOverlayInputEventKindCount> by_kind = {};
+    size_t repaint_actions = 0;
+    size_t close_actions = 0;
+};
+
+// Nearest-rank percentiles of `samples_ns`, which is sorted in place.
+[[nodiscard]] OverlayReplayLatency
+Summarize_replay_latency(std::span<int64_t> samples_ns) noexcept;
+
+struct OverlayReplayOptions final {
+    // Returns a running allocation count; sampled around every event when set.
+    uint64_t (*allocation_count)() = nullptr;
+};
+
+// Resets `controller` to the trace's monitors and replays every event, timing
+// each call. The caller wires text layout, spell check and obfuscate sources.
+[[nodiscard]] OverlayReplayReport
+Replay_overlay_input_trace(OverlayController &controller,
+                           OverlayInputTrace const &trace,
+                           OverlayReplayOptions const &options = {});
+
+[[nodiscard]] std::string_view
+Overlay_input_event_kind_name(OverlayInputEventKind kind) noexcept;
+
+} // namespace greenflame::core
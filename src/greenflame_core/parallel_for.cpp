@@ -0,0 +1,228 @@
+#include "greenflame_core/parallel_for.h"
+
+namespace greenflame::core {
+
+namespace {
+
+// One loop in flight. Helpers queued for it hold a reference and may start after
+// the caller returned; `closed` turns those into no-ops.
+struct ParallelLoop final {
+    size_t count = 0;
+    std::function<void(size_t)> const *body = nullptr;
+    std::atomic<bool> const *cancel = nullptr;
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> stop = false;
+    std::atomic<bool> cancelled = false;
+
+    std::mutex mutex = {};
+    std::condition_variable helpers_done = {};
+    size_t active_helpers = 0; // guarded by mutex
+    bool closed = false;       // guarded by mutex
+    std::exception_ptr error = nullptr;
+
+    void Fail(std::exception_ptr exception) noexcept {
+        std::scoped_lock lock(mutex);
+        if (error == nullptr) {
+            error = std::move(exception);
+        }
+        stop.store(true);
+    }
+
+    // Claims and runs indices until none are left or the loop stops.
+    void Work() noexcept {
+        for (;;) {
+            if (stop.load(std::memory_order_relaxed)) {
+                return;
+            }
+            if (cancel != nullptr && cancel->load(std::memory_order_relaxed)) {
+                cancelled.store(true);
+                stop.store(true);
+                return;
+            }
+            size_t const index = next.fetch_add(1);
+            if (index >= count) {
+                return;
+            }
+            try {
+                (*body)(index);
+            } catch (...) {
+                Fail(std::current_exception());
+                return;
+            }
+        }
+    }
+};
+
+// Fixed set of threads shared by every Parallel_for. Threads that fail to start
+// are simply missing; loops then lean on their callers.
+class WorkerPool final {
+  public:
+    WorkerPool() {
+        size_t const thread_count = std::max<size_t>(Default_parallel_workers(), 2) - 1;
+        try {
+            threads_.reserve(thread_count);
+            for (size_t index = 0; index < thread_count; ++index) {
+                threads_.emplace_back([this] { Serve(); });
+            }
+        } catch (...) {
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::scoped_lock lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkerPool(WorkerPool const &) = delete;
+    WorkerPool &operator=(WorkerPool const &) = delete;
+    WorkerPool(WorkerPool &&) = delete;
+    WorkerPool &operator=(WorkerPool &&) = delete;
+
+    [[nodiscard]] size_t Thread_count() const noexcept { return threads_.size(); }
+
+    // False when the task could not be queued.
+    [[nodiscard]] bool Try_submit(std::function<void()> task) noexcept {
+        try {
+            {
+                std::scoped_lock lock(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            wake_.notify_one();
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+  private:
+    void Serve() {
+        std::unique_lock lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            std::function<void()> task = std::move(tasks_.front());
+            tasks_.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex_ = {};
+    std::condition_variable wake_ = {};
+    std::deque<std::function<void()>> tasks_ = {};
+    bool stopping_ = false;
+    std::vector<std::thread> threads_ = {};
+};
+
+[[nodiscard]] WorkerPool &Shared_worker_pool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+// Closes the loop and waits for helpers that already started, on every way out
+// of Parallel_for, so `body` outlives every call into it.
+class HelperJoin final {
+  public:
+    explicit HelperJoin(ParallelLoop &loop) noexcept : loop_(loop) {}
+    ~HelperJoin() {
+        std::unique_lock lock(loop_.mutex);
+        loop_.closed = true;
+        loop_.helpers_done.wait(lock, [this] { return loop_.active_helpers == 0; });
+    }
+    HelperJoin(HelperJoin const &) = delete;
+    HelperJoin &operator=(HelperJoin const &) = delete;
+    HelperJoin(HelperJoin &&) = delete;
+    HelperJoin &operator=(HelperJoin &&) = delete;
+
+  private:
+    ParallelLoop &loop_;
+};
+
+} // namespace
+
+size_t Default_parallel_workers() noexcept {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+bool Parallel_for(size_t count, ParallelForOptions const &options,
+                  std::function<void(size_t)> const &body,
+                  std::function<void()> const &caller_first) {
+    size_t const workers = std::max<size_t>(options.max_workers, 1);
+    // Without a caller task the caller takes one index itself.
+    size_t helpers = std::min(workers - 1, caller_first ? count : count - (count > 0));
+    std::shared_ptr<ParallelLoop> loop = nullptr;
+    if (helpers > 0) {
+        helpers = std::min(helpers, Shared_worker_pool().Thread_count());
+    }
+    if (helpers > 0) {
+        try {
+            loop = std::make_shared<ParallelLoop>();
+        } catch (std::bad_alloc const &) {
+            helpers = 0;
+        }
+    }
+    if (helpers == 0) {
+        if (caller_first) {
+            caller_first();
+        }
+        for (size_t index = 0; index < count; ++index) {
+            if (options.cancel != nullptr &&
+                options.cancel->load(std::memory_order_relaxed)) {
+                return false;
+            }
+            body(index);
+        }
+        return true;
+    }
+
+    loop->count = count;
+    loop->body = &body;
+    loop->cancel = options.cancel;
+    {
+        HelperJoin const join(*loop);
+        WorkerPool &pool = Shared_worker_pool();
+        for (size_t helper = 0; helper < helpers; ++helper) {
+            bool const queued = pool.Try_submit([loop] {
+                {
+                    std::scoped_lock lock(loop->mutex);
+                    if (loop->closed) {
+                        return;
+                    }
+                    ++loop->active_helpers;
+                }
+                loop->Work();
+                {
+                    std::scoped_lock lock(loop->mutex);
+                    --loop->active_helpers;
+                }
+                loop->helpers_done.notify_all();
+            });
+            if (!queued) {
+                break;
+            }
+        }
+        if (caller_first) {
+            try {
+                caller_first();
+            } catch (...) {
+                loop->Fail(std::current_exception());
+            }
+        }
+        loop->Work();
+    }
+    if (loop->error != nullptr) {
+        std::rethrow_exception(loop->error);
+    }
+    return !loop->cancelled.load();
+}
+
+} // namespace greenflame::core
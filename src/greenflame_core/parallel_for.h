@@ -0,0 +1,37 @@
+#pragma once
+
+namespace greenflame::core {
+
+// Threads a CPU-bound loop should use, the caller included: one per hardware
+// thread. Callers size their loops with this rather than asking the platform.
+[[nodiscard]] size_t Default_parallel_workers() noexcept;
+
+struct ParallelForOptions final {
+    // Threads working on the loop, the caller included; 0 or 1 runs every index on
+    // the caller.
+    size_t max_workers = 1;
+    // Checked before each index; once true, indices not yet started are skipped.
+    std::atomic<bool> const *cancel = nullptr;
+};
+
+// Runs body(index) once for every index in [0, count) on the calling thread and
+// up to `max_workers - 1` threads of one process-wide pool, and returns only after
+// every started index has finished, on every path out. The pool's thread count
+// is fixed, so nested loops (a loop body that starts its own loop) queue on the
+// same threads instead of multiplying them, and they cannot deadlock: each
+// caller works through its own indices and only waits for helpers that already
+// started. When the pool has no free or no working threads, or the loop's shared
+// state cannot be allocated, the caller runs the indices itself.
+//
+// `caller_first`, when given, runs on the calling thread while pool threads start
+// on the loop; the caller then joins the loop. It overlaps serial work, such as
+// handing finished rows to a sink, with the next parallel batch.
+//
+// The first exception thrown by `body` or `caller_first` stops indices not yet
+// started and is rethrown on the caller once the loop has wound down. Returns
+// false when `options.cancel` stopped the loop.
+bool Parallel_for(size_t count, ParallelForOptions const &options,
+                  std::function<void(size_t)> const &body,
+                  std::function<void()> const &caller_first = {});
+
+} // namespace greenflame::core
@@ -274,4 +274,16 @@ void Multiply_premultiplied_layer_onto_opaque_pixels(
         });
 }
 
+void Multiply_premultiplied_bitmap_onto_opaque_pixels(
+    std::span<uint8_t> pixels, int width, int height, int row_bytes,
+    std::span<const uint8_t> layer_pixels, int layer_width, int layer_height,
+    int layer_row_bytes, RectPx layer_bounds) noexcept {
+    Composite_premultiplied_bitmap(
+        pixels, width, height, row_bytes, layer_pixels, layer_width, layer_height,
+        layer_row_bytes, layer_bounds,
+        [](uint8_t dst, uint8_t src, uint8_t alpha) noexcept {
+            return Multiply_premultiplied_channel(dst, src, alpha);
+        });
+}
+
 } // namespace greenflame::core
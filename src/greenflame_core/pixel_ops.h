@@ -43,4 +43,10 @@ void Multiply_premultiplied_layer_onto_opaque_pixels(
     std::span<const uint8_t> layer_pixels, int layer_row_bytes,
     RectPx layer_bounds) noexcept;
 
+// Multiply counterpart of Blend_premultiplied_bitmap_onto_opaque_pixels.
+void Multiply_premultiplied_bitmap_onto_opaque_pixels(
+    std::span<uint8_t> pixels, int width, int height, int row_bytes,
+    std::span<const uint8_t> layer_pixels, int layer_width, int layer_height,
+    int layer_row_bytes, RectPx layer_bounds) noexcept;
+
 } // namespace greenflame::core
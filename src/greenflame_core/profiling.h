@@ -5,6 +5,15 @@
 
 #define GREENFLAME_PROFILE_SCOPE(scope_name) PERFORMANCEAPI_INSTRUMENT(scope_name)
 #define GREENFLAME_PROFILE_FUNCTION() PERFORMANCEAPI_INSTRUMENT_FUNCTION()
+#elif defined(GREENFLAME_ENABLE_TRACE_RECORDER) && GREENFLAME_ENABLE_TRACE_RECORDER
+#include "greenflame_core/trace_recorder.h"
+
+#define GREENFLAME_PROFILE_CONCAT_INNER(a, b) a##b
+#define GREENFLAME_PROFILE_CONCAT(a, b) GREENFLAME_PROFILE_CONCAT_INNER(a, b)
+#define GREENFLAME_PROFILE_SCOPE(scope_name)                                           \
+    ::greenflame::core::TraceScope const GREENFLAME_PROFILE_CONCAT(                    \
+        greenflame_trace_scope_, __LINE__)(scope_name)
+#define GREENFLAME_PROFILE_FUNCTION() GREENFLAME_PROFILE_SCOPE(__FUNCTION__)
 #else
 #define GREENFLAME_PROFILE_SCOPE(scope_name)
 #define GREENFLAME_PROFILE_FUNCTION()
@@ -8,6 +8,12 @@ namespace greenflame::core {
 
 namespace {
 constexpr size_t kMaxWindowTitleChars = 50;
+constexpr size_t kNumPaddingWidth = 6;
+constexpr std::wstring_view kNumVariable = L"${num}";
+// Stands in for ${num} in expanded stems; it cannot occur in a file name.
+constexpr wchar_t kNumMarker = L'\0';
+constexpr std::array<std::wstring_view, 4> kIndexedExtensions = {
+    {L".png", L".jpg", L".jpeg", L".bmp"}};
 
 [[nodiscard]] std::wstring Pad_unsigned(unsigned value, size_t width) {
     auto s = std::to_wstring(value);
@@ -74,12 +80,27 @@ constexpr size_t kMaxWindowTitleChars = 50;
         return std::to_wstring(*ctx.monitor_index_zero_based + 1);
     }
     if (name == L"num") {
-        constexpr size_t k_padding_width = 6;
-        return Pad_unsigned(ctx.incrementing_number, k_padding_width);
+        return Pad_unsigned(ctx.incrementing_number, kNumPaddingWidth);
     }
     return {};
 }
 
+void Fold_case(std::wstring &text) {
+    for (wchar_t &ch : text) {
+        ch = static_cast<wchar_t>(std::towlower(ch));
+    }
+}
+
+[[nodiscard]] std::wstring Folded_directory(std::wstring_view directory) {
+    while (!directory.empty() &&
+           (directory.back() == L'\\' || directory.back() == L'/')) {
+        directory.remove_suffix(1);
+    }
+    std::wstring folded(directory);
+    Fold_case(folded);
+    return folded;
+}
+
 } // namespace
 
 std::wstring Sanitize_filename_segment(std::wstring_view input, size_t max_chars) {
@@ -129,27 +150,91 @@ unsigned
 Find_next_num_for_pattern(std::wstring_view pattern, FilenamePatternContext const &ctx,
                           std::vector<std::wstring> const &existing_filenames) {
     if (!Pattern_uses_num(pattern)) return 1;
+    SaveDirectoryIndex index;
+    index.Load({}, existing_filenames);
+    return index.Next_num(pattern, ctx);
+}
 
-    static constexpr std::wstring_view kExtensions[] = {L".png", L".jpg", L".jpeg",
-                                                        L".bmp"};
-    FilenamePatternContext trial_ctx = ctx;
-    for (unsigned num = 1;; ++num) {
-        trial_ctx.incrementing_number = num;
-        std::wstring const candidate = Expand_filename_pattern(pattern, trial_ctx);
-        bool found = false;
-        for (std::wstring const &existing : existing_filenames) {
-            for (std::wstring_view ext : kExtensions) {
-                std::wstring with_ext = candidate;
-                with_ext += ext;
-                if (Equals_no_case(existing, with_ext)) {
-                    found = true;
-                    break;
-                }
+bool SaveDirectoryIndex::Is_loaded_for(std::wstring_view directory) const {
+    return directory_.has_value() && *directory_ == Folded_directory(directory);
+}
+
+void SaveDirectoryIndex::Load(std::wstring_view directory,
+                              std::span<const std::wstring> filenames) {
+    Clear();
+    directory_ = Folded_directory(directory);
+    names_.reserve(filenames.size());
+    for (std::wstring const &filename : filenames) {
+        Add_filename(filename);
+    }
+}
+
+void SaveDirectoryIndex::Clear() noexcept {
+    directory_.reset();
+    names_.clear();
+    next_num_by_stem_.clear();
+}
+
+void SaveDirectoryIndex::Add_filename(std::wstring_view filename) {
+    std::wstring folded(filename);
+    Fold_case(folded);
+    names_.insert(std::move(folded));
+}
+
+void SaveDirectoryIndex::Add_saved_path(std::wstring_view path) {
+    size_t const slash = path.find_last_of(L"\\/");
+    if (slash == std::wstring_view::npos || slash + 1 >= path.size() ||
+        !Is_loaded_for(path.substr(0, slash))) {
+        return;
+    }
+    Add_filename(path.substr(slash + 1));
+}
+
+unsigned SaveDirectoryIndex::Next_num(std::wstring_view pattern,
+                                      FilenamePatternContext const &ctx) {
+    if (!Pattern_uses_num(pattern)) return 1;
+
+    // Expand everything but ${num} once; a probe then only substitutes digits.
+    std::wstring marked_pattern(pattern);
+    for (size_t at = marked_pattern.find(kNumVariable); at != std::wstring::npos;
+         at = marked_pattern.find(kNumVariable, at + 1)) {
+        marked_pattern.replace(at, kNumVariable.size(), 1, kNumMarker);
+    }
+    std::wstring stem = Expand_filename_pattern(marked_pattern, ctx);
+    Fold_case(stem);
+
+    auto [entry, inserted] = next_num_by_stem_.try_emplace(stem, 1u);
+    (void)inserted;
+    std::wstring candidate = {};
+    for (unsigned num = entry->second;; ++num) {
+        std::wstring const digits = Pad_unsigned(num, kNumPaddingWidth);
+        candidate.clear();
+        for (wchar_t const ch : stem) {
+            if (ch == kNumMarker) {
+                candidate += digits;
+            } else {
+                candidate.push_back(ch);
             }
-            if (found) break;
         }
-        if (!found) return num;
+        if (!Is_taken(candidate)) {
+            entry->second = num;
+            return num;
+        }
+    }
+}
+
+bool SaveDirectoryIndex::Is_taken(std::wstring &candidate) const {
+    size_t const stem_size = candidate.size();
+    for (std::wstring_view const extension : kIndexedExtensions) {
+        candidate.resize(stem_size);
+        candidate += extension;
+        if (names_.contains(candidate)) {
+            candidate.resize(stem_size);
+            return true;
+        }
     }
+    candidate.resize(stem_size);
+    return false;
 }
 
 std::wstring_view Default_filename_pattern(SaveSelectionSource source) {
@@ -56,6 +56,36 @@ Find_next_num_for_pattern(std::wstring_view pattern, FilenamePatternContext cons
 Expand_filename_pattern(std::wstring_view pattern,
                         FilenamePatternContext const &context);
 
+// Case-folded file names of one save directory, listed once and then kept current
+// as files are saved there, so ${num} resolution neither re-lists the directory
+// nor compares every name per candidate number. The app shares one index between
+// the overlay and the controller and clears it at the start of each overlay
+// session and CLI request, so files added or deleted elsewhere are seen then; a
+// different resolved directory is re-listed by Is_loaded_for.
+class SaveDirectoryIndex final {
+  public:
+    [[nodiscard]] bool Is_loaded_for(std::wstring_view directory) const;
+    void Load(std::wstring_view directory, std::span<const std::wstring> filenames);
+    void Clear() noexcept;
+
+    void Add_filename(std::wstring_view filename);
+    // Adds the file name when `path` is directly inside the indexed directory.
+    void Add_saved_path(std::wstring_view path);
+
+    // Same answer as Find_next_num_for_pattern over the indexed names. The search
+    // resumes where the last one for the same expanded pattern stopped, so a run
+    // of saves costs O(1) amortized per save.
+    [[nodiscard]] unsigned Next_num(std::wstring_view pattern,
+                                    FilenamePatternContext const &ctx);
+
+  private:
+    [[nodiscard]] bool Is_taken(std::wstring &candidate) const;
+
+    std::optional<std::wstring> directory_ = std::nullopt;
+    std::unordered_set<std::wstring> names_ = {};
+    std::unordered_map<std::wstring, unsigned> next_num_by_stem_ = {};
+};
+
 [[nodiscard]] std::wstring_view Default_filename_pattern(SaveSelectionSource source);
 
 [[nodiscard]] std::wstring
@@ -72,6 +102,22 @@ enum class ImageSaveFormat : uint8_t {
     Bmp = 2,
 };
 
+// Where encoded image bytes are delivered.
+enum class OutputSinkKind : uint8_t {
+    File = 0,
+    // Written to the process's standard output (`--output -`); no file is touched.
+    Stdout = 1,
+    // Returned to the caller in the save result.
+    Memory = 2,
+};
+
+// `--output` value that selects OutputSinkKind::Stdout.
+inline constexpr std::wstring_view kStdoutOutputPath = L"-";
+
+[[nodiscard]] constexpr bool Is_stdout_output_path(std::wstring_view path) noexcept {
+    return path == kStdoutOutputPath;
+}
+
 [[nodiscard]] ImageSaveFormat
 Image_save_format_from_config(AppConfig const &config) noexcept;
 
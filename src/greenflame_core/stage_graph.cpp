@@ -0,0 +1,249 @@
+#include "greenflame_core/stage_graph.h"
+
+#include "greenflame_core/parallel_for.h"
+#include "greenflame_core/trace_recorder.h"
+
+namespace greenflame::core {
+
+namespace {
+
+// Shared by the caller and the workers while a graph runs; guarded by `mutex`.
+struct StageGraphRunState final {
+    std::mutex mutex = {};
+    std::condition_variable changed = {};
+    std::deque<size_t> ready_caller = {};
+    std::deque<size_t> ready_any = {};
+    std::vector<size_t> waiting_on = {}; // unfinished producers per stage
+    size_t finished = 0;
+};
+
+} // namespace
+
+size_t StageGraph::Add_stage(char const *name, StageThread thread,
+                             std::initializer_list<std::string_view> inputs,
+                             std::initializer_list<std::string_view> outputs,
+                             StageFunction run) {
+    stages_.push_back(Stage{name, thread, inputs, outputs, std::move(run)});
+    return stages_.size() - 1;
+}
+
+bool StageGraph::Try_build_dependencies(
+    std::vector<std::vector<size_t>> &dependencies) const {
+    std::unordered_map<std::string_view, size_t> producer_of = {};
+    for (size_t index = 0; index < stages_.size(); ++index) {
+        for (std::string_view const output : stages_[index].outputs) {
+            if (!producer_of.emplace(output, index).second) {
+                return false;
+            }
+        }
+    }
+
+    dependencies.assign(stages_.size(), {});
+    for (size_t index = 0; index < stages_.size(); ++index) {
+        std::vector<size_t> &producers = dependencies[index];
+        for (std::string_view const input : stages_[index].inputs) {
+            auto const producer = producer_of.find(input);
+            if (producer == producer_of.end() || producer->second == index) {
+                return false;
+            }
+            if (std::find(producers.begin(), producers.end(), producer->second) ==
+                producers.end()) {
+                producers.push_back(producer->second);
+            }
+        }
+    }
+    return true;
+}
+
+bool StageGraph::Is_valid() const {
+    std::vector<std::vector<size_t>> dependencies = {};
+    if (!Try_build_dependencies(dependencies)) {
+        return false;
+    }
+
+    // Kahn's algorithm: every stage is reachable in topological order only
+    // when there is no cycle.
+    std::vector<size_t> waiting_on(stages_.size());
+    std::vector<std::vector<size_t>> dependents(stages_.size());
+    std::vector<size_t> ready = {};
+    for (size_t index = 0; index < stages_.size(); ++index) {
+        waiting_on[index] = dependencies[index].size();
+        for (size_t const producer : dependencies[index]) {
+            dependents[producer].push_back(index);
+        }
+        if (waiting_on[index] == 0) {
+            ready.push_back(index);
+        }
+    }
+    size_t ordered = 0;
+    while (!ready.empty()) {
+        size_t const index = ready.back();
+        ready.pop_back();
+        ++ordered;
+        for (size_t const dependent : dependents[index]) {
+            if (--waiting_on[dependent] == 0) {
+                ready.push_back(dependent);
+            }
+        }
+    }
+    return ordered == stages_.size();
+}
+
+StageGraphResult StageGraph::Run(size_t max_workers) {
+    StageGraphResult result = {};
+    result.stages.resize(stages_.size());
+    for (size_t index = 0; index < stages_.size(); ++index) {
+        result.stages[index].name = stages_[index].name;
+    }
+
+    std::vector<std::vector<size_t>> dependencies = {};
+    if (!Is_valid() || !Try_build_dependencies(dependencies)) {
+        for (StageTiming &timing : result.stages) {
+            timing.status = StageStatus::Skipped;
+        }
+        return result;
+    }
+
+    std::vector<std::vector<size_t>> dependents(stages_.size());
+    StageGraphRunState state = {};
+    state.waiting_on.resize(stages_.size());
+    size_t any_stages = 0;
+    for (size_t index = 0; index < stages_.size(); ++index) {
+        for (size_t const producer : dependencies[index]) {
+            dependents[producer].push_back(index);
+        }
+        state.waiting_on[index] = dependencies[index].size();
+        if (stages_[index].thread == StageThread::Any) {
+            ++any_stages;
+        }
+    }
+
+    // Called with the mutex held.
+    auto const enqueue = [&](size_t index) {
+        if (stages_[index].thread == StageThread::Caller) {
+            state.ready_caller.push_back(index);
+        } else {
+            state.ready_any.push_back(index);
+        }
+    };
+    auto const complete = [&](size_t index, bool succeeded) {
+        result.stages[index].status =
+            succeeded ? StageStatus::Succeeded : StageStatus::Failed;
+        ++state.finished;
+        std::vector<size_t> skipped = {};
+        for (size_t const dependent : dependents[index]) {
+            if (result.stages[dependent].status != StageStatus::Pending) {
+                continue;
+            }
+            if (!succeeded) {
+                skipped.push_back(dependent);
+            } else if (--state.waiting_on[dependent] == 0) {
+                enqueue(dependent);
+            }
+        }
+        while (!skipped.empty()) {
+            size_t const skip = skipped.back();
+            skipped.pop_back();
+            if (result.stages[skip].status != StageStatus::Pending) {
+                continue;
+            }
+            result.stages[skip].status = StageStatus::Skipped;
+            ++state.finished;
+            for (size_t const dependent : dependents[skip]) {
+                skipped.push_back(dependent);
+            }
+        }
+    };
+
+    int64_t const start_ns = TraceRecorder::Now_ns();
+    auto const run_stage = [&](size_t index, bool on_caller) {
+        TraceRecorder &recorder = TraceRecorder::Instance();
+        int64_t const begin_ns = TraceRecorder::Now_ns();
+        // A throwing stage fails like one returning false, so its dependents are
+        // skipped instead of waited on forever.
+        bool succeeded = true;
+        if (stages_[index].run) {
+            try {
+                succeeded = stages_[index].run();
+            } catch (...) {
+                succeeded = false;
+            }
+        }
+        int64_t const end_ns = TraceRecorder::Now_ns();
+        if (recorder.Is_enabled()) {
+            recorder.Record(stages_[index].name, begin_ns, end_ns);
+        }
+
+        std::scoped_lock lock(state.mutex);
+        StageTiming &timing = result.stages[index];
+        timing.begin_ns = begin_ns - start_ns;
+        timing.end_ns = end_ns - start_ns;
+        timing.ran_on_caller = on_caller;
+        complete(index, succeeded);
+    };
+
+    {
+        std::scoped_lock lock(state.mutex);
+        for (size_t index = 0; index < stages_.size(); ++index) {
+            if (state.waiting_on[index] == 0) {
+                enqueue(index);
+            }
+        }
+    }
+
+    auto const worker = [&]() {
+        std::unique_lock lock(state.mutex);
+        for (;;) {
+            state.changed.wait(lock, [&] {
+                return !state.ready_any.empty() || state.finished == stages_.size();
+            });
+            if (state.ready_any.empty()) {
+                return;
+            }
+            size_t const index = state.ready_any.front();
+            state.ready_any.pop_front();
+            lock.unlock();
+            run_stage(index, false);
+            state.changed.notify_all();
+            lock.lock();
+        }
+    };
+
+    // The caller runs its own stages first and otherwise helps with Any stages.
+    auto const caller = [&]() {
+        std::unique_lock lock(state.mutex);
+        for (;;) {
+            state.changed.wait(lock, [&] {
+                return !state.ready_caller.empty() || !state.ready_any.empty() ||
+                       state.finished == stages_.size();
+            });
+            std::deque<size_t> &queue =
+                state.ready_caller.empty() ? state.ready_any : state.ready_caller;
+            if (queue.empty()) {
+                break;
+            }
+            size_t const index = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            run_stage(index, true);
+            state.changed.notify_all();
+            lock.lock();
+        }
+    };
+
+    // Workers the pool cannot start yet are picked up by the caller once every
+    // stage has finished, where they return at once.
+    size_t const workers =
+        max_workers <= 1 ? 0 : std::min(max_workers - 1, any_stages);
+    Parallel_for(workers, {.max_workers = workers + 1}, [&](size_t) { worker(); },
+                 caller);
+
+    result.total_ns = TraceRecorder::Now_ns() - start_ns;
+    result.success = std::all_of(result.stages.begin(), result.stages.end(),
+                                 [](StageTiming const &timing) {
+                                     return timing.status == StageStatus::Succeeded;
+                                 });
+    return result;
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,82 @@
+#pragma once
+
+namespace greenflame::core {
+
+// Caller stages always run on the thread that called StageGraph::Run (window
+// creation, apartment-bound COM objects, thread-affine render targets). Any
+// stages may also run on a worker.
+enum class StageThread : uint8_t {
+    Caller,
+    Any,
+};
+
+enum class StageStatus : uint8_t {
+    Pending,
+    Succeeded,
+    Failed,
+    Skipped, // an input's producer failed or was skipped
+};
+
+struct StageTiming final {
+    char const *name = "";
+    StageStatus status = StageStatus::Pending;
+    // Relative to the start of Run; both 0 for stages that never ran.
+    int64_t begin_ns = 0;
+    int64_t end_ns = 0;
+    bool ran_on_caller = false;
+};
+
+struct StageGraphResult final {
+    bool success = false; // every stage succeeded
+    int64_t total_ns = 0;
+    std::vector<StageTiming> stages = {}; // in Add_stage order
+
+    [[nodiscard]] StageStatus Status(size_t stage) const noexcept {
+        return stage < stages.size() ? stages[stage].status : StageStatus::Pending;
+    }
+};
+
+// Small dependency-graph executor for startup work. Each stage names the values
+// it reads and the values it produces; it becomes ready as soon as every
+// producer of its inputs has succeeded, and is skipped when one of them failed.
+// Values themselves live wherever the stage functions put them. Each stage is
+// timed and, when the trace recorder is on, recorded under its name.
+class StageGraph final {
+  public:
+    using StageFunction = std::function<bool()>;
+
+    // `name`, `inputs` and `outputs` must outlive the graph; string literals.
+    // Returns the stage's index into StageGraphResult::stages.
+    size_t Add_stage(char const *name, StageThread thread,
+                     std::initializer_list<std::string_view> inputs,
+                     std::initializer_list<std::string_view> outputs,
+                     StageFunction run);
+
+    // Every input has exactly one producer, no value is produced twice and the
+    // stages form no cycle.
+    [[nodiscard]] bool Is_valid() const;
+
+    // Runs every stage once. Ready Any stages are shared by the caller and up to
+    // `max_workers - 1` threads of the shared worker pool; 0 or 1 runs everything
+    // on the caller. A stage that throws counts as Failed. An invalid graph runs
+    // nothing and reports every stage Skipped.
+    [[nodiscard]] StageGraphResult Run(size_t max_workers);
+
+  private:
+    struct Stage final {
+        char const *name = "";
+        StageThread thread = StageThread::Any;
+        std::vector<std::string_view> inputs = {};
+        std::vector<std::string_view> outputs = {};
+        StageFunction run = {};
+    };
+
+    // Producer stage indices per stage; false when an input has no single
+    // producer or a value is produced twice.
+    [[nodiscard]] bool
+    Try_build_dependencies(std::vector<std::vector<size_t>> &dependencies) const;
+
+    std::vector<Stage> stages_ = {};
+};
+
+} // namespace greenflame::core
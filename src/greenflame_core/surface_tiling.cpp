@@ -0,0 +1,131 @@
+#include "greenflame_core/surface_tiling.h"
+
+namespace greenflame::core {
+
+namespace {
+
+[[nodiscard]] std::vector<int32_t> Make_edges(int32_t extent, int32_t max_tile_px) {
+    int64_t const count =
+        max_tile_px > 0 ? (static_cast<int64_t>(extent) + max_tile_px - 1) / max_tile_px
+                        : 1;
+    std::vector<int32_t> edges = {};
+    edges.reserve(static_cast<size_t>(count) + 1);
+    for (int64_t index = 0; index <= count; ++index) {
+        edges.push_back(static_cast<int32_t>(extent * index / count));
+    }
+    return edges;
+}
+
+// Segment holding `value`; edges must span it.
+[[nodiscard]] size_t Segment_at(std::vector<int32_t> const &edges,
+                                int32_t value) noexcept {
+    auto const after = std::upper_bound(edges.begin(), edges.end(), value);
+    return static_cast<size_t>(after - edges.begin()) - 1;
+}
+
+} // namespace
+
+SurfaceTileGrid::SurfaceTileGrid(int32_t width, int32_t height, int32_t max_tile_px) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    column_edges_ = Make_edges(width, max_tile_px);
+    row_edges_ = Make_edges(height, max_tile_px);
+}
+
+bool SurfaceTileGrid::Is_empty() const noexcept { return column_edges_.empty(); }
+
+bool SurfaceTileGrid::Is_tiled() const noexcept { return Tile_count() > 1; }
+
+int32_t SurfaceTileGrid::Width() const noexcept {
+    return Is_empty() ? 0 : column_edges_.back();
+}
+
+int32_t SurfaceTileGrid::Height() const noexcept {
+    return Is_empty() ? 0 : row_edges_.back();
+}
+
+size_t SurfaceTileGrid::Columns() const noexcept {
+    return Is_empty() ? 0 : column_edges_.size() - 1;
+}
+
+size_t SurfaceTileGrid::Rows() const noexcept {
+    return Is_empty() ? 0 : row_edges_.size() - 1;
+}
+
+size_t SurfaceTileGrid::Tile_count() const noexcept { return Columns() * Rows(); }
+
+RectPx SurfaceTileGrid::Tile_bounds(size_t tile_index) const noexcept {
+    if (tile_index >= Tile_count()) {
+        return {};
+    }
+    size_t const column = tile_index % Columns();
+    size_t const row = tile_index / Columns();
+    return RectPx::From_ltrb(column_edges_[column], row_edges_[row],
+                             column_edges_[column + 1], row_edges_[row + 1]);
+}
+
+std::optional<size_t> SurfaceTileGrid::Tile_index_at(PointPx point) const noexcept {
+    if (Is_empty() || point.x < 0 || point.y < 0 || point.x >= Width() ||
+        point.y >= Height()) {
+        return std::nullopt;
+    }
+    return Segment_at(row_edges_, point.y) * Columns() +
+           Segment_at(column_edges_, point.x);
+}
+
+PointPx SurfaceTileGrid::To_tile_local(size_t tile_index,
+                                       PointPx point) const noexcept {
+    RectPx const bounds = Tile_bounds(tile_index);
+    return {point.x - bounds.left, point.y - bounds.top};
+}
+
+RectPx SurfaceTileGrid::To_tile_local(size_t tile_index, RectPx rect) const noexcept {
+    RectPx const bounds = Tile_bounds(tile_index);
+    return RectPx::From_ltrb(rect.left - bounds.left, rect.top - bounds.top,
+                             rect.right - bounds.left, rect.bottom - bounds.top);
+}
+
+std::vector<SurfaceTileSpan> SurfaceTileGrid::Split(RectPx rect) const {
+    std::vector<SurfaceTileSpan> spans = {};
+    if (Is_empty()) {
+        return spans;
+    }
+    std::optional<RectPx> const clipped = RectPx::Clip(
+        rect.Normalized(), RectPx::From_ltrb(0, 0, Width(), Height()));
+    if (!clipped.has_value()) {
+        return spans;
+    }
+    size_t const first_column = Segment_at(column_edges_, clipped->left);
+    size_t const first_row = Segment_at(row_edges_, clipped->top);
+    for (size_t row = first_row; row_edges_[row] < clipped->bottom; ++row) {
+        for (size_t column = first_column; column_edges_[column] < clipped->right;
+             ++column) {
+            size_t const tile_index = row * Columns() + column;
+            std::optional<RectPx> const part =
+                RectPx::Intersect(*clipped, Tile_bounds(tile_index));
+            if (part.has_value()) {
+                spans.push_back({tile_index, *part, To_tile_local(tile_index, *part)});
+            }
+        }
+    }
+    return spans;
+}
+
+SurfaceFit Fit_surface_to_limit(int32_t width, int32_t height,
+                                int32_t max_px) noexcept {
+    if (width <= 0 || height <= 0) {
+        return {};
+    }
+    int32_t const longest = std::max(width, height);
+    if (max_px <= 0 || longest <= max_px) {
+        return SurfaceFit{1.f, width, height};
+    }
+    double const scale = static_cast<double>(max_px) / static_cast<double>(longest);
+    auto const fit = [&](int32_t extent) {
+        return std::clamp(static_cast<int32_t>(std::ceil(extent * scale)), 1, max_px);
+    };
+    return SurfaceFit{static_cast<float>(scale), fit(width), fit(height)};
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "greenflame_core/rect_px.h"
+
+namespace greenflame::core {
+
+// Direct3D feature level 11 guarantees textures of this size per side; the
+// renderer replaces it with the device's actual limit when one is available.
+inline constexpr int32_t kDefaultMaxSurfaceTilePx = 16384;
+
+// Part of a surface rect that lies in one tile, in surface and tile-local pixels.
+struct SurfaceTileSpan final {
+    size_t tile_index = 0;
+    RectPx surface_rect = {};
+    RectPx local_rect = {};
+
+    constexpr bool operator==(SurfaceTileSpan const &) const noexcept = default;
+};
+
+// Splits a width x height surface (origin at 0,0) into the fewest row-major tiles
+// no larger than max_tile_px per side. Each axis is split evenly, so a surface a
+// few pixels over the limit does not leave a sliver tile. A non-positive limit
+// means no limit: one tile covers the surface.
+class SurfaceTileGrid final {
+  public:
+    SurfaceTileGrid() = default;
+    SurfaceTileGrid(int32_t width, int32_t height, int32_t max_tile_px);
+
+    [[nodiscard]] bool Is_empty() const noexcept;
+    // True when the surface needs more than one tile.
+    [[nodiscard]] bool Is_tiled() const noexcept;
+    [[nodiscard]] int32_t Width() const noexcept;
+    [[nodiscard]] int32_t Height() const noexcept;
+    [[nodiscard]] size_t Columns() const noexcept;
+    [[nodiscard]] size_t Rows() const noexcept;
+    [[nodiscard]] size_t Tile_count() const noexcept;
+
+    // Surface pixels covered by the tile; empty for an out-of-range index.
+    [[nodiscard]] RectPx Tile_bounds(size_t tile_index) const noexcept;
+    // Tile holding the pixel, or nullopt when it lies outside the surface.
+    [[nodiscard]] std::optional<size_t> Tile_index_at(PointPx point) const noexcept;
+    [[nodiscard]] PointPx To_tile_local(size_t tile_index,
+                                        PointPx point) const noexcept;
+    [[nodiscard]] RectPx To_tile_local(size_t tile_index, RectPx rect) const noexcept;
+
+    // The tiles a surface rect touches, clipped to the surface, in row-major order.
+    // The spans cover every surface pixel of the rect exactly once.
+    [[nodiscard]] std::vector<SurfaceTileSpan> Split(RectPx rect) const;
+
+  private:
+    // Tile edges along each axis: edges[i] .. edges[i + 1] is column or row i.
+    std::vector<int32_t> column_edges_ = {};
+    std::vector<int32_t> row_edges_ = {};
+};
+
+// A single surface standing in for a larger one: `scale` maps the large surface's
+// pixels onto its `width` x `height` pixels.
+struct SurfaceFit final {
+    float scale = 1.f;
+    int32_t width = 0;
+    int32_t height = 0;
+
+    constexpr bool operator==(SurfaceFit const &) const noexcept = default;
+};
+
+// The largest uniform downscale of a width x height surface that keeps both sides
+// within max_px; scale 1 and the same size when it already fits. Render targets
+// that cannot be tiled (the overlay's swap chain and layer caches) use it, while
+// bitmaps keep full resolution through SurfaceTileGrid.
+[[nodiscard]] SurfaceFit Fit_surface_to_limit(int32_t width, int32_t height,
+                                              int32_t max_px) noexcept;
+
+} // namespace greenflame::core
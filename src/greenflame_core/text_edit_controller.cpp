@@ -168,8 +168,8 @@ TextEditController::TextEditController(PointPx origin,
                                        TextAnnotationBaseStyle const &base_style,
                                        ITextLayoutEngine *layout_engine,
                                        ISpellCheckService *spell_check_service)
-    : origin_(origin), layout_engine_(layout_engine),
-      spell_check_service_(spell_check_service) {
+    : origin_(origin), layout_cache_(layout_engine),
+      spell_checker_(spell_check_service) {
     buffer_.base_style = base_style;
     draft_annotation_.origin = origin_;
     draft_annotation_.base_style = base_style;
@@ -183,8 +183,8 @@ TextEditController::TextEditController(PointPx origin,
                                        std::vector<TextRun> initial_runs,
                                        ITextLayoutEngine *layout_engine,
                                        ISpellCheckService *spell_check_service)
-    : origin_(origin), layout_engine_(layout_engine),
-      spell_check_service_(spell_check_service) {
+    : origin_(origin), layout_cache_(layout_engine),
+      spell_checker_(spell_check_service) {
     buffer_.base_style = base_style;
     buffer_.runs = std::move(initial_runs);
     draft_annotation_.origin = origin_;
@@ -197,7 +197,9 @@ TextEditController::TextEditController(PointPx origin,
 TextDraftView TextEditController::Build_view() const {
     return TextDraftView{&draft_annotation_,           layout_.visual_bounds,
                          layout_.selection_rects,      layout_.caret_rect,
-                         layout_.overwrite_caret_rect, spell_errors_,
+                         layout_.overwrite_caret_rect,
+                         std::vector<SpellError>(spell_checker_.Errors().begin(),
+                                                 spell_checker_.Errors().end()),
                          !buffer_.overwrite_mode};
 }
 
@@ -561,18 +563,13 @@ void TextEditController::Rebuild_layout() {
     draft_annotation_.bitmap_row_bytes = 0;
     draft_annotation_.premultiplied_bgra.clear();
 
-    if (layout_engine_ != nullptr) {
-        layout_ = layout_engine_->Build_draft_layout(buffer_, origin_);
-    } else {
-        layout_ = {};
-    }
+    // Caret and selection changes are served from cached paragraph metrics; the
+    // engine only sees paragraphs whose text or style changed.
+    layout_ = layout_cache_.Layout(buffer_, origin_);
     draft_annotation_.visual_bounds = layout_.visual_bounds;
 
-    if (spell_check_service_ != nullptr) {
-        spell_errors_ = spell_check_service_->Check(Flatten_text(buffer_.runs));
-    } else {
-        spell_errors_.clear();
-    }
+    // Only paragraphs touched since the last rebuild reach the service.
+    (void)spell_checker_.Update(Flatten_text(buffer_.runs));
 }
 
 void TextEditController::Refresh_preferred_x_from_layout() noexcept {
@@ -648,11 +645,8 @@ int32_t TextEditController::Current_text_length() const {
     return total_length;
 }
 
-int32_t TextEditController::Hit_test_offset(PointPx cursor) const {
-    if (layout_engine_ == nullptr) {
-        return 0;
-    }
-    return std::clamp(layout_engine_->Hit_test_point(buffer_, origin_, cursor), 0,
+int32_t TextEditController::Hit_test_offset(PointPx cursor) {
+    return std::clamp(layout_cache_.Hit_test_point(buffer_, origin_, cursor), 0,
                       Current_text_length());
 }
 
@@ -673,13 +667,9 @@ void TextEditController::Sync_typing_style_to_cursor() {
     }
 }
 
-int32_t TextEditController::Move_vertical(int32_t offset, int delta_lines) const {
-    if (layout_engine_ == nullptr) {
-        return offset;
-    }
-    return std::clamp(layout_engine_->Move_vertical(buffer_, origin_, offset,
-                                                    delta_lines,
-                                                    buffer_.preferred_x_px),
+int32_t TextEditController::Move_vertical(int32_t offset, int delta_lines) {
+    return std::clamp(layout_cache_.Move_vertical(buffer_, origin_, offset, delta_lines,
+                                                  buffer_.preferred_x_px),
                       0, Current_text_length());
 }
 
@@ -1,7 +1,7 @@
 #pragma once
 
-#include "greenflame_core/spell_check_service.h"
-#include "greenflame_core/text_layout_engine.h"
+#include "greenflame_core/incremental_spell_checker.h"
+#include "greenflame_core/text_layout_cache.h"
 
 namespace greenflame::core {
 
@@ -96,19 +96,18 @@ class TextEditController final {
     void Replace_selection_with_text(std::wstring_view text, bool allow_overwrite);
     void Delete_selected_range();
     [[nodiscard]] int32_t Current_text_length() const;
-    [[nodiscard]] int32_t Hit_test_offset(PointPx cursor) const;
+    [[nodiscard]] int32_t Hit_test_offset(PointPx cursor);
     void Sync_typing_style_to_cursor();
-    [[nodiscard]] int32_t Move_vertical(int32_t offset, int delta_lines) const;
+    [[nodiscard]] int32_t Move_vertical(int32_t offset, int delta_lines);
 
     TextDraftBuffer buffer_ = {};
     PointPx origin_ = {};
     std::vector<TextDraftSnapshot> history_ = {};
     size_t history_index_ = 0;
-    ITextLayoutEngine *layout_engine_ = nullptr;
-    ISpellCheckService *spell_check_service_ = nullptr;
+    TextLayoutCache layout_cache_;
+    IncrementalSpellChecker spell_checker_;
     DraftTextLayoutResult layout_ = {};
     TextAnnotation draft_annotation_ = {};
-    std::vector<SpellError> spell_errors_ = {};
     bool pointer_selecting_ = false;
 };
 
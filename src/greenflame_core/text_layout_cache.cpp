@@ -0,0 +1,310 @@
+#include "greenflame_core/text_layout_cache.h"
+
+namespace greenflame::core {
+
+namespace {
+
+[[nodiscard]] int32_t Floor_to_int(float value) noexcept {
+    return static_cast<int32_t>(std::floor(value));
+}
+
+[[nodiscard]] int32_t Ceil_to_int(float value) noexcept {
+    return static_cast<int32_t>(std::ceil(value));
+}
+
+[[nodiscard]] int32_t Round_to_int(float value) noexcept {
+    return static_cast<int32_t>(std::lround(value));
+}
+
+[[nodiscard]] RectPx Rect_from_left_top_width_height(float left, float top, float width,
+                                                     float height) noexcept {
+    return RectPx::From_ltrb(Floor_to_int(left), Floor_to_int(top),
+                             Ceil_to_int(left + width), Ceil_to_int(top + height));
+}
+
+[[nodiscard]] int32_t Paragraph_length(std::span<const TextRun> runs) noexcept {
+    int32_t length = 0;
+    for (TextRun const &run : runs) {
+        length += static_cast<int32_t>(run.text.size());
+    }
+    return length;
+}
+
+// Splits runs at L'\n'. The separators are dropped, so N newlines always yield
+// N + 1 paragraphs (possibly empty), matching the lines of a no-wrap layout.
+[[nodiscard]] std::vector<std::vector<TextRun>>
+Split_paragraphs(std::span<const TextRun> runs) {
+    std::vector<std::vector<TextRun>> paragraphs(1);
+    for (TextRun const &run : runs) {
+        size_t begin = 0;
+        while (true) {
+            size_t const separator = run.text.find(L'\n', begin);
+            size_t const end =
+                separator == std::wstring::npos ? run.text.size() : separator;
+            if (end > begin) {
+                paragraphs.back().push_back(
+                    TextRun{run.text.substr(begin, end - begin), run.flags});
+            }
+            if (separator == std::wstring::npos) {
+                break;
+            }
+            paragraphs.emplace_back();
+            begin = separator + 1;
+        }
+    }
+    return paragraphs;
+}
+
+} // namespace
+
+TextLayoutCache::TextLayoutCache(ITextLayoutEngine *engine) noexcept
+    : engine_(engine) {}
+
+DraftTextLayoutResult const &TextLayoutCache::Layout(TextDraftBuffer const &buf,
+                                                     PointPx origin) {
+    TextLayoutChange change = Classify(buf);
+    if (change == TextLayoutChange::None && origin != layout_origin_) {
+        change = TextLayoutChange::Selection;
+    }
+    last_change_ = change;
+    if (has_layout_ && change == TextLayoutChange::None) {
+        return layout_;
+    }
+
+    // Empty drafts keep the engine's placeholder caret geometry.
+    bool const empty = Paragraph_length(buf.runs) == 0;
+    if (!empty && Sync_metrics(buf)) {
+        Build_result_from_metrics(buf, origin);
+    } else if (engine_ != nullptr) {
+        layout_ = engine_->Build_draft_layout(buf, origin);
+    } else {
+        layout_ = {};
+    }
+
+    layout_buffer_ = buf;
+    layout_origin_ = origin;
+    has_layout_ = true;
+    return layout_;
+}
+
+int32_t TextLayoutCache::Hit_test_point(TextDraftBuffer const &buf, PointPx origin,
+                                        PointPx point) {
+    if (!Sync_metrics(buf)) {
+        return engine_ != nullptr ? engine_->Hit_test_point(buf, origin, point) : 0;
+    }
+    if (text_length_ == 0) {
+        return 0;
+    }
+
+    size_t const index = Paragraph_index_for_y(static_cast<float>(point.y - origin.y));
+    return Offset_in_paragraph(index, static_cast<float>(point.x - origin.x));
+}
+
+int32_t TextLayoutCache::Move_vertical(TextDraftBuffer const &buf, PointPx origin,
+                                       int32_t offset, int delta_lines,
+                                       int32_t preferred_x_px) {
+    if (!Sync_metrics(buf)) {
+        return engine_ != nullptr ? engine_->Move_vertical(buf, origin, offset,
+                                                           delta_lines, preferred_x_px)
+                                  : offset;
+    }
+
+    int32_t const clamped = std::clamp(offset, 0, text_length_);
+    if (text_length_ == 0 || delta_lines == 0) {
+        return clamped;
+    }
+
+    int64_t const target = static_cast<int64_t>(Paragraph_index_for_offset(clamped)) +
+                           static_cast<int64_t>(delta_lines);
+    if (target < 0) {
+        return 0;
+    }
+    if (target >= static_cast<int64_t>(paragraphs_.size())) {
+        return text_length_;
+    }
+    return Offset_in_paragraph(static_cast<size_t>(target),
+                               static_cast<float>(preferred_x_px));
+}
+
+TextLayoutChange TextLayoutCache::Last_change() const noexcept { return last_change_; }
+
+void TextLayoutCache::Invalidate() noexcept {
+    has_layout_ = false;
+    has_metrics_ = false;
+    metrics_supported_ = true;
+    paragraphs_.clear();
+    metrics_runs_.clear();
+}
+
+TextLayoutChange TextLayoutCache::Classify(TextDraftBuffer const &buf) const {
+    if (!has_layout_ || buf.base_style != layout_buffer_.base_style) {
+        return TextLayoutChange::Style;
+    }
+    if (buf.runs != layout_buffer_.runs) {
+        return TextLayoutChange::Content;
+    }
+    if (buf != layout_buffer_) {
+        return TextLayoutChange::Selection;
+    }
+    return TextLayoutChange::None;
+}
+
+bool TextLayoutCache::Sync_metrics(TextDraftBuffer const &buf) {
+    if (engine_ == nullptr || !metrics_supported_) {
+        return false;
+    }
+    if (has_metrics_ && buf.base_style == metrics_style_ && buf.runs == metrics_runs_) {
+        return true;
+    }
+
+    std::vector<std::vector<TextRun>> split = Split_paragraphs(buf.runs);
+    std::vector<Paragraph> previous = {};
+    if (has_metrics_ && buf.base_style == metrics_style_) {
+        previous = std::move(paragraphs_);
+    }
+    has_metrics_ = false;
+    paragraphs_.clear();
+
+    // Paragraphs matching at the front or the back of the previous layout keep
+    // their metrics; only the edited ones in between are re-measured.
+    size_t const common = std::min(previous.size(), split.size());
+    size_t prefix = 0;
+    while (prefix < common && previous[prefix].runs == split[prefix]) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < common - prefix &&
+           previous[previous.size() - 1 - suffix].runs ==
+               split[split.size() - 1 - suffix]) {
+        ++suffix;
+    }
+
+    std::vector<Paragraph> next = {};
+    next.reserve(split.size());
+    int32_t start = 0;
+    float top = 0.0f;
+    for (size_t index = 0; index < split.size(); ++index) {
+        Paragraph paragraph{};
+        if (index < prefix) {
+            paragraph = std::move(previous[index]);
+        } else if (index >= split.size() - suffix) {
+            paragraph = std::move(previous[previous.size() - (split.size() - index)]);
+        } else {
+            paragraph.runs = std::move(split[index]);
+            if (!engine_->Measure_paragraph(buf.base_style, paragraph.runs,
+                                            paragraph.metrics) ||
+                paragraph.metrics.caret_x_px.size() !=
+                    static_cast<size_t>(Paragraph_length(paragraph.runs)) + 1) {
+                metrics_supported_ = false;
+                return false;
+            }
+        }
+        paragraph.start_utf16 = start;
+        paragraph.top_px = top;
+        start += Paragraph_length(paragraph.runs) + 1;
+        top += paragraph.metrics.height_px;
+        next.push_back(std::move(paragraph));
+    }
+
+    paragraphs_ = std::move(next);
+    text_length_ = start - 1;
+    metrics_style_ = buf.base_style;
+    metrics_runs_ = buf.runs;
+    has_metrics_ = true;
+    return true;
+}
+
+size_t TextLayoutCache::Paragraph_index_for_offset(int32_t offset) const noexcept {
+    auto const it =
+        std::upper_bound(paragraphs_.begin(), paragraphs_.end(), offset,
+                         [](int32_t value, Paragraph const &paragraph) {
+                             return value < paragraph.start_utf16;
+                         });
+    return it == paragraphs_.begin()
+               ? 0
+               : static_cast<size_t>(std::distance(paragraphs_.begin(), it)) - 1;
+}
+
+size_t TextLayoutCache::Paragraph_index_for_y(float y) const noexcept {
+    for (size_t index = 0; index < paragraphs_.size(); ++index) {
+        Paragraph const &paragraph = paragraphs_[index];
+        if (y < paragraph.top_px + paragraph.metrics.height_px) {
+            return index;
+        }
+    }
+    return paragraphs_.empty() ? 0 : paragraphs_.size() - 1;
+}
+
+int32_t TextLayoutCache::Offset_in_paragraph(size_t index, float x) const noexcept {
+    // Same rule as a leading/trailing hit test: the caret lands after a
+    // character once the point passes that character's midpoint.
+    Paragraph const &paragraph = paragraphs_[index];
+    std::vector<float> const &caret_x = paragraph.metrics.caret_x_px;
+    size_t column = 0;
+    while (column + 1 < caret_x.size() &&
+           x >= (caret_x[column] + caret_x[column + 1]) * 0.5f) {
+        ++column;
+    }
+    return paragraph.start_utf16 + static_cast<int32_t>(column);
+}
+
+void TextLayoutCache::Build_result_from_metrics(TextDraftBuffer const &buf,
+                                                PointPx origin) {
+    DraftTextLayoutResult result{};
+    float const origin_x = static_cast<float>(origin.x);
+    float const origin_y = static_cast<float>(origin.y);
+
+    float width = 0.0f;
+    for (Paragraph const &paragraph : paragraphs_) {
+        width = std::max(width, paragraph.metrics.caret_x_px.back());
+    }
+    Paragraph const &last = paragraphs_.back();
+    result.visual_bounds = Rect_from_left_top_width_height(
+        origin_x, origin_y, width, last.top_px + last.metrics.height_px);
+
+    int32_t const selection_start = std::clamp(
+        std::min(buf.selection.anchor_utf16, buf.selection.active_utf16), 0,
+        text_length_);
+    int32_t const selection_end = std::clamp(
+        std::max(buf.selection.anchor_utf16, buf.selection.active_utf16), 0,
+        text_length_);
+    if (selection_start < selection_end) {
+        size_t const first = Paragraph_index_for_offset(selection_start);
+        size_t const last_index = Paragraph_index_for_offset(selection_end);
+        for (size_t index = first; index <= last_index; ++index) {
+            Paragraph const &paragraph = paragraphs_[index];
+            int32_t const length = Paragraph_length(paragraph.runs);
+            int32_t const from = std::max(selection_start, paragraph.start_utf16) -
+                                 paragraph.start_utf16;
+            int32_t const to = std::min(selection_end, paragraph.start_utf16 + length) -
+                               paragraph.start_utf16;
+            if (to <= from) {
+                continue;
+            }
+            float const left = paragraph.metrics.caret_x_px[static_cast<size_t>(from)];
+            float const right = paragraph.metrics.caret_x_px[static_cast<size_t>(to)];
+            result.selection_rects.push_back(Rect_from_left_top_width_height(
+                origin_x + left, origin_y + paragraph.top_px, right - left,
+                paragraph.metrics.height_px));
+        }
+    }
+
+    int32_t const active = std::clamp(buf.selection.active_utf16, 0, text_length_);
+    Paragraph const &caret_paragraph = paragraphs_[Paragraph_index_for_offset(active)];
+    std::vector<float> const &caret_x = caret_paragraph.metrics.caret_x_px;
+    size_t const column = static_cast<size_t>(active - caret_paragraph.start_utf16);
+    int32_t const left = origin.x + Floor_to_int(caret_x[column]);
+    int32_t const top = origin.y + Floor_to_int(caret_paragraph.top_px);
+    int32_t const height = std::max(1, Ceil_to_int(caret_paragraph.metrics.height_px));
+    int32_t const overwrite_width =
+        column + 1 < caret_x.size()
+            ? std::max(1, Round_to_int(caret_x[column + 1] - caret_x[column]))
+            : 1;
+    result.caret_rect = RectPx::From_ltrb(left, top, left + 1, top + height);
+    result.overwrite_caret_rect =
+        RectPx::From_ltrb(left, top, left + overwrite_width, top + height);
+    result.preferred_x_px = Round_to_int(caret_x[column]);
+    layout_ = std::move(result);
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "greenflame_core/text_layout_engine.h"
+
+namespace greenflame::core {
+
+// What changed between two consecutive TextLayoutCache::Layout() calls.
+enum class TextLayoutChange : uint8_t {
+    None,
+    // Caret, selection, typing style or edit mode only; cached metrics reused.
+    Selection,
+    // Runs changed; only paragraphs that differ are re-measured.
+    Content,
+    // Base style changed; every paragraph is re-measured.
+    Style,
+};
+
+// Caches draft text layout between edits. Per-paragraph metrics from
+// ITextLayoutEngine::Measure_paragraph are kept across calls, so caret moves,
+// selection changes, hit testing and vertical navigation are answered in core
+// without touching the engine, and a content edit only re-measures the
+// paragraphs it touched. Engines without paragraph metrics fall back to the
+// whole-draft engine calls, with the last draft layout reused while the buffer
+// is unchanged.
+class TextLayoutCache final {
+  public:
+    explicit TextLayoutCache(ITextLayoutEngine *engine) noexcept;
+
+    [[nodiscard]] DraftTextLayoutResult const &Layout(TextDraftBuffer const &buf,
+                                                      PointPx origin);
+    [[nodiscard]] int32_t Hit_test_point(TextDraftBuffer const &buf, PointPx origin,
+                                         PointPx point);
+    [[nodiscard]] int32_t Move_vertical(TextDraftBuffer const &buf, PointPx origin,
+                                        int32_t offset, int delta_lines,
+                                        int32_t preferred_x_px);
+
+    [[nodiscard]] TextLayoutChange Last_change() const noexcept;
+    void Invalidate() noexcept;
+
+  private:
+    struct Paragraph final {
+        int32_t start_utf16 = 0;
+        std::vector<TextRun> runs = {};
+        TextParagraphMetrics metrics = {};
+        float top_px = 0.0f;
+    };
+
+    [[nodiscard]] TextLayoutChange Classify(TextDraftBuffer const &buf) const;
+    [[nodiscard]] bool Sync_metrics(TextDraftBuffer const &buf);
+    [[nodiscard]] size_t Paragraph_index_for_offset(int32_t offset) const noexcept;
+    [[nodiscard]] size_t Paragraph_index_for_y(float y) const noexcept;
+    [[nodiscard]] int32_t Offset_in_paragraph(size_t index, float x) const noexcept;
+    void Build_result_from_metrics(TextDraftBuffer const &buf, PointPx origin);
+
+    ITextLayoutEngine *engine_ = nullptr;
+    bool metrics_supported_ = true;
+    bool has_layout_ = false;
+    bool has_metrics_ = false;
+    TextLayoutChange last_change_ = TextLayoutChange::None;
+    TextDraftBuffer layout_buffer_ = {};
+    PointPx layout_origin_ = {};
+    DraftTextLayoutResult layout_ = {};
+    TextAnnotationBaseStyle metrics_style_ = {};
+    std::vector<TextRun> metrics_runs_ = {};
+    std::vector<Paragraph> paragraphs_ = {};
+    int32_t text_length_ = 0;
+};
+
+} // namespace greenflame::core
@@ -13,6 +13,38 @@ struct DraftTextLayoutResult final {
     int32_t preferred_x_px = 0;
 };
 
+// Geometry of one laid-out paragraph (the text between L'\n' separators),
+// relative to the paragraph's top-left corner. Drafts never wrap, so a
+// paragraph is exactly one line.
+struct TextParagraphMetrics final {
+    float height_px = 0.0f;
+    // Caret x for every insertion offset 0..length of the paragraph.
+    std::vector<float> caret_x_px = {};
+
+    bool operator==(TextParagraphMetrics const &) const noexcept = default;
+};
+
+// One decimal digit of a bubble counter font as a coverage mask (one byte per
+// pixel). Row 0 of the mask is the top of the line box.
+struct BubbleDigitGlyph final {
+    float advance_px = 0.0f;
+    // Mask left edge relative to the pen position.
+    int32_t offset_x_px = 0;
+    int32_t width_px = 0;
+    int32_t height_px = 0;
+    std::vector<uint8_t> coverage = {};
+
+    bool operator==(BubbleDigitGlyph const &) const noexcept = default;
+};
+
+// The digits 0-9 of one bold font at one size, laid out on a shared line box.
+struct BubbleDigitAtlas final {
+    float line_height_px = 0.0f;
+    std::array<BubbleDigitGlyph, 10> digits = {};
+
+    bool operator==(BubbleDigitAtlas const &) const noexcept = default;
+};
+
 class ITextLayoutEngine {
   public:
     ITextLayoutEngine() = default;
@@ -31,8 +63,44 @@ class ITextLayoutEngine {
                                                 PointPx origin, int32_t offset,
                                                 int delta_lines,
                                                 int32_t preferred_x_px) = 0;
+    // Measures a single paragraph; runs never contain L'\n'. Engines that cannot
+    // report paragraph metrics return false and callers fall back to the
+    // whole-draft calls above.
+    [[nodiscard]] virtual bool Measure_paragraph(TextAnnotationBaseStyle const &style,
+                                                 std::span<const TextRun> runs,
+                                                 TextParagraphMetrics &out) {
+        (void)style;
+        (void)runs;
+        (void)out;
+        return false;
+    }
+    // Lays out a finished annotation from its origin, fills visual_bounds and
+    // rasterizes it. Engines without a separate layout pass rasterize the
+    // annotation's existing visual_bounds.
+    [[nodiscard]] virtual bool Prepare_for_cli(TextAnnotation &annotation) {
+        Rasterize(annotation);
+        return annotation.bitmap_width_px > 0 && annotation.bitmap_height_px > 0 &&
+               annotation.bitmap_row_bytes > 0 &&
+               !annotation.premultiplied_bgra.empty();
+    }
     virtual void Rasterize(TextAnnotation &annotation) = 0;
     virtual void Rasterize_bubble(BubbleAnnotation &annotation) = 0;
+    // Changes whenever the fonts or resolution behind the engine's glyphs change,
+    // so glyph caches know to refetch. Engines with fixed fonts keep it at 0.
+    [[nodiscard]] virtual uint64_t Font_generation() const noexcept { return 0; }
+    // Rasterizes the bold digits BubbleRenderer composes counters from.
+    // `font_family` overrides `font_choice` when not empty. Engines that cannot
+    // produce glyph masks return false and bubbles go through Rasterize_bubble.
+    [[nodiscard]] virtual bool Rasterize_bubble_digits(TextFontChoice font_choice,
+                                                       std::wstring_view font_family,
+                                                       float font_size_dip,
+                                                       BubbleDigitAtlas &out) {
+        (void)font_choice;
+        (void)font_family;
+        (void)font_size_dip;
+        (void)out;
+        return false;
+    }
 };
 
 } // namespace greenflame::core
@@ -0,0 +1,25 @@
+#include "greenflame_core/toolbar_glyph_masks.h"
+
+namespace greenflame::core {
+
+namespace {
+
+#include "greenflame_core/toolbar_glyph_masks.inc"
+
+static_assert(kToolbarGlyphMasks.size() ==
+                  static_cast<size_t>(ToolbarGlyphMaskId::Count),
+              "regenerate toolbar_glyph_masks.inc after changing ToolbarGlyphMaskId");
+static_assert(std::all_of(kToolbarGlyphMasks.begin(), kToolbarGlyphMasks.end(),
+                          [](ToolbarGlyphMask const &mask) {
+                              return mask.Is_valid();
+                          }));
+
+} // namespace
+
+ToolbarGlyphMask Toolbar_glyph_mask(ToolbarGlyphMaskId id) noexcept {
+    size_t const index = static_cast<size_t>(id);
+    return index < kToolbarGlyphMasks.size() ? kToolbarGlyphMasks[index]
+                                             : ToolbarGlyphMask{};
+}
+
+} // namespace greenflame::core
@@ -0,0 +1,40 @@
+#pragma once
+
+namespace greenflame::core {
+
+// Toolbar glyphs, in the order of scripts/generate_toolbar_glyph_masks.ps1.
+enum class ToolbarGlyphMaskId : uint8_t {
+    Brush,
+    Highlighter,
+    Line,
+    Arrow,
+    Rectangle,
+    FilledRectangle,
+    Ellipse,
+    FilledEllipse,
+    Obfuscate,
+    Text,
+    Bubble,
+    Cursor,
+    Pin,
+    Help,
+    Count,
+};
+
+// Row-major alpha (0 transparent, 255 opaque); tinted at draw time.
+struct ToolbarGlyphMask final {
+    int32_t width = 0;
+    int32_t height = 0;
+    std::span<const uint8_t> alpha = {};
+
+    [[nodiscard]] constexpr bool Is_valid() const noexcept {
+        return width > 0 && height > 0 &&
+               alpha.size() == static_cast<size_t>(width) * static_cast<size_t>(height);
+    }
+};
+
+// Pre-decoded from resources/*-mask.png and compiled in, so showing the toolbar
+// decodes no images. An out-of-range id returns an empty (invalid) mask.
+[[nodiscard]] ToolbarGlyphMask Toolbar_glyph_mask(ToolbarGlyphMaskId id) noexcept;
+
+} // namespace greenflame::core
@@ -0,0 +1,231 @@
+#include "greenflame_core/trace_recorder.h"
+
+namespace greenflame::core {
+
+namespace {
+
+constexpr int64_t kNanosecondsPerMicrosecond = 1000;
+
+[[nodiscard]] uint64_t Next_recorder_id() noexcept {
+    static std::atomic<uint64_t> next_id = 1;
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Append_json_string(std::string &out, std::string_view text) {
+    constexpr std::string_view hex_digits = "0123456789abcdef";
+    out += '"';
+    for (char const ch : text) {
+        unsigned char const byte = static_cast<unsigned char>(ch);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (byte < 0x20u) {
+            out += "\\u00";
+            out += hex_digits[byte >> 4u];
+            out += hex_digits[byte & 0xFu];
+        } else {
+            out += ch;
+        }
+    }
+    out += '"';
+}
+
+// Nanoseconds as fractional microseconds, the unit of trace-event timestamps.
+void Append_microseconds(std::string &out, int64_t ns) {
+    if (ns < 0) {
+        out += '-';
+        ns = -ns;
+    }
+    out += std::to_string(ns / kNanosecondsPerMicrosecond);
+    std::string const fraction = std::to_string(ns % kNanosecondsPerMicrosecond);
+    out += '.';
+    out.append(3u - fraction.size(), '0');
+    out += fraction;
+}
+
+} // namespace
+
+struct TraceThreadBuffer final {
+    struct Event final {
+        std::atomic<char const *> name = nullptr;
+        std::atomic<int64_t> begin_ns = 0;
+        std::atomic<int64_t> end_ns = 0;
+    };
+
+    explicit TraceThreadBuffer(uint32_t id)
+        : thread_id(id), events(kTraceEventsPerThread) {}
+
+    uint32_t const thread_id;
+    // `claimed` moves ahead before an event is written and `written` after, so a
+    // reader can tell which slots may have changed under it.
+    std::atomic<uint64_t> claimed = 0;
+    std::atomic<uint64_t> written = 0;
+    // Set when the owning thread exits; the next new thread reuses the ring.
+    std::atomic<bool> retired = false;
+    std::vector<Event> events;
+};
+
+namespace {
+
+// The calling thread's ring in the recorder it last recorded into. Marks the
+// ring retired at thread exit; the shared ownership keeps that safe after the
+// recorder is gone.
+struct ThreadBufferSlot final {
+    uint64_t recorder_id = 0;
+    std::shared_ptr<TraceThreadBuffer> buffer = {};
+
+    ThreadBufferSlot() = default;
+    ThreadBufferSlot(ThreadBufferSlot const &) = delete;
+    ThreadBufferSlot &operator=(ThreadBufferSlot const &) = delete;
+    ~ThreadBufferSlot() { Retire(); }
+
+    void Retire() noexcept {
+        if (buffer != nullptr) {
+            buffer->retired.store(true, std::memory_order_release);
+            buffer.reset();
+        }
+    }
+};
+
+[[nodiscard]] ThreadBufferSlot &Current_thread_slot() noexcept {
+    CLANG_WARN_IGNORE_PUSH("-Wexit-time-destructors")
+    thread_local ThreadBufferSlot slot;
+    CLANG_WARN_IGNORE_POP()
+    return slot;
+}
+
+} // namespace
+
+TraceRecorder::TraceRecorder()
+    : id_(Next_recorder_id()), epoch_ns_(Now_ns()), cleared_at_ns_(epoch_ns_) {}
+
+TraceRecorder::~TraceRecorder() = default;
+
+TraceRecorder &TraceRecorder::Instance() noexcept {
+    // Never destroyed: worker threads may still record during process exit.
+    static TraceRecorder *const instance = new TraceRecorder();
+    return *instance;
+}
+
+int64_t TraceRecorder::Now_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void TraceRecorder::Set_enabled(bool enabled) noexcept {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void TraceRecorder::Record(char const *name, int64_t begin_ns, int64_t end_ns) {
+    TraceThreadBuffer &buffer = Buffer_for_current_thread();
+    uint64_t const index = buffer.written.load(std::memory_order_relaxed);
+    buffer.claimed.store(index + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    TraceThreadBuffer::Event &event = buffer.events[index % kTraceEventsPerThread];
+    event.name.store(name, std::memory_order_relaxed);
+    event.begin_ns.store(begin_ns, std::memory_order_relaxed);
+    event.end_ns.store(end_ns, std::memory_order_relaxed);
+    buffer.written.store(index + 1u, std::memory_order_release);
+}
+
+std::string TraceRecorder::Build_chrome_trace_json() const {
+    std::vector<std::shared_ptr<TraceThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers = buffers_;
+    }
+
+    int64_t const cleared_at_ns = cleared_at_ns_.load(std::memory_order_relaxed);
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto const begin_event = [&](std::string_view name, char phase, uint32_t tid) {
+        json += first ? "\n" : ",\n";
+        first = false;
+        json += "{\"name\":";
+        Append_json_string(json, name);
+        json += ",\"ph\":\"";
+        json += phase;
+        json += "\",\"pid\":1,\"tid\":";
+        json += std::to_string(tid);
+    };
+
+    struct CopiedEvent final {
+        char const *name = nullptr;
+        int64_t begin_ns = 0;
+        int64_t end_ns = 0;
+    };
+    std::vector<CopiedEvent> copied;
+    for (std::shared_ptr<TraceThreadBuffer> const &buffer : buffers) {
+        uint64_t const end = buffer->written.load(std::memory_order_acquire);
+        if (end == 0) {
+            continue;
+        }
+        uint64_t const start =
+            end > kTraceEventsPerThread ? end - kTraceEventsPerThread : 0;
+        copied.clear();
+        for (uint64_t index = start; index < end; ++index) {
+            TraceThreadBuffer::Event const &event =
+                buffer->events[index % kTraceEventsPerThread];
+            copied.push_back({event.name.load(std::memory_order_relaxed),
+                              event.begin_ns.load(std::memory_order_relaxed),
+                              event.end_ns.load(std::memory_order_relaxed)});
+        }
+        // Slots the owner claimed while they were copied may be torn.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t const claimed = buffer->claimed.load(std::memory_order_relaxed);
+        uint64_t const valid_from =
+            claimed > kTraceEventsPerThread ? claimed - kTraceEventsPerThread : 0;
+
+        begin_event("thread_name", 'M', buffer->thread_id);
+        json += ",\"args\":{\"name\":";
+        Append_json_string(json, "thread " + std::to_string(buffer->thread_id));
+        json += "}}";
+        for (uint64_t index = std::max(start, valid_from); index < end; ++index) {
+            CopiedEvent const &event = copied[static_cast<size_t>(index - start)];
+            if (event.name == nullptr || event.begin_ns < cleared_at_ns) {
+                continue;
+            }
+            begin_event(event.name, 'X', buffer->thread_id);
+            json += ",\"ts\":";
+            Append_microseconds(json, event.begin_ns - epoch_ns_);
+            json += ",\"dur\":";
+            Append_microseconds(json,
+                                std::max<int64_t>(event.end_ns - event.begin_ns, 0));
+            json += '}';
+        }
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+void TraceRecorder::Clear() noexcept {
+    cleared_at_ns_.store(Now_ns(), std::memory_order_relaxed);
+}
+
+TraceThreadBuffer &TraceRecorder::Buffer_for_current_thread() {
+    ThreadBufferSlot &slot = Current_thread_slot();
+    if (slot.recorder_id == id_ && slot.buffer != nullptr) {
+        return *slot.buffer;
+    }
+    slot.Retire();
+
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    for (std::shared_ptr<TraceThreadBuffer> const &buffer : buffers_) {
+        bool expected = true;
+        if (buffer->retired.compare_exchange_strong(expected, false,
+                                                    std::memory_order_acq_rel)) {
+            slot.buffer = buffer;
+            break;
+        }
+    }
+    if (slot.buffer == nullptr) {
+        uint32_t const thread_id = static_cast<uint32_t>(buffers_.size() + 1u);
+        slot.buffer = std::make_shared<TraceThreadBuffer>(thread_id);
+        buffers_.push_back(slot.buffer);
+    }
+    slot.recorder_id = id_;
+    return *slot.buffer;
+}
+
+} // namespace greenflame::core
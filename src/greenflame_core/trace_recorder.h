@@ -0,0 +1,73 @@
+#pragma once
+
+namespace greenflame::core {
+
+#if defined(GREENFLAME_ENABLE_TRACE_RECORDER) && GREENFLAME_ENABLE_TRACE_RECORDER
+inline constexpr bool kTraceRecorderCompiledIn = true;
+#else
+inline constexpr bool kTraceRecorderCompiledIn = false;
+#endif
+
+// Events kept per thread; older events are overwritten.
+inline constexpr size_t kTraceEventsPerThread = size_t{1} << 14;
+
+struct TraceThreadBuffer;
+
+// Records timed scopes into a fixed ring per thread and exports them as Chrome
+// trace-event JSON (chrome://tracing, Perfetto). Recording is lock-free: each
+// thread only writes its own ring, and a disabled recorder costs one relaxed
+// load per scope. A thread's ring is handed to the next new thread once it exits.
+class TraceRecorder final {
+  public:
+    TraceRecorder();
+    ~TraceRecorder();
+    TraceRecorder(TraceRecorder const &) = delete;
+    TraceRecorder &operator=(TraceRecorder const &) = delete;
+
+    // The recorder behind GREENFLAME_PROFILE_SCOPE.
+    [[nodiscard]] static TraceRecorder &Instance() noexcept;
+    [[nodiscard]] static int64_t Now_ns() noexcept;
+
+    void Set_enabled(bool enabled) noexcept;
+    [[nodiscard]] bool Is_enabled() const noexcept {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // `name` must outlive the recorder; scope names are string literals.
+    void Record(char const *name, int64_t begin_ns, int64_t end_ns);
+    // Safe while other threads record; events being overwritten are skipped.
+    [[nodiscard]] std::string Build_chrome_trace_json() const;
+    // Drops the events recorded so far from later exports.
+    void Clear() noexcept;
+
+  private:
+    [[nodiscard]] TraceThreadBuffer &Buffer_for_current_thread();
+
+    uint64_t const id_;
+    int64_t const epoch_ns_;
+    std::atomic<bool> enabled_ = false;
+    std::atomic<int64_t> cleared_at_ns_;
+    mutable std::mutex buffers_mutex_ = {};
+    std::vector<std::shared_ptr<TraceThreadBuffer>> buffers_ = {};
+};
+
+// Records the enclosing scope into TraceRecorder::Instance() when it is enabled.
+class TraceScope final {
+  public:
+    explicit TraceScope(char const *name) noexcept
+        : name_(TraceRecorder::Instance().Is_enabled() ? name : nullptr),
+          begin_ns_(name_ != nullptr ? TraceRecorder::Now_ns() : 0) {}
+    ~TraceScope() {
+        if (name_ != nullptr) {
+            TraceRecorder::Instance().Record(name_, begin_ns_, TraceRecorder::Now_ns());
+        }
+    }
+    TraceScope(TraceScope const &) = delete;
+    TraceScope &operator=(TraceScope const &) = delete;
+
+  private:
+    char const *name_ = nullptr;
+    int64_t begin_ns_ = 0;
+};
+
+} // namespace greenflame::core
@@ -0,0 +1,65 @@
+#include "allocation_tracking.h"
+
+namespace {
+
+using greenflame::test::AllocationStats;
+
+// Trivially constructed so operator new can use them before and after any
+// static initialization.
+constinit thread_local AllocationStats t_allocation_stats = {};
+constinit std::atomic<uint64_t> g_process_allocation_count = 0;
+
+[[nodiscard]] void *Counted_allocate(size_t size) noexcept {
+    t_allocation_stats.allocations += 1;
+    t_allocation_stats.bytes += size;
+    g_process_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void Counted_free(void *block) noexcept {
+    if (block != nullptr) {
+        t_allocation_stats.deallocations += 1;
+        std::free(block);
+    }
+}
+
+} // namespace
+
+namespace greenflame::test {
+
+AllocationStats Thread_allocation_stats() noexcept { return t_allocation_stats; }
+
+uint64_t Process_allocation_count() noexcept {
+    return g_process_allocation_count.load(std::memory_order_relaxed);
+}
+
+} // namespace greenflame::test
+
+// Every unaligned form is replaced so any new/delete pairing stays on malloc/free.
+void *operator new(size_t size) {
+    if (void *const block = Counted_allocate(size)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, std::nothrow_t const &) noexcept {
+    return Counted_allocate(size);
+}
+
+void *operator new[](size_t size, std::nothrow_t const &) noexcept {
+    return Counted_allocate(size);
+}
+
+void operator delete(void *block) noexcept { Counted_free(block); }
+void operator delete[](void *block) noexcept { Counted_free(block); }
+void operator delete(void *block, size_t) noexcept { Counted_free(block); }
+void operator delete[](void *block, size_t) noexcept { Counted_free(block); }
+void operator delete(void *block, std::nothrow_t const &) noexcept {
+    Counted_free(block);
+}
+void operator delete[](void *block, std::nothrow_t const &) noexcept {
+    Counted_free(block);
+}
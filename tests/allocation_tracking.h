@@ -0,0 +1,69 @@
+#pragma once
+
+// Global operator new/delete accounting for tests. Linking allocation_tracking.cpp
+// replaces the replaceable allocation functions for the whole executable; counts
+// are kept per thread so work on other threads never leaks into a scope.
+// Over-aligned allocations (operator new with std::align_val_t) are not counted.
+
+#include "greenflame_core/compiler_diagnostic.h"
+
+namespace greenflame::test {
+
+struct AllocationStats final {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0; // requested by the counted allocations
+};
+
+// Running totals for the calling thread.
+[[nodiscard]] AllocationStats Thread_allocation_stats() noexcept;
+// Allocations made by every thread since startup.
+[[nodiscard]] uint64_t Process_allocation_count() noexcept;
+
+// Counts what the constructing thread allocates while the scope is alive.
+// Scopes nest; each one sees everything allocated since it began.
+class AllocationScope final {
+  public:
+    AllocationScope() noexcept : start_(Thread_allocation_stats()) {}
+    AllocationScope(AllocationScope const &) = delete;
+    AllocationScope &operator=(AllocationScope const &) = delete;
+    AllocationScope(AllocationScope &&) = delete;
+    AllocationScope &operator=(AllocationScope &&) = delete;
+    ~AllocationScope() = default;
+
+    [[nodiscard]] AllocationStats Stats() const noexcept {
+        AllocationStats const now = Thread_allocation_stats();
+        return {now.allocations - start_.allocations,
+                now.deallocations - start_.deallocations, now.bytes - start_.bytes};
+    }
+
+  private:
+    AllocationStats start_ = {};
+};
+
+} // namespace greenflame::test
+
+#define GREENFLAME_EXPECT_ALLOCATIONS_(max_allocations, max_bytes, text, ...)          \
+    do {                                                                               \
+        ::greenflame::test::AllocationScope const gf_allocation_scope_;                \
+        CLANG_WARN_IGNORE_PUSH("-Wextra-semi-stmt")                                    \
+        {__VA_ARGS__;}                                                                 \
+        CLANG_WARN_IGNORE_POP()                                                        \
+        ::greenflame::test::AllocationStats const gf_allocation_stats_ =               \
+            gf_allocation_scope_.Stats();                                              \
+        EXPECT_TRUE(gf_allocation_stats_.allocations <= uint64_t{max_allocations} &&   \
+                    gf_allocation_stats_.bytes <= uint64_t{max_bytes})                 \
+            << "allocation budget exceeded by: " text "\n  allocations: "              \
+            << gf_allocation_stats_.allocations << " (budget " << (max_allocations)    \
+            << ")\n  bytes: " << gf_allocation_stats_.bytes << " (budget "             \
+            << (max_bytes) << ")";                                                     \
+    } while (false)
+
+// EXPECT_NO_ALLOCATIONS({ statements; }) fails if the statements allocate at all.
+#define EXPECT_NO_ALLOCATIONS(...)                                                     \
+    GREENFLAME_EXPECT_ALLOCATIONS_(0, 0, #__VA_ARGS__, __VA_ARGS__)
+// Budget form: at most `max_allocations` calls to operator new totalling at most
+// `max_bytes` requested bytes.
+#define EXPECT_ALLOCATIONS_WITHIN(max_allocations, max_bytes, ...)                     \
+    GREENFLAME_EXPECT_ALLOCATIONS_(max_allocations, max_bytes, #__VA_ARGS__,           \
+                                   __VA_ARGS__)
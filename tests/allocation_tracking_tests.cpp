@@ -0,0 +1,73 @@
+#include "allocation_tracking.h"
+
+using greenflame::test::AllocationScope;
+using greenflame::test::AllocationStats;
+
+namespace {
+
+// Keeps the optimizer from eliding a new/delete pair.
+std::atomic<void *> g_sink = nullptr;
+
+void Allocate_and_free(size_t bytes) {
+    std::vector<uint8_t> buffer(bytes);
+    g_sink.store(buffer.data(), std::memory_order_relaxed);
+}
+
+} // namespace
+
+TEST(allocation_tracking, Scope_CountsAllocationsFreesAndBytes) {
+    AllocationScope const scope;
+    Allocate_and_free(100);
+    Allocate_and_free(28);
+    AllocationStats const stats = scope.Stats();
+    EXPECT_EQ(stats.allocations, 2u);
+    EXPECT_EQ(stats.deallocations, 2u);
+    EXPECT_EQ(stats.bytes, 128u);
+}
+
+TEST(allocation_tracking, Scope_NestedScopesSeeOnlyTheirOwnWork) {
+    AllocationScope const outer;
+    Allocate_and_free(16);
+    {
+        AllocationScope const inner;
+        EXPECT_EQ(inner.Stats().allocations, 0u);
+        Allocate_and_free(32);
+        EXPECT_EQ(inner.Stats().allocations, 1u);
+        EXPECT_EQ(inner.Stats().bytes, 32u);
+    }
+    EXPECT_EQ(outer.Stats().allocations, 2u);
+    EXPECT_EQ(outer.Stats().bytes, 48u);
+}
+
+TEST(allocation_tracking, Scope_IgnoresOtherThreads) {
+    AllocationScope const scope;
+    uint64_t const process_before = greenflame::test::Process_allocation_count();
+    std::thread worker([] { Allocate_and_free(4096); });
+    worker.join();
+    // std::thread may allocate its own state on this thread; the worker's buffer
+    // must not show up here.
+    uint64_t const here = scope.Stats().allocations;
+    EXPECT_GT(greenflame::test::Process_allocation_count(), process_before + here);
+    EXPECT_LT(scope.Stats().bytes, 4096u);
+}
+
+TEST(allocation_tracking, Macros_PassWithinBudget) {
+    std::array<int32_t, 8> values = {};
+    EXPECT_NO_ALLOCATIONS({
+        for (size_t index = 0; index < values.size(); ++index) {
+            values[index] = static_cast<int32_t>(index) * 3;
+        }
+    });
+    EXPECT_EQ(values[7], 21);
+    std::vector<int32_t> grown;
+    EXPECT_ALLOCATIONS_WITHIN(1, 256 * sizeof(int32_t), { grown.reserve(256); });
+    EXPECT_EQ(grown.capacity(), 256u);
+}
+
+TEST(allocation_tracking, Macros_ReportOverBudgetStatements) {
+    EXPECT_NONFATAL_FAILURE(EXPECT_NO_ALLOCATIONS(Allocate_and_free(8)),
+                            "allocations: 1 (budget 0)");
+    EXPECT_NONFATAL_FAILURE(
+        EXPECT_ALLOCATIONS_WITHIN(4, 16, Allocate_and_free(64)),
+        "bytes: 64 (budget 16)");
+}
@@ -0,0 +1,272 @@
+#include "greenflame_core/annotation_binary.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+[[nodiscard]] std::vector<uint8_t> Make_flat_pixels(int32_t width, int32_t height,
+                                                    uint8_t value) {
+    return std::vector<uint8_t>(
+        static_cast<size_t>(width) * static_cast<size_t>(height) * 4, value);
+}
+
+[[nodiscard]] AnnotationDocument Make_document_with_every_kind() {
+    AnnotationDocument document{};
+    document.next_annotation_id = 42;
+
+    FreehandStrokeAnnotation freehand{};
+    freehand.points = {{10, 10}, {11, 12}, {9, 8}, {-2147483647, 2147483647}};
+    freehand.style = StrokeStyle{7, RGB(1, 2, 3), 55};
+    freehand.freehand_tip_shape = FreehandTipShape::Square;
+    document.annotations.push_back(Annotation{1, freehand});
+
+    StrokeStyle const line_style{3, RGB(9, 8, 7), 100};
+    document.annotations.push_back(
+        Annotation{2, LineAnnotation{{-5, 3}, {400, -300}, line_style, true}});
+    document.annotations.push_back(Annotation{
+        3, RectangleAnnotation{RectPx::From_ltrb(1, 2, 30, 40), {}, true}});
+    document.annotations.push_back(Annotation{
+        4, EllipseAnnotation{RectPx::From_ltrb(-10, -20, 5, 6), {}, false}});
+
+    ObfuscateAnnotation obfuscate{};
+    obfuscate.bounds = RectPx::From_ltrb(0, 0, 16, 8);
+    obfuscate.block_size = 4;
+    obfuscate.bitmap_width_px = 16;
+    obfuscate.bitmap_height_px = 8;
+    obfuscate.bitmap_row_bytes = 64;
+    obfuscate.premultiplied_bgra = Make_flat_pixels(16, 8, 0x7F);
+    document.annotations.push_back(Annotation{5, obfuscate});
+
+    TextAnnotation text{};
+    text.origin = {100, 200};
+    text.base_style = TextAnnotationBaseStyle{RGB(255, 0, 0), TextFontChoice::Mono,
+                                              L"Consolas", 18};
+    text.runs = {TextRun{L"Hello ", {}},
+                 TextRun{L"w\x00F6rld \xD83D\xDE00", {true, false, true, false}},
+                 TextRun{L"\nsecond", {false, true, false, true}}};
+    text.visual_bounds = RectPx::From_ltrb(100, 200, 180, 240);
+    text.bitmap_width_px = 3;
+    text.bitmap_height_px = 2;
+    text.bitmap_row_bytes = 12;
+    for (uint8_t value = 0; value < 24; ++value) {
+        text.premultiplied_bgra.push_back(static_cast<uint8_t>(value * 11));
+    }
+    document.annotations.push_back(Annotation{6, text});
+
+    BubbleAnnotation bubble{};
+    bubble.center = {50, 60};
+    bubble.diameter_px = 24;
+    bubble.color = RGB(0, 128, 255);
+    bubble.font_choice = TextFontChoice::Art;
+    bubble.font_family = L"Comic Sans MS";
+    bubble.counter_value = 12;
+    bubble.bitmap_width_px = 24;
+    bubble.bitmap_height_px = 24;
+    bubble.bitmap_row_bytes = 96;
+    bubble.premultiplied_bgra = Make_flat_pixels(24, 24, 0);
+    document.annotations.push_back(Annotation{41, bubble});
+
+    document.selected_annotation_ids = {41, 2};
+    return document;
+}
+
+} // namespace
+
+TEST(annotation_binary, RoundTrip_EveryAnnotationKind) {
+    AnnotationDocument const document = Make_document_with_every_kind();
+
+    for (bool const compress : {true, false}) {
+        AnnotationBinaryEncodeOptions const options{compress};
+        std::vector<uint8_t> const bytes =
+            Encode_annotation_document(document, options);
+        ASSERT_GE(bytes.size(), kAnnotationBinaryMagic.size());
+        EXPECT_TRUE(std::equal(kAnnotationBinaryMagic.begin(),
+                               kAnnotationBinaryMagic.end(), bytes.begin()));
+
+        AnnotationDocument decoded{};
+        ASSERT_TRUE(Try_decode_annotation_document(bytes, decoded));
+        EXPECT_EQ(decoded, document);
+    }
+}
+
+TEST(annotation_binary, RoundTrip_EmptyDocument) {
+    AnnotationDocument const document{};
+    std::vector<uint8_t> const bytes = Encode_annotation_document(document);
+
+    AnnotationDocument decoded = Make_document_with_every_kind();
+    ASSERT_TRUE(Try_decode_annotation_document(bytes, decoded));
+    EXPECT_EQ(decoded, document);
+}
+
+TEST(annotation_binary, Encode_CompressesFlatBitmapsAndDeltaEncodesPoints) {
+    AnnotationDocument document{};
+    ObfuscateAnnotation obfuscate{};
+    obfuscate.bitmap_width_px = 256;
+    obfuscate.bitmap_height_px = 256;
+    obfuscate.bitmap_row_bytes = 1024;
+    obfuscate.premultiplied_bgra = Make_flat_pixels(256, 256, 0x40);
+    document.annotations.push_back(Annotation{1, obfuscate});
+
+    FreehandStrokeAnnotation freehand{};
+    for (int32_t index = 0; index < 1000; ++index) {
+        freehand.points.push_back(PointPx{100000 + index, 200000 - index});
+    }
+    document.annotations.push_back(Annotation{2, freehand});
+
+    std::vector<uint8_t> const compressed = Encode_annotation_document(document);
+    std::vector<uint8_t> const raw =
+        Encode_annotation_document(document, AnnotationBinaryEncodeOptions{false});
+
+    EXPECT_GT(raw.size(), obfuscate.premultiplied_bgra.size());
+    EXPECT_LT(compressed.size(), 4096u);
+    // Unit-step deltas take one byte per coordinate after the first point.
+    EXPECT_LT(raw.size(), obfuscate.premultiplied_bgra.size() + 2100u);
+
+    AnnotationDocument decoded{};
+    ASSERT_TRUE(Try_decode_annotation_document(compressed, decoded));
+    EXPECT_EQ(decoded, document);
+}
+
+TEST(annotation_binary, Decode_RejectsTruncatedInputAtEveryLength) {
+    AnnotationDocument const document = Make_document_with_every_kind();
+    std::vector<uint8_t> const bytes = Encode_annotation_document(document);
+
+    for (size_t length = 0; length < bytes.size(); ++length) {
+        AnnotationDocument decoded = document;
+        EXPECT_FALSE(Try_decode_annotation_document(
+            std::span<const uint8_t>(bytes.data(), length), decoded))
+            << "length " << length;
+        EXPECT_EQ(decoded, AnnotationDocument{});
+    }
+}
+
+TEST(annotation_binary, Decode_RejectsBadHeaderAndTrailingBytes) {
+    std::vector<uint8_t> const bytes =
+        Encode_annotation_document(Make_document_with_every_kind());
+    AnnotationDocument decoded{};
+
+    std::vector<uint8_t> bad_magic = bytes;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(Try_decode_annotation_document(bad_magic, decoded));
+
+    std::vector<uint8_t> future_version = bytes;
+    future_version[4] = static_cast<uint8_t>(kAnnotationBinaryVersion + 1);
+    EXPECT_FALSE(Try_decode_annotation_document(future_version, decoded));
+
+    std::vector<uint8_t> trailing = bytes;
+    trailing.push_back(0);
+    EXPECT_FALSE(Try_decode_annotation_document(trailing, decoded));
+}
+
+TEST(annotation_binary, Decode_RejectsBitmapsThatDoNotMatchTheirShape) {
+    struct Shape final {
+        int32_t width;
+        int32_t height;
+        int32_t row_bytes;
+        size_t size;
+    };
+    std::array<Shape, 7> const bad_shapes = {{
+        {3, 2, 8, 16},                   // stride narrower than a row of pixels
+        {3, 2, 12, 20},                  // pixels truncated
+        {3, 2, 12, 28},                  // pixels beyond the last row
+        {-3, 2, 12, 24},                 // negative width
+        {3, 0, 12, 0},                   // empty height with a stride
+        {0x7FFFFFFF, 2, 0x7FFFFFFF, 64}, // width x 4 overflows int32
+        {0, 0, 0, 4},                    // "not rasterized" with pixels
+    }};
+    for (Shape const &shape : bad_shapes) {
+        for (bool const compress : {false, true}) {
+            TextAnnotation text{};
+            text.bitmap_width_px = shape.width;
+            text.bitmap_height_px = shape.height;
+            text.bitmap_row_bytes = shape.row_bytes;
+            text.premultiplied_bgra.assign(shape.size, 0x40);
+            AnnotationDocument document{};
+            document.annotations.push_back(Annotation{1, text});
+
+            AnnotationDocument decoded{};
+            EXPECT_FALSE(Try_decode_annotation_document(
+                Encode_annotation_document(document, {.compress_bitmaps = compress}),
+                decoded))
+                << shape.width << "x" << shape.height << " stride " << shape.row_bytes
+                << " size " << shape.size;
+            EXPECT_EQ(decoded, AnnotationDocument{});
+        }
+    }
+
+    // Padded rows and the unrasterized shape stay valid.
+    TextAnnotation padded{};
+    padded.bitmap_width_px = 3;
+    padded.bitmap_height_px = 2;
+    padded.bitmap_row_bytes = 16;
+    padded.premultiplied_bgra.assign(32, 0x40);
+    AnnotationDocument document{};
+    document.annotations.push_back(Annotation{1, padded});
+    document.annotations.push_back(Annotation{2, TextAnnotation{}});
+    AnnotationDocument decoded{};
+    ASSERT_TRUE(
+        Try_decode_annotation_document(Encode_annotation_document(document), decoded));
+    EXPECT_EQ(decoded, document);
+}
+
+TEST(annotation_binary, Decode_CorruptBytesNeverCrash) {
+    std::vector<uint8_t> const bytes =
+        Encode_annotation_document(Make_document_with_every_kind());
+    uint32_t state = 0x9E3779B9u;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    for (int iteration = 0; iteration < 2000; ++iteration) {
+        std::vector<uint8_t> corrupt = bytes;
+        int const flips = 1 + static_cast<int>(next() % 4);
+        for (int flip = 0; flip < flips; ++flip) {
+            corrupt[next() % corrupt.size()] = static_cast<uint8_t>(next());
+        }
+        AnnotationDocument decoded{};
+        if (!Try_decode_annotation_document(corrupt, decoded)) {
+            EXPECT_EQ(decoded, AnnotationDocument{});
+        }
+    }
+}
+
+TEST(annotation_binary, Lz_RoundTripsMixedInput) {
+    std::vector<uint8_t> input;
+    for (int index = 0; index < 5000; ++index) {
+        input.push_back(static_cast<uint8_t>(index % 7 == 0 ? index : 0xAA));
+    }
+    input.insert(input.end(), 300, 0x00);
+    input.push_back(1);
+
+    std::vector<uint8_t> const compressed = Lz_compress_bytes(input);
+    EXPECT_LT(compressed.size(), input.size());
+
+    std::vector<uint8_t> output;
+    ASSERT_TRUE(Try_lz_decompress_bytes(compressed, input.size(), output));
+    EXPECT_EQ(output, input);
+
+    EXPECT_FALSE(Try_lz_decompress_bytes(compressed, input.size() + 1, output));
+    EXPECT_FALSE(Try_lz_decompress_bytes(compressed, input.size() - 1, output));
+    std::vector<uint8_t> const bad_distance = {0, 5, 0};
+    EXPECT_FALSE(Try_lz_decompress_bytes(bad_distance, 8, output));
+}
+
+TEST(annotation_binary, Lz_LongRunsStayWithinTheExpansionBound) {
+    std::vector<uint8_t> const input(1u << 20, 0x5A);
+    std::vector<uint8_t> const compressed = Lz_compress_bytes(input);
+    EXPECT_LT(compressed.size(), input.size() / 1000);
+
+    std::vector<uint8_t> output;
+    ASSERT_TRUE(Try_lz_decompress_bytes(compressed, input.size(), output));
+    EXPECT_EQ(output, input);
+
+    // A header claiming far more than a few bytes can encode is rejected before
+    // anything is reserved.
+    std::vector<uint8_t> const tiny = {1, 0x5A, 1, 0x7F};
+    std::vector<uint8_t> untouched;
+    EXPECT_FALSE(Try_lz_decompress_bytes(tiny, size_t{1} << 29, untouched));
+    EXPECT_EQ(untouched.capacity(), 0u);
+}
@@ -1,3 +1,4 @@
+#include "allocation_tracking.h"
 #include "fake_spell_check_service.h"
 #include "fake_text_layout_engine.h"
 #include "greenflame_core/annotation_controller.h"
@@ -2208,3 +2209,85 @@ TEST(annotation_controller, BubblePlacement_FullCounterSequence) {
     ASSERT_EQ(controller.Annotations().size(), 1u);
     EXPECT_EQ(controller.Current_bubble_counter(), 3);
 }
+
+TEST(annotation_controller, PointerMove_HoverAndShapeDragDoNotAllocate) {
+    AnnotationController controller;
+    UndoStack undo_stack;
+    controller.Insert_annotation_at(0, Make_stroke(1, {{20, 20}, {30, 20}, {40, 25}}),
+                                    std::nullopt);
+    controller.Insert_annotation_at(1, Make_rectangle(2, {50, 50, 150, 150}, 2),
+                                    std::nullopt);
+    size_t hits = 0;
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 0; step < 60; ++step) {
+            std::ignore = controller.On_pointer_move({step * 3, 20});
+            hits += controller.Annotation_id_at({step * 3, 20}).has_value() ? 1u : 0u;
+            hits += controller.Annotation_edit_target_at({step * 3, 50}).has_value()
+                        ? 1u
+                        : 0u;
+        }
+    });
+    EXPECT_GT(hits, 0u);
+
+    ASSERT_TRUE(controller.Toggle_tool(AnnotationToolId::Line));
+    ASSERT_TRUE(controller.On_primary_press({200, 200}));
+    Annotation const *draft = nullptr;
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 1; step <= 50; ++step) {
+            std::ignore = controller.On_pointer_move({200 + step, 220}, true);
+        }
+        draft = controller.Draft_annotation();
+    });
+    EXPECT_NE(draft, nullptr);
+    EXPECT_TRUE(controller.On_primary_release(undo_stack));
+}
+
+TEST(annotation_controller, PointerMove_FreehandDragAllocatesOnlyForPointGrowth) {
+    AnnotationController controller;
+    ASSERT_TRUE(controller.Toggle_tool(AnnotationToolId::Freehand));
+    ASSERT_TRUE(controller.On_primary_press({10, 10}));
+    // Only the draft point buffer's geometric growth may allocate.
+    EXPECT_ALLOCATIONS_WITHIN(12, 64 * 1024, {
+        for (int32_t step = 1; step <= 1000; ++step) {
+            std::ignore = controller.On_pointer_move({10 + step % 50, 10 + step / 10});
+        }
+    });
+    std::span<const PointPx> points = {};
+    bool has_style = false;
+    bool has_obfuscate_preview = true;
+    EXPECT_NO_ALLOCATIONS({
+        points = controller.Draft_freehand_points();
+        has_style = controller.Draft_freehand_style().has_value();
+        has_obfuscate_preview = !controller.Active_obfuscate_preview_indices().empty();
+    });
+    EXPECT_EQ(points.size(), 1001u);
+    EXPECT_TRUE(has_style);
+    EXPECT_FALSE(has_obfuscate_preview);
+}
+
+TEST(annotation_controller, PointerMove_MoveDragKeepsSelectionWithoutAllocating) {
+    AnnotationController controller;
+    UndoStack undo_stack;
+    controller.Insert_annotation_at(0, Make_rectangle(1, {50, 50, 150, 150}, 2),
+                                    std::nullopt);
+    RectPx const before = Annotation_bounds(controller.Annotations()[0]);
+    PointPx const grab{50, 75}; // on the left edge, clear of the resize handles
+    ASSERT_TRUE(controller.Select_topmost_annotation(grab));
+    std::optional<AnnotationEditTarget> const target =
+        controller.Annotation_edit_target_at(grab);
+    ASSERT_TRUE(target.has_value());
+    ASSERT_EQ(target->kind, AnnotationEditTargetKind::Body);
+    ASSERT_TRUE(controller.Begin_annotation_edit(*target, grab));
+
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 1; step <= 50; ++step) {
+            std::ignore =
+                controller.On_pointer_move({grab.x + step, grab.y + step}, true);
+        }
+    });
+    EXPECT_EQ(controller.Selected_annotation_id(), std::optional<uint64_t>{1});
+    EXPECT_TRUE(controller.On_primary_release(undo_stack));
+    EXPECT_EQ(Annotation_bounds(controller.Annotations()[0]),
+              RectPx::From_ltrb(before.left + 50, before.top + 50, before.right + 50,
+                                before.bottom + 50));
+}
@@ -0,0 +1,246 @@
+#include "greenflame_core/annotation_document.h"
+#include "greenflame_core/annotation_hit_test.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+Annotation Make_rectangle(uint64_t id, RectPx outer_bounds) {
+    Annotation annotation{};
+    annotation.id = id;
+    annotation.data = RectangleAnnotation{
+        .outer_bounds = outer_bounds,
+        .style = {.width_px = 2},
+        .filled = true,
+    };
+    return annotation;
+}
+
+Annotation Make_square(uint64_t id, int32_t left) {
+    return Make_rectangle(id, RectPx::From_ltrb(left, 0, left + 10, 10));
+}
+
+// Shapes whose hit coverage is much smaller than their bounds.
+Annotation Make_sparse_shape(uint64_t id, int32_t left) {
+    Annotation annotation{};
+    annotation.id = id;
+    switch (id % 3) {
+    case 0:
+        annotation.data = FreehandStrokeAnnotation{
+            .points = {{left, 0}, {left + 30, 12}, {left + 5, -15}},
+            .style = {.width_px = 3},
+            .freehand_tip_shape =
+                id % 2 == 0 ? FreehandTipShape::Square : FreehandTipShape::Round,
+        };
+        break;
+    case 1:
+        annotation.data = LineAnnotation{
+            .start = {left, -10},
+            .end = {left + 25, 14},
+            .style = {.width_px = 2},
+            .arrow_head = id % 2 == 0,
+        };
+        break;
+    default:
+        annotation.data = EllipseAnnotation{
+            .outer_bounds = RectPx::From_ltrb(left, -12, left + 28, 16),
+            .style = {.width_px = 2},
+        };
+        break;
+    }
+    return annotation;
+}
+
+// Every indexed lookup must agree with the scanning helpers.
+void Expect_index_matches_scans(AnnotationDocument const &document) {
+    ASSERT_TRUE(Annotation_document_index_is_current(document));
+    std::span<const Annotation> const annotations = document.annotations;
+    std::span<const uint64_t> const selection = document.selected_annotation_ids;
+    for (uint64_t id = 0; id <= document.next_annotation_id; ++id) {
+        EXPECT_EQ(Index_of_annotation_id(document, id),
+                  Index_of_annotation_id(annotations, id))
+            << "id " << id;
+        bool const exists = Index_of_annotation_id(annotations, id).has_value();
+        EXPECT_EQ(Selection_contains_annotation_id(document, id),
+                  exists && Selection_contains_annotation_id(selection, id))
+            << "id " << id;
+    }
+    EXPECT_EQ(Annotation_selection_bounds(document),
+              Annotation_selection_bounds(annotations, selection));
+
+    AnnotationDocument rebuilt = document;
+    Rebuild_annotation_document_index(rebuilt);
+    EXPECT_EQ(rebuilt.index.position_by_id, document.index.position_by_id);
+    EXPECT_EQ(rebuilt.index.selected_at, document.index.selected_at);
+    EXPECT_EQ(rebuilt.index.summaries, document.index.summaries);
+
+    for (int32_t y = -20; y <= 20; y += 7) {
+        for (int32_t x = -110; x <= 120; x += 9) {
+            EXPECT_EQ(Index_of_topmost_annotation_at(document, {x, y}),
+                      Index_of_topmost_annotation_at(annotations, {x, y}))
+                << x << "," << y;
+        }
+    }
+    RectPx const probe = RectPx::From_ltrb(-30, 2, 25, 4);
+    EXPECT_EQ(Annotation_ids_intersecting_selection_rect(document, probe),
+              Annotation_ids_intersecting_selection_rect(annotations, probe));
+}
+
+} // namespace
+
+TEST(annotation_document, Helpers_MaintainIndexAndNextId) {
+    AnnotationDocument document{};
+    Insert_document_annotation(document, 0, Make_square(3, 0));
+    Insert_document_annotation(document, 1, Make_square(7, 20));
+    Insert_document_annotation(document, 0, Make_square(5, 40));
+    EXPECT_EQ(document.next_annotation_id, 8u);
+    EXPECT_EQ(Index_of_annotation_id(document, 3), std::optional<size_t>{1});
+    EXPECT_EQ(Index_of_annotation_id(document, 5), std::optional<size_t>{0});
+    EXPECT_EQ(Index_of_annotation_id(document, 4), std::nullopt);
+
+    Set_document_selection(document, {7, 5});
+    EXPECT_TRUE(Selection_contains_annotation_id(document, 7));
+    EXPECT_FALSE(Selection_contains_annotation_id(document, 3));
+    EXPECT_EQ(Annotation_selection_bounds(document),
+              std::optional<RectPx>{RectPx::From_ltrb(19, -1, 51, 11)});
+    Expect_index_matches_scans(document);
+
+    Replace_document_annotation(document, 2, Make_square(9, 60));
+    EXPECT_EQ(Index_of_annotation_id(document, 7), std::nullopt);
+    EXPECT_EQ(Index_of_annotation_id(document, 9), std::optional<size_t>{2});
+    EXPECT_EQ(document.next_annotation_id, 10u);
+    Expect_index_matches_scans(document);
+
+    Erase_document_annotation(document, 2);
+    Erase_document_annotation(document, 0);
+    EXPECT_EQ(Index_of_annotation_id(document, 3), std::optional<size_t>{0});
+    EXPECT_EQ(Index_of_annotation_id(document, 5), std::nullopt);
+    Expect_index_matches_scans(document);
+
+    Clear_document_annotations(document);
+    EXPECT_TRUE(document.selected_annotation_ids.empty());
+    EXPECT_EQ(Index_of_annotation_id(document, 3), std::nullopt);
+    EXPECT_EQ(document.next_annotation_id, 10u);
+}
+
+TEST(annotation_document, NormalizeSelection_UsesDocumentOrderAndDropsUnknownIds) {
+    AnnotationDocument document{};
+    for (uint64_t id : {4u, 2u, 9u}) {
+        Insert_document_annotation(document, document.annotations.size(),
+                                   Make_square(id, static_cast<int32_t>(id) * 10));
+    }
+    AnnotationSelection const requested = {9, 99, 4, 9, 2};
+    EXPECT_EQ(Normalize_annotation_selection(document, requested),
+              (AnnotationSelection{4, 2, 9}));
+    EXPECT_EQ(Normalize_annotation_selection(document, requested),
+              Normalize_annotation_selection(document.annotations, requested));
+}
+
+TEST(annotation_document, Summaries_CacheBoundsUntilTheAnnotationChanges) {
+    AnnotationDocument document{};
+    Insert_document_annotation(document, 0, Make_sparse_shape(1, 0));
+    Insert_document_annotation(document, 1, Make_square(2, 50));
+    ASSERT_EQ(document.index.summaries.size(), 2u);
+    EXPECT_EQ(document.index.summaries[0],
+              Summarize_annotation(document.annotations[0]));
+    EXPECT_EQ(document.index.summaries[1].visual_bounds,
+              RectPx::From_ltrb(50, 0, 60, 10));
+
+    Replace_document_annotation(document, 1, Make_square(2, 70));
+    EXPECT_EQ(document.index.summaries[1].hit_bounds,
+              RectPx::From_ltrb(70, 0, 80, 10));
+    EXPECT_EQ(Index_of_topmost_annotation_at(document, {75, 5}),
+              std::optional<size_t>{1});
+    EXPECT_EQ(Index_of_topmost_annotation_at(document, {55, 5}), std::nullopt);
+    EXPECT_EQ(Annotation_ids_intersecting_selection_rect(
+                  document, RectPx::From_ltrb(65, 0, 72, 3)),
+              (AnnotationSelection{2}));
+}
+
+TEST(annotation_document, StaleIndex_FallsBackToScanning) {
+    AnnotationDocument document{};
+    document.annotations = {Make_square(1, 0), Make_square(2, 20)};
+    document.selected_annotation_ids = {2};
+    EXPECT_FALSE(Annotation_document_index_is_current(document));
+    EXPECT_EQ(Index_of_annotation_id(document, 2), std::optional<size_t>{1});
+    EXPECT_TRUE(Selection_contains_annotation_id(document, 2));
+    EXPECT_EQ(Annotation_selection_bounds(document),
+              std::optional<RectPx>{RectPx::From_ltrb(19, -1, 31, 11)});
+
+    // An id reassigned behind the helpers' back is not reported at its old slot.
+    Rebuild_annotation_document_index(document);
+    document.annotations[1].id = 6;
+    EXPECT_EQ(Index_of_annotation_id(document, 2), std::nullopt);
+    EXPECT_EQ(Index_of_annotation_id(document, 6), std::optional<size_t>{1});
+}
+
+TEST(annotation_document, SameSizeReorder_IsNotCurrent) {
+    AnnotationDocument document{};
+    document.annotations = {Make_square(1, 0), Make_square(2, 20)};
+    document.selected_annotation_ids = {2};
+    Rebuild_annotation_document_index(document);
+    ASSERT_TRUE(Annotation_document_index_is_current(document));
+
+    std::swap(document.annotations[0], document.annotations[1]);
+    EXPECT_FALSE(Annotation_document_index_is_current(document));
+    EXPECT_FALSE(Annotation_document_index_is_current_at(document, 0));
+    EXPECT_EQ(Index_of_annotation_id(document, 2), std::optional<size_t>{0});
+    EXPECT_TRUE(Selection_contains_annotation_id(document, 2));
+    EXPECT_FALSE(Selection_contains_annotation_id(document, 1));
+    EXPECT_EQ(Index_of_topmost_annotation_at(document, {5, 5}),
+              std::optional<size_t>{1});
+    EXPECT_EQ(Annotation_selection_bounds(document),
+              std::optional<RectPx>{RectPx::From_ltrb(19, -1, 31, 11)});
+}
+
+TEST(annotation_document, RandomEdits_KeepIndexConsistentWithScans) {
+    uint32_t state = 0x2545F491u;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    AnnotationDocument document{};
+    for (int step = 0; step < 600; ++step) {
+        size_t const size = document.annotations.size();
+        // Ids stay unique, as they do in the controller; occasionally reuse a
+        // freed one.
+        uint64_t id = document.next_annotation_id;
+        if (next() % 4 == 0 && !Index_of_annotation_id(document, id % 32).has_value()) {
+            id %= 32;
+        }
+        int32_t const left = static_cast<int32_t>(next() % 200) - 100;
+        Annotation const shape =
+            next() % 2 == 0 ? Make_square(id, left) : Make_sparse_shape(id, left);
+        switch (next() % 5) {
+        case 0:
+        case 1:
+            Insert_document_annotation(document, next() % (size + 2), shape);
+            break;
+        case 2:
+            Erase_document_annotation(document, size == 0 ? 0 : next() % (size + 1));
+            break;
+        case 3:
+            if (size > 0) {
+                Replace_document_annotation(document, next() % size, shape);
+            }
+            break;
+        default: {
+            AnnotationSelection selection = {};
+            for (uint32_t count = next() % 4; count > 0; --count) {
+                selection.push_back(next() % document.next_annotation_id);
+            }
+            Set_document_selection(
+                document, Normalize_annotation_selection(document.annotations,
+                                                         selection));
+            break;
+        }
+        }
+        Expect_index_matches_scans(document);
+        if (testing::Test::HasFailure()) {
+            FAIL() << "step " << step;
+        }
+    }
+}
@@ -1,3 +1,4 @@
+#include "allocation_tracking.h"
 #include "greenflame_core/annotation_hit_test.h"
 
 using namespace greenflame::core;
@@ -513,3 +514,22 @@ TEST(annotation_hit_test, ResizeRectangleFromHandle_ClampsMinimumSizeForCrossedE
         RectPx::From_ltrb(10, 10, 21, 21), SelectionHandle::Top, {15, 21});
     EXPECT_EQ(from_top, (RectPx::From_ltrb(10, 20, 21, 21)));
 }
+
+TEST(annotation_hit_test, AnnotationHitsPoint_DoesNotAllocate) {
+    std::vector<PointPx> points;
+    for (int32_t step = 0; step < 500; ++step) {
+        points.push_back({step * 2, 100 + (step % 20)});
+    }
+    Annotation stroke{};
+    stroke.id = 1;
+    stroke.data = FreehandStrokeAnnotation{.points = std::move(points), .style = {}};
+    Annotation const line = Make_line(2, {0, 0}, {400, 300});
+    size_t hits = 0;
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t x = 0; x < 1000; x += 10) {
+            hits += Annotation_hits_point(stroke, {x, 110}) ? 1u : 0u;
+            hits += Annotation_hits_point(line, {x, x * 3 / 4}) ? 1u : 0u;
+        }
+    });
+    EXPECT_GT(hits, 0u);
+}
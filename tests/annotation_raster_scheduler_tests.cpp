@@ -0,0 +1,257 @@
+#include "fake_text_layout_engine.h"
+#include "greenflame_core/annotation_raster_scheduler.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+struct EngineCounters final {
+    std::atomic<int> engines = 0;
+    std::atomic<int> text_layouts = 0;
+    std::atomic<int> bubble_layouts = 0;
+};
+
+// Stamps every pixel with a value derived from the request so tests can tell
+// which raster an annotation received. Layout mimics a CLI engine: visual
+// bounds are derived from the origin and the text length.
+class StampingLayoutEngine final : public ITextLayoutEngine {
+  public:
+    explicit StampingLayoutEngine(EngineCounters &counters) : counters_(counters) {}
+
+    [[nodiscard]] int32_t Line_ascent(TextAnnotationBaseStyle const &) override {
+        return 0;
+    }
+    [[nodiscard]] DraftTextLayoutResult Build_draft_layout(TextDraftBuffer const &,
+                                                           PointPx) override {
+        return {};
+    }
+    [[nodiscard]] int32_t Hit_test_point(TextDraftBuffer const &, PointPx,
+                                         PointPx) override {
+        return 0;
+    }
+    [[nodiscard]] int32_t Move_vertical(TextDraftBuffer const &, PointPx, int32_t,
+                                        int, int32_t) override {
+        return 0;
+    }
+
+    [[nodiscard]] bool Prepare_for_cli(TextAnnotation &annotation) override {
+        ++counters_.text_layouts;
+        std::wstring const text = Flatten_text(annotation.runs);
+        if (text.empty()) {
+            return false;
+        }
+        int32_t const width = static_cast<int32_t>(text.size()) * 3;
+        annotation.visual_bounds =
+            RectPx::From_ltrb(annotation.origin.x + 1, annotation.origin.y - 2,
+                              annotation.origin.x + 1 + width, annotation.origin.y + 2);
+        Rasterize(annotation);
+        return true;
+    }
+
+    void Rasterize(TextAnnotation &annotation) override {
+        annotation.bitmap_width_px = annotation.visual_bounds.Width();
+        annotation.bitmap_height_px = annotation.visual_bounds.Height();
+        annotation.bitmap_row_bytes = annotation.bitmap_width_px * 4;
+        annotation.premultiplied_bgra.assign(
+            static_cast<size_t>(annotation.bitmap_row_bytes) *
+                static_cast<size_t>(annotation.bitmap_height_px),
+            static_cast<uint8_t>(annotation.runs.front().text.front()));
+    }
+
+    void Rasterize_bubble(BubbleAnnotation &annotation) override {
+        ++counters_.bubble_layouts;
+        if (annotation.diameter_px <= 0) {
+            return;
+        }
+        int32_t const d = annotation.diameter_px;
+        annotation.bitmap_width_px = d;
+        annotation.bitmap_height_px = d;
+        annotation.bitmap_row_bytes = d * 4;
+        annotation.premultiplied_bgra.assign(
+            static_cast<size_t>(d) * static_cast<size_t>(d) * 4u,
+            static_cast<uint8_t>(annotation.counter_value));
+    }
+
+  private:
+    EngineCounters &counters_;
+};
+
+[[nodiscard]] TextLayoutEngineFactory Stamping_factory(EngineCounters &counters) {
+    return [&counters]() -> std::unique_ptr<ITextLayoutEngine> {
+        ++counters.engines;
+        return std::make_unique<StampingLayoutEngine>(counters);
+    };
+}
+
+[[nodiscard]] Annotation Make_bubble(uint64_t id, int32_t counter, PointPx center,
+                                     int32_t diameter = 20) {
+    BubbleAnnotation bubble{};
+    bubble.center = center;
+    bubble.diameter_px = diameter;
+    bubble.color = RGB(255, 0, 0);
+    bubble.counter_value = counter;
+    return Annotation{id, bubble};
+}
+
+[[nodiscard]] Annotation Make_text(uint64_t id, std::wstring text, PointPx origin) {
+    TextAnnotation annotation{};
+    annotation.origin = origin;
+    annotation.base_style.point_size = 12;
+    annotation.runs = {TextRun{std::move(text), {}}};
+    return Annotation{id, annotation};
+}
+
+std::array<std::wstring, 4> const kFamilies = {L"Arial", L"Times New Roman",
+                                               L"Consolas", L"Comic Sans MS"};
+
+} // namespace
+
+TEST(annotation_raster_scheduler, NumberedBubbles_RasterizeEachDistinctRequestOnce) {
+    EngineCounters counters;
+    AnnotationRasterScheduler scheduler;
+    std::vector<Annotation> annotations = {};
+    for (int32_t step = 0; step < 50; ++step) {
+        annotations.push_back(Make_bubble(static_cast<uint64_t>(step + 1),
+                                          1 + step % 10, {step * 30, step}));
+    }
+
+    AnnotationRasterBatchResult const result =
+        scheduler.Rasterize(annotations, kFamilies, Stamping_factory(counters), 1);
+    EXPECT_EQ(result, (AnnotationRasterBatchResult{true, 0, 10, 40}));
+    EXPECT_EQ(counters.bubble_layouts, 10);
+    EXPECT_EQ(counters.engines, 1);
+    for (int32_t step = 0; step < 50; ++step) {
+        BubbleAnnotation const &bubble =
+            std::get<BubbleAnnotation>(annotations[static_cast<size_t>(step)].data);
+        EXPECT_EQ(bubble.center, (PointPx{step * 30, step}));
+        ASSERT_EQ(bubble.premultiplied_bgra.size(), 20u * 20u * 4u);
+        EXPECT_EQ(bubble.premultiplied_bgra.front(), 1 + step % 10);
+    }
+}
+
+TEST(annotation_raster_scheduler, Text_ReusesRasterAtEachOrigin) {
+    EngineCounters counters;
+    AnnotationRasterScheduler scheduler;
+    std::vector<Annotation> annotations = {Make_text(1, L"Step", {10, 20}),
+                                           Make_text(2, L"Step", {-40, 300}),
+                                           Make_text(3, L"Next", {10, 20})};
+
+    AnnotationRasterBatchResult const result =
+        scheduler.Rasterize(annotations, kFamilies, Stamping_factory(counters), 1);
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.rasterized, 2u);
+    EXPECT_EQ(counters.text_layouts, 2);
+
+    TextAnnotation const &first = std::get<TextAnnotation>(annotations[0].data);
+    TextAnnotation const &second = std::get<TextAnnotation>(annotations[1].data);
+    TextAnnotation const &third = std::get<TextAnnotation>(annotations[2].data);
+    EXPECT_EQ(first.visual_bounds, RectPx::From_ltrb(11, 18, 23, 22));
+    EXPECT_EQ(second.visual_bounds, RectPx::From_ltrb(-39, 298, -27, 302));
+    EXPECT_EQ(second.premultiplied_bgra, first.premultiplied_bgra);
+    EXPECT_EQ(first.premultiplied_bgra.front(), static_cast<uint8_t>(L'S'));
+    EXPECT_EQ(third.premultiplied_bgra.front(), static_cast<uint8_t>(L'N'));
+
+    // A different style is a different request.
+    std::vector<Annotation> bold = {Make_text(4, L"Step", {0, 0})};
+    std::get<TextAnnotation>(bold[0].data).runs[0].flags.bold = true;
+    EXPECT_EQ(scheduler.Rasterize(bold, kFamilies, Stamping_factory(counters), 1)
+                  .rasterized,
+              1u);
+}
+
+TEST(annotation_raster_scheduler, Cache_PersistsAcrossBatchesWithLruEviction) {
+    EngineCounters counters;
+    AnnotationRasterScheduler scheduler(2);
+    auto run = [&](int32_t counter) {
+        std::vector<Annotation> batch = {Make_bubble(1, counter, {0, 0})};
+        return scheduler.Rasterize(batch, kFamilies, Stamping_factory(counters), 1);
+    };
+
+    EXPECT_EQ(run(1).rasterized, 1u);
+    EXPECT_EQ(run(2).rasterized, 1u);
+    AnnotationRasterBatchResult const hit = run(1);
+    EXPECT_EQ(hit.rasterized, 0u);
+    EXPECT_EQ(hit.reused, 1u);
+    EXPECT_EQ(run(3).rasterized, 1u); // Evicts 2, the least recently used.
+    EXPECT_EQ(scheduler.Cached_entries(), 2u);
+    EXPECT_EQ(run(1).rasterized, 0u);
+    EXPECT_EQ(run(2).rasterized, 1u);
+    EXPECT_EQ(counters.bubble_layouts, 4);
+
+    // Preset families resolve font choices, so they are part of the key.
+    std::array<std::wstring, 4> other_families = kFamilies;
+    other_families[0] = L"Segoe UI";
+    std::vector<Annotation> batch = {Make_bubble(1, 2, {0, 0})};
+    EXPECT_EQ(
+        scheduler.Rasterize(batch, other_families, Stamping_factory(counters), 1)
+            .rasterized,
+        1u);
+
+    scheduler.Clear();
+    EXPECT_EQ(scheduler.Cached_entries(), 0u);
+}
+
+TEST(annotation_raster_scheduler, Workers_EachUseTheirOwnEngine) {
+    EngineCounters counters;
+    AnnotationRasterScheduler scheduler;
+    std::vector<Annotation> annotations = {};
+    for (int32_t counter = 1; counter <= 64; ++counter) {
+        annotations.push_back(
+            Make_bubble(static_cast<uint64_t>(counter), counter, {counter, 0}));
+        annotations.push_back(Make_text(static_cast<uint64_t>(100 + counter),
+                                        std::wstring(1, static_cast<wchar_t>(
+                                                            L'A' + counter % 26)) +
+                                            std::to_wstring(counter),
+                                        {0, counter}));
+    }
+
+    AnnotationRasterBatchResult const result =
+        scheduler.Rasterize(annotations, kFamilies, Stamping_factory(counters), 4);
+    EXPECT_EQ(result, (AnnotationRasterBatchResult{true, 0, 128, 0}));
+    EXPECT_EQ(counters.engines, 4);
+    EXPECT_EQ(counters.bubble_layouts, 64);
+    EXPECT_EQ(counters.text_layouts, 64);
+    for (int32_t counter = 1; counter <= 64; ++counter) {
+        size_t const index = static_cast<size_t>(counter - 1) * 2;
+        EXPECT_EQ(std::get<BubbleAnnotation>(annotations[index].data)
+                      .premultiplied_bgra.front(),
+                  counter);
+        TextAnnotation const &text =
+            std::get<TextAnnotation>(annotations[index + 1].data);
+        EXPECT_EQ(text.visual_bounds.top, counter - 2);
+        EXPECT_EQ(text.premultiplied_bgra.front(),
+                  static_cast<uint8_t>(L'A' + counter % 26));
+    }
+}
+
+TEST(annotation_raster_scheduler, Failure_ReportsFirstFailingAnnotationAndKeepsOthers) {
+    EngineCounters counters;
+    AnnotationRasterScheduler scheduler;
+    std::vector<Annotation> annotations = {
+        Make_bubble(1, 1, {0, 0}), Make_text(2, L"", {0, 0}),
+        Make_bubble(3, 2, {0, 0}, 0), Make_bubble(4, 3, {0, 0})};
+
+    AnnotationRasterBatchResult const result =
+        scheduler.Rasterize(annotations, kFamilies, Stamping_factory(counters), 2);
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.failed_index, 1u);
+    EXPECT_EQ(scheduler.Cached_entries(), 2u);
+}
+
+TEST(annotation_raster_scheduler, FakeEngine_FillsBubbleRasters) {
+    AnnotationRasterScheduler scheduler;
+    std::vector<Annotation> annotations = {Make_bubble(1, 7, {5, 5}, 24),
+                                           Make_bubble(2, 7, {50, 50}, 24)};
+    TextLayoutEngineFactory const factory = []() -> std::unique_ptr<ITextLayoutEngine> {
+        return std::make_unique<FakeTextLayoutEngine>();
+    };
+
+    AnnotationRasterBatchResult const result =
+        scheduler.Rasterize(annotations, kFamilies, factory, 8);
+    EXPECT_EQ(result, (AnnotationRasterBatchResult{true, 0, 1, 1}));
+    for (Annotation const &annotation : annotations) {
+        BubbleAnnotation const &bubble = std::get<BubbleAnnotation>(annotation.data);
+        EXPECT_EQ(bubble.bitmap_width_px, 24);
+        EXPECT_EQ(bubble.premultiplied_bgra.size(), 24u * 24u * 4u);
+    }
+}
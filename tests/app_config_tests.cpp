@@ -430,6 +430,42 @@ TEST(app_config_json, Parse_RejectsNonBooleanCaptureIncludeCursor) {
             .has_value());
 }
 
+TEST(app_config_json, CaptureHistoryBudget_RoundTripsAndRejectsOutOfRange) {
+    AppConfig config{};
+    config.capture_history_budget_mb = 0;
+    std::string const serialized = Serialize_app_config_json(config);
+    EXPECT_NE(serialized.find(R"json("history_budget_mb")json"), std::string::npos);
+    EXPECT_EQ(serialized.find(R"json("include_cursor")json"), std::string::npos);
+    std::optional<AppConfig> const round_tripped = Parse_app_config_json(serialized);
+    ASSERT_TRUE(round_tripped.has_value());
+    EXPECT_EQ(round_tripped->capture_history_budget_mb, 0);
+
+    EXPECT_EQ(Serialize_app_config_json(AppConfig{}).find("history_budget_mb"),
+              std::string::npos);
+    EXPECT_FALSE(
+        Parse_app_config_json(R"json({"capture":{"history_budget_mb":1025}})json")
+            .has_value());
+    EXPECT_FALSE(
+        Parse_app_config_json(R"json({"capture":{"history_budget_mb":-1}})json")
+            .has_value());
+}
+
+TEST(app_config_json, OverlayInputTraceDir_RoundTripsAndRejectsUnknownKeys) {
+    AppConfig config{};
+    config.overlay_input_trace_dir = L"C:\\traces";
+    std::string const serialized = Serialize_app_config_json(config);
+    EXPECT_NE(serialized.find(R"json("diagnostics")json"), std::string::npos);
+    std::optional<AppConfig> const round_tripped = Parse_app_config_json(serialized);
+    ASSERT_TRUE(round_tripped.has_value());
+    EXPECT_EQ(round_tripped->overlay_input_trace_dir, L"C:\\traces");
+
+    EXPECT_EQ(Serialize_app_config_json(AppConfig{}).find("diagnostics"),
+              std::string::npos);
+    EXPECT_FALSE(
+        Parse_app_config_json(R"json({"diagnostics":{"trace_dir":"C:\\t"}})json")
+            .has_value());
+}
+
 TEST(app_config_json, Parse_RejectsColorArrays) {
     EXPECT_FALSE(Parse_app_config_json(R"json({"tools":{"colors":["#ff00ff"]}})json")
                      .has_value());
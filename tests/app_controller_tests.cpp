@@ -1,5 +1,6 @@
 #include "greenflame_core/app_config.h"
 #include "greenflame_core/app_controller.h"
+#include "greenflame_core/cli_server_protocol.h"
 #include "greenflame_core/output_path.h"
 
 using namespace greenflame;
@@ -70,6 +71,19 @@ class MockCaptureService : public ICaptureService {
                 (core::CaptureSaveRequest const &, std::wstring_view,
                  core::ImageSaveFormat),
                 (override));
+    MOCK_METHOD(std::vector<core::CaptureSaveResult>, Save_captures_from_one_grab,
+                (std::span<const core::CaptureSaveJob>), (override));
+    MOCK_METHOD(bool, Copy_history_capture_to_clipboard, (uint64_t), (override));
+    MOCK_METHOD(core::CaptureSaveResult, Save_history_capture_to_file,
+                (uint64_t, std::wstring_view, core::ImageSaveFormat), (override));
+
+    // Not a mock so every capture flow need not expect it; tests set the id the
+    // next capture reports.
+    [[nodiscard]] std::optional<uint64_t> Take_recorded_capture_id() override {
+        return std::exchange(recorded_capture_id, std::nullopt);
+    }
+
+    std::optional<uint64_t> recorded_capture_id = std::nullopt;
 };
 
 class MockInputImageService : public IInputImageService {
@@ -126,6 +140,12 @@ class MockFileSystemService : public IFileSystemService {
     MOCK_METHOD(std::wstring, Get_app_config_file_path, (), (const, override));
     MOCK_METHOD(bool, Try_read_text_file_utf8,
                 (std::wstring_view, std::string &, std::wstring &), (const, override));
+    MOCK_METHOD(bool, Try_read_annotation_document,
+                (std::wstring_view, core::AnnotationDocument &, std::wstring &),
+                (const, override));
+    MOCK_METHOD(bool, Try_write_annotation_document,
+                (std::wstring_view, core::AnnotationDocument const &, std::wstring &),
+                (const, override));
     MOCK_METHOD(void, Delete_file_if_exists, (std::wstring_view), (const, override));
     MOCK_METHOD(core::SaveTimestamp, Get_current_timestamp, (), (const, override));
 };
@@ -138,11 +158,12 @@ struct ControllerFixture {
     StrictMock<MockInputImageService> input_image = {};
     StrictMock<MockAnnotationPreparationService> annotation_preparation = {};
     StrictMock<MockFileSystemService> file_system = {};
+    SaveDirectoryIndex save_directory_index = {};
     AppController controller;
 
     ControllerFixture()
         : controller(config, display, windows, capture, input_image,
-                     annotation_preparation, file_system) {}
+                     annotation_preparation, file_system, save_directory_index) {}
     ControllerFixture(ControllerFixture const &) = delete;
     ControllerFixture &operator=(ControllerFixture const &) = delete;
     ControllerFixture(ControllerFixture &&) = delete;
@@ -325,6 +346,101 @@ TEST(app_controller, copy_last_region_returns_warning_when_clipboard_copy_fails)
     EXPECT_THAT(result.balloon_message, HasSubstr(L"No previously captured region"));
 }
 
+TEST(app_controller, copy_last_region_copies_history_before_recapturing) {
+    ControllerFixture fixture;
+    RectPx const rect = RectPx::From_ltrb(10, 20, 110, 120);
+    fixture.capture.recorded_capture_id = 3;
+    std::ignore =
+        fixture.controller.On_selection_copied_to_clipboard(rect, std::nullopt);
+
+    EXPECT_CALL(fixture.capture, Copy_history_capture_to_clipboard(3u))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    EXPECT_TRUE(
+        fixture.controller.On_copy_last_region_to_clipboard_requested().success);
+
+    // Evicted: the region is grabbed again and the new grab is recorded.
+    EXPECT_CALL(fixture.capture, Copy_rect_to_clipboard(rect, false))
+        .WillOnce([&](RectPx, bool) {
+            fixture.capture.recorded_capture_id = 4;
+            return true;
+        });
+    EXPECT_TRUE(
+        fixture.controller.On_copy_last_region_to_clipboard_requested().success);
+    EXPECT_EQ(fixture.controller.Last_capture_history_id(), std::optional<uint64_t>{4});
+}
+
+TEST(app_controller, save_last_capture_writes_history_entry_to_default_directory) {
+    ControllerFixture fixture;
+    RectPx const rect = RectPx::From_ltrb(0, 0, 100, 100);
+    std::wstring const reserved = L"C:\\shots\\again.png";
+
+    SelectionSavedResult const empty =
+        fixture.controller.On_save_last_capture_requested();
+    EXPECT_TRUE(empty.file_path.empty());
+    EXPECT_THAT(empty.balloon_message, HasSubstr(L"No previous capture"));
+
+    fixture.capture.recorded_capture_id = 9;
+    std::ignore =
+        fixture.controller.On_selection_copied_to_clipboard(rect, std::nullopt);
+    EXPECT_CALL(fixture.file_system, Resolve_save_directory(_))
+        .Times(2)
+        .WillRepeatedly(Return(L"C:\\shots"));
+    EXPECT_CALL(fixture.file_system, Get_current_timestamp())
+        .Times(2)
+        .WillRepeatedly(Return(SaveTimestamp{}));
+    EXPECT_CALL(fixture.file_system, Reserve_unique_file_path(_))
+        .Times(2)
+        .WillRepeatedly(Return(reserved));
+    EXPECT_CALL(fixture.capture,
+                Save_history_capture_to_file(9u, Eq(std::wstring_view{reserved}),
+                                             ImageSaveFormat::Png))
+        .WillOnce(Return(Make_capture_save_success()))
+        .WillOnce(Return(core::CaptureSaveResult{core::CaptureSaveStatus::SaveFailed,
+                                                 {}}));
+    EXPECT_CALL(fixture.file_system,
+                Delete_file_if_exists(Eq(std::wstring_view{reserved})));
+
+    SelectionSavedResult const saved =
+        fixture.controller.On_save_last_capture_requested();
+    EXPECT_EQ(saved.file_path, reserved);
+    EXPECT_THAT(saved.balloon_message, HasSubstr(L"again.png"));
+
+    // Evicted from the history since; the reserved file is removed again.
+    SelectionSavedResult const evicted =
+        fixture.controller.On_save_last_capture_requested();
+    EXPECT_TRUE(evicted.file_path.empty());
+    EXPECT_THAT(evicted.balloon_message, HasSubstr(L"No previous capture"));
+}
+
+TEST(app_controller, copy_last_capture_replays_history_without_new_grab) {
+    ControllerFixture fixture;
+    RectPx const rect = RectPx::From_ltrb(0, 0, 100, 100);
+
+    ClipboardCopyResult const empty =
+        fixture.controller.On_copy_last_capture_to_clipboard_requested();
+    EXPECT_FALSE(empty.success);
+    EXPECT_THAT(empty.balloon_message, HasSubstr(L"No previous capture"));
+
+    fixture.capture.recorded_capture_id = 7;
+    std::ignore =
+        fixture.controller.On_selection_copied_to_clipboard(rect, std::nullopt);
+    EXPECT_CALL(fixture.capture, Copy_history_capture_to_clipboard(7u))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    EXPECT_TRUE(
+        fixture.controller.On_copy_last_capture_to_clipboard_requested().success);
+    // Evicted from the history since.
+    EXPECT_FALSE(
+        fixture.controller.On_copy_last_capture_to_clipboard_requested().success);
+
+    // A capture that was not recorded replaces the last one.
+    std::ignore =
+        fixture.controller.On_selection_copied_to_clipboard(rect, std::nullopt);
+    EXPECT_FALSE(
+        fixture.controller.On_copy_last_capture_to_clipboard_requested().success);
+}
+
 TEST(app_controller, copy_last_window_reports_minimized) {
     ControllerFixture fixture;
     HWND const hwnd = reinterpret_cast<HWND>(static_cast<uintptr_t>(0x2222));
@@ -1482,6 +1598,58 @@ TEST(app_controller, cli_default_output_path_uses_timestamp_and_num_scan) {
     EXPECT_THAT(result.stdout_message, HasSubstr(expected_unreserved));
 }
 
+TEST(app_controller, cli_num_pattern_sees_files_added_between_requests) {
+    ControllerFixture fixture;
+    fixture.config.default_save_dir = L"C:\\shots";
+    fixture.config.filename_pattern_desktop = L"shot_${num}";
+
+    CliOptions options{};
+    options.capture_mode = CliCaptureMode::Desktop;
+
+    RectPx const desktop = RectPx::From_ltrb(0, 0, 1920, 1080);
+    std::wstring const first = L"C:\\shots\\shot_000002.png";
+    std::wstring const second = L"C:\\shots\\shot_000005.png";
+
+    EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+        .Times(4)
+        .WillRepeatedly(Return(desktop));
+    EXPECT_CALL(fixture.file_system,
+                Resolve_save_directory(Eq(fixture.config.default_save_dir)))
+        .Times(2)
+        .WillRepeatedly(Return(L"C:\\shots"));
+    EXPECT_CALL(fixture.file_system, Get_current_timestamp())
+        .Times(2)
+        .WillRepeatedly(Return(SaveTimestamp{27, 2, 2026, 10, 11, 12}));
+    // Another program writes shot_000004 between the two requests.
+    EXPECT_CALL(fixture.file_system,
+                List_directory_filenames(Eq(std::wstring_view{L"C:\\shots"})))
+        .WillOnce(Return(
+            std::vector<std::wstring>{L"shot_000001.png", L"SHOT_000003.JPG"}))
+        .WillOnce(Return(std::vector<std::wstring>{
+            L"shot_000001.png", L"shot_000002.png", L"SHOT_000003.JPG",
+            L"shot_000004.png"}));
+    auto const expect_save = [&](std::wstring const &path) {
+        EXPECT_CALL(fixture.file_system,
+                    Resolve_absolute_path(Eq(std::wstring_view{path})))
+            .WillOnce(Return(path));
+        EXPECT_CALL(fixture.file_system,
+                    Reserve_unique_file_path(Eq(std::wstring_view{path})))
+            .WillOnce(Return(path));
+        EXPECT_CALL(fixture.capture,
+                    Save_capture_to_file(Make_screen_save_request(desktop),
+                                         Eq(std::wstring_view{path}),
+                                         ImageSaveFormat::Png))
+            .WillOnce(Return(Make_capture_save_success()));
+    };
+    expect_save(first);
+    expect_save(second);
+
+    EXPECT_THAT(fixture.controller.Run_cli_capture_mode(options).stdout_message,
+                HasSubstr(first));
+    EXPECT_THAT(fixture.controller.Run_cli_capture_mode(options).stdout_message,
+                HasSubstr(second));
+}
+
 TEST(app_controller, cli_monitor_mode_reports_out_of_range) {
     ControllerFixture fixture;
     CliOptions options{};
@@ -1521,6 +1689,86 @@ TEST(app_controller, cli_desktop_mode_saves_virtual_bounds) {
     EXPECT_EQ(result.exit_code, ProcessExitCode::Success);
 }
 
+TEST(app_controller, forwarded_cli_request_parses_args_and_runs_capture) {
+    ControllerFixture fixture;
+    RectPx const desktop = RectPx::From_ltrb(0, 0, 1920, 1080);
+    EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+        .Times(2)
+        .WillRepeatedly(Return(desktop));
+    EXPECT_CALL(fixture.file_system,
+                Resolve_absolute_path(Eq(std::wstring_view{L"desktop.png"})))
+        .WillOnce(Return(L"C:\\client\\desktop.png"));
+    EXPECT_CALL(fixture.capture,
+                Save_capture_to_file(Make_screen_save_request(desktop),
+                                     Eq(std::wstring_view{L"C:\\client\\desktop.png"}),
+                                     ImageSaveFormat::Png))
+        .WillOnce(Return(Make_capture_save_success()));
+
+    CliServerRequest const request{
+        .working_directory = L"C:\\client",
+        .args = {L"--desktop", L"--output", L"desktop.png", L"--overwrite"}};
+    CliServerResponse const response =
+        Run_forwarded_cli_request(fixture.controller, request, false);
+    EXPECT_EQ(response.exit_code, To_exit_code(ProcessExitCode::Success));
+    EXPECT_THAT(response.stdout_message, HasSubstr(L"C:\\client\\desktop.png"));
+
+    CliServerResponse const rejected = Run_forwarded_cli_request(
+        fixture.controller, CliServerRequest{.args = {L"--bogus"}}, false);
+    EXPECT_EQ(rejected.exit_code,
+              To_exit_code(ProcessExitCode::CliArgumentParseFailed));
+    EXPECT_TRUE(rejected.stderr_message.starts_with(L"Error: "));
+    EXPECT_TRUE(rejected.stdout_message.empty());
+}
+
+TEST(app_controller, cli_stdout_output_streams_without_path_reservation) {
+    ControllerFixture fixture;
+    fixture.config.default_save_dir = L"C:\\configured";
+    CliOptions options{};
+    options.capture_mode = CliCaptureMode::Desktop;
+    options.output_path = L"-";
+    options.output_format = CliOutputFormat::Jpeg;
+
+    // No Resolve_absolute_path or reservation calls: nothing touches the disk.
+    RectPx const desktop = RectPx::From_ltrb(0, 0, 1920, 1080);
+    CaptureSaveRequest expected_request = Make_screen_save_request(desktop);
+    expected_request.output_sink = OutputSinkKind::Stdout;
+    EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+        .Times(2)
+        .WillRepeatedly(Return(desktop));
+    EXPECT_CALL(fixture.capture,
+                Save_capture_to_file(expected_request, Eq(std::wstring_view{L"-"}),
+                                     ImageSaveFormat::Jpeg))
+        .WillOnce(Return(Make_capture_save_success()));
+
+    CliResult const result = fixture.controller.Run_cli_capture_mode(options);
+    EXPECT_EQ(result.exit_code, ProcessExitCode::Success);
+    EXPECT_TRUE(result.stdout_message.empty());
+    EXPECT_EQ(fixture.config.default_save_dir, L"C:\\configured");
+}
+
+TEST(app_controller, cli_stdout_output_uses_config_format_and_reports_failures) {
+    ControllerFixture fixture;
+    fixture.config.default_save_format = L"bmp";
+    CliOptions options{};
+    options.capture_mode = CliCaptureMode::Desktop;
+    options.output_path = L"-";
+
+    RectPx const desktop = RectPx::From_ltrb(0, 0, 100, 100);
+    EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+        .Times(2)
+        .WillRepeatedly(Return(desktop));
+    EXPECT_CALL(fixture.capture,
+                Save_capture_to_file(_, Eq(std::wstring_view{L"-"}),
+                                     ImageSaveFormat::Bmp))
+        .WillOnce(Return(core::CaptureSaveResult{core::CaptureSaveStatus::SaveFailed,
+                                                 {}}));
+
+    CliResult const result = fixture.controller.Run_cli_capture_mode(options);
+    EXPECT_EQ(result.exit_code, ProcessExitCode::CliCaptureSaveFailed);
+    EXPECT_TRUE(result.stdout_message.empty());
+    EXPECT_THAT(result.stderr_message, HasSubstr(L"standard output"));
+}
+
 TEST(app_controller, cli_explicit_output_without_overwrite_checks_reservation) {
     ControllerFixture fixture;
     CliOptions options{};
@@ -1905,6 +2153,123 @@ TEST(app_controller, cli_annotate_file_read_success_parses_and_saves_annotations
     EXPECT_EQ(result.exit_code, ProcessExitCode::Success);
 }
 
+TEST(app_controller, cli_save_annotations_writes_capture_local_document) {
+    ControllerFixture fixture;
+    CliOptions options{};
+    options.capture_mode = CliCaptureMode::Region;
+    options.region_px = RectPx::From_ltrb(100, 50, 300, 250);
+    options.output_path = L"C:\\shots\\out.png";
+    options.overwrite_output = true;
+    options.annotate_value = L"{\"annotations\":[]}";
+    options.save_annotations_path = L"notes.gfa";
+
+    core::Annotation prepared_annotation{};
+    prepared_annotation.id = 7;
+    prepared_annotation.data = core::LineAnnotation{
+        .start = PointPx{110, 60}, .end = PointPx{120, 70}, .style = {}};
+
+    EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+        .WillOnce(Return(RectPx::From_ltrb(0, 0, 1920, 1080)));
+    EXPECT_CALL(fixture.annotation_preparation, Prepare_annotations(_))
+        .WillOnce([&](core::AnnotationPreparationRequest const &) {
+            core::AnnotationPreparationResult result{};
+            result.status = core::AnnotationPreparationStatus::Success;
+            result.annotations = {prepared_annotation};
+            return result;
+        });
+    EXPECT_CALL(fixture.file_system,
+                Resolve_absolute_path(Eq(std::wstring_view{L"notes.gfa"})))
+        .WillOnce(Return(L"C:\\shots\\notes.gfa"));
+    EXPECT_CALL(fixture.file_system,
+                Try_write_annotation_document(
+                    Eq(std::wstring_view{L"C:\\shots\\notes.gfa"}), _, _))
+        .WillOnce([](std::wstring_view, core::AnnotationDocument const &document,
+                     std::wstring &) {
+            EXPECT_EQ(document.next_annotation_id, 8u);
+            EXPECT_EQ(document.annotations.size(), 1u);
+            auto const *line =
+                std::get_if<core::LineAnnotation>(&document.annotations[0].data);
+            EXPECT_NE(line, nullptr);
+            if (line != nullptr) {
+                EXPECT_EQ(line->start, (PointPx{10, 10}));
+                EXPECT_EQ(line->end, (PointPx{20, 20}));
+            }
+            return true;
+        });
+    EXPECT_CALL(fixture.file_system,
+                Resolve_absolute_path(Eq(std::wstring_view{L"C:\\shots\\out.png"})))
+        .WillOnce(Return(L"C:\\shots\\out.png"));
+    EXPECT_CALL(fixture.capture, Save_capture_to_file(_, _, ImageSaveFormat::Png))
+        .WillOnce([&](core::CaptureSaveRequest const &request, std::wstring_view,
+                      ImageSaveFormat) {
+            EXPECT_EQ(request.annotations,
+                      std::vector<core::Annotation>{prepared_annotation});
+            return Make_capture_save_success();
+        });
+
+    CliResult const result = fixture.controller.Run_cli_capture_mode(options);
+    EXPECT_EQ(result.exit_code, ProcessExitCode::Success) << result.stderr_message;
+}
+
+TEST(app_controller, cli_annotate_document_skips_json_and_preparation) {
+    ControllerFixture fixture;
+    CliOptions options{};
+    options.capture_mode = CliCaptureMode::Region;
+    options.region_px = RectPx::From_ltrb(400, 300, 600, 500);
+    options.output_path = L"C:\\shots\\out.png";
+    options.overwrite_output = true;
+    options.annotate_value = L"notes.gfa";
+
+    core::AnnotationDocument document{};
+    document.annotations.push_back(core::Annotation{
+        7, core::LineAnnotation{.start = PointPx{10, 10}, .end = PointPx{20, 20}}});
+    core::ObfuscateAnnotation stale_obfuscate{};
+    stale_obfuscate.bounds = RectPx::From_ltrb(0, 0, 1, 1);
+    stale_obfuscate.bitmap_width_px = 1;
+    stale_obfuscate.bitmap_height_px = 1;
+    stale_obfuscate.bitmap_row_bytes = 4;
+    stale_obfuscate.premultiplied_bgra = {1, 2, 3, 255};
+    document.annotations.push_back(core::Annotation{8, stale_obfuscate});
+    fixture.config.obfuscate_risk_acknowledged = true;
+
+    EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+        .WillOnce(Return(RectPx::From_ltrb(0, 0, 1920, 1080)));
+    EXPECT_CALL(fixture.file_system,
+                Resolve_absolute_path(Eq(std::wstring_view{L"notes.gfa"})))
+        .WillOnce(Return(L"C:\\shots\\notes.gfa"));
+    EXPECT_CALL(fixture.file_system,
+                Try_read_annotation_document(
+                    Eq(std::wstring_view{L"C:\\shots\\notes.gfa"}), _, _))
+        .WillOnce(DoAll(SetArgReferee<1>(document), Return(true)));
+    EXPECT_CALL(fixture.file_system,
+                Resolve_absolute_path(Eq(std::wstring_view{L"C:\\shots\\out.png"})))
+        .WillOnce(Return(L"C:\\shots\\out.png"));
+    EXPECT_CALL(fixture.capture, Save_capture_to_file(_, _, ImageSaveFormat::Png))
+        .WillOnce([](core::CaptureSaveRequest const &request, std::wstring_view,
+                     ImageSaveFormat) {
+            EXPECT_EQ(request.annotations.size(), 2u);
+            if (request.annotations.size() == 2u) {
+                auto const *line =
+                    std::get_if<core::LineAnnotation>(&request.annotations[0].data);
+                EXPECT_NE(line, nullptr);
+                if (line != nullptr) {
+                    EXPECT_EQ(line->start, (PointPx{410, 310}));
+                }
+                auto const *obfuscate = std::get_if<core::ObfuscateAnnotation>(
+                    &request.annotations[1].data);
+                EXPECT_NE(obfuscate, nullptr);
+                if (obfuscate != nullptr) {
+                    EXPECT_EQ(obfuscate->bounds, RectPx::From_ltrb(400, 300, 401, 301));
+                    EXPECT_TRUE(obfuscate->premultiplied_bgra.empty());
+                }
+            }
+            return Make_capture_save_success();
+        });
+
+    CliResult const result = fixture.controller.Run_cli_capture_mode(options);
+    EXPECT_EQ(result.exit_code, ProcessExitCode::Success) << result.stderr_message;
+}
+
 TEST(app_controller, cli_annotate_file_read_failure_returns_exit_14) {
     ControllerFixture fixture;
     CliOptions options{};
@@ -2065,6 +2430,38 @@ TEST(app_controller, cli_input_explicit_output_without_overwrite_reserves_and_sa
     EXPECT_THAT(result.stdout_message, HasSubstr(L"Saved: C:\\shots\\annotated.png"));
 }
 
+TEST(app_controller, cli_input_stdout_output_keeps_probed_format) {
+    ControllerFixture fixture;
+
+    CliOptions options{};
+    options.input_path = L"issue.jpg";
+    options.output_path = L"-";
+    options.annotate_value = L"{\"annotations\":[]}";
+
+    EXPECT_CALL(fixture.file_system,
+                Resolve_absolute_path(Eq(std::wstring_view{L"issue.jpg"})))
+        .WillOnce(Return(L"C:\\shots\\issue.jpg"));
+    EXPECT_CALL(fixture.input_image,
+                Probe_input_image(Eq(std::wstring_view{L"C:\\shots\\issue.jpg"})))
+        .WillOnce(Return(Make_input_probe_success(80, 60, ImageSaveFormat::Jpeg)));
+    EXPECT_CALL(fixture.annotation_preparation, Prepare_annotations(_))
+        .WillOnce(Return(Make_annotation_prepare_success()));
+    EXPECT_CALL(fixture.input_image,
+                Save_input_image_to_file(_,
+                                         Eq(std::wstring_view{L"C:\\shots\\issue.jpg"}),
+                                         Eq(std::wstring_view{L"-"}),
+                                         ImageSaveFormat::Jpeg))
+        .WillOnce([](core::InputImageSaveRequest const &request, std::wstring_view,
+                     std::wstring_view, ImageSaveFormat) {
+            EXPECT_EQ(request.output_sink, OutputSinkKind::Stdout);
+            return Make_input_save_success();
+        });
+
+    CliResult const result = fixture.controller.Run_cli_capture_mode(options);
+    EXPECT_EQ(result.exit_code, ProcessExitCode::Success);
+    EXPECT_TRUE(result.stdout_message.empty());
+}
+
 TEST(app_controller, cli_input_explicit_output_with_overwrite_skips_reservation) {
     ControllerFixture fixture;
 
@@ -2332,3 +2729,101 @@ TEST(app_controller,
     EXPECT_EQ(result.exit_code, ProcessExitCode::CliCaptureSaveFailed);
     EXPECT_THAT(result.stderr_message, HasSubstr(L"disk full"));
 }
+
+TEST(app_controller, cli_multi_region_saves_every_pair_from_one_grab) {
+    ControllerFixture fixture;
+    CliOptions options{};
+    options.capture_mode = CliCaptureMode::Region;
+    options.region_px = RectPx::From_ltrb(0, 0, 100, 50);
+    options.output_path = L"toolbar.png";
+    options.additional_regions = {
+        {RectPx::From_ltrb(10, 60, 70, 90), L"status.jpg"},
+    };
+    options.padding_px = InsetsPx{2, 2, 2, 2};
+
+    RectPx const desktop = RectPx::From_ltrb(0, 0, 1920, 1080);
+    EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+        .WillOnce(Return(desktop));
+    EXPECT_CALL(fixture.file_system,
+                Resolve_absolute_path(Eq(std::wstring_view{L"toolbar.png"})))
+        .WillOnce(Return(L"C:\\shots\\toolbar.png"));
+    EXPECT_CALL(fixture.file_system,
+                Resolve_absolute_path(Eq(std::wstring_view{L"status.jpg"})))
+        .WillOnce(Return(L"C:\\shots\\status.jpg"));
+    EXPECT_CALL(fixture.file_system, Try_reserve_exact_file_path(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(fixture.capture, Save_captures_from_one_grab(_))
+        .WillOnce([&](std::span<const core::CaptureSaveJob> jobs) {
+            EXPECT_EQ(jobs.size(), 2u);
+            EXPECT_EQ(jobs[0].path, L"C:\\shots\\toolbar.png");
+            EXPECT_EQ(jobs[0].format, ImageSaveFormat::Png);
+            EXPECT_EQ(jobs[0].request,
+                      Make_screen_save_request(*options.region_px,
+                                               InsetsPx{2, 2, 2, 2},
+                                               Make_colorref(0x00, 0x00, 0x00), true));
+            EXPECT_EQ(jobs[1].path, L"C:\\shots\\status.jpg");
+            EXPECT_EQ(jobs[1].format, ImageSaveFormat::Jpeg);
+            EXPECT_EQ(jobs[1].request.source_rect_screen,
+                      RectPx::From_ltrb(10, 60, 70, 90));
+            return std::vector<core::CaptureSaveResult>(2,
+                                                        Make_capture_save_success());
+        });
+
+    CliResult const result = fixture.controller.Run_cli_capture_mode(options);
+    EXPECT_EQ(result.exit_code, ProcessExitCode::Success);
+    EXPECT_EQ(result.stdout_message,
+              L"Saved: C:\\shots\\toolbar.png\nSaved: C:\\shots\\status.jpg");
+    EXPECT_EQ(fixture.config.default_save_dir, L"C:\\shots");
+}
+
+TEST(app_controller, cli_multi_region_rejects_duplicates_and_reports_partial_failure) {
+    {
+        ControllerFixture fixture;
+        CliOptions options{};
+        options.capture_mode = CliCaptureMode::Region;
+        options.region_px = RectPx::From_ltrb(0, 0, 10, 10);
+        options.output_path = L"a.png";
+        options.additional_regions = {{RectPx::From_ltrb(5, 5, 20, 20), L"A.PNG"}};
+        options.overwrite_output = true;
+
+        EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+            .WillOnce(Return(RectPx::From_ltrb(0, 0, 100, 100)));
+        EXPECT_CALL(fixture.file_system, Resolve_absolute_path(_))
+            .WillOnce(Return(L"C:\\shots\\a.png"))
+            .WillOnce(Return(L"C:\\shots\\A.PNG"));
+        EXPECT_CALL(fixture.capture, Save_captures_from_one_grab(_)).Times(0);
+
+        CliResult const result = fixture.controller.Run_cli_capture_mode(options);
+        EXPECT_EQ(result.exit_code, ProcessExitCode::CliOutputPathFailure);
+        EXPECT_THAT(result.stderr_message, HasSubstr(L"its own --output"));
+    }
+    {
+        ControllerFixture fixture;
+        CliOptions options{};
+        options.capture_mode = CliCaptureMode::Region;
+        options.region_px = RectPx::From_ltrb(0, 0, 10, 10);
+        options.output_path = L"a.png";
+        options.additional_regions = {{RectPx::From_ltrb(5, 5, 20, 20), L"b.png"}};
+
+        EXPECT_CALL(fixture.display, Get_virtual_desktop_bounds_px())
+            .WillOnce(Return(RectPx::From_ltrb(0, 0, 100, 100)));
+        EXPECT_CALL(fixture.file_system, Resolve_absolute_path(_))
+            .WillOnce(Return(L"C:\\shots\\a.png"))
+            .WillOnce(Return(L"C:\\shots\\b.png"));
+        EXPECT_CALL(fixture.file_system, Try_reserve_exact_file_path(_, _))
+            .Times(2)
+            .WillRepeatedly(Return(true));
+        EXPECT_CALL(fixture.capture, Save_captures_from_one_grab(_))
+            .WillOnce(Return(std::vector<core::CaptureSaveResult>{
+                Make_capture_save_success(),
+                {core::CaptureSaveStatus::SaveFailed, L"disk full"}}));
+        EXPECT_CALL(fixture.file_system,
+                    Delete_file_if_exists(Eq(std::wstring_view{L"C:\\shots\\b.png"})));
+
+        CliResult const result = fixture.controller.Run_cli_capture_mode(options);
+        EXPECT_EQ(result.exit_code, ProcessExitCode::CliCaptureSaveFailed);
+        EXPECT_EQ(result.stdout_message, L"Saved: C:\\shots\\a.png");
+        EXPECT_THAT(result.stderr_message, HasSubstr(L"disk full"));
+    }
+}
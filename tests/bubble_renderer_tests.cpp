@@ -0,0 +1,231 @@
+#include "greenflame_core/bubble_renderer.h"
+#include "greenflame_core/selection_wheel.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+constexpr int32_t kGlyphAdvancePx = 4;
+constexpr int32_t kLineHeightPx = 10;
+
+// Digit glyphs are solid kGlyphAdvancePx x kLineHeightPx blocks, so composed
+// counters are easy to locate in the output.
+class DigitAtlasEngine final : public ITextLayoutEngine {
+  public:
+    explicit DigitAtlasEngine(bool supports_digits)
+        : supports_digits_(supports_digits) {}
+
+    [[nodiscard]] int32_t Line_ascent(TextAnnotationBaseStyle const &) override {
+        return 0;
+    }
+    [[nodiscard]] DraftTextLayoutResult Build_draft_layout(TextDraftBuffer const &,
+                                                           PointPx) override {
+        return {};
+    }
+    [[nodiscard]] int32_t Hit_test_point(TextDraftBuffer const &, PointPx,
+                                         PointPx) override {
+        return 0;
+    }
+    [[nodiscard]] int32_t Move_vertical(TextDraftBuffer const &, PointPx, int32_t,
+                                        int, int32_t) override {
+        return 0;
+    }
+    void Rasterize(TextAnnotation &) override {}
+
+    void Rasterize_bubble(BubbleAnnotation &annotation) override {
+        ++bubble_calls;
+        int32_t const d = annotation.diameter_px;
+        annotation.bitmap_width_px = d;
+        annotation.bitmap_height_px = d;
+        annotation.bitmap_row_bytes = d * 4;
+        annotation.premultiplied_bgra.assign(
+            static_cast<size_t>(d) * static_cast<size_t>(d) * 4u, 0x5A);
+    }
+
+    [[nodiscard]] bool Rasterize_bubble_digits(TextFontChoice, std::wstring_view,
+                                               float font_size_dip,
+                                               BubbleDigitAtlas &out) override {
+        ++digit_calls;
+        last_font_size_dip = font_size_dip;
+        if (!supports_digits_) {
+            return false;
+        }
+        out.line_height_px = static_cast<float>(kLineHeightPx);
+        for (BubbleDigitGlyph &glyph : out.digits) {
+            glyph.advance_px = static_cast<float>(kGlyphAdvancePx);
+            glyph.width_px = kGlyphAdvancePx;
+            glyph.height_px = kLineHeightPx;
+            glyph.coverage.assign(static_cast<size_t>(kGlyphAdvancePx * kLineHeightPx),
+                                  255);
+        }
+        return true;
+    }
+
+    [[nodiscard]] uint64_t Font_generation() const noexcept override {
+        return font_generation;
+    }
+
+    int bubble_calls = 0;
+    int digit_calls = 0;
+    float last_font_size_dip = 0.0f;
+    uint64_t font_generation = 0;
+
+  private:
+    bool supports_digits_ = true;
+};
+
+[[nodiscard]] BubbleAnnotation Make_bubble(int32_t counter, int32_t diameter = 30) {
+    BubbleAnnotation bubble{};
+    bubble.diameter_px = diameter;
+    bubble.color = Make_colorref(255, 0, 0);
+    bubble.counter_value = counter;
+    return bubble;
+}
+
+[[nodiscard]] std::array<uint8_t, 4> Pixel(BubbleAnnotation const &bubble, int32_t x,
+                                           int32_t y) {
+    size_t const at =
+        static_cast<size_t>(y) * static_cast<size_t>(bubble.bitmap_row_bytes) +
+        static_cast<size_t>(x) * 4u;
+    return {bubble.premultiplied_bgra[at], bubble.premultiplied_bgra[at + 1],
+            bubble.premultiplied_bgra[at + 2], bubble.premultiplied_bgra[at + 3]};
+}
+
+constexpr std::array<uint8_t, 4> kOpaqueRed = {0, 0, 255, 255};
+constexpr std::array<uint8_t, 4> kOpaqueBlack = {0, 0, 0, 255};
+
+} // namespace
+
+TEST(bubble_renderer, Counters_ComposeFromOneAtlasPerFontAndSize) {
+    DigitAtlasEngine engine(true);
+    BubbleRenderer renderer;
+    for (int32_t counter = 1; counter < 100; ++counter) {
+        BubbleAnnotation bubble = Make_bubble(counter);
+        renderer.Rasterize(bubble, engine);
+        ASSERT_EQ(bubble.premultiplied_bgra.size(), 30u * 30u * 4u);
+    }
+    EXPECT_EQ(engine.digit_calls, 1);
+    EXPECT_EQ(engine.bubble_calls, 0);
+    EXPECT_FLOAT_EQ(engine.last_font_size_dip, Bubble_counter_font_size(30, 1));
+
+    // Three digits use a smaller font; other fonts get their own atlas.
+    BubbleAnnotation long_counter = Make_bubble(100);
+    renderer.Rasterize(long_counter, engine);
+    BubbleAnnotation serif = Make_bubble(1);
+    serif.font_choice = TextFontChoice::Serif;
+    renderer.Rasterize(serif, engine);
+    EXPECT_EQ(engine.digit_calls, 3);
+    EXPECT_EQ(renderer.Cached_atlases(), 3u);
+    EXPECT_EQ(renderer.Cached_discs(), 1u);
+
+    renderer.Clear();
+    EXPECT_EQ(renderer.Cached_atlases(), 0u);
+    EXPECT_EQ(renderer.Cached_discs(), 0u);
+}
+
+TEST(bubble_renderer, FontGenerationChange_RefetchesTheAtlas) {
+    DigitAtlasEngine engine(true);
+    BubbleRenderer renderer;
+    BubbleAnnotation first = Make_bubble(1);
+    renderer.Rasterize(first, engine);
+    BubbleAnnotation again = Make_bubble(2);
+    renderer.Rasterize(again, engine);
+    EXPECT_EQ(engine.digit_calls, 1);
+
+    // New font families behind the same preset choice.
+    ++engine.font_generation;
+    BubbleAnnotation refreshed = Make_bubble(3);
+    renderer.Rasterize(refreshed, engine);
+    EXPECT_EQ(engine.digit_calls, 2);
+    EXPECT_EQ(renderer.Cached_atlases(), 1u);
+    EXPECT_EQ(renderer.Cached_discs(), 1u);
+}
+
+TEST(bubble_renderer, Digits_AreCenteredInContrastColor) {
+    DigitAtlasEngine engine(true);
+    BubbleRenderer renderer;
+
+    BubbleAnnotation single = Make_bubble(7);
+    renderer.Rasterize(single, engine);
+    EXPECT_EQ(single.bitmap_width_px, 30);
+    EXPECT_EQ(single.bitmap_height_px, 30);
+    EXPECT_EQ(single.bitmap_row_bytes, 120);
+    // 4px glyph centered in 30px starts at 13; the 10px line box at row 10.
+    EXPECT_EQ(Pixel(single, 12, 15), kOpaqueRed);
+    EXPECT_EQ(Pixel(single, 13, 15), kOpaqueBlack);
+    EXPECT_EQ(Pixel(single, 16, 15), kOpaqueBlack);
+    EXPECT_EQ(Pixel(single, 17, 15), kOpaqueRed);
+    EXPECT_EQ(Pixel(single, 14, 9), kOpaqueRed);
+    EXPECT_EQ(Pixel(single, 14, 10), kOpaqueBlack);
+    EXPECT_EQ(Pixel(single, 14, 19), kOpaqueBlack);
+    EXPECT_EQ(Pixel(single, 14, 20), kOpaqueRed);
+
+    BubbleAnnotation pair = Make_bubble(42);
+    renderer.Rasterize(pair, engine);
+    EXPECT_EQ(Pixel(pair, 10, 15), kOpaqueRed);
+    EXPECT_EQ(Pixel(pair, 11, 15), kOpaqueBlack);
+    EXPECT_EQ(Pixel(pair, 18, 15), kOpaqueBlack);
+    EXPECT_EQ(Pixel(pair, 19, 15), kOpaqueRed);
+
+    // Dark fills get white digits.
+    BubbleAnnotation dark = Make_bubble(7);
+    dark.color = Make_colorref(0, 0, 128);
+    renderer.Rasterize(dark, engine);
+    EXPECT_EQ(Pixel(dark, 14, 15), (std::array<uint8_t, 4>{255, 255, 255, 255}));
+    EXPECT_EQ(Pixel(dark, 5, 15), (std::array<uint8_t, 4>{128, 0, 0, 255}));
+}
+
+TEST(bubble_renderer, Disc_IsTransparentOutsideAndAntialiasedAtTheEdge) {
+    DigitAtlasEngine engine(true);
+    BubbleRenderer renderer;
+    BubbleAnnotation bubble = Make_bubble(1);
+    renderer.Rasterize(bubble, engine);
+
+    EXPECT_EQ(Pixel(bubble, 0, 0), (std::array<uint8_t, 4>{0, 0, 0, 0}));
+    EXPECT_EQ(Pixel(bubble, 29, 29), (std::array<uint8_t, 4>{0, 0, 0, 0}));
+    // The ring in the text color runs 1-2px inside the edge.
+    EXPECT_EQ(Pixel(bubble, 1, 15)[2], 0);
+    EXPECT_GT(Pixel(bubble, 1, 15)[3], 128);
+    EXPECT_EQ(Pixel(bubble, 4, 15), kOpaqueRed);
+    // Diagonal edge pixels are partially covered and stay premultiplied.
+    std::array<uint8_t, 4> const edge = Pixel(bubble, 4, 4);
+    EXPECT_GT(edge[3], 0);
+    EXPECT_LT(edge[3], 255);
+    EXPECT_LE(edge[2], edge[3]);
+}
+
+TEST(bubble_renderer, EnginesWithoutDigitAtlas_FallBackToRasterizeBubble) {
+    DigitAtlasEngine engine(false);
+    BubbleRenderer renderer;
+    for (int32_t counter = 1; counter <= 3; ++counter) {
+        BubbleAnnotation bubble = Make_bubble(counter);
+        renderer.Rasterize(bubble, engine);
+        EXPECT_EQ(bubble.premultiplied_bgra.front(), 0x5A);
+    }
+    // The failed atlas lookup is remembered.
+    EXPECT_EQ(engine.digit_calls, 1);
+    EXPECT_EQ(engine.bubble_calls, 3);
+
+    DigitAtlasEngine atlas_engine(true);
+    BubbleAnnotation negative = Make_bubble(-1);
+    renderer.Rasterize(negative, atlas_engine);
+    EXPECT_EQ(atlas_engine.bubble_calls, 1);
+
+    BubbleAnnotation empty = Make_bubble(1, 0);
+    renderer.Rasterize(empty, atlas_engine);
+    EXPECT_TRUE(empty.premultiplied_bgra.empty());
+    EXPECT_EQ(atlas_engine.bubble_calls, 1);
+}
+
+TEST(bubble_renderer, CacheLimit_EmptiesCachesWhenFull) {
+    DigitAtlasEngine engine(true);
+    BubbleRenderer renderer(2);
+    for (int32_t diameter = 20; diameter < 25; ++diameter) {
+        BubbleAnnotation bubble = Make_bubble(1, diameter);
+        renderer.Rasterize(bubble, engine);
+        EXPECT_EQ(bubble.bitmap_width_px, diameter);
+    }
+    EXPECT_LE(renderer.Cached_discs(), 2u);
+    EXPECT_LE(renderer.Cached_atlases(), 2u);
+    EXPECT_EQ(engine.digit_calls, 5);
+}
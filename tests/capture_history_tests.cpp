@@ -0,0 +1,284 @@
+#include "greenflame_core/capture_history.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+class Xorshift32 final {
+  public:
+    explicit Xorshift32(uint32_t seed) noexcept : state_(seed | 1u) {}
+    [[nodiscard]] uint8_t Next() noexcept {
+        state_ ^= state_ << 13u;
+        state_ ^= state_ >> 17u;
+        state_ ^= state_ << 5u;
+        return static_cast<uint8_t>(state_);
+    }
+
+  private:
+    uint32_t state_ = 1;
+};
+
+struct TestImage final {
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<uint8_t> pixels = {};
+
+    [[nodiscard]] ExportSourcePixels Source() const {
+        return ExportSourcePixels{pixels, static_cast<size_t>(width) * 4u, width,
+                                  height};
+    }
+};
+
+// Flat bands with a noisy stripe, roughly what a window capture looks like.
+[[nodiscard]] TestImage Make_ui_image(int32_t width, int32_t height, uint32_t seed) {
+    TestImage image{width, height, {}};
+    image.pixels.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 4u);
+    Xorshift32 random(seed);
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            size_t const pixel =
+                (static_cast<size_t>(y) * static_cast<size_t>(width) +
+                 static_cast<size_t>(x)) *
+                4u;
+            bool const noisy = y % 50 < 3;
+            image.pixels[pixel] =
+                noisy ? random.Next() : static_cast<uint8_t>(y / 40);
+            image.pixels[pixel + 1u] = static_cast<uint8_t>(x / 32);
+            image.pixels[pixel + 2u] = static_cast<uint8_t>(seed);
+            // Alpha is not part of a capture and reads back opaque.
+            image.pixels[pixel + 3u] = static_cast<uint8_t>(x);
+        }
+    }
+    return image;
+}
+
+[[nodiscard]] std::vector<uint8_t> Expected_rect(TestImage const &image, RectPx rect) {
+    std::vector<uint8_t> expected;
+    for (int32_t y = rect.top; y < rect.bottom; ++y) {
+        for (int32_t x = rect.left; x < rect.right; ++x) {
+            size_t const pixel =
+                (static_cast<size_t>(y) * static_cast<size_t>(image.width) +
+                 static_cast<size_t>(x)) *
+                4u;
+            expected.insert(expected.end(), image.pixels.begin() + pixel,
+                            image.pixels.begin() + pixel + 3u);
+            expected.push_back(255);
+        }
+    }
+    return expected;
+}
+
+} // namespace
+
+TEST(capture_history, Push_ReadsBackExactPixelsAndSubRects) {
+    CaptureHistory history;
+    TestImage const image = Make_ui_image(203, 131, 1);
+    RectPx const screen = RectPx::From_ltrb(-100, 20, 103, 151);
+    std::optional<uint64_t> const id =
+        history.Push(image.Source(), screen, std::optional<HWND>{});
+    ASSERT_TRUE(id.has_value());
+
+    CaptureHistoryEntryInfo const *const info = history.Find(*id);
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->screen_rect, screen);
+    EXPECT_EQ(info->width, 203);
+    EXPECT_EQ(info->height, 131);
+    EXPECT_EQ(history.Latest(), info);
+    EXPECT_LT(history.Memory_bytes(), image.pixels.size());
+
+    std::vector<uint8_t> all(image.pixels.size());
+    ASSERT_TRUE(history.Read_all(*id, ImageRowTarget{all, 203u * 4u}));
+    EXPECT_EQ(all, Expected_rect(image, RectPx::From_ltrb(0, 0, 203, 131)));
+
+    // Crosses tile seams on both axes, written into a wider canvas.
+    RectPx const sub = RectPx::From_ltrb(60, 63, 130, 129);
+    size_t const canvas_row_bytes = 100u * 4u;
+    std::vector<uint8_t> canvas(canvas_row_bytes * 66u);
+    ASSERT_TRUE(history.Read_rect(*id, sub, ImageRowTarget{canvas, canvas_row_bytes}));
+    std::vector<uint8_t> read;
+    for (size_t row = 0; row < 66u; ++row) {
+        read.insert(read.end(), canvas.begin() + row * canvas_row_bytes,
+                    canvas.begin() + row * canvas_row_bytes + 70u * 4u);
+    }
+    EXPECT_EQ(read, Expected_rect(image, sub));
+
+    std::vector<uint8_t> too_small(10);
+    EXPECT_FALSE(history.Read_rect(*id, sub, ImageRowTarget{too_small, 70u * 4u}));
+    EXPECT_FALSE(history.Read_rect(*id, RectPx::From_ltrb(0, 0, 204, 1),
+                                   ImageRowTarget{all, 204u * 4u}));
+    EXPECT_FALSE(history.Read_all(*id + 1u, ImageRowTarget{all, 203u * 4u}));
+}
+
+TEST(capture_history, Thumbnail_IsBoundedAndOpaque) {
+    CaptureHistory history;
+    TestImage const wide = Make_ui_image(1000, 90, 2);
+    TestImage const small = Make_ui_image(40, 30, 3);
+    std::optional<uint64_t> const wide_id =
+        history.Push(wide.Source(), {}, std::optional<HWND>{});
+    std::optional<uint64_t> const small_id =
+        history.Push(small.Source(), {}, std::optional<HWND>{});
+    ASSERT_TRUE(wide_id.has_value());
+    ASSERT_TRUE(small_id.has_value());
+
+    CaptureThumbnail const *const thumbnail = history.Thumbnail(*wide_id);
+    ASSERT_NE(thumbnail, nullptr);
+    EXPECT_EQ(thumbnail->width, kCaptureHistoryThumbnailMaxEdge);
+    EXPECT_EQ(thumbnail->height, 14);
+    ASSERT_EQ(thumbnail->pixels.size(), 160u * 14u * 4u);
+    for (size_t alpha = 3; alpha < thumbnail->pixels.size(); alpha += 4u) {
+        ASSERT_EQ(thumbnail->pixels[alpha], 255);
+    }
+
+    CaptureThumbnail const *const copy = history.Thumbnail(*small_id);
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(copy->width, 40);
+    EXPECT_EQ(copy->pixels,
+              Expected_rect(small, RectPx::From_ltrb(0, 0, small.width, small.height)));
+}
+
+TEST(capture_history, Push_EvictsOldestToStayWithinLimits) {
+    CaptureHistory history(CaptureHistoryLimits{.max_entries = 3});
+    std::vector<uint64_t> ids;
+    for (uint32_t seed = 0; seed < 5; ++seed) {
+        TestImage const image = Make_ui_image(64, 64, seed);
+        std::optional<uint64_t> const id =
+            history.Push(image.Source(), {}, std::optional<HWND>{});
+        ASSERT_TRUE(id.has_value());
+        ids.push_back(*id);
+    }
+    EXPECT_EQ(history.Size(), 3u);
+    EXPECT_EQ(history.Find(ids[1]), nullptr);
+    EXPECT_NE(history.Find(ids[2]), nullptr);
+    EXPECT_EQ(history.Latest()->id, ids[4]);
+
+    size_t const per_entry = history.Memory_bytes() / 3u;
+    history.Set_limits(
+        CaptureHistoryLimits{.max_entries = 3, .budget_bytes = per_entry * 2u + 1u});
+    EXPECT_LE(history.Memory_bytes(), per_entry * 2u + 1u);
+    EXPECT_EQ(history.Find(ids[2]), nullptr);
+    EXPECT_NE(history.Find(ids[4]), nullptr);
+
+    // Bigger than the whole budget: rejected, and nothing is evicted for it.
+    TestImage const huge = Make_ui_image(600, 600, 9);
+    size_t const size_before = history.Size();
+    EXPECT_FALSE(history.Push(huge.Source(), {}, std::optional<HWND>{}).has_value());
+    EXPECT_EQ(history.Size(), size_before);
+
+    history.Set_limits(CaptureHistoryLimits{.budget_bytes = 0});
+    EXPECT_EQ(history.Size(), 0u);
+    EXPECT_EQ(history.Memory_bytes(), 0u);
+    TestImage const image = Make_ui_image(8, 8, 1);
+    EXPECT_FALSE(history.Push(image.Source(), {}, std::optional<HWND>{}).has_value());
+}
+
+TEST(capture_history, Compress_IsBoundedByTheBudget) {
+    TestImage const image = Make_ui_image(300, 200, 4);
+    std::optional<CompressedCapture> const capture =
+        Compress_capture_for_history(image.Source(), kDefaultCaptureHistoryBudgetBytes);
+    ASSERT_TRUE(capture.has_value());
+    EXPECT_EQ(capture->tiles.size(), 5u * 4u);
+    EXPECT_LT(capture->memory_bytes, image.pixels.size());
+    EXPECT_FALSE(
+        Compress_capture_for_history(image.Source(), capture->memory_bytes - 1u)
+            .has_value());
+    EXPECT_FALSE(
+        Compress_capture_for_history(ExportSourcePixels{}, 1u << 20u).has_value());
+}
+
+TEST(capture_history, Insert_TakesReservedIdsInOrderWithGaps) {
+    CaptureHistory history;
+    TestImage const image = Make_ui_image(70, 70, 5);
+    uint64_t const first = history.Reserve_id();
+    uint64_t const skipped = history.Reserve_id();
+    uint64_t const last = history.Reserve_id();
+    ASSERT_LT(first, skipped);
+    ASSERT_LT(skipped, last);
+
+    auto const compress = [&] {
+        return *Compress_capture_for_history(image.Source(),
+                                             kDefaultCaptureHistoryBudgetBytes);
+    };
+    EXPECT_TRUE(history.Insert(first, compress(), {}, std::optional<HWND>{}));
+    EXPECT_TRUE(history.Insert(last, compress(), {}, std::optional<HWND>{}));
+    EXPECT_FALSE(history.Insert(skipped, compress(), {}, std::optional<HWND>{}));
+    EXPECT_FALSE(history.Insert(last + 1u, compress(), {}, std::optional<HWND>{}));
+    EXPECT_EQ(history.Size(), 2u);
+    EXPECT_NE(history.Find(first), nullptr);
+    EXPECT_EQ(history.Find(skipped), nullptr);
+    EXPECT_EQ(history.Latest()->id, last);
+
+    std::vector<uint8_t> all(image.pixels.size());
+    ASSERT_TRUE(history.Read_all(last, ImageRowTarget{all, 70u * 4u}));
+    EXPECT_EQ(all, Expected_rect(image, RectPx::From_ltrb(0, 0, 70, 70)));
+}
+
+TEST(capture_history, Recorder_ReadsRightAfterRecord) {
+    CaptureHistoryRecorder recorder;
+    std::vector<TestImage> images;
+    std::vector<uint64_t> ids;
+    for (uint32_t seed = 0; seed < 4; ++seed) {
+        images.push_back(Make_ui_image(150 + static_cast<int32_t>(seed), 90, seed));
+        // Padded rows; the recorder keeps its own tight copy.
+        TestImage const &image = images.back();
+        size_t const row_bytes = static_cast<size_t>(image.width) * 4u + 12u;
+        std::vector<uint8_t> padded(row_bytes * static_cast<size_t>(image.height));
+        for (int32_t y = 0; y < image.height; ++y) {
+            std::ranges::copy(
+                std::span<const uint8_t>(image.pixels)
+                    .subspan(static_cast<size_t>(y) * image.width * 4u,
+                             static_cast<size_t>(image.width) * 4u),
+                padded.begin() + static_cast<std::ptrdiff_t>(y * row_bytes));
+        }
+        std::optional<uint64_t> const id = recorder.Record(
+            ExportSourcePixels{padded, row_bytes, image.width, image.height},
+            RectPx::From_ltrb(0, 0, image.width, image.height), std::optional<HWND>{});
+        ASSERT_TRUE(id.has_value());
+        ids.push_back(*id);
+    }
+
+    for (size_t index = 0; index < ids.size(); ++index) {
+        TestImage const &image = images[index];
+        std::optional<CaptureHistoryEntryInfo> const info = recorder.Find(ids[index]);
+        ASSERT_TRUE(info.has_value());
+        EXPECT_EQ(info->width, image.width);
+        std::vector<uint8_t> all(image.pixels.size());
+        ASSERT_TRUE(recorder.Read_all(
+            ids[index], ImageRowTarget{all, static_cast<size_t>(image.width) * 4u}));
+        EXPECT_EQ(all, Expected_rect(image, RectPx::From_ltrb(0, 0, image.width,
+                                                               image.height)));
+    }
+
+    recorder.Set_limits(CaptureHistoryLimits{.budget_bytes = 0});
+    EXPECT_FALSE(recorder.Find(ids.back()).has_value());
+    EXPECT_FALSE(recorder.Record(images[0].Source(), {}, std::optional<HWND>{})
+                     .has_value());
+}
+
+TEST(capture_history, Recorder_KeepsEveryCaptureOfABurstInOrder) {
+    // More captures than may wait raw, so later ones are compressed by Record.
+    CaptureHistoryRecorder recorder;
+    std::vector<TestImage> images;
+    std::vector<uint64_t> ids;
+    for (uint32_t seed = 0; seed < kCaptureHistoryMaxPendingCaptures * 4u; ++seed) {
+        images.push_back(Make_ui_image(120, 80 + static_cast<int32_t>(seed), seed));
+        std::optional<uint64_t> const id =
+            recorder.Record(images.back().Source(), {}, std::optional<HWND>{});
+        ASSERT_TRUE(id.has_value());
+        if (!ids.empty()) {
+            EXPECT_GT(*id, ids.back());
+        }
+        ids.push_back(*id);
+    }
+
+    for (size_t index = 0; index < ids.size(); ++index) {
+        TestImage const &image = images[index];
+        std::optional<CaptureHistoryEntryInfo> const info = recorder.Find(ids[index]);
+        ASSERT_TRUE(info.has_value());
+        EXPECT_EQ(info->height, image.height);
+        std::vector<uint8_t> all(image.pixels.size());
+        ASSERT_TRUE(recorder.Read_all(
+            ids[index], ImageRowTarget{all, static_cast<size_t>(image.width) * 4u}));
+        EXPECT_EQ(all, Expected_rect(image, RectPx::From_ltrb(0, 0, image.width,
+                                                               image.height)));
+    }
+}
@@ -42,6 +42,9 @@ TEST(cli_annotation_import, classify_input_detects_inline_json_and_file_path) {
               CliAnnotationInputKind::InlineJson);
     EXPECT_EQ(Classify_cli_annotation_input(L"annotations.json"),
               CliAnnotationInputKind::FilePath);
+    EXPECT_EQ(Classify_cli_annotation_input(L"C:\\notes\\prepared.GFA "),
+              CliAnnotationInputKind::DocumentPath);
+    EXPECT_EQ(Classify_cli_annotation_input(L".gfa"), CliAnnotationInputKind::FilePath);
 }
 
 TEST(cli_annotation_import, parse_rejects_unknown_top_level_key) {
@@ -886,3 +889,178 @@ TEST(cli_annotation_import, parse_rejects_coordinate_and_bounds_overflows) {
         R"({"annotations":[{"type":"bubble","center":{"x":5,"y":0},"size":4}]})",
         Make_context(config, near_edge_rect), L"overflows screen-space coordinates.");
 }
+
+namespace {
+
+constexpr std::array<std::string_view, 12> kEquivalenceSeedDocuments = {{
+    R"({"annotations":[]})",
+    R"({"$schema":"x","coordinate_space":"local","color":"#102030","highlighter_opacity_percent":40,"font":{"preset":"mono"},"annotations":[{"type":"line","start":{"x":1,"y":2},"end":{"x":3,"y":4},"size":2,"color":"#aabbcc"},{"type":"arrow","start":{"x":-5,"y":6},"end":{"x":7,"y":8}}]})",
+    R"({"annotations":[{"type":"brush","points":[{"x":1,"y":1},{"x":2,"y":3},{"x":5,"y":8}],"size":4},{"type":"highlighter","points":[{"x":0,"y":0},{"x":9,"y":9}],"opacity_percent":55}]})",
+    R"({"annotations":[{"type":"highlighter","start":{"x":1,"y":2},"end":{"x":30,"y":2},"color":"#ffff00"}]})",
+    R"({"annotations":[{"type":"rectangle","left":1,"top":2,"width":30,"height":40,"size":3},{"type":"filled_rectangle","left":-1,"top":-2,"width":3,"height":4,"color":"#000000"}]})",
+    R"({"annotations":[{"type":"ellipse","center":{"x":10,"y":10},"width":8,"height":6},{"type":"filled_ellipse","center":{"x":0,"y":0},"width":5,"height":5}]})",
+    R"({"annotations":[{"type":"obfuscate","left":0,"top":0,"width":16,"height":16,"size":4}]})",
+    R"({"annotations":[{"type":"text","origin":{"x":4,"y":5},"text":"Hello\r\nworld \"quoted\" \/ \t tab","font":{"family":"  Segoe UI  "},"size":12}]})",
+    R"({"annotations":[{"type":"text","origin":{"x":4,"y":5},"spans":[{"text":"a","bold":true},{"text":"b","bold":true},{"text":"c","italic":true,"underline":false,"strikethrough":true}]}]})",
+    R"({"annotations":[{"type":"bubble","center":{"x":1,"y":1}},{"type":"bubble","center":{"x":2,"y":2},"font":{"preset":"serif"},"size":7}]})",
+    R"({"coordinate_space":"global","annotations":[{"type":"line","start":{"x":1,"y":2},"end":{"x":3,"y":4},"start":{"x":9,"y":9}}]})",
+    R"( { "annotations" : [ { "type" : "text" , "origin" : { "x" : 1 , "y" : 2 } , "text" : "café A" } ] } )",
+}};
+
+constexpr std::array<std::string_view, 24> kEquivalenceFragments = {{
+    R"("x":)",      R"("y":1)",     R"({"x":1,"y":2})", R"("type":"brush")",
+    R"(,"bogus":1)", R"(t)",   R"(\")",            R"(1.5)",
+    R"(1e3)",       R"(-0)",        R"(true)",          R"(null)",
+    R"("points":[])", R"([])",      R"({})",            R"(,)",
+    R"(")",         R"(#zzzzzz)",   R"("#123456")",     R"(2147483648)",
+    R"("text":"")", R"("size":99)", "\xC3\x28",         R"(\n)",
+}};
+
+constexpr std::string_view kEquivalenceMutationChars = "{}[]\":,0123456789-.exyz\\ tn";
+
+// Small deterministic generator so failures reproduce across platforms.
+struct EquivalenceFuzzRng final {
+    uint32_t state = 0x9E3779B9u;
+
+    [[nodiscard]] uint32_t Next() noexcept {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    [[nodiscard]] size_t Below(size_t bound) noexcept {
+        return bound == 0 ? 0 : static_cast<size_t>(Next()) % bound;
+    }
+};
+
+[[nodiscard]] std::string Mutate_document(std::string document,
+                                          EquivalenceFuzzRng &rng) {
+    size_t const mutations = 1 + rng.Below(3);
+    for (size_t mutation = 0; mutation < mutations; ++mutation) {
+        size_t const position = rng.Below(document.size() + 1);
+        char const ch =
+            kEquivalenceMutationChars[rng.Below(kEquivalenceMutationChars.size())];
+        std::string_view const fragment =
+            kEquivalenceFragments[rng.Below(kEquivalenceFragments.size())];
+        switch (rng.Below(4)) {
+        case 0:
+            if (position < document.size()) {
+                document.erase(position, 1 + rng.Below(4));
+            }
+            break;
+        case 1:
+            document.insert(position, 1, ch);
+            break;
+        case 2:
+            if (position < document.size()) {
+                document[position] = ch;
+            }
+            break;
+        default:
+            document.insert(position, fragment);
+            break;
+        }
+    }
+    return document;
+}
+
+void Expect_parsers_equivalent(std::string_view json,
+                               CliAnnotationParseContext const &context) {
+    CliAnnotationParseResult const streamed = Parse_cli_annotations_json(json, context);
+    CliAnnotationParseResult const dom = Parse_cli_annotations_json_dom(json, context);
+    EXPECT_EQ(streamed.ok, dom.ok) << json;
+    EXPECT_EQ(streamed.error_message, dom.error_message) << json;
+    EXPECT_TRUE(streamed == dom) << json;
+}
+
+} // namespace
+
+TEST(cli_annotation_import, tape_parser_matches_dom_parser_on_seed_documents) {
+    AppConfig const config = Make_config();
+    CliAnnotationParseContext const context = Make_context(config);
+    for (std::string_view const seed : kEquivalenceSeedDocuments) {
+        CliAnnotationParseResult const result =
+            Parse_cli_annotations_json(seed, context);
+        EXPECT_TRUE(result.ok) << result.error_message;
+        Expect_parsers_equivalent(seed, context);
+    }
+}
+
+TEST(cli_annotation_import, tape_parser_matches_dom_parser_on_mutated_documents) {
+    AppConfig const config = Make_config();
+    CliAnnotationParseContext const context = Make_context(config);
+    CliAnnotationParseContext input_context = context;
+    input_context.target_kind = CliAnnotationTargetKind::InputImage;
+
+    EquivalenceFuzzRng rng{};
+    constexpr int kIterations = 6000;
+    for (int iteration = 0; iteration < kIterations; ++iteration) {
+        std::string_view const seed =
+            kEquivalenceSeedDocuments[rng.Below(kEquivalenceSeedDocuments.size())];
+        std::string const document = Mutate_document(std::string(seed), rng);
+        Expect_parsers_equivalent(document,
+                                  (iteration % 5) == 0 ? input_context : context);
+        if (::testing::Test::HasFailure()) {
+            return;
+        }
+    }
+}
+
+TEST(cli_annotation_import, tape_parser_resolves_keys_like_dom) {
+    AppConfig const config = Make_config();
+    CliAnnotationParseContext const context = Make_context(config);
+
+    // Duplicate keys: the last occurrence wins.
+    CliAnnotationParseResult const duplicate = Parse_cli_annotations_json(
+        R"({"annotations":[{"type":"line","start":{"x":1,"y":1},"end":{"x":2,"y":2},"size":2,"size":5}]})",
+        context);
+    ASSERT_TRUE(duplicate.ok);
+    EXPECT_EQ(std::get<LineAnnotation>(duplicate.annotations[0].data).style.width_px,
+              5);
+
+    // Unknown keys are reported in sorted order, not document order.
+    CliAnnotationParseResult const unknown = Parse_cli_annotations_json(
+        R"({"zeta":1,"annotations":[],"alpha":2})", context);
+    EXPECT_EQ(unknown.error_message,
+              L"--annotate: $.alpha contains an unknown property.");
+
+    // Escaped keys are decoded like easyjson: \/ resolves, \u stays verbatim.
+    Expect_parse_error_contains(R"({"annotations":[],"\u0041":1})", context,
+                                L"$.\\u0041 contains an unknown property.");
+    Expect_parsers_equivalent(R"({"annotations":[],"\u0041":1})", context);
+    Expect_parsers_equivalent(R"({"annotations":[{"ty\/pe":"brush"}]})", context);
+}
+
+TEST(cli_annotation_import, tape_parser_matches_dom_parser_on_large_brush_document) {
+    AppConfig const config = Make_config();
+    CliAnnotationParseContext const context = Make_context(config);
+
+    std::string document = R"({"annotations":[)";
+    constexpr int kStrokes = 20;
+    constexpr int kPointsPerStroke = 500;
+    for (int stroke = 0; stroke < kStrokes; ++stroke) {
+        document += stroke == 0 ? "" : ",";
+        document += R"({"type":"brush","points":[)";
+        for (int point = 0; point < kPointsPerStroke; ++point) {
+            document += point == 0 ? "" : ",";
+            document += R"({"x":)" + std::to_string(point) + R"(,"y":)" +
+                        std::to_string(stroke * 3 + point % 7) + "}";
+        }
+        document += "]}";
+    }
+    document += "]}";
+
+    CliAnnotationParseResult const result =
+        Parse_cli_annotations_json(document, context);
+    ASSERT_TRUE(result.ok) << result.error_message;
+    EXPECT_EQ(result.annotations.size(), static_cast<size_t>(kStrokes));
+    Expect_parsers_equivalent(document, context);
+
+    std::string broken = document;
+    broken.replace(broken.rfind(R"("y")"), 3, R"("q")");
+    Expect_parsers_equivalent(broken, context);
+    EXPECT_NE(Parse_cli_annotations_json(broken, context)
+                  .error_message.find(L"$.annotations[19].points[499].q"),
+              std::wstring::npos);
+}
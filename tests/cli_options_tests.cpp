@@ -147,6 +147,19 @@ TEST(cli_options, CLI_parser_RejectsBareInputWithoutOutputOrOverwrite) {
         std::wstring::npos);
 }
 
+TEST(cli_options, CLI_parser_AcceptsDashOutputButNotWithOverwrite) {
+    std::vector<std::wstring> args = {L"--desktop", L"-o", L"-"};
+    CliParseResult result = Parse_cli_arguments(args, false);
+    ASSERT_TRUE(result.ok);
+    EXPECT_EQ(result.options.output_path, L"-");
+
+    args = {L"--desktop", L"--output=-", L"--overwrite"};
+    result = Parse_cli_arguments(args, false);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.error_message.find(L"--overwrite cannot be used with --output -."),
+              std::wstring::npos);
+}
+
 TEST(cli_options, CLI_parser_RejectsInputWithLiveCaptureModesAndWindowCapture) {
     for (std::vector<std::wstring> const &args :
          {std::vector<std::wstring>{L"--input", L"shot.png", L"--region",
@@ -289,6 +302,23 @@ TEST(cli_options, CLI_parser_RejectsWhitespaceOnlyAnnotateValue) {
               std::wstring::npos);
 }
 
+TEST(cli_options, CLI_parser_ParsesSaveAnnotationsWithAnnotate) {
+    std::vector<std::wstring> args = {L"--desktop", L"--annotate", L"notes.json",
+                                      L"--save-annotations", L"notes.gfa"};
+    CliParseResult const result = Parse_cli_arguments(args, false);
+    ASSERT_TRUE(result.ok) << result.error_message;
+    EXPECT_EQ(result.options.save_annotations_path, L"notes.gfa");
+}
+
+TEST(cli_options, CLI_parser_RejectsSaveAnnotationsWithoutAnnotate) {
+    std::vector<std::wstring> args = {L"--desktop", L"--save-annotations",
+                                      L"notes.gfa"};
+    CliParseResult const result = Parse_cli_arguments(args, false);
+    EXPECT_FALSE(result.ok);
+    EXPECT_NE(result.error_message.find(L"--save-annotations requires --annotate"),
+              std::wstring::npos);
+}
+
 TEST(cli_options, CLI_parser_AcceptsWindowCaptureBackendValues) {
     {
         std::vector<std::wstring> args = {L"--window", L"Notepad", L"--window-capture",
@@ -570,6 +600,7 @@ TEST(cli_options, CLI_help_IncludesDeclaredOptions) {
     EXPECT_NE(help_release.find(L"-p, --padding"), std::wstring::npos);
     EXPECT_NE(help_release.find(L"--padding-color"), std::wstring::npos);
     EXPECT_NE(help_release.find(L"--annotate"), std::wstring::npos);
+    EXPECT_NE(help_release.find(L"--save-annotations"), std::wstring::npos);
     EXPECT_NE(help_release.find(L"--window-capture"), std::wstring::npos);
     EXPECT_NE(help_release.find(L"--cursor"), std::wstring::npos);
     EXPECT_NE(help_release.find(L"--no-cursor"), std::wstring::npos);
@@ -586,3 +617,44 @@ TEST(cli_options, CLI_help_IncludesDeclaredOptions) {
     EXPECT_EQ(help_debug.find(L"--testing-1-2"), std::wstring::npos);
 #endif
 }
+
+TEST(cli_options, CLI_parser_PairsRepeatedRegionsWithOutputsInOrder) {
+    std::vector<std::wstring> args = {L"-r", L"0,0,10,10",  L"-r", L"20,0,5,5",
+                                      L"-o", L"first.png",  L"--region=1,2,3,4",
+                                      L"-o", L"second.png", L"-o", L"third.png"};
+    CliParseResult const result = Parse_cli_arguments(args, false);
+    ASSERT_TRUE(result.ok) << result.error_message;
+    EXPECT_EQ(result.options.capture_mode, CliCaptureMode::Region);
+    EXPECT_EQ(result.options.region_px, RectPx::From_ltrb(0, 0, 10, 10));
+    EXPECT_EQ(result.options.output_path, L"first.png");
+    ASSERT_EQ(result.options.additional_regions.size(), 2u);
+    EXPECT_EQ(result.options.additional_regions[0].region_px,
+              RectPx::From_ltrb(20, 0, 25, 5));
+    EXPECT_EQ(result.options.additional_regions[0].output_path, L"second.png");
+    EXPECT_EQ(result.options.additional_regions[1].region_px,
+              RectPx::From_ltrb(1, 2, 4, 6));
+    EXPECT_EQ(result.options.additional_regions[1].output_path, L"third.png");
+}
+
+TEST(cli_options, CLI_parser_RejectsUnpairedRepeatedRegions) {
+    struct Case final {
+        std::vector<std::wstring> args;
+        std::wstring_view message;
+    };
+    for (Case const &test_case : {
+             Case{{L"-r", L"0,0,10,10", L"-r", L"0,0,5,5", L"-o", L"a.png"},
+                  L"one --output each"},
+             Case{{L"-r", L"0,0,10,10", L"-o", L"a.png", L"-o", L"b.png"},
+                  L"one --output each"},
+             Case{{L"-d", L"-o", L"a.png", L"-o", L"b.png"},
+                  L"--output can only be specified once."},
+             Case{{L"-r", L"0,0,10,10", L"-r", L"0,0,5,5", L"-o", L"a.png", L"-o",
+                   L"-"},
+                  L"cannot be used with repeated --region"},
+         }) {
+        CliParseResult const result = Parse_cli_arguments(test_case.args, false);
+        EXPECT_FALSE(result.ok);
+        EXPECT_NE(result.error_message.find(test_case.message), std::wstring::npos)
+            << result.error_message;
+    }
+}
@@ -0,0 +1,201 @@
+#include "greenflame_core/cli_server_protocol.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+// One direction of an in-memory pipe. Readers block until enough bytes arrive
+// or the writer closes.
+class ByteChannel final {
+  public:
+    void Write(std::span<const uint8_t> bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            bytes_.insert(bytes_.end(), bytes.begin(), bytes.end());
+        }
+        ready_.notify_all();
+    }
+
+    [[nodiscard]] bool Read(std::span<uint8_t> buffer) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [&] { return closed_ || bytes_.size() >= buffer.size(); });
+        if (bytes_.size() < buffer.size()) {
+            return false;
+        }
+        std::copy_n(bytes_.begin(), buffer.size(), buffer.begin());
+        bytes_.erase(bytes_.begin(),
+                     bytes_.begin() + static_cast<std::ptrdiff_t>(buffer.size()));
+        return true;
+    }
+
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_ = {};
+    std::condition_variable ready_ = {};
+    std::deque<uint8_t> bytes_ = {};
+    bool closed_ = false;
+};
+
+class ChannelStream final : public ICliServerStream {
+  public:
+    ChannelStream(ByteChannel &in, ByteChannel &out) : in_(in), out_(out) {}
+
+    [[nodiscard]] bool Read_exact(std::span<uint8_t> buffer) override {
+        return in_.Read(buffer);
+    }
+    [[nodiscard]] bool Write_all(std::span<const uint8_t> bytes) override {
+        out_.Write(bytes);
+        return true;
+    }
+
+  private:
+    ByteChannel &in_;
+    ByteChannel &out_;
+};
+
+class RecordingHandler final : public ICliRequestHandler {
+  public:
+    [[nodiscard]] CliServerResponse
+    Handle_cli_request(CliServerRequest const &request) override {
+        requests.push_back(request);
+        CliServerResponse response{};
+        response.stdout_message = L"Saved: " + request.working_directory;
+        response.stderr_message = std::to_wstring(request.args.size());
+        response.exit_code = 7;
+        return response;
+    }
+
+    std::vector<CliServerRequest> requests = {};
+};
+
+[[nodiscard]] CliServerRequest Make_request() {
+    return CliServerRequest{
+        .working_directory = L"C:\\work \x00E9",
+        .args = {L"--region", L"0,0,10,10", L"--output", L"shot.png", L""}};
+}
+
+} // namespace
+
+TEST(cli_server_protocol, RequestAndResponse_RoundTrip) {
+    CliServerRequest const request = Make_request();
+    CliServerRequest decoded_request{};
+    ASSERT_TRUE(Try_decode_cli_server_request(Encode_cli_server_request(request),
+                                              decoded_request));
+    EXPECT_EQ(decoded_request, request);
+
+    CliServerResponse const response{L"Saved: a.png", L"Warning: b", 4};
+    CliServerResponse decoded_response{};
+    ASSERT_TRUE(Try_decode_cli_server_response(Encode_cli_server_response(response),
+                                               decoded_response));
+    EXPECT_EQ(decoded_response, response);
+}
+
+TEST(cli_server_protocol, Decode_RejectsMalformedPayloads) {
+    std::vector<uint8_t> const encoded = Encode_cli_server_request(Make_request());
+    CliServerRequest request{};
+    for (size_t size = 0; size < encoded.size(); ++size) {
+        EXPECT_FALSE(Try_decode_cli_server_request(
+            std::span<const uint8_t>(encoded).first(size), request))
+            << "size=" << size;
+    }
+
+    std::vector<uint8_t> trailing = encoded;
+    trailing.push_back(0);
+    EXPECT_FALSE(Try_decode_cli_server_request(trailing, request));
+
+    std::vector<uint8_t> bad_magic = encoded;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(Try_decode_cli_server_request(bad_magic, request));
+
+    std::vector<uint8_t> other_version = encoded;
+    other_version[4] = static_cast<uint8_t>(kCliServerProtocolVersion + 1u);
+    EXPECT_FALSE(Try_decode_cli_server_request(other_version, request));
+
+    // A request is not a response.
+    CliServerResponse response{};
+    EXPECT_FALSE(Try_decode_cli_server_response(encoded, response));
+
+    // An argument count that cannot fit in the payload.
+    std::vector<uint8_t> huge_count = Encode_cli_server_request(CliServerRequest{});
+    std::fill(huge_count.end() - 4, huge_count.end(), uint8_t{0xFF});
+    EXPECT_FALSE(Try_decode_cli_server_request(huge_count, request));
+}
+
+TEST(cli_server_protocol, Frames_RejectOversizedPayloads) {
+    ByteChannel to_server;
+    ByteChannel to_client;
+    ChannelStream client(to_client, to_server);
+    ChannelStream server(to_server, to_client);
+
+    std::array<uint8_t, 4> const oversized = {0x01, 0x00, 0x40, 0x00};
+    EXPECT_TRUE(client.Write_all(oversized));
+    std::vector<uint8_t> payload = {};
+    EXPECT_FALSE(Read_cli_server_frame(server, payload));
+
+    std::vector<uint8_t> const too_big(kCliServerMaxPayloadBytes + 1u, 0);
+    EXPECT_FALSE(Write_cli_server_frame(client, too_big));
+}
+
+TEST(cli_server_protocol, ForwardedRequest_IsServedByStandInServer) {
+    ByteChannel to_server;
+    ByteChannel to_client;
+    ChannelStream client(to_client, to_server);
+    ChannelStream server(to_server, to_client);
+    RecordingHandler handler;
+
+    bool served = false;
+    std::thread server_thread([&] { served = Serve_cli_request(server, handler); });
+    std::optional<CliServerResponse> const response =
+        Forward_cli_request(client, Make_request());
+    server_thread.join();
+
+    EXPECT_TRUE(served);
+    ASSERT_EQ(handler.requests.size(), 1u);
+    EXPECT_EQ(handler.requests.front(), Make_request());
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->stdout_message, L"Saved: C:\\work \x00E9");
+    EXPECT_EQ(response->stderr_message, L"5");
+    EXPECT_EQ(response->exit_code, 7);
+}
+
+TEST(cli_server_protocol, UnreadableRequest_GetsNoResponse) {
+    ByteChannel to_server;
+    ByteChannel to_client;
+    ChannelStream client(to_client, to_server);
+    ChannelStream server(to_server, to_client);
+    RecordingHandler handler;
+
+    std::array<uint8_t, 3> const garbage = {1, 2, 3};
+    ASSERT_TRUE(Write_cli_server_frame(client, garbage));
+    EXPECT_FALSE(Serve_cli_request(server, handler));
+    EXPECT_TRUE(handler.requests.empty());
+
+    // The server hangs up; the client sees no response and runs in-process.
+    to_client.Close();
+    EXPECT_FALSE(Forward_cli_request(client, Make_request()).has_value());
+}
+
+TEST(cli_server_protocol, Forwardable_RequiresRenderSourceAndFileOutput) {
+    CliOptions options{};
+    EXPECT_FALSE(Is_cli_server_forwardable(options));
+
+    options.capture_mode = CliCaptureMode::Desktop;
+    EXPECT_TRUE(Is_cli_server_forwardable(options));
+    options.output_path = L"C:\\shots\\desktop.png";
+    EXPECT_TRUE(Is_cli_server_forwardable(options));
+    options.output_path = std::wstring(kStdoutOutputPath);
+    EXPECT_FALSE(Is_cli_server_forwardable(options));
+
+    CliOptions input{};
+    input.input_path = L"issue.png";
+    EXPECT_TRUE(Is_cli_server_forwardable(input));
+    input.action = CliAction::Help;
+    EXPECT_FALSE(Is_cli_server_forwardable(input));
+}
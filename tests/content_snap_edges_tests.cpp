@@ -0,0 +1,204 @@
+#include "greenflame_core/content_snap_edges.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+constexpr uint8_t kBackground = 200;
+constexpr uint8_t kPanel = 100;
+
+struct TestImage final {
+    int32_t width = 0;
+    int32_t height = 0;
+    std::vector<uint8_t> pixels = {};
+
+    TestImage(int32_t image_width, int32_t image_height)
+        : width(image_width), height(image_height),
+          pixels(static_cast<size_t>(image_width * image_height * 4), kBackground) {}
+
+    void Fill(RectPx rect, uint8_t gray) {
+        for (int32_t y = rect.top; y < rect.bottom; ++y) {
+            for (int32_t x = rect.left; x < rect.right; ++x) {
+                std::fill_n(pixels.begin() + (y * width + x) * 4, 3, gray);
+            }
+        }
+    }
+
+    [[nodiscard]] ContentEdgeSourcePixels Source(PointPx origin = {}) const {
+        return {pixels, static_cast<size_t>(width) * 4, width, height, origin};
+    }
+};
+
+[[nodiscard]] SnapEdges Detect(TestImage const &image,
+                               ContentEdgeSettings const &settings = {},
+                               PointPx origin = {}) {
+    std::optional<SnapEdges> edges =
+        Detect_content_snap_edges(image.Source(origin), settings, 1);
+    EXPECT_TRUE(edges.has_value());
+    return edges.value_or(SnapEdges{});
+}
+
+} // namespace
+
+TEST(content_snap_edges, PanelBordersBecomeEdgesOnRectLines) {
+    TestImage image(200, 150);
+    image.Fill(RectPx::From_ltrb(40, 30, 160, 120), kPanel);
+    SnapEdges const edges = Detect(image);
+    EXPECT_EQ(edges.vertical,
+              (std::vector<SnapEdgeSegmentPx>{{40, 30, 120}, {160, 30, 120}}));
+    EXPECT_EQ(edges.horizontal,
+              (std::vector<SnapEdgeSegmentPx>{{30, 40, 160}, {120, 40, 160}}));
+}
+
+TEST(content_snap_edges, EdgesAreReportedInScreenSpace) {
+    TestImage image(200, 150);
+    image.Fill(RectPx::From_ltrb(40, 30, 160, 120), kPanel);
+    SnapEdges const edges = Detect(image, {}, {-1920, 100});
+    ASSERT_EQ(edges.vertical.size(), 2u);
+    EXPECT_EQ(edges.vertical[0], (SnapEdgeSegmentPx{-1880, 130, 220}));
+    ASSERT_EQ(edges.horizontal.size(), 2u);
+    EXPECT_EQ(edges.horizontal[1], (SnapEdgeSegmentPx{220, -1880, -1760}));
+}
+
+TEST(content_snap_edges, SmallFeaturesAndFineTextureAreIgnored) {
+    TestImage image(160, 160);
+    // Glyph-sized box, below the minimum run.
+    image.Fill(RectPx::From_ltrb(10, 10, 30, 30), 0);
+    // One-pixel checkerboard: every boundary ties with its neighbours.
+    for (int32_t y = 60; y < 150; ++y) {
+        for (int32_t x = 60; x < 150; ++x) {
+            if ((x + y) % 2 == 0) {
+                image.Fill(RectPx::From_ltrb(x, y, x + 1, y + 1), 0);
+            }
+        }
+    }
+    SnapEdges const edges = Detect(image);
+    for (SnapEdgeSegmentPx const &edge : edges.vertical) {
+        EXPECT_TRUE(edge.line == 60 || edge.line == 150) << edge.line;
+    }
+    for (SnapEdgeSegmentPx const &edge : edges.horizontal) {
+        EXPECT_TRUE(edge.line == 60 || edge.line == 150) << edge.line;
+    }
+}
+
+TEST(content_snap_edges, ShortGapsAreBridgedAndLongGapsSplitRuns) {
+    TestImage image(300, 40);
+    // A one-pixel table line with a 2 px and a 5 px break. Its two sides tie, so
+    // thinning keeps one edge, on the line below it.
+    image.Fill(RectPx::From_ltrb(10, 20, 100, 21), kPanel);
+    image.Fill(RectPx::From_ltrb(102, 20, 170, 21), kPanel);
+    image.Fill(RectPx::From_ltrb(175, 20, 290, 21), kPanel);
+    SnapEdges const edges = Detect(image);
+    EXPECT_EQ(edges.horizontal,
+              (std::vector<SnapEdgeSegmentPx>{{21, 10, 170}, {21, 175, 290}}));
+    EXPECT_TRUE(edges.vertical.empty());
+}
+
+TEST(content_snap_edges, OutputDoesNotDependOnTilesOrWorkers) {
+    TestImage image(523, 301);
+    int32_t state = 7;
+    for (int32_t index = 0; index < 40; ++index) {
+        state = (state * 1103 + 12345) % 65521;
+        int32_t const left = state % 480;
+        int32_t const top = (state / 7) % 260;
+        image.Fill(RectPx::From_ltrb(left, top, std::min(left + 40 + state % 200, 523),
+                                     std::min(top + 30 + state % 150, 301)),
+                   static_cast<uint8_t>(state % 256));
+    }
+    std::optional<SnapEdges> const reference =
+        Detect_content_snap_edges(image.Source(), {}, 1);
+    ASSERT_TRUE(reference.has_value());
+    EXPECT_FALSE(reference->vertical.empty());
+    EXPECT_FALSE(reference->horizontal.empty());
+    for (int32_t const tile_px : {17, 64, 1000}) {
+        for (size_t const workers : {size_t{0}, size_t{3}, size_t{16}}) {
+            ContentEdgeSettings settings = {};
+            settings.tile_px = tile_px;
+            std::optional<SnapEdges> const edges =
+                Detect_content_snap_edges(image.Source(), settings, workers);
+            ASSERT_TRUE(edges.has_value());
+            EXPECT_EQ(edges->vertical, reference->vertical)
+                << tile_px << " " << workers;
+            EXPECT_EQ(edges->horizontal, reference->horizontal)
+                << tile_px << " " << workers;
+        }
+    }
+}
+
+TEST(content_snap_edges, EdgeCapKeepsTheLongestRuns) {
+    TestImage image(400, 300);
+    image.Fill(RectPx::From_ltrb(10, 10, 390, 200), kPanel);
+    image.Fill(RectPx::From_ltrb(20, 220, 90, 290), 0);
+    ContentEdgeSettings settings = {};
+    settings.max_edges_per_axis = 2;
+    SnapEdges const edges = Detect(image, settings);
+    EXPECT_EQ(edges.horizontal,
+              (std::vector<SnapEdgeSegmentPx>{{10, 10, 390}, {200, 10, 390}}));
+    EXPECT_EQ(edges.vertical,
+              (std::vector<SnapEdgeSegmentPx>{{10, 10, 200}, {390, 10, 200}}));
+}
+
+TEST(content_snap_edges, CancelledOrInvalidRunsReturnNothing) {
+    TestImage image(64, 64);
+    std::atomic<bool> const cancelled = true;
+    EXPECT_FALSE(
+        Detect_content_snap_edges(image.Source(), {}, 4, &cancelled).has_value());
+
+    ContentEdgeSourcePixels short_rows = image.Source();
+    short_rows.row_bytes = 8;
+    EXPECT_FALSE(Detect_content_snap_edges(short_rows, {}, 1).has_value());
+    ContentEdgeSourcePixels too_tall = image.Source();
+    too_tall.height = 65;
+    EXPECT_FALSE(Detect_content_snap_edges(too_tall, {}, 1).has_value());
+    EXPECT_FALSE(Detect_content_snap_edges({}, {}, 1).has_value());
+}
+
+TEST(content_snap_edges, LumaOutlivesLaterPixelChanges) {
+    TestImage image(200, 150);
+    image.Fill(RectPx::From_ltrb(40, 30, 160, 120), kPanel);
+    std::optional<ContentEdgeLuma> const luma =
+        Build_content_edge_luma(image.Source({5, 7}), 3);
+    ASSERT_TRUE(luma.has_value());
+    SnapEdges const before = Detect(image, {}, {5, 7});
+
+    // A cursor-sized patch drawn after the luma was taken does not reach it.
+    image.Fill(RectPx::From_ltrb(0, 0, 200, 150), 0);
+    std::optional<SnapEdges> const edges =
+        Detect_content_snap_edges_in_luma(*luma, {}, 2);
+    ASSERT_TRUE(edges.has_value());
+    EXPECT_EQ(edges->vertical, before.vertical);
+    EXPECT_EQ(edges->horizontal, before.horizontal);
+    EXPECT_FALSE(Build_content_edge_luma({}, 1).has_value());
+}
+
+TEST(content_snap_edges, AnalyzerHandsOverTheResultOnce) {
+    TestImage image(200, 150);
+    image.Fill(RectPx::From_ltrb(40, 30, 160, 120), kPanel);
+    std::mutex mutex;
+    std::condition_variable ready_changed;
+    bool ready = false;
+
+    std::optional<ContentEdgeLuma> const luma =
+        Build_content_edge_luma(image.Source(), 1);
+    ASSERT_TRUE(luma.has_value());
+    ContentSnapEdgeAnalyzer analyzer;
+    EXPECT_FALSE(analyzer.Take_result().has_value());
+    analyzer.Start(*luma, {}, 2, [&] {
+        std::scoped_lock lock(mutex);
+        ready = true;
+        ready_changed.notify_one();
+    });
+    {
+        std::unique_lock lock(mutex);
+        ready_changed.wait(lock, [&] { return ready; });
+    }
+    std::optional<SnapEdges> const edges = analyzer.Take_result();
+    ASSERT_TRUE(edges.has_value());
+    EXPECT_EQ(edges->vertical, Detect(image).vertical);
+    EXPECT_FALSE(analyzer.Take_result().has_value());
+
+    // Cancel drops a result that was not taken yet.
+    analyzer.Start(*luma, {}, 1, [] {});
+    analyzer.Cancel();
+    EXPECT_FALSE(analyzer.Take_result().has_value());
+}
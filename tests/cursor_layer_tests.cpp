@@ -0,0 +1,179 @@
+#include "greenflame_core/cursor_layer.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+constexpr int32_t kBytesPerPixel = 4;
+
+[[nodiscard]] size_t Pixel_offset(int32_t x, int32_t y, int32_t row_bytes) noexcept {
+    return static_cast<size_t>(y) * static_cast<size_t>(row_bytes) +
+           static_cast<size_t>(x) * static_cast<size_t>(kBytesPerPixel);
+}
+
+// Opaque target whose every pixel is distinct, so a misplaced restore shows up.
+[[nodiscard]] std::vector<uint8_t> Make_target(int32_t width, int32_t height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width * height * kBytesPerPixel));
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            size_t const offset = Pixel_offset(x, y, width * kBytesPerPixel);
+            pixels[offset] = static_cast<uint8_t>(x * 10);
+            pixels[offset + 1] = static_cast<uint8_t>(y * 10);
+            pixels[offset + 2] = static_cast<uint8_t>(x + y);
+            pixels[offset + 3] = 255;
+        }
+    }
+    return pixels;
+}
+
+// Solid premultiplied cursor of the given color and alpha.
+[[nodiscard]] CursorImage Make_solid_cursor(int32_t width, int32_t height,
+                                            uint8_t value, uint8_t alpha,
+                                            PointPx hotspot_offset_px = {}) {
+    CursorImage image = {};
+    image.hotspot_offset_px = hotspot_offset_px;
+    image.bitmap.width_px = width;
+    image.bitmap.height_px = height;
+    image.bitmap.row_bytes = width * kBytesPerPixel;
+    image.bitmap.premultiplied_bgra.resize(
+        static_cast<size_t>(width * height * kBytesPerPixel));
+    for (size_t index = 0; index < image.bitmap.premultiplied_bgra.size();
+         index += static_cast<size_t>(kBytesPerPixel)) {
+        image.bitmap.premultiplied_bgra[index] = value;
+        image.bitmap.premultiplied_bgra[index + 1] = value;
+        image.bitmap.premultiplied_bgra[index + 2] = value;
+        image.bitmap.premultiplied_bgra[index + 3] = alpha;
+    }
+    return image;
+}
+
+} // namespace
+
+TEST(cursor_layer, ShowCompositesOnlyTheCursorRectAndHideRestoresIt) {
+    constexpr int32_t width = 8;
+    constexpr int32_t height = 6;
+    constexpr int32_t row_bytes = width * kBytesPerPixel;
+    std::vector<uint8_t> const original = Make_target(width, height);
+    std::vector<uint8_t> pixels = original;
+
+    CursorLayer layer;
+    layer.Set_image(Make_solid_cursor(3, 2, 200, 255, {1, 1}), {4, 3});
+    EXPECT_EQ(layer.Bounds(), RectPx::From_ltrb(3, 2, 6, 4));
+
+    RectPx const shown = layer.Show(pixels, width, height, row_bytes);
+    EXPECT_EQ(shown, RectPx::From_ltrb(3, 2, 6, 4));
+    EXPECT_TRUE(layer.Is_shown());
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            size_t const offset = Pixel_offset(x, y, row_bytes);
+            bool const covered = x >= 3 && x < 6 && y >= 2 && y < 4;
+            EXPECT_EQ(pixels[offset], covered ? 200 : original[offset])
+                << x << "," << y;
+        }
+    }
+
+    // Showing twice neither re-blends nor overwrites the saved patch.
+    EXPECT_TRUE(layer.Show(pixels, width, height, row_bytes).Is_empty());
+
+    EXPECT_EQ(layer.Hide(pixels, width, height, row_bytes), shown);
+    EXPECT_FALSE(layer.Is_shown());
+    EXPECT_EQ(pixels, original);
+    EXPECT_TRUE(layer.Hide(pixels, width, height, row_bytes).Is_empty());
+}
+
+TEST(cursor_layer, ShowBlendsTranslucentPixelsSourceOver) {
+    std::vector<uint8_t> pixels = {100, 100, 100, 255};
+    CursorLayer layer;
+    // 50% white, premultiplied.
+    layer.Set_image(Make_solid_cursor(1, 1, 128, 128), {0, 0});
+    (void)layer.Show(pixels, 1, 1, kBytesPerPixel);
+    EXPECT_EQ(pixels[0], 128 + (100 * 127 + 127) / 255);
+    EXPECT_EQ(pixels[3], 255);
+    (void)layer.Hide(pixels, 1, 1, kBytesPerPixel);
+    EXPECT_EQ(pixels, (std::vector<uint8_t>{100, 100, 100, 255}));
+}
+
+TEST(cursor_layer, ShowClipsToTheTargetEdges) {
+    constexpr int32_t width = 4;
+    constexpr int32_t height = 4;
+    constexpr int32_t row_bytes = width * kBytesPerPixel;
+    std::vector<uint8_t> const original = Make_target(width, height);
+    std::vector<uint8_t> pixels = original;
+
+    CursorLayer layer;
+    layer.Set_image(Make_solid_cursor(3, 3, 50, 255, {2, 2}), {1, 5});
+    RectPx const shown = layer.Show(pixels, width, height, row_bytes);
+    EXPECT_EQ(shown, RectPx::From_ltrb(0, 3, 2, 4));
+    EXPECT_EQ(pixels[Pixel_offset(1, 3, row_bytes)], 50);
+    EXPECT_EQ(pixels[Pixel_offset(2, 3, row_bytes)],
+              original[Pixel_offset(2, 3, row_bytes)]);
+    (void)layer.Hide(pixels, width, height, row_bytes);
+    EXPECT_EQ(pixels, original);
+
+    // Entirely off the target: shown, but nothing changes.
+    layer.Set_image(Make_solid_cursor(2, 2, 50, 255), {-10, -10});
+    EXPECT_TRUE(layer.Show(pixels, width, height, row_bytes).Is_empty());
+    EXPECT_TRUE(layer.Is_shown());
+    EXPECT_TRUE(layer.Hide(pixels, width, height, row_bytes).Is_empty());
+    EXPECT_EQ(pixels, original);
+}
+
+TEST(cursor_layer, InvertMaskInvertsTheBackgroundAndRoundTrips) {
+    std::vector<uint8_t> const original = {10, 20, 30, 255, 40, 50, 60, 255};
+    std::vector<uint8_t> pixels = original;
+    CursorImage image = Make_solid_cursor(2, 1, 0, 0);
+    image.invert_mask = {0, 1};
+
+    CursorLayer layer;
+    layer.Set_image(std::move(image), {0, 0});
+    (void)layer.Show(pixels, 2, 1, 2 * kBytesPerPixel);
+    EXPECT_EQ(pixels, (std::vector<uint8_t>{10, 20, 30, 255, 215, 205, 195, 255}));
+    (void)layer.Hide(pixels, 2, 1, 2 * kBytesPerPixel);
+    EXPECT_EQ(pixels, original);
+}
+
+TEST(cursor_layer, LayerWithoutImageOrWithBadTargetDoesNothing) {
+    std::vector<uint8_t> pixels = {1, 2, 3, 255};
+    CursorLayer empty;
+    EXPECT_FALSE(empty.Has_image());
+    EXPECT_TRUE(empty.Show(pixels, 1, 1, kBytesPerPixel).Is_empty());
+    EXPECT_FALSE(empty.Is_shown());
+
+    CursorLayer layer;
+    layer.Set_image(Make_solid_cursor(1, 1, 9, 255), {0, 0});
+    EXPECT_TRUE(layer.Show(pixels, 2, 2, 2 * kBytesPerPixel).Is_empty());
+    EXPECT_FALSE(layer.Is_shown());
+
+    (void)layer.Show(pixels, 1, 1, kBytesPerPixel);
+    layer.Discard_target();
+    EXPECT_FALSE(layer.Is_shown());
+    EXPECT_TRUE(layer.Hide(pixels, 1, 1, kBytesPerPixel).Is_empty());
+    EXPECT_EQ(pixels[0], 9);
+}
+
+TEST(cursor_layer, CursorImageFromRendersRecoversAlphaAndInvertPixels) {
+    // Pixels: opaque red, transparent, 50% black, inverting.
+    std::vector<uint8_t> const on_black = {0, 0, 255, 255, 0,   0,   0,   255,
+                                           0, 0, 0,   255, 255, 255, 255, 255};
+    std::vector<uint8_t> const on_white = {0,   0,   255, 255, 255, 255, 255, 255,
+                                           127, 127, 127, 255, 0,   0,   0,   255};
+    CursorImage const image = Cursor_image_from_black_and_white_renders(
+        on_black, on_white, 4, 1, 4 * kBytesPerPixel, {1, 0});
+    ASSERT_TRUE(image.Is_valid());
+    EXPECT_EQ(image.hotspot_offset_px, (PointPx{1, 0}));
+    EXPECT_EQ(image.bitmap.premultiplied_bgra,
+              (std::vector<uint8_t>{0, 0, 255, 255, 0, 0, 0, 0, 0, 0, 0, 128, 0, 0, 0,
+                                    0}));
+    EXPECT_EQ(image.invert_mask, (std::vector<uint8_t>{0, 0, 0, 1}));
+
+    std::vector<uint8_t> const opaque_white(static_cast<size_t>(4 * kBytesPerPixel),
+                                           255);
+    CursorImage const plain = Cursor_image_from_black_and_white_renders(
+        opaque_white, opaque_white, 4, 1, 4 * kBytesPerPixel, {});
+    ASSERT_TRUE(plain.Is_valid());
+    EXPECT_TRUE(plain.invert_mask.empty());
+
+    EXPECT_FALSE(Cursor_image_from_black_and_white_renders(on_black, on_white, 4, 2,
+                                                           4 * kBytesPerPixel, {})
+                     .Is_valid());
+}
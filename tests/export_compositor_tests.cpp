@@ -0,0 +1,232 @@
+#include "greenflame_core/export_compositor.h"
+#include "greenflame_core/pixel_ops.h"
+#include "greenflame_core/selection_wheel.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+class XorShift32 final {
+  public:
+    explicit XorShift32(uint32_t seed) noexcept : state_(seed) {}
+
+    [[nodiscard]] uint32_t Next() noexcept {
+        state_ ^= state_ << 13u;
+        state_ ^= state_ >> 17u;
+        state_ ^= state_ << 5u;
+        return state_;
+    }
+
+  private:
+    uint32_t state_ = 1;
+};
+
+[[nodiscard]] std::vector<uint8_t> Random_bytes(XorShift32 &rng, size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t &byte : bytes) {
+        byte = static_cast<uint8_t>(rng.Next());
+    }
+    return bytes;
+}
+
+// Valid premultiplied pixels: every color channel is at most its alpha.
+[[nodiscard]] std::vector<uint8_t> Random_premultiplied(XorShift32 &rng,
+                                                        size_t pixel_count) {
+    std::vector<uint8_t> bytes(pixel_count * 4u);
+    for (size_t pixel = 0; pixel < pixel_count; ++pixel) {
+        uint32_t const alpha = rng.Next() % 3u == 0 ? 0u : rng.Next() % 256u;
+        for (size_t channel = 0; channel < 3; ++channel) {
+            bytes[pixel * 4u + channel] =
+                static_cast<uint8_t>(alpha == 0 ? 0 : rng.Next() % (alpha + 1u));
+        }
+        bytes[pixel * 4u + 3u] = static_cast<uint8_t>(alpha);
+    }
+    return bytes;
+}
+
+class RecordingSink final : public IExportRowSink {
+  public:
+    explicit RecordingSink(int32_t fail_at_row = -1) : fail_at_row_(fail_at_row) {}
+
+    [[nodiscard]] bool Write_rows(int32_t first_row, int32_t row_count,
+                                  std::span<const uint8_t> rows,
+                                  size_t row_bytes) override {
+        if (fail_at_row_ >= 0 && first_row + row_count > fail_at_row_) {
+            return false;
+        }
+        EXPECT_EQ(first_row, next_row);
+        EXPECT_EQ(rows.size(), static_cast<size_t>(row_count) * row_bytes);
+        next_row = first_row + row_count;
+        ++calls;
+        pixels.insert(pixels.end(), rows.begin(), rows.end());
+        return true;
+    }
+
+    std::vector<uint8_t> pixels = {};
+    int32_t next_row = 0;
+    int calls = 0;
+
+  private:
+    int32_t fail_at_row_ = -1;
+};
+
+// The multi-pass pipeline the compositor replaces: padded canvas, source blit,
+// opaque alpha, then one full-frame pass per layer.
+[[nodiscard]] std::vector<uint8_t> Reference_export(ExportCompositeSpec const &spec) {
+    int32_t width = 0;
+    int32_t height = 0;
+    EXPECT_TRUE(Try_get_export_size(spec, width, height));
+    int const row_bytes = width * 4;
+    std::vector<uint8_t> canvas(static_cast<size_t>(row_bytes) *
+                                static_cast<size_t>(height));
+    RectPx const full = RectPx::From_ltrb(0, 0, width, height);
+    Blend_rect_onto_pixels(canvas, width, height, row_bytes, full, spec.fill_color,
+                           255);
+    for (int32_t y = 0; y < spec.source.height; ++y) {
+        std::ranges::copy(
+            spec.source.pixels.subspan(static_cast<size_t>(y) * spec.source.row_bytes,
+                                       static_cast<size_t>(spec.source.width) * 4u),
+            canvas.begin() +
+                static_cast<std::ptrdiff_t>(
+                    static_cast<size_t>(spec.padding_px.top + y) *
+                        static_cast<size_t>(row_bytes) +
+                    static_cast<size_t>(spec.padding_px.left) * 4u));
+    }
+    Force_alpha_opaque(canvas);
+    for (ExportLayer const &layer : spec.layers) {
+        if (layer.blend == ExportLayerBlend::Multiply) {
+            Multiply_premultiplied_bitmap_onto_opaque_pixels(
+                canvas, width, height, row_bytes, layer.premultiplied_bgra,
+                layer.bounds.Width(), layer.bounds.Height(), layer.row_bytes,
+                layer.bounds);
+        } else {
+            Blend_premultiplied_bitmap_onto_opaque_pixels(
+                canvas, width, height, row_bytes, layer.premultiplied_bgra,
+                layer.bounds.Width(), layer.bounds.Height(), layer.row_bytes,
+                layer.bounds);
+        }
+    }
+    return canvas;
+}
+
+} // namespace
+
+TEST(export_compositor, Tiles_MatchMultiPassPipelineForAnyTilingAndWorkerCount) {
+    XorShift32 rng(0x5EED1234u);
+    constexpr int32_t kSourceWidth = 37;
+    constexpr int32_t kSourceHeight = 29;
+    constexpr size_t kSourceRowBytes = kSourceWidth * 4 + 12;
+    std::vector<uint8_t> const source =
+        Random_bytes(rng, kSourceRowBytes * static_cast<size_t>(kSourceHeight));
+
+    // Cursor patch (opaque), an annotation hanging off the top-left corner and a
+    // highlighter across the padding.
+    std::vector<uint8_t> cursor(8u * 8u * 4u, 0);
+    for (size_t pixel = 0; pixel < 64; ++pixel) {
+        cursor[pixel * 4u] = static_cast<uint8_t>(pixel);
+        cursor[pixel * 4u + 3u] = 255;
+    }
+    std::vector<uint8_t> const stroke = Random_premultiplied(rng, 20u * 15u);
+    std::vector<uint8_t> const highlighter = Random_premultiplied(rng, 50u * 6u);
+    std::array<ExportLayer, 3> const layers = {
+        ExportLayer{RectPx::From_ltrb(20, 12, 28, 20), cursor, 8 * 4,
+                    ExportLayerBlend::SourceOver},
+        ExportLayer{RectPx::From_ltrb(-5, -3, 15, 12), stroke, 20 * 4,
+                    ExportLayerBlend::SourceOver},
+        ExportLayer{RectPx::From_ltrb(0, 30, 50, 36), highlighter, 50 * 4,
+                    ExportLayerBlend::Multiply},
+    };
+
+    ExportCompositeSpec const spec{
+        .source = {source, kSourceRowBytes, kSourceWidth, kSourceHeight},
+        .padding_px = {3, 5, 7, 2},
+        .fill_color = Make_colorref(0x12, 0x34, 0x56),
+        .layers = layers,
+    };
+    std::vector<uint8_t> const expected = Reference_export(spec);
+
+    for (int32_t const tile_rows : {1, 7, 64, 1000}) {
+        for (size_t const workers : {size_t{0}, size_t{1}, size_t{3}, size_t{8}}) {
+            RecordingSink sink;
+            ASSERT_TRUE(Compose_export(spec, {tile_rows, workers}, sink));
+            EXPECT_EQ(sink.next_row, 36);
+            EXPECT_EQ(sink.pixels, expected)
+                << "tile_rows=" << tile_rows << " workers=" << workers;
+        }
+    }
+}
+
+TEST(export_compositor, Padding_IsOpaqueFillAndSourceAlphaIsIgnored) {
+    std::vector<uint8_t> const source = {10, 20, 30, 0};
+    ExportCompositeSpec const spec{
+        .source = {source, 4, 1, 1},
+        .padding_px = {1, 1, 1, 0},
+        .fill_color = Make_colorref(0xFF, 0x80, 0x00),
+    };
+    int32_t width = 0;
+    int32_t height = 0;
+    ASSERT_TRUE(Try_get_export_size(spec, width, height));
+    EXPECT_EQ(width, 3);
+    EXPECT_EQ(height, 2);
+
+    RecordingSink sink;
+    ASSERT_TRUE(Compose_export(spec, {}, sink));
+    EXPECT_EQ(sink.calls, 1);
+    EXPECT_EQ(sink.pixels, (std::vector<uint8_t>{0x00, 0x80, 0xFF, 255, //
+                                                 0x00, 0x80, 0xFF, 255, //
+                                                 0x00, 0x80, 0xFF, 255, //
+                                                 0x00, 0x80, 0xFF, 255, //
+                                                 10, 20, 30, 255,       //
+                                                 0x00, 0x80, 0xFF, 255}));
+}
+
+TEST(export_compositor, SinkFailure_StopsTheExport) {
+    std::vector<uint8_t> const source(16u * 40u * 4u, 0x40);
+    ExportCompositeSpec const spec{.source = {source, 16 * 4, 16, 40}};
+    for (size_t const workers : {size_t{1}, size_t{4}}) {
+        RecordingSink sink(20);
+        EXPECT_FALSE(Compose_export(spec, {8, workers}, sink));
+        EXPECT_EQ(sink.next_row, 16);
+    }
+}
+
+TEST(export_compositor, InvalidInput_IsRejected) {
+    std::vector<uint8_t> const source(4u * 4u * 4u, 0);
+    RecordingSink sink;
+
+    ExportCompositeSpec truncated{.source = {source, 16, 4, 5}};
+    EXPECT_FALSE(Compose_export(truncated, {}, sink));
+
+    ExportCompositeSpec narrow_rows{.source = {source, 12, 4, 4}};
+    EXPECT_FALSE(Compose_export(narrow_rows, {}, sink));
+
+    ExportCompositeSpec negative_padding{.source = {source, 16, 4, 4},
+                                         .padding_px = {-1, 0, 0, 0}};
+    EXPECT_FALSE(Compose_export(negative_padding, {}, sink));
+
+    std::vector<uint8_t> const layer_pixels(3u * 3u * 4u, 0);
+    std::array<ExportLayer, 1> const short_layer = {
+        ExportLayer{RectPx::From_ltrb(0, 0, 4, 4), layer_pixels, 16}};
+    ExportCompositeSpec bad_layer{.source = {source, 16, 4, 4}, .layers = short_layer};
+    EXPECT_FALSE(Compose_export(bad_layer, {}, sink));
+    EXPECT_EQ(sink.calls, 0);
+}
+
+TEST(export_compositor, ImageRowTargetSink_WritesIntoStridedBuffer) {
+    std::vector<uint8_t> const source = {1, 2, 3, 4, 5, 6, 7, 8, //
+                                         9, 10, 11, 12, 13, 14, 15, 16};
+    ExportCompositeSpec const spec{.source = {source, 8, 2, 2}};
+    std::vector<uint8_t> target(3u * 12u, 0xEE);
+    ImageRowTargetSink sink(ImageRowTarget{target, 12});
+    ASSERT_TRUE(Compose_export(spec, {1, 2}, sink));
+    EXPECT_EQ(target, (std::vector<uint8_t>{1,    2,    3,    255,  5,    6,
+                                            7,    255,  0xEE, 0xEE, 0xEE, 0xEE,
+                                            9,    10,   11,   255,  13,   14,
+                                            15,   255,  0xEE, 0xEE, 0xEE, 0xEE,
+                                            0xEE, 0xEE, 0xEE, 0xEE, 0xEE, 0xEE,
+                                            0xEE, 0xEE, 0xEE, 0xEE, 0xEE, 0xEE}));
+
+    std::vector<uint8_t> small(12u, 0);
+    ImageRowTargetSink small_sink(ImageRowTarget{small, 12});
+    EXPECT_FALSE(Compose_export(spec, {}, small_sink));
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "greenflame_core/annotation_controller.h"
+
+namespace {
+
+using namespace greenflame::core;
+
+// Solid grey source of the requested size, enough to rasterize obfuscation.
+struct FakeObfuscateSourceProvider final : public IObfuscateSourceProvider {
+    [[nodiscard]] std::optional<BgraBitmap> Build_composited_source(
+        RectPx bounds, std::span<const Annotation> /*lower_annotations*/) override {
+        RectPx const normalized_bounds = bounds.Normalized();
+        if (normalized_bounds.Is_empty()) {
+            return std::nullopt;
+        }
+
+        int32_t const width = normalized_bounds.Width();
+        int32_t const height = normalized_bounds.Height();
+        int32_t const row_bytes = width * 4;
+        return BgraBitmap{
+            .width_px = width,
+            .height_px = height,
+            .row_bytes = row_bytes,
+            .premultiplied_bgra = std::vector<uint8_t>(
+                static_cast<size_t>(row_bytes) * static_cast<size_t>(height), 0xCC),
+        };
+    }
+};
+
+} // namespace
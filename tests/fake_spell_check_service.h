@@ -9,10 +9,34 @@ using namespace greenflame::core;
 class FakeSpellCheckService final : public ISpellCheckService {
   public:
     std::vector<SpellError> errors_to_return;
+    // When non-empty, every occurrence of these words in the checked text is
+    // reported instead of errors_to_return.
+    std::vector<std::wstring> misspelled_words;
+    mutable std::vector<std::wstring> checked_texts;
 
-    [[nodiscard]] std::vector<SpellError> Check(std::wstring_view) const override {
-        return errors_to_return;
+    [[nodiscard]] std::vector<SpellError> Check(std::wstring_view text) const override {
+        checked_texts.emplace_back(text);
+        if (misspelled_words.empty()) {
+            return errors_to_return;
+        }
+
+        std::vector<SpellError> errors;
+        for (std::wstring const &word : misspelled_words) {
+            size_t pos = text.find(word);
+            while (pos != std::wstring_view::npos) {
+                errors.push_back(SpellError{static_cast<int32_t>(pos),
+                                            static_cast<int32_t>(word.size())});
+                pos = text.find(word, pos + word.size());
+            }
+        }
+        std::sort(errors.begin(), errors.end(),
+                  [](SpellError const &a, SpellError const &b) {
+                      return a.start_utf16 < b.start_utf16;
+                  });
+        return errors;
     }
+
+    [[nodiscard]] size_t Call_count() const noexcept { return checked_texts.size(); }
 };
 
 } // namespace
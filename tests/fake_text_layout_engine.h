@@ -45,6 +45,9 @@ using namespace greenflame::core;
     return line_end;
 }
 
+// Monospace engine: 10 px per UTF-16 unit, 20 px per line. Paragraph metrics are
+// opt-in so callers can exercise both the cached and the whole-draft paths; the
+// counters record how often each engine entry point ran.
 class FakeTextLayoutEngine final : public ITextLayoutEngine {
   public:
     [[nodiscard]] int32_t Line_ascent(TextAnnotationBaseStyle const &) override {
@@ -55,6 +58,7 @@ class FakeTextLayoutEngine final : public ITextLayoutEngine {
                                                            PointPx origin) override {
         constexpr int32_t char_width_px = 10;
         constexpr int32_t line_height_px = 20;
+        ++draft_layout_calls;
 
         std::wstring const text = Flatten_text(buf.runs);
         DraftTextLayoutResult result{};
@@ -90,6 +94,7 @@ class FakeTextLayoutEngine final : public ITextLayoutEngine {
                                          PointPx point) override {
         constexpr int32_t char_width_px = 10;
         constexpr int32_t line_height_px = 20;
+        ++hit_test_calls;
 
         std::wstring const text = Flatten_text(buf.runs);
         std::vector<int32_t> const starts = Line_starts(text);
@@ -106,6 +111,7 @@ class FakeTextLayoutEngine final : public ITextLayoutEngine {
                                         int32_t preferred_x_px) override {
         constexpr int32_t char_width_px = 10;
         (void)origin;
+        ++move_vertical_calls;
 
         std::wstring const text = Flatten_text(buf.runs);
         std::vector<int32_t> const starts = Line_starts(text);
@@ -117,6 +123,23 @@ class FakeTextLayoutEngine final : public ITextLayoutEngine {
         return std::clamp(line_start + column, line_start, Line_end(text, line_start));
     }
 
+    [[nodiscard]] bool Measure_paragraph(TextAnnotationBaseStyle const &style,
+                                         std::span<const TextRun> runs,
+                                         TextParagraphMetrics &out) override {
+        if (!paragraph_metrics) {
+            return false;
+        }
+        std::wstring const text = Flatten_text(runs);
+        measured_styles.push_back(style);
+        measured_paragraphs.push_back(text);
+        out.height_px = 20.0f;
+        out.caret_x_px.clear();
+        for (size_t column = 0; column <= text.size(); ++column) {
+            out.caret_x_px.push_back(static_cast<float>(column) * 10.0f);
+        }
+        return true;
+    }
+
     void Rasterize(TextAnnotation &annotation) override {
         annotation.bitmap_width_px = std::max(0, annotation.visual_bounds.Width());
         annotation.bitmap_height_px = std::max(0, annotation.visual_bounds.Height());
@@ -135,6 +158,13 @@ class FakeTextLayoutEngine final : public ITextLayoutEngine {
         annotation.premultiplied_bgra.assign(
             static_cast<size_t>(d) * static_cast<size_t>(d) * 4u, 0);
     }
+
+    bool paragraph_metrics = false;
+    int draft_layout_calls = 0;
+    int hit_test_calls = 0;
+    int move_vertical_calls = 0;
+    std::vector<TextAnnotationBaseStyle> measured_styles = {};
+    std::vector<std::wstring> measured_paragraphs = {};
 };
 
 } // namespace
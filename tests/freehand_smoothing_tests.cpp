@@ -1,3 +1,4 @@
+#include "allocation_tracking.h"
 #include "greenflame_core/freehand_smoothing.h"
 
 using namespace greenflame::core;
@@ -102,3 +103,18 @@ TEST(freehand_smoothing, PreviewPlan_ExtendedStrokeKeepsSmoothedStablePrefix) {
     EXPECT_TRUE(std::equal(smoothed_before.begin(), smoothed_before.end(),
                            smoothed_after.begin()));
 }
+
+TEST(freehand_smoothing, PreviewPlan_LongStrokeCopiesOnlyTheTail) {
+    std::vector<PointPx> points;
+    for (int32_t step = 0; step < 5000; ++step) {
+        points.push_back({step, 100 + (step % 7)});
+    }
+    FreehandPreviewPlan plan = {};
+    // One allocation for the raw tail, sized by the tail length rather than the
+    // stroke length.
+    EXPECT_ALLOCATIONS_WITHIN(1, 256 * sizeof(PointPx), {
+        plan = Build_freehand_preview_plan(points, FreehandSmoothingMode::Smooth, 6);
+    });
+    EXPECT_GT(plan.stable_raw_point_count, 4000u);
+    EXPECT_EQ(plan.tail_points.back(), points.back());
+}
@@ -0,0 +1,225 @@
+#include "greenflame_core/hdr_tone_map.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+constexpr uint16_t kHalfZero = 0x0000;
+constexpr uint16_t kHalfQuarter = 0x3400;
+constexpr uint16_t kHalfHalf = 0x3800;
+constexpr uint16_t kHalfOne = 0x3C00;
+constexpr uint16_t kHalfTwo = 0x4000;
+constexpr uint16_t kHalfTwelveAndHalf = 0x4A40;
+constexpr uint16_t kHalfMinusOne = 0xBC00;
+constexpr uint16_t kHalfInfinity = 0x7C00;
+constexpr uint16_t kHalfNan = 0x7E00;
+
+struct ScRgb final {
+    uint16_t red = 0;
+    uint16_t green = 0;
+    uint16_t blue = 0;
+};
+
+// One row of R16G16B16A16_FLOAT pixels, little-endian.
+[[nodiscard]] std::vector<uint8_t> Make_scrgb_row(std::span<const ScRgb> pixels) {
+    std::vector<uint8_t> bytes = {};
+    for (ScRgb const &pixel : pixels) {
+        for (uint16_t const channel : {pixel.red, pixel.green, pixel.blue, kHalfOne}) {
+            bytes.push_back(static_cast<uint8_t>(channel & 0xFFu));
+            bytes.push_back(static_cast<uint8_t>(channel >> 8u));
+        }
+    }
+    return bytes;
+}
+
+// R10G10B10A2_UNORM codes, little-endian.
+[[nodiscard]] std::array<uint8_t, 4> Pack_hdr10(uint32_t red, uint32_t green,
+                                                uint32_t blue) {
+    uint32_t const packed = red | (green << 10u) | (blue << 20u) | (3u << 30u);
+    return {static_cast<uint8_t>(packed), static_cast<uint8_t>(packed >> 8u),
+            static_cast<uint8_t>(packed >> 16u), static_cast<uint8_t>(packed >> 24u)};
+}
+
+[[nodiscard]] std::vector<uint8_t> Convert_scrgb_row(std::span<const ScRgb> pixels,
+                                                     ToneMapCurve curve) {
+    std::vector<uint8_t> const bytes = Make_scrgb_row(pixels);
+    HdrSourcePixels const source{bytes, bytes.size(),
+                                 static_cast<int32_t>(pixels.size()), 1,
+                                 HdrPixelFormat::ScRgbFloat16};
+    HdrToneMapSettings settings = {};
+    settings.curve = curve;
+    std::optional<BgraBitmap> const bitmap =
+        Convert_hdr_to_srgb_bitmap(source, settings, 1);
+    return bitmap.has_value() ? bitmap->premultiplied_bgra : std::vector<uint8_t>{};
+}
+
+} // namespace
+
+TEST(hdr_tone_map, ScRgbGrayRampMatchesGoldenValuesPerCurve) {
+    std::array<ScRgb, 5> const ramp = {{{kHalfZero, kHalfZero, kHalfZero},
+                                        {kHalfHalf, kHalfHalf, kHalfHalf},
+                                        {kHalfOne, kHalfOne, kHalfOne},
+                                        {kHalfTwo, kHalfTwo, kHalfTwo},
+                                        {kHalfTwelveAndHalf, kHalfTwelveAndHalf,
+                                         kHalfTwelveAndHalf}}};
+    struct Golden final {
+        ToneMapCurve curve;
+        std::array<uint8_t, 5> gray;
+    };
+    // Default settings: SDR white 80 nits, peak 1000 nits (12.5 x SDR white).
+    std::array<Golden, 3> const goldens = {{
+        {ToneMapCurve::Clip, {0, 188, 255, 255, 255}},
+        {ToneMapCurve::Reinhard, {0, 156, 188, 214, 255}},
+        {ToneMapCurve::SoftKnee, {0, 188, 243, 252, 255}},
+    }};
+    for (Golden const &golden : goldens) {
+        std::vector<uint8_t> const out = Convert_scrgb_row(ramp, golden.curve);
+        ASSERT_EQ(out.size(), ramp.size() * 4);
+        for (size_t index = 0; index < ramp.size(); ++index) {
+            for (size_t channel = 0; channel < 3; ++channel) {
+                EXPECT_EQ(out[index * 4 + channel], golden.gray[index])
+                    << static_cast<int>(golden.curve) << " pixel " << index;
+            }
+            EXPECT_EQ(out[index * 4 + 3], 255);
+        }
+    }
+}
+
+TEST(hdr_tone_map, DefaultSettingsKeepSdrWhiteWhite) {
+    std::vector<uint8_t> const bytes =
+        Make_scrgb_row(std::array<ScRgb, 2>{{{kHalfOne, kHalfOne, kHalfOne},
+                                             {kHalfHalf, kHalfHalf, kHalfHalf}}});
+    HdrSourcePixels const source{bytes, bytes.size(), 2, 1,
+                                 HdrPixelFormat::ScRgbFloat16};
+    std::optional<BgraBitmap> const bitmap =
+        Convert_hdr_to_srgb_bitmap(source, HdrToneMapSettings{}, 1);
+    ASSERT_TRUE(bitmap.has_value());
+    EXPECT_EQ(bitmap->premultiplied_bgra,
+              (std::vector<uint8_t>{255, 255, 255, 255, 188, 188, 188, 255}));
+}
+
+TEST(hdr_tone_map, ToneMappingKeepsHueOfHighlights) {
+    // (2.0, 1.0, 0.5) x SDR white: scaled as a whole instead of clipping red.
+    std::array<ScRgb, 1> const orange = {{{kHalfTwo, kHalfOne, kHalfHalf}}};
+    EXPECT_EQ(Convert_scrgb_row(orange, ToneMapCurve::Clip),
+              (std::vector<uint8_t>{137, 188, 255, 255}));
+    EXPECT_EQ(Convert_scrgb_row(orange, ToneMapCurve::SoftKnee),
+              (std::vector<uint8_t>{135, 185, 252, 255}));
+}
+
+TEST(hdr_tone_map, OutOfRangeScRgbValuesAreClamped) {
+    std::array<ScRgb, 3> const pixels = {
+        {{kHalfMinusOne, kHalfQuarter, kHalfZero},
+         {kHalfNan, kHalfNan, kHalfNan},
+         {kHalfInfinity, kHalfInfinity, kHalfInfinity}}};
+    std::vector<uint8_t> const out = Convert_scrgb_row(pixels, ToneMapCurve::SoftKnee);
+    ASSERT_EQ(out.size(), 12u);
+    EXPECT_EQ(out[0], 0);   // blue 0
+    EXPECT_EQ(out[1], 137); // green 0.25
+    EXPECT_EQ(out[2], 0);   // red -1, outside the gamut
+    EXPECT_EQ(out[4], 0);
+    EXPECT_EQ(out[8], 255);
+    EXPECT_EQ(out[10], 255);
+}
+
+TEST(hdr_tone_map, SdrWhiteLevelScalesScRgbInput) {
+    std::vector<uint8_t> const bytes =
+        Make_scrgb_row(std::array<ScRgb, 1>{{{kHalfTwo, kHalfTwo, kHalfTwo}}});
+    HdrSourcePixels const source{bytes, bytes.size(), 1, 1,
+                                 HdrPixelFormat::ScRgbFloat16};
+    HdrToneMapSettings settings = {};
+    settings.curve = ToneMapCurve::Clip;
+    settings.sdr_white_nits = 160.f; // scRGB 2.0 is exactly SDR white
+    std::optional<BgraBitmap> const bitmap =
+        Convert_hdr_to_srgb_bitmap(source, settings, 1);
+    ASSERT_TRUE(bitmap.has_value());
+    EXPECT_EQ(bitmap->premultiplied_bgra[0], 255);
+
+    settings.sdr_white_nits = 320.f; // now half of SDR white
+    std::optional<BgraBitmap> const dimmer =
+        Convert_hdr_to_srgb_bitmap(source, settings, 1);
+    ASSERT_TRUE(dimmer.has_value());
+    EXPECT_EQ(dimmer->premultiplied_bgra[0], 188);
+}
+
+TEST(hdr_tone_map, Hdr10DecodesPqAndRec2020) {
+    // Code 497 is about 80 nits; 1023 is the PQ maximum of 10000 nits.
+    std::vector<uint8_t> bytes = {};
+    for (std::array<uint8_t, 4> const pixel :
+         {Pack_hdr10(0, 0, 0), Pack_hdr10(497, 497, 497), Pack_hdr10(1023, 1023, 1023),
+          Pack_hdr10(520, 0, 0)}) {
+        bytes.insert(bytes.end(), pixel.begin(), pixel.end());
+    }
+    HdrSourcePixels const source{bytes, bytes.size(), 4, 1,
+                                 HdrPixelFormat::Hdr10Rgb10A2};
+    HdrToneMapSettings settings = {};
+    settings.curve = ToneMapCurve::Clip;
+    std::optional<BgraBitmap> const bitmap =
+        Convert_hdr_to_srgb_bitmap(source, settings, 1);
+    ASSERT_TRUE(bitmap.has_value());
+    std::vector<uint8_t> const &out = bitmap->premultiplied_bgra;
+    EXPECT_EQ(std::vector<uint8_t>(out.begin(), out.begin() + 4),
+              (std::vector<uint8_t>{0, 0, 0, 255}));
+    for (size_t channel = 0; channel < 3; ++channel) {
+        EXPECT_GE(out[4 + channel], 254);
+        EXPECT_EQ(out[8 + channel], 255);
+    }
+    // A pure Rec.2020 red lies outside Rec.709: only red survives.
+    EXPECT_EQ(out[12], 0);
+    EXPECT_EQ(out[13], 0);
+    EXPECT_EQ(out[14], 255);
+}
+
+TEST(hdr_tone_map, OutputDoesNotDependOnWorkerCount) {
+    constexpr int32_t width = 37;
+    constexpr int32_t height = 29;
+    constexpr size_t row_bytes = static_cast<size_t>(width) * 8 + 16; // padded rows
+    std::vector<uint8_t> bytes(row_bytes * height);
+    uint32_t state = 12345u;
+    for (uint8_t &byte : bytes) {
+        state = state * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(state >> 24u);
+    }
+    // Keep exponents finite so the image is mostly ordinary values.
+    for (size_t index = 1; index < bytes.size(); index += 2) {
+        bytes[index] = static_cast<uint8_t>(bytes[index] & 0x4Fu);
+    }
+    HdrSourcePixels const source{bytes, row_bytes, width, height,
+                                 HdrPixelFormat::ScRgbFloat16};
+    HdrToneMapSettings const settings{.curve = ToneMapCurve::SoftKnee};
+
+    std::optional<BgraBitmap> const single =
+        Convert_hdr_to_srgb_bitmap(source, settings, 1);
+    ASSERT_TRUE(single.has_value());
+    for (size_t const workers : {size_t{0}, size_t{2}, size_t{5}, size_t{64}}) {
+        std::optional<BgraBitmap> const parallel =
+            Convert_hdr_to_srgb_bitmap(source, settings, workers);
+        ASSERT_TRUE(parallel.has_value());
+        EXPECT_EQ(*parallel, *single) << workers;
+    }
+}
+
+TEST(hdr_tone_map, RejectsInvalidInputAndSettings) {
+    std::vector<uint8_t> const bytes(16, 0);
+    HdrSourcePixels const source{bytes, 8, 1, 2, HdrPixelFormat::ScRgbFloat16};
+    HdrToneMapSettings const settings = {};
+    std::vector<uint8_t> out(8, 0);
+    EXPECT_TRUE(Convert_hdr_to_srgb(source, settings, 1, {out, 4}));
+
+    HdrSourcePixels short_source = source;
+    short_source.height = 3;
+    EXPECT_FALSE(Convert_hdr_to_srgb(short_source, settings, 1, {out, 4}));
+    HdrSourcePixels narrow_rows = source;
+    narrow_rows.row_bytes = 4;
+    EXPECT_FALSE(Convert_hdr_to_srgb(narrow_rows, settings, 1, {out, 4}));
+    EXPECT_FALSE(
+        Convert_hdr_to_srgb(source, settings, 1, {std::span(out).first(4), 4}));
+
+    for (HdrToneMapSettings bad :
+         {HdrToneMapSettings{.sdr_white_nits = 0.f},
+          HdrToneMapSettings{.peak_nits = std::numeric_limits<float>::infinity()},
+          HdrToneMapSettings{.knee = 1.f}}) {
+        EXPECT_FALSE(Convert_hdr_to_srgb(source, bad, 1, {out, 4}));
+    }
+    EXPECT_FALSE(Convert_hdr_to_srgb_bitmap({}, settings, 1).has_value());
+}
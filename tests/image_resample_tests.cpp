@@ -0,0 +1,221 @@
+#include "greenflame_core/image_resample.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+constexpr int32_t kBytesPerPixel = 4;
+constexpr std::array<ResampleFilter, 3> kFilters = {
+    ResampleFilter::Box, ResampleFilter::Bicubic, ResampleFilter::Lanczos3};
+
+[[nodiscard]] BgraBitmap Make_bitmap(int32_t width, int32_t height) {
+    BgraBitmap bitmap = {};
+    bitmap.width_px = width;
+    bitmap.height_px = height;
+    bitmap.row_bytes = width * kBytesPerPixel;
+    bitmap.premultiplied_bgra.resize(
+        static_cast<size_t>(width * height * kBytesPerPixel));
+    return bitmap;
+}
+
+[[nodiscard]] BgraBitmap Make_solid(int32_t width, int32_t height, uint8_t value,
+                                    uint8_t alpha) {
+    BgraBitmap bitmap = Make_bitmap(width, height);
+    for (size_t index = 0; index < bitmap.premultiplied_bgra.size();
+         index += static_cast<size_t>(kBytesPerPixel)) {
+        bitmap.premultiplied_bgra[index] = value;
+        bitmap.premultiplied_bgra[index + 1] = value;
+        bitmap.premultiplied_bgra[index + 2] = value;
+        bitmap.premultiplied_bgra[index + 3] = alpha;
+    }
+    return bitmap;
+}
+
+// Every pixel distinct: blue = x, green = y, red = x + y.
+[[nodiscard]] BgraBitmap Make_gradient(int32_t width, int32_t height) {
+    BgraBitmap bitmap = Make_bitmap(width, height);
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            size_t const offset =
+                static_cast<size_t>((y * width + x) * kBytesPerPixel);
+            bitmap.premultiplied_bgra[offset] = static_cast<uint8_t>(x);
+            bitmap.premultiplied_bgra[offset + 1] = static_cast<uint8_t>(y);
+            bitmap.premultiplied_bgra[offset + 2] = static_cast<uint8_t>(x + y);
+            bitmap.premultiplied_bgra[offset + 3] = 255;
+        }
+    }
+    return bitmap;
+}
+
+[[nodiscard]] uint8_t Blue_at(BgraBitmap const &bitmap, int32_t x, int32_t y) {
+    return bitmap.premultiplied_bgra[static_cast<size_t>(y * bitmap.row_bytes +
+                                                         x * kBytesPerPixel)];
+}
+
+} // namespace
+
+TEST(image_resample, AxisWeightsSumToOneAndStayInRange) {
+    for (ResampleFilter const filter : kFilters) {
+        for (auto const &[source, target] : std::array<std::pair<int32_t, int32_t>, 4>{
+                 {{100, 7}, {7, 100}, {3, 2}, {1, 5}}}) {
+            ResampleAxisWeights const axis =
+                Build_resample_axis_weights(source, target, filter);
+            ASSERT_TRUE(axis.Is_valid());
+            EXPECT_LE(axis.taps, source);
+            for (size_t x = 0; x < static_cast<size_t>(target); ++x) {
+                EXPECT_GE(axis.first_source[x], 0);
+                EXPECT_LE(axis.first_source[x] + axis.taps, source);
+                int32_t sum = 0;
+                for (size_t tap = 0; tap < static_cast<size_t>(axis.taps); ++tap) {
+                    sum += axis.weights[x * static_cast<size_t>(axis.taps) + tap];
+                }
+                EXPECT_EQ(sum, 1 << kResampleWeightBits);
+            }
+        }
+    }
+    EXPECT_FALSE(Build_resample_axis_weights(0, 4, ResampleFilter::Box).Is_valid());
+}
+
+TEST(image_resample, BoxHalvingAveragesPixelPairs) {
+    BgraBitmap source = Make_bitmap(4, 2);
+    std::array<uint8_t, 8> const blues = {10, 20, 30, 50, 0, 0, 100, 100};
+    for (size_t index = 0; index < blues.size(); ++index) {
+        source.premultiplied_bgra[index * 4] = blues[index];
+        source.premultiplied_bgra[index * 4 + 3] = 255;
+    }
+    std::optional<BgraBitmap> const half =
+        Resample_bitmap(source, 2, 1, ResampleFilter::Box, 1);
+    ASSERT_TRUE(half.has_value());
+    EXPECT_EQ(Blue_at(*half, 0, 0), 8);  // (10 + 20 + 0 + 0) / 4 rounded
+    EXPECT_EQ(Blue_at(*half, 1, 0), 70); // (30 + 50 + 100 + 100) / 4
+    EXPECT_EQ(half->premultiplied_bgra[3], 255);
+}
+
+TEST(image_resample, FlatImagesStayFlatForEveryFilter) {
+    BgraBitmap const solid = Make_solid(13, 9, 90, 200);
+    for (ResampleFilter const filter : kFilters) {
+        for (auto const &[width, height] : std::array<std::pair<int32_t, int32_t>, 3>{
+                 {{5, 4}, {40, 31}, {13, 20}}}) {
+            std::optional<BgraBitmap> const out =
+                Resample_bitmap(solid, width, height, filter, 1);
+            ASSERT_TRUE(out.has_value());
+            EXPECT_EQ(*out, Make_solid(width, height, 90, 200))
+                << static_cast<int>(filter) << " " << width << "x" << height;
+        }
+    }
+}
+
+TEST(image_resample, RingingNeverBreaksPremultipliedPixels) {
+    // Hard edges between opaque white and transparent black overshoot with
+    // Lanczos; colors must still not exceed alpha.
+    BgraBitmap checker = Make_bitmap(8, 8);
+    for (int32_t y = 0; y < 8; ++y) {
+        for (int32_t x = 0; x < 8; ++x) {
+            if (((x / 2) + (y / 2)) % 2 == 0) {
+                std::fill_n(checker.premultiplied_bgra.begin() + (y * 8 + x) * 4, 4,
+                            uint8_t{255});
+            }
+        }
+    }
+    std::optional<BgraBitmap> const out =
+        Resample_bitmap(checker, 21, 19, ResampleFilter::Lanczos3, 1);
+    ASSERT_TRUE(out.has_value());
+    std::vector<uint8_t> const &pixels = out->premultiplied_bgra;
+    for (size_t index = 0; index < pixels.size(); index += 4) {
+        EXPECT_LE(pixels[index], pixels[index + 3]);
+        EXPECT_LE(pixels[index + 2], pixels[index + 3]);
+    }
+}
+
+TEST(image_resample, OutputDoesNotDependOnWorkerCountOrCache) {
+    BgraBitmap const source = Make_gradient(97, 61);
+    for (ResampleFilter const filter : kFilters) {
+        std::optional<BgraBitmap> const single =
+            Resample_bitmap(source, 40, 150, filter, 1);
+        ASSERT_TRUE(single.has_value());
+        ResampleWeightCache cache;
+        for (size_t const workers : {size_t{0}, size_t{3}, size_t{16}, size_t{500}}) {
+            std::optional<BgraBitmap> const parallel =
+                Resample_bitmap(source, 40, 150, filter, workers, &cache);
+            ASSERT_TRUE(parallel.has_value());
+            EXPECT_EQ(*parallel, *single) << workers;
+        }
+    }
+}
+
+TEST(image_resample, SameSizeReturnsTheSourceAndInvalidInputFails) {
+    BgraBitmap const source = Make_gradient(6, 4);
+    std::optional<BgraBitmap> const same =
+        Resample_bitmap(source, 6, 4, ResampleFilter::Lanczos3, 4);
+    ASSERT_TRUE(same.has_value());
+    EXPECT_EQ(*same, source);
+    EXPECT_FALSE(Resample_bitmap(source, 0, 4, ResampleFilter::Box, 1).has_value());
+    EXPECT_FALSE(Resample_bitmap({}, 2, 2, ResampleFilter::Box, 1).has_value());
+}
+
+TEST(image_resample, WeightCacheReusesAndEvictsLeastRecentlyUsed) {
+    ResampleWeightCache cache(2);
+    std::shared_ptr<const ResampleAxisWeights> const first =
+        cache.Get(100, 50, ResampleFilter::Bicubic);
+    EXPECT_EQ(cache.Get(100, 50, ResampleFilter::Bicubic), first);
+    EXPECT_NE(cache.Get(100, 50, ResampleFilter::Lanczos3), first);
+    EXPECT_EQ(cache.Get(100, 50, ResampleFilter::Bicubic), first);
+    (void)cache.Get(100, 60, ResampleFilter::Bicubic); // evicts the Lanczos entry
+    EXPECT_EQ(cache.Size(), 2u);
+    EXPECT_EQ(cache.Get(100, 50, ResampleFilter::Bicubic), first);
+}
+
+TEST(image_resample, QuarterTurnsRotateClockwise) {
+    // 3 x 2 source, blue = x, green = y.
+    BgraBitmap const source = Make_gradient(3, 2);
+    BgraBitmap const right = Rotate_bitmap_quarter_turns(source, 1);
+    ASSERT_EQ(right.width_px, 2);
+    ASSERT_EQ(right.height_px, 3);
+    // The source's bottom-left corner becomes the top-left corner.
+    EXPECT_EQ(Blue_at(right, 0, 0), 0);
+    EXPECT_EQ(right.premultiplied_bgra[1], 1);
+    EXPECT_EQ(Blue_at(right, 1, 2), 2); // top-right becomes bottom-right
+    EXPECT_EQ(right.premultiplied_bgra[static_cast<size_t>(2 * 8 + 4 + 1)], 0);
+
+    BgraBitmap const half = Rotate_bitmap_quarter_turns(source, 2);
+    EXPECT_EQ(Blue_at(half, 0, 0), 2);
+    EXPECT_EQ(half.premultiplied_bgra[1], 1);
+
+    EXPECT_EQ(Rotate_bitmap_quarter_turns(source, -1),
+              Rotate_bitmap_quarter_turns(source, 3));
+    EXPECT_EQ(Rotate_bitmap_quarter_turns(source, 4), source);
+}
+
+TEST(image_resample, QuarterTurnsRoundTripAcrossTiles) {
+    BgraBitmap const source = Make_gradient(70, 45);
+    for (int32_t const turns : {1, 2, 3}) {
+        BgraBitmap const rotated = Rotate_bitmap_quarter_turns(source, turns);
+        EXPECT_EQ(Rotate_bitmap_quarter_turns(rotated, 4 - turns), source) << turns;
+    }
+}
+
+TEST(image_resample, MipPyramidBuildsLevelsOnDemandAndPicksTheClosest) {
+    ResampleMipPyramid pyramid;
+    EXPECT_FALSE(pyramid.Has_image());
+    EXPECT_FALSE(pyramid.Resample(4, 4, ResampleFilter::Box, 1).has_value());
+
+    pyramid.Reset(Make_solid(64, 40, 30, 255));
+    EXPECT_EQ(pyramid.Level_count(), 1u);
+    EXPECT_EQ(&pyramid.Level_for(100, 100), &pyramid.Base());
+
+    BgraBitmap const &level = pyramid.Level_for(15, 9);
+    EXPECT_EQ(level.width_px, 16);
+    EXPECT_EQ(level.height_px, 10);
+    EXPECT_EQ(pyramid.Level_count(), 3u);
+    // Prebuilt levels are reused.
+    (void)pyramid.Level_for(20, 12);
+    EXPECT_EQ(pyramid.Level_count(), 3u);
+
+    std::optional<BgraBitmap> const out =
+        pyramid.Resample(15, 9, ResampleFilter::Lanczos3, 2);
+    ASSERT_TRUE(out.has_value());
+    EXPECT_EQ(*out, Make_solid(15, 9, 30, 255));
+
+    pyramid.Reset({});
+    EXPECT_FALSE(pyramid.Has_image());
+}
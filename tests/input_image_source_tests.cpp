@@ -0,0 +1,161 @@
+#include "greenflame_core/bmp.h"
+#include "greenflame_core/input_image_source.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+void Put_le16(std::vector<uint8_t> &bytes, size_t offset, uint16_t value) {
+    bytes[offset] = static_cast<uint8_t>(value & 0xFFu);
+    bytes[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+void Put_le32(std::vector<uint8_t> &bytes, size_t offset, uint32_t value) {
+    Put_le16(bytes, offset, static_cast<uint16_t>(value & 0xFFFFu));
+    Put_le16(bytes, offset + 2, static_cast<uint16_t>(value >> 16));
+}
+
+// 24 bpp BI_RGB with the given row order; pixel (x, y) is {x, y, x + y} as BGR.
+[[nodiscard]] std::vector<uint8_t> Make_bmp24(int32_t width, int32_t height,
+                                              bool top_down) {
+    size_t const stride = (static_cast<size_t>(width) * 3 + 3) & ~size_t{3};
+    std::vector<uint8_t> bytes(54 + stride * static_cast<size_t>(height), 0xEE);
+    bytes[0] = 'B';
+    bytes[1] = 'M';
+    Put_le32(bytes, 2, static_cast<uint32_t>(bytes.size()));
+    Put_le32(bytes, 10, 54);
+    Put_le32(bytes, 14, 40);
+    Put_le32(bytes, 18, static_cast<uint32_t>(width));
+    Put_le32(bytes, 22, static_cast<uint32_t>(top_down ? -height : height));
+    Put_le16(bytes, 26, 1);
+    Put_le16(bytes, 28, 24);
+    Put_le32(bytes, 30, 0);
+    for (int32_t y = 0; y < height; ++y) {
+        size_t const row = static_cast<size_t>(top_down ? y : height - 1 - y);
+        for (int32_t x = 0; x < width; ++x) {
+            size_t const at = 54 + row * stride + static_cast<size_t>(x) * 3;
+            bytes[at] = static_cast<uint8_t>(x);
+            bytes[at + 1] = static_cast<uint8_t>(y);
+            bytes[at + 2] = static_cast<uint8_t>(x + y);
+        }
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(input_image_source, Bmp24_DecodesBothRowOrdersIntoPaddedTarget) {
+    constexpr int32_t kWidth = 3;
+    constexpr int32_t kHeight = 2;
+    constexpr size_t kCanvasRowBytes = 7 * 4;
+    constexpr size_t kPadLeftBytes = 2 * 4;
+    constexpr size_t kPadTop = 1;
+
+    for (bool const top_down : {false, true}) {
+        std::vector<uint8_t> const file = Make_bmp24(kWidth, kHeight, top_down);
+        ASSERT_TRUE(BmpInputImageDecoder::Can_decode(file));
+
+        BmpInputImageDecoder decoder;
+        InputImageHeader header{};
+        std::wstring detail;
+        ASSERT_EQ(decoder.Read_header(file, header, detail),
+                  InputImageDecodeStatus::Success);
+        EXPECT_EQ(header, (InputImageHeader{kWidth, kHeight, ImageSaveFormat::Bmp,
+                                            false}));
+
+        std::vector<uint8_t> canvas(kCanvasRowBytes * 4, 0x11);
+        ImageRowTarget const target{
+            std::span<uint8_t>(canvas).subspan(kPadTop * kCanvasRowBytes +
+                                               kPadLeftBytes),
+            kCanvasRowBytes};
+        ASSERT_EQ(decoder.Decode_rows(file, header, target, detail),
+                  InputImageDecodeStatus::Success);
+
+        for (int32_t y = 0; y < kHeight; ++y) {
+            for (int32_t x = 0; x < kWidth; ++x) {
+                size_t const at = (kPadTop + static_cast<size_t>(y)) * kCanvasRowBytes +
+                                  kPadLeftBytes + static_cast<size_t>(x) * 4;
+                EXPECT_EQ(canvas[at], x);
+                EXPECT_EQ(canvas[at + 1], y);
+                EXPECT_EQ(canvas[at + 2], x + y);
+                EXPECT_EQ(canvas[at + 3], 0xFF);
+            }
+        }
+        // Padding around the image is untouched.
+        EXPECT_EQ(canvas[0], 0x11);
+        EXPECT_EQ(canvas[kPadTop * kCanvasRowBytes + kPadLeftBytes - 1], 0x11);
+        EXPECT_EQ(canvas[kPadTop * kCanvasRowBytes + kPadLeftBytes + kWidth * 4], 0x11);
+        EXPECT_TRUE(Image_rows_are_opaque(target, kWidth, kHeight));
+    }
+}
+
+TEST(input_image_source, Bmp32_IgnoresFourthByteLikeWindows) {
+    // Build_bmp_bytes writes bottom-up 32 bpp BI_RGB.
+    std::vector<uint8_t> const pixels = {1, 2, 3, 0, 4, 5, 6, 7};
+    std::vector<uint8_t> const file = Build_bmp_bytes(pixels, 1, 2, 4);
+    BmpInputImageDecoder decoder;
+    InputImageHeader header{};
+    std::wstring detail;
+    ASSERT_EQ(decoder.Read_header(file, header, detail),
+              InputImageDecodeStatus::Success);
+
+    std::vector<uint8_t> out(8, 0);
+    ASSERT_EQ(decoder.Decode_rows(file, header, ImageRowTarget{out, 4}, detail),
+              InputImageDecodeStatus::Success);
+    EXPECT_EQ(out, (std::vector<uint8_t>{4, 5, 6, 0xFF, 1, 2, 3, 0xFF}));
+}
+
+TEST(input_image_source, Bmp_UnsupportedLayoutsAreLeftToPlatformDecoder) {
+    std::vector<uint8_t> rle = Make_bmp24(2, 2, false);
+    Put_le16(rle, 28, 8);
+    Put_le32(rle, 30, 1);
+    EXPECT_FALSE(BmpInputImageDecoder::Can_decode(rle));
+
+    std::vector<uint8_t> png_like = {0x89, 'P', 'N', 'G', 0, 0, 0, 0};
+    EXPECT_FALSE(BmpInputImageDecoder::Can_decode(png_like));
+
+    BmpInputImageDecoder decoder;
+    InputImageHeader header{};
+    std::wstring detail;
+    EXPECT_EQ(decoder.Read_header(png_like, header, detail),
+              InputImageDecodeStatus::UnsupportedFormat);
+}
+
+TEST(input_image_source, Bmp_RejectsBadDimensionsAndTruncatedPixels) {
+    BmpInputImageDecoder decoder;
+    InputImageHeader header{};
+    std::wstring detail;
+
+    std::vector<uint8_t> zero_width = Make_bmp24(2, 2, false);
+    Put_le32(zero_width, 18, 0);
+    EXPECT_EQ(decoder.Read_header(zero_width, header, detail),
+              InputImageDecodeStatus::Unreadable);
+    EXPECT_EQ(detail, L"invalid image dimensions.");
+
+    std::vector<uint8_t> truncated = Make_bmp24(2, 2, false);
+    truncated.resize(truncated.size() - 3);
+    EXPECT_EQ(decoder.Read_header(truncated, header, detail),
+              InputImageDecodeStatus::Unreadable);
+    EXPECT_EQ(detail, L"pixel data is truncated.");
+
+    std::vector<uint8_t> const file = Make_bmp24(2, 2, false);
+    ASSERT_EQ(decoder.Read_header(file, header, detail),
+              InputImageDecodeStatus::Success);
+    std::vector<uint8_t> small(15, 0);
+    EXPECT_EQ(decoder.Decode_rows(file, header, ImageRowTarget{small, 8}, detail),
+              InputImageDecodeStatus::Failed);
+}
+
+TEST(input_image_source, Image_rows_are_opaque_OnlyScansImagePixels) {
+    std::vector<uint8_t> canvas(2 * 12, 0);
+    ImageRowTarget const target{canvas, 12};
+    for (size_t row = 0; row < 2; ++row) {
+        for (size_t alpha = 3; alpha < 8; alpha += 4) {
+            canvas[row * 12 + alpha] = 0xFF;
+        }
+    }
+    EXPECT_TRUE(Image_rows_are_opaque(target, 2, 2));
+    canvas[12 + 7] = 0xFE;
+    EXPECT_FALSE(Image_rows_are_opaque(target, 2, 2));
+    EXPECT_FALSE(Image_rows_are_opaque(target, 3, 3));
+}
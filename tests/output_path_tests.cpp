@@ -79,3 +79,22 @@ TEST(output_path, Resolve_explicit_output_path_RejectsUnsupportedExtension) {
     EXPECT_NE(resolved.error_message.find(L"unsupported extension"),
               std::wstring::npos);
 }
+
+TEST(output_path, Resolve_explicit_output_path_DashSelectsStdout) {
+    ResolveExplicitPathResult const resolved =
+        Resolve_explicit_output_path(L"-", ImageSaveFormat::Bmp, std::nullopt);
+    EXPECT_TRUE(resolved.ok);
+    EXPECT_EQ(resolved.sink, OutputSinkKind::Stdout);
+    EXPECT_EQ(resolved.path, L"-");
+    EXPECT_EQ(resolved.format, ImageSaveFormat::Bmp);
+
+    std::optional<CliOutputFormat> const jpeg = CliOutputFormat::Jpeg;
+    ResolveExplicitPathResult const formatted =
+        Resolve_explicit_output_path(L"-", ImageSaveFormat::Png, jpeg);
+    EXPECT_TRUE(formatted.ok);
+    EXPECT_EQ(formatted.format, ImageSaveFormat::Jpeg);
+
+    ResolveExplicitPathResult const file = Resolve_explicit_output_path(
+        L"C:\\shots\\-", ImageSaveFormat::Png, std::nullopt);
+    EXPECT_EQ(file.sink, OutputSinkKind::File);
+}
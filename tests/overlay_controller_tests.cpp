@@ -1,3 +1,5 @@
+#include "allocation_tracking.h"
+#include "fake_obfuscate_source_provider.h"
 #include "fake_spell_check_service.h"
 #include "fake_text_layout_engine.h"
 #include "greenflame_core/modification_command.h"
@@ -40,27 +42,6 @@ std::vector<MonitorWithBounds> Triple_with_left_monitor() {
             Make_monitor(1920, 0, 1920, 1080)};
 }
 
-struct FakeObfuscateSourceProvider final : public IObfuscateSourceProvider {
-    [[nodiscard]] std::optional<BgraBitmap> Build_composited_source(
-        RectPx bounds, std::span<const Annotation> /*lower_annotations*/) override {
-        RectPx const normalized_bounds = bounds.Normalized();
-        if (normalized_bounds.Is_empty()) {
-            return std::nullopt;
-        }
-
-        int32_t const width = normalized_bounds.Width();
-        int32_t const height = normalized_bounds.Height();
-        int32_t const row_bytes = width * 4;
-        return BgraBitmap{
-            .width_px = width,
-            .height_px = height,
-            .row_bytes = row_bytes,
-            .premultiplied_bgra = std::vector<uint8_t>(
-                static_cast<size_t>(row_bytes) * static_cast<size_t>(height), 0xCC),
-        };
-    }
-};
-
 class OpaqueTextLayoutEngine final : public ITextLayoutEngine {
   public:
     [[nodiscard]] int32_t Line_ascent(TextAnnotationBaseStyle const &) override {
@@ -2394,3 +2375,115 @@ TEST(overlay_controller,
     EXPECT_EQ(c.Active_obfuscate_preview_indices(), (std::vector<size_t>{1}));
     EXPECT_EQ(Release(c, {240, 240}), OverlayAction::InvalidateFrozenCache);
 }
+
+// ===========================================================================
+// Group L — Allocation budgets (WM_MOUSEMOVE and paint preparation)
+// ===========================================================================
+
+TEST(overlay_controller, L_PointerMove_HoverSelectionAndMoveDragsDoNotAllocate) {
+    auto c = Make_controller();
+    std::vector<RectPx> window_rects;
+    for (int32_t index = 0; index < 100; ++index) {
+        window_rects.push_back(RectPx::From_ltrb(index * 10, index * 5,
+                                                 index * 10 + 300, index * 5 + 200));
+    }
+    SnapEdges const snap_edges = Make_snap_edges(c, window_rects);
+    c.Refresh_snap_edges(snap_edges, 0, 0);
+
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 0; step < 50; ++step) {
+            Move(c, {100 + step, 100 + step});
+        }
+    });
+    std::ignore = c.On_primary_press(No_mods(), {100, 100}, {100, 100}, std::nullopt,
+                                     std::nullopt, std::nullopt, {}, snap_edges, 0, 0);
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 0; step < 50; ++step) {
+            Move(c, {300 + step * 3, 300 + step * 2});
+        }
+    });
+    Release(c, {600, 500});
+    ASSERT_FALSE(c.State().final_selection.Is_empty());
+
+    // Hover inside the selection and across its resize handles, then move it.
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 0; step < 50; ++step) {
+            Move(c, {200 + step, 200 + step});
+            Move(c, {600, 480 + step});
+        }
+    });
+    std::ignore = c.On_primary_press(No_mods(), {300, 300}, {300, 300}, std::nullopt,
+                                     std::nullopt, std::nullopt, {}, snap_edges, 0, 0);
+    ASSERT_TRUE(c.State().move_dragging);
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 0; step < 50; ++step) {
+            Move(c, {300 + step, 300 + step});
+        }
+    });
+}
+
+TEST(overlay_controller, L_PointerMove_ShapeDrawAndAnnotationMoveDoNotAllocate) {
+    auto c = Make_controller();
+    Press(c, {100, 100});
+    Release(c, {800, 700});
+    ASSERT_EQ(c.On_select_annotation_tool(AnnotationToolId::Rectangle),
+              OverlayAction::Repaint);
+
+    Press(c, {400, 400});
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 0; step < 50; ++step) {
+            Move(c, {420 + step, 420 + step});
+        }
+    });
+    ASSERT_EQ(Release(c, {470, 470}), OverlayAction::InvalidateFrozenCache);
+
+    ASSERT_EQ(c.On_select_annotation_tool(AnnotationToolId::Rectangle),
+              OverlayAction::Repaint);
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 0; step < 50; ++step) {
+            Move(c, {400 + step, 430});
+        }
+    });
+    Press(c, {400, 430});
+    ASSERT_TRUE(c.Is_annotation_dragging());
+    EXPECT_NO_ALLOCATIONS({
+        for (int32_t step = 0; step < 50; ++step) {
+            Move(c, {400 + step, 430 + step});
+        }
+    });
+    EXPECT_EQ(Release(c, {449, 479}), OverlayAction::InvalidateFrozenCache);
+}
+
+TEST(overlay_controller, L_PaintInputs_FreehandDragAllocatesOnlyForPointGrowth) {
+    auto c = Make_controller();
+    Press(c, {100, 100});
+    Release(c, {800, 700});
+    ASSERT_EQ(c.On_select_annotation_tool(AnnotationToolId::Freehand),
+              OverlayAction::Repaint);
+    Press(c, {200, 200});
+
+    // The draft point buffer grows geometrically; nothing else may allocate per
+    // move. The paint path reads the raw draft points, never Draft_annotation().
+    EXPECT_ALLOCATIONS_WITHIN(12, 64 * 1024, {
+        for (int32_t step = 1; step <= 1000; ++step) {
+            Move(c, {200 + step % 300, 200 + step / 4});
+        }
+    });
+    std::span<const PointPx> points = {};
+    std::optional<StrokeStyle> style = std::nullopt;
+    std::optional<RectPx> selected_bounds = std::nullopt;
+    bool has_obfuscate_preview = true;
+    std::optional<AnnotationEditTarget> edit_target = std::nullopt;
+    EXPECT_NO_ALLOCATIONS({
+        points = c.Draft_freehand_points();
+        style = c.Draft_freehand_style();
+        selected_bounds = c.Selected_annotation_bounds();
+        has_obfuscate_preview = !c.Active_obfuscate_preview_indices().empty();
+        edit_target = c.Annotation_edit_target_at({200, 200});
+    });
+    EXPECT_EQ(points.size(), 1001u);
+    EXPECT_TRUE(style.has_value());
+    EXPECT_FALSE(selected_bounds.has_value());
+    EXPECT_FALSE(has_obfuscate_preview);
+    EXPECT_FALSE(edit_target.has_value());
+}
@@ -0,0 +1,215 @@
+#include "fake_text_layout_engine.h"
+#include "greenflame_core/overlay_input_trace.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+[[nodiscard]] OverlayInputEvent Pointer_event(OverlayInputEventKind kind, PointPx point,
+                                              bool primary_down) {
+    return OverlayInputEvent{.kind = kind,
+                             .mods = {.primary_down = primary_down},
+                             .cursor_client = point,
+                             .cursor_screen = point};
+}
+
+// A selection drag, a rectangle tool drag and an undo.
+[[nodiscard]] OverlayInputTrace Make_session_trace() {
+    OverlayInputTrace trace = {};
+    trace.monitors.push_back(
+        MonitorWithBounds{RectPx::From_ltrb(0, 0, 1920, 1080), MonitorInfo{}});
+    trace.events.push_back({.kind = OverlayInputEventKind::SnapEdgesRefreshed,
+                            .snap_edges = SnapEdges{{{0, 0, 1080}}, {{0, 0, 1920}}}});
+    trace.events.push_back(
+        Pointer_event(OverlayInputEventKind::PrimaryPress, {100, 100}, true));
+    trace.events.push_back(
+        Pointer_event(OverlayInputEventKind::PointerMove, {600, 500}, true));
+    trace.events.push_back(
+        Pointer_event(OverlayInputEventKind::PrimaryRelease, {600, 500}, false));
+    trace.events.push_back(
+        {.kind = OverlayInputEventKind::AnnotationToolHotkey, .hotkey = L'R'});
+    for (int32_t shape = 0; shape < 2; ++shape) {
+        PointPx const start{200 + shape * 50, 200};
+        PointPx const end{300 + shape * 50, 300};
+        trace.events.push_back(
+            Pointer_event(OverlayInputEventKind::PrimaryPress, start, true));
+        trace.events.push_back(
+            Pointer_event(OverlayInputEventKind::PointerMove, end, true));
+        trace.events.push_back(
+            Pointer_event(OverlayInputEventKind::PrimaryRelease, end, false));
+    }
+    trace.events.push_back({.kind = OverlayInputEventKind::Undo});
+    return trace;
+}
+
+} // namespace
+
+TEST(overlay_input_trace, Encode_RoundTripsEveryField) {
+    OverlayInputTrace trace = Make_session_trace();
+    trace.monitors.push_back(MonitorWithBounds{
+        RectPx::From_ltrb(-1080, -200, 0, 1720),
+        MonitorInfo{MonitorDpiScale{150}, MonitorOrientation::Portrait}});
+    trace.events.push_back(OverlayInputEvent{
+        .kind = OverlayInputEventKind::ModifierChanged,
+        .time_ns = 123'456'789,
+        .mods = {.shift = true, .ctrl = true, .alt = true},
+        .cursor_client = {-5, 7},
+        .cursor_screen = {-1085, -193},
+        .window = reinterpret_cast<HWND>(static_cast<uintptr_t>(0x1234ABCD)),
+        .monitor_index = 1,
+        .window_rect_screen = RectPx::From_ltrb(-900, -100, -10, 400),
+        .virtual_desktop_bounds = RectPx::From_ltrb(-1080, -200, 1920, 1720),
+        .origin_x = -1080,
+        .origin_y = -200,
+        .window_full_capture_available = true,
+        .hotkey = L'E',
+        .tool = AnnotationToolId::Bubble});
+    trace.events.push_back({.kind = OverlayInputEventKind::SelectAnnotationTool,
+                            .time_ns = 123'000'000,
+                            .tool = AnnotationToolId::Obfuscate});
+
+    std::vector<uint8_t> const bytes = Encode_overlay_input_trace(trace);
+    ASSERT_TRUE(std::equal(kOverlayInputTraceMagic.begin(),
+                           kOverlayInputTraceMagic.end(), bytes.begin()));
+    OverlayInputTrace decoded = {};
+    ASSERT_TRUE(Try_decode_overlay_input_trace(bytes, decoded));
+    ASSERT_EQ(decoded.monitors.size(), 2u);
+    EXPECT_EQ(decoded.monitors[1].bounds, trace.monitors[1].bounds);
+    EXPECT_EQ(decoded.monitors[1].info.dpi_scale.percent, 150);
+    EXPECT_EQ(decoded.monitors[1].info.orientation, MonitorOrientation::Portrait);
+    ASSERT_EQ(decoded.events.size(), trace.events.size());
+
+    for (size_t index = 0; index < trace.events.size(); ++index) {
+        OverlayInputEvent const &expected = trace.events[index];
+        OverlayInputEvent const &actual = decoded.events[index];
+        EXPECT_EQ(actual.kind, expected.kind) << index;
+        EXPECT_EQ(actual.time_ns, expected.time_ns) << index;
+        EXPECT_EQ(actual.mods.shift, expected.mods.shift) << index;
+        EXPECT_EQ(actual.mods.ctrl, expected.mods.ctrl) << index;
+        EXPECT_EQ(actual.mods.alt, expected.mods.alt) << index;
+        EXPECT_EQ(actual.mods.primary_down, expected.mods.primary_down) << index;
+        EXPECT_EQ(actual.cursor_client, expected.cursor_client) << index;
+        EXPECT_EQ(actual.cursor_screen, expected.cursor_screen) << index;
+        EXPECT_EQ(actual.window, expected.window) << index;
+        EXPECT_EQ(actual.monitor_index, expected.monitor_index) << index;
+        EXPECT_EQ(actual.window_rect_screen, expected.window_rect_screen) << index;
+        EXPECT_EQ(actual.virtual_desktop_bounds, expected.virtual_desktop_bounds)
+            << index;
+        EXPECT_EQ(actual.origin_x, expected.origin_x) << index;
+        EXPECT_EQ(actual.origin_y, expected.origin_y) << index;
+        EXPECT_EQ(actual.window_full_capture_available,
+                  expected.window_full_capture_available)
+            << index;
+        EXPECT_EQ(actual.hotkey, expected.hotkey) << index;
+        EXPECT_EQ(actual.tool, expected.tool) << index;
+        ASSERT_EQ(actual.snap_edges.has_value(), expected.snap_edges.has_value())
+            << index;
+        if (expected.snap_edges.has_value()) {
+            EXPECT_EQ(actual.snap_edges->vertical, expected.snap_edges->vertical);
+            EXPECT_EQ(actual.snap_edges->horizontal, expected.snap_edges->horizontal);
+        }
+    }
+}
+
+TEST(overlay_input_trace, Decode_RejectsTruncatedOrCorruptInput) {
+    std::vector<uint8_t> const bytes = Encode_overlay_input_trace(Make_session_trace());
+    OverlayInputTrace decoded = {};
+    for (size_t size = 0; size < bytes.size(); ++size) {
+        EXPECT_FALSE(Try_decode_overlay_input_trace(
+            std::span<const uint8_t>(bytes).first(size), decoded))
+            << "size=" << size;
+        EXPECT_TRUE(decoded.events.empty());
+    }
+
+    std::vector<uint8_t> trailing = bytes;
+    trailing.push_back(0);
+    EXPECT_FALSE(Try_decode_overlay_input_trace(trailing, decoded));
+    std::vector<uint8_t> wrong_version = bytes;
+    wrong_version[4] = 0x7F;
+    EXPECT_FALSE(Try_decode_overlay_input_trace(wrong_version, decoded));
+    for (size_t at = 0; at < bytes.size(); ++at) {
+        std::vector<uint8_t> corrupt = bytes;
+        corrupt[at] ^= 0xFFu;
+        (void)Try_decode_overlay_input_trace(corrupt, decoded);
+    }
+}
+
+TEST(overlay_input_trace, Recorder_StampsTimesAndStoresRepeatedSnapEdgesOnce) {
+    OverlayInputRecorder recorder;
+    EXPECT_FALSE(recorder.Is_recording());
+    recorder.Record({.kind = OverlayInputEventKind::Cancel});
+
+    std::array<MonitorWithBounds, 1> const monitors = {
+        {{RectPx::From_ltrb(0, 0, 800, 600), MonitorInfo{}}}};
+    recorder.Begin_session(monitors);
+    ASSERT_TRUE(recorder.Is_recording());
+    SnapEdges const edges{{{10, 0, 600}}, {{20, 0, 800}}};
+    SnapEdges const other_edges{{{30, 0, 600}}, {}};
+    recorder.Record({.kind = OverlayInputEventKind::SnapEdgesRefreshed,
+                     .snap_edges = edges});
+    recorder.Record({.kind = OverlayInputEventKind::PrimaryPress, .snap_edges = edges});
+    recorder.Record(
+        {.kind = OverlayInputEventKind::PrimaryPress, .snap_edges = other_edges});
+    recorder.Record(
+        {.kind = OverlayInputEventKind::PrimaryPress, .snap_edges = other_edges});
+
+    OverlayInputTrace const trace = recorder.Take_trace();
+    EXPECT_FALSE(recorder.Is_recording());
+    ASSERT_EQ(trace.monitors.size(), 1u);
+    ASSERT_EQ(trace.events.size(), 4u);
+    EXPECT_TRUE(trace.events[0].snap_edges.has_value());
+    EXPECT_FALSE(trace.events[1].snap_edges.has_value());
+    EXPECT_TRUE(trace.events[2].snap_edges.has_value());
+    EXPECT_FALSE(trace.events[3].snap_edges.has_value());
+    for (size_t index = 1; index < trace.events.size(); ++index) {
+        EXPECT_GE(trace.events[index].time_ns, trace.events[index - 1].time_ns);
+    }
+}
+
+TEST(overlay_input_trace, Replay_MatchesDirectControllerCalls) {
+    OverlayInputTrace const trace = Make_session_trace();
+    FakeTextLayoutEngine text_layout_engine;
+
+    OverlayController replayed;
+    replayed.Set_text_layout_engine(&text_layout_engine);
+    uint64_t (*const no_allocations)() = [] { return uint64_t{0}; };
+    OverlayReplayReport const report = Replay_overlay_input_trace(
+        replayed, trace, {.allocation_count = no_allocations});
+
+    OverlayController direct;
+    direct.Set_text_layout_engine(&text_layout_engine);
+    direct.Reset_for_session(trace.monitors);
+    SnapEdges snap_edges = {};
+    for (OverlayInputEvent const &event : trace.events) {
+        (void)Apply_overlay_input_event(direct, event, snap_edges);
+    }
+
+    EXPECT_EQ(replayed.State().final_selection, RectPx::From_ltrb(100, 100, 600, 500));
+    EXPECT_EQ(replayed.State().final_selection, direct.State().final_selection);
+    // Two rectangles drawn, one undone.
+    EXPECT_EQ(replayed.Annotations().size(), 1u);
+    EXPECT_EQ(direct.Annotations().size(), 1u);
+    EXPECT_EQ(report.all.count, trace.events.size());
+    EXPECT_EQ(report.by_kind[static_cast<size_t>(OverlayInputEventKind::PrimaryPress)]
+                  .count,
+              3u);
+    EXPECT_EQ(report.all.allocations, 0u);
+    EXPECT_GT(report.repaint_actions, 0u);
+}
+
+TEST(overlay_input_trace, SummarizeLatency_UsesNearestRankPercentiles) {
+    std::vector<int64_t> samples;
+    for (int64_t value = 100; value >= 1; --value) {
+        samples.push_back(value * 10);
+    }
+    OverlayReplayLatency const latency = Summarize_replay_latency(samples);
+    EXPECT_EQ(latency.count, 100u);
+    EXPECT_EQ(latency.p50_ns, 500);
+    EXPECT_EQ(latency.p90_ns, 900);
+    EXPECT_EQ(latency.p99_ns, 990);
+    EXPECT_EQ(latency.max_ns, 1000);
+
+    std::array<int64_t, 1> single = {{42}};
+    EXPECT_EQ(Summarize_replay_latency(single).p50_ns, 42);
+    EXPECT_EQ(Summarize_replay_latency({}).count, 0u);
+}
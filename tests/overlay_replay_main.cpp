@@ -0,0 +1,182 @@
+// Headless replay of recorded overlay sessions (.gfit) for performance work.
+//
+//   greenflame_overlay_replay [--iterations N] [--synthetic] [trace.gfit ...]
+//
+// Each trace is replayed N times into a fresh OverlayController wired to fake
+// text layout and obfuscate sources. Per-event latency percentiles and heap
+// allocation counts are printed per event kind.
+
+#include "allocation_tracking.h"
+#include "fake_obfuscate_source_provider.h"
+#include "fake_text_layout_engine.h"
+#include "greenflame_core/overlay_input_trace.h"
+
+namespace {
+
+using namespace greenflame::core;
+
+constexpr int kDefaultIterations = 5;
+
+struct ReplayInput final {
+    std::string name = {};
+    OverlayInputTrace trace = {};
+};
+
+[[nodiscard]] bool Read_trace_file(char const *path, OverlayInputTrace &trace) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> const bytes((std::istreambuf_iterator<char>(file)),
+                                     std::istreambuf_iterator<char>());
+    return Try_decode_overlay_input_trace(bytes, trace);
+}
+
+// Selection, then long brush strokes, shapes, an obfuscation and undo/redo over
+// a desktop with many snap edges: a heavy but ordinary session.
+[[nodiscard]] OverlayInputTrace Build_synthetic_trace() {
+    OverlayInputTrace trace = {};
+    RectPx const desktop = RectPx::From_ltrb(0, 0, 2560, 1440);
+    trace.monitors.push_back(MonitorWithBounds{desktop, MonitorInfo{}});
+
+    SnapEdges edges = {};
+    for (int32_t index = 0; index < 400; ++index) {
+        int32_t const offset = (index * 37) % 2400;
+        edges.vertical.push_back({offset + 40, offset % 1200, offset % 1200 + 240});
+        edges.horizontal.push_back({offset % 1400, offset, offset + 320});
+    }
+    trace.events.push_back({.kind = OverlayInputEventKind::SnapEdgesRefreshed,
+                            .snap_edges = edges});
+
+    auto const add = [&](OverlayInputEventKind kind, PointPx point, bool down) {
+        OverlayInputEvent event = {.kind = kind,
+                                   .mods = {.primary_down = down},
+                                   .cursor_client = point,
+                                   .cursor_screen = point,
+                                   .virtual_desktop_bounds = desktop};
+        trace.events.push_back(std::move(event));
+    };
+    auto const drag = [&](PointPx from, int32_t steps, auto const &position) {
+        add(OverlayInputEventKind::PrimaryPress, from, true);
+        for (int32_t step = 1; step <= steps; ++step) {
+            add(OverlayInputEventKind::PointerMove, position(step), true);
+        }
+        add(OverlayInputEventKind::PrimaryRelease, position(steps), false);
+    };
+    auto const hotkey = [&](wchar_t key) {
+        trace.events.push_back(
+            {.kind = OverlayInputEventKind::AnnotationToolHotkey, .hotkey = key});
+    };
+
+    for (int32_t step = 0; step < 200; ++step) {
+        add(OverlayInputEventKind::PointerMove, {300 + step * 3, 200 + step}, false);
+    }
+    drag({200, 150}, 400, [](int32_t step) {
+        return PointPx{200 + step * 5, 150 + step * 3};
+    });
+
+    hotkey(L'B');
+    for (int32_t stroke = 0; stroke < 6; ++stroke) {
+        PointPx const center{600 + stroke * 180, 700};
+        drag(center, 1500, [center](int32_t step) {
+            double const angle = step * 0.05;
+            double const radius = 20.0 + step * 0.1;
+            return PointPx{center.x + static_cast<int32_t>(radius * std::cos(angle)),
+                           center.y + static_cast<int32_t>(radius * std::sin(angle))};
+        });
+    }
+    hotkey(L'R');
+    for (int32_t shape = 0; shape < 20; ++shape) {
+        PointPx const start{300 + shape * 40, 300 + shape * 20};
+        drag(start, 60, [start](int32_t step) {
+            return PointPx{start.x + step * 4, start.y + step * 2};
+        });
+    }
+    hotkey(L'O');
+    drag({900, 400}, 200, [](int32_t step) {
+        return PointPx{900 + step * 2, 400 + step};
+    });
+    for (int32_t index = 0; index < 5; ++index) {
+        trace.events.push_back({.kind = OverlayInputEventKind::Undo});
+    }
+    for (int32_t index = 0; index < 3; ++index) {
+        trace.events.push_back({.kind = OverlayInputEventKind::Redo});
+    }
+    return trace;
+}
+
+void Print_latency_row(std::string_view name, OverlayReplayLatency const &latency) {
+    auto const microseconds = [](int64_t ns) {
+        return static_cast<double>(ns) / 1000.0;
+    };
+    std::printf("  %-28.*s %8zu %10.1f %10.1f %10.1f %10.1f %10llu %8llu\n",
+                static_cast<int>(name.size()), name.data(), latency.count,
+                microseconds(latency.p50_ns), microseconds(latency.p90_ns),
+                microseconds(latency.p99_ns), microseconds(latency.max_ns),
+                static_cast<unsigned long long>(latency.allocations),
+                static_cast<unsigned long long>(latency.max_allocations));
+}
+
+void Print_report(std::string_view name, int iteration,
+                  OverlayReplayReport const &report) {
+    std::printf("%.*s (iteration %d)\n", static_cast<int>(name.size()), name.data(),
+                iteration);
+    std::printf("  %-28s %8s %10s %10s %10s %10s %10s %8s\n", "event", "count",
+                "p50 us", "p90 us", "p99 us", "max us", "allocs", "max/ev");
+    for (size_t kind = 0; kind < report.by_kind.size(); ++kind) {
+        if (report.by_kind[kind].count != 0) {
+            Print_latency_row(
+                Overlay_input_event_kind_name(static_cast<OverlayInputEventKind>(kind)),
+                report.by_kind[kind]);
+        }
+    }
+    Print_latency_row("all", report.all);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int iterations = kDefaultIterations;
+    std::vector<ReplayInput> inputs;
+    for (int index = 1; index < argc; ++index) {
+        std::string_view const arg = argv[index];
+        if (arg == "--iterations" && index + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++index]));
+        } else if (arg == "--synthetic") {
+            inputs.push_back({"synthetic", Build_synthetic_trace()});
+        } else if (!arg.empty() && arg.front() == '-') {
+            std::fprintf(stderr,
+                         "usage: greenflame_overlay_replay [--iterations N] "
+                         "[--synthetic] [trace.gfit ...]\n");
+            return 1;
+        } else {
+            ReplayInput input = {std::string(arg), {}};
+            if (!Read_trace_file(argv[index], input.trace)) {
+                std::fprintf(stderr, "error: cannot read overlay input trace: %s\n",
+                             argv[index]);
+                return 1;
+            }
+            inputs.push_back(std::move(input));
+        }
+    }
+    if (inputs.empty()) {
+        inputs.push_back({"synthetic", Build_synthetic_trace()});
+    }
+
+    for (ReplayInput const &input : inputs) {
+        for (int iteration = 1; iteration <= iterations; ++iteration) {
+            FakeTextLayoutEngine text_layout_engine;
+            FakeObfuscateSourceProvider obfuscate_source_provider;
+            OverlayController controller;
+            controller.Set_text_layout_engine(&text_layout_engine);
+            controller.Set_obfuscate_source_provider(&obfuscate_source_provider);
+            OverlayReplayReport const report = Replay_overlay_input_trace(
+                controller, input.trace,
+                {.allocation_count = &greenflame::test::Process_allocation_count});
+            if (iteration == 1 || iteration == iterations) {
+                Print_report(input.name, iteration, report);
+            }
+        }
+    }
+    return 0;
+}
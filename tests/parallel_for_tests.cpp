@@ -0,0 +1,85 @@
+#include "greenflame_core/parallel_for.h"
+
+using namespace greenflame::core;
+
+TEST(parallel_for, RunsEveryIndexOnce) {
+    for (size_t const workers : {size_t{0}, size_t{1}, size_t{3}, size_t{64}}) {
+        std::vector<std::atomic<int>> hits(200);
+        EXPECT_TRUE(Parallel_for(hits.size(), {.max_workers = workers},
+                                 [&](size_t index) { hits[index].fetch_add(1); }));
+        for (size_t index = 0; index < hits.size(); ++index) {
+            EXPECT_EQ(hits[index].load(), 1) << workers << " " << index;
+        }
+    }
+    EXPECT_TRUE(Parallel_for(0, {.max_workers = 4}, [](size_t) { FAIL(); }));
+}
+
+TEST(parallel_for, CallerFirstRunsOnceBeforeTheCallerJoins) {
+    std::thread::id const caller = std::this_thread::get_id();
+    std::atomic<int> indices = 0;
+    int first_calls = 0;
+    EXPECT_TRUE(Parallel_for(
+        50, {.max_workers = 4}, [&](size_t) { indices.fetch_add(1); },
+        [&] {
+            EXPECT_EQ(std::this_thread::get_id(), caller);
+            ++first_calls;
+        }));
+    EXPECT_EQ(first_calls, 1);
+    EXPECT_EQ(indices.load(), 50);
+}
+
+TEST(parallel_for, FirstExceptionIsRethrownAfterTheLoopWindsDown) {
+    std::atomic<int> running = 0;
+    std::atomic<int> after_return = 0;
+    std::atomic<bool> returned = false;
+    try {
+        (void)Parallel_for(1000, {.max_workers = 4}, [&](size_t index) {
+            running.fetch_add(1);
+            if (returned.load()) {
+                after_return.fetch_add(1);
+            }
+            running.fetch_sub(1);
+            if (index == 3) {
+                throw std::runtime_error("tile");
+            }
+        });
+        ADD_FAILURE() << "no exception";
+    } catch (std::runtime_error const &error) {
+        EXPECT_STREQ(error.what(), "tile");
+    }
+    returned.store(true);
+    EXPECT_EQ(running.load(), 0);
+    EXPECT_EQ(after_return.load(), 0);
+
+    EXPECT_THROW(
+        (void)Parallel_for(10, {.max_workers = 4}, [](size_t) {},
+                           [] { throw std::runtime_error("sink"); }),
+        std::runtime_error);
+}
+
+TEST(parallel_for, CancelSkipsIndicesNotYetStarted) {
+    std::atomic<bool> cancel = false;
+    std::atomic<size_t> ran = 0;
+    EXPECT_FALSE(Parallel_for(1000, {.max_workers = 4, .cancel = &cancel},
+                              [&](size_t index) {
+                                  ran.fetch_add(1);
+                                  if (index == 10) {
+                                      cancel.store(true);
+                                  }
+                              }));
+    EXPECT_LT(ran.load(), 1000u);
+
+    std::atomic<bool> const already = true;
+    EXPECT_FALSE(Parallel_for(5, {.max_workers = 1, .cancel = &already},
+                              [](size_t) { FAIL(); }));
+}
+
+TEST(parallel_for, NestedLoopsFinishOnTheSharedPool) {
+    size_t const workers = std::max<size_t>(Default_parallel_workers(), 4);
+    std::atomic<int> inner = 0;
+    EXPECT_TRUE(Parallel_for(workers * 2, {.max_workers = workers}, [&](size_t) {
+        EXPECT_TRUE(Parallel_for(16, {.max_workers = workers},
+                                 [&](size_t) { inner.fetch_add(1); }));
+    }));
+    EXPECT_EQ(inner.load(), static_cast<int>(workers * 2 * 16));
+}
@@ -1,3 +1,4 @@
+#include "allocation_tracking.h"
 #include "greenflame_core/pixel_ops.h"
 #include "greenflame_core/rect_px.h"
 
@@ -304,3 +305,22 @@ TEST(pixel_ops, PremultipliedLayerComposition_PreservesLayerOrder) {
     EXPECT_NE(pixels[0], reverse_expected_blue);
     EXPECT_NE(pixels[2], reverse_expected_red);
 }
+
+TEST(pixel_ops, BlendAndDimPasses_DoNotAllocate) {
+    int const width = 64;
+    int const height = 32;
+    int const row_bytes = width * kBytesPerPixel;
+    std::vector<uint8_t> pixels(static_cast<size_t>(row_bytes) * height, 200);
+    std::vector<uint8_t> const layer(static_cast<size_t>(16 * kBytesPerPixel) * 8, 128);
+    EXPECT_NO_ALLOCATIONS({
+        Dim_pixels_outside_rect(pixels, width, height, row_bytes,
+                                RectPx::From_ltrb(8, 8, 40, 24));
+        Blend_rect_onto_pixels(pixels, width, height, row_bytes,
+                               RectPx::From_ltrb(0, 0, 20, 20), RGB(10, 20, 30), 96);
+        Blend_premultiplied_bitmap_onto_opaque_pixels(
+            pixels, width, height, row_bytes, layer, 16, 8, 16 * kBytesPerPixel,
+            RectPx::From_ltrb(30, 10, 46, 18));
+    });
+    EXPECT_NE(pixels[Pixel_offset(35, 12, row_bytes)], 200);
+}
+
@@ -164,6 +164,61 @@ TEST(save_image_policy, Find_next_num_for_pattern_FindsGap) {
     EXPECT_EQ(Find_next_num_for_pattern(L"shot_${num}", ctx, files), 2);
 }
 
+// --- SaveDirectoryIndex ---
+
+TEST(save_image_policy, SaveDirectoryIndex_TracksSavesWithoutRelisting) {
+    FilenamePatternContext ctx{};
+    ctx.timestamp = {1, 1, 2026, 0, 0, 0};
+    std::vector<std::wstring> const files = {L"shot_000001.png", L"Shot_000002.JPEG",
+                                             L"shot_000004.bmp", L"other.png"};
+    SaveDirectoryIndex index;
+    EXPECT_FALSE(index.Is_loaded_for(L"C:\\shots"));
+    index.Load(L"C:\\Shots\\", files);
+    EXPECT_TRUE(index.Is_loaded_for(L"c:\\shots"));
+    EXPECT_FALSE(index.Is_loaded_for(L"C:\\other"));
+
+    EXPECT_EQ(index.Next_num(L"shot_${num}", ctx), 3u);
+    // Unsaved answers are not consumed.
+    EXPECT_EQ(index.Next_num(L"shot_${num}", ctx), 3u);
+    index.Add_saved_path(L"C:\\shots\\shot_000003.png");
+    EXPECT_EQ(index.Next_num(L"shot_${num}", ctx), 5u);
+    // Saves elsewhere are ignored.
+    index.Add_saved_path(L"D:\\shot_000005.png");
+    EXPECT_EQ(index.Next_num(L"shot_${num}", ctx), 5u);
+
+    // Every other variable is part of the stem, so each stem counts on its own.
+    EXPECT_EQ(index.Next_num(L"${YYYY}_${num}", ctx), 1u);
+    index.Add_filename(L"2026_000001.png");
+    EXPECT_EQ(index.Next_num(L"${YYYY}_${num}", ctx), 2u);
+    ctx.timestamp.year = 2027;
+    EXPECT_EQ(index.Next_num(L"${YYYY}_${num}", ctx), 1u);
+    EXPECT_EQ(index.Next_num(L"${num}-${num}", ctx), 1u);
+    EXPECT_EQ(index.Next_num(L"shot", ctx), 1u);
+
+    index.Clear();
+    EXPECT_FALSE(index.Is_loaded_for(L"C:\\shots"));
+}
+
+TEST(save_image_policy, SaveDirectoryIndex_MatchesFindNextNumOnLargeDirectory) {
+    FilenamePatternContext ctx{};
+    ctx.timestamp = {1, 1, 2026, 0, 0, 0};
+    std::vector<std::wstring> files = {};
+    for (unsigned num = 1; num <= 50000; ++num) {
+        if (num != 40000) {
+            files.push_back(Expand_filename_pattern(
+                                L"shot_${num}", {.incrementing_number = num}) +
+                            L".png");
+        }
+    }
+    EXPECT_EQ(Find_next_num_for_pattern(L"shot_${num}", ctx, files), 40000u);
+
+    SaveDirectoryIndex index;
+    index.Load(L"C:\\shots", files);
+    EXPECT_EQ(index.Next_num(L"shot_${num}", ctx), 40000u);
+    index.Add_filename(L"shot_040000.png");
+    EXPECT_EQ(index.Next_num(L"shot_${num}", ctx), 50001u);
+}
+
 // --- Build_default_save_name (with default patterns) ---
 
 TEST(save_image_policy, Build_default_save_name_Region) {
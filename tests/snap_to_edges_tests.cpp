@@ -1,3 +1,4 @@
+#include "allocation_tracking.h"
 #include "greenflame_core/rect_px.h"
 #include "greenflame_core/snap_edge_builder.h"
 #include "greenflame_core/snap_to_edges.h"
@@ -309,3 +310,19 @@ TEST(snap_to_edges, Snap_moved_rect_IgnoresSegmentOutsideSpan) {
     RectPx out = Snap_moved_rect_to_edges(rect, vertical, horizontal, kThreshold);
     EXPECT_EQ(out, rect);
 }
+
+TEST(snap_to_edges, Snap_rect_to_edges_DoesNotAllocate) {
+    std::vector<SnapEdgeSegmentPx> vertical;
+    std::vector<SnapEdgeSegmentPx> horizontal;
+    for (int32_t line = 0; line < 2000; line += 7) {
+        vertical.push_back(Seg(line, 0, 1000));
+        horizontal.push_back(Seg(line, 0, 1000));
+    }
+    RectPx out = {};
+    EXPECT_NO_ALLOCATIONS({
+        out = Snap_rect_to_edges(RectPx::From_ltrb(103, 52, 498, 302), vertical,
+                                 horizontal, kThreshold);
+    });
+    EXPECT_EQ(out.left, 105);
+    EXPECT_EQ(out.top, 49);
+}
@@ -1,5 +1,6 @@
 #include "fake_spell_check_service.h"
 #include "fake_text_layout_engine.h"
+#include "greenflame_core/incremental_spell_checker.h"
 #include "greenflame_core/text_edit_controller.h"
 
 using namespace greenflame::core;
@@ -80,3 +81,173 @@ TEST(spell_check, ServiceReturnsNoErrors_ViewHasNoErrors) {
     TextDraftView const view = controller.Build_view();
     EXPECT_TRUE(view.spell_errors.empty());
 }
+
+TEST(spell_check, NavigationDoesNotRecheckText) {
+    FakeTextLayoutEngine engine;
+    FakeSpellCheckService spell_service;
+
+    TextEditController controller({100, 200}, Default_style(), &engine, &spell_service);
+    controller.On_text_input(L"hello world");
+    size_t const calls_after_typing = spell_service.Call_count();
+
+    controller.On_navigation(TextNavigationAction::Left, false);
+    controller.On_navigation(TextNavigationAction::WordLeft, true);
+    controller.On_select_all();
+    controller.Toggle_insert_mode();
+
+    EXPECT_EQ(spell_service.Call_count(), calls_after_typing);
+}
+
+TEST(spell_check, TypingInOneParagraphChecksOnlyThatParagraph) {
+    FakeTextLayoutEngine engine;
+    FakeSpellCheckService spell_service;
+    spell_service.misspelled_words = {L"wrold"};
+
+    std::vector<TextRun> initial_runs = {TextRun{L"first line\nhello wrold\nlast", {}}};
+    TextEditController controller({100, 200}, Default_style(), std::move(initial_runs),
+                                  &engine, &spell_service);
+    ASSERT_EQ(spell_service.Call_count(), 3u);
+
+    controller.On_navigation(TextNavigationAction::DocEnd, false);
+    controller.On_text_input(L"!");
+
+    ASSERT_EQ(spell_service.Call_count(), 4u);
+    EXPECT_EQ(spell_service.checked_texts.back(), L"last!");
+    std::vector<SpellError> const expected = {SpellError{17, 5}};
+    EXPECT_EQ(controller.Build_view().spell_errors, expected);
+}
+
+TEST(incremental_spell_checker, NullService_ReportsNothing) {
+    IncrementalSpellChecker checker(nullptr);
+    EXPECT_TRUE(checker.Update(L"helo wrold").empty());
+}
+
+TEST(incremental_spell_checker, ErrorsAreOffsetByParagraphStart) {
+    FakeSpellCheckService service;
+    service.misspelled_words = {L"helo", L"wrold"};
+    IncrementalSpellChecker checker(&service);
+
+    std::span<const SpellError> const errors = checker.Update(L"ok\nhelo there\nwrold");
+
+    std::vector<SpellError> const expected = {SpellError{3, 4}, SpellError{14, 5}};
+    EXPECT_EQ(std::vector<SpellError>(errors.begin(), errors.end()), expected);
+    EXPECT_EQ(service.Call_count(), 3u);
+}
+
+TEST(incremental_spell_checker, EditShiftsLaterParagraphsWithoutRechecking) {
+    FakeSpellCheckService service;
+    service.misspelled_words = {L"wrold"};
+    IncrementalSpellChecker checker(&service);
+    (void)checker.Update(L"ok\nwrold\nwrold");
+    service.checked_texts.clear();
+
+    std::span<const SpellError> const errors = checker.Update(L"okay\nwrold\nwrold");
+
+    ASSERT_EQ(service.Call_count(), 1u);
+    EXPECT_EQ(service.checked_texts[0], L"okay");
+    std::vector<SpellError> const expected = {SpellError{5, 5}, SpellError{11, 5}};
+    EXPECT_EQ(std::vector<SpellError>(errors.begin(), errors.end()), expected);
+}
+
+TEST(incremental_spell_checker, RevertedParagraphIsServedFromCache) {
+    FakeSpellCheckService service;
+    IncrementalSpellChecker checker(&service);
+    (void)checker.Update(L"alpha\nbeta");
+    (void)checker.Update(L"alpha\nbetas");
+    ASSERT_EQ(service.Call_count(), 3u);
+
+    (void)checker.Update(L"alpha\nbeta");
+    (void)checker.Update(L"beta\nalpha");
+
+    EXPECT_EQ(service.Call_count(), 3u);
+}
+
+TEST(incremental_spell_checker, CacheIsBounded) {
+    FakeSpellCheckService service;
+    IncrementalSpellChecker checker(&service, 2);
+    (void)checker.Update(L"a");
+    (void)checker.Update(L"b");
+    (void)checker.Update(L"c");
+    EXPECT_LE(checker.Cached_paragraph_count(), 2u);
+}
+
+TEST(incremental_spell_checker, MatchesFullCheckAcrossEdits) {
+    FakeSpellCheckService service;
+    service.misspelled_words = {L"teh", L"adn"};
+    IncrementalSpellChecker checker(&service);
+
+    std::wstring text = L"teh cat\nadn dog\n\nteh end";
+    struct Edit final {
+        size_t offset = 0;
+        size_t erase_count = 0;
+        std::wstring_view inserted = {};
+    };
+    std::array<Edit, 8> const edits = {{
+        {0, 0, L"x"},
+        {9, 0, L"\n"},
+        {4, 0, L"adn "},
+        {0, 1, L"teh\n"},
+        {12, 3, L"teh"},
+        {3, 2, L""},
+        {20, 0, L"\nadn"},
+        {1, 0, L"d"},
+    }};
+    for (Edit const &edit : edits) {
+        size_t const offset = std::min(edit.offset, text.size());
+        text.erase(offset, edit.erase_count);
+        text.insert(offset, edit.inserted);
+        std::span<const SpellError> const incremental = checker.Update(text);
+
+        std::vector<SpellError> expected;
+        size_t paragraph_start = 0;
+        while (paragraph_start <= text.size()) {
+            size_t paragraph_end = text.find(L'\n', paragraph_start);
+            if (paragraph_end == std::wstring::npos) {
+                paragraph_end = text.size();
+            }
+            for (SpellError const &error : service.Check(
+                     std::wstring_view(text).substr(paragraph_start,
+                                                    paragraph_end - paragraph_start))) {
+                expected.push_back(SpellError{
+                    static_cast<int32_t>(paragraph_start) + error.start_utf16,
+                    error.length_utf16});
+            }
+            paragraph_start = paragraph_end + 1;
+        }
+        EXPECT_EQ(std::vector<SpellError>(incremental.begin(), incremental.end()),
+                  expected)
+            << "after editing to: " << std::string(text.begin(), text.end());
+    }
+}
+
+TEST(incremental_spell_checker, AsyncJobsApplyOnlyToCurrentVersion) {
+    FakeSpellCheckService service;
+    IncrementalSpellChecker checker(&service);
+
+    std::vector<SpellCheckJob> const first = checker.Begin_update(L"helo");
+    ASSERT_EQ(first.size(), 1u);
+    EXPECT_EQ(first[0].paragraph_text, L"helo");
+    EXPECT_TRUE(checker.Errors().empty());
+
+    std::vector<SpellCheckJob> const second = checker.Begin_update(L"helo\nwrold");
+    ASSERT_EQ(second.size(), 2u);
+    EXPECT_GT(second[0].text_version, first[0].text_version);
+
+    // A result for the superseded version is cached but not applied.
+    EXPECT_FALSE(checker.Complete_job(first[0], {SpellError{0, 4}}));
+    EXPECT_TRUE(checker.Errors().empty());
+    EXPECT_EQ(service.Call_count(), 0u);
+
+    EXPECT_TRUE(checker.Complete_job(second[1], {SpellError{0, 5}}));
+    std::vector<SpellError> const expected = {SpellError{5, 5}};
+    EXPECT_EQ(std::vector<SpellError>(checker.Errors().begin(), checker.Errors().end()),
+              expected);
+
+    // The stale result for "helo" satisfies the next update without a job.
+    std::vector<SpellCheckJob> const third = checker.Begin_update(L"helo\nwrold!");
+    ASSERT_EQ(third.size(), 1u);
+    EXPECT_EQ(third[0].paragraph_text, L"wrold!");
+    std::vector<SpellError> const expected_after = {SpellError{0, 4}};
+    EXPECT_EQ(std::vector<SpellError>(checker.Errors().begin(), checker.Errors().end()),
+              expected_after);
+}
@@ -0,0 +1,235 @@
+#include "greenflame_core/stage_graph.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+// Appends stage names in completion order; safe from any thread.
+class CompletionLog final {
+  public:
+    void Add(std::string_view name) {
+        std::scoped_lock lock(mutex_);
+        names_.emplace_back(name);
+    }
+
+    [[nodiscard]] size_t Position(std::string_view name) {
+        std::scoped_lock lock(mutex_);
+        return static_cast<size_t>(std::find(names_.begin(), names_.end(), name) -
+                                   names_.begin());
+    }
+
+    [[nodiscard]] size_t Size() {
+        std::scoped_lock lock(mutex_);
+        return names_.size();
+    }
+
+  private:
+    std::mutex mutex_ = {};
+    std::vector<std::string> names_ = {};
+};
+
+} // namespace
+
+TEST(stage_graph, Run_StartsStagesOnlyAfterTheirProducers) {
+    for (size_t const workers : {size_t{1}, size_t{4}}) {
+        CompletionLog log;
+        StageGraph graph;
+        // Added out of order on purpose.
+        (void)graph.Add_stage("compose", StageThread::Any, {"capture", "cursor"},
+                              {"display"}, [&] {
+                                  log.Add("compose");
+                                  return true;
+                              });
+        (void)graph.Add_stage("capture", StageThread::Any, {}, {"capture"}, [&] {
+            log.Add("capture");
+            return true;
+        });
+        (void)graph.Add_stage("cursor", StageThread::Any, {}, {"cursor"}, [&] {
+            log.Add("cursor");
+            return true;
+        });
+        (void)graph.Add_stage("upload", StageThread::Caller, {"display"}, {}, [&] {
+            log.Add("upload");
+            return true;
+        });
+        ASSERT_TRUE(graph.Is_valid());
+
+        StageGraphResult const result = graph.Run(workers);
+        EXPECT_TRUE(result.success) << workers;
+        ASSERT_EQ(log.Size(), 4u);
+        EXPECT_LT(log.Position("capture"), log.Position("compose")) << workers;
+        EXPECT_LT(log.Position("cursor"), log.Position("compose")) << workers;
+        EXPECT_LT(log.Position("compose"), log.Position("upload")) << workers;
+        ASSERT_EQ(result.stages.size(), 4u);
+        EXPECT_STREQ(result.stages[0].name, "compose");
+        EXPECT_LE(result.stages[1].end_ns, result.stages[0].begin_ns);
+        EXPECT_LE(result.stages[0].end_ns, result.stages[3].begin_ns);
+        for (StageTiming const &timing : result.stages) {
+            EXPECT_EQ(timing.status, StageStatus::Succeeded);
+            EXPECT_LE(timing.begin_ns, timing.end_ns);
+            EXPECT_LE(timing.end_ns, result.total_ns);
+        }
+    }
+}
+
+TEST(stage_graph, Run_FailureSkipsDependentsButNotIndependentStages) {
+    std::atomic<int> runs = 0;
+    StageGraph graph;
+    size_t const capture =
+        graph.Add_stage("capture", StageThread::Any, {}, {"capture"}, [] {
+            return false;
+        });
+    size_t const compose = graph.Add_stage("compose", StageThread::Any,
+                                           {"capture", "glyphs"}, {"display"}, [&] {
+                                               ++runs;
+                                               return true;
+                                           });
+    size_t const upload =
+        graph.Add_stage("upload", StageThread::Caller, {"display"}, {}, [&] {
+            ++runs;
+            return true;
+        });
+    size_t const glyphs =
+        graph.Add_stage("glyphs", StageThread::Any, {}, {"glyphs"}, [&] {
+            ++runs;
+            return true;
+        });
+
+    StageGraphResult const result = graph.Run(3);
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.Status(capture), StageStatus::Failed);
+    EXPECT_EQ(result.Status(compose), StageStatus::Skipped);
+    EXPECT_EQ(result.Status(upload), StageStatus::Skipped);
+    EXPECT_EQ(result.Status(glyphs), StageStatus::Succeeded);
+    EXPECT_EQ(runs.load(), 1);
+    EXPECT_EQ(result.stages[upload].begin_ns, 0);
+    EXPECT_EQ(result.stages[upload].end_ns, 0);
+}
+
+TEST(stage_graph, Run_ThrowingStageFailsLikeOneReturningFalse) {
+    for (size_t const workers : {size_t{1}, size_t{4}}) {
+        StageGraph graph;
+        size_t const capture =
+            graph.Add_stage("capture", StageThread::Any, {}, {"capture"},
+                            []() -> bool { throw std::runtime_error("capture"); });
+        size_t const upload = graph.Add_stage("upload", StageThread::Caller,
+                                              {"capture"}, {}, [] { return true; });
+        size_t const glyphs =
+            graph.Add_stage("glyphs", StageThread::Any, {}, {}, [] { return true; });
+
+        StageGraphResult const result = graph.Run(workers);
+        EXPECT_FALSE(result.success);
+        EXPECT_EQ(result.Status(capture), StageStatus::Failed) << workers;
+        EXPECT_EQ(result.Status(upload), StageStatus::Skipped) << workers;
+        EXPECT_EQ(result.Status(glyphs), StageStatus::Succeeded) << workers;
+    }
+}
+
+TEST(stage_graph, Run_KeepsCallerStagesOnTheCallingThread) {
+    std::thread::id const caller = std::this_thread::get_id();
+    std::vector<std::thread::id> caller_stage_threads(3);
+    StageGraph graph;
+    for (size_t index = 0; index < 4; ++index) {
+        (void)graph.Add_stage("work", StageThread::Any, {}, {}, [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return true;
+        });
+    }
+    (void)graph.Add_stage("window", StageThread::Caller, {}, {"hwnd"}, [&] {
+        caller_stage_threads[0] = std::this_thread::get_id();
+        return true;
+    });
+    (void)graph.Add_stage("device", StageThread::Caller, {"hwnd"}, {"device"}, [&] {
+        caller_stage_threads[1] = std::this_thread::get_id();
+        return true;
+    });
+    (void)graph.Add_stage("upload", StageThread::Caller, {"device"}, {}, [&] {
+        caller_stage_threads[2] = std::this_thread::get_id();
+        return true;
+    });
+
+    StageGraphResult const result = graph.Run(4);
+    EXPECT_TRUE(result.success);
+    for (std::thread::id const id : caller_stage_threads) {
+        EXPECT_EQ(id, caller);
+    }
+    for (size_t index = 4; index < result.stages.size(); ++index) {
+        EXPECT_TRUE(result.stages[index].ran_on_caller);
+    }
+}
+
+TEST(stage_graph, Run_OverlapsIndependentStagesOnWorkers) {
+    // Each stage waits (bounded) for the other to start, so they only both see
+    // each other when they really run at the same time.
+    std::atomic<int> started = 0;
+    auto const rendezvous = [&] {
+        ++started;
+        auto const deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (started.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        return started.load() == 2;
+    };
+    StageGraph graph;
+    (void)graph.Add_stage("first", StageThread::Any, {}, {}, rendezvous);
+    (void)graph.Add_stage("second", StageThread::Any, {}, {}, rendezvous);
+
+    StageGraphResult const result = graph.Run(2);
+    EXPECT_TRUE(result.success);
+    EXPECT_NE(result.stages[0].ran_on_caller, result.stages[1].ran_on_caller);
+}
+
+TEST(stage_graph, Run_WithoutWorkersRunsEverythingOnTheCaller) {
+    std::thread::id const caller = std::this_thread::get_id();
+    for (size_t const workers : {size_t{0}, size_t{1}}) {
+        std::atomic<int> off_caller = 0;
+        StageGraph graph;
+        for (size_t index = 0; index < 5; ++index) {
+            (void)graph.Add_stage("work", StageThread::Any, {}, {}, [&] {
+                if (std::this_thread::get_id() != caller) {
+                    ++off_caller;
+                }
+                return true;
+            });
+        }
+        StageGraphResult const result = graph.Run(workers);
+        EXPECT_TRUE(result.success);
+        EXPECT_EQ(off_caller.load(), 0) << workers;
+    }
+}
+
+TEST(stage_graph, Run_RejectsInvalidGraphsWithoutRunningAnything) {
+    std::atomic<int> runs = 0;
+    auto const count = [&] {
+        ++runs;
+        return true;
+    };
+
+    StageGraph missing_producer;
+    (void)missing_producer.Add_stage("a", StageThread::Any, {"nothing"}, {}, count);
+    StageGraph duplicate_producer;
+    (void)duplicate_producer.Add_stage("a", StageThread::Any, {}, {"value"}, count);
+    (void)duplicate_producer.Add_stage("b", StageThread::Any, {}, {"value"}, count);
+    StageGraph cycle;
+    (void)cycle.Add_stage("a", StageThread::Any, {"b"}, {"a"}, count);
+    (void)cycle.Add_stage("b", StageThread::Caller, {"a"}, {"b"}, count);
+    (void)cycle.Add_stage("c", StageThread::Any, {}, {"c"}, count);
+    StageGraph self_loop;
+    (void)self_loop.Add_stage("a", StageThread::Any, {"a"}, {"a"}, count);
+
+    for (StageGraph *const graph :
+         {&missing_producer, &duplicate_producer, &cycle, &self_loop}) {
+        EXPECT_FALSE(graph->Is_valid());
+        StageGraphResult const result = graph->Run(4);
+        EXPECT_FALSE(result.success);
+        for (StageTiming const &timing : result.stages) {
+            EXPECT_EQ(timing.status, StageStatus::Skipped);
+        }
+    }
+    EXPECT_EQ(runs.load(), 0);
+
+    StageGraph empty;
+    EXPECT_TRUE(empty.Is_valid());
+    EXPECT_TRUE(empty.Run(4).success);
+}
@@ -0,0 +1,167 @@
+#include "greenflame_core/surface_tiling.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+// Every pixel of `rect` (clipped to the surface) is in exactly one span, and each
+// span maps back to its tile's local coordinates.
+void Expect_exact_cover(SurfaceTileGrid const &grid, RectPx rect) {
+    std::vector<SurfaceTileSpan> const spans = grid.Split(rect);
+    std::optional<RectPx> const clipped = RectPx::Clip(
+        rect, RectPx::From_ltrb(0, 0, grid.Width(), grid.Height()));
+    int64_t covered = 0;
+    for (SurfaceTileSpan const &span : spans) {
+        RectPx const bounds = grid.Tile_bounds(span.tile_index);
+        EXPECT_EQ(RectPx::Intersect(span.surface_rect, bounds), span.surface_rect);
+        EXPECT_EQ(span.local_rect.left, span.surface_rect.left - bounds.left);
+        EXPECT_EQ(span.local_rect.top, span.surface_rect.top - bounds.top);
+        EXPECT_EQ(span.local_rect.Width(), span.surface_rect.Width());
+        EXPECT_EQ(span.local_rect.Height(), span.surface_rect.Height());
+        covered += static_cast<int64_t>(span.surface_rect.Width()) *
+                   span.surface_rect.Height();
+        for (SurfaceTileSpan const &other : spans) {
+            if (&other != &span) {
+                EXPECT_FALSE(RectPx::Intersect(span.surface_rect, other.surface_rect)
+                                 .has_value());
+            }
+        }
+    }
+    int64_t const expected =
+        clipped.has_value()
+            ? static_cast<int64_t>(clipped->Width()) * clipped->Height()
+            : 0;
+    EXPECT_EQ(covered, expected);
+}
+
+} // namespace
+
+TEST(surface_tiling, SurfaceWithinTheLimitIsOneTile) {
+    SurfaceTileGrid const grid(7680, 2160, kDefaultMaxSurfaceTilePx);
+    EXPECT_FALSE(grid.Is_tiled());
+    EXPECT_EQ(grid.Tile_count(), 1u);
+    EXPECT_EQ(grid.Tile_bounds(0), RectPx::From_ltrb(0, 0, 7680, 2160));
+
+    SurfaceTileGrid const exact(16384, 16384, 16384);
+    EXPECT_EQ(exact.Tile_count(), 1u);
+    SurfaceTileGrid const unlimited(100000, 5, 0);
+    EXPECT_EQ(unlimited.Tile_count(), 1u);
+}
+
+TEST(surface_tiling, OnePixelOverTheLimitSplitsEvenly) {
+    SurfaceTileGrid const grid(16385, 1080, 16384);
+    ASSERT_EQ(grid.Columns(), 2u);
+    ASSERT_EQ(grid.Rows(), 1u);
+    EXPECT_EQ(grid.Tile_bounds(0), RectPx::From_ltrb(0, 0, 8192, 1080));
+    EXPECT_EQ(grid.Tile_bounds(1), RectPx::From_ltrb(8192, 0, 16385, 1080));
+    EXPECT_EQ(grid.Tile_bounds(2), RectPx{});
+}
+
+TEST(surface_tiling, ExtremeLayoutsKeepEveryTileWithinTheLimit) {
+    struct Layout final {
+        int32_t width;
+        int32_t height;
+        int32_t max_tile_px;
+        size_t columns;
+        size_t rows;
+    };
+    std::array<Layout, 4> const layouts = {{
+        {5 * 3840, 2160, 16384, 2, 1},        // five 4K monitors side by side
+        {3840, 6 * 2160, 8192, 1, 2},         // stacked video wall, older GPU limit
+        {4 * 7680, 3 * 4320, 16384, 2, 1},    // 8K wall, 4 x 3
+        {10 * 3840, 5 * 2160, 4096, 10, 3},   // small limit
+    }};
+    for (Layout const &layout : layouts) {
+        SurfaceTileGrid const grid(layout.width, layout.height, layout.max_tile_px);
+        ASSERT_EQ(grid.Columns(), layout.columns) << layout.width;
+        ASSERT_EQ(grid.Rows(), layout.rows) << layout.height;
+        int64_t area = 0;
+        for (size_t index = 0; index < grid.Tile_count(); ++index) {
+            RectPx const bounds = grid.Tile_bounds(index);
+            EXPECT_LE(bounds.Width(), layout.max_tile_px);
+            EXPECT_LE(bounds.Height(), layout.max_tile_px);
+            EXPECT_FALSE(bounds.Is_empty());
+            area += static_cast<int64_t>(bounds.Width()) * bounds.Height();
+        }
+        EXPECT_EQ(area, static_cast<int64_t>(layout.width) * layout.height);
+    }
+}
+
+TEST(surface_tiling, PointLookupRespectsTileEdges) {
+    SurfaceTileGrid const grid(19200, 2160, 16384);
+    EXPECT_EQ(grid.Tile_index_at({0, 0}), 0u);
+    EXPECT_EQ(grid.Tile_index_at({9599, 2159}), 0u);
+    EXPECT_EQ(grid.Tile_index_at({9600, 0}), 1u);
+    EXPECT_EQ(grid.Tile_index_at({19199, 2159}), 1u);
+    EXPECT_FALSE(grid.Tile_index_at({19200, 0}).has_value());
+    EXPECT_FALSE(grid.Tile_index_at({-1, 0}).has_value());
+    EXPECT_FALSE(grid.Tile_index_at({0, 2160}).has_value());
+    EXPECT_EQ(grid.To_tile_local(1, PointPx{9600, 10}), (PointPx{0, 10}));
+    EXPECT_EQ(grid.To_tile_local(1, RectPx::From_ltrb(9700, 5, 9800, 50)),
+              RectPx::From_ltrb(100, 5, 200, 50));
+}
+
+TEST(surface_tiling, MagnifierRectStraddlingASeamSplitsAcrossTiles) {
+    SurfaceTileGrid const grid(19200, 4320 * 4, 16384);
+    ASSERT_EQ(grid.Columns(), 2u);
+    ASSERT_EQ(grid.Rows(), 2u);
+    // A 41 x 41 sample around the four-way corner of the tiles.
+    RectPx const sample = RectPx::From_ltrb(9580, 8620, 9621, 8661);
+    std::vector<SurfaceTileSpan> const spans = grid.Split(sample);
+    ASSERT_EQ(spans.size(), 4u);
+    EXPECT_EQ(spans[0].tile_index, 0u);
+    EXPECT_EQ(spans[0].surface_rect, RectPx::From_ltrb(9580, 8620, 9600, 8640));
+    EXPECT_EQ(spans[0].local_rect, RectPx::From_ltrb(9580, 8620, 9600, 8640));
+    EXPECT_EQ(spans[3].tile_index, 3u);
+    EXPECT_EQ(spans[3].surface_rect, RectPx::From_ltrb(9600, 8640, 9621, 8661));
+    EXPECT_EQ(spans[3].local_rect, RectPx::From_ltrb(0, 0, 21, 21));
+    Expect_exact_cover(grid, sample);
+}
+
+TEST(surface_tiling, SplitCoversEveryPixelOnceAndClipsToTheSurface) {
+    SurfaceTileGrid const grid(1000, 700, 256);
+    for (RectPx const rect :
+         {RectPx::From_ltrb(0, 0, 1000, 700), RectPx::From_ltrb(-50, -50, 300, 300),
+          RectPx::From_ltrb(999, 699, 1200, 900), RectPx::From_ltrb(250, 175, 251, 525),
+          RectPx::From_ltrb(600, 400, 300, 100)}) {
+        Expect_exact_cover(grid, rect.Normalized());
+    }
+    EXPECT_TRUE(grid.Split(RectPx::From_ltrb(1000, 0, 1100, 10)).empty());
+    EXPECT_TRUE(grid.Split(RectPx::From_ltrb(10, 10, 10, 20)).empty());
+    EXPECT_TRUE(SurfaceTileGrid().Split(RectPx::From_ltrb(0, 0, 5, 5)).empty());
+    EXPECT_TRUE(SurfaceTileGrid(0, 10, 256).Is_empty());
+}
+
+TEST(surface_tiling, FitKeepsSurfacesWithinTheLimitUnscaled) {
+    EXPECT_EQ(Fit_surface_to_limit(3840, 2160, 16384), (SurfaceFit{1.f, 3840, 2160}));
+    EXPECT_EQ(Fit_surface_to_limit(16384, 16384, 16384),
+              (SurfaceFit{1.f, 16384, 16384}));
+    EXPECT_EQ(Fit_surface_to_limit(20000, 100, 0), (SurfaceFit{1.f, 20000, 100}));
+    EXPECT_EQ(Fit_surface_to_limit(0, 100, 16384), SurfaceFit{});
+}
+
+// An oversized desktop must not fail at the swap chain or cache targets before
+// the screenshot gets to its tiled upload.
+TEST(surface_tiling, OversizedDesktopFitsTargetsAndTilesTheScreenshot) {
+    struct Desktop final {
+        int32_t width = 0;
+        int32_t height = 0;
+    };
+    for (Desktop const desktop : {Desktop{5 * 3840, 2160}, Desktop{16385, 1080},
+                                  Desktop{7680, 4 * 4320}, Desktop{40000, 30000}}) {
+        SurfaceFit const fit = Fit_surface_to_limit(desktop.width, desktop.height,
+                                                    kDefaultMaxSurfaceTilePx);
+        EXPECT_LT(fit.scale, 1.f);
+        EXPECT_LE(fit.width, kDefaultMaxSurfaceTilePx);
+        EXPECT_LE(fit.height, kDefaultMaxSurfaceTilePx);
+        EXPECT_EQ(std::max(fit.width, fit.height), kDefaultMaxSurfaceTilePx);
+        EXPECT_NEAR(static_cast<float>(fit.width) / static_cast<float>(fit.height),
+                    static_cast<float>(desktop.width) /
+                        static_cast<float>(desktop.height),
+                    0.01f);
+
+        SurfaceTileGrid const grid(desktop.width, desktop.height,
+                                   kDefaultMaxSurfaceTilePx);
+        EXPECT_TRUE(grid.Is_tiled());
+    }
+}
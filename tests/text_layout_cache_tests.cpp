@@ -0,0 +1,173 @@
+#include "fake_text_layout_engine.h"
+#include "greenflame_core/text_edit_controller.h"
+#include "greenflame_core/text_layout_cache.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+// Answers caret, hit-test and navigation from paragraph metrics; the whole-draft
+// call counters let tests assert the cache never needed them.
+[[nodiscard]] FakeTextLayoutEngine Make_measuring_engine() {
+    FakeTextLayoutEngine engine;
+    engine.paragraph_metrics = true;
+    return engine;
+}
+
+[[nodiscard]] TextDraftBuffer Make_buffer(std::wstring text, int32_t caret) {
+    TextDraftBuffer buffer{};
+    buffer.runs.push_back(TextRun{std::move(text), {}});
+    buffer.selection = TextSelection{caret, caret};
+    return buffer;
+}
+
+} // namespace
+
+TEST(text_layout_cache, Layout_MeasuresEachParagraphOnce) {
+    FakeTextLayoutEngine engine = Make_measuring_engine();
+    TextLayoutCache cache(&engine);
+
+    DraftTextLayoutResult const &layout =
+        cache.Layout(Make_buffer(L"ab\n\ncdef", 6), PointPx{100, 50});
+
+    EXPECT_EQ(cache.Last_change(), TextLayoutChange::Style);
+    EXPECT_EQ(engine.draft_layout_calls, 0);
+    EXPECT_EQ(engine.measured_paragraphs,
+              (std::vector<std::wstring>{L"ab", L"", L"cdef"}));
+    EXPECT_EQ(layout.visual_bounds, RectPx::From_ltrb(100, 50, 140, 110));
+    EXPECT_EQ(layout.caret_rect, RectPx::From_ltrb(120, 90, 121, 110));
+    EXPECT_EQ(layout.overwrite_caret_rect, RectPx::From_ltrb(120, 90, 130, 110));
+    EXPECT_EQ(layout.preferred_x_px, 20);
+}
+
+TEST(text_layout_cache, Layout_SelectionChangeReusesMetrics) {
+    FakeTextLayoutEngine engine = Make_measuring_engine();
+    TextLayoutCache cache(&engine);
+    TextDraftBuffer buffer = Make_buffer(L"abc\ndef", 0);
+    (void)cache.Layout(buffer, PointPx{0, 0});
+    size_t const measured = engine.measured_paragraphs.size();
+
+    buffer.selection = TextSelection{1, 6};
+    DraftTextLayoutResult const &layout = cache.Layout(buffer, PointPx{0, 0});
+
+    EXPECT_EQ(cache.Last_change(), TextLayoutChange::Selection);
+    EXPECT_EQ(engine.measured_paragraphs.size(), measured);
+    EXPECT_EQ(engine.draft_layout_calls, 0);
+    ASSERT_EQ(layout.selection_rects.size(), 2u);
+    EXPECT_EQ(layout.selection_rects[0], RectPx::From_ltrb(10, 0, 30, 20));
+    EXPECT_EQ(layout.selection_rects[1], RectPx::From_ltrb(0, 20, 20, 40));
+    EXPECT_EQ(layout.caret_rect, RectPx::From_ltrb(20, 20, 21, 40));
+
+    (void)cache.Layout(buffer, PointPx{0, 0});
+    EXPECT_EQ(cache.Last_change(), TextLayoutChange::None);
+}
+
+TEST(text_layout_cache, Layout_EditRemeasuresOnlyTouchedParagraph) {
+    FakeTextLayoutEngine engine = Make_measuring_engine();
+    TextLayoutCache cache(&engine);
+    (void)cache.Layout(Make_buffer(L"one\ntwo\nthree", 0), PointPx{0, 0});
+    engine.measured_paragraphs.clear();
+
+    DraftTextLayoutResult const &layout =
+        cache.Layout(Make_buffer(L"one\ntwoX\nthree", 8), PointPx{0, 0});
+
+    EXPECT_EQ(cache.Last_change(), TextLayoutChange::Content);
+    EXPECT_EQ(engine.measured_paragraphs, (std::vector<std::wstring>{L"twoX"}));
+    EXPECT_EQ(layout.caret_rect, RectPx::From_ltrb(40, 20, 41, 40));
+
+    engine.measured_paragraphs.clear();
+    (void)cache.Layout(Make_buffer(L"one\ntw\no\nthree", 7), PointPx{0, 0});
+    EXPECT_EQ(engine.measured_paragraphs, (std::vector<std::wstring>{L"tw", L"o"}));
+}
+
+TEST(text_layout_cache, Layout_BaseStyleChangeRemeasuresEveryParagraph) {
+    FakeTextLayoutEngine engine = Make_measuring_engine();
+    TextLayoutCache cache(&engine);
+    TextDraftBuffer buffer = Make_buffer(L"one\ntwo", 0);
+    (void)cache.Layout(buffer, PointPx{0, 0});
+    engine.measured_paragraphs.clear();
+
+    buffer.base_style.point_size += 4;
+    (void)cache.Layout(buffer, PointPx{0, 0});
+
+    EXPECT_EQ(cache.Last_change(), TextLayoutChange::Style);
+    EXPECT_EQ(engine.measured_paragraphs, (std::vector<std::wstring>{L"one", L"two"}));
+    EXPECT_EQ(engine.measured_styles.back(), buffer.base_style);
+}
+
+TEST(text_layout_cache, HitTestAndMoveVertical_AnsweredFromMetrics) {
+    FakeTextLayoutEngine engine = Make_measuring_engine();
+    TextLayoutCache cache(&engine);
+    TextDraftBuffer const buffer = Make_buffer(L"abcd\nef\nghij", 0);
+    PointPx const origin{100, 100};
+    (void)cache.Layout(buffer, origin);
+
+    EXPECT_EQ(cache.Hit_test_point(buffer, origin, PointPx{114, 105}), 1);
+    EXPECT_EQ(cache.Hit_test_point(buffer, origin, PointPx{116, 105}), 2);
+    EXPECT_EQ(cache.Hit_test_point(buffer, origin, PointPx{190, 125}), 7);
+    EXPECT_EQ(cache.Hit_test_point(buffer, origin, PointPx{50, 500}), 8);
+
+    EXPECT_EQ(cache.Move_vertical(buffer, origin, 3, 1, 30), 7);
+    EXPECT_EQ(cache.Move_vertical(buffer, origin, 7, 1, 30), 11);
+    EXPECT_EQ(cache.Move_vertical(buffer, origin, 2, -1, 20), 0);
+    EXPECT_EQ(cache.Move_vertical(buffer, origin, 9, 1, 20), 12);
+
+    EXPECT_EQ(engine.hit_test_calls, 0);
+    EXPECT_EQ(engine.move_vertical_calls, 0);
+    EXPECT_EQ(engine.measured_paragraphs.size(), 3u);
+}
+
+TEST(text_layout_cache, Layout_EmptyTextUsesEnginePlaceholder) {
+    FakeTextLayoutEngine engine = Make_measuring_engine();
+    TextLayoutCache cache(&engine);
+
+    DraftTextLayoutResult const &layout =
+        cache.Layout(Make_buffer(L"", 0), PointPx{5, 6});
+
+    EXPECT_EQ(engine.draft_layout_calls, 1);
+    EXPECT_EQ(layout.caret_rect, RectPx::From_ltrb(5, 6, 6, 26));
+}
+
+TEST(text_layout_cache, EngineWithoutParagraphMetrics_FallsBackToDraftCalls) {
+    FakeTextLayoutEngine engine;
+    TextLayoutCache cache(&engine);
+    TextDraftBuffer buffer = Make_buffer(L"abc", 1);
+
+    EXPECT_EQ(cache.Layout(buffer, PointPx{0, 0}).caret_rect,
+              RectPx::From_ltrb(10, 0, 11, 20));
+    (void)cache.Layout(buffer, PointPx{0, 0});
+    EXPECT_EQ(engine.draft_layout_calls, 1);
+
+    buffer.selection = TextSelection{2, 2};
+    EXPECT_EQ(cache.Layout(buffer, PointPx{0, 0}).caret_rect,
+              RectPx::From_ltrb(20, 0, 21, 20));
+    EXPECT_EQ(engine.draft_layout_calls, 2);
+
+    EXPECT_EQ(cache.Hit_test_point(buffer, PointPx{0, 0}, PointPx{15, 5}), 1);
+    EXPECT_EQ(cache.Move_vertical(buffer, PointPx{0, 0}, 2, 1, 10), 1);
+    EXPECT_EQ(engine.hit_test_calls, 1);
+    EXPECT_EQ(engine.move_vertical_calls, 1);
+}
+
+TEST(text_layout_cache, TextEditController_NavigationDoesNotRelayout) {
+    FakeTextLayoutEngine engine = Make_measuring_engine();
+    TextEditController controller(PointPx{0, 0}, TextAnnotationBaseStyle{},
+                                  {TextRun{L"first line\nsecond line", {}}}, &engine,
+                                  nullptr);
+    size_t const measured = engine.measured_paragraphs.size();
+
+    controller.On_navigation(TextNavigationAction::DocHome, false);
+    controller.On_navigation(TextNavigationAction::Down, false);
+    controller.On_navigation(TextNavigationAction::Right, true);
+    controller.On_pointer_press(PointPx{52, 5});
+
+    EXPECT_EQ(engine.measured_paragraphs.size(), measured);
+    EXPECT_EQ(engine.draft_layout_calls, 0);
+    EXPECT_EQ(engine.hit_test_calls, 0);
+    EXPECT_EQ(engine.move_vertical_calls, 0);
+    EXPECT_EQ(controller.Build_view().caret_rect, RectPx::From_ltrb(50, 0, 51, 20));
+
+    controller.On_text_input(L"!");
+    EXPECT_EQ(engine.measured_paragraphs.back(), L"first! line");
+    EXPECT_EQ(engine.measured_paragraphs.size(), measured + 1);
+}
@@ -0,0 +1,55 @@
+#include "greenflame_core/toolbar_glyph_masks.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+[[nodiscard]] size_t Count_opaque(ToolbarGlyphMask const &mask) {
+    return static_cast<size_t>(
+        std::count_if(mask.alpha.begin(), mask.alpha.end(),
+                      [](uint8_t alpha) { return alpha >= 128; }));
+}
+
+} // namespace
+
+TEST(toolbar_glyph_masks, EveryGlyphIsA20PxMaskWithTransparentCorners) {
+    for (size_t index = 0; index < static_cast<size_t>(ToolbarGlyphMaskId::Count);
+         ++index) {
+        ToolbarGlyphMask const mask =
+            Toolbar_glyph_mask(static_cast<ToolbarGlyphMaskId>(index));
+        ASSERT_TRUE(mask.Is_valid()) << index;
+        EXPECT_EQ(mask.width, 20) << index;
+        EXPECT_EQ(mask.height, 20) << index;
+        EXPECT_EQ(mask.alpha.front(), 0) << index;
+        EXPECT_EQ(mask.alpha[19], 0) << index;
+        EXPECT_EQ(mask.alpha[380], 0) << index;
+        EXPECT_EQ(mask.alpha.back(), 0) << index;
+        EXPECT_GT(Count_opaque(mask), 0u) << index;
+    }
+}
+
+TEST(toolbar_glyph_masks, GlyphsAreDistinctAndFilledVariantsCoverMore) {
+    constexpr size_t kCount = static_cast<size_t>(ToolbarGlyphMaskId::Count);
+    for (size_t a = 0; a < kCount; ++a) {
+        for (size_t b = a + 1; b < kCount; ++b) {
+            std::span<const uint8_t> const first =
+                Toolbar_glyph_mask(static_cast<ToolbarGlyphMaskId>(a)).alpha;
+            std::span<const uint8_t> const second =
+                Toolbar_glyph_mask(static_cast<ToolbarGlyphMaskId>(b)).alpha;
+            EXPECT_FALSE(std::equal(first.begin(), first.end(), second.begin(),
+                                    second.end()))
+                << a << " " << b;
+        }
+    }
+    // The filled variants cover more of the button than their outlines.
+    EXPECT_GT(Count_opaque(Toolbar_glyph_mask(ToolbarGlyphMaskId::FilledRectangle)),
+              Count_opaque(Toolbar_glyph_mask(ToolbarGlyphMaskId::Rectangle)));
+    EXPECT_GT(Count_opaque(Toolbar_glyph_mask(ToolbarGlyphMaskId::FilledEllipse)),
+              Count_opaque(Toolbar_glyph_mask(ToolbarGlyphMaskId::Ellipse)));
+}
+
+TEST(toolbar_glyph_masks, OutOfRangeIdReturnsEmptyMask) {
+    ToolbarGlyphMask const mask = Toolbar_glyph_mask(ToolbarGlyphMaskId::Count);
+    EXPECT_FALSE(mask.Is_valid());
+    EXPECT_TRUE(mask.alpha.empty());
+}
@@ -0,0 +1,137 @@
+#include "greenflame_core/cli_options.h"
+#include "greenflame_core/trace_recorder.h"
+
+using namespace greenflame::core;
+
+namespace {
+
+[[nodiscard]] size_t Count_occurrences(std::string_view text, std::string_view needle) {
+    size_t count = 0;
+    for (size_t at = text.find(needle); at != std::string_view::npos;
+         at = text.find(needle, at + needle.size())) {
+        ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(trace_recorder, Export_WritesCompleteEventsRelativeToRecorderStart) {
+    TraceRecorder recorder;
+    int64_t const start = TraceRecorder::Now_ns();
+    recorder.Record("Paint", start + 2'500, start + 4'000);
+    recorder.Record("Quote\"Back\\slash\n", start + 10'000, start + 9'000);
+
+    std::string const json = recorder.Build_chrome_trace_json();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"name\":\"Paint\",\"ph\":\"X\",\"pid\":1,\"tid\":1"),
+              std::string::npos);
+    EXPECT_NE(json.find(",\"dur\":1.500}"), std::string::npos);
+    // End before begin clamps to an empty duration instead of a negative one.
+    EXPECT_NE(json.find("\"name\":\"Quote\\\"Back\\\\slash\\u000a\""),
+              std::string::npos);
+    EXPECT_NE(json.find(",\"dur\":0.000}"), std::string::npos);
+    EXPECT_EQ(Count_occurrences(json, "\"ph\":\"M\""), 1u);
+    EXPECT_EQ(json.substr(json.size() - 4u), "\n]}\n");
+}
+
+TEST(trace_recorder, Export_KeepsLatestEventsOfEachThreadRing) {
+    TraceRecorder recorder;
+    int64_t const start = TraceRecorder::Now_ns();
+    size_t const total = kTraceEventsPerThread + 10u;
+    for (size_t index = 0; index < total; ++index) {
+        char const *const name = index < 10u ? "Old" : "New";
+        int64_t const at = start + static_cast<int64_t>(index);
+        recorder.Record(name, at, at + 1);
+    }
+
+    std::string const json = recorder.Build_chrome_trace_json();
+    EXPECT_EQ(Count_occurrences(json, "\"name\":\"Old\""), 0u);
+    EXPECT_EQ(Count_occurrences(json, "\"name\":\"New\""), kTraceEventsPerThread);
+}
+
+TEST(trace_recorder, Export_GivesEachThreadItsOwnTrack) {
+    TraceRecorder recorder;
+    constexpr int kThreads = 4;
+    constexpr int kEventsPerThread = 100;
+    // Threads stay alive until all have recorded so none inherits another's ring.
+    std::atomic<int> recorded = 0;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kThreads; ++thread) {
+        threads.emplace_back([&recorder, &recorded] {
+            for (int index = 0; index < kEventsPerThread; ++index) {
+                int64_t const now = TraceRecorder::Now_ns();
+                recorder.Record("Work", now, now + 10);
+            }
+            recorded.fetch_add(1);
+            while (recorded.load() < kThreads) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    std::string const json = recorder.Build_chrome_trace_json();
+    EXPECT_EQ(Count_occurrences(json, "\"name\":\"Work\""),
+              static_cast<size_t>(kThreads * kEventsPerThread));
+    EXPECT_EQ(Count_occurrences(json, "\"ph\":\"M\""), static_cast<size_t>(kThreads));
+
+    // A later thread reuses a ring whose owner exited rather than growing.
+    std::thread([&recorder] {
+        int64_t const now = TraceRecorder::Now_ns();
+        recorder.Record("Late", now, now + 10);
+    }).join();
+    std::string const after = recorder.Build_chrome_trace_json();
+    EXPECT_EQ(Count_occurrences(after, "\"ph\":\"M\""), static_cast<size_t>(kThreads));
+    EXPECT_EQ(Count_occurrences(after, "\"name\":\"Late\""), 1u);
+}
+
+TEST(trace_recorder, Clear_DropsEventsThatBeganEarlier) {
+    TraceRecorder recorder;
+    int64_t const before = TraceRecorder::Now_ns();
+    recorder.Record("Before", before, before + 1);
+    recorder.Clear();
+    int64_t const after = TraceRecorder::Now_ns() + 1;
+    recorder.Record("After", after, after + 1);
+
+    std::string const json = recorder.Build_chrome_trace_json();
+    EXPECT_EQ(json.find("\"Before\""), std::string::npos);
+    EXPECT_NE(json.find("\"After\""), std::string::npos);
+}
+
+TEST(trace_recorder, Scope_RecordsIntoInstanceOnlyWhileEnabled) {
+    TraceRecorder &recorder = TraceRecorder::Instance();
+    EXPECT_FALSE(recorder.Is_enabled());
+    { TraceScope const scope("trace_recorder_tests.disabled"); }
+
+    recorder.Set_enabled(true);
+    { TraceScope const scope("trace_recorder_tests.enabled"); }
+    recorder.Set_enabled(false);
+    { TraceScope const scope("trace_recorder_tests.disabled_again"); }
+
+    std::string const json = recorder.Build_chrome_trace_json();
+    EXPECT_EQ(json.find("trace_recorder_tests.disabled"), std::string::npos);
+    EXPECT_NE(json.find("trace_recorder_tests.enabled"), std::string::npos);
+    recorder.Clear();
+}
+
+TEST(trace_recorder, CLI_parser_TraceOutputOnlyInTraceBuilds) {
+    std::vector<std::wstring> const args = {L"--desktop", L"--output", L"a.png",
+                                            L"--trace-output", L"trace.json"};
+    CliParseResult const result = Parse_cli_arguments(args, false);
+    if constexpr (kTraceRecorderCompiledIn) {
+        ASSERT_TRUE(result.ok) << result.error_message;
+        EXPECT_EQ(result.options.trace_output_path, L"trace.json");
+
+        std::vector<std::wstring> const without_source = {L"--trace-output",
+                                                          L"trace.json"};
+        CliParseResult const rejected = Parse_cli_arguments(without_source, false);
+        EXPECT_FALSE(rejected.ok);
+        EXPECT_NE(rejected.error_message.find(L"--trace-output requires"),
+                  std::wstring::npos);
+    } else {
+        EXPECT_FALSE(result.ok);
+    }
+}